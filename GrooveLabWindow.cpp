@@ -21,7 +21,6 @@ GrooveLabWindow::GrooveLabWindow(MidiProcessor* midi, QWidget* parent)
     : QMainWindow(parent)
     , m_midi(midi)
     , m_engine(this) {
-    m_grooveRegistry = groove::GrooveRegistry::builtins();
     setWindowTitle("Groove Lab");
     resize(960, 640);
     buildUi();
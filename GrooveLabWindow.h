@@ -138,6 +138,6 @@ private:
     QComboBox* m_lockMode = nullptr;
     QDoubleSpinBox* m_lockStrength = nullptr;
 
-    virtuoso::groove::GrooveRegistry m_grooveRegistry;
+    const virtuoso::groove::GrooveRegistry& m_grooveRegistry = virtuoso::groove::GrooveRegistry::shared();
 };
 
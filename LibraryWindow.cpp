@@ -104,8 +104,8 @@ static int normalizeMidi(int midi) {
 
 LibraryWindow::LibraryWindow(MidiProcessor* midi, QWidget* parent)
     : QMainWindow(parent),
-      m_registry(OntologyRegistry::builtins()),
-      m_grooveRegistry(virtuoso::groove::GrooveRegistry::builtins()),
+      m_registry(OntologyRegistry::shared()),
+      m_grooveRegistry(virtuoso::groove::GrooveRegistry::shared()),
       m_midi(midi) {
     setWindowTitle("Library");
     resize(1100, 520);
@@ -98,10 +98,10 @@ private:
     static QString jsonString(const QJsonObject& o, const char* key);
     static int jsonInt(const QJsonObject& o, const char* key, int fallback = 0);
 
-    virtuoso::ontology::OntologyRegistry m_registry;
+    const virtuoso::ontology::OntologyRegistry& m_registry; // shared()
     playback::HarmonyContext m_harmonyHelper;
     MidiProcessor* m_midi = nullptr; // not owned
-    virtuoso::groove::GrooveRegistry m_grooveRegistry;
+    const virtuoso::groove::GrooveRegistry& m_grooveRegistry; // shared()
 
     // Stable, logical ordering (QHash iteration order is not deterministic)
     QVector<const virtuoso::ontology::ChordDef*> m_orderedChords;
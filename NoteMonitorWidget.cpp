@@ -517,24 +517,13 @@ NoteMonitorWidget::NoteMonitorWidget(bool performanceMode, QWidget* parent)
 
     if (m_performanceMode) {
         // Performance mode: lightweight startup with only ScaleSnapProcessor
-        m_standaloneOntology = new virtuoso::ontology::OntologyRegistry(virtuoso::ontology::OntologyRegistry::builtins());
+        m_standaloneOntology = &virtuoso::ontology::OntologyRegistry::shared();
         m_standaloneHarmony = new playback::HarmonyContext();
         m_standaloneHarmony->setOntology(m_standaloneOntology);
         m_standaloneScaleSnap = new playback::ScaleSnapProcessor(this);
         m_standaloneScaleSnap->setHarmonyContext(m_standaloneHarmony);
         m_standaloneScaleSnap->setOntology(m_standaloneOntology);
 
-        // Timer to drive updateConformance() for glissando/bend behaviors in performance mode
-        // (In full engine mode, the engine's tick timer handles this)
-        m_conformanceTimer = new QTimer(this);
-        m_conformanceTimer->setTimerType(Qt::PreciseTimer);
-        connect(m_conformanceTimer, &QTimer::timeout, this, [this]() {
-            if (m_standaloneScaleSnap) {
-                m_standaloneScaleSnap->updateConformance(10.0f);
-            }
-        });
-        m_conformanceTimer->start(10); // 10ms tick, same as playback engine
-
         // Hide ALL superfluous UI — performance mode shows only wave + note overlays
         if (m_chartContainer) m_chartContainer->hide();
     } else {
@@ -1001,24 +990,19 @@ void NoteMonitorWidget::setMidiProcessor(MidiProcessor* processor) {
     if (m_performanceMode) {
         // Performance mode: wire ScaleSnapProcessor directly to MidiProcessor signals
         if (m_standaloneScaleSnap) {
+            // Guitar note on/off: inline stage on the MIDI worker (installed by setMidiProcessor)
             m_standaloneScaleSnap->setMidiProcessor(m_midiProcessor);
-            // Guitar signals: DirectConnection for real-time performance
-            connect(m_midiProcessor, &MidiProcessor::guitarNoteOn,
-                    m_standaloneScaleSnap, &playback::ScaleSnapProcessor::onGuitarNoteOn,
-                    Qt::DirectConnection);
-            connect(m_midiProcessor, &MidiProcessor::guitarNoteOff,
-                    m_standaloneScaleSnap, &playback::ScaleSnapProcessor::onGuitarNoteOff,
-                    Qt::DirectConnection);
             connect(m_midiProcessor, &MidiProcessor::guitarHzUpdated,
                     m_standaloneScaleSnap, &playback::ScaleSnapProcessor::onGuitarHzUpdated,
                     Qt::DirectConnection);
-            // Voice signals: QueuedConnection (comes from worker thread)
+            // Voice signals: DirectConnection too; the note table belongs to the MIDI worker
+            // (which also ticks conformance for glissando/bend through the stage)
             connect(m_midiProcessor, &MidiProcessor::voiceCc2Updated,
                     m_standaloneScaleSnap, &playback::ScaleSnapProcessor::onVoiceCc2Updated,
-                    Qt::QueuedConnection);
+                    Qt::DirectConnection);
             connect(m_midiProcessor, &MidiProcessor::voiceHzUpdated,
                     m_standaloneScaleSnap, &playback::ScaleSnapProcessor::onVoiceHzUpdated,
-                    Qt::QueuedConnection);
+                    Qt::DirectConnection);
             // Voice MIDI notes for VocalSync mode (stable integer note tracking)
             connect(m_midiProcessor, &MidiProcessor::voiceNoteOn,
                     m_standaloneScaleSnap, &playback::ScaleSnapProcessor::onVoiceNoteOn,
@@ -1109,7 +1093,7 @@ void NoteMonitorWidget::loadSongAtIndex(int idx) {
     if (!m_performanceMode && m_virtuosoPresetCombo) {
         const bool prevSig = m_virtuosoPresetCombo->blockSignals(true);
         m_virtuosoPresetCombo->clear();
-        const auto reg = virtuoso::groove::GrooveRegistry::builtins();
+        const auto& reg = virtuoso::groove::GrooveRegistry::shared();
         const auto presets = reg.allStylePresets();
         int sel = -1;
         QString desiredKey;
@@ -1208,7 +1192,6 @@ NoteMonitorWidget::~NoteMonitorWidget() {
     // Performance mode standalone objects (non-QObject heap allocations)
     delete m_standaloneHarmony;
     m_standaloneHarmony = nullptr;
-    delete m_standaloneOntology;
     m_standaloneOntology = nullptr;
 }
 
@@ -161,10 +161,9 @@ private:
 
     // Performance mode: lightweight startup without Virtuoso musician subsystem
     bool m_performanceMode = false;
-    virtuoso::ontology::OntologyRegistry* m_standaloneOntology = nullptr;
+    const virtuoso::ontology::OntologyRegistry* m_standaloneOntology = nullptr; // shared()
     playback::HarmonyContext* m_standaloneHarmony = nullptr;
     playback::ScaleSnapProcessor* m_standaloneScaleSnap = nullptr;
-    QTimer* m_conformanceTimer = nullptr;    // ticks updateConformance() for glissando/bend in perf mode
     chart::ChartModel m_perfModeChartModel;  // owned chart model for performance mode
 
 protected:
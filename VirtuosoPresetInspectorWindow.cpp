@@ -35,7 +35,7 @@ VirtuosoPresetInspectorWindow::VirtuosoPresetInspectorWindow(MidiProcessor* midi
     setWindowTitle("Virtuoso Preset Inspector");
     resize(980, 720);
 
-    m_regOwned = new GrooveRegistry(GrooveRegistry::builtins());
+    m_registry = &GrooveRegistry::shared();
 
     QWidget* root = new QWidget(this);
     QVBoxLayout* v = new QVBoxLayout(root);
@@ -177,10 +177,10 @@ QString VirtuosoPresetInspectorWindow::currentPresetKey() const {
 }
 
 void VirtuosoPresetInspectorWindow::rebuildPresetCombo() {
-    if (!m_regOwned || !m_presetCombo) return;
+    if (!m_registry || !m_presetCombo) return;
     const bool prev = m_presetCombo->blockSignals(true);
     m_presetCombo->clear();
-    const auto presets = m_regOwned->allStylePresets();
+    const auto presets = m_registry->allStylePresets();
     int sel = -1;
     for (const auto* p : presets) {
         if (!p) continue;
@@ -215,7 +215,7 @@ void VirtuosoPresetInspectorWindow::refreshAll() {
 
 void VirtuosoPresetInspectorWindow::refreshPresetSummary() {
     const QString key = currentPresetKey();
-    const auto* p = (m_regOwned && !key.isEmpty()) ? m_regOwned->stylePreset(key) : nullptr;
+    const auto* p = (m_registry && !key.isEmpty()) ? m_registry->stylePreset(key) : nullptr;
     if (!p) {
         m_presetSummary->setText("(no preset selected)");
         return;
@@ -237,10 +237,10 @@ void VirtuosoPresetInspectorWindow::refreshPresetSummary() {
 }
 
 void VirtuosoPresetInspectorWindow::refreshGrooveTemplateTable() {
-    if (!m_grooveOffsets || !m_regOwned) return;
+    if (!m_grooveOffsets || !m_registry) return;
     const QString key = currentPresetKey();
-    const auto* p = (!key.isEmpty()) ? m_regOwned->stylePreset(key) : nullptr;
-    const auto* gt = (p && !p->grooveTemplateKey.isEmpty()) ? m_regOwned->grooveTemplate(p->grooveTemplateKey) : nullptr;
+    const auto* p = (!key.isEmpty()) ? m_registry->stylePreset(key) : nullptr;
+    const auto* gt = (p && !p->grooveTemplateKey.isEmpty()) ? m_registry->grooveTemplate(p->grooveTemplateKey) : nullptr;
     m_grooveOffsets->setRowCount(0);
     if (!gt) return;
 
@@ -266,9 +266,9 @@ void VirtuosoPresetInspectorWindow::refreshGrooveTemplateTable() {
 }
 
 void VirtuosoPresetInspectorWindow::refreshInstrumentProfilesTable() {
-    if (!m_profiles || !m_regOwned) return;
+    if (!m_profiles || !m_registry) return;
     const QString key = currentPresetKey();
-    const auto* p = (!key.isEmpty()) ? m_regOwned->stylePreset(key) : nullptr;
+    const auto* p = (!key.isEmpty()) ? m_registry->stylePreset(key) : nullptr;
     m_profiles->setRowCount(0);
     if (!p) return;
 
@@ -321,7 +321,7 @@ void VirtuosoPresetInspectorWindow::onBpmChanged(int) {
 }
 
 void VirtuosoPresetInspectorWindow::onGeneratePreview() {
-    if (!m_timeline || !m_regOwned) return;
+    if (!m_timeline || !m_registry) return;
 
     // Simple preview over a tiny ballad test progression (ii–V–I in C).
     // This is for *visual validation* of what planners do, not audio playback.
@@ -344,11 +344,11 @@ void VirtuosoPresetInspectorWindow::onGeneratePreview() {
 
     // Resolve selected style preset -> groove template + instrument profiles for humanization.
     const QString presetKey = currentPresetKey();
-    const auto* sp = (!presetKey.isEmpty()) ? m_regOwned->stylePreset(presetKey) : nullptr;
+    const auto* sp = (!presetKey.isEmpty()) ? m_registry->stylePreset(presetKey) : nullptr;
     virtuoso::groove::GrooveTemplate gtScaled;
     bool haveGt = false;
     if (sp) {
-        const auto* gt = m_regOwned->grooveTemplate(sp->grooveTemplateKey);
+        const auto* gt = m_registry->grooveTemplate(sp->grooveTemplateKey);
         if (gt) {
             gtScaled = *gt;
             gtScaled.amount = qBound(0.0, sp->templateAmount, 1.0);
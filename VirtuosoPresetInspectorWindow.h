@@ -45,7 +45,7 @@ private:
     QString currentPresetKey() const;
 
     MidiProcessor* m_midi = nullptr; // not owned
-    virtuoso::groove::GrooveRegistry* m_regOwned = nullptr;
+    const virtuoso::groove::GrooveRegistry* m_registry = nullptr; // shared()
 
     QComboBox* m_presetCombo = nullptr;
     QSpinBox* m_bpm = nullptr;
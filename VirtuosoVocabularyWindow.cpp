@@ -213,10 +213,9 @@ void VirtuosoVocabularyWindow::buildUi() {
         emit agentEnergyMultiplierChanged(instrumentName(m_instrument), mult);
     });
 
-    // Load vocab library (for showing underlying pattern definitions when selecting tags/IDs).
-    QString err;
-    m_vocabLoaded = m_vocab.loadFromResourcePath(":/virtuoso/vocab/cool_jazz_vocabulary.json", &err);
-    if (!m_vocabLoaded) m_vocabErr = err;
+    // Vocab library (for showing underlying pattern definitions when selecting tags/IDs).
+    m_vocabLoaded = m_vocab.isLoaded();
+    if (!m_vocabLoaded) m_vocabErr = m_vocab.lastError();
 }
 
 void VirtuosoVocabularyWindow::refreshTagList() {
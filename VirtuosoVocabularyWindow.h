@@ -111,7 +111,7 @@ private:
     QVector<virtuoso::ui::GrooveTimelineWidget::LaneEvent> m_displayEvents;
 
     // Vocabulary (for mapping IDs/tags -> underlying library definition)
-    virtuoso::vocab::VocabularyRegistry m_vocab;
+    const virtuoso::vocab::VocabularyRegistry& m_vocab = virtuoso::vocab::VocabularyRegistry::shared();
     bool m_vocabLoaded = false;
     QString m_vocabErr;
 };
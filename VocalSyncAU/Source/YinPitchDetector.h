@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cmath>
+#include <complex>
 
 /**
  * YinPitchDetector - Lightweight monophonic pitch detection using the YIN algorithm.
@@ -10,17 +11,33 @@
  * YIN method which provides reliable fundamental frequency estimation for
  * monophonic signals (single voice).
  *
+ * The analysis window is kept contiguous (the ring buffer is mirrored, every sample
+ * is written twice) so the difference function never wraps. By default it is computed
+ * with the energy-term formulation
+ *     d(tau) = sum x[j]^2 + sum x[j+tau]^2 - 2 * sum x[j] * x[j+tau]
+ * where the energies come from a prefix sum and the cross term from one FFT
+ * autocorrelation: O(W log W) instead of O(W^2) per detection.
+ *
+ * Detection runs once per hop (setHopSize) rather than on every process() call.
+ *
  * Reference: de Cheveign, A. & Kawahara, H. (2002). "YIN, a fundamental
  * frequency estimator for speech and music."
  */
 class YinPitchDetector
 {
 public:
+    /** How the difference function (YIN step 1) is computed. All give the same pitch. */
+    enum class Method {
+        Fft,       // energy terms + FFT autocorrelation (default)
+        Direct,    // O(W^2) over the contiguous window, vectorizable inner loop
+        Reference  // original O(W^2) loop over the circular buffer (verification only)
+    };
+
     YinPitchDetector() = default;
 
     /**
      * Initialize the detector for a given sample rate.
-     * Must be called before process().
+     * Must be called before process(). Allocates; process() does not.
      */
     void prepare(double sampleRate, int maxBlockSize)
     {
@@ -29,23 +46,51 @@ public:
         // At 44100 Hz: 44100/80 * 2 = 1102 samples
         m_windowSize = static_cast<int>(sampleRate / m_minFrequency) * 2;
         m_halfWindow = m_windowSize / 2;
-        m_buffer.resize(m_windowSize, 0.0f);
-        m_yinBuffer.resize(m_halfWindow, 0.0f);
+        m_buffer.assign(m_windowSize * 2, 0.0f);
+        m_yinBuffer.assign(m_halfWindow, 0.0f);
         m_writePos = 0;
+        m_samplesSinceDetect = 0;
+
+        // FFT autocorrelation: lags < W/2 of a W-sample window never wrap at N >= W.
+        m_fftSize = 1;
+        while (m_fftSize < m_windowSize) m_fftSize <<= 1;
+        m_fftBuffer.assign(m_fftSize, {0.0, 0.0});
+        m_twiddles.resize(m_fftSize / 2);
+        for (int k = 0; k < m_fftSize / 2; ++k) {
+            const double phase = -2.0 * kPi * k / m_fftSize;
+            m_twiddles[k] = {std::cos(phase), std::sin(phase)};
+        }
+        m_bitReverse.resize(m_fftSize);
+        int bits = 0;
+        while ((1 << bits) < m_fftSize) ++bits;
+        for (int i = 0; i < m_fftSize; ++i) {
+            int r = 0;
+            for (int b = 0; b < bits; ++b)
+                if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+            m_bitReverse[i] = r;
+        }
+        m_energyPrefix.assign(m_windowSize + 1, 0.0);
+        (void)maxBlockSize;
     }
 
     /**
      * Feed audio samples into the detector.
-     * Call this every audio block with the input buffer.
+     * Call this every audio block with the input buffer. Detection runs when at least
+     * hopSize() samples arrived since the last one (every call if hopSize() == 0).
      */
     void process(const float* input, int numSamples)
     {
-        // Accumulate into circular buffer
+        // Accumulate into the mirrored circular buffer
         for (int i = 0; i < numSamples; ++i) {
             m_buffer[m_writePos] = input[i];
-            m_writePos = (m_writePos + 1) % m_windowSize;
+            m_buffer[m_writePos + m_windowSize] = input[i];
+            if (++m_writePos == m_windowSize) m_writePos = 0;
         }
 
+        m_samplesSinceDetect += numSamples;
+        if (m_hopSize > 0 && m_samplesSinceDetect < m_hopSize) return;
+        m_samplesSinceDetect = (m_hopSize > 0) ? m_samplesSinceDetect % m_hopSize : 0;
+
         // Run YIN on the current buffer
         computeYin();
     }
@@ -62,16 +107,27 @@ public:
     /** Set the YIN threshold (default 0.15). Lower = stricter. */
     void setThreshold(float threshold) { m_threshold = threshold; }
 
-    /** Set minimum detectable frequency (default 80 Hz). */
+    /** Set minimum detectable frequency (default 80 Hz). Takes effect on the next prepare(). */
     void setMinFrequency(float freq) { m_minFrequency = freq; }
 
     /** Set maximum detectable frequency (default 1000 Hz). */
     void setMaxFrequency(float freq) { m_maxFrequency = freq; }
 
+    /** Run detection every `samples` input samples (default 0 = on every process() call). */
+    void setHopSize(int samples) { m_hopSize = samples > 0 ? samples : 0; }
+    int hopSize() const { return m_hopSize; }
+
+    void setMethod(Method method) { m_method = method; }
+    Method method() const { return m_method; }
+
 private:
-    void computeYin()
+    static constexpr double kPi = 3.14159265358979323846;
+
+    // Oldest sample first; valid for m_windowSize samples.
+    const float* window() const { return m_buffer.data() + m_writePos; }
+
+    void differenceReference()
     {
-        // Step 1: Difference function
         for (int tau = 0; tau < m_halfWindow; ++tau) {
             m_yinBuffer[tau] = 0.0f;
             for (int j = 0; j < m_halfWindow; ++j) {
@@ -81,6 +137,125 @@ private:
                 m_yinBuffer[tau] += delta * delta;
             }
         }
+    }
+
+    void differenceDirect()
+    {
+        constexpr int kLanes = 8;
+        const float* x = window();
+        float* out = m_yinBuffer.data();
+        const int n = m_halfWindow;
+        const int nVec = n - n % kLanes;
+        for (int tau = 0; tau < n; ++tau) {
+            const float* a = x;
+            const float* b = x + tau;
+            // Independent partial sums so the compiler can keep them in one vector register.
+            float acc[kLanes] = {};
+            for (int j = 0; j < nVec; j += kLanes) {
+                for (int l = 0; l < kLanes; ++l) {
+                    const float delta = a[j + l] - b[j + l];
+                    acc[l] += delta * delta;
+                }
+            }
+            float sum = 0.0f;
+            for (int j = nVec; j < n; ++j) {
+                const float delta = a[j] - b[j];
+                sum += delta * delta;
+            }
+            for (int l = 0; l < kLanes; ++l) sum += acc[l];
+            out[tau] = sum;
+        }
+    }
+
+    void differenceFft()
+    {
+        const float* x = window();
+        const int n = m_halfWindow;
+        const int size = m_fftSize;
+        // Raw pointers: indexing the member vectors directly makes the compiler reload
+        // their data pointers after every store (several times slower).
+        std::complex<double>* z = m_fftBuffer.data();
+        double* prefix = m_energyPrefix.data();
+        float* out = m_yinBuffer.data();
+
+        // Energy terms: E(tau) = sum_{j<n} x[j+tau]^2 from a prefix sum.
+        prefix[0] = 0.0;
+        for (int j = 0; j < m_windowSize; ++j)
+            prefix[j + 1] = prefix[j] + double(x[j]) * double(x[j]);
+
+        // Cross term r(tau) = sum_{j<n} x[j] * x[j+tau]: pack the window (real) and its first
+        // half (imag) into one complex FFT, correlate in the frequency domain, invert.
+        for (int j = 0; j < size; ++j) {
+            const double re = (j < m_windowSize) ? double(x[j]) : 0.0;
+            const double im = (j < n) ? double(x[j]) : 0.0;
+            z[j] = {re, im};
+        }
+        fft(m_fftBuffer);
+        for (int k = 0; k <= size / 2; ++k) {
+            const int mk = (size - k) & (size - 1);
+            const std::complex<double> zk = z[k];
+            const std::complex<double> zm = std::conj(z[mk]);
+            const std::complex<double> full = (zk + zm) * 0.5;
+            const std::complex<double> half = (zk - zm) * std::complex<double>(0.0, -0.5);
+            // Stores conj(conj(half) * full); conj then forward FFT == inverse FFT * N for real output.
+            const std::complex<double> c(half.real() * full.real() + half.imag() * full.imag(),
+                                         half.imag() * full.real() - half.real() * full.imag());
+            z[k] = c;
+            z[mk] = std::conj(c);
+        }
+        fft(m_fftBuffer);
+
+        const double energy0 = prefix[n];
+        // Round-off in r scales with the whole window's energy, not just the two halves.
+        const double noiseFloor = 1e-12 * prefix[m_windowSize];
+        const double invSize = 1.0 / size;
+        for (int tau = 0; tau < n; ++tau) {
+            const double r = z[tau].real() * invSize;
+            const double energyTau = prefix[tau + n] - prefix[tau];
+            const double d = energy0 + energyTau - 2.0 * r;
+            // FFT round-off leaves d slightly above 0 where the direct sum is exactly 0 (both
+            // halves still silent at a note onset); a CMND built from that noise reports a
+            // confident, wrong pitch. Treat d within epsilon of the energy terms as 0.
+            out[tau] = d > 1e-6 * (energy0 + energyTau) + noiseFloor ? static_cast<float>(d) : 0.0f;
+        }
+    }
+
+    // In-place iterative radix-2 forward FFT of size m_fftSize.
+    void fft(std::vector<std::complex<double>>& buffer) const
+    {
+        const int size = m_fftSize;
+        std::complex<double>* a = buffer.data();
+        const std::complex<double>* twiddles = m_twiddles.data();
+        for (int i = 0; i < size; ++i) {
+            const int r = m_bitReverse[i];
+            if (i < r) std::swap(a[i], a[r]);
+        }
+        for (int len = 2; len <= size; len <<= 1) {
+            const int halfLen = len >> 1;
+            const int step = size / len;
+            for (int i = 0; i < size; i += len) {
+                for (int k = 0; k < halfLen; ++k) {
+                    // Written out: std::complex operator* calls the NaN/Inf-safe library
+                    // routine unless built with -ffast-math.
+                    const std::complex<double> u = a[i + k + halfLen];
+                    const std::complex<double> w = twiddles[k * step];
+                    const std::complex<double> t(u.real() * w.real() - u.imag() * w.imag(),
+                                                 u.real() * w.imag() + u.imag() * w.real());
+                    a[i + k + halfLen] = a[i + k] - t;
+                    a[i + k] += t;
+                }
+            }
+        }
+    }
+
+    void computeYin()
+    {
+        // Step 1: Difference function
+        switch (m_method) {
+        case Method::Fft: differenceFft(); break;
+        case Method::Direct: differenceDirect(); break;
+        case Method::Reference: differenceReference(); break;
+        }
 
         // Step 2: Cumulative mean normalized difference
         m_yinBuffer[0] = 1.0f;
@@ -137,11 +312,21 @@ private:
     float m_threshold = 0.15f;
     float m_minFrequency = 80.0f;
     float m_maxFrequency = 1000.0f;
+    Method m_method = Method::Fft;
+    int m_hopSize = 0;
+    int m_samplesSinceDetect = 0;
     int m_windowSize = 0;
     int m_halfWindow = 0;
     int m_writePos = 0;
     float m_detectedHz = 0.0f;
     float m_confidence = 0.0f;
-    std::vector<float> m_buffer;
+    std::vector<float> m_buffer;      // 2 * m_windowSize: [i] and [i + m_windowSize] hold the same sample
     std::vector<float> m_yinBuffer;
+
+    // Method::Fft scratch (sized in prepare())
+    int m_fftSize = 0;
+    std::vector<std::complex<double>> m_fftBuffer;
+    std::vector<std::complex<double>> m_twiddles;
+    std::vector<int> m_bitReverse;
+    std::vector<double> m_energyPrefix;
 };
@@ -0,0 +1,175 @@
+#include "YinPitchDetector.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QtGlobal>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+static int g_failures = 0;
+
+static void expect(bool cond, const QString& msg) {
+    if (!cond) {
+        ++g_failures;
+        qWarning().noquote() << "FAIL:" << msg;
+    }
+}
+
+constexpr double kTwoPi = 6.28318530717958647692;
+
+static std::vector<float> sine(double sr, double hz, int n, double amp = 0.5) {
+    std::vector<float> out(n);
+    for (int i = 0; i < n; ++i) out[i] = float(amp * std::sin(kTwoPi * hz * i / sr));
+    return out;
+}
+
+// Voice-like: decaying harmonics, 5.5 Hz vibrato (+-30 cents), a little deterministic noise.
+static std::vector<float> voice(double sr, double hz, int n) {
+    std::vector<float> out(n);
+    double phase = 0.0;
+    quint32 x = 12345u;
+    for (int i = 0; i < n; ++i) {
+        const double f = hz * std::pow(2.0, 0.3 / 12.0 * std::sin(kTwoPi * 5.5 * i / sr));
+        phase += kTwoPi * f / sr;
+        double s = 0.0;
+        for (int h = 1; h <= 6; ++h) s += std::sin(h * phase) / (h * h);
+        x = x * 1664525u + 1013904223u;
+        const double noise = (double(x >> 8) / double(1u << 24) - 0.5) * 0.02;
+        out[i] = float(0.3 * s + noise);
+    }
+    return out;
+}
+
+struct Detection {
+    float hz = 0.0f;
+    bool voiced = false;
+};
+
+// Feeds `signal` in blocks and returns the state after the last block.
+static Detection run(YinPitchDetector::Method method, double sr, const std::vector<float>& signal,
+                     int block, int hop = 0) {
+    YinPitchDetector yin;
+    yin.setMethod(method);
+    yin.setHopSize(hop);
+    yin.prepare(sr, block);
+    for (int i = 0; i + block <= int(signal.size()); i += block) yin.process(signal.data() + i, block);
+    return {yin.detectedHz(), yin.isVoiced()};
+}
+
+static void expectSameHz(const Detection& ref, const Detection& got, const QString& what) {
+    expect(ref.voiced == got.voiced, what + ": voiced flag differs");
+    const float tol = 0.001f * qMax(1.0f, ref.hz); // 0.1% (~1.7 cents)
+    expect(std::abs(ref.hz - got.hz) <= tol,
+           what + QString(": %1 Hz vs reference %2 Hz").arg(double(got.hz)).arg(double(ref.hz)));
+}
+
+static void testMethodsMatchReferenceOnSines() {
+    using M = YinPitchDetector::Method;
+    for (double sr : {44100.0, 48000.0}) {
+        for (double hz : {82.41, 110.0, 196.0, 261.63, 440.0, 659.25, 880.0}) {
+            const auto sig = sine(sr, hz, 8192);
+            const Detection ref = run(M::Reference, sr, sig, 512);
+            const QString what = QString("sine %1 Hz @ %2").arg(hz).arg(sr);
+            // Parabolic interpolation is coarse at short lags (880 Hz reads ~866 Hz); only check the lock.
+            expect(ref.voiced && std::abs(ref.hz - hz) < 0.02 * hz, what + ": reference did not lock");
+            expectSameHz(ref, run(M::Direct, sr, sig, 512), what + " direct");
+            expectSameHz(ref, run(M::Fft, sr, sig, 512), what + " fft");
+        }
+    }
+}
+
+static void testMethodsMatchReferenceOnVoice() {
+    using M = YinPitchDetector::Method;
+    const double sr = 48000.0;
+    for (double hz : {98.0, 146.83, 220.0, 329.63, 523.25}) {
+        const auto sig = voice(sr, hz, 12000);
+        // Compare after every block, not just the last one, so vibrato sweeps are covered.
+        YinPitchDetector ref, direct, fft;
+        ref.setMethod(M::Reference);
+        direct.setMethod(M::Direct);
+        fft.setMethod(M::Fft);
+        for (auto* y : {&ref, &direct, &fft}) y->prepare(sr, 256);
+        for (int i = 0; i + 256 <= int(sig.size()); i += 256) {
+            for (auto* y : {&ref, &direct, &fft}) y->process(sig.data() + i, 256);
+            if (i < 2048) continue; // window still filling
+            const QString what = QString("voice %1 Hz @ sample %2").arg(hz).arg(i);
+            expectSameHz({ref.detectedHz(), ref.isVoiced()}, {direct.detectedHz(), direct.isVoiced()}, what + " direct");
+            expectSameHz({ref.detectedHz(), ref.isVoiced()}, {fft.detectedHz(), fft.isVoiced()}, what + " fft");
+        }
+    }
+}
+
+static void testSilenceIsUnvoiced() {
+    const std::vector<float> zeros(4096, 0.0f);
+    for (auto m : {YinPitchDetector::Method::Reference, YinPitchDetector::Method::Direct, YinPitchDetector::Method::Fft}) {
+        const Detection d = run(m, 48000.0, zeros, 256);
+        expect(!d.voiced && d.hz == 0.0f, "silence must be unvoiced");
+    }
+}
+
+// Digital silence, then a sine: the window straddles the onset for several blocks. The Fft
+// method must not turn round-off in the silent part into a (confident) pitch.
+static void testSilenceToOnsetMatchesReference() {
+    using M = YinPitchDetector::Method;
+    const double sr = 48000.0;
+    for (int block : {128, 256, 512}) {
+        std::vector<float> sig(4096, 0.0f);
+        const auto tone = sine(sr, 220.0, 4096);
+        sig.insert(sig.end(), tone.begin(), tone.end());
+        YinPitchDetector ref, direct, fft;
+        ref.setMethod(M::Reference);
+        direct.setMethod(M::Direct);
+        fft.setMethod(M::Fft);
+        for (auto* y : {&ref, &direct, &fft}) y->prepare(sr, block);
+        for (int i = 0; i + block <= int(sig.size()); i += block) {
+            for (auto* y : {&ref, &direct, &fft}) y->process(sig.data() + i, block);
+            if (i < 4096 - block) continue;
+            const QString what = QString("onset (block %1) @ sample %2").arg(block).arg(i);
+            expectSameHz({ref.detectedHz(), ref.isVoiced()}, {direct.detectedHz(), direct.isVoiced()}, what + " direct");
+            expectSameHz({ref.detectedHz(), ref.isVoiced()}, {fft.detectedHz(), fft.isVoiced()}, what + " fft");
+        }
+        expect(ref.isVoiced() && std::abs(ref.detectedHz() - 220.0f) < 2.0f,
+               QString("onset (block %1): reference locks once the window is full").arg(block));
+    }
+}
+
+static void testHopSize() {
+    const double sr = 48000.0;
+    const auto sig = sine(sr, 220.0, 4096);
+
+    // Hop 256 with 64-sample blocks: nothing until the 4th block, then every 4th block.
+    YinPitchDetector yin;
+    yin.setHopSize(256);
+    yin.prepare(sr, 64);
+    for (int i = 0; i < 3 * 64; i += 64) yin.process(sig.data() + i, 64);
+    expect(yin.detectedHz() == 0.0f, "hop: no detection before hopSize samples");
+
+    // Both end on a hop boundary (4096 % 256 == 0): same final window, same result.
+    const Detection everyBlock = run(YinPitchDetector::Method::Fft, sr, sig, 64, 0);
+    const Detection hopped = run(YinPitchDetector::Method::Fft, sr, sig, 64, 256);
+    expect(everyBlock.hz == hopped.hz && everyBlock.voiced == hopped.voiced, "hop: same window gives same pitch");
+
+    // Blocks larger than the hop still detect once per block.
+    const Detection big = run(YinPitchDetector::Method::Fft, sr, sig, 1024, 256);
+    expect(big.voiced && std::abs(big.hz - 220.0f) < 2.0f, "hop: block > hop still detects");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    testMethodsMatchReferenceOnSines();
+    testMethodsMatchReferenceOnVoice();
+    testSilenceIsUnvoiced();
+    testSilenceToOnsetMatchesReference();
+    testHopSize();
+    if (g_failures > 0) {
+        qWarning() << "YinPitchDetectorTests failures:" << g_failures;
+        return 1;
+    }
+    qInfo() << "YinPitchDetectorTests OK";
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "bench/AllocCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local bool t_countAllocs = false;
+thread_local long long t_allocs = 0;
+} // namespace
+
+void beginAllocCount() {
+    t_allocs = 0;
+    t_countAllocs = true;
+}
+
+long long endAllocCount() {
+    t_countAllocs = false;
+    return t_allocs;
+}
+
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* malloc(size_t n) {
+    if (t_countAllocs) ++t_allocs;
+    return __libc_malloc(n);
+}
+extern "C" void* calloc(size_t n, size_t sz) {
+    if (t_countAllocs) ++t_allocs;
+    return __libc_calloc(n, sz);
+}
+extern "C" void* realloc(void* p, size_t n) {
+    if (t_countAllocs) ++t_allocs;
+    return __libc_realloc(p, n);
+}
+#endif
+
+void* operator new(std::size_t n) {
+#if !defined(__GLIBC__)
+    if (t_countAllocs) ++t_allocs;
+#endif
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,13 @@
+#pragma once
+
+// Counts heap allocations made by the current thread while armed. On glibc
+// malloc itself is interposed so Qt's direct malloc() calls (QString data)
+// are caught too; elsewhere only operator new is counted.
+//
+// The interposers live in AllocCounter.cpp, built as an OBJECT library so
+// they always link into the benchmark or test that uses them.
+
+// Zeroes this thread's count and starts counting.
+void beginAllocCount();
+// Stops counting; returns the allocations this thread made since beginAllocCount().
+long long endAllocCount();
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QDebug>
+#include <QString>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <vector>
+
+// Prints "name: n=.. p50=..us p99=..us p99.9=..us max=..us" for a set of
+// nanosecond samples, sorting them in place.
+inline void reportPercentiles(const QString& name, std::vector<qint64>& samplesNs) {
+    if (samplesNs.empty()) {
+        qInfo().noquote() << name << ": no samples";
+        return;
+    }
+    std::sort(samplesNs.begin(), samplesNs.end());
+    auto pct = [&](double p) {
+        const size_t idx = std::min(samplesNs.size() - 1, size_t(p * double(samplesNs.size())));
+        return double(samplesNs[idx]) / 1000.0;
+    };
+    qInfo().noquote() << QString("%1: n=%2 p50=%3us p99=%4us p99.9=%5us max=%6us")
+                             .arg(name, -34)
+                             .arg(samplesNs.size())
+                             .arg(pct(0.50), 0, 'f', 2)
+                             .arg(pct(0.99), 0, 'f', 2)
+                             .arg(pct(0.999), 0, 'f', 2)
+                             .arg(double(samplesNs.back()) / 1000.0, 0, 'f', 2);
+}
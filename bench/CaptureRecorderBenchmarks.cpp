@@ -0,0 +1,178 @@
+// Capture recorder overhead: one guitar note-on/off worker pass (input ring -> MidiProcessor
+// -> ScaleSnapProcessor inline, lead + 2 harmony voices -> dummy output) with the recorder
+//   off:       not recording; record() is one relaxed load per message
+//   recording: every inbound and outbound message pushed to the recorder ring, flushed to
+//              a temporary .mcap by the recorder's own thread
+// Allocations are counted on the calling (worker) thread only and should be zero in both.
+// Also reports the bare record() cost, the file size per event and a read-back check of the
+// written capture.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./CaptureRecorderBenchmarks > bench_output.txt
+
+#include "playback/ScaleSnapProcessor.h"
+#include "playback/HarmonyContext.h"
+#include "midiprocessor.h"
+#include "midi/MidiCapture.h"
+#include "midi/MidiRecorder.h"
+#include "music/ChordSymbol.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+#include "bench/AllocCounter.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// Friend of MidiProcessor: pushes a guitar message through its input ring and runs the
+// rest of a worker pass, as the worker does.
+struct MidiProcessorBenchAccess {
+    static void attachDummyOutput(MidiProcessor& p) {
+        if (!p.midiOut) {
+            p.midiOut = std::make_unique<midi::RtMidiOutputPort>(std::make_unique<RtMidiOut>(RtMidi::RTMIDI_DUMMY));
+        }
+    }
+    static void actAsWorker(MidiProcessor& p) { p.m_workerThreadId.store(std::this_thread::get_id()); }
+    static void guitarPass(MidiProcessor& p, midi::MidiMsg m) {
+        MidiProcessor::MidiEvent ev;
+        ev.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        ev.programIndex = -1;
+        m.timestampNs = midi::monotonicNowNs();
+        p.m_guitarRing.push(m);
+        p.drainRing(p.m_guitarRing, MidiProcessor::MidiSource::Guitar, ev);
+        p.drainScheduled(ev);
+        p.drainRing(p.m_virtualRing, MidiProcessor::MidiSource::VirtualBand, ev);
+    }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kNotes = 20000;
+
+static void bench(MidiProcessor& midi, bool recording, const QString& path) {
+    if (recording) midi.startCaptureRecording(path);
+
+    QVector<double> ns;
+    ns.reserve(kNotes);
+    long long allocs = 0;
+    for (int i = 0; i < kNotes; ++i) {
+        const int note = 52 + (i * 7) % 24;
+        beginAllocCount();
+        const auto t0 = Clock::now();
+        MidiProcessorBenchAccess::guitarPass(midi, midi::MidiMsg::make(0x90, quint8(note), 90));
+        const auto t1 = Clock::now();
+        allocs += endAllocCount();
+        MidiProcessorBenchAccess::guitarPass(midi, midi::MidiMsg::make(0x80, quint8(note), 0));
+        ns.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+        // Roughly a fast player: leaves the flusher room to keep up.
+        if (i % 64 == 63) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    if (recording) midi.stopCaptureRecording();
+
+    std::sort(ns.begin(), ns.end());
+    qInfo().noquote() << QString("%1: note-on pass p50 %2 ns, p99 %3 ns, max %4 ns, %5 allocs/event")
+                             .arg(recording ? "recording" : "off      ")
+                             .arg(ns[ns.size() / 2], 0, 'f', 0)
+                             .arg(ns[int(ns.size() * 0.99)], 0, 'f', 0)
+                             .arg(ns.last(), 0, 'f', 0)
+                             .arg(double(allocs) / kNotes, 0, 'f', 2);
+}
+
+// record() alone, producer side, with a drained ring (the flusher keeps up).
+static void benchRecordCall(const QString& path) {
+    midi::MidiRecorder recorder;
+    const midi::MidiMsg m = midi::MidiMsg::make(0x90, 64, 90);
+    constexpr int kBatch = 4096; // well under the ring capacity
+    constexpr int kBatches = 64;
+    double totalNs = 0.0;
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool on = pass == 1;
+        if (on) recorder.start(path);
+        totalNs = 0.0;
+        for (int b = 0; b < kBatches; ++b) {
+            const auto t0 = Clock::now();
+            for (int i = 0; i < kBatch; ++i) recorder.record(midi::CapturePort::Out, m, midi::monotonicNowNs());
+            totalNs += double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+            std::this_thread::sleep_for(std::chrono::milliseconds(2 * midi::MidiRecorder::kFlushIntervalMs));
+        }
+        recorder.stop();
+        qInfo().noquote() << QString("record() %1: %2 ns/call (incl. monotonicNowNs)")
+                                 .arg(on ? "recording" : "off      ")
+                                 .arg(totalNs / (kBatch * kBatches), 0, 'f', 1);
+    }
+    qInfo().noquote() << QString("record() recording: %1 events, %2 dropped, %3 bytes/event")
+                             .arg(recorder.recorded())
+                             .arg(recorder.dropped())
+                             .arg(double(recorder.bytesWritten() - midi::kBinaryCaptureHeaderBytes) /
+                                      double(qMax<quint64>(1, recorder.recorded())),
+                                  0, 'f', 2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QString path = QDir::tempPath() + "/CaptureRecorderBenchmarks.mcap";
+
+    Preset preset;
+    preset.settings.voiceControlEnabled = true; // no command-note handling
+    MidiProcessor midi(preset);
+    MidiProcessorBenchAccess::attachDummyOutput(midi);
+    MidiProcessorBenchAccess::actAsWorker(midi);
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+
+    playback::ScaleSnapProcessor snap;
+    snap.setMidiProcessor(&midi); // registers as the inline guitar stage
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    snap.setHarmonyHumanizationEnabled(false);
+    snap.setLeadMode(playback::ScaleSnapProcessor::LeadMode::Conformed);
+    for (int i = 0; i < 4; ++i) {
+        playback::HarmonyVoiceConfig c;
+        c.motionType = (i < 2) ? playback::VoiceMotionType::PARALLEL_FIXED : playback::VoiceMotionType::OFF;
+        c.rangeMin = 40;
+        c.rangeMax = 88;
+        c.parallelInterval = (i % 2) ? -5 : 4;
+        snap.setVoiceConfig(i, c);
+    }
+    music::ChordSymbol chord;
+    music::parseChordSymbol("Bbmaj7", chord);
+    snap.setDefaultHarmonyChord(chord);
+
+    bench(midi, false, path);
+    bench(midi, true, path);
+    bench(midi, false, path);
+
+    // What the recording pass wrote, read back.
+    midi::MidiCapture capture;
+    QString error;
+    std::uint64_t dropped = 0;
+    if (midi::loadBinaryCapture(path, capture, &error, &dropped)) {
+        int in = 0;
+        for (const midi::CaptureEvent& ev : capture) in += midi::isCaptureInput(ev.port) ? 1 : 0;
+        qInfo().noquote() << QString("capture: %1 events (%2 in, %3 out), %4 dropped, %5 bytes/event")
+                                 .arg(capture.size())
+                                 .arg(in)
+                                 .arg(int(capture.size()) - in)
+                                 .arg(dropped)
+                                 .arg(double(QFile(path).size() - midi::kBinaryCaptureHeaderBytes) /
+                                          double(qMax<std::size_t>(1, capture.size())),
+                                      0, 'f', 2);
+    } else {
+        qWarning().noquote() << "capture:" << error;
+    }
+
+    benchRecordCall(path);
+    QFile::remove(path);
+    return 0;
+}
@@ -0,0 +1,118 @@
+// JointCandidateModel::chooseBestCombo benchmark: exhaustive scoring with the full
+// combo list materialized (explainability mode, the former default) vs the pruned
+// branch-and-bound search, at live (3x3x2), phrase-beam (2x2x2) and larger pools.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./ComboSearchBenchmarks > bench_output.txt
+
+#include "playback/JointCandidateModel.h"
+#include "music/ChordSymbol.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <chrono>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using playback::JointCandidateModel;
+
+struct Pool {
+    QVector<JointCandidateModel::BassCand> bass;
+    QVector<JointCandidateModel::PianoCand> piano;
+    QVector<JointCandidateModel::DrumCand> drums;
+};
+
+static Pool makePool(int nb, int np, int nd, quint32 seed) {
+    quint32 x = seed;
+    auto rnd = [&](int n) {
+        x = x * 1664525u + 1013904223u;
+        return int((x >> 8) % quint32(qMax(1, n)));
+    };
+    auto notes = [&](int lo, int hi, int count) {
+        QVector<virtuoso::engine::AgentIntentNote> out;
+        for (int i = 0; i < count; ++i) {
+            virtuoso::engine::AgentIntentNote n;
+            n.note = lo + rnd(hi - lo + 1);
+            n.startPos.barIndex = 0;
+            n.startPos.withinBarWhole = virtuoso::groove::Rational(rnd(8), 8);
+            out.push_back(n);
+        }
+        return out;
+    };
+    const QStringList ids = {"sparse", "base", "rich"};
+    Pool p;
+    for (int i = 0; i < nb; ++i) {
+        JointCandidateModel::BassCand c;
+        c.id = ids[i % ids.size()];
+        c.plan.notes = notes(28, 55, 1 + rnd(2));
+        p.bass.push_back(c);
+    }
+    for (int i = 0; i < np; ++i) {
+        JointCandidateModel::PianoCand c;
+        c.id = ids[i % ids.size()];
+        c.plan.notes = notes(52, 84, 2 + rnd(4));
+        c.pianistFeasibilityCost = 0.05 * rnd(6);
+        p.piano.push_back(c);
+    }
+    for (int i = 0; i < nd; ++i) {
+        JointCandidateModel::DrumCand c;
+        c.id = (i % 2) ? "wet" : "dry";
+        c.plan = notes(36, 51, 2 + rnd(3));
+        p.drums.push_back(c);
+    }
+    return p;
+}
+
+static void bench(int nb, int np, int nd, int calls) {
+    const Pool pool = makePool(nb, np, nd, 7u);
+    JointCandidateModel::ScoringInputs si;
+    music::parseChordSymbol("G7", si.chord);
+    si.userSilence = true;
+    si.lastBassId = "base";
+    si.lastPianoId = "base";
+    si.lastDrumsId = "dry";
+    si.weightsAvg.rhythm = 0.45;
+    si.weights = virtuoso::solver::weightsFromWeightsV2(si.weightsAvg);
+
+    JointCandidateModel::ScoringInputs full = si;
+    full.explainAllCombos = true;
+
+    for (int mode = 0; mode < 2; ++mode) {
+        const auto& in = (mode == 0) ? full : si;
+        qint64 evaluated = 0;
+        int checksum = 0;
+        const auto t0 = Clock::now();
+        for (int i = 0; i < calls; ++i) {
+            const auto best = JointCandidateModel::chooseBestCombo(in, pool.bass, pool.piano, pool.drums);
+            evaluated += best.evaluatedCombos;
+            checksum += best.bestBi * 10000 + best.bestPi * 100 + best.bestDi;
+        }
+        const auto t1 = Clock::now();
+        const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        qInfo().noquote() << QString("%1 %2x%3x%4: %5 us/call, %6 of %7 combos scored (checksum %8)")
+                                 .arg(mode == 0 ? "exhaustive" : "pruned    ")
+                                 .arg(nb, 2)
+                                 .arg(np, 2)
+                                 .arg(nd)
+                                 .arg(ns / 1000.0 / double(calls), 0, 'f', 2)
+                                 .arg(double(evaluated) / double(calls), 0, 'f', 1)
+                                 .arg(nb * np * nd)
+                                 .arg(checksum);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    bench(2, 2, 2, 20000);  // phrase beam node expansion
+    bench(3, 3, 2, 20000);  // live AgentCoordinator step
+    bench(3, 3, 3, 20000);
+    bench(8, 8, 4, 2000);
+    bench(16, 16, 6, 200);  // >= kParallelMinCombos: thread-pool path
+    return 0;
+}
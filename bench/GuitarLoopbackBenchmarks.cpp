@@ -0,0 +1,128 @@
+// Guitar -> ScaleSnap -> lead/harmony loopback benchmark: one worker pass from a guitar note
+// event to the last conformed lead/harmony message handed to the (dummy) MIDI output.
+//   signal: ScaleSnapProcessor direct-connected to guitarNoteOn/Off, its output queued on the
+//           virtual-band/scheduled rings and sent when the same pass drains them (former wiring)
+//   inline: ScaleSnapProcessor as the MidiProcessor's IGuitarStage, output sent in place
+// Both run on the calling thread standing in for the worker, so the difference is signal
+// dispatch plus the ring round-trip.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./GuitarLoopbackBenchmarks > bench_output.txt
+
+#include "playback/ScaleSnapProcessor.h"
+#include "playback/HarmonyContext.h"
+#include "midiprocessor.h"
+#include "music/ChordSymbol.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// Friend of MidiProcessor: feeds guitar events and runs the rest of a worker pass.
+struct MidiProcessorBenchAccess {
+    static void attachDummyOutput(MidiProcessor& p) {
+        if (!p.midiOut) {
+            p.midiOut = std::make_unique<midi::RtMidiOutputPort>(std::make_unique<RtMidiOut>(RtMidi::RTMIDI_DUMMY));
+        }
+    }
+    static void actAsWorker(MidiProcessor& p, bool worker) {
+        p.m_workerThreadId.store(worker ? std::this_thread::get_id() : std::thread::id());
+    }
+    static void guitarPass(MidiProcessor& p, const midi::MidiMsg& m) {
+        MidiProcessor::MidiEvent ev;
+        ev.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        ev.message = m;
+        ev.source = MidiProcessor::MidiSource::Guitar;
+        ev.programIndex = -1;
+        p.processMidiEvent(ev);
+        // Rest of the worker pass (workerLoop order).
+        p.drainScheduled(ev);
+        p.drainRing(p.m_virtualRing, MidiProcessor::MidiSource::VirtualBand, ev);
+    }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using playback::ScaleSnapProcessor;
+
+static void bench(MidiProcessor& midi, ScaleSnapProcessor& snap, bool inlineStage, int voices, int notes) {
+    for (int i = 0; i < 4; ++i) {
+        playback::HarmonyVoiceConfig c;
+        c.motionType = (i < voices) ? ((i % 2) ? playback::VoiceMotionType::SCALE_PARALLEL
+                                               : playback::VoiceMotionType::PARALLEL_FIXED)
+                                    : playback::VoiceMotionType::OFF;
+        c.rangeMin = 40;
+        c.rangeMax = 88;
+        c.parallelInterval = (i % 2) ? -5 : 4;
+        c.scaleStepOffset = (i % 2) ? -2 : 2;
+        snap.setVoiceConfig(i, c);
+    }
+
+    if (inlineStage) {
+        QObject::disconnect(&midi, &MidiProcessor::guitarNoteOn, &snap, &ScaleSnapProcessor::onGuitarNoteOn);
+        QObject::disconnect(&midi, &MidiProcessor::guitarNoteOff, &snap, &ScaleSnapProcessor::onGuitarNoteOff);
+        midi.setGuitarStage(&snap);
+    } else {
+        midi.setGuitarStage(nullptr);
+        QObject::connect(&midi, &MidiProcessor::guitarNoteOn, &snap, &ScaleSnapProcessor::onGuitarNoteOn,
+                         static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
+        QObject::connect(&midi, &MidiProcessor::guitarNoteOff, &snap, &ScaleSnapProcessor::onGuitarNoteOff,
+                         static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
+    }
+    MidiProcessorBenchAccess::actAsWorker(midi, inlineStage);
+
+    QVector<double> us;
+    us.reserve(notes);
+    for (int i = 0; i < notes; ++i) {
+        const int note = 52 + (i * 7) % 24;
+        const auto t0 = Clock::now();
+        MidiProcessorBenchAccess::guitarPass(midi, midi::MidiMsg::make(0x90, quint8(note), 90));
+        const auto t1 = Clock::now();
+        MidiProcessorBenchAccess::guitarPass(midi, midi::MidiMsg::make(0x80, quint8(note), 0));
+        us.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / 1000.0);
+    }
+    std::sort(us.begin(), us.end());
+    qInfo().noquote() << QString("%1 %2 voice(s): p50 %3 us, p99 %4 us, max %5 us")
+                             .arg(inlineStage ? "inline" : "signal")
+                             .arg(voices)
+                             .arg(us[us.size() / 2], 0, 'f', 2)
+                             .arg(us[int(us.size() * 0.99)], 0, 'f', 2)
+                             .arg(us.last(), 0, 'f', 2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    Preset preset;
+    preset.settings.voiceControlEnabled = true; // no command-note handling
+    MidiProcessor midi(preset);
+    MidiProcessorBenchAccess::attachDummyOutput(midi);
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+
+    ScaleSnapProcessor snap;
+    snap.setMidiProcessor(&midi);
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    snap.setHarmonyHumanizationEnabled(false); // harmony due immediately: same-pass send
+    snap.setLeadMode(ScaleSnapProcessor::LeadMode::Conformed);
+    music::ChordSymbol chord;
+    music::parseChordSymbol("Bbmaj7", chord);
+    snap.setDefaultHarmonyChord(chord);
+
+    for (int voices : {0, 2, 4}) {
+        bench(midi, snap, false, voices, 5000);
+        bench(midi, snap, true, voices, 5000);
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Microbenchmarks for the live MIDI path (callback -> worker -> output).
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./MidiPathBenchmarks > bench_output.txt
+
+#include "midi/SpscRing.h"
+#include "midi/MpscRing.h"
+#include "midi/WorkerWake.h"
+#include "bench/BenchReport.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+static qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Traffic shape: a steady ~100 Hz stream (voice CC2) interleaved with guitar
+// bursts of 16 back-to-back messages, which is what exposed the jitter.
+static constexpr int kEvents = 20000;
+static constexpr int kBurstEvery = 50;
+static constexpr int kBurstLen = 16;
+
+static void paceProducer(int i) {
+    if (i % kBurstEvery < kBurstLen) return; // burst: no gap
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+// --- Hop latency: mutex + std::deque + condition_variable, vector payload (previous design) ---
+struct LockedEvent {
+    std::vector<unsigned char> message;
+    qint64 sentNs = 0;
+};
+
+static void benchLockedDequeHop() {
+    std::deque<LockedEvent> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::vector<qint64> samples;
+    samples.reserve(kEvents);
+
+    std::thread consumer([&] {
+        for (;;) {
+            LockedEvent ev;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return !queue.empty() || done; });
+                if (queue.empty()) return;
+                ev = std::move(queue.front());
+                queue.pop_front();
+            }
+            samples.push_back(nowNs() - ev.sentNs);
+        }
+    });
+
+    std::vector<unsigned char> msg = {0x90, 60, 100};
+    for (int i = 0; i < kEvents; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back({msg, nowNs()});
+        }
+        cv.notify_one();
+        paceProducer(i);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    consumer.join();
+    reportPercentiles("hop mutex+deque+cv (vector)", samples);
+}
+
+// --- Hop latency: SPSC ring + WorkerWake, inline 3-byte payload ---
+struct InlineEvent {
+    unsigned char bytes[3];
+    unsigned char len;
+    qint64 sentNs;
+};
+
+static void benchSpscRingHop() {
+    midi::SpscRing<InlineEvent, 4096> ring;
+    midi::WorkerWake wake;
+    std::atomic<bool> done{false};
+    std::vector<qint64> samples;
+    samples.reserve(kEvents);
+
+    std::thread consumer([&] {
+        const auto hasWork = [&] { return !ring.empty() || done.load(); };
+        for (;;) {
+            wake.wait(hasWork);
+            InlineEvent ev;
+            bool any = false;
+            while (ring.pop(ev)) {
+                samples.push_back(nowNs() - ev.sentNs);
+                any = true;
+            }
+            if (!any && done.load()) return;
+        }
+    });
+
+    for (int i = 0; i < kEvents; ++i) {
+        const InlineEvent ev{{0x90, 60, 100}, 3, nowNs()};
+        while (!ring.push(ev)) std::this_thread::yield();
+        wake.notify();
+        paceProducer(i);
+    }
+    done.store(true);
+    wake.notify();
+    consumer.join();
+    reportPercentiles("hop spsc ring + wake (inline)", samples);
+}
+
+// --- Hop latency: MPSC ring with 3 producers (sendVirtual* path) ---
+static void benchMpscRingHop() {
+    midi::MpscRing<InlineEvent, 8192> ring;
+    midi::WorkerWake wake;
+    std::atomic<int> producersLeft{3};
+    std::vector<qint64> samples;
+    samples.reserve(kEvents * 3);
+
+    std::thread consumer([&] {
+        const auto hasWork = [&] { return !ring.empty() || producersLeft.load() == 0; };
+        for (;;) {
+            wake.wait(hasWork);
+            InlineEvent ev;
+            bool any = false;
+            while (ring.pop(ev)) {
+                samples.push_back(nowNs() - ev.sentNs);
+                any = true;
+            }
+            if (!any && producersLeft.load() == 0) return;
+        }
+    });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&] {
+            for (int i = 0; i < kEvents; ++i) {
+                const InlineEvent ev{{0x91, 48, 90}, 3, nowNs()};
+                while (!ring.push(ev)) std::this_thread::yield();
+                wake.notify();
+                paceProducer(i);
+            }
+            --producersLeft;
+            wake.notify();
+        });
+    }
+    for (auto& t : producers) t.join();
+    consumer.join();
+    reportPercentiles("hop mpsc ring x3 producers", samples);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    benchLockedDequeHop();
+    benchSpscRingHop();
+    benchMpscRingHop();
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Offline replay of a timestamped multi-port MIDI capture (guitar, voice amp, voice pitch,
+// Ampero, virtual band) through the full MidiProcessor worker + inline ScaleSnapProcessor
+// pipeline, on midi::MemoryMidiBackend ports: no MIDI hardware or CoreMIDI needed.
+// Each run replays the capture at 1x, 10x and max speed and reports throughput, the
+// per-path latency histograms (see MidiProcessor::latencyStats()), output message counts
+// and an output digest; a digest that differs from the 1x run flags timing-dependent
+// output. Without a capture file a synthetic 10 s performance is used.
+//   ./MidiReplayBenchmarks [capture.txt|capture.mcap] [--dump-out prefix]
+// (capture formats: midi/MidiCapture.h; a recorded .mcap also holds what was sent, which
+// replay skips. --dump-out writes each run's output as <prefix>-<speed>.txt.)
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./MidiReplayBenchmarks > bench_output.txt
+
+#include "playback/ScaleSnapProcessor.h"
+#include "playback/HarmonyContext.h"
+#include "midiprocessor.h"
+#include "midi/MemoryMidiBackend.h"
+#include "midi/MidiCapture.h"
+#include "music/ChordSymbol.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+// Friend of MidiProcessor: dropped-event counter.
+struct MidiProcessorBenchAccess {
+    static quint64 dropped(const MidiProcessor& p) { return p.m_droppedMidiEvents.load(); }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using midi::CaptureEvent;
+using midi::CapturePort;
+using midi::MemoryMidiBackend;
+using midi::MidiCapture;
+using midi::MidiMsg;
+
+const char* const kGuitarPort = "Replay Guitar";
+const char* const kVoiceAmpPort = "Replay Voice Amp";
+const char* const kVoicePitchPort = "Replay Voice Pitch";
+const char* const kAmperoPort = "Replay Ampero";
+const char* const kOutPort = "Replay Out";
+const char* const kVocalSyncPort = "VocalSync Out";
+
+// 10 s at 120 bpm: guitar eighths with bends, a sung line (voice pitch notes + 100 Hz
+// bend, 100 Hz breath aftertouch), an Ampero footswitch every 2 s and a bass + comp
+// virtual band on the beat.
+static MidiCapture syntheticCapture() {
+    MidiCapture c;
+    const auto add = [&c](std::int64_t tUs, CapturePort port, std::uint8_t st, std::uint8_t d1, std::uint8_t d2) {
+        CaptureEvent ev;
+        ev.tNs = tUs * 1000;
+        ev.port = port;
+        ev.msg = MidiMsg::make(st, d1, d2);
+        if ((st & 0xF0) == 0xD0) ev.msg.len = 2;
+        c.push_back(ev);
+    };
+    const std::int64_t kEighthUs = 250000;
+    for (std::int64_t t = 0; t < 10000000; t += 10000) { // 10 ms streams
+        const int step = int(t / 10000);
+        add(t, CapturePort::VoiceAmp, 0xD0, std::uint8_t(40 + (step % 60)), 0);
+        add(t + 5000, CapturePort::VoicePitch, 0xE0, 0, std::uint8_t(0x40 + (step % 8) - 4));
+        if (t % kEighthUs == 0) {
+            const int i = int(t / kEighthUs);
+            const std::uint8_t g = std::uint8_t(52 + (i * 7) % 24);
+            add(t + 1000, CapturePort::Guitar, 0x90, g, 96);
+            add(t + 120000, CapturePort::Guitar, 0xE0, 0, 0x48);
+            add(t + 200000, CapturePort::Guitar, 0xE0, 0, 0x40);
+            add(t + 230000, CapturePort::Guitar, 0x80, g, 0);
+            if (i % 2 == 0) {
+                const std::uint8_t v = std::uint8_t(60 + (i / 2) % 12);
+                add(t + 2000, CapturePort::VoicePitch, 0x90, v, 80);
+                add(t + 480000, CapturePort::VoicePitch, 0x80, v, 0);
+                const std::uint8_t bass = std::uint8_t(36 + (i / 2) % 12);
+                add(t + 3000, CapturePort::VirtualBand, 0x92, bass, 90);
+                add(t + 450000, CapturePort::VirtualBand, 0x82, bass, 0);
+                add(t + 3500, CapturePort::VirtualBand, 0x93, std::uint8_t(bass + 28), 70);
+                add(t + 300000, CapturePort::VirtualBand, 0x83, std::uint8_t(bass + 28), 0);
+            }
+            if (i % 8 == 0) add(t + 4000, CapturePort::Ampero, 0xB0, 27, std::uint8_t((i / 8) % 2 ? 127 : 0));
+        }
+    }
+    std::stable_sort(c.begin(), c.end(), [](const CaptureEvent& a, const CaptureEvent& b) { return a.tNs < b.tNs; });
+    return c;
+}
+
+static void deliverVirtual(MidiProcessor& midi, const MidiMsg& m) {
+    const int ch = m.channelNibble() + 1;
+    switch (m.type()) {
+    case 0x90:
+        if (m.data2() > 0) midi.sendVirtualNoteOn(ch, m.data1(), m.data2());
+        else midi.sendVirtualNoteOff(ch, m.data1());
+        break;
+    case 0x80: midi.sendVirtualNoteOff(ch, m.data1()); break;
+    case 0xB0: midi.sendVirtualCC(ch, m.data1(), m.data2()); break;
+    case 0xE0: midi.sendVirtualPitchBend(ch, int(m.data1()) | (int(m.data2()) << 7)); break;
+    default: break;
+    }
+}
+
+// FNV-1a over the output bytes in send order (times excluded).
+static quint64 digest(const MemoryMidiBackend::Output& out) {
+    quint64 h = 1469598103934665603ULL;
+    for (std::size_t i = 0; i < out.sentCount(); ++i) {
+        const MidiMsg& m = out.sent(i).msg;
+        for (std::size_t b = 0; b < m.size(); ++b) h = (h ^ m[b]) * 1099511628211ULL;
+        h = (h ^ 0xFF) * 1099511628211ULL;
+    }
+    return h;
+}
+
+// Waits until the worker has gone quiet (delayed harmony and legato releases flushed).
+static void waitForQuiet(const MemoryMidiBackend& backend) {
+    std::size_t last = ~std::size_t(0);
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        const std::size_t now = backend.output(kOutPort)->sentCount() + backend.output(kVocalSyncPort)->sentCount();
+        if (now == last) return;
+        last = now;
+    }
+}
+
+struct RunResult {
+    quint64 digest = 0;
+    std::size_t sent = 0;
+};
+
+static RunResult replay(MidiProcessor& midi, MemoryMidiBackend& backend, const MidiCapture& capture,
+                        double speed, const QString& dumpPrefix) {
+    MemoryMidiBackend::Output& out = *backend.output(kOutPort);
+    MemoryMidiBackend::Output& vocalSync = *backend.output(kVocalSyncPort);
+    out.clear();
+    vocalSync.clear();
+    midi.resetLatencyStats();
+    const quint64 droppedBefore = MidiProcessorBenchAccess::dropped(midi);
+
+    MemoryMidiBackend::Input* inputs[] = {backend.input(kGuitarPort), backend.input(kVoiceAmpPort),
+                                          backend.input(kVoicePitchPort), backend.input(kAmperoPort)};
+    const auto t0 = Clock::now();
+    for (const CaptureEvent& ev : capture) {
+        if (speed > 0.0) {
+            std::this_thread::sleep_until(t0 + std::chrono::nanoseconds(std::int64_t(double(ev.tNs) / speed)));
+        }
+        if (ev.port == CapturePort::VirtualBand) deliverVirtual(midi, ev.msg);
+        else inputs[int(ev.port)]->deliver(ev.msg);
+    }
+    const double feedSec = std::chrono::duration<double>(Clock::now() - t0).count();
+    waitForQuiet(backend);
+
+    const QString label = speed > 0.0 ? QString("%1x").arg(speed) : QString("max");
+    qInfo().noquote() << QString("%1: %2 events fed in %3 s (%4 events/s), %5 sent + %6 VocalSync, %7 dropped, digest %8")
+                             .arg(label, -4)
+                             .arg(capture.size())
+                             .arg(feedSec, 0, 'f', 3)
+                             .arg(double(capture.size()) / feedSec, 0, 'f', 0)
+                             .arg(out.sentCount())
+                             .arg(vocalSync.sentCount())
+                             .arg(MidiProcessorBenchAccess::dropped(midi) - droppedBefore + out.dropped())
+                             .arg(digest(out), 16, 16, QChar('0'));
+    for (const QString& line : midi.latencyStats().summaryLines()) qInfo().noquote() << "      " + line;
+
+    if (!dumpPrefix.isEmpty()) {
+        MidiCapture sent;
+        const std::int64_t base = out.sentCount() ? out.sent(0).tNs : 0;
+        for (std::size_t i = 0; i < out.sentCount(); ++i) {
+            CaptureEvent ev;
+            ev.tNs = out.sent(i).tNs - base;
+            ev.port = CapturePort::Out;
+            ev.msg = out.sent(i).msg;
+            sent.push_back(ev);
+        }
+        midi::saveTextCapture(QString("%1-%2.txt").arg(dumpPrefix, label), sent);
+    }
+    return {digest(out), out.sentCount()};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    QString dumpPrefix;
+    MidiCapture capture;
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--dump-out" && i + 1 < args.size()) {
+            dumpPrefix = args[++i];
+        } else {
+            QString error;
+            if (!midi::loadCapture(args[i], capture, &error)) {
+                qWarning().noquote() << "capture:" << error;
+                return 1;
+            }
+        }
+    }
+    // A recorded capture also logs what was sent; only the inputs are replayed.
+    capture.erase(std::remove_if(capture.begin(), capture.end(),
+                                 [](const CaptureEvent& ev) { return !midi::isCaptureInput(ev.port); }),
+                  capture.end());
+    if (capture.empty()) capture = syntheticCapture();
+
+    MemoryMidiBackend backend;
+    backend.addInput(kGuitarPort);
+    backend.addInput(kVoiceAmpPort);
+    backend.addInput(kVoicePitchPort);
+    backend.addInput(kAmperoPort);
+    backend.addOutput(kOutPort);
+    backend.addOutput(kVocalSyncPort);
+
+    Preset preset;
+    preset.settings.voiceControlEnabled = true; // no command-note handling
+    preset.settings.ports["GUITAR_IN"] = kGuitarPort;
+    preset.settings.ports["VOICE_IN"] = kVoiceAmpPort;
+    preset.settings.ports["VOICE_PITCH_IN"] = kVoicePitchPort;
+    preset.settings.ports["AMPERO_IN"] = kAmperoPort;
+    preset.settings.ports["CONTROLLER_OUT"] = kOutPort;
+    MidiProcessor midi(preset);
+    if (!midi.initialize(backend)) {
+        qWarning() << "MidiProcessor failed to open the in-memory ports";
+        return 1;
+    }
+
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+    playback::ScaleSnapProcessor snap;
+    snap.setMidiProcessor(&midi); // inline guitar stage on the worker
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    snap.setHarmonyHumanizationEnabled(false); // keeps the output comparable across speeds
+    snap.setLeadMode(playback::ScaleSnapProcessor::LeadMode::Conformed);
+    for (int i = 0; i < 4; ++i) {
+        playback::HarmonyVoiceConfig c;
+        c.motionType = (i < 2) ? playback::VoiceMotionType::PARALLEL_FIXED : playback::VoiceMotionType::OFF;
+        c.rangeMin = 40;
+        c.rangeMax = 88;
+        c.parallelInterval = (i % 2) ? -5 : 4;
+        snap.setVoiceConfig(i, c);
+    }
+    music::ChordSymbol chord;
+    music::parseChordSymbol("Bbmaj7", chord);
+    snap.setDefaultHarmonyChord(chord);
+    midi.setVoiceCh10ScaleMask(0x0AB5); // Bb major
+
+    qInfo().noquote() << QString("capture: %1 events over %2 s").arg(capture.size())
+                             .arg(capture.empty() ? 0.0 : double(capture.back().tNs) / 1e9, 0, 'f', 2);
+    const RunResult reference = replay(midi, backend, capture, 1.0, dumpPrefix);
+    for (double speed : {10.0, 0.0}) {
+        const RunResult r = replay(midi, backend, capture, speed, dumpPrefix);
+        qInfo().noquote() << QString("      output %1 the 1x run (%2 vs %3 messages)")
+                                 .arg(r.digest == reference.digest ? "matches" : "DIFFERS from")
+                                 .arg(r.sent)
+                                 .arg(reference.sent);
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// ScaleSnapProcessor per-note state benchmark: guitar note-on/off latency while voice Hz
+// (100 Hz) and the 10 ms conformance tick also walk the table.
+//   locked: QHash<int, ActiveNote> behind a recursive QReadWriteLock, guitar on the MIDI
+//           worker, voice Hz + tick on a second (UI) thread (the former layout)
+//   owned:  NoteSlotTable<ActiveNote> owned by the worker, which also runs voice Hz + tick
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./NoteTableBenchmarks > bench_output.txt
+
+#include "playback/NoteSlotTable.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Same shape and size class as ScaleSnapProcessor::ActiveNote.
+struct ActiveNote {
+    int originalNote = 0;
+    int snappedNote = 0;
+    int harmonyNote = -1;
+    std::array<int, 4> harmonyNotes = {-1, -1, -1, -1};
+    double referenceHz = 0.0;
+    bool voiceSustained = false;
+    int velocity = 64;
+    float conformanceBendTarget = 0.0f;
+    float conformanceBendCurrent = 0.0f;
+    bool isDelayed = false;
+    float delayRemainingMs = 0.0f;
+    float timedBendElapsedMs = 0.0f;
+};
+
+constexpr int kNotes = 20000;
+constexpr auto kNotePeriod = std::chrono::microseconds(500); // fast picking, up to 3 notes held
+
+// Work the handlers do per visit, roughly.
+template <typename Table>
+static void noteOn(Table& t, int note) {
+    ActiveNote a;
+    a.originalNote = note;
+    a.snappedNote = note + 1;
+    a.referenceHz = 440.0;
+    for (auto it = t.begin(); it != t.end(); ++it) it.value().voiceSustained = false;
+    t.insert(note, a);
+}
+template <typename Table>
+static void voiceHz(Table& t, double hz) {
+    for (auto it = t.begin(); it != t.end(); ++it) it.value().conformanceBendTarget = float(hz - it.value().referenceHz);
+}
+template <typename Table>
+static void tick(Table& t) {
+    for (auto it = t.begin(); it != t.end(); ++it) {
+        ActiveNote& n = it.value();
+        n.conformanceBendCurrent += 0.1f * (n.conformanceBendTarget - n.conformanceBendCurrent);
+        n.timedBendElapsedMs += 10.0f;
+    }
+}
+
+static void report(const char* label, QVector<double>& us) {
+    std::sort(us.begin(), us.end());
+    qInfo().noquote() << QString("%1: note-on p50 %2 us, p99 %3 us, p99.9 %4 us, max %5 us")
+                             .arg(label)
+                             .arg(us[us.size() / 2], 0, 'f', 3)
+                             .arg(us[int(us.size() * 0.99)], 0, 'f', 3)
+                             .arg(us[int(us.size() * 0.999)], 0, 'f', 3)
+                             .arg(us.last(), 0, 'f', 3);
+}
+
+static double elapsedUs(Clock::time_point t0, Clock::time_point t1) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / 1000.0;
+}
+
+static void benchLocked() {
+    QHash<int, ActiveNote> notes;
+    QReadWriteLock lock(QReadWriteLock::Recursive);
+    std::atomic<bool> done{false};
+
+    std::thread ui([&] {
+        auto next = Clock::now();
+        while (!done.load()) {
+            next += std::chrono::milliseconds(10);
+            {
+                QReadLocker r(&lock);
+                voiceHz(notes, 441.0);
+            }
+            {
+                QWriteLocker w(&lock);
+                tick(notes);
+            }
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    QVector<double> us;
+    us.reserve(kNotes);
+    auto next = Clock::now();
+    for (int i = 0; i < kNotes; ++i) {
+        next += kNotePeriod;
+        const int note = 40 + (i * 7) % 48;
+        const auto t0 = Clock::now();
+        {
+            QWriteLocker w(&lock);
+            noteOn(notes, note);
+            if (notes.size() > 3) notes.erase(notes.begin());
+        }
+        us.push_back(elapsedUs(t0, Clock::now()));
+        std::this_thread::sleep_until(next);
+    }
+    done.store(true);
+    ui.join();
+    report("locked", us);
+}
+
+static void benchOwned() {
+    playback::NoteSlotTable<ActiveNote> notes;
+    QVector<double> us;
+    us.reserve(kNotes);
+    auto next = Clock::now();
+    auto nextTick = next;
+    for (int i = 0; i < kNotes; ++i) {
+        next += kNotePeriod;
+        const int note = 40 + (i * 7) % 48;
+        const auto t0 = Clock::now();
+        noteOn(notes, note);
+        if (notes.size() > 3) notes.erase(notes.begin());
+        us.push_back(elapsedUs(t0, Clock::now()));
+        // Voice Hz and the tick run on the same thread between guitar events.
+        if (Clock::now() >= nextTick) {
+            nextTick += std::chrono::milliseconds(10);
+            voiceHz(notes, 441.0);
+            tick(notes);
+        }
+        std::this_thread::sleep_until(next);
+    }
+    report("owned ", us);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    benchLocked();
+    benchOwned();
+    return 0;
+}
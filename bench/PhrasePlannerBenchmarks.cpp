@@ -0,0 +1,229 @@
+// Beam-search benchmark for JointPhrasePlanner: cost of forking beam nodes with the
+// former flat JazzBalladPianoPlanner::PlannerState + copied choice history vs the
+// shared-substate PlannerState + persistent choice list, and JointPhrasePlanner::plan
+// end to end (wall time and heap allocations per call).
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./PhrasePlannerBenchmarks > bench_output.txt
+
+#include "playback/BrushesBalladDrummer.h"
+#include "playback/HarmonyContext.h"
+#include "playback/InteractionContext.h"
+#include "playback/JazzBalladBassPlanner.h"
+#include "playback/JazzBalladPianoPlanner.h"
+#include "playback/JointPhrasePlanner.h"
+#include "playback/StoryState.h"
+#include "virtuoso/engine/VirtuosoEngine.h"
+#include "virtuoso/memory/MotivicMemory.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+// Counts every heap allocation in the process (Qt containers included).
+static std::atomic<quint64> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using playback::JazzBalladPianoPlanner;
+using playback::StoryState;
+
+// Mirrors the old PlannerState: every field inline, containers copied (refcounted) per fork.
+struct FlatPianoState : JazzBalladPianoPlanner::StateCore, JazzBalladPianoPlanner::StateShared {};
+
+// Mirrors the old BeamNode: flat states + the whole choice history by value.
+struct LegacyNode {
+    double cost = 0.0;
+    playback::JazzBalladBassPlanner::PlannerState bassState;
+    FlatPianoState pianoState;
+    QVector<StoryState::JointStepChoice> choices;
+};
+
+struct ChoiceLink {
+    StoryState::JointStepChoice choice;
+    std::shared_ptr<const ChoiceLink> prev;
+};
+
+// Mirrors the new BeamNode.
+struct SharedNode {
+    double cost = 0.0;
+    playback::JazzBalladBassPlanner::PlannerState bassState;
+    JazzBalladPianoPlanner::PlannerState pianoState;
+    std::shared_ptr<const ChoiceLink> choices;
+};
+
+static chart::ChartModel makeChart() {
+    const QStringList cells = {"Dm7", "", "G7", "", "Cmaj7", "", "A7", "",
+                               "Dm7", "", "G7", "", "Em7", "", "A7", "",
+                               "Fmaj7", "", "Bb7", "", "Em7", "", "A7", "",
+                               "Dm7", "", "G7", "", "Cmaj7", "", "", ""};
+    chart::ChartModel m;
+    chart::Line line;
+    for (int b = 0; b < cells.size() / 4; ++b) {
+        chart::Bar bar;
+        bar.cells.resize(4);
+        for (int c = 0; c < 4; ++c) bar.cells[c].chord = cells[b * 4 + c];
+        line.bars.push_back(bar);
+    }
+    m.lines.push_back(line);
+    m.timeSigNum = 4;
+    m.timeSigDen = 4;
+    return m;
+}
+
+// Beam bookkeeping only (no planning): `steps` steps, each node expands into 4 children, keep `width`.
+template <typename Node, typename Fork>
+static void benchFork(const char* label, const Node& root, int width, int steps, Fork fork) {
+    const quint64 a0 = g_allocs.load();
+    const auto t0 = Clock::now();
+    QVector<Node> beam;
+    beam.push_back(root);
+    qint64 forks = 0;
+    for (int si = 0; si < steps; ++si) {
+        QVector<Node> next;
+        next.reserve(beam.size() * 4);
+        for (const Node& n : beam) {
+            for (int k = 0; k < 4; ++k) {
+                next.push_back(fork(n, si, k));
+                ++forks;
+            }
+        }
+        if (next.size() > width) next.resize(width);
+        beam = std::move(next);
+    }
+    const auto t1 = Clock::now();
+    const quint64 allocs = g_allocs.load() - a0;
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    qInfo().noquote() << QString("%1 beam=%2: %3 ns/fork, %4 allocs/fork")
+                             .arg(label)
+                             .arg(width, 2)
+                             .arg(ns / double(qMax<qint64>(1, forks)), 0, 'f', 1)
+                             .arg(double(allocs) / double(qMax<qint64>(1, forks)), 0, 'f', 2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    using namespace playback;
+
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    const chart::ChartModel model = makeChart();
+    QVector<int> sequence;
+    for (int i = 0; i < 32; ++i) sequence << i;
+
+    HarmonyContext harmony;
+    harmony.setOntology(&ont);
+    harmony.rebuildFromModel(model);
+    InteractionContext interaction;
+    JazzBalladBassPlanner bassPlanner;
+    JazzBalladPianoPlanner pianoPlanner;
+    pianoPlanner.setOntology(&ont);
+    BrushesBalladDrummer drummer;
+    virtuoso::memory::MotivicMemory mem;
+    StoryState story;
+    virtuoso::engine::VirtuosoEngine engine;
+
+    AgentCoordinator::Inputs in;
+    in.model = &model;
+    in.sequence = &sequence;
+    in.bpm = 60;
+    in.stylePresetKey = "jazz_brushes_ballad_60_evans";
+    in.debugEnergyAuto = false;
+    in.debugEnergy = 0.45;
+    in.harmony = &harmony;
+    in.interaction = &interaction;
+    in.engine = &engine;
+    in.ontology = &ont;
+    in.bassPlanner = &bassPlanner;
+    in.pianoPlanner = &pianoPlanner;
+    in.drummer = &drummer;
+    in.motivicMemory = &mem;
+    in.story = &story;
+
+    // Realistic mid-song states and one planned step to fork from.
+    JointPhrasePlanner::Inputs warm;
+    warm.in = in;
+    warm.steps = 8;
+    warm.beamWidth = 2;
+    const auto warmPlan = JointPhrasePlanner::plan(warm);
+    if (warmPlan.isEmpty()) {
+        qWarning() << "PhrasePlannerBenchmarks: planner produced no steps";
+        return 1;
+    }
+    const StoryState::JointStepChoice sample = warmPlan.last();
+    pianoPlanner.restoreState(sample.pianoStateAfter);
+    bassPlanner.restoreState(sample.bassStateAfter);
+
+    const int kSteps = 32;
+    for (int width : {6, 12}) {
+        LegacyNode legacy;
+        legacy.bassState = sample.bassStateAfter;
+        static_cast<JazzBalladPianoPlanner::StateCore&>(legacy.pianoState) = sample.pianoStateAfter.core;
+        static_cast<JazzBalladPianoPlanner::StateShared&>(legacy.pianoState) = sample.pianoStateAfter.sub();
+        benchFork("fork legacy (flat state, copied history) ", legacy, width, kSteps,
+                  [&](const LegacyNode& n, int, int k) {
+                      LegacyNode nn = n;
+                      nn.cost += k;
+                      nn.pianoState = legacy.pianoState;
+                      nn.choices.push_back(sample);
+                      return nn;
+                  });
+
+        SharedNode shared;
+        shared.bassState = sample.bassStateAfter;
+        shared.pianoState = sample.pianoStateAfter;
+        benchFork("fork shared (POD core, persistent history)", shared, width, kSteps,
+                  [&](const SharedNode& n, int, int k) {
+                      SharedNode nn = n;
+                      nn.cost += k;
+                      nn.pianoState = shared.pianoState;
+                      auto link = std::make_shared<ChoiceLink>();
+                      link->choice = sample;
+                      link->prev = n.choices;
+                      nn.choices = std::move(link);
+                      return nn;
+                  });
+    }
+
+    // End to end: one 8-bar phrase plan per call.
+    for (int width : {6, 12}) {
+        JointPhrasePlanner::Inputs p;
+        p.in = in;
+        p.startStep = 0;
+        p.steps = kSteps;
+        p.beamWidth = width;
+        const int kRuns = 5;
+        JointPhrasePlanner::plan(p); // warm caches
+        const quint64 a0 = g_allocs.load();
+        const auto t0 = Clock::now();
+        int checksum = 0;
+        for (int r = 0; r < kRuns; ++r) checksum += JointPhrasePlanner::plan(p).size();
+        const auto t1 = Clock::now();
+        const double ms = double(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()) / 1000.0;
+        qInfo().noquote() << QString("JointPhrasePlanner::plan beam=%1 steps=%2: %3 ms/call, %4 allocs/call (checksum %5)")
+                                 .arg(width, 2)
+                                 .arg(kSteps)
+                                 .arg(ms / kRuns, 0, 'f', 2)
+                                 .arg(double(g_allocs.load() - a0) / kRuns, 0, 'f', 0)
+                                 .arg(checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// ScaleSnapProcessor note-on benchmark: guitar note-on -> lead + harmony emit latency with
+// the chord/scale context re-derived on every attack (the former behaviour, emulated by
+// forcing a snapshot rebuild before each note) vs read from the chord-change snapshot.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./ScaleSnapBenchmarks > bench_output.txt
+
+#include "playback/ScaleSnapProcessor.h"
+#include "playback/HarmonyContext.h"
+#include "midiprocessor.h"
+#include "music/ChordSymbol.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using playback::ScaleSnapProcessor;
+
+struct Voicing {
+    const char* label;
+    playback::VoiceMotionType types[4];
+};
+
+static void bench(ScaleSnapProcessor& snap, const music::ChordSymbol& chord, const Voicing& v,
+                  bool rebuildPerNote, int notes) {
+    for (int i = 0; i < 4; ++i) {
+        playback::HarmonyVoiceConfig c;
+        c.motionType = v.types[i];
+        c.rangeMin = 40;
+        c.rangeMax = 88;
+        c.parallelInterval = (i % 2) ? -5 : 4;
+        c.scaleStepOffset = (i % 2) ? -2 : 2;
+        snap.setVoiceConfig(i, c);
+    }
+
+    QVector<double> us;
+    us.reserve(notes);
+    for (int i = 0; i < notes; ++i) {
+        const int note = 52 + (i * 7) % 24;
+        const auto t0 = Clock::now();
+        if (rebuildPerNote) snap.setDefaultHarmonyChord(chord); // re-derive context, as every attack used to
+        snap.onGuitarNoteOn(note, 90);
+        const auto t1 = Clock::now();
+        snap.onGuitarNoteOff(note);
+        us.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / 1000.0);
+    }
+    std::sort(us.begin(), us.end());
+    qInfo().noquote() << QString("%1 %2: p50 %3 us, p99 %4 us, max %5 us")
+                             .arg(rebuildPerNote ? "per-attack" : "snapshot  ")
+                             .arg(v.label)
+                             .arg(us[us.size() / 2], 0, 'f', 2)
+                             .arg(us[int(us.size() * 0.99)], 0, 'f', 2)
+                             .arg(us.last(), 0, 'f', 2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    using playback::VoiceMotionType;
+
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor midi(preset);
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+
+    ScaleSnapProcessor snap;
+    snap.setMidiProcessor(&midi);
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    snap.setHarmonyHumanizationEnabled(false); // no humanization delay on harmony emits
+    snap.setLeadMode(ScaleSnapProcessor::LeadMode::Conformed);
+    music::ChordSymbol chord;
+    music::parseChordSymbol("Bbmaj7", chord);
+    snap.setDefaultHarmonyChord(chord);
+
+    const Voicing voicings[] = {
+        {"fixed+scale x4   ", {VoiceMotionType::PARALLEL_FIXED, VoiceMotionType::SCALE_PARALLEL,
+                               VoiceMotionType::PARALLEL_FIXED, VoiceMotionType::SCALE_PARALLEL}},
+        {"drone+fixed x2   ", {VoiceMotionType::DRONE, VoiceMotionType::PARALLEL_FIXED,
+                               VoiceMotionType::OFF, VoiceMotionType::OFF}},
+        {"parallel+contrary", {VoiceMotionType::PARALLEL, VoiceMotionType::CONTRARY,
+                               VoiceMotionType::OFF, VoiceMotionType::OFF}},
+    };
+    for (const Voicing& v : voicings) {
+        bench(snap, chord, v, true, 5000);
+        bench(snap, chord, v, false, 5000);
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Dispatch-accuracy benchmark for VirtuosoScheduler: QTimer mode vs the
+// realtime dispatch thread, with the GUI thread under synthetic load.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./SchedulerBenchmarks > bench_output.txt
+
+#include "virtuoso/engine/IMidiOutputSink.h"
+#include "virtuoso/engine/VirtuosoClock.h"
+#include "virtuoso/engine/VirtuosoScheduler.h"
+#include "bench/BenchReport.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QString>
+#include <QTimer>
+#include <QtGlobal>
+
+#include <atomic>
+#include <vector>
+
+using virtuoso::engine::IMidiOutputSink;
+using virtuoso::engine::VirtuosoClock;
+using virtuoso::engine::VirtuosoScheduler;
+
+namespace {
+
+// Pattern: 2000 notes, 5 ms apart with a 0/1/2 ms swing offset, scheduled up
+// front. Events fire in due order, so deviation is measured against a FIFO of
+// due times.
+static constexpr int kNotes = 2000;
+static constexpr qint64 kLeadMs = 50;
+
+// GUI load: every 16 ms the event loop is blocked for 8 ms (a heavy repaint).
+static constexpr int kLoadPeriodMs = 16;
+static constexpr qint64 kLoadBusyNs = 8000000;
+
+struct DeviationLog {
+    std::vector<qint64> dueNs;
+    std::vector<qint64> deviationNs;
+    std::atomic<int> received{0};
+
+    void record(qint64 nowNs) {
+        const int k = received.load(std::memory_order_relaxed);
+        if (k >= int(dueNs.size())) return;
+        deviationNs[size_t(k)] = nowNs - dueNs[size_t(k)];
+        received.store(k + 1, std::memory_order_release);
+    }
+};
+
+class RecordingSink final : public IMidiOutputSink {
+public:
+    RecordingSink(const VirtuosoClock* clock, DeviationLog* log) : m_clock(clock), m_log(log) {}
+    void sendNoteOn(int, int, int) override { m_log->record(m_clock->elapsedNs()); }
+    void sendNoteOff(int, int) override {}
+    void sendAllNotesOff(int) override {}
+    void sendCC(int, int, int) override {}
+
+private:
+    const VirtuosoClock* m_clock;
+    DeviationLog* m_log;
+};
+
+static void report(const QString& name, std::vector<qint64> samplesNs) {
+    reportPercentiles(name, samplesNs);
+    if (samplesNs.empty()) return;
+
+    // Histogram of |actual - due|.
+    static const qint64 edgesUs[] = {100, 250, 500, 1000, 2000, 5000, 10000};
+    int counts[8] = {};
+    for (qint64 s : samplesNs) {
+        const qint64 us = qAbs(s) / 1000;
+        int b = 0;
+        while (b < 7 && us >= edgesUs[b]) ++b;
+        ++counts[b];
+    }
+    QString hist = "    |dev|";
+    qint64 lo = 0;
+    for (int b = 0; b < 8; ++b) {
+        const QString range = (b < 7) ? QString("%1-%2us").arg(lo).arg(edgesUs[b]) : QString(">=%1us").arg(lo);
+        hist += QString(" %1:%2").arg(range).arg(counts[b]);
+        if (b < 7) lo = edgesUs[b];
+    }
+    qInfo().noquote() << hist;
+}
+
+static void runMode(const QString& name, bool realtime) {
+    VirtuosoClock clock;
+    VirtuosoScheduler sched(&clock);
+    DeviationLog log;
+    log.dueNs.reserve(kNotes);
+    log.deviationNs.assign(kNotes, 0);
+    RecordingSink sink(&clock, &log);
+
+    if (realtime) {
+        sched.setRealtimeSink(&sink);
+    } else {
+        QObject::connect(&sched, &VirtuosoScheduler::noteOn, [&](int, int, int) { log.record(clock.elapsedNs()); });
+    }
+
+    QTimer load;
+    load.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&load, &QTimer::timeout, [&] {
+        const qint64 until = VirtuosoClock::monotonicNowNs() + kLoadBusyNs;
+        while (VirtuosoClock::monotonicNowNs() < until) {
+        }
+    });
+
+    clock.start();
+    for (int i = 0; i < kNotes; ++i) {
+        VirtuosoScheduler::ScheduledEvent ev;
+        ev.dueMs = kLeadMs + qint64(i) * 5 + (i % 3);
+        ev.kind = VirtuosoScheduler::Kind::NoteOn;
+        ev.channel = 1;
+        ev.note = 60;
+        ev.velocity = 90;
+        ev.noteId = quint32(i + 1);
+        log.dueNs.push_back(ev.dueMs * 1000000);
+        sched.schedule(ev);
+    }
+    load.start(kLoadPeriodMs);
+
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, [&] {
+        if (log.received.load(std::memory_order_acquire) >= kNotes) loop.quit();
+    });
+    poll.start(20);
+    QTimer::singleShot(int(kLeadMs + kNotes * 5 + 2000), &loop, &QEventLoop::quit);
+    loop.exec();
+    load.stop();
+    sched.setRealtimeSink(nullptr);
+    clock.stop();
+
+    const int n = log.received.load(std::memory_order_acquire);
+    report(name, std::vector<qint64>(log.deviationNs.begin(), log.deviationNs.begin() + n));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    runMode("dispatch qtimer (gui load)", false);
+    runMode("dispatch realtime (gui load)", true);
+    return 0;
+}
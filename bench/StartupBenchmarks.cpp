@@ -0,0 +1,173 @@
+// Registry startup cost: what the playback engine and the library/groove windows build at
+// launch, the current way vs from the precompiled registry bundle (virtuoso/util/RegistryBundle.h)
+//   ontology:     OntologyRegistry::builtins()           vs fromBundle()
+//   groove:       GrooveRegistry::builtins()             vs fromBundle()
+//   vocabulary:   loadFromResourcePath() (JSON parse)    vs loadFromBundle()
+//   chord-scale:  ChordScaleTable::initialize()          vs initializeFromBundle()
+//   bundle open:  map + checksum + string table, paid once per process
+// The bundle is compiled here the way tools/BuildRegistryBundle does and written to a
+// temporary file. Each row is the median of several cold loads, with allocations per load.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./StartupBenchmarks [cool_jazz_vocabulary.json] > bench_output.txt
+
+#include "playback/ChordScaleTable.h"
+#include "virtuoso/groove/GrooveRegistry.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+#include "virtuoso/util/RegistryBundle.h"
+#include "virtuoso/vocab/VocabularyRegistry.h"
+#include "bench/AllocCounter.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+
+// Friend of ChordScaleTable: drops the table so each round initializes cold.
+namespace playback {
+struct ChordScaleTableBenchAccess {
+    static void reset() { delete ChordScaleTable::s_table.exchange(nullptr); }
+};
+} // namespace playback
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using virtuoso::util::RegistryBundle;
+
+struct Sample {
+    double us = 0.0;
+    double allocs = 0.0;
+};
+
+// Median time of rounds calls to fn, with its allocation count per call. prepare() runs
+// before each call, untimed.
+template <typename Prepare, typename Fn>
+static Sample measure(int rounds, const Prepare& prepare, const Fn& fn) {
+    QVector<double> us;
+    us.reserve(rounds);
+    long long allocs = 0;
+    for (int i = 0; i < rounds; ++i) {
+        prepare();
+        beginAllocCount();
+        const auto t0 = Clock::now();
+        fn();
+        const auto t1 = Clock::now();
+        allocs += endAllocCount();
+        us.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / 1000.0);
+    }
+    std::sort(us.begin(), us.end());
+    return {us[us.size() / 2], double(allocs) / rounds};
+}
+
+static void report(const char* label, const Sample& current, const Sample& bundle) {
+    qInfo().noquote() << QString("%1 current %2 us (%3 allocs)   bundle %4 us (%5 allocs)   x%6")
+                             .arg(QString::fromLatin1(label), -12)
+                             .arg(current.us, 9, 'f', 1)
+                             .arg(current.allocs, 7, 'f', 0)
+                             .arg(bundle.us, 8, 'f', 1)
+                             .arg(bundle.allocs, 6, 'f', 0)
+                             .arg(current.us / qMax(0.001, bundle.us), 0, 'f', 1);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const QString vocabPath = args.size() > 1 ? args[1] : QString("../virtuoso/vocab/cool_jazz_vocabulary.json");
+
+    // Compile the bundle (tools/BuildRegistryBundle).
+    QString error;
+    const auto ontology = virtuoso::ontology::OntologyRegistry::builtins();
+    const auto groove = virtuoso::groove::GrooveRegistry::builtins();
+    virtuoso::vocab::VocabularyRegistry vocab;
+    if (!vocab.loadFromResourcePath(vocabPath, &error)) {
+        qWarning().noquote() << error;
+        return 1;
+    }
+    playback::ChordScaleTable::initialize(ontology);
+    virtuoso::util::BundleWriter w;
+    ontology.writeBundle(w);
+    groove.writeBundle(w);
+    vocab.writeBundle(w);
+    playback::ChordScaleTable::writeBundle(w);
+    const QByteArray bytes = w.finish();
+
+    const QString bundlePath = QDir::tempPath() + "/StartupBenchmarks.vrb";
+    {
+        QFile f(bundlePath);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(bytes) != bytes.size()) {
+            qWarning().noquote() << "cannot write" << bundlePath;
+            return 1;
+        }
+    }
+    auto bundle = RegistryBundle::open(bundlePath, &error);
+    if (!bundle) {
+        qWarning().noquote() << error;
+        return 1;
+    }
+    qInfo().noquote() << QString("bundle: %1 bytes, %2 interned strings, format %3")
+                             .arg(bytes.size())
+                             .arg(bundle->stringCount())
+                             .arg(RegistryBundle::kFormatVersion);
+
+    constexpr int kRounds = 15;
+    constexpr int kTableRounds = 5;
+    const auto none = [] {};
+    bool ok = true;
+
+    const Sample open = measure(kRounds, none, [&] { ok &= RegistryBundle::open(bundlePath) != nullptr; });
+
+    virtuoso::ontology::OntologyRegistry ontologyOut;
+    const Sample ontologyCurrent = measure(kRounds, none, [&] { ontologyOut = virtuoso::ontology::OntologyRegistry::builtins(); });
+    const Sample ontologyBundle = measure(kRounds, none, [&] {
+        ok &= virtuoso::ontology::OntologyRegistry::fromBundle(*bundle, ontologyOut);
+    });
+
+    virtuoso::groove::GrooveRegistry grooveOut;
+    const Sample grooveCurrent = measure(kRounds, none, [&] { grooveOut = virtuoso::groove::GrooveRegistry::builtins(); });
+    const Sample grooveBundle = measure(kRounds, none, [&] {
+        ok &= virtuoso::groove::GrooveRegistry::fromBundle(*bundle, grooveOut);
+    });
+
+    virtuoso::vocab::VocabularyRegistry vocabOut;
+    const Sample vocabCurrent = measure(kRounds, none, [&] { ok &= vocabOut.loadFromResourcePath(vocabPath); });
+    const Sample vocabBundle = measure(kRounds, none, [&] { ok &= vocabOut.loadFromBundle(*bundle); });
+
+    const Sample tableCurrent = measure(kTableRounds, playback::ChordScaleTableBenchAccess::reset, [&] {
+        playback::ChordScaleTable::initialize(ontology);
+    });
+    const Sample tableBundle = measure(kTableRounds, playback::ChordScaleTableBenchAccess::reset, [&] {
+        ok &= playback::ChordScaleTable::initializeFromBundle(*bundle);
+    });
+
+    if (!ok) {
+        qWarning().noquote() << "a bundle load failed";
+        return 1;
+    }
+
+    report("ontology", ontologyCurrent, ontologyBundle);
+    report("groove", grooveCurrent, grooveBundle);
+    report("vocabulary", vocabCurrent, vocabBundle);
+    report("chord-scale", tableCurrent, tableBundle);
+    qInfo().noquote() << QString("%1 %2 us (%3 allocs)")
+                             .arg("bundle open", -12)
+                             .arg(open.us, 9, 'f', 1)
+                             .arg(open.allocs, 7, 'f', 0);
+
+    const Sample totalCurrent{ontologyCurrent.us + grooveCurrent.us + vocabCurrent.us + tableCurrent.us,
+                              ontologyCurrent.allocs + grooveCurrent.allocs + vocabCurrent.allocs + tableCurrent.allocs};
+    const Sample totalBundle{open.us + ontologyBundle.us + grooveBundle.us + vocabBundle.us + tableBundle.us,
+                             open.allocs + ontologyBundle.allocs + grooveBundle.allocs + vocabBundle.allocs + tableBundle.allocs};
+    report("startup", totalCurrent, totalBundle);
+
+    bundle.reset();
+    QFile::remove(bundlePath);
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Event-queue benchmark for VirtuosoScheduler: the former QVector min-heap of
+// fat ScheduledEvent (inline QString) vs TimingWheel of compact POD events.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./TimingWheelBenchmarks > bench_output.txt
+
+#include "virtuoso/engine/TimingWheel.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Mirrors the old VirtuosoScheduler::ScheduledEvent layout.
+struct FatEvent {
+    qint64 dueMs = 0;
+    int kind = 0;
+    int channel = 1;
+    int note = 0;
+    int velocity = 0;
+    quint32 noteId = 0;
+    int cc = 0;
+    int ccValue = 0;
+    QString theoryJson;
+};
+
+// Mirrors VirtuosoScheduler::WheelEvent.
+struct CompactEvent {
+    qint64 dueMs = 0;
+    quint32 noteId = 0;
+    quint32 payload = 0;
+    quint8 kind = 0;
+    quint8 channel = 1;
+    quint8 note = 0;
+    quint8 velocity = 0;
+    quint8 cc = 0;
+    quint8 ccValue = 0;
+};
+
+static bool fatLess(const FatEvent& a, const FatEvent& b) { return a.dueMs > b.dueMs; }
+
+// Pending events spread over the next ~2 minutes of song time, mostly near-term
+// (the lookahead window) with a tail of far-future events.
+static qint64 dueFor(quint32& x, qint64 nowMs) {
+    x = x * 1664525u + 1013904223u;
+    const qint64 span = (x % 10u < 8u) ? 4000 : 120000;
+    return nowMs + 1 + qint64((x >> 8) % quint32(span));
+}
+
+static double nsPerOp(Clock::time_point t0, Clock::time_point t1, qint64 ops) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / double(qMax<qint64>(1, ops));
+}
+
+// Hold model: keep N events pending; each step advances time by 1 ms, pops
+// everything due and pushes one replacement per popped event.
+static void benchHeap(int pending, int steps) {
+    QVector<FatEvent> heap;
+    quint32 x = 1u;
+    for (int i = 0; i < pending; ++i) {
+        FatEvent ev;
+        ev.dueMs = dueFor(x, 0);
+        ev.noteId = quint32(i);
+        heap.push_back(ev);
+        std::push_heap(heap.begin(), heap.end(), fatLess);
+    }
+    qint64 ops = 0;
+    quint64 sink = 0;
+    const auto t0 = Clock::now();
+    for (qint64 now = 1; now <= steps; ++now) {
+        int popped = 0;
+        while (!heap.isEmpty() && heap.front().dueMs <= now) {
+            sink += heap.front().noteId;
+            std::pop_heap(heap.begin(), heap.end(), fatLess);
+            heap.pop_back();
+            ++popped;
+        }
+        for (int i = 0; i < qMax(1, popped); ++i) {
+            FatEvent ev;
+            ev.dueMs = dueFor(x, now);
+            heap.push_back(ev);
+            std::push_heap(heap.begin(), heap.end(), fatLess);
+        }
+        ops += popped + qMax(1, popped);
+    }
+    const auto t1 = Clock::now();
+    qInfo().noquote() << QString("heap  (fat QVector)  pending=%1: %2 ns/op (checksum %3)")
+                             .arg(pending, 6)
+                             .arg(nsPerOp(t0, t1, ops), 0, 'f', 1)
+                             .arg(sink);
+}
+
+static void benchWheel(int pending, int steps) {
+    virtuoso::engine::TimingWheel<CompactEvent> wheel;
+    quint32 x = 1u;
+    for (int i = 0; i < pending; ++i) {
+        CompactEvent ev;
+        ev.dueMs = dueFor(x, 0);
+        ev.noteId = quint32(i);
+        wheel.push(ev);
+    }
+    qint64 ops = 0;
+    quint64 sink = 0;
+    const auto t0 = Clock::now();
+    for (qint64 now = 1; now <= steps; ++now) {
+        int popped = 0;
+        wheel.advance(now, [&](const CompactEvent& ev) {
+            sink += ev.noteId;
+            ++popped;
+        });
+        for (int i = 0; i < qMax(1, popped); ++i) {
+            CompactEvent ev;
+            ev.dueMs = dueFor(x, now);
+            wheel.push(ev);
+        }
+        ops += popped + qMax(1, popped);
+    }
+    const auto t1 = Clock::now();
+    qInfo().noquote() << QString("wheel (compact POD)  pending=%1: %2 ns/op (checksum %3)")
+                             .arg(pending, 6)
+                             .arg(nsPerOp(t0, t1, ops), 0, 'f', 1)
+                             .arg(sink);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    for (int pending : {1000, 10000, 100000}) {
+        benchHeap(pending, 200000);
+        benchWheel(pending, 200000);
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Live-path logging cost: one guitar note-on/off worker pass through MidiProcessor with
+// ScaleSnapProcessor inline as the guitar stage (lead + 2 harmony voices), per trace mode.
+//   off:    every TraceLog category disabled; no record written, no string formatted
+//   binary: all categories at Debug; fixed-size records pushed to the per-thread ring
+//   string: trace off, plus the former per-event QString(...).arg().toStdString() pushed
+//           under a mutex for the same events (what the raw-mirror log used to cost)
+// Allocations are counted on the calling thread only; "off" and "binary" should match, the
+// difference to "string" being the formatting. Also reports the consumer-side
+// (pollLogQueue) drain + format cost per record.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./TraceLogBenchmarks > bench_output.txt
+
+#include "playback/ScaleSnapProcessor.h"
+#include "playback/HarmonyContext.h"
+#include "midiprocessor.h"
+#include "midi/TraceLog.h"
+#include "music/ChordSymbol.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+#include "bench/AllocCounter.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+
+// Friend of MidiProcessor: feeds guitar events and runs the rest of a worker pass.
+struct MidiProcessorBenchAccess {
+    static void attachDummyOutput(MidiProcessor& p) {
+        if (!p.midiOut) {
+            p.midiOut = std::make_unique<midi::RtMidiOutputPort>(std::make_unique<RtMidiOut>(RtMidi::RTMIDI_DUMMY));
+        }
+    }
+    static void actAsWorker(MidiProcessor& p) { p.m_workerThreadId.store(std::this_thread::get_id()); }
+    static void guitarPass(MidiProcessor& p, const midi::MidiMsg& m) {
+        MidiProcessor::MidiEvent ev;
+        ev.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        ev.message = m;
+        ev.source = MidiProcessor::MidiSource::Guitar;
+        ev.programIndex = -1;
+        p.processMidiEvent(ev);
+        p.drainScheduled(ev);
+        p.drainRing(p.m_virtualRing, MidiProcessor::MidiSource::VirtualBand, ev);
+    }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Mode { Off, Binary, String };
+
+constexpr int kNotes = 20000;
+
+static void setAllCategories(bool on) {
+    for (int c = 0; c < int(midi::TraceCategory::Count); ++c) {
+        midi::TraceLog::instance().setCategoryEnabled(midi::TraceCategory(c), on);
+    }
+}
+
+static void bench(MidiProcessor& midi, Mode mode) {
+    midi::TraceLog& log = midi::TraceLog::instance();
+    setAllCategories(mode == Mode::Binary);
+    log.setLevel(midi::TraceLevel::Debug);
+
+    std::mutex stringMutex;
+    std::queue<std::string> stringQueue;
+
+    QVector<double> ns;
+    ns.reserve(kNotes);
+    long long allocs = 0;
+    int records = 0;
+    double formatNs = 0.0;
+    for (int i = 0; i < kNotes; ++i) {
+        const int note = 52 + (i * 7) % 24;
+        const midi::MidiMsg on = midi::MidiMsg::make(0x90, quint8(note), 90);
+        beginAllocCount();
+        const auto t0 = Clock::now();
+        MidiProcessorBenchAccess::guitarPass(midi, on);
+        if (mode == Mode::String) {
+            std::lock_guard<std::mutex> lock(stringMutex);
+            stringQueue.push(QString("RAW-MIRROR Guitar→ch9 note=%1 vel=%2 status=0x%3")
+                                 .arg(on[1]).arg(on[2]).arg(on[0], 2, 16, QChar('0')).toStdString());
+        }
+        const auto t1 = Clock::now();
+        allocs += endAllocCount();
+        MidiProcessorBenchAccess::guitarPass(midi, midi::MidiMsg::make(0x80, quint8(note), 0));
+        ns.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+
+        // Consumer side, as pollLogQueue() does it between passes.
+        if (i % 64 == 63) {
+            const auto f0 = Clock::now();
+            records += log.drain([](const midi::TraceRecord& r) { (void)midi::formatTraceRecord(r); });
+            formatNs += double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - f0).count());
+            std::queue<std::string>().swap(stringQueue);
+        }
+    }
+    std::sort(ns.begin(), ns.end());
+    const char* label = mode == Mode::Off ? "off   " : mode == Mode::Binary ? "binary" : "string";
+    qInfo().noquote() << QString("%1: note-on pass p50 %2 ns, p99 %3 ns, max %4 ns, %5 allocs/event")
+                             .arg(label)
+                             .arg(ns[ns.size() / 2], 0, 'f', 0)
+                             .arg(ns[int(ns.size() * 0.99)], 0, 'f', 0)
+                             .arg(ns.last(), 0, 'f', 0)
+                             .arg(double(allocs) / kNotes, 0, 'f', 2);
+    if (records > 0) {
+        qInfo().noquote() << QString("%1: consumer drain+format %2 ns/record (%3 records, %4 dropped so far)")
+                                 .arg(label)
+                                 .arg(formatNs / records, 0, 'f', 0)
+                                 .arg(records)
+                                 .arg(log.dropped());
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    Preset preset;
+    preset.settings.voiceControlEnabled = true; // no command-note handling
+    MidiProcessor midi(preset);
+    MidiProcessorBenchAccess::attachDummyOutput(midi);
+    MidiProcessorBenchAccess::actAsWorker(midi);
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+
+    playback::ScaleSnapProcessor snap;
+    snap.setMidiProcessor(&midi); // registers as the inline guitar stage
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    snap.setHarmonyHumanizationEnabled(false);
+    snap.setLeadMode(playback::ScaleSnapProcessor::LeadMode::Conformed);
+    for (int i = 0; i < 4; ++i) {
+        playback::HarmonyVoiceConfig c;
+        c.motionType = (i < 2) ? playback::VoiceMotionType::PARALLEL_FIXED : playback::VoiceMotionType::OFF;
+        c.rangeMin = 40;
+        c.rangeMax = 88;
+        c.parallelInterval = (i % 2) ? -5 : 4;
+        snap.setVoiceConfig(i, c);
+    }
+    music::ChordSymbol chord;
+    music::parseChordSymbol("Bbmaj7", chord);
+    snap.setDefaultHarmonyChord(chord);
+
+    for (Mode mode : {Mode::Off, Mode::Binary, Mode::String, Mode::Off}) bench(midi, mode);
+    return 0;
+}
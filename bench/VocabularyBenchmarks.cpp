@@ -0,0 +1,179 @@
+// Vocabulary selection cost: the determinism-seed hash and a full VocabularyRegistry
+// choosePianoBeat() call, over a grid of queries like the piano planner issues per beat.
+//   hash:   fnv1a32(QString(format).arg(...).toUtf8()) vs StableHash::ArgFormat (same value)
+//   choose: choosePianoBeat() and pianoPhraseHitsForBeat() end to end
+// Allocations are counted per call.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./VocabularyBenchmarks [cool_jazz_vocabulary.json] > bench_output.txt
+
+#include "virtuoso/util/StableHash.h"
+#include "virtuoso/vocab/VocabularyRegistry.h"
+#include "bench/AllocCounter.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include <chrono>
+
+using virtuoso::util::StableHash;
+using virtuoso::vocab::VocabularyRegistry;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRounds = 200;
+
+static QVector<VocabularyRegistry::PianoBeatQuery> queryGrid() {
+    const QStringList chords = {"Cmaj7", "Dm7", "G7", "F#m7b5", "Bbmaj7", "Eb7"};
+    const QStringList functions = {"", "Tonic", "Subdominant", "Dominant"};
+    QVector<VocabularyRegistry::PianoBeatQuery> out;
+    for (int bar = 0; bar < 8; ++bar) {
+        for (int beat = 0; beat < 4; ++beat) {
+            VocabularyRegistry::PianoBeatQuery q;
+            q.playbackBarIndex = bar;
+            q.beatInBar = beat;
+            q.chordText = chords[(bar + beat) % chords.size()];
+            q.chordFunction = functions[bar % functions.size()];
+            q.chordIsNew = beat == 0;
+            q.userSilence = bar % 3 == 2;
+            q.energy = 0.1 + 0.1 * ((bar * 4 + beat) % 9);
+            q.determinismSeed = 0xC0FFEEu + quint32(bar);
+            out.push_back(q);
+        }
+    }
+    return out;
+}
+
+template <typename Fn>
+static void run(const char* label, int calls, const Fn& fn) {
+    beginAllocCount();
+    const auto t0 = Clock::now();
+    fn();
+    const auto t1 = Clock::now();
+    const long long allocs = endAllocCount();
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    qInfo().noquote() << QString("%1 %2 ns/call, %3 allocs/call")
+                             .arg(QString::fromLatin1(label), -34)
+                             .arg(ns / calls, 7, 'f', 1)
+                             .arg(double(allocs) / calls, 0, 'f', 2);
+}
+
+static void benchHash(const QVector<VocabularyRegistry::PianoBeatQuery>& grid) {
+    const int calls = kRounds * grid.size();
+    quint32 formattedSum = 0;
+    quint32 streamedSum = 0;
+    int mismatches = 0;
+    for (const auto& q : grid) {
+        const quint32 a = StableHash::fnv1a32(QString("%1|piano|%2|%3|%4|%5|%6")
+                                                  .arg(q.chordText)
+                                                  .arg(q.playbackBarIndex)
+                                                  .arg(q.beatInBar)
+                                                  .arg(int(q.chordIsNew))
+                                                  .arg(q.chordFunction)
+                                                  .arg(q.determinismSeed)
+                                                  .toUtf8());
+        const quint32 b = StableHash::ArgFormat("%1|piano|%2|%3|%4|%5|%6")
+                              .arg(q.chordText)
+                              .arg(q.playbackBarIndex)
+                              .arg(q.beatInBar)
+                              .arg(int(q.chordIsNew))
+                              .arg(q.chordFunction)
+                              .arg(q.determinismSeed)
+                              .value();
+        mismatches += (a != b) ? 1 : 0;
+    }
+    run("hash: QString::arg + toUtf8", calls, [&] {
+        for (int r = 0; r < kRounds; ++r) {
+            for (const auto& q : grid) {
+                formattedSum += StableHash::fnv1a32(QString("%1|piano|%2|%3|%4|%5|%6")
+                                                        .arg(q.chordText)
+                                                        .arg(q.playbackBarIndex)
+                                                        .arg(q.beatInBar)
+                                                        .arg(int(q.chordIsNew))
+                                                        .arg(q.chordFunction)
+                                                        .arg(q.determinismSeed)
+                                                        .toUtf8());
+            }
+        }
+    });
+    run("hash: StableHash::ArgFormat", calls, [&] {
+        for (int r = 0; r < kRounds; ++r) {
+            for (const auto& q : grid) {
+                streamedSum += StableHash::ArgFormat("%1|piano|%2|%3|%4|%5|%6")
+                                   .arg(q.chordText)
+                                   .arg(q.playbackBarIndex)
+                                   .arg(q.beatInBar)
+                                   .arg(int(q.chordIsNew))
+                                   .arg(q.chordFunction)
+                                   .arg(q.determinismSeed)
+                                   .value();
+            }
+        }
+    });
+    qInfo().noquote() << QString("hash: %1 of %2 seeds differ%3")
+                             .arg(mismatches)
+                             .arg(grid.size())
+                             .arg(formattedSum == streamedSum ? "" : " (checksums differ)");
+}
+
+static void benchChoose(const VocabularyRegistry& vocab, const QVector<VocabularyRegistry::PianoBeatQuery>& grid) {
+    const int calls = kRounds * grid.size();
+    int chosen = 0;
+    run("choose: choosePianoBeat", calls, [&] {
+        for (int r = 0; r < kRounds; ++r) {
+            for (const auto& q : grid) chosen += vocab.choosePianoBeat(q).id.isEmpty() ? 0 : 1;
+        }
+    });
+
+    int hits = 0;
+    run("choose: pianoPhraseHitsForBeat", calls, [&] {
+        for (int r = 0; r < kRounds; ++r) {
+            for (const auto& q : grid) {
+                VocabularyRegistry::PianoPhraseQuery pq;
+                pq.playbackBarIndex = q.playbackBarIndex;
+                pq.beatInBar = q.beatInBar;
+                pq.chordText = q.chordText;
+                pq.chordFunction = q.chordFunction;
+                pq.chordIsNew = q.chordIsNew;
+                pq.userSilence = q.userSilence;
+                pq.energy = q.energy;
+                pq.determinismSeed = q.determinismSeed;
+                pq.phraseBars = 8;
+                hits += vocab.pianoPhraseHitsForBeat(pq).size();
+            }
+        }
+    });
+    qInfo().noquote() << QString("choose: %1% of beat queries matched a pattern, %2 phrase hits/round")
+                             .arg(100.0 * chosen / calls, 0, 'f', 1)
+                             .arg(double(hits) / kRounds, 0, 'f', 1);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const QString path = args.size() > 1 ? args[1] : QString("../virtuoso/vocab/cool_jazz_vocabulary.json");
+
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning().noquote() << "cannot open" << path;
+        return 1;
+    }
+    VocabularyRegistry vocab;
+    QString error;
+    if (!vocab.loadFromJsonBytes(f.readAll(), &error)) {
+        qWarning().noquote() << error;
+        return 1;
+    }
+
+    const QVector<VocabularyRegistry::PianoBeatQuery> grid = queryGrid();
+    benchHash(grid);
+    benchChoose(vocab, grid);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// VocalSyncAU YinPitchDetector benchmark: per-block CPU of the original circular-buffer
+// O(W^2) difference function vs the contiguous-window direct loop vs the FFT/energy-term
+// path, detecting on every block or once per 256-sample hop.
+// Not part of ctest: numbers are machine-dependent. Run manually, e.g.
+//   ./YinBenchmarks > bench_output.txt
+
+#include "YinPitchDetector.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QtGlobal>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Method = YinPitchDetector::Method;
+
+static const char* methodName(Method m) {
+    switch (m) {
+    case Method::Reference: return "reference";
+    case Method::Direct: return "direct   ";
+    case Method::Fft: return "fft      ";
+    }
+    return "?";
+}
+
+static void bench(Method method, double sr, int block, int hop) {
+    // ~10 s of a voice-like signal (harmonics + vibrato).
+    const int total = int(sr * 10.0);
+    std::vector<float> signal(total);
+    double phase = 0.0;
+    for (int i = 0; i < total; ++i) {
+        const double f = 220.0 * std::pow(2.0, 0.3 / 12.0 * std::sin(6.2831853 * 5.5 * i / sr));
+        phase += 6.2831853 * f / sr;
+        signal[i] = float(0.3 * (std::sin(phase) + 0.5 * std::sin(2 * phase) + 0.25 * std::sin(3 * phase)));
+    }
+
+    YinPitchDetector yin;
+    yin.setMethod(method);
+    yin.setHopSize(hop);
+    yin.prepare(sr, block);
+
+    // Reference is slow: cap its run so the whole benchmark stays short.
+    const int blocks = (method == Method::Reference) ? qMin(total / block, 2000) : total / block;
+    double hzSum = 0.0;
+    const auto t0 = Clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        yin.process(signal.data() + b * block, block);
+        hzSum += yin.detectedHz();
+    }
+    const auto t1 = Clock::now();
+    const double us = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / 1000.0 / blocks;
+    const double budgetUs = 1e6 * block / sr;
+    qInfo().noquote() << QString("%1 sr=%2 block=%3 hop=%4: %5 us/block (%6% of real time), mean %7 Hz")
+                             .arg(methodName(method))
+                             .arg(int(sr))
+                             .arg(block, 4)
+                             .arg(hop, 3)
+                             .arg(us, 0, 'f', 2)
+                             .arg(100.0 * us / budgetUs, 0, 'f', 2)
+                             .arg(hzSum / blocks, 0, 'f', 1);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    for (int block : {64, 256, 512}) {
+        for (Method m : {Method::Reference, Method::Direct, Method::Fft}) {
+            bench(m, 48000.0, block, 0);
+            bench(m, 48000.0, block, 256);
+        }
+    }
+    return 0;
+}
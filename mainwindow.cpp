@@ -180,6 +180,10 @@ void MainWindow::createWidgets(const Preset& preset) {
     noteMonitorWidget = new NoteMonitorWidget(m_performanceMode, this);
     noteMonitorWidget->setMidiProcessor(m_midiProcessor);
     rootStack->addWidget(noteMonitorWidget);
+    // Band MIDI from the realtime dispatch thread unless turned off in Settings (see below).
+    if (auto* engine = noteMonitorWidget->virtuosoPlayback()) {
+        engine->setRealtimeDispatch(QSettings().value("playback/realtimeDispatch", true).toBool());
+    }
 
     // Preferences action in a Settings menu (PreferencesRole => macOS App menu)
     QAction* preferencesAction = new QAction("Preferences…", this);
@@ -218,6 +222,52 @@ void MainWindow::createWidgets(const Preset& preset) {
         }
         settingsMenu->addAction(preferencesAction);
 
+        // Latency histograms (guitar/voice in -> synth out), dumped as JSON
+        // next to harmony.log so a session can be compared against the last.
+        settingsMenu->addSeparator();
+        QAction* dumpLatencyAction = new QAction("Dump Latency Histograms", this);
+        dumpLatencyAction->setMenuRole(QAction::NoRole);
+        connect(dumpLatencyAction, &QAction::triggered, this, [this]() {
+            m_midiProcessor->dumpLatencyStats();
+        });
+        settingsMenu->addAction(dumpLatencyAction);
+        QAction* resetLatencyAction = new QAction("Reset Latency Histograms", this);
+        resetLatencyAction->setMenuRole(QAction::NoRole);
+        connect(resetLatencyAction, &QAction::triggered, this, [this]() {
+            m_midiProcessor->resetLatencyStats();
+            m_midiProcessor->pushLog("Latency histograms reset");
+        });
+        settingsMenu->addAction(resetLatencyAction);
+
+        // MIDI capture: everything in and out of the worker, written next to
+        // harmony.log for replay (MidiReplayBenchmarks) or MidiCaptureToSmf.
+        QAction* recordCaptureAction = new QAction("Record MIDI Capture", this);
+        recordCaptureAction->setMenuRole(QAction::NoRole);
+        recordCaptureAction->setCheckable(true);
+        connect(recordCaptureAction, &QAction::toggled, this, [this, recordCaptureAction](bool on) {
+            if (!on) {
+                m_midiProcessor->stopCaptureRecording();
+            } else if (m_midiProcessor->startCaptureRecording().isEmpty()) {
+                const QSignalBlocker block(recordCaptureAction);
+                recordCaptureAction->setChecked(false);
+            }
+        });
+        settingsMenu->addAction(recordCaptureAction);
+
+        // Band timing: a dedicated dispatch thread writing into the MIDI worker's ring, or the
+        // GUI-thread QTimer + queued signals (fallback if a synth setup misbehaves).
+        if (auto* engine = noteMonitorWidget->virtuosoPlayback()) {
+            QAction* realtimeDispatchAction = new QAction("Realtime Band Dispatch", this);
+            realtimeDispatchAction->setMenuRole(QAction::NoRole);
+            realtimeDispatchAction->setCheckable(true);
+            realtimeDispatchAction->setChecked(engine->realtimeDispatch());
+            connect(realtimeDispatchAction, &QAction::toggled, this, [engine](bool on) {
+                engine->setRealtimeDispatch(on);
+                QSettings().setValue("playback/realtimeDispatch", on);
+            });
+            settingsMenu->addAction(realtimeDispatchAction);
+        }
+
         // Window menu: access secondary windows/dialogs.
         QMenu* windowMenu = nullptr;
         for (QAction* a : menuBar()->actions()) {
@@ -650,27 +700,13 @@ void MainWindow::createConnections() {
                 this, &MainWindow::logToConsole,
                 static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
         
-        connect(m_midiProcessor, &MidiProcessor::guitarPitchUpdated,
-                noteMonitorWidget, &NoteMonitorWidget::setGuitarNote,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-        connect(m_midiProcessor, &MidiProcessor::voicePitchUpdated,
-                noteMonitorWidget, &NoteMonitorWidget::setVoiceNote,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-        connect(m_midiProcessor, &MidiProcessor::guitarHzUpdated,
-                noteMonitorWidget, &NoteMonitorWidget::setGuitarHz,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-        connect(m_midiProcessor, &MidiProcessor::voiceHzUpdated,
-                noteMonitorWidget, &NoteMonitorWidget::setVoiceHz,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-        connect(m_midiProcessor, &MidiProcessor::guitarAftertouchUpdated,
-                noteMonitorWidget, &NoteMonitorWidget::setGuitarAmplitude,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-        connect(m_midiProcessor, &MidiProcessor::voiceCc2Updated,
-                noteMonitorWidget, &NoteMonitorWidget::setVoiceAmplitude,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-        connect(m_midiProcessor, &MidiProcessor::guitarVelocityUpdated,
-                noteMonitorWidget, &NoteMonitorWidget::setGuitarVelocity,
-                static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
+        // Pitch, Hz, pressure, breath and velocity: polled from the
+        // processor's latest-value block at display rate instead of one
+        // queued signal per incoming message.
+        m_continuousPollTimer = new QTimer(this);
+        m_continuousPollTimer->setInterval(16); // ~60 Hz
+        connect(m_continuousPollTimer, &QTimer::timeout, this, &MainWindow::pollContinuousState);
+        m_continuousPollTimer->start();
     }
 
     // --- Shutdown safety: stop playback engines before MIDI teardown ---
@@ -693,6 +729,27 @@ void MainWindow::updateTrackUI(const std::string& trackId, bool newState) {
     }
 }
 
+void MainWindow::pollContinuousState() {
+    if (!noteMonitorWidget || !m_midiProcessor) return;
+    const quint64 version = m_midiProcessor->continuousVersion();
+    if (version == m_lastContinuousVersion) return;
+    m_lastContinuousVersion = version;
+    const midi::ContinuousState now = m_midiProcessor->continuousState();
+    const midi::ContinuousState& was = m_lastContinuous;
+    if (now.guitarNote != was.guitarNote || now.guitarCents != was.guitarCents) {
+        noteMonitorWidget->setGuitarNote(now.guitarNote, now.guitarCents);
+    }
+    if (now.voiceNote != was.voiceNote || now.voiceCents != was.voiceCents) {
+        noteMonitorWidget->setVoiceNote(now.voiceNote, now.voiceCents);
+    }
+    if (now.guitarHz != was.guitarHz) noteMonitorWidget->setGuitarHz(now.guitarHz);
+    if (now.voiceHz != was.voiceHz) noteMonitorWidget->setVoiceHz(now.voiceHz);
+    if (now.guitarAftertouch != was.guitarAftertouch) noteMonitorWidget->setGuitarAmplitude(now.guitarAftertouch);
+    if (now.voiceCc2 != was.voiceCc2) noteMonitorWidget->setVoiceAmplitude(now.voiceCc2);
+    if (now.guitarVelocity != was.guitarVelocity) noteMonitorWidget->setGuitarVelocity(now.guitarVelocity);
+    m_lastContinuous = now;
+}
+
 // FIX: Signature updated and body simplified.
 void MainWindow::logToConsole(const QString& message) {
     logConsole->append(message);
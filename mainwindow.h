@@ -58,6 +58,8 @@ private slots:
     void openPreferences();
     void applyLegacyUiSetting(bool legacyOn);
     void openIRealHtml();
+    // Feeds the note monitor from MidiProcessor::continuousState().
+    void pollContinuousState();
 
 private:
     void createWidgets(const Preset& preset);
@@ -90,6 +92,11 @@ protected:
     QLabel* voiceTranscriptionLabel;
     QLabel* voiceStatusLabel;
     QTimer* voiceTranscriptionTimer;
+
+    // Note monitor feed (pollContinuousState)
+    QTimer* m_continuousPollTimer = nullptr;
+    quint64 m_lastContinuousVersion = 0;
+    midi::ContinuousState m_lastContinuous;
     
     // Transpose control
     QCheckBox* transposeCheckBox;
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "midi/Seqlock.h"
+
+namespace midi {
+
+// Latest values of MidiProcessor's continuous signals: pitch-tracker Hz and
+// note/cents, guitar pressure and velocity, voice breath (CC2). The worker
+// publishes the whole block on every change; UI and analysis code polls it
+// at its own rate instead of taking a queued Qt signal per message. Note
+// on/off and other discrete events still go through queued signals.
+struct ContinuousState {
+    double guitarHz = 0.0; // <= 0: no pitch
+    double voiceHz = 0.0;
+    double guitarCents = 0.0;
+    double voiceCents = 0.0;
+    std::int32_t guitarNote = -1; // nearest note to guitarHz, -1 = none
+    std::int32_t voiceNote = -1;
+    std::int32_t guitarAftertouch = 0; // 0-127 channel pressure
+    std::int32_t guitarVelocity = 0;   // last note-on velocity
+    std::int32_t voiceCc2 = 0;         // 0-127 breath
+    // Breath samples published so far (wraps). A poller that compares it
+    // with its last read knows whether new CC2 arrived even when the value
+    // repeated, and how many it skipped.
+    std::uint32_t voiceCc2Samples = 0;
+};
+
+// Event-loop traffic accounting. Continuous updates used to be one queued
+// signal each (times the queued receivers); they now cost one store, and
+// their consumers one poll per timer tick.
+struct ContinuousStats {
+    std::atomic<std::uint64_t> updates{0};         // continuous values published (worker)
+    std::atomic<std::uint64_t> polls{0};           // snapshots read by pollers
+    std::atomic<std::uint64_t> discreteSignals{0}; // queued note on/off signals still emitted
+
+    void reset() {
+        updates.store(0, std::memory_order_relaxed);
+        polls.store(0, std::memory_order_relaxed);
+        discreteSignals.store(0, std::memory_order_relaxed);
+    }
+};
+
+} // namespace midi
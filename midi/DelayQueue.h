@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "midi/MidiMsg.h"
+
+namespace midi {
+
+// A MIDI message to be sent at a monotonic deadline (monotonicNowNs()
+// clock). Producers hand these to the worker through an MpscRing; a
+// cancel entry instead drops the channel's pending note-ons.
+struct ScheduledMidiMsg {
+    MidiMsg msg;
+    std::int64_t dueNs = 0;
+    bool cancelNoteOns = false; // msg's channel nibble selects the channel
+};
+
+// Preallocated min-heap of timed MIDI messages, ordered by (due time,
+// arrival order). Owned by the MIDI worker thread: single-threaded, never
+// allocates after construction.
+//
+// Two rules keep delayed notes well-formed whatever delays the producer
+// picks:
+//  * a note-off is never due before the latest note-on pushed for the same
+//    channel/note, and on equal due times arrival order wins, so a release
+//    always follows its attack;
+//  * cancelNoteOns(channel) drops that channel's unsent note-ons (for
+//    all-notes-off) and leaves pending note-offs to fire harmlessly.
+template <std::size_t Capacity>
+class DelayQueue {
+    static_assert(Capacity >= 1, "DelayQueue needs at least one slot");
+
+public:
+    DelayQueue() { m_lastOnDueNs.fill(0); }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == Capacity; }
+    std::size_t size() const { return m_size; }
+
+    // Earliest due time. Only valid when !empty().
+    std::int64_t nextDueNs() const { return m_heap[0].dueNs; }
+
+    // Returns false when full; the caller makes room with popFront().
+    bool push(const MidiMsg& msg, std::int64_t dueNs) {
+        if (m_size == Capacity) return false;
+        Entry e{dueNs, m_nextSeq++, msg};
+        const int key = noteKey(msg);
+        if (key >= 0) {
+            if (isNoteOn(msg)) {
+                m_lastOnDueNs[std::size_t(key)] = dueNs;
+            } else if (e.dueNs < m_lastOnDueNs[std::size_t(key)]) {
+                e.dueNs = m_lastOnDueNs[std::size_t(key)];
+            }
+        }
+        siftUp(m_size++, e);
+        return true;
+    }
+
+    // Pops the earliest entry if it is due at `nowNs`.
+    bool popDue(std::int64_t nowNs, MidiMsg& out) {
+        if (m_size == 0 || m_heap[0].dueNs > nowNs) return false;
+        return popFront(out);
+    }
+
+    // Pops the earliest entry whether or not it is due.
+    bool popFront(MidiMsg& out) {
+        if (m_size == 0) return false;
+        out = m_heap[0].msg;
+        --m_size;
+        if (m_size > 0) siftDown(0, m_heap[m_size]);
+        return true;
+    }
+
+    void cancelNoteOns(std::uint8_t zeroBasedChannel) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_size; ++i) {
+            const MidiMsg& m = m_heap[i].msg;
+            if (isNoteOn(m) && m.channelNibble() == zeroBasedChannel) continue;
+            m_heap[kept++] = m_heap[i];
+        }
+        m_size = kept;
+        for (std::size_t i = m_size / 2; i-- > 0;) siftDown(i, m_heap[i]);
+    }
+
+private:
+    struct Entry {
+        std::int64_t dueNs;
+        std::uint64_t seq;
+        MidiMsg msg;
+    };
+
+    static bool before(const Entry& a, const Entry& b) {
+        return a.dueNs < b.dueNs || (a.dueNs == b.dueNs && a.seq < b.seq);
+    }
+    static bool isNoteOn(const MidiMsg& m) {
+        return m.len == 3 && m.type() == 0x90 && m.data2() > 0;
+    }
+    // channel * 128 + note for note-on/off, else -1.
+    static int noteKey(const MidiMsg& m) {
+        if (m.len != 3 || (m.type() != 0x90 && m.type() != 0x80)) return -1;
+        return int(m.channelNibble()) * 128 + int(m.data1() & 0x7F);
+    }
+
+    void siftUp(std::size_t i, const Entry e) {
+        while (i > 0) {
+            const std::size_t parent = (i - 1) / 2;
+            if (!before(e, m_heap[parent])) break;
+            m_heap[i] = m_heap[parent];
+            i = parent;
+        }
+        m_heap[i] = e;
+    }
+    void siftDown(std::size_t i, const Entry e) {
+        for (;;) {
+            std::size_t child = 2 * i + 1;
+            if (child >= m_size) break;
+            if (child + 1 < m_size && before(m_heap[child + 1], m_heap[child])) ++child;
+            if (!before(m_heap[child], e)) break;
+            m_heap[i] = m_heap[child];
+            i = child;
+        }
+        m_heap[i] = e;
+    }
+
+    std::array<Entry, Capacity> m_heap{};
+    std::size_t m_size = 0;
+    std::uint64_t m_nextSeq = 0;
+    std::array<std::int64_t, 16 * 128> m_lastOnDueNs{};
+};
+
+} // namespace midi
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace midi {
+
+// Synchronous per-note processing stage, run inline by MidiProcessor's
+// worker thread for every performance guitar note (transposed; command-mode
+// notes are excluded) before passthrough. Anything the stage sends through
+// MidiProcessor::sendVirtual* / scheduleVirtual* from inside these calls
+// goes out on the same worker pass instead of round-tripping through the
+// virtual-band ring. Implementations must not block.
+class IGuitarStage {
+public:
+    virtual ~IGuitarStage() = default;
+    virtual void guitarNoteOn(int midiNote, int velocity) = 0;
+    virtual void guitarNoteOff(int midiNote) = 0;
+    // nextTickDeadlineNs() when the stage has nothing timed pending.
+    static constexpr std::int64_t kNoTickDeadline = -1;
+
+    // Timed housekeeping on the worker (glides, bends, delayed notes). The
+    // worker calls tick() once monotonicNowNs() reaches nextTickDeadlineNs(),
+    // and parks without a timeout while the stage reports kNoTickDeadline, so
+    // an idle stage costs no wakeups. The stage owns its cadence: it returns
+    // its next tick time only while such work is active. Both run on the
+    // worker, which asks for the deadline again after every pass.
+    virtual void tick(std::int64_t nowNs) { (void)nowNs; }
+    virtual std::int64_t nextTickDeadlineNs() const { return kNoTickDeadline; }
+};
+
+} // namespace midi
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "midi/MidiMsg.h"
+
+namespace midi {
+
+// Lock-free log-linear latency histogram (HdrHistogram layout, ~3%
+// resolution). Values below 64 ns get one bucket each; above that every
+// power of two is split into 32 equal buckets, up to 2^34 ns (~17 s), beyond
+// which samples land in the last bucket. record() is a handful of relaxed
+// atomic adds, so any thread may record while another takes a snapshot.
+class LatencyHistogram {
+public:
+    static constexpr int kLinearBuckets = 64;
+    static constexpr int kSubBuckets = 32;
+    static constexpr int kMaxShift = 28; // top range is [2^33, 2^34)
+    static constexpr int kBuckets = kLinearBuckets + kMaxShift * kSubBuckets;
+
+    static int bucketFor(std::int64_t ns) {
+        if (ns < kLinearBuckets) return ns < 0 ? 0 : int(ns);
+        const std::uint64_t v = std::uint64_t(ns);
+        int msb = 63;
+        while (!((v >> msb) & 1u)) --msb;
+        const int shift = msb - 5; // leaves a 6-bit mantissa in [32, 64)
+        if (shift > kMaxShift) return kBuckets - 1;
+        return kLinearBuckets + (shift - 1) * kSubBuckets + int(v >> shift) - kSubBuckets;
+    }
+    // Smallest value that maps to `bucket`.
+    static std::int64_t bucketLowNs(int bucket) {
+        if (bucket < kLinearBuckets) return bucket;
+        const int k = bucket - kLinearBuckets;
+        const int shift = k / kSubBuckets + 1;
+        return std::int64_t(kSubBuckets + k % kSubBuckets) << shift;
+    }
+    static std::int64_t bucketHighNs(int bucket) {
+        if (bucket < kLinearBuckets) return bucket;
+        const int k = bucket - kLinearBuckets;
+        const int shift = k / kSubBuckets + 1;
+        return (std::int64_t(kSubBuckets + k % kSubBuckets + 1) << shift) - 1;
+    }
+
+    void record(std::int64_t ns) {
+        if (ns < 0) ns = 0;
+        m_counts[std::size_t(bucketFor(ns))].fetch_add(1, std::memory_order_relaxed);
+        m_sumNs.fetch_add(std::uint64_t(ns), std::memory_order_relaxed);
+        std::int64_t prev = m_maxNs.load(std::memory_order_relaxed);
+        while (ns > prev && !m_maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+    }
+
+    // Not atomic with respect to concurrent record() calls: a sample landing
+    // mid-reset may survive in part. Good enough between takes.
+    void reset() {
+        for (auto& c : m_counts) c.store(0, std::memory_order_relaxed);
+        m_sumNs.store(0, std::memory_order_relaxed);
+        m_maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    // Point-in-time copy for reporting (consumer side).
+    struct Snapshot {
+        std::array<std::uint64_t, kBuckets> counts{};
+        std::uint64_t count = 0;
+        std::uint64_t sumNs = 0;
+        std::int64_t maxNs = 0;
+
+        // Upper edge of the bucket holding the p-quantile (0..1), capped at
+        // the recorded max; 0 when empty.
+        std::int64_t percentileNs(double p) const {
+            if (count == 0) return 0;
+            const std::uint64_t rank = std::uint64_t(p * double(count - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (int b = 0; b < kBuckets; ++b) {
+                seen += counts[std::size_t(b)];
+                if (seen >= rank) return bucketHighNs(b) < maxNs ? bucketHighNs(b) : maxNs;
+            }
+            return maxNs;
+        }
+        double meanNs() const { return count ? double(sumNs) / double(count) : 0.0; }
+    };
+    Snapshot snapshot() const {
+        Snapshot s;
+        for (int b = 0; b < kBuckets; ++b) {
+            s.counts[std::size_t(b)] = m_counts[std::size_t(b)].load(std::memory_order_relaxed);
+            s.count += s.counts[std::size_t(b)];
+        }
+        s.sumNs = m_sumNs.load(std::memory_order_relaxed);
+        s.maxNs = m_maxNs.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> m_counts{};
+    std::atomic<std::uint64_t> m_sumNs{0};
+    std::atomic<std::int64_t> m_maxNs{0};
+};
+
+// Output paths measured end to end (input callback -> RtMidi send returned),
+// keyed by what the app sends where.
+enum class LatencyPath : std::uint8_t {
+    Lead,      // ch 1: guitar passthrough or the conformed lead
+    RawMirror, // ch 9: guitar raw mirror
+    VoiceSnap, // ch 10: snapped voice
+    Harmony,   // ch 12-15: ScaleSnap harmony voices
+    VocalSync, // dedicated VocalSync port
+    Count
+};
+
+// Per-event stages between the input callback and the end of processing.
+enum class LatencyStage : std::uint8_t {
+    QueueWait,  // callback -> popped by the worker
+    Dispatch,   // popped -> processing start
+    Processing, // processing start -> end (includes the sends)
+    Send,       // one RtMidi sendMessage() call on a measured path
+    Count
+};
+
+// Monotonic timestamps (monotonicNowNs()) carried with one inbound event
+// through the worker; 0 = not reached.
+struct LatencyStamps {
+    std::int64_t arrivalNs = 0;
+    std::int64_t dequeueNs = 0;
+    std::int64_t processStartNs = 0;
+    std::int64_t processEndNs = 0;
+    std::int64_t sendReturnNs = 0; // last measured send made while processing it
+};
+
+// The histograms MidiProcessor keeps: one per path and one per stage.
+class LatencyStats {
+public:
+    static const char* pathName(LatencyPath p) {
+        static const char* const names[] = {"lead_ch1", "raw_mirror_ch9", "voice_snap_ch10",
+                                            "harmony_ch12_15", "vocalsync"};
+        return names[int(p)];
+    }
+    static const char* stageName(LatencyStage s) {
+        static const char* const names[] = {"queue_wait", "dispatch", "processing", "send"};
+        return names[int(s)];
+    }
+
+    // Path for a message on the main output, or Count when it isn't
+    // measured. Only note-ons are: they are what a player hears as latency,
+    // and it keeps CC/pressure streams out of the numbers.
+    static LatencyPath pathFor(const MidiMsg& m) {
+        if (m.len != 3 || m.type() != 0x90 || m.data2() == 0) return LatencyPath::Count;
+        const int ch = m.channelNibble() + 1;
+        if (ch == 1) return LatencyPath::Lead;
+        if (ch == 9) return LatencyPath::RawMirror;
+        if (ch == 10) return LatencyPath::VoiceSnap;
+        if (ch >= 12 && ch <= 15) return LatencyPath::Harmony;
+        return LatencyPath::Count;
+    }
+
+    LatencyHistogram& path(LatencyPath p) { return m_paths[std::size_t(p)]; }
+    const LatencyHistogram& path(LatencyPath p) const { return m_paths[std::size_t(p)]; }
+    LatencyHistogram& stage(LatencyStage s) { return m_stages[std::size_t(s)]; }
+    const LatencyHistogram& stage(LatencyStage s) const { return m_stages[std::size_t(s)]; }
+
+    // Queue wait, dispatch and processing of one fully stamped event.
+    void recordEvent(const LatencyStamps& s) {
+        if (s.arrivalNs <= 0 || s.dequeueNs <= 0 || s.processStartNs <= 0 || s.processEndNs <= 0) return;
+        stage(LatencyStage::QueueWait).record(s.dequeueNs - s.arrivalNs);
+        stage(LatencyStage::Dispatch).record(s.processStartNs - s.dequeueNs);
+        stage(LatencyStage::Processing).record(s.processEndNs - s.processStartNs);
+    }
+    // One send on `p`: end to end from the message's origin, plus the call itself.
+    void recordSend(LatencyPath p, std::int64_t originNs, std::int64_t sendStartNs, std::int64_t sendReturnNs) {
+        path(p).record(sendReturnNs - originNs);
+        stage(LatencyStage::Send).record(sendReturnNs - sendStartNs);
+    }
+
+    void reset() {
+        for (auto& h : m_paths) h.reset();
+        for (auto& h : m_stages) h.reset();
+    }
+
+    // {"paths": {name: {...}}, "stages": {name: {...}}}; each histogram has
+    // count, mean/max/p50/p90/p99/p99.9 in microseconds and its non-empty
+    // buckets as [low_ns, high_ns, count] triples.
+    QJsonObject toJson() const {
+        QJsonObject paths;
+        for (int p = 0; p < int(LatencyPath::Count); ++p) {
+            paths.insert(pathName(LatencyPath(p)), histogramJson(m_paths[std::size_t(p)].snapshot()));
+        }
+        QJsonObject stages;
+        for (int s = 0; s < int(LatencyStage::Count); ++s) {
+            stages.insert(stageName(LatencyStage(s)), histogramJson(m_stages[std::size_t(s)].snapshot()));
+        }
+        QJsonObject root;
+        root.insert("unit", "us");
+        root.insert("paths", paths);
+        root.insert("stages", stages);
+        return root;
+    }
+
+    // One console line per non-empty histogram.
+    QStringList summaryLines() const {
+        QStringList lines;
+        const auto line = [&lines](const char* name, const LatencyHistogram::Snapshot& s) {
+            if (s.count == 0) return;
+            lines << QString("Latency %1: n=%2 p50=%3us p99=%4us p99.9=%5us max=%6us")
+                         .arg(name)
+                         .arg(s.count)
+                         .arg(double(s.percentileNs(0.50)) / 1000.0, 0, 'f', 1)
+                         .arg(double(s.percentileNs(0.99)) / 1000.0, 0, 'f', 1)
+                         .arg(double(s.percentileNs(0.999)) / 1000.0, 0, 'f', 1)
+                         .arg(double(s.maxNs) / 1000.0, 0, 'f', 1);
+        };
+        for (int p = 0; p < int(LatencyPath::Count); ++p) {
+            line(pathName(LatencyPath(p)), m_paths[std::size_t(p)].snapshot());
+        }
+        for (int s = 0; s < int(LatencyStage::Count); ++s) {
+            line(stageName(LatencyStage(s)), m_stages[std::size_t(s)].snapshot());
+        }
+        return lines;
+    }
+
+private:
+    static QJsonObject histogramJson(const LatencyHistogram::Snapshot& s) {
+        const auto us = [](std::int64_t ns) { return double(ns) / 1000.0; };
+        QJsonObject o;
+        o.insert("count", double(s.count));
+        o.insert("mean", s.meanNs() / 1000.0);
+        o.insert("max", us(s.maxNs));
+        o.insert("p50", us(s.percentileNs(0.50)));
+        o.insert("p90", us(s.percentileNs(0.90)));
+        o.insert("p99", us(s.percentileNs(0.99)));
+        o.insert("p999", us(s.percentileNs(0.999)));
+        QJsonArray buckets;
+        for (int b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            if (!s.counts[std::size_t(b)]) continue;
+            QJsonArray bucket;
+            bucket.append(double(LatencyHistogram::bucketLowNs(b)));
+            bucket.append(double(LatencyHistogram::bucketHighNs(b)));
+            bucket.append(double(s.counts[std::size_t(b)]));
+            buckets.append(bucket);
+        }
+        o.insert("buckets_ns", buckets);
+        return o;
+    }
+
+    std::array<LatencyHistogram, std::size_t(LatencyPath::Count)> m_paths;
+    std::array<LatencyHistogram, std::size_t(LatencyStage::Count)> m_stages;
+};
+
+} // namespace midi
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "midi/MidiBackend.h"
+#include "midi/MidiMsg.h"
+
+namespace midi {
+
+// In-memory IMidiBackend for tests, benchmarks and replay: no OS ports.
+//
+// Ports exist once declared with addInput()/addOutput() and are matched by
+// name fragment like the RtMidi backend. deliver() runs the opened input's
+// callback on the calling thread, so each input must be fed from one thread
+// at a time (as a CoreMIDI source would). Sent messages are appended,
+// with their send time, to a preallocated per-output log that one thread
+// (the MIDI worker) writes and any thread may read up to sentCount().
+class MemoryMidiBackend final : public IMidiBackend {
+public:
+    struct SentMessage {
+        std::int64_t tNs = 0; // monotonicNowNs() when sendMessage() was called
+        MidiMsg msg;
+    };
+
+    class Input final : public IMidiInputPort {
+    public:
+        void setCallback(InputCallback fn, void* userData) override {
+            m_userData = userData;
+            m_fn.store(fn, std::memory_order_release);
+        }
+        void ignoreTypes(bool sysex, bool timing, bool activeSensing) override {
+            m_ignoreSysex = sysex;
+            m_ignoreTiming = timing;
+            m_ignoreSensing = activeSensing;
+        }
+        // Returns false if nothing is listening or the type is filtered.
+        bool deliver(const MidiMsg& m, double deltaSeconds = 0.0) {
+            const InputCallback fn = m_fn.load(std::memory_order_acquire);
+            if (!fn || m.empty() || ignored(m.status())) return false;
+            m_scratch.assign(m.data(), m.data() + m.size()); // capacity reserved: no allocation
+            fn(deltaSeconds, &m_scratch, m_userData);
+            return true;
+        }
+
+    private:
+        bool ignored(std::uint8_t status) const {
+            if (status == 0xF0) return m_ignoreSysex;
+            if (status == 0xF8 || status == 0xF1) return m_ignoreTiming;
+            if (status == 0xFE) return m_ignoreSensing;
+            return false;
+        }
+
+        std::atomic<InputCallback> m_fn{nullptr};
+        void* m_userData = nullptr;
+        bool m_ignoreSysex = true;
+        bool m_ignoreTiming = true;
+        bool m_ignoreSensing = true;
+        std::vector<unsigned char> m_scratch = std::vector<unsigned char>(MidiMsg::kMaxBytes);
+    };
+
+    class Output final : public IMidiOutputPort {
+    public:
+        explicit Output(std::size_t capacity) : m_log(capacity) {}
+        void sendMessage(const unsigned char* data, std::size_t size) override {
+            const std::size_t n = m_count.load(std::memory_order_relaxed);
+            if (n == m_log.size()) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_log[n].tNs = monotonicNowNs();
+            MidiMsg::fromBytes(data, size, m_log[n].msg);
+            m_count.store(n + 1, std::memory_order_release);
+        }
+        std::size_t sentCount() const { return m_count.load(std::memory_order_acquire); }
+        const SentMessage& sent(std::size_t i) const { return m_log[i]; }
+        std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+        // Only while nothing is sending.
+        void clear() {
+            m_count.store(0, std::memory_order_relaxed);
+            m_dropped.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::vector<SentMessage> m_log;
+        std::atomic<std::size_t> m_count{0};
+        std::atomic<std::uint64_t> m_dropped{0};
+    };
+
+    explicit MemoryMidiBackend(std::size_t outputCapacity = 1 << 20) : m_outputCapacity(outputCapacity) {}
+
+    // Declares a port. The backend keeps ownership of the port object: the
+    // IMidi*Port handed out by open*() is a thin handle onto it, so the
+    // backend must outlive whoever opened it.
+    Input& addInput(const std::string& name) { return *(m_inputs[name] = std::make_unique<Input>()); }
+    Output& addOutput(const std::string& name) {
+        return *(m_outputs[name] = std::make_unique<Output>(m_outputCapacity));
+    }
+    Input* input(const std::string& name) const {
+        const auto it = m_inputs.find(name);
+        return it == m_inputs.end() ? nullptr : it->second.get();
+    }
+    Output* output(const std::string& name) const {
+        const auto it = m_outputs.find(name);
+        return it == m_outputs.end() ? nullptr : it->second.get();
+    }
+
+    std::unique_ptr<IMidiInputPort> openInput(const std::string& nameFragment) override {
+        for (auto& [name, in] : m_inputs) {
+            if (name.find(nameFragment) != std::string::npos) return std::make_unique<InputHandle>(*in);
+        }
+        return nullptr;
+    }
+    std::unique_ptr<IMidiOutputPort> openOutput(const std::string& nameFragment) override {
+        for (auto& [name, out] : m_outputs) {
+            if (name.find(nameFragment) != std::string::npos) return std::make_unique<OutputHandle>(*out);
+        }
+        return nullptr;
+    }
+    std::unique_ptr<IMidiOutputPort> openVirtualOutput(const std::string& name) override {
+        Output* out = output(name);
+        return std::make_unique<OutputHandle>(out ? *out : addOutput(name));
+    }
+
+private:
+    // Handles detach the callback when closed, like closing an RtMidiIn.
+    class InputHandle final : public IMidiInputPort {
+    public:
+        explicit InputHandle(Input& in) : m_in(in) {}
+        ~InputHandle() override { m_in.setCallback(nullptr, nullptr); }
+        void setCallback(InputCallback fn, void* userData) override { m_in.setCallback(fn, userData); }
+        void ignoreTypes(bool sysex, bool timing, bool activeSensing) override {
+            m_in.ignoreTypes(sysex, timing, activeSensing);
+        }
+
+    private:
+        Input& m_in;
+    };
+    class OutputHandle final : public IMidiOutputPort {
+    public:
+        explicit OutputHandle(Output& out) : m_out(out) {}
+        void sendMessage(const unsigned char* data, std::size_t size) override { m_out.sendMessage(data, size); }
+
+    private:
+        Output& m_out;
+    };
+
+    std::size_t m_outputCapacity;
+    std::map<std::string, std::unique_ptr<Input>> m_inputs;
+    std::map<std::string, std::unique_ptr<Output>> m_outputs;
+};
+
+} // namespace midi
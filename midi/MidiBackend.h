@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RtMidi.h"
+
+namespace midi {
+
+// Same shape as RtMidiIn::RtMidiCallback, so MidiProcessor's static
+// callbacks work unchanged with any backend.
+using InputCallback = void (*)(double deltaSeconds, std::vector<unsigned char>* message, void* userData);
+
+// An opened input port. The callback runs on the backend's delivery thread,
+// one thread per port (the SPSC rings rely on that).
+class IMidiInputPort {
+public:
+    virtual ~IMidiInputPort() = default;
+    virtual void setCallback(InputCallback fn, void* userData) = 0;
+    virtual void ignoreTypes(bool sysex, bool timing, bool activeSensing) = 0;
+};
+
+// An opened output port. Called from the MIDI worker (and at teardown).
+// May throw RtMidiError; MidiProcessor::safeSendMessage catches.
+class IMidiOutputPort {
+public:
+    virtual ~IMidiOutputPort() = default;
+    virtual void sendMessage(const unsigned char* data, std::size_t size) = 0;
+};
+
+// Where MidiProcessor::initialize() gets its ports from. Lookups match on a
+// name fragment, like the preset's port names always have; nullptr = no
+// such port (or it failed to open).
+class IMidiBackend {
+public:
+    virtual ~IMidiBackend() = default;
+    virtual std::unique_ptr<IMidiInputPort> openInput(const std::string& nameFragment) = 0;
+    virtual std::unique_ptr<IMidiOutputPort> openOutput(const std::string& nameFragment) = 0;
+    virtual std::unique_ptr<IMidiOutputPort> openVirtualOutput(const std::string& name) = 0;
+};
+
+// --- RtMidi (CoreMIDI in the app; the dummy API elsewhere) ---
+
+class RtMidiInputPort final : public IMidiInputPort {
+public:
+    explicit RtMidiInputPort(std::unique_ptr<RtMidiIn> in) : m_in(std::move(in)) {}
+    void setCallback(InputCallback fn, void* userData) override { m_in->setCallback(fn, userData); }
+    void ignoreTypes(bool sysex, bool timing, bool activeSensing) override {
+        m_in->ignoreTypes(sysex, timing, activeSensing);
+    }
+
+private:
+    std::unique_ptr<RtMidiIn> m_in;
+};
+
+class RtMidiOutputPort final : public IMidiOutputPort {
+public:
+    explicit RtMidiOutputPort(std::unique_ptr<RtMidiOut> out) : m_out(std::move(out)) {}
+    void sendMessage(const unsigned char* data, std::size_t size) override { m_out->sendMessage(data, size); }
+
+private:
+    std::unique_ptr<RtMidiOut> m_out;
+};
+
+class RtMidiBackend final : public IMidiBackend {
+public:
+    explicit RtMidiBackend(RtMidi::Api api = RtMidi::UNSPECIFIED) : m_api(api) {}
+
+    std::unique_ptr<IMidiInputPort> openInput(const std::string& nameFragment) override {
+        auto in = std::make_unique<RtMidiIn>(m_api);
+        const int port = findPort(*in, nameFragment);
+        if (port < 0) return nullptr;
+        in->openPort(unsigned(port));
+        return std::make_unique<RtMidiInputPort>(std::move(in));
+    }
+    std::unique_ptr<IMidiOutputPort> openOutput(const std::string& nameFragment) override {
+        auto out = std::make_unique<RtMidiOut>(m_api);
+        const int port = findPort(*out, nameFragment);
+        if (port < 0) return nullptr;
+        out->openPort(unsigned(port));
+        return std::make_unique<RtMidiOutputPort>(std::move(out));
+    }
+    std::unique_ptr<IMidiOutputPort> openVirtualOutput(const std::string& name) override {
+        try {
+            auto out = std::make_unique<RtMidiOut>(m_api);
+            out->openVirtualPort(name);
+            return std::make_unique<RtMidiOutputPort>(std::move(out));
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+private:
+    static int findPort(RtMidi& midi, const std::string& name) {
+        for (unsigned int i = 0; i < midi.getPortCount(); i++) {
+            if (midi.getPortName(i).find(name) != std::string::npos) return (int)i;
+        }
+        return -1;
+    }
+
+    RtMidi::Api m_api;
+};
+
+} // namespace midi
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "midi/MidiMsg.h"
+
+namespace midi {
+
+// Where a captured message was seen: the MidiProcessor inputs (what a
+// replay feeds back in), then its two outputs (what the recorder logs as
+// sent; replays skip them).
+enum class CapturePort : std::uint8_t {
+    Guitar,
+    VoiceAmp,
+    VoicePitch,
+    Ampero,
+    VirtualBand,
+    Out,       // CONTROLLER_OUT
+    VocalSync, // VocalSync output
+    Count
+};
+
+inline const char* capturePortName(CapturePort p) {
+    static const char* const names[] = {"guitar", "voice_amp", "voice_pitch", "ampero", "virtual_band", "out",
+                                        "vocalsync"};
+    return p < CapturePort::Count ? names[int(p)] : "?";
+}
+inline bool isCaptureInput(CapturePort p) { return p < CapturePort::Out; }
+
+// One timestamped input message. tNs is relative to the start of the capture.
+struct CaptureEvent {
+    std::int64_t tNs = 0;
+    CapturePort port = CapturePort::Guitar;
+    MidiMsg msg;
+};
+
+using MidiCapture = std::vector<CaptureEvent>;
+
+// Text form, one event per line: "<time_us> <port> <status> [<d1> [<d2>]]"
+// with the bytes in hex, e.g. "1250000 guitar 90 40 60". Blank lines and
+// lines starting with '#' are skipped. Events must be in time order.
+inline bool loadTextCapture(const QString& path, MidiCapture& out, QString* error = nullptr) {
+    const auto fail = [error](const QString& why) {
+        if (error) *error = why;
+        return false;
+    };
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return fail(QString("cannot open %1").arg(path));
+    out.clear();
+    QTextStream in(&f);
+    int lineNo = 0;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        ++lineNo;
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.size() < 3 || parts.size() > 5) return fail(QString("line %1: expected 3-5 fields").arg(lineNo));
+        CaptureEvent ev;
+        bool ok = false;
+        ev.tNs = parts[0].toLongLong(&ok) * 1000;
+        if (!ok || (!out.empty() && ev.tNs < out.back().tNs)) return fail(QString("line %1: bad time").arg(lineNo));
+        ev.port = CapturePort::Count;
+        for (int p = 0; p < int(CapturePort::Count); ++p) {
+            if (parts[1] == capturePortName(CapturePort(p))) ev.port = CapturePort(p);
+        }
+        if (ev.port == CapturePort::Count) return fail(QString("line %1: unknown port '%2'").arg(lineNo).arg(parts[1]));
+        unsigned char bytes[MidiMsg::kMaxBytes];
+        const int n = int(parts.size()) - 2;
+        for (int i = 0; i < n; ++i) {
+            const uint v = parts[2 + i].toUInt(&ok, 16);
+            if (!ok || v > 0xFF) return fail(QString("line %1: bad byte '%2'").arg(lineNo).arg(parts[2 + i]));
+            bytes[i] = (unsigned char)v;
+        }
+        MidiMsg::fromBytes(bytes, std::size_t(n), ev.msg);
+        out.push_back(ev);
+    }
+    return true;
+}
+
+inline bool saveTextCapture(const QString& path, const MidiCapture& capture) {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+    QTextStream out(&f);
+    out << "# time_us port status [d1 [d2]] (hex bytes)\n";
+    for (const CaptureEvent& ev : capture) {
+        out << ev.tNs / 1000 << ' ' << capturePortName(ev.port);
+        for (std::size_t i = 0; i < ev.msg.size(); ++i) {
+            out << ' ' << QString("%1").arg(ev.msg[i], 2, 16, QChar('0'));
+        }
+        out << '\n';
+    }
+    return true;
+}
+
+// --- Binary form ---
+//
+// Compact and append-only, as written by MidiRecorder: a 16-byte header
+// ("MIDICAP1" + the wall-clock start time in ms, little endian), then one
+// record per event:
+//   tag      bits 0-1 message length (1-3), bits 2-4 port, bits 5-7 zero
+//   delta    zigzag varint, microseconds since the previous record
+//   bytes    the message itself
+// so a note-on a few ms after the previous event takes 6 bytes and a dense
+// pressure stream 4-5. Records are in write order, which is not strictly
+// time order (an input is logged with its arrival time, after the outputs
+// sent meanwhile), hence the signed delta. A tag of 0x80 is a gap marker
+// followed by a varint count of events the recorder had to drop. A record
+// cut short at the end of the file (crash mid-write) is ignored.
+inline constexpr char kBinaryCaptureMagic[8] = {'M', 'I', 'D', 'I', 'C', 'A', 'P', '1'};
+inline constexpr int kBinaryCaptureHeaderBytes = 16;
+inline constexpr std::uint8_t kBinaryCaptureGapTag = 0x80;
+
+inline QByteArray binaryCaptureHeader(std::int64_t wallClockMs) {
+    QByteArray h(kBinaryCaptureMagic, int(sizeof(kBinaryCaptureMagic)));
+    for (int i = 0; i < 8; ++i) h.append(char(std::uint64_t(wallClockMs) >> (8 * i)));
+    return h;
+}
+
+class BinaryCaptureEncoder {
+public:
+    // tNs is relative to the capture start.
+    void encode(CapturePort port, const MidiMsg& m, std::int64_t tNs, QByteArray& out) {
+        if (m.empty()) return;
+        const std::int64_t us = tNs / 1000;
+        out.append(char((std::uint8_t(port) & 0x07) << 2 | (m.len & 0x03)));
+        appendVarint(zigzag(us - m_prevUs), out);
+        out.append(reinterpret_cast<const char*>(m.data()), int(m.size()));
+        m_prevUs = us;
+    }
+    void encodeGap(std::uint64_t dropped, QByteArray& out) {
+        out.append(char(kBinaryCaptureGapTag));
+        appendVarint(dropped, out);
+    }
+
+private:
+    static std::uint64_t zigzag(std::int64_t v) { return (std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63); }
+    static void appendVarint(std::uint64_t v, QByteArray& out) {
+        while (v >= 0x80) {
+            out.append(char(0x80 | (v & 0x7F)));
+            v >>= 7;
+        }
+        out.append(char(v));
+    }
+
+    std::int64_t m_prevUs = 0;
+};
+
+// Loads a binary capture, stably sorted into time order. `dropped` gets the
+// sum of the gap markers, `startedMs` the header's wall-clock start.
+inline bool loadBinaryCapture(const QString& path, MidiCapture& out, QString* error = nullptr,
+                              std::uint64_t* dropped = nullptr, std::int64_t* startedMs = nullptr) {
+    const auto fail = [error](const QString& why) {
+        if (error) *error = why;
+        return false;
+    };
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return fail(QString("cannot open %1").arg(path));
+    const QByteArray data = f.readAll();
+    if (data.size() < kBinaryCaptureHeaderBytes ||
+        !std::equal(kBinaryCaptureMagic, kBinaryCaptureMagic + 8, data.constData())) {
+        return fail(QString("%1 is not a binary MIDI capture").arg(path));
+    }
+    const auto* p = reinterpret_cast<const std::uint8_t*>(data.constData());
+    const auto* const end = p + data.size();
+    std::uint64_t started = 0;
+    for (int i = 0; i < 8; ++i) started |= std::uint64_t(p[8 + i]) << (8 * i);
+    if (startedMs) *startedMs = std::int64_t(started);
+    p += kBinaryCaptureHeaderBytes;
+
+    const auto readVarint = [&p, end](std::uint64_t& v) {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            const std::uint8_t b = *p++;
+            v |= std::uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    };
+    out.clear();
+    std::uint64_t gaps = 0;
+    std::int64_t us = 0;
+    while (p < end) {
+        const std::uint8_t tag = *p++;
+        std::uint64_t v = 0;
+        if (tag == kBinaryCaptureGapTag) {
+            if (!readVarint(v)) break;
+            gaps += v;
+            continue;
+        }
+        const std::size_t len = tag & 0x03;
+        const CapturePort port = CapturePort((tag >> 2) & 0x07);
+        if ((tag & 0xE0) || len == 0 || port >= CapturePort::Count) {
+            return fail(QString("corrupt record at byte %1").arg(p - 1 - reinterpret_cast<const std::uint8_t*>(data.constData())));
+        }
+        if (!readVarint(v) || std::size_t(end - p) < len) break; // truncated tail
+        us += std::int64_t(v >> 1) ^ -std::int64_t(v & 1);
+        CaptureEvent ev;
+        ev.tNs = us * 1000;
+        ev.port = port;
+        MidiMsg::fromBytes(p, len, ev.msg);
+        p += len;
+        out.push_back(ev);
+    }
+    std::stable_sort(out.begin(), out.end(), [](const CaptureEvent& a, const CaptureEvent& b) { return a.tNs < b.tNs; });
+    if (dropped) *dropped = gaps;
+    return true;
+}
+
+// Either form, told apart by the binary magic.
+inline bool loadCapture(const QString& path, MidiCapture& out, QString* error = nullptr,
+                        std::uint64_t* dropped = nullptr) {
+    if (dropped) *dropped = 0;
+    QFile f(path);
+    if (f.open(QIODevice::ReadOnly) && f.peek(8) == QByteArray(kBinaryCaptureMagic, 8)) {
+        f.close();
+        return loadBinaryCapture(path, out, error, dropped);
+    }
+    return loadTextCapture(path, out, error);
+}
+
+// --- Standard MIDI File export ---
+//
+// Format 1, one track per port present, named after it. Division 1000 at
+// 60 bpm, so one tick is one millisecond of capture time. Only channel
+// messages are written.
+inline bool saveSmf(const QString& path, const MidiCapture& capture, QString* error = nullptr) {
+    const auto be = [](QByteArray& b, std::uint32_t v, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) b.append(char((v >> (8 * i)) & 0xFF));
+    };
+    const auto vlq = [](QByteArray& b, std::uint32_t v) {
+        char buf[5];
+        int n = 0;
+        buf[n++] = char(v & 0x7F);
+        while (v >>= 7) buf[n++] = char(0x80 | (v & 0x7F));
+        while (n > 0) b.append(buf[--n]);
+    };
+    const auto chunk = [&be](QByteArray& file, const char* id, const QByteArray& body) {
+        file.append(id, 4);
+        be(file, std::uint32_t(body.size()), 4);
+        file.append(body);
+    };
+
+    QByteArray tracks;
+    int trackCount = 1;
+    {
+        QByteArray tempo; // conductor track: 60 bpm
+        vlq(tempo, 0);
+        tempo.append("\xFF\x51\x03", 3);
+        be(tempo, 1000000, 3);
+        vlq(tempo, 0);
+        tempo.append("\xFF\x2F\x00", 3);
+        chunk(tracks, "MTrk", tempo);
+    }
+    for (int p = 0; p < int(CapturePort::Count); ++p) {
+        QByteArray body;
+        std::int64_t lastMs = 0;
+        bool any = false;
+        for (const CaptureEvent& ev : capture) {
+            if (int(ev.port) != p || !ev.msg.isChannelMessage()) continue;
+            if (!any) {
+                const QByteArray name(capturePortName(CapturePort(p)));
+                vlq(body, 0);
+                body.append("\xFF\x03", 2);
+                vlq(body, std::uint32_t(name.size()));
+                body.append(name);
+                any = true;
+            }
+            const std::int64_t ms = std::max<std::int64_t>(ev.tNs / 1000000, lastMs);
+            vlq(body, std::uint32_t(ms - lastMs));
+            body.append(reinterpret_cast<const char*>(ev.msg.data()), int(ev.msg.size()));
+            lastMs = ms;
+        }
+        if (!any) continue;
+        vlq(body, 0);
+        body.append("\xFF\x2F\x00", 3);
+        chunk(tracks, "MTrk", body);
+        ++trackCount;
+    }
+
+    QByteArray header;
+    be(header, 1, 2); // format 1
+    be(header, std::uint32_t(trackCount), 2);
+    be(header, 1000, 2); // ticks per quarter note
+    QByteArray file;
+    chunk(file, "MThd", header);
+    file.append(tracks);
+
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(file) != file.size()) {
+        if (error) *error = QString("cannot write %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+} // namespace midi
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace midi {
+
+// Monotonic nanoseconds (steady clock). Used for message timestamps.
+inline std::int64_t monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Fixed-size, trivially copyable MIDI channel message.
+//
+// Every message on the live path (RtMidi input -> worker -> RtMidi output)
+// is a channel message of at most 3 bytes: the live inputs ignore SysEx,
+// timing and active sensing. Carrying it inline removes the per-message
+// std::vector allocation and lets it travel through the lock-free rings
+// with a plain copy.
+struct MidiMsg {
+    std::uint8_t bytes[3] = {0, 0, 0}; // status, data1, data2
+    std::uint8_t len = 0;              // 0 = empty, otherwise 1..3
+    std::int64_t timestampNs = 0;      // monotonic arrival time; 0 = unknown
+
+    static constexpr std::size_t kMaxBytes = 3;
+
+    static constexpr MidiMsg make(std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+        MidiMsg m;
+        m.bytes[0] = status;
+        m.bytes[1] = d1;
+        m.bytes[2] = d2;
+        m.len = 3;
+        return m;
+    }
+
+    // Returns false (and leaves `out` empty) for empty or oversized input.
+    static bool fromBytes(const unsigned char* data, std::size_t n, MidiMsg& out) {
+        out = MidiMsg{};
+        if (!data || n == 0 || n > kMaxBytes) return false;
+        out.len = std::uint8_t(n);
+        for (std::size_t i = 0; i < n; ++i) out.bytes[i] = data[i];
+        return true;
+    }
+    static bool fromVector(const std::vector<unsigned char>* v, MidiMsg& out) {
+        if (!v) { out = MidiMsg{}; return false; }
+        return fromBytes(v->data(), v->size(), out);
+    }
+
+    bool empty() const { return len == 0; }
+    std::size_t size() const { return len; }
+    const unsigned char* data() const { return bytes; }
+
+    std::uint8_t& operator[](std::size_t i) { return bytes[i]; }
+    std::uint8_t operator[](std::size_t i) const { return bytes[i]; }
+
+    std::uint8_t status() const { return bytes[0]; }
+    std::uint8_t type() const { return std::uint8_t(bytes[0] & 0xF0); }
+    std::uint8_t channelNibble() const { return std::uint8_t(bytes[0] & 0x0F); }
+    std::uint8_t data1() const { return bytes[1]; }
+    std::uint8_t data2() const { return bytes[2]; }
+    bool isChannelMessage() const { return len > 0 && bytes[0] < 0xF0; }
+
+    // Copy with the channel nibble replaced (0-based). Only valid for
+    // channel messages; system messages are returned unchanged.
+    MidiMsg withChannel(std::uint8_t zeroBasedChannel) const {
+        MidiMsg m = *this;
+        if (m.isChannelMessage()) m.bytes[0] = std::uint8_t((m.bytes[0] & 0xF0) | (zeroBasedChannel & 0x0F));
+        return m;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<MidiMsg>, "MidiMsg must stay POD-like for the rings");
+static_assert(sizeof(MidiMsg) <= 16, "MidiMsg should fit in a quarter cache line");
+
+} // namespace midi
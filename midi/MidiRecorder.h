@@ -0,0 +1,169 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "midi/MidiCapture.h"
+#include "midi/MidiMsg.h"
+#include "midi/SpscRing.h"
+
+namespace midi {
+
+// Capture recorder for performance forensics: every message the MIDI worker
+// takes in or sends out, with its port and a nanosecond timestamp, into a
+// preallocated ring that a background thread flushes to the binary capture
+// format (midi/MidiCapture.h).
+//
+// record() is for one producer thread (the worker) and costs a relaxed load
+// when not recording, a ring push when recording: no lock, no allocation,
+// no I/O. When the flusher falls behind and the ring fills, events are
+// counted and written as a gap marker instead. start()/stop() are for
+// control threads; a second start() while recording fails.
+class MidiRecorder {
+public:
+    static constexpr std::size_t kRingCapacity = 1 << 16; // ~1 MB, seconds of dense traffic
+    static constexpr int kFlushIntervalMs = 20;
+
+    ~MidiRecorder() { stop(); }
+
+    bool start(const QString& path, QString* error = nullptr) {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (m_flusher.joinable()) {
+            if (error) *error = QString("already recording to %1").arg(m_path);
+            return false;
+        }
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            if (error) *error = QString("cannot open %1").arg(path);
+            return false;
+        }
+        m_file.write(binaryCaptureHeader(QDateTime::currentMSecsSinceEpoch()));
+        m_path = path;
+        // Whatever a previous session's late pushes left behind belongs to no file.
+        Record stale;
+        while (m_ring.pop(stale)) {}
+        m_encoder = BinaryCaptureEncoder();
+        m_reportedDrops = 0;
+        m_dropped.store(0, std::memory_order_relaxed);
+        m_recorded.store(0, std::memory_order_relaxed);
+        m_bytesWritten.store(kBinaryCaptureHeaderBytes, std::memory_order_relaxed);
+        m_startNs = monotonicNowNs();
+        m_stopFlusher = false;
+        m_flusher = std::thread(&MidiRecorder::flushLoop, this);
+        m_recording.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Stops taking events, flushes what is queued and closes the file.
+    void stop() {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (!m_flusher.joinable()) return;
+        m_recording.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+            m_stopFlusher = true;
+        }
+        m_wakeCv.notify_one();
+        m_flusher.join();
+        m_file.close();
+    }
+
+    bool recording() const { return m_recording.load(std::memory_order_relaxed); }
+
+    // Producer side (one thread).
+    void record(CapturePort port, const MidiMsg& m, std::int64_t tNs) {
+        if (!m_recording.load(std::memory_order_relaxed)) return;
+        Record r;
+        r.tNs = tNs;
+        r.bytes[0] = m.bytes[0];
+        r.bytes[1] = m.bytes[1];
+        r.bytes[2] = m.bytes[2];
+        r.len = m.len;
+        r.port = port;
+        if (m_ring.push(r)) {
+            m_recorded.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    QString path() const {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        return m_path;
+    }
+    std::uint64_t recorded() const { return m_recorded.load(std::memory_order_relaxed); }
+    std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    std::uint64_t bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+
+private:
+    struct Record {
+        std::int64_t tNs = 0;
+        std::uint8_t bytes[3] = {0, 0, 0};
+        std::uint8_t len = 0;
+        CapturePort port = CapturePort::Guitar;
+    };
+
+    void flushLoop() {
+        QByteArray buf;
+        buf.reserve(64 * 1024);
+        for (;;) {
+            bool stopping = false;
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wakeCv.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs), [this] { return m_stopFlusher; });
+                stopping = m_stopFlusher;
+            }
+            flushPending(buf);
+            if (stopping) return;
+        }
+    }
+
+    void flushPending(QByteArray& buf) {
+        buf.clear();
+        Record r;
+        while (m_ring.pop(r)) {
+            MidiMsg m;
+            MidiMsg::fromBytes(r.bytes, r.len, m);
+            m_encoder.encode(r.port, m, r.tNs - m_startNs, buf);
+        }
+        const std::uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_reportedDrops) {
+            m_encoder.encodeGap(dropped - m_reportedDrops, buf);
+            m_reportedDrops = dropped;
+        }
+        if (buf.isEmpty()) return;
+        m_file.write(buf);
+        m_file.flush();
+        m_bytesWritten.fetch_add(std::uint64_t(buf.size()), std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> m_recording{false};
+    std::atomic<std::uint64_t> m_recorded{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::atomic<std::uint64_t> m_bytesWritten{0};
+    SpscRing<Record, kRingCapacity> m_ring;
+
+    // Flusher-owned while recording.
+    QFile m_file;
+    BinaryCaptureEncoder m_encoder;
+    std::uint64_t m_reportedDrops = 0;
+    std::int64_t m_startNs = 0;
+
+    mutable std::mutex m_controlMutex;
+    QString m_path;
+    std::thread m_flusher;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    bool m_stopFlusher = false;
+};
+
+} // namespace midi
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "midi/SpscRing.h"
+
+namespace midi {
+
+// Lock-free bounded multi-producer / single-consumer ring (Vyukov-style
+// per-slot sequence numbers).
+//
+// Any thread may push(); only one thread may pop()/empty(). Producers race
+// on a single CAS for a slot index and never block on each other or on the
+// consumer. Used for the sendVirtual* path, which is called from the GUI
+// thread, the playback engine and ScaleSnapProcessor.
+template <typename T, std::size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MpscRing capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "MpscRing slots are copied with plain stores");
+
+public:
+    MpscRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    // Producer side (any thread). Returns false when the ring is full.
+    bool push(const T& value) {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[pos & kMask];
+            const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+            const std::intptr_t dif = std::intptr_t(seq) - std::intptr_t(pos);
+            if (dif == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+                // CAS failure reloaded pos; retry.
+            } else if (dif < 0) {
+                return false; // full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer side. Returns false when the ring is empty (or the next slot
+    // has been claimed but not yet published by its producer).
+    bool pop(T& out) {
+        Slot& slot = m_slots[m_dequeuePos & kMask];
+        const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+        if (std::intptr_t(seq) - std::intptr_t(m_dequeuePos + 1) < 0) return false;
+        out = slot.value;
+        slot.seq.store(m_dequeuePos + Capacity, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+    // Consumer side (used as a wake-up predicate).
+    bool empty() const {
+        const Slot& slot = m_slots[m_dequeuePos & kMask];
+        const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+        return std::intptr_t(seq) - std::intptr_t(m_dequeuePos + 1) < 0;
+    }
+
+    // Consumer side. Slots claimed so far, including ones whose producer has
+    // not published yet (pop() stops short of those).
+    std::size_t sizeApprox() const {
+        return m_enqueuePos.load(std::memory_order_acquire) - m_dequeuePos;
+    }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    struct Slot {
+        std::atomic<std::size_t> seq{0};
+        T value{};
+    };
+
+    alignas(kCacheLineBytes) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas(kCacheLineBytes) std::size_t m_dequeuePos = 0; // consumer-local
+    alignas(kCacheLineBytes) Slot m_slots[Capacity];
+};
+
+} // namespace midi
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "midi/SpscRing.h"
+
+namespace midi {
+
+// Single-writer latest-value cell (seqlock). The writer never waits: store()
+// bumps the sequence to odd, writes the value and bumps it back to even.
+// Readers retry while a write is in flight or raced their copy, so they
+// always see one whole value, never a mix of two. The value is kept as
+// relaxed atomic words, so concurrent reads aren't a data race.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied bytewise");
+
+public:
+    Seqlock() { store(T{}); }
+
+    // Writer side (one thread).
+    void store(const T& value) {
+        std::uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+        const std::uint64_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i) m_words[i].store(words[i], std::memory_order_relaxed);
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Any thread.
+    T load() const {
+        std::uint64_t words[kWords];
+        for (;;) {
+            const std::uint64_t before = m_seq.load(std::memory_order_acquire);
+            if (before & 1u) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < kWords; ++i) words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_seq.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // Even, and bumped by 2 per store(): "has anything changed since".
+    std::uint64_t version() const { return m_seq.load(std::memory_order_acquire); }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + 7) / 8;
+
+    alignas(kCacheLineBytes) std::atomic<std::uint64_t> m_seq{0};
+    std::atomic<std::uint64_t> m_words[kWords]; // written by the constructor
+};
+
+} // namespace midi
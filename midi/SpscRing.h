@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace midi {
+
+// Cache-line size used to keep producer- and consumer-owned indices apart.
+inline constexpr std::size_t kCacheLineBytes = 64;
+
+// Wait-free bounded single-producer / single-consumer ring.
+//
+// Exactly one thread may call push() (e.g. one RtMidi input callback) and
+// exactly one thread may call pop()/empty() (the MIDI worker). Neither side
+// ever blocks, allocates or takes a lock. Indices are free-running, so all
+// Capacity slots are usable; Capacity must be a power of two.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SpscRing slots are copied with plain stores");
+
+public:
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    // Producer side. Returns false when the ring is full (caller decides
+    // whether to drop or divert the value).
+    bool push(const T& value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail >= Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail >= Capacity) return false;
+        }
+        m_slots[head & kMask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T& out) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) return false;
+        }
+        out = m_slots[tail & kMask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side (used as a wake-up predicate).
+    bool empty() const {
+        return m_tail.load(std::memory_order_relaxed) == m_head.load(std::memory_order_acquire);
+    }
+
+    // Approximate fill level; exact only when called from the consumer.
+    std::size_t sizeApprox() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    alignas(kCacheLineBytes) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail = 0; // producer-local view of m_tail
+
+    alignas(kCacheLineBytes) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_cachedHead = 0; // consumer-local view of m_head
+
+    alignas(kCacheLineBytes) T m_slots[Capacity];
+};
+
+} // namespace midi
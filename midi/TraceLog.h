@@ -0,0 +1,195 @@
+#pragma once
+
+#include <QString>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "midi/MidiMsg.h"
+#include "midi/SpscRing.h"
+
+// Highest TraceLevel compiled in. Trace calls above it compile to nothing,
+// e.g. -DMIDI_TRACE_MAX_LEVEL=1 keeps only errors and warnings.
+#ifndef MIDI_TRACE_MAX_LEVEL
+#define MIDI_TRACE_MAX_LEVEL 3
+#endif
+
+namespace midi {
+
+enum class TraceLevel : std::uint8_t { Error = 0, Warn = 1, Info = 2, Debug = 3 };
+
+enum class TraceCategory : std::uint8_t { Guitar, Voice, Ampero, VirtualBand, Pitch, ScaleSnap, Count };
+
+// One id per trace site; the arguments each one carries are listed with
+// its format in formatTraceRecord().
+enum class TraceEvent : std::uint16_t {
+    GuitarRawMirrorNoteOn,
+    VoiceCh10NoteOn,
+    VoiceCh10NoteOnHeld,
+    VoiceCh10NoteOffDeferred,
+    VoiceCh10NoteOffFlushed,
+    VoiceCh10HeldReleasedByMask,
+    AmperoCc,
+    AmperoFanOut,
+    AmperoHarmonyToggle,
+    AmperoPassthrough,
+    VirtualBandNoteOn,
+    VirtualBandNoteOff,
+    PitchBendCcs,
+    ScaleSnapLead,
+    ScaleSnapHarmonyVoice,
+    ScaleSnapHarmonyLegacy,
+    ScaleSnapNoteOff,
+};
+
+// Fixed-size binary record: an event id plus up to four ints. Formatting
+// happens only when the consumer drains it.
+struct TraceRecord {
+    std::int64_t tNs = 0; // monotonicNowNs()
+    TraceEvent event = TraceEvent::GuitarRawMirrorNoteOn;
+    TraceCategory category = TraceCategory::Guitar;
+    TraceLevel level = TraceLevel::Info;
+    std::int32_t args[4] = {0, 0, 0, 0};
+};
+
+// Process-wide trace sink. Each producing thread claims one of kMaxThreads
+// preallocated SPSC rings on its first record and writes only to that one,
+// so writers never lock, allocate or format. A single consumer (the log
+// poll timer) drains all rings. Records from threads beyond kMaxThreads,
+// or written while a ring is full, are counted and dropped.
+class TraceLog {
+public:
+    static constexpr int kMaxThreads = 8;
+    static constexpr std::size_t kRingCapacity = 1024;
+
+    static TraceLog& instance() {
+        static TraceLog log;
+        return log;
+    }
+
+    // Runtime filters: records above the level or in a disabled category
+    // are skipped before anything is written.
+    void setLevel(TraceLevel level) { m_level.store(std::uint8_t(level), std::memory_order_relaxed); }
+    void setCategoryEnabled(TraceCategory c, bool on) {
+        const std::uint32_t bit = 1u << unsigned(c);
+        if (on) m_categories.fetch_or(bit, std::memory_order_relaxed);
+        else m_categories.fetch_and(~bit, std::memory_order_relaxed);
+    }
+    bool enabled(TraceLevel level, TraceCategory c) const {
+        return std::uint8_t(level) <= m_level.load(std::memory_order_relaxed) &&
+               ((m_categories.load(std::memory_order_relaxed) >> unsigned(c)) & 1u);
+    }
+
+    void write(TraceLevel level, TraceCategory c, TraceEvent e,
+               std::int32_t a0, std::int32_t a1, std::int32_t a2, std::int32_t a3) {
+        thread_local int t_ring = -1;
+        if (t_ring < 0) t_ring = std::min(m_claimed.fetch_add(1, std::memory_order_relaxed), kMaxThreads);
+        TraceRecord r;
+        r.tNs = monotonicNowNs();
+        r.event = e;
+        r.category = c;
+        r.level = level;
+        r.args[0] = a0;
+        r.args[1] = a1;
+        r.args[2] = a2;
+        r.args[3] = a3;
+        if (t_ring >= kMaxThreads || !m_rings[std::size_t(t_ring)].push(r)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Consumer side (one thread): hands every pending record to fn, ring by
+    // ring. Returns how many were drained.
+    template <typename Fn>
+    int drain(Fn&& fn) {
+        // Rings are preallocated, so reading one that was claimed a moment ago is safe.
+        const int rings = std::min(m_claimed.load(std::memory_order_relaxed), kMaxThreads);
+        int n = 0;
+        TraceRecord r;
+        for (int i = 0; i < rings; ++i) {
+            while (m_rings[std::size_t(i)].pop(r)) {
+                fn(r);
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    TraceLog() = default;
+
+    std::atomic<std::uint8_t> m_level{std::uint8_t(TraceLevel::Info)};
+    std::atomic<std::uint32_t> m_categories{~0u};
+    std::atomic<int> m_claimed{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::array<SpscRing<TraceRecord, kRingCapacity>, kMaxThreads> m_rings;
+};
+
+// Hot-path entry point. Above MIDI_TRACE_MAX_LEVEL the call is discarded at
+// compile time; otherwise it costs two relaxed loads when filtered out and a
+// ring push when not.
+template <TraceLevel Level>
+inline void trace(TraceCategory c, TraceEvent e,
+                  int a0 = 0, int a1 = 0, int a2 = 0, int a3 = 0) {
+    if constexpr (int(Level) <= MIDI_TRACE_MAX_LEVEL) {
+        TraceLog& log = TraceLog::instance();
+        if (log.enabled(Level, c)) log.write(Level, c, e, a0, a1, a2, a3);
+    } else {
+        (void)c; (void)e; (void)a0; (void)a1; (void)a2; (void)a3;
+    }
+}
+
+// Consumer-side text for one record (same wording as the string log lines
+// these events replaced).
+inline QString formatTraceRecord(const TraceRecord& r) {
+    const auto* a = r.args;
+    const auto hex3 = [](int v) { return QString("%1").arg(v, 3, 16, QChar('0')); };
+    switch (r.event) {
+    case TraceEvent::GuitarRawMirrorNoteOn: // note, vel, status
+        return QString("RAW-MIRROR Guitar→ch9 note=%1 vel=%2 status=0x%3")
+            .arg(a[0]).arg(a[1]).arg(a[2], 2, 16, QChar('0'));
+    case TraceEvent::VoiceCh10NoteOn: // snap, orig, vel, breath | mask << 8
+        return QString("RAW-MIRROR Voice→ch10 NOTE_ON snap=%1 orig=%2 vel=%3 (breath=%4 mask=0x%5)")
+            .arg(a[0]).arg(a[1]).arg(a[2]).arg(a[3] & 0xFF).arg(hex3(a[3] >> 8));
+    case TraceEvent::VoiceCh10NoteOnHeld: // merged, snap, orig
+        return QString("RAW-MIRROR Voice→ch10 NOTE_ON %1 snap=%2 orig=%3 (held)")
+            .arg(a[0] ? "MERGED" : "tied").arg(a[1]).arg(a[2]);
+    case TraceEvent::VoiceCh10NoteOffDeferred: // snap, orig
+        return QString("RAW-MIRROR Voice→ch10 NOTE_OFF deferred snap=%1 orig=%2").arg(a[0]).arg(a[1]);
+    case TraceEvent::VoiceCh10NoteOffFlushed: // note
+        return QString("RAW-MIRROR Voice→ch10 NOTE_OFF (deferred-flushed) note=%1").arg(a[0]);
+    case TraceEvent::VoiceCh10HeldReleasedByMask: // snap, mask
+        return QString("Voice→ch10 held note %1 released — out of new mask 0x%2").arg(a[0]).arg(hex3(a[1]));
+    case TraceEvent::AmperoCc: // cc, value
+        return QString("Ampero RX  CC%1 = %2").arg(a[0]).arg(a[1]);
+    case TraceEvent::AmperoFanOut: // cc, value, count
+        return QString("Ampero CC%1=%2 -> fanned out %3 mute CC(s)").arg(a[0]).arg(a[1]).arg(a[2]);
+    case TraceEvent::AmperoHarmonyToggle: // cc, value, on
+        return QString("Ampero harmony toggle CC%1=%2 (press) -> %3").arg(a[0]).arg(a[1]).arg(a[2] ? "ON" : "OFF");
+    case TraceEvent::AmperoPassthrough: // cc, value
+        return QString("Ampero CC%1=%2 (passthrough only)").arg(a[0]).arg(a[1]);
+    case TraceEvent::VirtualBandNoteOn: // ch, note, vel
+        return QString("VirtualBand NOTE_ON  ch%1 note=%2 vel=%3").arg(a[0]).arg(a[1]).arg(a[2]);
+    case TraceEvent::VirtualBandNoteOff: // ch, note
+        return QString("VirtualBand NOTE_OFF ch%1 note=%2").arg(a[0]).arg(a[1]);
+    case TraceEvent::PitchBendCcs: // cc102, cc103
+        return QString("Pitch Bend CCs -> Down (102): %1, Up (103): %2").arg(a[0]).arg(a[1]);
+    case TraceEvent::ScaleSnapLead: // in, out, behavior, snapTarget
+        return QString("ScaleSnap: LEAD INPUT %1 -> OUTPUT %2 behavior: %3 snapTarget: %4")
+            .arg(a[0]).arg(a[1]).arg(a[2]).arg(a[3]);
+    case TraceEvent::ScaleSnapHarmonyVoice: // voice, in, out, channel
+        return QString("ScaleSnap Multi-Voice %1 : %2 -> %3 ch %4").arg(a[0]).arg(a[1]).arg(a[2]).arg(a[3]);
+    case TraceEvent::ScaleSnapHarmonyLegacy: // in, out
+        return QString("ScaleSnap Harmony (legacy): INPUT %1 -> HARMONY %2").arg(a[0]).arg(a[1]);
+    case TraceEvent::ScaleSnapNoteOff: // note, active, held
+        return QString("ScaleSnap::onGuitarNoteOff - note: %1 activeNotes count: %2 guitarNotesHeld: %3")
+            .arg(a[0]).arg(a[1]).arg(a[2]);
+    }
+    return QString("trace event %1").arg(int(r.event));
+}
+
+} // namespace midi
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace midi {
+
+// Single-consumer wake-up primitive ("event count") for the MIDI worker.
+//
+// Producers call notify() after publishing into a lock-free ring. notify()
+// is a single atomic load unless the consumer is actually parked, so the
+// RtMidi callbacks never touch a mutex while the worker is busy draining.
+// The consumer re-checks its predicate after announcing that it is about to
+// park. That alone is a Dekker pattern (store A, load B against store B,
+// load A): the ring publish is only a release store, so the producer's load
+// of m_parked could complete before it. A seq_cst fence on each side, between
+// the store and the load (notify() and park()), orders them and closes the
+// lost-wake-up window without holding a lock.
+//
+// Linux parks on an eventfd; other platforms (CoreMIDI / macOS has no
+// eventfd or public futex) fall back to a condition variable that is only
+// signalled while the consumer is parked.
+class WorkerWake {
+public:
+    WorkerWake() {
+#if defined(__linux__)
+        m_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+    ~WorkerWake() {
+#if defined(__linux__)
+        if (m_fd >= 0) ::close(m_fd);
+#endif
+    }
+    WorkerWake(const WorkerWake&) = delete;
+    WorkerWake& operator=(const WorkerWake&) = delete;
+
+    // Any thread. Cheap when the consumer is running.
+    void notify() {
+        // StoreLoad: the caller's ring publish before the m_parked check.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_parked.load(std::memory_order_relaxed)) return;
+        signal();
+    }
+
+    // Consumer only. Returns once hasWork() is true (spurious returns are
+    // allowed; callers loop).
+    template <typename Pred>
+    void wait(Pred hasWork) {
+        park(hasWork, -1);
+    }
+
+    // Consumer only. Like wait(), but gives up after `timeout`.
+    template <typename Pred>
+    void waitFor(std::chrono::nanoseconds timeout, Pred hasWork) {
+        if (timeout.count() <= 0) return;
+        park(hasWork, timeout.count());
+    }
+
+private:
+    template <typename Pred>
+    void park(Pred& hasWork, std::int64_t timeoutNs) {
+        m_parked.store(true, std::memory_order_relaxed);
+        // StoreLoad: m_parked before hasWork()'s ring loads (pairs with notify()).
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (hasWork()) {
+            m_parked.store(false, std::memory_order_relaxed);
+            return;
+        }
+#if defined(__linux__)
+        if (m_fd >= 0) {
+            pollfd pfd{m_fd, POLLIN, 0};
+            // ppoll() takes a timespec, so timed waits (scheduled notes) keep
+            // sub-millisecond resolution instead of poll()'s whole ms.
+            timespec ts{};
+            ts.tv_sec = time_t(timeoutNs / 1000000000);
+            ts.tv_nsec = long(timeoutNs % 1000000000);
+            ::ppoll(&pfd, 1, timeoutNs < 0 ? nullptr : &ts, nullptr);
+            std::uint64_t drained = 0;
+            (void)::read(m_fd, &drained, sizeof(drained));
+            m_parked.store(false, std::memory_order_relaxed);
+            return;
+        }
+#endif
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto ready = [&] { return m_token || hasWork(); };
+            if (timeoutNs < 0) {
+                m_cv.wait(lock, ready);
+            } else {
+                m_cv.wait_for(lock, std::chrono::nanoseconds(timeoutNs), ready);
+            }
+            m_token = false;
+        }
+        m_parked.store(false, std::memory_order_relaxed);
+    }
+
+    void signal() {
+#if defined(__linux__)
+        if (m_fd >= 0) {
+            const std::uint64_t one = 1;
+            (void)::write(m_fd, &one, sizeof(one));
+            return;
+        }
+#endif
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_token = true;
+        }
+        m_cv.notify_one();
+    }
+
+    std::atomic<bool> m_parked{false};
+#if defined(__linux__)
+    int m_fd = -1;
+#endif
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_token = false;
+};
+
+} // namespace midi
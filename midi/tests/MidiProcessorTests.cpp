@@ -0,0 +1,706 @@
+#include "midiprocessor.h"
+#include "midi/MidiMsg.h"
+#include "midi/DelayQueue.h"
+#include "midi/IGuitarStage.h"
+#include "midi/TraceLog.h"
+#include "midi/LatencyHistogram.h"
+#include "midi/MemoryMidiBackend.h"
+#include "midi/MidiCapture.h"
+#include "midi/MidiRecorder.h"
+#include "midi/Seqlock.h"
+#include "virtuoso/engine/VirtuosoEngine.h"
+#include "bench/AllocCounter.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Friend of MidiProcessor: drives the worker-side entry point directly (no
+// ports, no worker thread) and gives it a dummy-API output so the send path
+// is exercised end to end.
+struct MidiProcessorTestAccess {
+    static void attachDummyOutput(MidiProcessor& p) {
+        if (!p.midiOut) {
+            p.midiOut = std::make_unique<midi::RtMidiOutputPort>(std::make_unique<RtMidiOut>(RtMidi::RTMIDI_DUMMY));
+        }
+    }
+    static void feedGuitar(MidiProcessor& p, const midi::MidiMsg& m) {
+        MidiProcessor::MidiEvent ev;
+        ev.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        ev.message = m;
+        ev.source = MidiProcessor::MidiSource::Guitar;
+        ev.programIndex = -1;
+        p.processMidiEvent(ev);
+    }
+    // As the worker handles a ring entry: stamped and measured.
+    static midi::LatencyStamps feedGuitarLive(MidiProcessor& p, const midi::MidiMsg& m) {
+        MidiProcessor::MidiEvent ev;
+        ev.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        ev.message = m;
+        ev.source = MidiProcessor::MidiSource::Guitar;
+        ev.programIndex = -1;
+        p.processLiveEvent(ev);
+        return ev.stamps;
+    }
+    // Through the guitar input ring, as the worker drains it.
+    static void feedGuitarRing(MidiProcessor& p, const midi::MidiMsg& m) {
+        MidiProcessor::MidiEvent ev;
+        ev.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        ev.programIndex = -1;
+        p.m_guitarRing.push(m);
+        p.drainRing(p.m_guitarRing, MidiProcessor::MidiSource::Guitar, ev);
+    }
+    // One worker pass over the scheduled lane; returns what is still pending.
+    static size_t drainScheduled(MidiProcessor& p) {
+        MidiProcessor::MidiEvent scratch;
+        scratch.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        scratch.programIndex = -1;
+        p.drainScheduled(scratch);
+        return p.m_delayQueue.size();
+    }
+    // Tests never call initialize(), so there is no worker: let the calling
+    // thread stand in for it.
+    static void actAsWorker(MidiProcessor& p) { p.m_workerThreadId.store(std::this_thread::get_id()); }
+    static bool virtualRingEmpty(MidiProcessor& p) { return p.m_virtualRing.empty(); }
+    static constexpr size_t virtualRingCapacity() { return MidiProcessor::kVirtualRingCapacity; }
+    static constexpr size_t scheduledRingCapacity() { return MidiProcessor::kScheduledRingCapacity; }
+    static size_t pendingScheduled(MidiProcessor& p) { return p.m_delayQueue.size(); }
+    static void attachOutput(MidiProcessor& p, std::unique_ptr<midi::IMidiOutputPort> out) {
+        p.midiOut = std::move(out);
+    }
+    // One pass of the worker loop, run on the calling thread.
+    static int runWorkerPass(MidiProcessor& p) {
+        MidiProcessor::MidiEvent scratch;
+        scratch.type = MidiProcessor::EventType::MIDI_MESSAGE;
+        scratch.programIndex = -1;
+        return p.runWorkerPass(scratch);
+    }
+};
+
+namespace {
+
+static int g_failures = 0;
+
+static void expect(bool cond, const QString& msg) {
+    if (!cond) {
+        ++g_failures;
+        qWarning().noquote() << "FAIL:" << msg;
+    }
+}
+
+static void expectEq(long long a, long long b, const QString& msg) {
+    expect(a == b, msg + QString(" (got %1 expected %2)").arg(a).arg(b));
+}
+
+} // namespace
+
+static void testMidiMsgBasics() {
+    const midi::MidiMsg on = midi::MidiMsg::make(0x93, 60, 100);
+    expectEq(on.size(), 3, "MidiMsg: make() is 3 bytes");
+    expectEq(on.type(), 0x90, "MidiMsg: type strips channel");
+    expectEq(on.channelNibble(), 3, "MidiMsg: channel nibble");
+    expectEq(on.withChannel(0x08).status(), 0x98, "MidiMsg: withChannel rewrites nibble");
+
+    const midi::MidiMsg clock = midi::MidiMsg::make(0xF8, 0, 0);
+    expectEq(clock.withChannel(0x08).status(), 0xF8, "MidiMsg: system messages keep status");
+
+    const unsigned char sysex[5] = {0xF0, 1, 2, 3, 0xF7};
+    midi::MidiMsg out;
+    expect(!midi::MidiMsg::fromBytes(sysex, 5, out), "MidiMsg: oversized input rejected");
+    expect(out.empty(), "MidiMsg: rejected input leaves message empty");
+
+    const std::vector<unsigned char> pressure = {0xD0, 42};
+    expect(midi::MidiMsg::fromVector(&pressure, out), "MidiMsg: 2-byte message accepted");
+    expectEq(out.size(), 2, "MidiMsg: 2-byte length kept");
+    expectEq(out.data1(), 42, "MidiMsg: 2-byte data1");
+}
+
+static void testGuitarPathIsAllocationFree() {
+    Preset preset;
+    preset.settings.voiceControlEnabled = true; // no command-note handling
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+
+    const midi::MidiMsg noteOn = midi::MidiMsg::make(0x90, 64, 96);
+    const midi::MidiMsg noteOff = midi::MidiMsg::make(0x80, 64, 0);
+    const midi::MidiMsg bend = midi::MidiMsg::make(0xE0, 0x10, 0x41);
+    const midi::MidiMsg modWheel = midi::MidiMsg::make(0xB0, 1, 70);
+    midi::MidiMsg pressure = midi::MidiMsg::make(0xD0, 55, 0);
+    pressure.len = 2; // channel pressure is a 2-byte message
+
+    // Warm-up: first-touch state (signal tables, lazily-built statics).
+    for (int i = 0; i < 8; ++i) {
+        MidiProcessorTestAccess::feedGuitar(proc, noteOn);
+        MidiProcessorTestAccess::feedGuitar(proc, modWheel);
+        MidiProcessorTestAccess::feedGuitar(proc, pressure);
+        MidiProcessorTestAccess::feedGuitar(proc, bend);
+        MidiProcessorTestAccess::feedGuitar(proc, noteOff);
+    }
+
+    beginAllocCount();
+    for (int i = 0; i < 1000; ++i) {
+        MidiProcessorTestAccess::feedGuitar(proc, noteOn);
+        MidiProcessorTestAccess::feedGuitar(proc, modWheel);
+        MidiProcessorTestAccess::feedGuitar(proc, pressure);
+        MidiProcessorTestAccess::feedGuitar(proc, bend);
+        MidiProcessorTestAccess::feedGuitar(proc, noteOff);
+    }
+    expectEq(endAllocCount(), 0, "Guitar -> ch1/ch9 steady state performs zero heap allocations");
+}
+
+static void testDelayQueueOrdering() {
+    using midi::MidiMsg;
+    midi::DelayQueue<8> q;
+    MidiMsg out;
+
+    // Off scheduled with a shorter delay than its on: held until the on is sent.
+    q.push(MidiMsg::make(0x9B, 60, 90), 30);
+    q.push(MidiMsg::make(0x8B, 60, 0), 5);
+    expect(!q.popDue(10, out), "DelayQueue: off not due before its on");
+    expect(q.popDue(30, out) && out.type() == 0x90, "DelayQueue: on first");
+    expect(q.popDue(30, out) && out.type() == 0x80, "DelayQueue: then off");
+    expect(q.empty(), "DelayQueue: drained");
+
+    // Equal due times keep arrival order; other notes are independent.
+    q.push(MidiMsg::make(0x90, 64, 90), 10);
+    q.push(MidiMsg::make(0x80, 64, 0), 10);
+    q.push(MidiMsg::make(0x90, 67, 90), 2);
+    expect(q.popDue(10, out) && out.data1() == 67, "DelayQueue: earliest due first");
+    expect(q.popDue(10, out) && out.type() == 0x90 && out.data1() == 64, "DelayQueue: tie keeps on first");
+    expect(q.popDue(10, out) && out.type() == 0x80, "DelayQueue: tie keeps off second");
+
+    // Cancel drops pending note-ons on one channel only; offs survive.
+    q.push(MidiMsg::make(0x90, 60, 90), 5);
+    q.push(MidiMsg::make(0x91, 62, 90), 6);
+    q.push(MidiMsg::make(0x80, 59, 0), 7);
+    q.cancelNoteOns(0);
+    expectEq(q.size(), 2, "DelayQueue: cancel removes one on");
+    expect(q.popFront(out) && out.channelNibble() == 1 && out.type() == 0x90, "DelayQueue: other channel kept");
+    expect(q.popFront(out) && out.type() == 0x80, "DelayQueue: off kept");
+
+    for (int i = 0; i < 8; ++i) q.push(MidiMsg::make(0xB0, 1, i), 100 - i);
+    expect(q.full() && !q.push(MidiMsg::make(0xB0, 1, 9), 0), "DelayQueue: full rejects");
+    expect(q.popFront(out) && out.data2() == 7, "DelayQueue: popFront takes earliest");
+}
+
+static void testScheduledNotesWaitForDeadline() {
+    Preset preset;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+
+    // Humanized attack 20 ms out, release requested at once (voice delay changed):
+    // both stay queued until the attack is due.
+    proc.scheduleVirtualNoteOn(12, 60, 90, 20000000);
+    proc.scheduleVirtualNoteOff(12, 60, 0);
+    expectEq(MidiProcessorTestAccess::drainScheduled(proc), 3, "scheduled: on + dual off pending");
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    expectEq(MidiProcessorTestAccess::drainScheduled(proc), 0, "scheduled: all sent once due");
+
+    proc.scheduleVirtualNoteOn(13, 64, 90, 20000000);
+    proc.cancelScheduledVirtualNotes(13);
+    expectEq(MidiProcessorTestAccess::drainScheduled(proc), 0, "scheduled: cancel drops pending attack");
+
+    // Preallocated: scheduling and sending never touch the heap.
+    for (int i = 0; i < 8; ++i) {
+        proc.scheduleVirtualNoteOn(12, 60 + i, 90, 0);
+        proc.scheduleVirtualNoteOff(12, 60 + i, 0);
+        MidiProcessorTestAccess::drainScheduled(proc);
+    }
+    beginAllocCount();
+    for (int i = 0; i < 500; ++i) {
+        proc.scheduleVirtualNoteOn(12 + i % 4, 48 + i % 24, 90, 0);
+        proc.scheduleVirtualNoteOff(12 + i % 4, 48 + i % 24, 0);
+        MidiProcessorTestAccess::drainScheduled(proc);
+    }
+    expectEq(endAllocCount(), 0, "scheduled: virtual note path allocates nothing");
+}
+
+namespace {
+
+// Echoes each guitar note to channel 12 a fifth up, the way ScaleSnap emits harmony.
+struct EchoStage final : midi::IGuitarStage {
+    MidiProcessor* proc = nullptr;
+    int ons = 0;
+    int offs = 0;
+    int lastNote = -1;
+    void guitarNoteOn(int midiNote, int velocity) override {
+        ++ons;
+        lastNote = midiNote;
+        proc->sendVirtualNoteOn(12, midiNote + 7, velocity);
+    }
+    void guitarNoteOff(int midiNote) override {
+        ++offs;
+        proc->sendVirtualNoteOff(12, midiNote + 7);
+    }
+};
+
+// Ticks `burst` times at 5 ms once a note arrives, then reports idle again.
+struct BurstTickStage final : midi::IGuitarStage {
+    int burst = 3;
+    int left = 0; // worker-only
+    std::int64_t lastTickNs = 0;
+    std::atomic<int> ticks{0};
+    void guitarNoteOn(int, int) override { left = burst; }
+    void guitarNoteOff(int) override {}
+    void tick(std::int64_t nowNs) override {
+        ++ticks;
+        lastTickNs = nowNs;
+        --left;
+    }
+    std::int64_t nextTickDeadlineNs() const override {
+        if (left <= 0) return kNoTickDeadline;
+        return (left == burst) ? 0 : lastTickNs + 5000000;
+    }
+};
+
+} // namespace
+
+static void testGuitarStageRunsInline() {
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+    EchoStage stage;
+    stage.proc = &proc;
+    proc.setGuitarStage(&stage);
+
+    // Off the worker, virtual sends still go through the ring.
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 64, 96));
+    expectEq(stage.ons, 1, "stage: note-on delivered");
+    expectEq(stage.lastNote, 64, "stage: gets the performance note");
+    expect(!MidiProcessorTestAccess::virtualRingEmpty(proc), "stage: off-worker send is queued");
+
+    // On the worker, the backlog is flushed and the stage's output is sent inline.
+    MidiProcessorTestAccess::actAsWorker(proc);
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x80, 64, 0));
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 67, 0)); // velocity-0 off
+    expectEq(stage.offs, 2, "stage: note-offs delivered");
+    expect(MidiProcessorTestAccess::virtualRingEmpty(proc), "stage: worker send bypasses the ring");
+
+    for (int i = 0; i < 8; ++i) {
+        MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 60, 90));
+        MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x80, 60, 0));
+    }
+    beginAllocCount();
+    for (int i = 0; i < 500; ++i) {
+        MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 48 + i % 24, 90));
+        MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x80, 48 + i % 24, 0));
+    }
+    expectEq(endAllocCount(), 0, "stage: inline guitar -> harmony path allocates nothing");
+
+    // Releasing someone else's stage is a no-op; releasing our own detaches it.
+    EchoStage other;
+    proc.releaseGuitarStage(&other);
+    const int before = stage.ons;
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 62, 90));
+    expectEq(stage.ons, before + 1, "stage: foreign release ignored");
+    proc.releaseGuitarStage(&stage);
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 62, 90));
+    expectEq(stage.ons, before + 1, "stage: released stage not called");
+}
+
+static void testGuitarStageTicksOnlyWhileBusy() {
+    // Live worker: an idle stage is never ticked, a busy one is ticked on its
+    // own deadlines, and once it reports idle again the worker stops ticking.
+    midi::MemoryMidiBackend backend;
+    midi::MemoryMidiBackend::Input& guitar = backend.addInput("Test Guitar");
+    backend.addInput("Test Voice");
+    backend.addOutput("Test Out");
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    preset.settings.ports["GUITAR_IN"] = "Test Guitar";
+    preset.settings.ports["VOICE_IN"] = "Test Voice";
+    preset.settings.ports["CONTROLLER_OUT"] = "Test Out";
+    BurstTickStage stage;
+    MidiProcessor proc(preset);
+    expect(proc.initialize(backend), "stage tick: initialize on in-memory ports");
+    proc.setGuitarStage(&stage);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    expectEq(stage.ticks.load(), 0, "stage tick: idle stage is not ticked");
+
+    expect(guitar.deliver(midi::MidiMsg::make(0x90, 64, 96)), "stage tick: guitar callback attached");
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (stage.ticks.load() < stage.burst && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    expectEq(stage.ticks.load(), stage.burst, "stage tick: busy stage ticked on its deadlines");
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    expectEq(stage.ticks.load(), stage.burst, "stage tick: no ticks once the stage is idle again");
+    proc.releaseGuitarStage(&stage);
+}
+
+static void testTraceLogRecordsAndFilters() {
+    using midi::TraceCategory;
+    using midi::TraceEvent;
+    using midi::TraceLevel;
+    midi::TraceLog& log = midi::TraceLog::instance();
+    log.drain([](const midi::TraceRecord&) {}); // earlier tests traced too
+
+    // Writing is binary and allocation-free; filtered records cost nothing.
+    beginAllocCount();
+    midi::trace<TraceLevel::Info>(TraceCategory::Guitar, TraceEvent::GuitarRawMirrorNoteOn, 64, 96, 0x90);
+    midi::trace<TraceLevel::Debug>(TraceCategory::Pitch, TraceEvent::PitchBendCcs, 10, 20); // above Info
+    log.setCategoryEnabled(TraceCategory::Ampero, false);
+    midi::trace<TraceLevel::Info>(TraceCategory::Ampero, TraceEvent::AmperoCc, 7, 127);
+    log.setCategoryEnabled(TraceCategory::Ampero, true);
+    log.setLevel(TraceLevel::Debug);
+    midi::trace<TraceLevel::Debug>(TraceCategory::Pitch, TraceEvent::PitchBendCcs, 10, 20);
+    log.setLevel(TraceLevel::Info);
+    expectEq(endAllocCount(), 0, "trace: writing records allocates nothing");
+
+    QStringList lines;
+    const int n = log.drain([&lines](const midi::TraceRecord& r) { lines << midi::formatTraceRecord(r); });
+    expectEq(n, 2, "trace: level and category filters drop records before the ring");
+    expect(lines.value(0) == "RAW-MIRROR Guitar→ch9 note=64 vel=96 status=0x90", "trace: guitar note-on text");
+    expect(lines.value(1) == "Pitch Bend CCs -> Down (102): 10, Up (103): 20", "trace: debug record once enabled");
+
+    // The guitar path writes its raw-mirror note-on trace on every attack.
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 60, 80));
+    int guitarOns = 0;
+    log.drain([&guitarOns](const midi::TraceRecord& r) {
+        if (r.event == TraceEvent::GuitarRawMirrorNoteOn && r.args[0] == 60) ++guitarOns;
+    });
+    expectEq(guitarOns, 1, "trace: guitar note-on traced");
+}
+
+static void testLatencyHistograms() {
+    using midi::LatencyHistogram;
+    using midi::LatencyPath;
+    using midi::LatencyStage;
+
+    // Buckets: exact below 64 ns, ~3% above, every value inside its bucket.
+    expectEq(LatencyHistogram::bucketFor(63), 63, "latency: linear buckets");
+    for (std::int64_t v : {64LL, 100LL, 999LL, 1000000LL, 123456789LL, (1LL << 34) - 1}) {
+        const int b = LatencyHistogram::bucketFor(v);
+        expect(LatencyHistogram::bucketLowNs(b) <= v && v <= LatencyHistogram::bucketHighNs(b),
+               QString("latency: %1 ns inside its bucket").arg(v));
+        expect(double(LatencyHistogram::bucketHighNs(b) - LatencyHistogram::bucketLowNs(b)) <= 0.032 * double(v),
+               QString("latency: bucket for %1 ns within 3%").arg(v));
+    }
+    LatencyHistogram h;
+    for (int i = 1; i <= 1000; ++i) h.record(std::int64_t(i) * 1000);
+    const LatencyHistogram::Snapshot snap = h.snapshot();
+    expectEq(snap.count, 1000, "latency: count");
+    expect(snap.percentileNs(0.5) >= 500000 && snap.percentileNs(0.5) <= 516000, "latency: p50 within a bucket");
+    expectEq(snap.percentileNs(1.0), 1000000, "latency: p100 is the max");
+
+    // A guitar note-on that arrived 2 ms ago: measured on ch 1 and ch 9.
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+    MidiProcessorTestAccess::actAsWorker(proc);
+    midi::MidiMsg on = midi::MidiMsg::make(0x90, 64, 96);
+    on.timestampNs = midi::monotonicNowNs() - 2000000;
+    const midi::LatencyStamps st = MidiProcessorTestAccess::feedGuitarLive(proc, on);
+    expect(st.arrivalNs < st.dequeueNs && st.dequeueNs <= st.processStartNs &&
+           st.processStartNs <= st.sendReturnNs && st.sendReturnNs <= st.processEndNs,
+           "latency: stamps in pipeline order");
+    const midi::LatencyStats& stats = proc.latencyStats();
+    expectEq(stats.path(LatencyPath::Lead).snapshot().count, 1, "latency: ch1 passthrough measured");
+    expectEq(stats.path(LatencyPath::RawMirror).snapshot().count, 1, "latency: ch9 mirror measured");
+    expect(stats.path(LatencyPath::Lead).snapshot().maxNs >= 2000000, "latency: measured from callback arrival");
+    expectEq(stats.stage(LatencyStage::Processing).snapshot().count, 1, "latency: one event staged");
+    expectEq(stats.stage(LatencyStage::Send).snapshot().count, 2, "latency: two measured sends");
+
+    // Note-offs and untimed messages aren't measured; the live path stays malloc-free.
+    beginAllocCount();
+    for (int i = 0; i < 100; ++i) {
+        on.timestampNs = midi::monotonicNowNs();
+        MidiProcessorTestAccess::feedGuitarLive(proc, on);
+        midi::MidiMsg off = midi::MidiMsg::make(0x80, 64, 0);
+        off.timestampNs = midi::monotonicNowNs();
+        MidiProcessorTestAccess::feedGuitarLive(proc, off);
+    }
+    expectEq(endAllocCount(), 0, "latency: measured guitar path allocates nothing");
+    expectEq(stats.path(LatencyPath::Lead).snapshot().count, 101, "latency: note-ons only");
+
+    const QJsonObject json = stats.toJson();
+    expect(json.value("paths").toObject().value("raw_mirror_ch9").toObject().value("count").toDouble() == 101.0,
+           "latency: JSON dump carries the path counts");
+    proc.resetLatencyStats();
+    expectEq(stats.path(LatencyPath::Lead).snapshot().count, 0, "latency: reset");
+}
+
+static void testOverflowedReleaseKeepsRingOrder() {
+    // A release sent while the virtual ring is full takes the control lane;
+    // it must still go out after every attack the ring already held.
+    midi::MemoryMidiBackend backend;
+    midi::MemoryMidiBackend::Output& out = backend.addOutput("Test Out");
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachOutput(proc, backend.openOutput("Test Out"));
+
+    const int capacity = int(MidiProcessorTestAccess::virtualRingCapacity());
+    for (int i = 0; i < capacity; ++i) {
+        proc.sendVirtualNoteOn(1, 60, 1 + i % 127);
+    }
+    proc.sendVirtualNoteOn(1, 60, 100); // not critical: dropped
+    proc.sendVirtualNoteOff(1, 60);     // both release forms overflow
+
+    MidiProcessorTestAccess::runWorkerPass(proc);
+    expect(MidiProcessorTestAccess::virtualRingEmpty(proc), "overflow: one pass drains the full ring");
+    expectEq(out.sentCount(), capacity + 2, "overflow: ring entries plus both release forms sent");
+
+    int firstRelease = -1;
+    for (std::size_t i = 0; i < out.sentCount(); ++i) {
+        const midi::MidiMsg& m = out.sent(i).msg;
+        if (m.type() == 0x80 || (m.type() == 0x90 && m.data2() == 0)) {
+            firstRelease = int(i);
+            break;
+        }
+    }
+    expectEq(firstRelease, capacity, "overflow: release goes out after every older attack");
+}
+
+static void testOverflowedCancelKeepsScheduledOrder() {
+    // A cancel sent while the scheduled ring is full takes the control lane;
+    // it must still reach the delay queue after the attacks ahead of it.
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+
+    const int capacity = int(MidiProcessorTestAccess::scheduledRingCapacity());
+    for (int i = 0; i < capacity; ++i) {
+        proc.scheduleVirtualNoteOn(12, 48 + i % 24, 90, 10'000'000'000LL); // 10 s out
+    }
+    proc.cancelScheduledVirtualNotes(12); // ring full: diverted
+
+    MidiProcessorTestAccess::runWorkerPass(proc);
+    expectEq(MidiProcessorTestAccess::pendingScheduled(proc), 0,
+             "scheduled overflow: cancel applies after every older attack");
+}
+
+static void testMemoryBackendEndToEnd() {
+    // The whole live path on in-memory ports: callback -> ring -> worker -> output.
+    midi::MemoryMidiBackend backend;
+    midi::MemoryMidiBackend::Input& guitar = backend.addInput("Test Guitar");
+    backend.addInput("Test Voice");
+    midi::MemoryMidiBackend::Output& out = backend.addOutput("Test Out");
+
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    preset.settings.ports["GUITAR_IN"] = "Test Guitar";
+    preset.settings.ports["VOICE_IN"] = "Test Voice";
+    preset.settings.ports["CONTROLLER_OUT"] = "Missing Out";
+    {
+        MidiProcessor missing(preset);
+        expect(!missing.initialize(backend), "backend: missing output port fails initialize");
+    }
+    preset.settings.ports["CONTROLLER_OUT"] = "Test Out";
+    MidiProcessor proc(preset);
+    expect(proc.initialize(backend), "backend: initialize on in-memory ports");
+    expect(backend.output("VocalSync Out") != nullptr, "backend: VocalSync falls back to a virtual output");
+
+    expect(guitar.deliver(midi::MidiMsg::make(0x90, 64, 96)), "backend: guitar callback attached");
+    bool lead = false;
+    bool mirror = false;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!(lead && mirror) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (std::size_t i = 0; i < out.sentCount(); ++i) {
+            const midi::MidiMsg& m = out.sent(i).msg;
+            lead = lead || (m.status() == 0x90 && m.data1() == 64 && m.data2() > 0);
+            mirror = mirror || (m.status() == 0x98 && m.data1() == 64);
+        }
+    }
+    expect(lead, "backend: guitar note-on reaches the ch1 output");
+    expect(mirror, "backend: guitar note-on reaches the ch9 mirror");
+}
+
+static void testRealtimeBandDispatchEndToEnd() {
+    // Band MIDI as the playback engine sends it with realtime dispatch on: VirtuosoEngine's
+    // dispatch thread -> virtualBandSink() -> virtual ring -> worker -> output. Nothing here
+    // spins an event loop, so only the realtime path can deliver.
+    midi::MemoryMidiBackend backend;
+    backend.addInput("Test Guitar");
+    backend.addInput("Test Voice");
+    midi::MemoryMidiBackend::Output& out = backend.addOutput("Test Out");
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    preset.settings.ports["GUITAR_IN"] = "Test Guitar";
+    preset.settings.ports["VOICE_IN"] = "Test Voice";
+    preset.settings.ports["CONTROLLER_OUT"] = "Test Out";
+    MidiProcessor proc(preset);
+    expect(proc.initialize(backend), "realtime band: initialize on in-memory ports");
+
+    virtuoso::engine::VirtuosoEngine engine;
+    engine.setRealtimeOutput(proc.virtualBandSink());
+    expect(engine.isRealtimeOutput(), "realtime band: engine routes to the sink");
+    engine.start();
+    // Bass channel 4, note 40, due 20 ms from now, held 30 ms.
+    engine.scheduleKeySwitchAtMs("Bass", 4, 40, engine.elapsedMs() + 20, 30);
+
+    bool on = false;
+    bool off = false;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!(on && off) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (std::size_t i = 0; i < out.sentCount(); ++i) {
+            const midi::MidiMsg& m = out.sent(i).msg;
+            on = on || (m.status() == 0x93 && m.data1() == 40 && m.data2() > 0);
+            off = off || ((m.status() == 0x83 || (m.status() == 0x93 && m.data2() == 0)) && m.data1() == 40);
+        }
+    }
+    expect(on, "realtime band: note-on reaches the output without an event loop");
+    expect(off, "realtime band: matching note-off reaches the output");
+    engine.stop();
+    engine.setRealtimeOutput(nullptr);
+}
+
+static void testCaptureRecorderRoundTrip() {
+    using midi::CapturePort;
+    const QString path = QDir::tempPath() + "/MidiProcessorTests.mcap";
+
+    // Recorder alone: out-of-order times (an input logged after the outputs
+    // it caused) come back sorted, at microsecond resolution.
+    {
+        midi::MidiRecorder rec;
+        expect(rec.start(path), "capture: recorder starts");
+        expect(!rec.start(path), "capture: second start refused");
+        const std::int64_t t0 = midi::monotonicNowNs();
+        rec.record(CapturePort::Out, midi::MidiMsg::make(0x90, 64, 96), t0 + 3000000);
+        rec.record(CapturePort::Guitar, midi::MidiMsg::make(0x90, 64, 96), t0 + 2000000);
+        midi::MidiMsg pressure;
+        const unsigned char at[2] = {0xD0, 55};
+        midi::MidiMsg::fromBytes(at, 2, pressure);
+        for (int i = 0; i < 100; ++i) rec.record(CapturePort::VoiceAmp, pressure, t0 + 4000000 + i * 10000000LL);
+        rec.stop();
+        expectEq((long long)rec.recorded(), 102, "capture: events recorded");
+        expect(double(rec.bytesWritten() - midi::kBinaryCaptureHeaderBytes) / 102.0 <= 6.0,
+               "capture: at most 6 bytes per event");
+    }
+    midi::MidiCapture cap;
+    QString error;
+    std::uint64_t dropped = 1;
+    expect(midi::loadCapture(path, cap, &error, &dropped), "capture: binary file loads " + error);
+    expectEq((long long)cap.size(), 102, "capture: events read back");
+    expectEq((long long)dropped, 0, "capture: nothing dropped");
+    if (cap.size() == 102) {
+        expect(cap[0].port == CapturePort::Guitar && cap[1].port == CapturePort::Out, "capture: sorted by time");
+        expect(std::llabs((cap[1].tNs - cap[0].tNs) / 1000 - 1000) <= 1, "capture: microsecond deltas");
+        expect(cap[2].msg.size() == 2 && cap[2].msg[1] == 55, "capture: 2-byte message intact");
+        expect(std::llabs((cap[101].tNs - cap[2].tNs) / 1000 - 990000) <= 1, "capture: long gaps intact");
+    }
+    expect(midi::saveSmf(path + ".mid", cap), "capture: SMF export");
+    QFile smf(path + ".mid");
+    expect(smf.open(QIODevice::ReadOnly) && smf.read(4) == QByteArray("MThd"), "capture: SMF header");
+    smf.close();
+    QFile::remove(path + ".mid");
+
+    // Through MidiProcessor: inbound and outbound logged, no allocation on the worker.
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+    MidiProcessorTestAccess::actAsWorker(proc);
+    expect(proc.startCaptureRecording(path) == path, "capture: processor recording");
+    midi::MidiMsg on = midi::MidiMsg::make(0x90, 64, 96);
+    on.timestampNs = midi::monotonicNowNs();
+    beginAllocCount();
+    MidiProcessorTestAccess::feedGuitarRing(proc, on);
+    expectEq(endAllocCount(), 0, "capture: recording worker path allocates nothing");
+    proc.stopCaptureRecording();
+    expect(midi::loadBinaryCapture(path, cap, &error), "capture: processor capture loads " + error);
+    int in = 0;
+    int lead = 0;
+    int mirror = 0;
+    for (const midi::CaptureEvent& ev : cap) {
+        in += ev.port == CapturePort::Guitar ? 1 : 0;
+        lead += (ev.port == CapturePort::Out && ev.msg.status() == 0x90) ? 1 : 0;
+        mirror += (ev.port == CapturePort::Out && ev.msg.status() == 0x98) ? 1 : 0;
+    }
+    expectEq(in, 1, "capture: guitar input logged");
+    expectEq(lead, 1, "capture: ch1 output logged");
+    expectEq(mirror, 1, "capture: ch9 output logged");
+    QFile::remove(path);
+}
+
+static void testContinuousStateSeqlock() {
+    // Readers never see a torn value while the writer hammers the cell.
+    struct Sample {
+        std::uint64_t a = 0;
+        std::uint64_t b = 0;
+        double c = 0.0;
+    };
+    midi::Seqlock<Sample> cell;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            const Sample v = cell.load();
+            if (v.b != v.a * 3 || v.c != double(v.a)) torn.fetch_add(1);
+        }
+    });
+    for (std::uint64_t i = 1; i <= 200000; ++i) cell.store(Sample{i, i * 3, double(i)});
+    done.store(true);
+    reader.join();
+    expectEq(torn.load(), 0, "seqlock: no torn reads");
+    expectEq((long long)cell.load().a, 200000, "seqlock: latest value");
+    expectEq((long long)cell.version(), 2 * 200001, "seqlock: version bumps by two per store");
+
+    // MidiProcessor publishes guitar pressure, velocity and pitch, allocation-free.
+    Preset preset;
+    preset.settings.voiceControlEnabled = true;
+    MidiProcessor proc(preset);
+    MidiProcessorTestAccess::attachDummyOutput(proc);
+    MidiProcessorTestAccess::actAsWorker(proc);
+    const std::uint64_t before = proc.continuousVersion();
+    midi::MidiMsg pressure;
+    const unsigned char at[2] = {0xD0, 77};
+    midi::MidiMsg::fromBytes(at, 2, pressure);
+    beginAllocCount();
+    MidiProcessorTestAccess::feedGuitar(proc, pressure);
+    MidiProcessorTestAccess::feedGuitar(proc, midi::MidiMsg::make(0x90, 60, 101));
+    expectEq(endAllocCount(), 0, "continuous: publishing allocates nothing");
+    expect(proc.continuousVersion() != before, "continuous: version moved");
+    const midi::ContinuousState st = proc.continuousState();
+    expectEq(st.guitarAftertouch, 77, "continuous: guitar pressure");
+    expectEq(st.guitarVelocity, 101, "continuous: guitar velocity");
+    expectEq(st.guitarNote, 60, "continuous: guitar pitch note");
+    expect(st.guitarHz > 261.0 && st.guitarHz < 262.0, "continuous: guitar Hz");
+    // Pressure, velocity, note/cents, Hz: four signals' worth.
+    expectEq((long long)proc.continuousStats().updates.load(), 4, "continuous: updates counted");
+    expectEq((long long)proc.continuousStats().polls.load(), 1, "continuous: polls counted");
+    expectEq((long long)proc.continuousStats().discreteSignals.load(), 1, "continuous: note-on stays a signal");
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    testMidiMsgBasics();
+    testGuitarPathIsAllocationFree();
+    testDelayQueueOrdering();
+    testScheduledNotesWaitForDeadline();
+    testGuitarStageRunsInline();
+    testGuitarStageTicksOnlyWhileBusy();
+    testTraceLogRecordsAndFilters();
+    testLatencyHistograms();
+    testOverflowedReleaseKeepsRingOrder();
+    testOverflowedCancelKeepsScheduledOrder();
+    testMemoryBackendEndToEnd();
+    testRealtimeBandDispatchEndToEnd();
+    testCaptureRecorderRoundTrip();
+    testContinuousStateSeqlock();
+    if (g_failures > 0) {
+        qWarning() << "MidiProcessorTests failures:" << g_failures;
+        return 1;
+    }
+    qInfo() << "MidiProcessorTests OK";
+    return 0;
+}
@@ -7,6 +7,8 @@
 #include <QStringBuilder>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
 #include <QStandardPaths>
 #include <QTextStream>
 #include <QDateTime>
@@ -58,28 +60,42 @@ MidiProcessor::MidiProcessor(const Preset& preset, QObject *parent)
 
 MidiProcessor::~MidiProcessor() {
     m_isRunning = false;
-    m_condition.notify_one();
+    m_wake.notify();
     if (m_workerThread.joinable()) {
         m_workerThread.join();
     }
+    m_recorder.stop();
 
     // Guarantee silence on teardown. Many samplers require explicit NOTE_OFF to stop loops.
     // Do this AFTER the worker thread is stopped (no concurrent midiOut access),
     // and BEFORE midiOut is destroyed.
     panicAllChannels();
     
-    delete midiInGuitar;
-    delete midiOut;
-    delete midiInVoice;
-    delete midiInVoicePitch;
-    delete midiInAmpero;
+    midiInGuitar.reset();
+    midiOut.reset();
+    midiOutVocalSync.reset();
+    midiInVoice.reset();
+    midiInVoicePitch.reset();
+    midiInAmpero.reset();
 }
 
-void MidiProcessor::safeSendMessage(const std::vector<unsigned char>& msg) {
+void MidiProcessor::safeSendMessage(const midi::MidiMsg& msg) {
     if (!midiOut) return;
     if (msg.empty()) return;
+    // Measured paths only: note-ons carrying the input they came from.
+    const midi::LatencyPath path = msg.timestampNs > 0 ? midi::LatencyStats::pathFor(msg) : midi::LatencyPath::Count;
+    const std::int64_t sendStartNs = path != midi::LatencyPath::Count ? midi::monotonicNowNs() : 0;
     try {
-        midiOut->sendMessage(&msg);
+        // Pointer+length overload: no std::vector is built per message.
+        midiOut->sendMessage(msg.data(), msg.size());
+        if (sendStartNs) {
+            const std::int64_t now = midi::monotonicNowNs();
+            m_latency.recordSend(path, msg.timestampNs, sendStartNs, now);
+            if (onWorkerThread() && m_liveEvent) m_liveEvent->stamps.sendReturnNs = now;
+        }
+        if (m_recorder.recording() && onWorkerThread()) {
+            m_recorder.record(midi::CapturePort::Out, msg, midi::monotonicNowNs());
+        }
     } catch (const RtMidiError& e) {
         std::lock_guard<std::mutex> lock(m_logMutex);
         m_logQueue.push(std::string("ERROR: RtMidi sendMessage failed: ") + e.getMessage());
@@ -92,11 +108,23 @@ void MidiProcessor::safeSendMessage(const std::vector<unsigned char>& msg) {
     }
 }
 
-void MidiProcessor::safeSendVocalSync(const std::vector<unsigned char>& msg) {
+void MidiProcessor::safeSendVocalSync(const midi::MidiMsg& msg) {
     if (!midiOutVocalSync) return;
     if (msg.empty()) return;
+    // VocalSync output is driven by the live inputs (voice/guitar Hz), so
+    // every message sent while handling one is measured from its arrival.
+    const std::int64_t originNs = liveArrivalNs();
+    const std::int64_t sendStartNs = originNs ? midi::monotonicNowNs() : 0;
     try {
-        midiOutVocalSync->sendMessage(&msg);
+        midiOutVocalSync->sendMessage(msg.data(), msg.size());
+        if (originNs) {
+            const std::int64_t now = midi::monotonicNowNs();
+            m_latency.recordSend(midi::LatencyPath::VocalSync, originNs, sendStartNs, now);
+            m_liveEvent->stamps.sendReturnNs = now;
+        }
+        if (m_recorder.recording() && onWorkerThread()) {
+            m_recorder.record(midi::CapturePort::VocalSync, msg, midi::monotonicNowNs());
+        }
     } catch (...) {
         // Silently ignore errors on VocalSync port
     }
@@ -108,7 +136,7 @@ void MidiProcessor::sendVoiceCh10NoteOff(int snapNote) {
     // 0x89 = note-off on ch 10 (1-based). Velocity 0 — release velocity isn't
     // meaningful for breath/sample synths, and matches what we send on the
     // raw-mirror path elsewhere.
-    std::vector<unsigned char> off = {0x89, (unsigned char)snapNote, 0};
+    const midi::MidiMsg off = midi::MidiMsg::make(0x89, (unsigned char)snapNote, 0);
     safeSendMessage(off);
 }
 
@@ -119,11 +147,7 @@ void MidiProcessor::flushVoiceCh10PendingOff() {
     m_voiceCh10PendingOffSnap = -1;
     m_voiceCh10PendingOffMs = 0;
     if (m_voiceCh10HeldSnap == snap) m_voiceCh10HeldSnap = -1;
-    {
-        std::lock_guard<std::mutex> lock(m_logMutex);
-        m_logQueue.push(QString("RAW-MIRROR Voice→ch10 NOTE_OFF (deferred-flushed) note=%1")
-                            .arg(snap).toStdString());
-    }
+    midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Voice, midi::TraceEvent::VoiceCh10NoteOffFlushed, snap);
 }
 
 void MidiProcessor::setVoiceCh10SnapEnabled(bool enabled) {
@@ -139,7 +163,7 @@ void MidiProcessor::setVoiceCh10SnapEnabled(bool enabled) {
         // whatever the current mask is (the noteOn that established held
         // may have been emitted in unsnap mode where held = origNote).
         m_voiceCh10MaskChanged.store(true);
-        m_condition.notify_one();
+        m_wake.notify();
         std::lock_guard<std::mutex> lock(m_logMutex);
         m_logQueue.push("Voice ch10 snap ENABLED — sent bend center reset");
     } else if (!enabled && prev) {
@@ -152,7 +176,7 @@ void MidiProcessor::setVoiceCh10ScaleMask(uint16_t mask) {
     const uint16_t old = m_voiceCh10ScaleMask.exchange(mask);
     if (old != mask) {
         m_voiceCh10MaskChanged.store(true);
-        m_condition.notify_one();
+        m_wake.notify();
     }
 }
 
@@ -176,9 +200,8 @@ void MidiProcessor::handleVoiceCh10MaskChange() {
         // the map prevents a future noteOff from sending a release for a
         // note that's no longer sounding.
         m_voiceCh10SnapMap.clear();
-        std::lock_guard<std::mutex> lock(m_logMutex);
-        m_logQueue.push(QString("Voice→ch10 held note %1 released — out of new mask 0x%2")
-                            .arg(snap).arg(mask, 3, 16, QChar('0')).toStdString());
+        midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Voice, midi::TraceEvent::VoiceCh10HeldReleasedByMask,
+                                            snap, int(mask));
     }
 }
 
@@ -207,17 +230,17 @@ int MidiProcessor::computeVoiceCh10Snap(int origNote, uint16_t mask) const {
 }
 
 void MidiProcessor::sendVocalSyncNoteOn(int note, int velocity) {
-    std::vector<unsigned char> msg = { 0x90, (unsigned char)note, (unsigned char)velocity };
+    const midi::MidiMsg msg = midi::MidiMsg::make(0x90, (unsigned char)note, (unsigned char)velocity);
     safeSendVocalSync(msg);
 }
 
 void MidiProcessor::sendVocalSyncNoteOff(int note) {
-    std::vector<unsigned char> msg = { 0x80, (unsigned char)note, 0 };
+    const midi::MidiMsg msg = midi::MidiMsg::make(0x80, (unsigned char)note, 0);
     safeSendVocalSync(msg);
 }
 
 void MidiProcessor::sendVocalSyncCC(int cc, int value) {
-    std::vector<unsigned char> msg = { 0xB0, (unsigned char)cc, (unsigned char)value };
+    const midi::MidiMsg msg = midi::MidiMsg::make(0xB0, (unsigned char)cc, (unsigned char)value);
     safeSendVocalSync(msg);
 }
 
@@ -225,19 +248,22 @@ void MidiProcessor::sendVocalSyncPitchBend(int bendValue) {
     bendValue = std::max(0, std::min(bendValue, 16383));
     unsigned char lsb = bendValue & 0x7F;
     unsigned char msb = (bendValue >> 7) & 0x7F;
-    std::vector<unsigned char> msg = { 0xE0, lsb, msb };
+    const midi::MidiMsg msg = midi::MidiMsg::make(0xE0, lsb, msb);
     safeSendVocalSync(msg);
 }
 
 bool MidiProcessor::isCriticalMidiEvent(const MidiEvent& ev) {
     // Always keep control events.
     if (ev.type != EventType::MIDI_MESSAGE) return true;
-    const auto& m = ev.message;
-    if (m.empty()) return false;
+    return isCriticalMessage(ev.message.data(), ev.message.size());
+}
+
+bool MidiProcessor::isCriticalMessage(const unsigned char* m, size_t n) {
+    if (n == 0) return false;
     const unsigned char st = m[0] & 0xF0;
     const unsigned char stRaw = m[0];
     if (stRaw >= 0xF0) return false;
-    if (m.size() < 3) return false;
+    if (n < 3) return false;
     const int d1 = int(m[1]);
     const int d2 = int(m[2]);
     // NOTE_OFF (incl note-on vel=0) is critical to avoid stuck notes.
@@ -290,14 +316,160 @@ bool MidiProcessor::tryEnqueueEvent(MidiEvent&& ev) {
     return true;
 }
 
+void MidiProcessor::noteDroppedMidiEvent() {
+    const quint64 dropped = ++m_droppedMidiEvents;
+    // Log occasionally to avoid flooding.
+    if ((dropped % 1024u) == 1u) {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        m_logQueue.push(QString("WARN: Dropping MIDI events due to overload (dropped=%1)")
+                            .arg(qulonglong(dropped))
+                            .toStdString());
+    }
+}
+
+template <typename Ring>
+void MidiProcessor::enqueueInbound(Ring& ring, MidiSource source, const midi::MidiMsg& msg) {
+    if (!ring.push(msg)) {
+        // Ring full (worker stalled for seconds). Never lose a release:
+        // critical messages take the locked overflow lane; the rest drop.
+        if (isCriticalMessage(msg.data(), msg.size())) {
+            enqueueControl({EventType::MIDI_MESSAGE, msg, source, -1, ""});
+            return;
+        }
+        noteDroppedMidiEvent();
+        return;
+    }
+    m_wake.notify();
+}
+
+void MidiProcessor::enqueueVirtual(unsigned char status, unsigned char d1, unsigned char d2) {
+    midi::MidiMsg msg = midi::MidiMsg::make(status, d1, d2);
+    msg.timestampNs = midi::monotonicNowNs();
+    if (onWorkerThread()) {
+        // Sent on behalf of the live input being processed (the inline
+        // stage's lead notes): its latency counts from that input.
+        if (m_liveEvent) msg.timestampNs = m_liveEvent->stamps.arrivalNs;
+        flushVirtualBacklog();
+        sendVirtualNow(msg, m_inlineScratch);
+        return;
+    }
+    enqueueInbound(m_virtualRing, MidiSource::VirtualBand, msg);
+}
+
+bool MidiProcessor::onWorkerThread() const {
+    return m_workerThreadId.load(std::memory_order_relaxed) == std::this_thread::get_id();
+}
+
+void MidiProcessor::flushVirtualBacklog() {
+    while (drainScheduled(m_inlineScratch) > 0) {}
+    while (drainRing(m_virtualRing, MidiSource::VirtualBand, m_inlineScratch) > 0) {}
+}
+
+void MidiProcessor::setGuitarStage(midi::IGuitarStage* stage) {
+    m_guitarStage.store(stage);
+    if (onWorkerThread()) return;
+    while (m_stageBusy.load()) std::this_thread::yield();
+}
+
+void MidiProcessor::releaseGuitarStage(midi::IGuitarStage* stage) {
+    if (!stage || !m_guitarStage.compare_exchange_strong(stage, nullptr)) return;
+    if (onWorkerThread()) return;
+    while (m_stageBusy.load()) std::this_thread::yield();
+}
+
+void MidiProcessor::tickGuitarStage() {
+    m_stageBusy.store(true);
+    m_stageTickDueNs = midi::IGuitarStage::kNoTickDeadline;
+    if (midi::IGuitarStage* stage = m_guitarStage.load()) {
+        const std::int64_t due = stage->nextTickDeadlineNs();
+        if (due != midi::IGuitarStage::kNoTickDeadline) {
+            const std::int64_t now = midi::monotonicNowNs();
+            if (now >= due) stage->tick(now);
+            m_stageTickDueNs = (now >= due) ? stage->nextTickDeadlineNs() : due;
+        }
+    }
+    m_stageBusy.store(false);
+}
+
+void MidiProcessor::runOnWorker(void (*fn)(void*), void* ctx) {
+    if (onWorkerThread() || !m_isRunning) {
+        fn(ctx);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_workerCallMutex);
+    WorkerCall call{fn, ctx};
+    m_workerCall.store(&call);
+    m_wake.notify();
+    while (!call.done.load()) {
+        // Worker stopped before picking the call up: take it back and run it here.
+        if (!m_isRunning) {
+            WorkerCall* expected = &call;
+            if (m_workerCall.compare_exchange_strong(expected, nullptr)) {
+                fn(ctx);
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+void MidiProcessor::serviceWorkerCall() {
+    if (WorkerCall* call = m_workerCall.exchange(nullptr)) {
+        call->fn(call->ctx);
+        call->done.store(true);
+    }
+}
+
+void MidiProcessor::enqueueControl(MidiEvent&& ev) {
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        // MIDI and scheduled entries only get here when their ring was full.
+        const bool overflow = ev.type == EventType::MIDI_MESSAGE || ev.type == EventType::SCHEDULED_MESSAGE ||
+                              ev.type == EventType::SCHEDULED_CANCEL;
+        if (tryEnqueueEvent(std::move(ev)) && overflow) m_eventQueueHasOverflow = true;
+        m_controlQueued.store(true);
+    }
+    m_wake.notify();
+}
+
+void MidiProcessor::enqueueScheduled(const midi::ScheduledMidiMsg& s) {
+    if (onWorkerThread()) {
+        flushVirtualBacklog();
+        acceptScheduled(s, m_inlineScratch);
+        drainScheduled(m_inlineScratch); // sends it now if already due
+        return;
+    }
+    if (!m_scheduledRing.push(s)) {
+        // Ring full (worker stalled): releases and cancels take the locked
+        // lane with their due time; attacks drop like any other overflow.
+        if (s.cancelNoteOns || isCriticalMessage(s.msg.data(), s.msg.size())) {
+            MidiEvent ev{s.cancelNoteOns ? EventType::SCHEDULED_CANCEL : EventType::SCHEDULED_MESSAGE,
+                         s.msg, MidiSource::VirtualBand, -1, ""};
+            ev.dueNs = s.dueNs;
+            enqueueControl(std::move(ev));
+            return;
+        }
+        noteDroppedMidiEvent();
+        return;
+    }
+    m_wake.notify();
+}
+
+bool MidiProcessor::hasPendingInput() const {
+    return m_controlQueued.load() ||
+           !m_guitarRing.empty() || !m_voicePitchRing.empty() ||
+           !m_voiceAmpRing.empty() || !m_amperoRing.empty() ||
+           !m_virtualRing.empty() || !m_scheduledRing.empty();
+}
+
 void MidiProcessor::panicAllChannels() {
     if (!midiOut) return;
     for (int ch = 0; ch < 16; ++ch) {
         for (int n = 0; n < 128; ++n) {
-            std::vector<unsigned char> offMsg = { (unsigned char)(0x80 | (unsigned char)ch), (unsigned char)n, 0 };
+            const midi::MidiMsg offMsg = midi::MidiMsg::make((unsigned char)(0x80 | (unsigned char)ch), (unsigned char)n, 0);
             safeSendMessage(offMsg);
             // Some hosts prefer NoteOn velocity=0 as note-off
-            std::vector<unsigned char> on0Msg = { (unsigned char)(0x90 | (unsigned char)ch), (unsigned char)n, 0 };
+            const midi::MidiMsg on0Msg = midi::MidiMsg::make((unsigned char)(0x90 | (unsigned char)ch), (unsigned char)n, 0);
             safeSendMessage(on0Msg);
         }
         sendChannelAllNotesOff(ch);
@@ -305,55 +477,38 @@ void MidiProcessor::panicAllChannels() {
 }
 
 bool MidiProcessor::initialize() {
-    midiInGuitar = new RtMidiIn();
-    midiOut = new RtMidiOut();
-    midiInVoice = new RtMidiIn();
-    midiInVoicePitch = new RtMidiIn();
-    midiInAmpero = new RtMidiIn();
-
-    auto find_port = [](RtMidi& midi, const std::string& name) {
-        for (unsigned int i = 0; i < midi.getPortCount(); i++) {
-            if (midi.getPortName(i).find(name) != std::string::npos) return (int)i;
-        }
-        return -1;
-    };
+    m_ownedBackend = std::make_unique<midi::RtMidiBackend>();
+    return initialize(*m_ownedBackend);
+}
 
-    int guitarPort = find_port(*midiInGuitar, m_preset.settings.ports["GUITAR_IN"].toStdString());
-    int voicePort = find_port(*midiInVoice, m_preset.settings.ports["VOICE_IN"].toStdString());
+bool MidiProcessor::initialize(midi::IMidiBackend& backend) {
     // Voice pitch port: prefer VOICE_PITCH_IN override; else try default literal
     QString voicePitchName = m_preset.settings.ports.contains("VOICE_PITCH_IN")
         ? m_preset.settings.ports["VOICE_PITCH_IN"]
         : QString("IAC Driver MG3 Voice Pitch");
-    int voicePitchPort = find_port(*midiInVoicePitch, voicePitchName.toStdString());
-    int outPort = find_port(*midiOut, m_preset.settings.ports["CONTROLLER_OUT"].toStdString());
 
-    if (guitarPort == -1 || outPort == -1 || voicePort == -1) {
+    midiInGuitar = backend.openInput(m_preset.settings.ports["GUITAR_IN"].toStdString());
+    midiOut = backend.openOutput(m_preset.settings.ports["CONTROLLER_OUT"].toStdString());
+    midiInVoice = backend.openInput(m_preset.settings.ports["VOICE_IN"].toStdString());
+
+    if (!midiInGuitar || !midiOut || !midiInVoice) {
+        midiInGuitar.reset();
+        midiOut.reset();
+        midiInVoice.reset();
         std::lock_guard<std::mutex> lock(m_logMutex);
         m_logQueue.push("ERROR: Could not find all MIDI ports. Check names in preset.xml.");
         return false;
     }
 
-    midiInGuitar->openPort(guitarPort);
-    midiOut->openPort(outPort);
-    midiInVoice->openPort(voicePort);
-
     // VocalSync: open a dedicated output port on a separate IAC bus
     // This avoids flooding the AU plugin with unrelated MIDI traffic
-    midiOutVocalSync = new RtMidiOut();
-    int vocalSyncPort = find_port(*midiOutVocalSync, "IAC Driver MG3 Bass");
-    if (vocalSyncPort >= 0) {
-        midiOutVocalSync->openPort(vocalSyncPort);
-    } else {
+    midiOutVocalSync = backend.openOutput("IAC Driver MG3 Bass");
+    if (!midiOutVocalSync) {
         // Fallback: create a virtual port
-        try {
-            midiOutVocalSync->openVirtualPort("VocalSync Out");
-        } catch (...) {
-            delete midiOutVocalSync;
-            midiOutVocalSync = nullptr;
-        }
+        midiOutVocalSync = backend.openVirtualOutput("VocalSync Out");
     }
-    if (voicePitchPort != -1) {
-        midiInVoicePitch->openPort(voicePitchPort);
+    midiInVoicePitch = backend.openInput(voicePitchName.toStdString());
+    if (midiInVoicePitch) {
         m_voicePitchAvailable = true;
     } else {
         // Fallback: keep using VOICE_IN for pitch if separate pitch port not found
@@ -371,9 +526,8 @@ bool MidiProcessor::initialize() {
     QString amperoName = m_preset.settings.ports.contains("AMPERO_IN")
         ? m_preset.settings.ports["AMPERO_IN"]
         : QString("Ampero Control");
-    int amperoPort = find_port(*midiInAmpero, amperoName.toStdString());
-    if (amperoPort != -1) {
-        midiInAmpero->openPort(amperoPort);
+    midiInAmpero = backend.openInput(amperoName.toStdString());
+    if (midiInAmpero) {
         m_amperoAvailable = true;
         std::lock_guard<std::mutex> lock(m_logMutex);
         m_logQueue.push(std::string("SUCCESS: Opened Ampero input port: ") + amperoName.toStdString());
@@ -420,16 +574,12 @@ bool MidiProcessor::initialize() {
 }
 
 void MidiProcessor::applyProgram(int programIndex) {
-    std::lock_guard<std::mutex> lock(m_eventMutex);
-    tryEnqueueEvent({EventType::PROGRAM_CHANGE, std::vector<unsigned char>(), MidiSource::Guitar, programIndex, ""});
-    m_condition.notify_one();
+    enqueueControl({EventType::PROGRAM_CHANGE, midi::MidiMsg{}, MidiSource::Guitar, programIndex, ""});
 }
 
 void MidiProcessor::applyTranspose(int semitones) {
-    std::lock_guard<std::mutex> lock(m_eventMutex);
     // Use programIndex field to carry semitone value for TRANSPOSE_CHANGE
-    tryEnqueueEvent({EventType::TRANSPOSE_CHANGE, std::vector<unsigned char>(), MidiSource::Guitar, semitones, ""});
-    m_condition.notify_one();
+    enqueueControl({EventType::TRANSPOSE_CHANGE, midi::MidiMsg{}, MidiSource::Guitar, semitones, ""});
 }
 
 void MidiProcessor::sendVirtualNoteOn(int channel, int note, int velocity) {
@@ -439,10 +589,7 @@ void MidiProcessor::sendVirtualNoteOn(int channel, int note, int velocity) {
     if (velocity < 1) velocity = 1;
     if (velocity > 127) velocity = 127;
     const unsigned char chan = (unsigned char)(channel - 1);
-    std::vector<unsigned char> msg = { (unsigned char)(0x90 | chan), (unsigned char)note, (unsigned char)velocity };
-    std::lock_guard<std::mutex> lock(m_eventMutex);
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, msg, MidiSource::VirtualBand, -1, ""});
-    m_condition.notify_one();
+    enqueueVirtual((unsigned char)(0x90 | chan), (unsigned char)note, (unsigned char)velocity);
 }
 
 void MidiProcessor::sendVirtualNoteOff(int channel, int note) {
@@ -450,27 +597,55 @@ void MidiProcessor::sendVirtualNoteOff(int channel, int note) {
     if (note < 0) note = 0;
     if (note > 127) note = 127;
     const unsigned char chan = (unsigned char)(channel - 1);
-    std::lock_guard<std::mutex> lock(m_eventMutex);
     // Some VSTs/hosts are more reliable with "NoteOn velocity=0" as note-off.
     // Send BOTH forms to avoid stuck notes / "infinite sustain" symptoms.
-    std::vector<unsigned char> msgOff = { (unsigned char)(0x80 | chan), (unsigned char)note, 0 };
-    std::vector<unsigned char> msgOn0 = { (unsigned char)(0x90 | chan), (unsigned char)note, 0 };
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, msgOff, MidiSource::VirtualBand, -1, ""});
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, msgOn0, MidiSource::VirtualBand, -1, ""});
-    m_condition.notify_one();
+    enqueueVirtual((unsigned char)(0x80 | chan), (unsigned char)note, 0);
+    enqueueVirtual((unsigned char)(0x90 | chan), (unsigned char)note, 0);
+}
+
+void MidiProcessor::scheduleVirtualNoteOn(int channel, int note, int velocity, qint64 delayNs) {
+    if (channel < 1 || channel > 16) return;
+    note = qBound(0, note, 127);
+    velocity = qBound(1, velocity, 127);
+    midi::ScheduledMidiMsg s;
+    s.dueNs = midi::monotonicNowNs() + qMax<qint64>(0, delayNs);
+    s.msg = midi::MidiMsg::make((unsigned char)(0x90 | (channel - 1)), (unsigned char)note, (unsigned char)velocity);
+    // Latency origin. A note scheduled while a live input is processed (the
+    // stage's harmony) counts from that input's arrival, shifted by the
+    // intended delay so humanization isn't reported as latency.
+    const std::int64_t liveNs = liveArrivalNs();
+    s.msg.timestampNs = liveNs ? liveNs + qMax<qint64>(0, delayNs) : s.dueNs;
+    enqueueScheduled(s);
+}
+
+void MidiProcessor::scheduleVirtualNoteOff(int channel, int note, qint64 delayNs) {
+    if (channel < 1 || channel > 16) return;
+    note = qBound(0, note, 127);
+    midi::ScheduledMidiMsg s;
+    s.dueNs = midi::monotonicNowNs() + qMax<qint64>(0, delayNs);
+    // Same dual note-off form as sendVirtualNoteOff; both stay behind the note-on.
+    s.msg = midi::MidiMsg::make((unsigned char)(0x80 | (channel - 1)), (unsigned char)note, 0);
+    s.msg.timestampNs = s.dueNs;
+    enqueueScheduled(s);
+    s.msg = midi::MidiMsg::make((unsigned char)(0x90 | (channel - 1)), (unsigned char)note, 0);
+    s.msg.timestampNs = s.dueNs;
+    enqueueScheduled(s);
+}
+
+void MidiProcessor::cancelScheduledVirtualNotes(int channel) {
+    if (channel < 1 || channel > 16) return;
+    midi::ScheduledMidiMsg s;
+    s.cancelNoteOns = true;
+    s.msg = midi::MidiMsg::make((unsigned char)(0xB0 | (channel - 1)), 123, 0);
+    enqueueScheduled(s);
 }
 
 void MidiProcessor::sendVirtualAllNotesOff(int channel) {
     if (channel < 1 || channel > 16) return;
     const unsigned char chan = (unsigned char)(channel - 1);
-    std::vector<unsigned char> sustainOff = { (unsigned char)(0xB0 | chan), 64, 0 };
-    std::vector<unsigned char> allNotesOff = { (unsigned char)(0xB0 | chan), 123, 0 };
-    std::vector<unsigned char> allSoundOff = { (unsigned char)(0xB0 | chan), 120, 0 };
-    std::lock_guard<std::mutex> lock(m_eventMutex);
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, sustainOff, MidiSource::VirtualBand, -1, ""});
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, allNotesOff, MidiSource::VirtualBand, -1, ""});
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, allSoundOff, MidiSource::VirtualBand, -1, ""});
-    m_condition.notify_one();
+    enqueueVirtual((unsigned char)(0xB0 | chan), 64, 0);  // sustain off
+    enqueueVirtual((unsigned char)(0xB0 | chan), 123, 0); // all notes off
+    enqueueVirtual((unsigned char)(0xB0 | chan), 120, 0); // all sound off
 }
 
 void MidiProcessor::sendVirtualCC(int channel, int cc, int value) {
@@ -480,10 +655,7 @@ void MidiProcessor::sendVirtualCC(int channel, int cc, int value) {
     if (value < 0) value = 0;
     if (value > 127) value = 127;
     const unsigned char chan = (unsigned char)(channel - 1);
-    std::vector<unsigned char> msg = { (unsigned char)(0xB0 | chan), (unsigned char)cc, (unsigned char)value };
-    std::lock_guard<std::mutex> lock(m_eventMutex);
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, msg, MidiSource::VirtualBand, -1, ""});
-    m_condition.notify_one();
+    enqueueVirtual((unsigned char)(0xB0 | chan), (unsigned char)cc, (unsigned char)value);
 }
 
 void MidiProcessor::sendVirtualPitchBend(int channel, int bendValue) {
@@ -495,20 +667,16 @@ void MidiProcessor::sendVirtualPitchBend(int channel, int bendValue) {
     // Pitch bend message: status byte 0xE0 | channel, LSB (7 bits), MSB (7 bits)
     unsigned char lsb = (unsigned char)(bendValue & 0x7F);
     unsigned char msb = (unsigned char)((bendValue >> 7) & 0x7F);
-    std::vector<unsigned char> msg = { (unsigned char)(0xE0 | chan), lsb, msb };
-    std::lock_guard<std::mutex> lock(m_eventMutex);
-    tryEnqueueEvent({EventType::MIDI_MESSAGE, msg, MidiSource::VirtualBand, -1, ""});
-    m_condition.notify_one();
+    enqueueVirtual((unsigned char)(0xE0 | chan), lsb, msb);
 }
 
 void MidiProcessor::toggleTrack(const std::string& trackId) {
-    std::lock_guard<std::mutex> lock(m_eventMutex);
-    tryEnqueueEvent({EventType::TRACK_TOGGLE, std::vector<unsigned char>(), MidiSource::Guitar, -1, trackId});
-    m_condition.notify_one();
+    enqueueControl({EventType::TRACK_TOGGLE, midi::MidiMsg{}, MidiSource::Guitar, -1, trackId});
 }
 
 void MidiProcessor::setVerbose(bool verbose) {
-    m_isVerbose.store(verbose);
+    // Verbose lets the Debug-level trace sites through.
+    midi::TraceLog::instance().setLevel(verbose ? midi::TraceLevel::Debug : midi::TraceLevel::Info);
 }
 
 void MidiProcessor::setVoiceControlEnabled(bool enabled) {
@@ -548,6 +716,56 @@ void MidiProcessor::pushLog(const QString& message) {
     m_logQueue.push(message.toStdString());
 }
 
+QString MidiProcessor::dumpLatencyStats() {
+    const QString path = QFileInfo(m_logFilePath).absolutePath() +
+                         QString("/latency-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        pushLog(QString("ERROR: could not write latency histograms to %1").arg(path));
+        return QString();
+    }
+    f.write(QJsonDocument(m_latency.toJson()).toJson(QJsonDocument::Indented));
+    f.close();
+    for (const QString& line : m_latency.summaryLines()) pushLog(line);
+    pushLog(QString("Latency histograms written to %1").arg(path));
+    return path;
+}
+
+QString MidiProcessor::startCaptureRecording(const QString& path) {
+    const QString target = !path.isEmpty()
+        ? path
+        : QFileInfo(m_logFilePath).absolutePath() +
+              QString("/capture-%1.mcap").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    QString error;
+    if (!m_recorder.start(target, &error)) {
+        pushLog(QString("ERROR: MIDI capture not started: %1").arg(error));
+        return QString();
+    }
+    pushLog(QString("Recording MIDI capture to %1").arg(target));
+    return target;
+}
+
+void MidiProcessor::stopCaptureRecording() {
+    if (!m_recorder.recording()) return;
+    m_recorder.stop();
+    pushLog(QString("MIDI capture stopped: %1 events, %2 bytes, %3 dropped (%4)")
+                .arg(m_recorder.recorded())
+                .arg(m_recorder.bytesWritten())
+                .arg(m_recorder.dropped())
+                .arg(m_recorder.path()));
+}
+
+midi::CapturePort MidiProcessor::capturePortFor(MidiSource source) {
+    switch (source) {
+    case MidiSource::Guitar: return midi::CapturePort::Guitar;
+    case MidiSource::VoiceAmp: return midi::CapturePort::VoiceAmp;
+    case MidiSource::VoicePitch: return midi::CapturePort::VoicePitch;
+    case MidiSource::Ampero: return midi::CapturePort::Ampero;
+    case MidiSource::VirtualBand: break;
+    }
+    return midi::CapturePort::VirtualBand;
+}
+
 void MidiProcessor::setHarmonyToggleStateForFlip(bool state) {
     m_harmonyToggleState = state;
 }
@@ -597,12 +815,47 @@ void MidiProcessor::pollLogQueue() {
     QString allMessages;
     {
         std::lock_guard<std::mutex> lock(m_logMutex);
-        if (m_logQueue.empty()) return;
         while(!m_logQueue.empty()) {
             allMessages.append(QString::fromStdString(m_logQueue.front())).append('\n');
             m_logQueue.pop();
         }
     }
+    // Binary trace records from the live paths: formatted here, off the worker.
+    midi::TraceLog& trace = midi::TraceLog::instance();
+    trace.drain([&allMessages](const midi::TraceRecord& r) {
+        allMessages.append(midi::formatTraceRecord(r)).append('\n');
+    });
+    const quint64 dropped = trace.dropped();
+    if (dropped != m_reportedTraceDrops) {
+        allMessages.append(QString("WARN: trace ring full, %1 record(s) dropped\n").arg(dropped - m_reportedTraceDrops));
+        m_reportedTraceDrops = dropped;
+    }
+    // Verbose: event-loop traffic every 10 s while there is any. "before" is
+    // what the continuous values used to cost as one queued signal each.
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    if (nowMs - m_rateReportStartMs >= 10000) {
+        const quint64 updates = m_continuousStats.updates.load(std::memory_order_relaxed);
+        const quint64 polls = m_continuousStats.polls.load(std::memory_order_relaxed);
+        const quint64 discrete = m_continuousStats.discreteSignals.load(std::memory_order_relaxed);
+        if (m_rateReportStartMs > 0 && updates != m_reportedRateUpdates &&
+            trace.enabled(midi::TraceLevel::Debug, midi::TraceCategory::Voice)) {
+            const double secs = double(nowMs - m_rateReportStartMs) / 1000.0;
+            const double before = double(updates - m_reportedRateUpdates + discrete - m_reportedRateDiscrete) / secs;
+            const double after = double(polls - m_reportedRatePolls + discrete - m_reportedRateDiscrete) / secs;
+            allMessages.append(QString("Event loop: %1 events/s as queued signals -> %2 events/s "
+                                       "(%3 continuous updates/s coalesced, %4 polls/s, %5 note signals/s)\n")
+                                   .arg(before, 0, 'f', 0)
+                                   .arg(after, 0, 'f', 0)
+                                   .arg(double(updates - m_reportedRateUpdates) / secs, 0, 'f', 0)
+                                   .arg(double(polls - m_reportedRatePolls) / secs, 0, 'f', 0)
+                                   .arg(double(discrete - m_reportedRateDiscrete) / secs, 0, 'f', 0));
+        }
+        m_reportedRateUpdates = updates;
+        m_reportedRatePolls = polls;
+        m_reportedRateDiscrete = discrete;
+        m_rateReportStartMs = nowMs;
+    }
+    if (allMessages.isEmpty()) return;
     const QString trimmed = allMessages.trimmed();
     emit logMessage(trimmed);
 
@@ -623,95 +876,212 @@ void MidiProcessor::pollLogQueue() {
 void MidiProcessor::guitarCallback(double deltatime, std::vector<unsigned char>* message, void* userData) {
     MidiProcessor* self = static_cast<MidiProcessor*>(userData);
     if (!self->m_isRunning) return;
-    if (!message) return;
-    {
-        std::lock_guard<std::mutex> lock(self->m_eventMutex);
-        self->tryEnqueueEvent({EventType::MIDI_MESSAGE, *message, MidiSource::Guitar, -1, ""});
-    }
-    self->m_condition.notify_one();
+    midi::MidiMsg msg;
+    if (!midi::MidiMsg::fromVector(message, msg)) return;
+    msg.timestampNs = midi::monotonicNowNs();
+    self->enqueueInbound(self->m_guitarRing, MidiSource::Guitar, msg);
 }
 
 void MidiProcessor::voiceAmpCallback(double deltatime, std::vector<unsigned char>* message, void* userData) {
     MidiProcessor* self = static_cast<MidiProcessor*>(userData);
     if (!self->m_isRunning) return;
-    if (!message) return;
-    {
-        std::lock_guard<std::mutex> lock(self->m_eventMutex);
-        self->tryEnqueueEvent({EventType::MIDI_MESSAGE, *message, MidiSource::VoiceAmp, -1, ""});
-    }
-    self->m_condition.notify_one();
+    midi::MidiMsg msg;
+    if (!midi::MidiMsg::fromVector(message, msg)) return;
+    msg.timestampNs = midi::monotonicNowNs();
+    self->enqueueInbound(self->m_voiceAmpRing, MidiSource::VoiceAmp, msg);
 }
 
 void MidiProcessor::voicePitchCallback(double deltatime, std::vector<unsigned char>* message, void* userData) {
     MidiProcessor* self = static_cast<MidiProcessor*>(userData);
     if (!self->m_isRunning) return;
-    if (!message) return;
-    {
-        std::lock_guard<std::mutex> lock(self->m_eventMutex);
-        self->tryEnqueueEvent({EventType::MIDI_MESSAGE, *message, MidiSource::VoicePitch, -1, ""});
-    }
-    self->m_condition.notify_one();
+    midi::MidiMsg msg;
+    if (!midi::MidiMsg::fromVector(message, msg)) return;
+    msg.timestampNs = midi::monotonicNowNs();
+    self->enqueueInbound(self->m_voicePitchRing, MidiSource::VoicePitch, msg);
 }
 
 void MidiProcessor::amperoCallback(double deltatime, std::vector<unsigned char>* message, void* userData) {
     MidiProcessor* self = static_cast<MidiProcessor*>(userData);
     if (!self->m_isRunning) return;
-    if (!message) return;
-    {
-        std::lock_guard<std::mutex> lock(self->m_eventMutex);
-        self->tryEnqueueEvent({EventType::MIDI_MESSAGE, *message, MidiSource::Ampero, -1, ""});
+    midi::MidiMsg msg;
+    if (!midi::MidiMsg::fromVector(message, msg)) return;
+    msg.timestampNs = midi::monotonicNowNs();
+    self->enqueueInbound(self->m_amperoRing, MidiSource::Ampero, msg);
+}
+
+template <typename Ring>
+int MidiProcessor::drainRing(Ring& ring, MidiSource source, MidiEvent& scratch, int limit) {
+    int n = 0;
+    while (n < limit && ring.pop(scratch.message)) {
+        scratch.source = source;
+        if (m_recorder.recording()) {
+            m_recorder.record(capturePortFor(source), scratch.message,
+                              scratch.message.timestampNs > 0 ? scratch.message.timestampNs : midi::monotonicNowNs());
+        }
+        if (source != MidiSource::VirtualBand && scratch.message.timestampNs > 0) {
+            processLiveEvent(scratch);
+        } else {
+            processMidiEvent(scratch);
+        }
+        ++n;
+    }
+    return n;
+}
+
+void MidiProcessor::processLiveEvent(MidiEvent& ev) {
+    ev.stamps = midi::LatencyStamps{};
+    ev.stamps.arrivalNs = ev.message.timestampNs;
+    ev.stamps.dequeueNs = midi::monotonicNowNs();
+    MidiEvent* const outer = m_liveEvent;
+    m_liveEvent = &ev;
+    processMidiEvent(ev);
+    m_liveEvent = outer;
+    ev.stamps.processEndNs = midi::monotonicNowNs();
+    m_latency.recordEvent(ev.stamps);
+}
+
+std::int64_t MidiProcessor::liveArrivalNs() const {
+    return (onWorkerThread() && m_liveEvent) ? m_liveEvent->stamps.arrivalNs : 0;
+}
+
+bool MidiProcessor::takeControlQueue() {
+    if (!m_controlQueued.exchange(false)) return false;
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    m_controlBatch.swap(m_eventQueue);
+    const bool overflow = m_eventQueueHasOverflow;
+    m_eventQueueHasOverflow = false;
+    return overflow;
+}
+
+int MidiProcessor::processControlBatch() {
+    const int n = int(m_controlBatch.size());
+    for (const MidiEvent& ev : m_controlBatch) {
+        processMidiEvent(ev);
     }
-    self->m_condition.notify_one();
+    m_controlBatch.clear();
+    return n;
+}
+
+void MidiProcessor::sendVirtualNow(const midi::MidiMsg& msg, MidiEvent& scratch) {
+    scratch.source = MidiSource::VirtualBand;
+    scratch.message = msg;
+    processMidiEvent(scratch);
+}
+
+void MidiProcessor::acceptScheduled(const midi::ScheduledMidiMsg& s, MidiEvent& scratch) {
+    if (s.cancelNoteOns) {
+        m_delayQueue.cancelNoteOns(s.msg.channelNibble());
+        return;
+    }
+    // Full: send the earliest entries ahead of time rather than lose one.
+    // Heap order is kept, so an off still never precedes its on.
+    midi::MidiMsg early;
+    while (m_delayQueue.full() && m_delayQueue.popFront(early)) {
+        sendVirtualNow(early, scratch);
+    }
+    m_delayQueue.push(s.msg, s.dueNs);
+}
+
+int MidiProcessor::drainScheduled(MidiEvent& scratch, int limit) {
+    int n = 0;
+    midi::ScheduledMidiMsg s;
+    while (n < limit && m_scheduledRing.pop(s)) {
+        acceptScheduled(s, scratch);
+        ++n;
+    }
+    if (m_delayQueue.empty()) return n;
+    const std::int64_t now = midi::monotonicNowNs();
+    midi::MidiMsg due;
+    while (m_delayQueue.popDue(now, due)) {
+        sendVirtualNow(due, scratch);
+        ++n;
+    }
+    return n;
+}
+
+int MidiProcessor::runWorkerPass(MidiEvent& scratch) {
+    // Handle out-of-band signals before consuming events so a stale
+    // held note doesn't briefly process under the new mask.
+    if (m_voiceCh10MaskChanged.exchange(false)) {
+        handleVoiceCh10MaskChange();
+    }
+    serviceWorkerCall();
+
+    // Live inputs first (guitar is the latency-critical one), then the
+    // virtual band, then the cold control/overflow lane. The lane is taken
+    // before the rings are sized: a critical message in it was diverted
+    // because its ring was full, so every entry older than it is already in
+    // that ring. Such a pass drains each ring up to its current size rather
+    // than one batch, so the diverted message still goes out after them.
+    const bool overflow = takeControlQueue();
+    const auto limitFor = [overflow](const auto& ring) {
+        return overflow ? qMax(kRingDrainBatch, int(ring.sizeApprox())) : kRingDrainBatch;
+    };
+    int processed = 0;
+    processed += drainRing(m_guitarRing, MidiSource::Guitar, scratch, limitFor(m_guitarRing));
+    processed += drainRing(m_voicePitchRing, MidiSource::VoicePitch, scratch, limitFor(m_voicePitchRing));
+    processed += drainRing(m_voiceAmpRing, MidiSource::VoiceAmp, scratch, limitFor(m_voiceAmpRing));
+    processed += drainRing(m_amperoRing, MidiSource::Ampero, scratch, limitFor(m_amperoRing));
+    // Timed notes before the plain virtual ring, so a cancel queued
+    // ahead of an all-notes-off takes effect before the kill goes out.
+    // Overflowed releases and cancels reach m_delayQueue through the
+    // control lane, so the same full drain keeps them behind older attacks.
+    processed += drainScheduled(scratch, limitFor(m_scheduledRing));
+    processed += drainRing(m_virtualRing, MidiSource::VirtualBand, scratch, limitFor(m_virtualRing));
+    processed += processControlBatch();
+    tickGuitarStage();
+    return processed;
 }
 
 void MidiProcessor::workerLoop() {
+    m_workerThreadId.store(std::this_thread::get_id());
+    MidiEvent scratch;
+    scratch.type = EventType::MIDI_MESSAGE;
+    scratch.programIndex = -1;
+
+    const auto hasWork = [this] {
+        return hasPendingInput() || !m_isRunning || m_voiceCh10MaskChanged.load() ||
+               m_workerCall.load() != nullptr;
+    };
+
     while (m_isRunning) {
-        MidiEvent event;
-        bool gotEvent = false;
-        {
-            std::unique_lock<std::mutex> lock(m_eventMutex);
+        if (!hasWork()) {
             // When a voice ch-10 note-off is deferred, wake at the deadline
             // even if no events arrive — otherwise the held legato note
             // hangs (singer stops, MG3 stops emitting, no event triggers
             // the timeout check inside processMidiEvent).
             // Also wake on a voice mask change so a held note that's no
             // longer in scale can be released without waiting for the next
-            // event.
-            auto pred = [this] {
-                return !m_eventQueue.empty() || !m_isRunning ||
-                       m_voiceCh10MaskChanged.load();
-            };
+            // event. Scheduled virtual notes set the other deadline.
+            std::int64_t timeoutNs = -1;
             if (m_voiceCh10PendingOffSnap >= 0) {
                 const qint64 now = QDateTime::currentMSecsSinceEpoch();
                 const qint64 elapsed = now - m_voiceCh10PendingOffMs;
-                if (elapsed < kVoiceCh10PendingTimeoutMs) {
-                    const auto remaining = std::chrono::milliseconds(
-                        kVoiceCh10PendingTimeoutMs - elapsed);
-                    m_condition.wait_for(lock, remaining, pred);
-                }
-                // else: deadline already passed; fall through to consume / flush.
-            } else {
-                m_condition.wait(lock, pred);
+                // <= 0: deadline already passed; fall through to flush.
+                timeoutNs = qMax<qint64>(0, kVoiceCh10PendingTimeoutMs - elapsed) * 1000000;
             }
-
-            if (!m_isRunning && m_eventQueue.empty()) break;
-
-            if (!m_eventQueue.empty()) {
-                event = std::move(m_eventQueue.front());
-                m_eventQueue.pop_front();
-                gotEvent = true;
+            if (!m_delayQueue.empty()) {
+                const std::int64_t untilDue = qMax<std::int64_t>(0, m_delayQueue.nextDueNs() - midi::monotonicNowNs());
+                timeoutNs = (timeoutNs < 0) ? untilDue : qMin(timeoutNs, untilDue);
+            }
+            // The guitar stage only sets a deadline while it has timed work
+            // (glide, bend, delayed note); an idle stage adds no wakeups.
+            if (m_stageTickDueNs != midi::IGuitarStage::kNoTickDeadline && m_guitarStage.load()) {
+                const std::int64_t untilTick = qMax<std::int64_t>(0, m_stageTickDueNs - midi::monotonicNowNs());
+                timeoutNs = (timeoutNs < 0) ? untilTick : qMin(timeoutNs, untilTick);
+            }
+            if (timeoutNs < 0) {
+                m_wake.wait(hasWork);
+            } else {
+                m_wake.waitFor(std::chrono::nanoseconds(timeoutNs), hasWork);
             }
         }
 
-        // Handle out-of-band signals before consuming the event so a stale
-        // held note doesn't briefly process under the new mask.
-        if (m_voiceCh10MaskChanged.exchange(false)) {
-            handleVoiceCh10MaskChange();
-        }
+        if (!m_isRunning) break;
+
+        const int processed = runWorkerPass(scratch);
 
-        if (gotEvent) {
-            processMidiEvent(event);
-        } else if (m_voiceCh10PendingOffSnap >= 0) {
+        if (processed == 0 && m_voiceCh10PendingOffSnap >= 0) {
             // Timed out without an event — flush the deferred release so the
             // synth doesn't hold the legato note past the singer's silence.
             const qint64 now = QDateTime::currentMSecsSinceEpoch();
@@ -735,6 +1105,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
             flushVoiceCh10PendingOff();
         }
     }
+    if (m_liveEvent == &event) m_liveEvent->stamps.processStartNs = midi::monotonicNowNs();
     switch(event.type) {
         case EventType::MIDI_MESSAGE:
             {
@@ -761,16 +1132,14 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     // listen specifically to raw guitar (filter MIDI In Channel
                     // = 9) without channel-1 traffic mixed in. The processed
                     // lead still flows on channel 1 via ScaleSnapProcessor.
-                    if (!message.empty() && message[0] < 0xF0) {
-                        std::vector<unsigned char> rawMsg = message;
-                        rawMsg[0] = (rawMsg[0] & 0xF0) | 0x08; // ch 9 (1-based)
+                    if (message.isChannelMessage()) {
+                        const midi::MidiMsg rawMsg = message.withChannel(0x08); // ch 9 (1-based)
                         safeSendMessage(rawMsg);
-                        // Log every note-on (unconditional, not verbose-gated).
-                        if ((rawMsg[0] & 0xF0) == 0x90 && rawMsg.size() >= 3 && rawMsg[2] > 0) {
-                            std::lock_guard<std::mutex> lock(m_logMutex);
-                            m_logQueue.push(QString("RAW-MIRROR Guitar→ch9 note=%1 vel=%2 status=0x%3")
-                                                .arg(rawMsg[1]).arg(rawMsg[2])
-                                                .arg(rawMsg[0], 2, 16, QChar('0')).toStdString());
+                        // Binary trace record; formatted later by pollLogQueue().
+                        if (rawMsg.type() == 0x90 && rawMsg.size() >= 3 && rawMsg[2] > 0) {
+                            midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Guitar,
+                                                                midi::TraceEvent::GuitarRawMirrorNoteOn,
+                                                                rawMsg[1], rawMsg[2], rawMsg[0]);
                         }
                     }
 
@@ -780,6 +1149,8 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                         // Emit velocity for visualizer fallback amplitude
                         if (velocity != m_lastGuitarVelocity) {
                             m_lastGuitarVelocity = velocity;
+                            m_continuous.guitarVelocity = velocity;
+                            publishContinuous();
                             emit guitarVelocityUpdated(velocity);
                         }
                         // Only process MIDI commands if voice control is disabled
@@ -799,7 +1170,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                             }
                         }
                     }
-                    std::vector<unsigned char> passthroughMsg = message;
+                    midi::MidiMsg passthroughMsg = message;
                     // Only channel messages (0x8*..0xE*) should have their channel nibble rewritten.
                     if (passthroughMsg[0] < 0xF0) {
                         passthroughMsg[0] = (passthroughMsg[0] & 0xF0) | 0x00;
@@ -810,6 +1181,8 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                         int aftertouch = message[1];
                         if (aftertouch != m_lastGuitarAftertouch) {
                             m_lastGuitarAftertouch = aftertouch;
+                            m_continuous.guitarAftertouch = aftertouch;
+                            publishContinuous();
                             emit guitarAftertouchUpdated(aftertouch);
                         }
                     }
@@ -827,11 +1200,21 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     }
 
                     // Listening MVP hook: emit transposed performance note events (ignore command/backing selection notes).
+                    // The inline stage (ScaleSnapProcessor) runs first, synchronously, so its lead/harmony
+                    // output leaves on this pass; signal receivers are notified afterwards.
                     if (!m_inCommandMode && (status == 0x90 || status == 0x80) && passthroughMsg.size() >= 3) {
                         const int note = int(passthroughMsg[1]);
                         const int vel = int(passthroughMsg[2]);
-                        if (status == 0x90 && vel > 0) emit guitarNoteOn(note, vel);
-                        else if (status == 0x80 || (status == 0x90 && vel == 0)) emit guitarNoteOff(note);
+                        const bool isOn = (status == 0x90 && vel > 0);
+                        m_stageBusy.store(true);
+                        if (midi::IGuitarStage* stage = m_guitarStage.load()) {
+                            if (isOn) stage->guitarNoteOn(note, vel);
+                            else stage->guitarNoteOff(note);
+                        }
+                        m_stageBusy.store(false);
+                        m_continuousStats.discreteSignals.fetch_add(1, std::memory_order_relaxed);
+                        if (isOn) emit guitarNoteOn(note, vel);
+                        else emit guitarNoteOff(note);
                     }
 
                     // When ScaleSnapProcessor has Lead mode active, suppress passthrough of:
@@ -857,7 +1240,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     //      learned Controller Assignment: 127 = unmuted,
                     //      0 = muted. (The stock Logic mute button is
                     //      inverted, but the learned CA ends up this way.)
-                    std::vector<unsigned char> passMsg = message;
+                    midi::MidiMsg passMsg = message;
                     // Force channel 1 on passthrough so downstream Scripters /
                     // Controller Assignments don't have to care about the
                     // Ampero's transmit channel.
@@ -878,7 +1261,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     // duplication.
                     if (!message.empty() && message[0] < 0xF0) {
                         for (unsigned char chNibble = 0x08; chNibble <= 0x09; ++chNibble) {
-                            std::vector<unsigned char> mirrorMsg = message;
+                            midi::MidiMsg mirrorMsg = message;
                             mirrorMsg[0] = (mirrorMsg[0] & 0xF0) | chNibble;
                             safeSendMessage(mirrorMsg);
                         }
@@ -889,11 +1272,8 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                         const int value = int(message[2]);
                         // Unconditional CC trace — diagnoses footswitch
                         // mode (toggle vs momentary) at a glance.
-                        {
-                            std::lock_guard<std::mutex> lock(m_logMutex);
-                            m_logQueue.push(QString("Ampero RX  CC%1 = %2")
-                                                .arg(cc).arg(value).toStdString());
-                        }
+                        midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Ampero, midi::TraceEvent::AmperoCc,
+                                                            cc, value);
                         if (cc == m_audioTrackSwitchCC.load()) {
                             QList<AudioTrackMute> localMap;
                             {
@@ -903,19 +1283,14 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                             for (const auto& at : localMap) {
                                 // 127 = unmute the matching track; 0 = mute the rest.
                                 const unsigned char muteVal = (value == at.switchValue) ? 127 : 0;
-                                std::vector<unsigned char> muteMsg = {
-                                    0xB0, (unsigned char)at.muteCC, muteVal
-                                };
+                                const midi::MidiMsg muteMsg = midi::MidiMsg::make(0xB0, (unsigned char)at.muteCC, muteVal);
                                 safeSendMessage(muteMsg);
                             }
                             // Always log fan-out events (not gated on verbose)
                             // so the user can confirm the feature is firing.
-                            std::lock_guard<std::mutex> lock(m_logMutex);
-                            m_logQueue.push(QString("Ampero CC%1=%2 -> fanned out %3 mute CC(s)")
-                                                .arg(cc)
-                                                .arg(value)
-                                                .arg(localMap.size())
-                                                .toStdString());
+                            midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Ampero,
+                                                                midi::TraceEvent::AmperoFanOut,
+                                                                cc, value, int(localMap.size()));
                         } else if (cc == m_harmonyToggleCC.load()) {
                             // Harmony master toggle. The Ampero's "Toggle CC"
                             // mode alternates 0/127 each press, with no
@@ -928,11 +1303,9 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                                 m_lastHarmonyToggleValue = value;
                                 m_harmonyToggleState = !m_harmonyToggleState;
                                 emit harmonyToggleRequested(m_harmonyToggleState);
-                                std::lock_guard<std::mutex> lock(m_logMutex);
-                                m_logQueue.push(QString("Ampero harmony toggle CC%1=%2 (press) -> %3")
-                                                    .arg(cc).arg(value)
-                                                    .arg(m_harmonyToggleState ? "ON" : "OFF")
-                                                    .toStdString());
+                                midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Ampero,
+                                                                    midi::TraceEvent::AmperoHarmonyToggle,
+                                                                    cc, value, m_harmonyToggleState ? 1 : 0);
                             }
                         } else if (cc == m_harmonyRootStepCC.load()) {
                             // Rising-edge detection so momentary footswitches
@@ -985,12 +1358,9 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                                 m_logQueue.push(QString("Ampero direct-chord CC%1=%2 (no mapping)")
                                                     .arg(cc).arg(value).toStdString());
                             }
-                        } else if (m_isVerbose.load()) {
-                            std::lock_guard<std::mutex> lock(m_logMutex);
-                            m_logQueue.push(QString("Ampero CC%1=%2 (passthrough only)")
-                                                .arg(cc)
-                                                .arg(value)
-                                                .toStdString());
+                        } else {
+                            midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::Ampero,
+                                                                 midi::TraceEvent::AmperoPassthrough, cc, value);
                         }
                     }
 
@@ -1003,7 +1373,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     // single combined stream of pitched notes + continuous
                     // breath/aftertouch expression.
                     if (!message.empty() && message[0] < 0xF0) {
-                        std::vector<unsigned char> rawMsg = message;
+                        midi::MidiMsg rawMsg = message;
                         rawMsg[0] = (rawMsg[0] & 0xF0) | 0x09; // ch 10 (1-based)
                         // Defensive: drop any pitch bend coming from the amp
                         // port while snap is active, so the snapped note
@@ -1024,9 +1394,9 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                         int breathValue = std::max(0, value - 16);
 
                         // Channel 1: existing breath-control destination.
-                        std::vector<unsigned char> cc2_msg = {0xB0, 2, (unsigned char)breathValue};
+                        const midi::MidiMsg cc2_msg = midi::MidiMsg::make(0xB0, 2, (unsigned char)breathValue);
                         safeSendMessage(cc2_msg);
-                        std::vector<unsigned char> cc104_msg = {0xB0, 104, (unsigned char)breathValue};
+                        const midi::MidiMsg cc104_msg = midi::MidiMsg::make(0xB0, 104, (unsigned char)breathValue);
                         safeSendMessage(cc104_msg);
 
                         // Channel 10: combined voice channel needs the same
@@ -1035,16 +1405,21 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                         // expression. The raw aftertouch is also there from
                         // the mirror above, but most synths don't route
                         // channel pressure to volume by default.
-                        std::vector<unsigned char> cc2_ch10  = {0xB9, 2,   (unsigned char)breathValue};
-                        std::vector<unsigned char> cc104_ch10 = {0xB9, 104, (unsigned char)breathValue};
+                        const midi::MidiMsg cc2_ch10 = midi::MidiMsg::make(0xB9, 2, (unsigned char)breathValue);
+                        const midi::MidiMsg cc104_ch10 = midi::MidiMsg::make(0xB9, 104, (unsigned char)breathValue);
                         safeSendMessage(cc2_ch10);
                         safeSendMessage(cc104_ch10);
 
-                        // Unthrottled stream for interaction/vibe detection.
+                        // Unthrottled stream for interaction/vibe detection:
+                        // every sample is counted in the state block.
+                        const bool cc2Changed = breathValue != m_lastVoiceCc2;
+                        m_continuous.voiceCc2 = breathValue;
+                        ++m_continuous.voiceCc2Samples;
+                        publishContinuous(cc2Changed ? 2 : 1);
                         emit voiceCc2Stream(breathValue);
                         
                         // Emit breath (CC2) amplitude for visualizer if changed
-                        if (breathValue != m_lastVoiceCc2) {
+                        if (cc2Changed) {
                             m_lastVoiceCc2 = breathValue;
                             emit voiceCc2Updated(breathValue);
                         }
@@ -1074,7 +1449,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     // coherent at note-on. MIDI requires velocity ≥ 1
                     // (vel = 0 would be interpreted as note-off).
                     if (!message.empty() && message[0] < 0xF0) {
-                        std::vector<unsigned char> rawMsg = message;
+                        midi::MidiMsg rawMsg = message;
                         rawMsg[0] = (rawMsg[0] & 0xF0) | 0x09; // ch 10 (combined voice)
 
                         const unsigned char statusType = rawMsg[0] & 0xF0;
@@ -1155,7 +1530,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                                 // suppressed below so the note holds exactly
                                 // on scale for its full duration.
                                 if (maskActive) {
-                                    std::vector<unsigned char> bendCenter = {0xE9, 0x00, 0x40};
+                                    const midi::MidiMsg bendCenter = midi::MidiMsg::make(0xE9, 0x00, 0x40);
                                     safeSendMessage(bendCenter);
                                 }
                                 // BREATH PRIMER: physical-modeling brass / wind
@@ -1164,22 +1539,20 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                                 // their breath envelope is at 0 and the note
                                 // voices silently. Send CC 2 / CC 104 with the
                                 // same value as velocity right before the note.
-                                std::vector<unsigned char> primeCc2  = {0xB9, 2,   (unsigned char)v};
-                                std::vector<unsigned char> primeCc104= {0xB9, 104, (unsigned char)v};
+                                const midi::MidiMsg primeCc2 = midi::MidiMsg::make(0xB9, 2, (unsigned char)v);
+                                const midi::MidiMsg primeCc104 = midi::MidiMsg::make(0xB9, 104, (unsigned char)v);
                                 safeSendMessage(primeCc2);
                                 safeSendMessage(primeCc104);
                                 safeSendMessage(rawMsg);
                                 m_voiceCh10HeldSnap = snapNote;
-                                std::lock_guard<std::mutex> lock(m_logMutex);
-                                m_logQueue.push(QString("RAW-MIRROR Voice→ch10 NOTE_ON snap=%1 orig=%2 vel=%3 (breath=%4 mask=0x%5)")
-                                                    .arg(snapNote).arg(origNote).arg(vel)
-                                                    .arg(m_lastVoiceCc2)
-                                                    .arg(mask, 3, 16, QChar('0')).toStdString());
+                                midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Voice,
+                                                                    midi::TraceEvent::VoiceCh10NoteOn,
+                                                                    snapNote, origNote, vel,
+                                                                    (m_lastVoiceCc2 & 0xFF) | (int(mask) << 8));
                             } else {
-                                std::lock_guard<std::mutex> lock(m_logMutex);
-                                m_logQueue.push(QString("RAW-MIRROR Voice→ch10 NOTE_ON %1 snap=%2 orig=%3 (held)")
-                                                    .arg(merged ? "MERGED" : "tied")
-                                                    .arg(snapNote).arg(origNote).toStdString());
+                                midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Voice,
+                                                                    midi::TraceEvent::VoiceCh10NoteOnHeld,
+                                                                    merged ? 1 : 0, snapNote, origNote);
                             }
                         } else if (isNoteOff) {
                             const int origNote = rawMsg[1];
@@ -1206,9 +1579,9 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                                     // drops to zero, both flush via the helper.
                                     m_voiceCh10PendingOffSnap = snapNote;
                                     m_voiceCh10PendingOffMs   = QDateTime::currentMSecsSinceEpoch();
-                                    std::lock_guard<std::mutex> lock(m_logMutex);
-                                    m_logQueue.push(QString("RAW-MIRROR Voice→ch10 NOTE_OFF deferred snap=%1 orig=%2")
-                                                        .arg(snapNote).arg(origNote).toStdString());
+                                    midi::trace<midi::TraceLevel::Info>(midi::TraceCategory::Voice,
+                                                                        midi::TraceEvent::VoiceCh10NoteOffDeferred,
+                                                                        snapNote, origNote);
                                 } else {
                                     // Unsnapped path (or held mismatch — defensive):
                                     // release immediately on the snapped note number.
@@ -1240,7 +1613,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     }
                     // Use accurate pitch notes for visualization and optionally for output
                     if (status == 0x90 || status == 0x80) { // Note on/off for voice
-                        std::vector<unsigned char> voiceMsg = message;
+                        midi::MidiMsg voiceMsg = message;
                         if (voiceMsg[0] < 0xF0) {
                             voiceMsg[0] = (voiceMsg[0] & 0xF0) | 0x01; // Set to channel 2
                         }
@@ -1261,6 +1634,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                             const int vel = int(voiceMsg[2]);
                             if (status == 0x90 && vel > 0) emit voiceNoteOn(note, vel);
                             else if (status == 0x80 || (status == 0x90 && vel == 0)) emit voiceNoteOff(note);
+                            m_continuousStats.discreteSignals.fetch_add(1, std::memory_order_relaxed);
                         }
                         // Skip raw passthrough when VocalSync uses Ch 2 for pitch targets
                         if (!m_suppressVoicePassthrough.load()) {
@@ -1270,7 +1644,7 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                         // Forward other non-aftertouch messages as-is on channel 2
                         // Skip when VocalSync uses Ch 2 for pitch targets
                         if (!m_suppressVoicePassthrough.load()) {
-                            std::vector<unsigned char> voiceMsg = message;
+                            midi::MidiMsg voiceMsg = message;
                             if (voiceMsg[0] < 0xF0) {
                                 voiceMsg[0] = (voiceMsg[0] & 0xF0) | 0x01;
                             }
@@ -1279,22 +1653,18 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                     }
                 } else if (event.source == MidiSource::VirtualBand) {
                     // Virtual musicians: forward as-is (no transpose, no channel remap).
-                    if (m_isVerbose.load()) {
-                        // Log note events so we can verify keyswitch/FX output is actually happening.
-                        if (event.message.size() >= 3) {
-                            const unsigned char st = event.message[0] & 0xF0;
-                            const int ch = int(event.message[0] & 0x0F) + 1;
-                            const int note = int(event.message[1]);
-                            const int vel = int(event.message[2]);
-                            if (st == 0x90 && vel > 0) {
-                                std::lock_guard<std::mutex> lock(m_logMutex);
-                                m_logQueue.push(QString("VirtualBand NOTE_ON  ch%1 note=%2 vel=%3")
-                                                    .arg(ch).arg(note).arg(vel).toStdString());
-                            } else if (st == 0x80 || (st == 0x90 && vel == 0)) {
-                                std::lock_guard<std::mutex> lock(m_logMutex);
-                                m_logQueue.push(QString("VirtualBand NOTE_OFF ch%1 note=%2")
-                                                    .arg(ch).arg(note).toStdString());
-                            }
+                    // Log note events (verbose) so we can verify keyswitch/FX output is actually happening.
+                    if (event.message.size() >= 3) {
+                        const unsigned char st = event.message[0] & 0xF0;
+                        const int ch = int(event.message[0] & 0x0F) + 1;
+                        const int note = int(event.message[1]);
+                        const int vel = int(event.message[2]);
+                        if (st == 0x90 && vel > 0) {
+                            midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::VirtualBand,
+                                                                 midi::TraceEvent::VirtualBandNoteOn, ch, note, vel);
+                        } else if (st == 0x80 || (st == 0x90 && vel == 0)) {
+                            midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::VirtualBand,
+                                                                 midi::TraceEvent::VirtualBandNoteOff, ch, note);
                         }
                     }
                     safeSendMessage(event.message);
@@ -1331,6 +1701,19 @@ void MidiProcessor::processMidiEvent(const MidiEvent& event) {
                 setTrackState(event.trackId, !m_trackStates.at(event.trackId));
             }
             break;
+        case EventType::SCHEDULED_MESSAGE:
+        case EventType::SCHEDULED_CANCEL:
+            {
+                midi::ScheduledMidiMsg s;
+                s.msg = event.message;
+                s.dueNs = event.dueNs;
+                s.cancelNoteOns = (event.type == EventType::SCHEDULED_CANCEL);
+                MidiEvent scratch;
+                scratch.type = EventType::MIDI_MESSAGE;
+                scratch.programIndex = -1;
+                acceptScheduled(s, scratch);
+            }
+            break;
     }
 }
 
@@ -1340,12 +1723,12 @@ void MidiProcessor::processProgramChange(int programIndex) {
     m_currentProgramIndex = programIndex;
 
     if (program.programCC != -1 && program.programValue != -1) {
-        std::vector<unsigned char> prog_msg = { 0xB0, (unsigned char)program.programCC, (unsigned char)program.programValue };
+        const midi::MidiMsg prog_msg = midi::MidiMsg::make(0xB0, (unsigned char)program.programCC, (unsigned char)program.programValue);
         safeSendMessage(prog_msg);
     }
     
     if (program.volumeCC != -1 && program.volumeValue != -1) {
-        std::vector<unsigned char> vol_msg = { 0xB0, (unsigned char)program.volumeCC, (unsigned char)program.volumeValue };
+        const midi::MidiMsg vol_msg = midi::MidiMsg::make(0xB0, (unsigned char)program.volumeCC, (unsigned char)program.volumeValue);
         safeSendMessage(vol_msg);
     }
 
@@ -1380,7 +1763,7 @@ void MidiProcessor::setTrackState(const std::string& trackId, bool newState) {
 void MidiProcessor::sendNoteToggle(int note, int channel, int velocity) {
     if (channel < 1 || channel > 16) return;
     unsigned char chan = channel - 1;
-    std::vector<unsigned char> msg = {(unsigned char)(0x90 | chan), (unsigned char)note, (unsigned char)velocity};
+    midi::MidiMsg msg = midi::MidiMsg::make((unsigned char)(0x90 | chan), (unsigned char)note, (unsigned char)velocity);
     safeSendMessage(msg);
     msg[0] = (0x80 | chan); msg[2] = 0;
     safeSendMessage(msg);
@@ -1390,13 +1773,13 @@ void MidiProcessor::sendChannelAllNotesOff(int zeroBasedChannel) {
     if (zeroBasedChannel < 0 || zeroBasedChannel > 15) return;
     unsigned char chan = (unsigned char)zeroBasedChannel;
     // Sustain Off (CC64 = 0)
-    std::vector<unsigned char> sustainOff = { (unsigned char)(0xB0 | chan), 64, 0 };
+    const midi::MidiMsg sustainOff = midi::MidiMsg::make((unsigned char)(0xB0 | chan), 64, 0);
     safeSendMessage(sustainOff);
     // All Notes Off (CC123 = 0)
-    std::vector<unsigned char> allNotesOff = { (unsigned char)(0xB0 | chan), 123, 0 };
+    const midi::MidiMsg allNotesOff = midi::MidiMsg::make((unsigned char)(0xB0 | chan), 123, 0);
     safeSendMessage(allNotesOff);
     // All Sound Off (CC120 = 0)
-    std::vector<unsigned char> allSoundOff = { (unsigned char)(0xB0 | chan), 120, 0 };
+    const midi::MidiMsg allSoundOff = midi::MidiMsg::make((unsigned char)(0xB0 | chan), 120, 0);
     safeSendMessage(allSoundOff);
 }
 
@@ -1404,14 +1787,14 @@ void MidiProcessor::panicSilence() {
     // Hard kill per note for channels 1 and 2 to be extra safe, then send CC kills
     for (int ch = 0; ch < 2; ++ch) {
         for (int n = 0; n < 128; ++n) {
-            std::vector<unsigned char> offMsg = { (unsigned char)(0x80 | ch), (unsigned char)n, 0 };
+            const midi::MidiMsg offMsg = midi::MidiMsg::make((unsigned char)(0x80 | ch), (unsigned char)n, 0);
             safeSendMessage(offMsg);
         }
         sendChannelAllNotesOff(ch);
     }
 }
 
-void MidiProcessor::updatePitch(const std::vector<unsigned char>& message, bool isGuitar) {
+void MidiProcessor::updatePitch(const midi::MidiMsg& message, bool isGuitar) {
     // Defensive: some devices/routers can emit short MIDI packets (e.g., running status edge cases).
     // We must never crash the app because pitch tracking is "best effort".
     if (message.empty()) return;
@@ -1456,6 +1839,8 @@ void MidiProcessor::updatePitch(const std::vector<unsigned char>& message, bool
         if ((m_lastEmittedGuitarHz < 0 && hz > 0) || (hz <= 0 && m_lastEmittedGuitarHz > 0) ||
             std::fabs(hz - m_lastEmittedGuitarHz) >= hzThreshold) {
             m_lastEmittedGuitarHz = hz;
+            m_continuous.guitarHz = hz;
+            publishContinuous();
             emit guitarHzUpdated(hz);
         }
     } else {
@@ -1463,6 +1848,8 @@ void MidiProcessor::updatePitch(const std::vector<unsigned char>& message, bool
         if ((m_lastEmittedVoiceHz < 0 && hz > 0) || (hz <= 0 && m_lastEmittedVoiceHz > 0) ||
             std::fabs(hz - m_lastEmittedVoiceHz) >= hzThreshold) {
             m_lastEmittedVoiceHz = hz;
+            m_continuous.voiceHz = hz;
+            publishContinuous();
             emit voiceHzUpdated(hz);
         }
     }
@@ -1481,9 +1868,9 @@ void MidiProcessor::processPitchBend() {
 
     if (guitarHz <= 1.0 || voiceHz <= 1.0) {
         if (m_lastCC102Value != 0 || m_lastCC103Value != 0) {
-            std::vector<unsigned char> msg102 = { 0xB0, (unsigned char)BEND_DOWN_CC, 0 };
+            const midi::MidiMsg msg102 = midi::MidiMsg::make(0xB0, (unsigned char)BEND_DOWN_CC, 0);
             safeSendMessage(msg102);
-            std::vector<unsigned char> msg103 = { 0xB0, (unsigned char)BEND_UP_CC, 0 };
+            const midi::MidiMsg msg103 = midi::MidiMsg::make(0xB0, (unsigned char)BEND_UP_CC, 0);
             safeSendMessage(msg103);
             m_lastCC102Value = 0;
             m_lastCC103Value = 0;
@@ -1516,22 +1903,18 @@ void MidiProcessor::processPitchBend() {
     cc103_val = std::min(127, std::max(0, cc103_val));
 
     if (cc102_val != m_lastCC102Value) {
-        std::vector<unsigned char> msg = { 0xB0, (unsigned char)BEND_DOWN_CC, (unsigned char)cc102_val };
+        const midi::MidiMsg msg = midi::MidiMsg::make(0xB0, (unsigned char)BEND_DOWN_CC, (unsigned char)cc102_val);
         safeSendMessage(msg);
         m_lastCC102Value = cc102_val;
     }
     if (cc103_val != m_lastCC103Value) {
-        std::vector<unsigned char> msg = { 0xB0, (unsigned char)BEND_UP_CC, (unsigned char)cc103_val };
+        const midi::MidiMsg msg = midi::MidiMsg::make(0xB0, (unsigned char)BEND_UP_CC, (unsigned char)cc103_val);
         safeSendMessage(msg);
         m_lastCC103Value = cc103_val;
     }
 
-    if (m_isVerbose.load()) {
-        char buffer[100];
-        snprintf(buffer, sizeof(buffer), "Pitch Bend CCs -> Down (102): %d, Up (103): %d", m_lastCC102Value, m_lastCC103Value);
-        std::lock_guard<std::mutex> lock(m_logMutex);
-        m_logQueue.push(std::string(buffer));
-    }
+    midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::Pitch, midi::TraceEvent::PitchBendCcs,
+                                         m_lastCC102Value, m_lastCC103Value);
 }
 
 double MidiProcessor::noteToFrequency(int note) const {
@@ -1556,6 +1939,11 @@ void MidiProcessor::hzToNoteAndCents(double hz, int& noteOut, double& centsOut)
     centsOut = cents;
 }
 
+void MidiProcessor::publishContinuous(int signalCount) {
+    m_continuousCell.store(m_continuous);
+    m_continuousStats.updates.fetch_add(std::uint64_t(signalCount), std::memory_order_relaxed);
+}
+
 void MidiProcessor::emitPitchIfChanged(bool isGuitar) {
     int note;
     double cents;
@@ -1573,12 +1961,18 @@ void MidiProcessor::emitPitchIfChanged(bool isGuitar) {
         if (note != m_lastEmittedGuitarNote || std::fabs(cents - m_lastEmittedGuitarCents) >= centsThreshold) {
             m_lastEmittedGuitarNote = note;
             m_lastEmittedGuitarCents = cents;
+            m_continuous.guitarNote = note;
+            m_continuous.guitarCents = cents;
+            publishContinuous();
             emit guitarPitchUpdated(note, cents);
         }
     } else {
         if (note != m_lastEmittedVoiceNote || std::fabs(cents - m_lastEmittedVoiceCents) >= centsThreshold) {
             m_lastEmittedVoiceNote = note;
             m_lastEmittedVoiceCents = cents;
+            m_continuous.voiceNote = note;
+            m_continuous.voiceCents = cents;
+            publishContinuous();
             emit voicePitchUpdated(note, cents);
         }
     }
@@ -9,11 +9,23 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <queue>
 #include <deque>
+#include <memory>
 #include "RtMidi.h"
 #include "PresetData.h"
+#include "midi/MidiMsg.h"
+#include "midi/SpscRing.h"
+#include "midi/MpscRing.h"
+#include "midi/WorkerWake.h"
+#include "midi/DelayQueue.h"
+#include "midi/TraceLog.h"
+#include "midi/LatencyHistogram.h"
+#include "midi/IGuitarStage.h"
+#include "midi/MidiBackend.h"
+#include "midi/MidiRecorder.h"
+#include "midi/ContinuousState.h"
+#include "virtuoso/engine/IMidiOutputSink.h"
 
 class MidiProcessor : public QObject {
     Q_OBJECT
@@ -22,7 +34,11 @@ public:
     explicit MidiProcessor(const Preset& preset, QObject *parent = nullptr);
     ~MidiProcessor();
 
+    // Opens the preset's ports through RtMidi and starts the worker.
     bool initialize();
+    // Same with another port provider (e.g. midi::MemoryMidiBackend for
+    // replay). The backend must outlive this processor.
+    bool initialize(midi::IMidiBackend& backend);
 
 public slots:
     void applyProgram(int programIndex);
@@ -90,11 +106,59 @@ public slots:
     void sendVirtualCC(int channel, int cc, int value);
     // Virtual musician pitch bend (thread-safe; enqueued to worker thread)
     void sendVirtualPitchBend(int channel, int bendValue);
+    // Virtual musician notes sent `delayNs` after the call (thread-safe).
+    // The worker holds them in a preallocated timer queue and sends each at
+    // its deadline; no per-note timer objects. A scheduled note-off never
+    // goes out before the note-on scheduled ahead of it for the same
+    // channel/note, whatever the two delays were.
+    void scheduleVirtualNoteOn(int channel, int note, int velocity, qint64 delayNs);
+    void scheduleVirtualNoteOff(int channel, int note, qint64 delayNs);
+    // Drops scheduled-but-unsent note-ons on `channel`. Call before
+    // sendVirtualAllNotesOff so a delayed attack can't land after the kill.
+    void cancelScheduledVirtualNotes(int channel);
+    // Inline guitar-note stage (nullptr = none). Any thread; on return the
+    // worker is no longer inside the previous stage, so it may be destroyed.
+    void setGuitarStage(midi::IGuitarStage* stage);
+    // Clears the stage only if it is still `stage` (then waits the same way).
+    void releaseGuitarStage(midi::IGuitarStage* stage);
+    // Runs fn(ctx) on the worker thread and returns after it has run; runs
+    // it in place on the worker itself or when the worker isn't running.
+    // For state the worker owns (the guitar stage's note table) that UI-side
+    // setters have to touch. Callers block for at most one worker pass.
+    void runOnWorker(void (*fn)(void*), void* ctx);
+    // Same virtual-band path as an IMidiOutputSink, for VirtuosoScheduler's realtime dispatch thread.
+    virtuoso::engine::IMidiOutputSink* virtualBandSink() { return &m_virtualBandSink; }
     // VocalSync dedicated output (bypasses main output, goes to separate IAC bus)
     void sendVocalSyncNoteOn(int note, int velocity);
     void sendVocalSyncNoteOff(int note);
     void sendVocalSyncCC(int cc, int value);
     void sendVocalSyncPitchBend(int bendValue); // 14-bit (0-16383, center 8192)
+    // End-to-end latency: input callback -> RtMidi send returned, per output
+    // path (note-ons on ch 1/9/10/12-15, every VocalSync message), plus the
+    // per-stage breakdown of each inbound event. Lock-free; any thread may
+    // read or reset.
+    const midi::LatencyStats& latencyStats() const { return m_latency; }
+    void resetLatencyStats() { m_latency.reset(); }
+    // Writes latencyStats() as JSON next to the log file and logs a one-line
+    // summary per path. Returns the file path, or an empty string on failure.
+    QString dumpLatencyStats();
+    // Capture recorder: logs every message the worker takes in or sends out
+    // to a binary capture (midi/MidiCapture.h), by default
+    // capture-<time>.mcap next to the log file. Returns the file path, or an
+    // empty string on failure. Lock- and allocation-free on the worker.
+    QString startCaptureRecording(const QString& path = QString());
+    void stopCaptureRecording();
+    bool isCaptureRecording() const { return m_recorder.recording(); }
+    // Latest pitch/pressure/breath values (see midi/ContinuousState.h). For
+    // consumers off the worker: poll these on a timer rather than taking the
+    // continuous signals queued. Any thread; each call counts as one poll.
+    midi::ContinuousState continuousState() const {
+        m_continuousStats.polls.fetch_add(1, std::memory_order_relaxed);
+        return m_continuousCell.load();
+    }
+    // Changes whenever continuousState() would return something new.
+    std::uint64_t continuousVersion() const { return m_continuousCell.version(); }
+    const midi::ContinuousStats& continuousStats() const { return m_continuousStats; }
     // Emergency stop for shutdown: sends explicit NOTE_OFF for all notes on all channels,
     // plus CC64/CC123/CC120. This is intended for app quit / teardown.
     void panicAllChannels();
@@ -142,29 +206,144 @@ signals:
     void harmonyDirectChordRequested(const QString& chordText);
 
 private:
-    enum class EventType { MIDI_MESSAGE, PROGRAM_CHANGE, TRACK_TOGGLE, TRANSPOSE_CHANGE };
+    // Test-only access to the worker-side entry points (midi/tests, bench).
+    friend struct MidiProcessorTestAccess;
+    friend struct MidiProcessorBenchAccess;
+
+    enum class EventType { MIDI_MESSAGE, PROGRAM_CHANGE, TRACK_TOGGLE, TRANSPOSE_CHANGE,
+                           SCHEDULED_MESSAGE, SCHEDULED_CANCEL };
     enum class MidiSource { Guitar, VoiceAmp, VoicePitch, VirtualBand, Ampero };
     struct MidiEvent {
         EventType type;
-        std::vector<unsigned char> message;
+        midi::MidiMsg message;
         MidiSource source;
         int programIndex; // For PROGRAM_CHANGE/PLAY_TRACK this is index; for TRANSPOSE_CHANGE this is semitone amount
         std::string trackId;
+        std::int64_t dueNs = 0; // SCHEDULED_MESSAGE only (overflow of m_scheduledRing)
+        midi::LatencyStamps stamps; // live inputs only (processLiveEvent)
     };
     bool tryEnqueueEvent(MidiEvent&& ev);
     static bool isCriticalMidiEvent(const MidiEvent& ev);
+    static bool isCriticalMessage(const unsigned char* m, size_t n);
+
+    class VirtualBandSink final : public virtuoso::engine::IMidiOutputSink {
+    public:
+        explicit VirtualBandSink(MidiProcessor* p) : m_p(p) {}
+        void sendNoteOn(int channel, int note, int velocity) override { m_p->sendVirtualNoteOn(channel, note, velocity); }
+        void sendNoteOff(int channel, int note) override { m_p->sendVirtualNoteOff(channel, note); }
+        void sendAllNotesOff(int channel) override { m_p->sendVirtualAllNotesOff(channel); }
+        void sendCC(int channel, int cc, int value) override { m_p->sendVirtualCC(channel, cc, value); }
+    private:
+        MidiProcessor* m_p;
+    };
+    VirtualBandSink m_virtualBandSink{this};
 
     // --- Threading & Queues ---
+    // MIDI messages travel callback -> worker through one wait-free SPSC ring
+    // per RtMidi input (each input has exactly one callback thread) plus one
+    // MPSC ring for the sendVirtual* family. Control events (program change,
+    // transpose, track toggle) and critical messages that overflow a full
+    // ring go through the mutex-guarded m_eventQueue; that path is cold.
+    static constexpr size_t kInputRingCapacity = 4096;
+    static constexpr size_t kVirtualRingCapacity = 8192;
+    midi::SpscRing<midi::MidiMsg, kInputRingCapacity> m_guitarRing;
+    midi::SpscRing<midi::MidiMsg, kInputRingCapacity> m_voiceAmpRing;
+    midi::SpscRing<midi::MidiMsg, kInputRingCapacity> m_voicePitchRing;
+    midi::SpscRing<midi::MidiMsg, kInputRingCapacity> m_amperoRing;
+    midi::MpscRing<midi::MidiMsg, kVirtualRingCapacity> m_virtualRing;
+    midi::WorkerWake m_wake;
+
+    // Timed virtual notes (scheduleVirtual*): producers -> worker through
+    // m_scheduledRing, then held in m_delayQueue (worker-only) until due.
+    static constexpr size_t kScheduledRingCapacity = 1024;
+    static constexpr size_t kDelayQueueCapacity = 1024;
+    midi::MpscRing<midi::ScheduledMidiMsg, kScheduledRingCapacity> m_scheduledRing;
+    midi::DelayQueue<kDelayQueueCapacity> m_delayQueue;
+
+    // Inline stage. m_stageBusy brackets each call so setGuitarStage() can
+    // wait out a call into the stage it is replacing.
+    std::atomic<midi::IGuitarStage*> m_guitarStage{nullptr};
+    std::atomic<bool> m_stageBusy{false};
+    // Stage's nextTickDeadlineNs() as of the last pass (worker-only).
+    std::int64_t m_stageTickDueNs = midi::IGuitarStage::kNoTickDeadline;
+    void tickGuitarStage();
+    // runOnWorker() handoff: one caller at a time parks its call here.
+    struct WorkerCall {
+        void (*fn)(void*);
+        void* ctx;
+        std::atomic<bool> done{false};
+    };
+    std::mutex m_workerCallMutex;
+    std::atomic<WorkerCall*> m_workerCall{nullptr};
+    void serviceWorkerCall();
+    // Virtual sends made on the worker itself (from the stage or a
+    // direct-connected slot) skip the rings. Earlier-queued virtual
+    // messages are flushed first so per-note order is kept.
+    std::atomic<std::thread::id> m_workerThreadId{};
+    bool onWorkerThread() const;
+    void flushVirtualBacklog();
+    MidiEvent m_inlineScratch{EventType::MIDI_MESSAGE, {}, MidiSource::VirtualBand, -1, ""};
+
     std::thread m_workerThread;
-    std::deque<MidiEvent> m_eventQueue; // bounded (see tryEnqueueEvent)
+    std::deque<MidiEvent> m_eventQueue; // control + overflow lane, bounded (see tryEnqueueEvent)
     std::mutex m_eventMutex;
-    std::condition_variable m_condition;
+    bool m_eventQueueHasOverflow = false; // a diverted ring message is queued (m_eventMutex)
+    std::deque<MidiEvent> m_controlBatch; // worker-only: the lane taken this pass
+    std::atomic<bool> m_controlQueued{false}; // set after pushing into m_eventQueue
     std::atomic<bool> m_isRunning{false};
 
     // Backpressure: prevent unbounded growth when VirtualBand + live MIDI arrive together.
     static constexpr size_t kMaxEventQueue = 16384;
+    // Upper bound on messages taken from one ring per worker pass, so a
+    // flooded source cannot starve the others. Lifted for a pass that
+    // carries a ring overflow (see runWorkerPass).
+    static constexpr int kRingDrainBatch = 64;
     std::atomic<quint64> m_droppedMidiEvents{0};
 
+    // Producer helpers: push into a ring; on overflow, divert critical
+    // messages into the locked lane and drop (and count) the rest.
+    template <typename Ring>
+    void enqueueInbound(Ring& ring, MidiSource source, const midi::MidiMsg& msg);
+    void enqueueVirtual(unsigned char status, unsigned char d1, unsigned char d2);
+    void enqueueControl(MidiEvent&& ev);
+    void noteDroppedMidiEvent();
+    bool hasPendingInput() const;
+    template <typename Ring>
+    int drainRing(Ring& ring, MidiSource source, MidiEvent& scratch, int limit = kRingDrainBatch);
+    // Takes the control lane into m_controlBatch; true when it carries a
+    // ring overflow. processControlBatch() then handles what was taken.
+    bool takeControlQueue();
+    int processControlBatch();
+    // One worker pass over the out-of-band signals and every lane.
+    int runWorkerPass(MidiEvent& scratch);
+    void enqueueScheduled(const midi::ScheduledMidiMsg& s);
+    // Worker side: queue (or apply a cancel), then send everything due.
+    void acceptScheduled(const midi::ScheduledMidiMsg& s, MidiEvent& scratch);
+    int drainScheduled(MidiEvent& scratch, int limit = kRingDrainBatch);
+    void sendVirtualNow(const midi::MidiMsg& msg, MidiEvent& scratch);
+
+    // Latency instrumentation. m_liveEvent is the inbound event being
+    // processed (worker-only, null otherwise): sends made on its behalf,
+    // including ScaleSnap's lead and harmony, take its arrival time as
+    // their origin.
+    midi::LatencyStats m_latency;
+    MidiEvent* m_liveEvent = nullptr;
+    midi::MidiRecorder m_recorder; // worker is the only producer
+
+    // Continuous values: m_continuous is the worker's copy, published whole
+    // to m_continuousCell on every change (publishContinuous()).
+    midi::ContinuousState m_continuous;
+    midi::Seqlock<midi::ContinuousState> m_continuousCell;
+    mutable midi::ContinuousStats m_continuousStats;
+    quint64 m_reportedRateUpdates = 0;
+    quint64 m_reportedRatePolls = 0;
+    quint64 m_reportedRateDiscrete = 0;
+    qint64 m_rateReportStartMs = 0;
+    void publishContinuous(int signalCount = 1);
+    static midi::CapturePort capturePortFor(MidiSource source);
+    void processLiveEvent(MidiEvent& ev);
+    std::int64_t liveArrivalNs() const;
+
     // Suppress guitar passthrough: when true, guitar notes/CC are NOT passed through to channel 1.
     // ScaleSnapProcessor sets this when Lead mode is active so it can output processed notes instead.
     std::atomic<bool> m_suppressGuitarPassthrough{false};
@@ -216,6 +395,7 @@ private:
 
     QTimer* m_logPollTimer;
     std::queue<std::string> m_logQueue;
+    quint64 m_reportedTraceDrops = 0; // TraceLog::dropped() last reported by pollLogQueue()
     std::mutex m_logMutex;
 
     // File log: every console message also goes to
@@ -231,24 +411,25 @@ private:
     void sendNoteToggle(int note, int channel, int velocity);
     void panicSilence();
     void sendChannelAllNotesOff(int zeroBasedChannel);
-    void updatePitch(const std::vector<unsigned char>& message, bool isGuitar);
+    void updatePitch(const midi::MidiMsg& message, bool isGuitar);
     void processPitchBend();
     double noteToFrequency(int note) const;
     void precalculateRatios();
     void emitPitchIfChanged(bool isGuitar);
     void hzToNoteAndCents(double hz, int& noteOut, double& centsOut) const;
     // Defensive MIDI output: never crash due to RtMidi exceptions or null output.
-    void safeSendMessage(const std::vector<unsigned char>& msg);
+    void safeSendMessage(const midi::MidiMsg& msg);
     // VocalSync-dedicated output: sends on a separate IAC bus to avoid flooding the AU plugin
-    void safeSendVocalSync(const std::vector<unsigned char>& msg);
+    void safeSendVocalSync(const midi::MidiMsg& msg);
 
     // --- MIDI Ports ---
-    RtMidiIn* midiInGuitar = nullptr;
-    RtMidiOut* midiOut = nullptr;
-    RtMidiOut* midiOutVocalSync = nullptr;  // Dedicated output for VocalSync AU plugin
-    RtMidiIn* midiInVoice = nullptr;       // Voice amplitude (aftertouch) source
-    RtMidiIn* midiInVoicePitch = nullptr;  // Voice accurate pitch/note source
-    RtMidiIn* midiInAmpero = nullptr;      // Ampero Control USB (footswitch CCs)
+    std::unique_ptr<midi::IMidiBackend> m_ownedBackend; // initialize() without a backend: RtMidi
+    std::unique_ptr<midi::IMidiInputPort> midiInGuitar;
+    std::unique_ptr<midi::IMidiOutputPort> midiOut;
+    std::unique_ptr<midi::IMidiOutputPort> midiOutVocalSync; // Dedicated output for VocalSync AU plugin
+    std::unique_ptr<midi::IMidiInputPort> midiInVoice;       // Voice amplitude (aftertouch) source
+    std::unique_ptr<midi::IMidiInputPort> midiInVoicePitch;  // Voice accurate pitch/note source
+    std::unique_ptr<midi::IMidiInputPort> midiInAmpero;      // Ampero Control USB (footswitch CCs)
     bool m_voicePitchAvailable = false;
     bool m_amperoAvailable = false;
 
@@ -260,7 +441,6 @@ private:
     int m_currentProgramIndex;
     bool m_inCommandMode = false;
 
-    std::atomic<bool> m_isVerbose{false};
     std::atomic<bool> m_voiceControlEnabled{true};
     std::atomic<int> m_transposeAmount{0};
 
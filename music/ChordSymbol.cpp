@@ -108,6 +108,18 @@ static void decideSeventh(const QString& sRaw, int ext, ChordSymbol& out) {
 
 } // namespace
 
+bool sameChordSymbol(const ChordSymbol& a, const ChordSymbol& b) {
+    if (a.originalText != b.originalText || a.placeholder != b.placeholder || a.noChord != b.noChord) return false;
+    if (a.rootPc != b.rootPc || a.bassPc != b.bassPc || a.quality != b.quality || a.seventh != b.seventh) return false;
+    if (a.extension != b.extension || a.alt != b.alt || a.alterations.size() != b.alterations.size()) return false;
+    for (int i = 0; i < a.alterations.size(); ++i) {
+        const Alteration& x = a.alterations[i];
+        const Alteration& y = b.alterations[i];
+        if (x.degree != y.degree || x.delta != y.delta || x.add != y.add) return false;
+    }
+    return true;
+}
+
 QString normalizeChordText(QString chordText) {
     QString s = chordText.trimmed();
     if (s.isEmpty()) return s;
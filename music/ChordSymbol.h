@@ -54,6 +54,10 @@ struct ChordSymbol {
     QVector<Alteration> alterations;
 };
 
+// Field-for-field equality (text, flags, root/bass, quality, seventh, extension,
+// alterations in order), for comparing stored planner/cache state.
+bool sameChordSymbol(const ChordSymbol& a, const ChordSymbol& b);
+
 // Normalizes a chord string into a parser-friendly ASCII-ish form.
 // - Converts ♭/♯ → b/#, Δ → "maj", en-dash minor marker → "m"
 // - Keeps ø/° (half-diminished/diminished) for parsing
@@ -447,7 +447,7 @@ void AgentCoordinator::scheduleStep(const Inputs& in, int stepIndex) {
     }
 
     // Determinism seed.
-    const quint32 detSeed = virtuoso::util::StableHash::fnv1a32((QString("ballad|") + in.stylePresetKey).toUtf8());
+    const quint32 detSeed = virtuoso::util::StableHash::Builder().ascii("ballad|").utf8(in.stylePresetKey).value();
 
     // --- Persistent 4–8 bar story state (motif + register arcs) ---
     // This drives intentional register motion over the phrase horizon, while the joint selector
@@ -461,11 +461,11 @@ void AgentCoordinator::scheduleStep(const Inputs& in, int stepIndex) {
             in.story->phraseStartBar = phraseStartBar;
             in.story->phraseBars = look.phraseBars;
 
-            const quint32 sh = virtuoso::util::StableHash::fnv1a32(QString("story|%1|%2|%3")
-                                                                       .arg(in.stylePresetKey)
-                                                                       .arg(in.story->phraseStartBar)
-                                                                       .arg(detSeed)
-                                                                       .toUtf8());
+            const quint32 sh = virtuoso::util::StableHash::ArgFormat("story|%1|%2|%3")
+                                   .arg(in.stylePresetKey)
+                                   .arg(in.story->phraseStartBar)
+                                   .arg(detSeed)
+                                   .value();
             int dir = ((sh & 1u) != 0u) ? 1 : -1;
             if (vibeEff.vibe == VibeStateMachine::Vibe::Build) dir = 1;
             if (vibeEff.vibe == VibeStateMachine::Vibe::Climax) dir = 1;
@@ -1116,6 +1116,9 @@ void AgentCoordinator::scheduleStep(const Inputs& in, int stepIndex) {
             si.lastPianoGestureId = in.story->lastPianoGestureId;
         }
 
+        // The full combo list is only needed for the candidate_pool JSON below.
+        si.explainAllCombos = in.debugVerbose;
+
         const bool havePlanned = (!plannedBassId.isEmpty() || !plannedPianoId.isEmpty() || !plannedDrumsId.isEmpty());
         const auto best = JointCandidateModel::chooseBestCombo(si, bCands, pCands, dCands,
                                                                havePlanned ? plannedBassId : QString(),
@@ -96,7 +96,7 @@ ActiveChord ChordOntology::createActiveChord(
     }
 
     // Build scale tones set - relative to KEY root (not chord root!)
-    std::set<int> scaleTones;
+    PitchClassSet scaleTones;
     if (scaleDef) {
         int keyRoot = normalizePc(keyRootPc);
         for (int interval : scaleDef->intervals) {
@@ -144,7 +144,7 @@ ActiveChord ChordOntology::createActiveChord(
     }
 
     // Build scale tones set by unioning ALL compatible scales (from chord root)
-    std::set<int> allScaleTones;
+    PitchClassSet allScaleTones;
     for (const auto* scaleDef : scaleDefs) {
         if (!scaleDef) continue;
         // Store first scale key for reference
@@ -178,12 +178,12 @@ ActiveChord ChordOntology::createActiveChord(
 // Compute Tensions
 // ============================================================================
 
-std::set<int> ChordOntology::computeTensions(
+PitchClassSet ChordOntology::computeTensions(
     int rootPc,
-    const std::set<int>& chordTones,
-    const std::set<int>& scaleTones
+    const PitchClassSet& chordTones,
+    const PitchClassSet& scaleTones
 ) const {
-    std::set<int> tensions;
+    PitchClassSet tensions;
 
     // Standard tension intervals from root (as pitch classes)
     // 9th = 2 semitones (or 14 mod 12)
@@ -231,12 +231,12 @@ std::set<int> ChordOntology::computeTensions(
 // Compute Avoid Notes
 // ============================================================================
 
-std::set<int> ChordOntology::computeAvoidNotes(
+PitchClassSet ChordOntology::computeAvoidNotes(
     int rootPc,
-    const std::set<int>& chordTones,
-    const std::set<int>& scaleTones
+    const PitchClassSet& chordTones,
+    const PitchClassSet& scaleTones
 ) const {
-    std::set<int> avoidNotes;
+    PitchClassSet avoidNotes;
 
     // MUSIC THEORY RULES FOR AVOID NOTES:
     //
@@ -305,9 +305,9 @@ std::set<int> ChordOntology::computeAvoidNotes(
 int ChordOntology::getTier(int pitchClass, const ActiveChord& chord) const {
     int pc = normalizePc(pitchClass);
 
-    if (chord.tier1Absolute.count(pc)) return 1;  // Chord tone
-    if (chord.tier2Absolute.count(pc)) return 2;  // Tension
-    if (chord.tier3Absolute.count(pc)) return 3;  // Scale tone
+    if (chord.tier1Absolute.contains(pc)) return 1;  // Chord tone
+    if (chord.tier2Absolute.contains(pc)) return 2;  // Tension
+    if (chord.tier3Absolute.contains(pc)) return 3;  // Scale tone
     return 4;  // Chromatic
 }
 
@@ -341,6 +341,31 @@ int ChordOntology::signedDistance(int from, int to) {
     return diff;
 }
 
+int ChordOntology::nearestPc(int pitchClass, PitchClassSet targets) {
+    // [mask][pc] -> nearest member of mask, first (lowest) pc winning ties,
+    // exactly as the linear scan over an ascending std::set did.
+    static const std::array<qint8, 4096 * 12> table = [] {
+        std::array<qint8, 4096 * 12> t{};
+        for (int mask = 0; mask < 4096; ++mask) {
+            for (int pc = 0; pc < 12; ++pc) {
+                int best = -1;
+                int bestDist = 7;
+                for (int target = 0; target < 12; ++target) {
+                    if (!((mask >> target) & 1)) continue;
+                    const int dist = minDistance(pc, target);
+                    if (dist < bestDist) {
+                        bestDist = dist;
+                        best = target;
+                    }
+                }
+                t[size_t(mask * 12 + pc)] = qint8(best);
+            }
+        }
+        return t;
+    }();
+    return table[size_t(targets.mask() * 12 + normalizePc(pitchClass))];
+}
+
 int ChordOntology::findNearestInOctave(int referenceMidi, int targetPc) {
     targetPc = normalizePc(targetPc);
 
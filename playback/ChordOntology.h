@@ -2,7 +2,6 @@
 
 #include "HarmonyTypes.h"
 #include "virtuoso/ontology/OntologyRegistry.h"
-#include <set>
 #include <map>
 #include <array>
 #include <QString>
@@ -23,22 +22,27 @@ struct ActiveChord {
     QString ontologyChordKey;       // Key into OntologyRegistry (e.g., "maj7", "min7")
     QString ontologyScaleKey;       // Key into OntologyRegistry (e.g., "ionian", "dorian")
 
-    // Precomputed pitch class sets (absolute, transposed from root)
-    std::set<int> tier1Absolute;    // Chord tones (from OntologyRegistry chord intervals)
-    std::set<int> tier2Absolute;    // Tensions (9th, 11th, 13th not in chord)
-    std::set<int> tier3Absolute;    // Scale tones (from scale, excluding T1 & T2)
-    std::set<int> avoidAbsolute;    // Avoid notes (subset of T3 that clash)
+    // Precomputed pitch class sets (absolute, transposed from root).
+    // 12-bit masks; PitchClassSet keeps the std::set-style count/insert/
+    // iteration these used to be accessed with.
+    PitchClassSet tier1Absolute;    // Chord tones (from OntologyRegistry chord intervals)
+    PitchClassSet tier2Absolute;    // Tensions (9th, 11th, 13th not in chord)
+    PitchClassSet tier3Absolute;    // Scale tones (from scale, excluding T1 & T2)
+    PitchClassSet avoidAbsolute;    // Avoid notes (subset of T3 that clash)
 
     // Check if a pitch class is an avoid note
     bool isAvoidNote(int pitchClass) const {
-        return avoidAbsolute.count(pitchClass) > 0;
+        return avoidAbsolute.contains(pitchClass);
     }
 
     // Check if pitch class is in any valid tier (T1, T2, or T3)
     bool isValidScaleTone(int pitchClass) const {
-        return tier1Absolute.count(pitchClass) ||
-               tier2Absolute.count(pitchClass) ||
-               tier3Absolute.count(pitchClass);
+        return validMask().contains(pitchClass);
+    }
+
+    // T1 | T2 | T3
+    PitchClassSet validMask() const {
+        return PitchClassSet::fromMask(quint16(tier1Absolute.mask() | tier2Absolute.mask() | tier3Absolute.mask()));
     }
 };
 
@@ -106,6 +110,11 @@ public:
     // Get signed distance on pitch class circle (-6 to +6, prefers smaller absolute)
     static int signedDistance(int from, int to);
 
+    // Nearest pitch class in `targets` to `pitchClass` on the pc circle
+    // (ties go to the lower pc), or -1 if `targets` is empty. One load from
+    // a 4096x12 table built on first use.
+    static int nearestPc(int pitchClass, PitchClassSet targets);
+
     // Find MIDI note with target pitch class, nearest to reference
     static int findNearestInOctave(int referenceMidi, int targetPc);
 
@@ -121,17 +130,17 @@ private:
     // Determine avoid notes based on chord structure
     // Rule: If chord has major 3rd (interval 4), the natural 4th (interval 5)
     // is an avoid note because it creates a minor 2nd clash
-    std::set<int> computeAvoidNotes(
+    PitchClassSet computeAvoidNotes(
         int rootPc,
-        const std::set<int>& chordTones,
-        const std::set<int>& scaleTones
+        const PitchClassSet& chordTones,
+        const PitchClassSet& scaleTones
     ) const;
 
     // Determine tensions (9th, 11th, 13th that aren't chord tones)
-    std::set<int> computeTensions(
+    PitchClassSet computeTensions(
         int rootPc,
-        const std::set<int>& chordTones,
-        const std::set<int>& scaleTones
+        const PitchClassSet& chordTones,
+        const PitchClassSet& scaleTones
     ) const;
 
     const virtuoso::ontology::OntologyRegistry* m_ontology = nullptr;
@@ -3,168 +3,306 @@
 #include <QElapsedTimer>
 #include <QDebug>
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
 #include "virtuoso/theory/ScaleSuggester.h"
+#include "virtuoso/util/RegistryBundle.h"
 
 namespace playback {
 
 // Static members
-QHash<QString, ChordScaleEntry> ChordScaleTable::s_table;
-bool ChordScaleTable::s_initialized = false;
-int ChordScaleTable::s_hits = 0;
-int ChordScaleTable::s_misses = 0;
+std::atomic<const ChordScaleTable::Table*> ChordScaleTable::s_table{nullptr};
+
+namespace {
+
+// Serializes initializers; lookups never take it. std::mutex rather than QMutex so
+// ThreadSanitizer sees the happens-before (it does not model QMutex's futex fast path).
+std::mutex s_initMutex;
+
+// Hit/miss counters, one slot per thread so concurrent lookups never write a shared cache
+// line. A thread's slot is registered on its first lookup; readers merge the live slots with
+// what exited threads left behind.
+struct alignas(64) StatsSlot {
+    std::atomic<int> hits{0};
+    std::atomic<int> misses{0};
+};
+
+struct StatsRegistry {
+    std::mutex mutex;
+    QVector<StatsSlot*> live;
+    int retiredHits = 0;
+    int retiredMisses = 0;
+};
+
+StatsRegistry& statsRegistry() {
+    static StatsRegistry registry;
+    return registry;
+}
+
+struct ThreadStats {
+    StatsSlot slot;
+    ThreadStats() {
+        StatsRegistry& r = statsRegistry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(&slot);
+    }
+    ~ThreadStats() {
+        StatsRegistry& r = statsRegistry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.retiredHits += slot.hits.load(std::memory_order_relaxed);
+        r.retiredMisses += slot.misses.load(std::memory_order_relaxed);
+        r.live.removeOne(&slot);
+    }
+};
 
-QString ChordScaleTable::makeKey(const QString& chordDefKey, int interval, virtuoso::theory::KeyMode mode) {
+StatsSlot& threadStats() {
+    thread_local ThreadStats stats;
+    return stats.slot;
+}
+
+} // namespace
+
+int ChordScaleTable::slot(int chordId, int interval, virtuoso::theory::KeyMode mode) {
     // Normalize interval to 0-11
     int norm = interval % 12;
     if (norm < 0) norm += 12;
-    return QString("%1:%2:%3").arg(chordDefKey).arg(norm).arg(static_cast<int>(mode));
+    return chordId * kSlotsPerChord + norm * 2 + (static_cast<int>(mode) != 0 ? 1 : 0);
+}
+
+int ChordScaleTable::Table::chordIdOf(QStringView chordDefKey) const {
+    // chordKeys is in id order, which is key order.
+    const auto it = std::lower_bound(chordKeys.cbegin(), chordKeys.cend(), chordDefKey,
+                                     [](const QString& k, QStringView key) { return QStringView(k).compare(key) < 0; });
+    if (it == chordKeys.cend() || QStringView(*it).compare(chordDefKey) != 0) return -1;
+    return int(it - chordKeys.cbegin());
+}
+
+template <typename Build>
+bool ChordScaleTable::initializeOnce(const Build& build) {
+    if (isInitialized()) return true;
+    std::lock_guard<std::mutex> lock(s_initMutex);
+    // Another thread may have published while this one waited.
+    if (isInitialized()) return true;
+    std::unique_ptr<Table> table = build();
+    if (!table) return false;
+    // Before publishing: lookups that see the table must not have their counts wiped.
+    resetStats();
+    // Never freed: lookups hand out entry pointers for the rest of the process.
+    s_table.store(table.release(), std::memory_order_release);
+    return true;
 }
 
 void ChordScaleTable::initialize(const virtuoso::ontology::OntologyRegistry& ontology) {
-    if (s_initialized) return;
-    
-    QElapsedTimer timer;
-    timer.start();
-    
-    s_table.clear();
-    
-    const auto allChords = ontology.allChords();
-    const auto allScales = ontology.allScales();
-    
-    if (allChords.isEmpty() || allScales.isEmpty()) {
-        qWarning() << "ChordScaleTable: Empty ontology, skipping initialization";
-        return;
-    }
-    
-    // For each chord type × each interval (0-11) × each mode (Major/Minor)
-    // compute the best scale choice
-    
-    for (const auto* chordDef : allChords) {
-        if (!chordDef) continue;
-        
-        for (int interval = 0; interval < 12; ++interval) {
-            for (int modeInt = 0; modeInt <= 1; ++modeInt) {
-                const auto mode = static_cast<virtuoso::theory::KeyMode>(modeInt);
-                
-                // Compute pitch classes for this chord at this interval
-                // (as if the key tonic is at PC 0, and chord root is at `interval`)
-                QSet<int> pcs;
-                for (int iv : chordDef->intervals) {
-                    pcs.insert((interval + iv) % 12);
-                }
-                
-                // Get scale suggestions
-                const auto suggestions = virtuoso::theory::suggestScalesForPitchClasses(ontology, pcs, 12);
-                if (suggestions.isEmpty()) continue;
-                
-                // Analyze function (key tonic = 0, chord root = interval)
-                const auto harmony = virtuoso::theory::analyzeChordInKey(0, mode, interval, *chordDef);
-                
-                // Rank scales by function-appropriate bonuses
-                struct Ranked { virtuoso::theory::ScaleSuggestion s; double score; };
-                QVector<Ranked> ranked;
-                ranked.reserve(suggestions.size());
-                
-                for (const auto& s : suggestions) {
-                    double bonus = 0.0;
-                    
-                    // Prefer scales rooted on the chord root
-                    if ((s.bestTranspose % 12) == interval) bonus += 0.6;
-                    
-                    const QString name = s.name.toLower();
-                    
-                    // Function-specific bonuses (music theory rules)
-                    if (harmony.function == "Dominant") {
-                        // V7 chords: prefer Mixolydian, Altered, Lydian Dominant
-                        if (name.contains("altered")) bonus += 0.45;
-                        else if (name.contains("lydian dominant")) bonus += 0.40;
-                        else if (name.contains("mixolydian")) bonus += 0.35;
-                        else if (name.contains("half-whole") || name.contains("diminished")) bonus += 0.30;
-                        else if (name.contains("phrygian dominant")) bonus += 0.25;
-                    } else if (harmony.function == "Subdominant") {
-                        // ii, IV chords: prefer Dorian, Lydian
-                        if (name.contains("dorian")) bonus += 0.40;
-                        else if (name.contains("lydian")) bonus += 0.35;
-                        else if (name.contains("phrygian")) bonus += 0.20;
-                    } else if (harmony.function == "Tonic") {
-                        // I, vi chords: prefer Ionian, Aeolian, Lydian
-                        if (name.contains("ionian") || name.contains("major")) bonus += 0.40;
-                        else if (name.contains("aeolian") || name.contains("natural minor")) bonus += 0.35;
-                        else if (name.contains("lydian")) bonus += 0.30;
-                    }
-                    
-                    // Special cases for common jazz chords
-                    const QString chordKey = chordDef->key.toLower();
-                    if (chordKey.contains("halfdim") || chordKey.contains("min7b5")) {
-                        // Half-diminished: Locrian ♮2 is preferred
-                        if (name.contains("locrian") && name.contains("2")) bonus += 0.50;
-                        else if (name.contains("locrian")) bonus += 0.30;
+    initializeOnce([&ontology]() -> std::unique_ptr<Table> {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (ontology.chordCount() == 0 || ontology.scaleCount() == 0) {
+            qWarning() << "ChordScaleTable: Empty ontology, skipping initialization";
+            return nullptr;
+        }
+
+        auto table = std::make_unique<Table>();
+        QVector<QString>& chordKeys = table->chordKeys;
+        QVector<ChordScaleEntry>& entries = table->entries;
+        entries.resize(ontology.chordCount() * kSlotsPerChord);
+        int& entryCount = table->entryCount;
+        chordKeys.reserve(ontology.chordCount());
+
+        // For each chord type × each interval (0-11) × each mode (Major/Minor)
+        // compute the best scale choice
+
+        for (int chordId = 0; chordId < ontology.chordCount(); ++chordId) {
+            const auto* chordDef = ontology.chordById(chordId);
+            chordKeys.push_back(chordDef->key);
+
+            for (int interval = 0; interval < 12; ++interval) {
+                for (int modeInt = 0; modeInt <= 1; ++modeInt) {
+                    const auto mode = static_cast<virtuoso::theory::KeyMode>(modeInt);
+
+                    // Compute pitch classes for this chord at this interval
+                    // (as if the key tonic is at PC 0, and chord root is at `interval`)
+                    QSet<int> pcs;
+                    for (int iv : chordDef->intervals) {
+                        pcs.insert((interval + iv) % 12);
                     }
-                    if (chordKey.contains("dim7")) {
-                        // Fully diminished: whole-half diminished
-                        if (name.contains("whole-half") || name.contains("diminished")) bonus += 0.50;
+
+                    // Get scale suggestions
+                    const auto suggestions = virtuoso::theory::suggestScalesForPitchClasses(ontology, pcs, 12);
+                    if (suggestions.isEmpty()) continue;
+
+                    // Analyze function (key tonic = 0, chord root = interval)
+                    const auto harmony = virtuoso::theory::analyzeChordInKey(0, mode, interval, *chordDef);
+
+                    // Rank scales by function-appropriate bonuses
+                    struct Ranked { virtuoso::theory::ScaleSuggestion s; double score; };
+                    QVector<Ranked> ranked;
+                    ranked.reserve(suggestions.size());
+
+                    for (const auto& s : suggestions) {
+                        double bonus = 0.0;
+
+                        // Prefer scales rooted on the chord root
+                        if ((s.bestTranspose % 12) == interval) bonus += 0.6;
+
+                        const QString name = s.name.toLower();
+
+                        // Function-specific bonuses (music theory rules)
+                        if (harmony.function == "Dominant") {
+                            // V7 chords: prefer Mixolydian, Altered, Lydian Dominant
+                            if (name.contains("altered")) bonus += 0.45;
+                            else if (name.contains("lydian dominant")) bonus += 0.40;
+                            else if (name.contains("mixolydian")) bonus += 0.35;
+                            else if (name.contains("half-whole") || name.contains("diminished")) bonus += 0.30;
+                            else if (name.contains("phrygian dominant")) bonus += 0.25;
+                        } else if (harmony.function == "Subdominant") {
+                            // ii, IV chords: prefer Dorian, Lydian
+                            if (name.contains("dorian")) bonus += 0.40;
+                            else if (name.contains("lydian")) bonus += 0.35;
+                            else if (name.contains("phrygian")) bonus += 0.20;
+                        } else if (harmony.function == "Tonic") {
+                            // I, vi chords: prefer Ionian, Aeolian, Lydian
+                            if (name.contains("ionian") || name.contains("major")) bonus += 0.40;
+                            else if (name.contains("aeolian") || name.contains("natural minor")) bonus += 0.35;
+                            else if (name.contains("lydian")) bonus += 0.30;
+                        }
+
+                        // Special cases for common jazz chords
+                        const QString chordKey = chordDef->key.toLower();
+                        if (chordKey.contains("halfdim") || chordKey.contains("min7b5")) {
+                            // Half-diminished: Locrian ♮2 is preferred
+                            if (name.contains("locrian") && name.contains("2")) bonus += 0.50;
+                            else if (name.contains("locrian")) bonus += 0.30;
+                        }
+                        if (chordKey.contains("dim7")) {
+                            // Fully diminished: whole-half diminished
+                            if (name.contains("whole-half") || name.contains("diminished")) bonus += 0.50;
+                        }
+                        if (chordKey.contains("aug") || chordKey.contains("+")) {
+                            // Augmented: whole tone or Lydian augmented
+                            if (name.contains("whole tone")) bonus += 0.50;
+                            else if (name.contains("lydian augmented")) bonus += 0.45;
+                        }
+
+                        ranked.push_back({s, s.score + bonus});
                     }
-                    if (chordKey.contains("aug") || chordKey.contains("+")) {
-                        // Augmented: whole tone or Lydian augmented
-                        if (name.contains("whole tone")) bonus += 0.50;
-                        else if (name.contains("lydian augmented")) bonus += 0.45;
+
+                    // Sort by score descending
+                    std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+                        if (qAbs(a.score - b.score) > 0.001) return a.score > b.score;
+                        return a.s.name < b.s.name;
+                    });
+
+                    // Store the best choice
+                    if (!ranked.isEmpty()) {
+                        const auto& best = ranked.first().s;
+                        ChordScaleEntry entry;
+                        entry.scaleKey = best.key;
+                        entry.scaleName = best.name;
+                        entry.function = harmony.function;
+                        entry.roman = harmony.roman;
+
+                        entries[slot(chordId, interval, mode)] = entry;
+                        ++entryCount;
                     }
-                    
-                    ranked.push_back({s, s.score + bonus});
-                }
-                
-                // Sort by score descending
-                std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
-                    if (qAbs(a.score - b.score) > 0.001) return a.score > b.score;
-                    return a.s.name < b.s.name;
-                });
-                
-                // Store the best choice
-                if (!ranked.isEmpty()) {
-                    const auto& best = ranked.first().s;
-                    ChordScaleEntry entry;
-                    entry.scaleKey = best.key;
-                    entry.scaleName = best.name;
-                    entry.function = harmony.function;
-                    entry.roman = harmony.roman;
-                    
-                    const QString key = makeKey(chordDef->key, interval, mode);
-                    s_table.insert(key, entry);
                 }
             }
         }
-    }
-    
-    s_initialized = true;
-    s_hits = 0;
-    s_misses = 0;
-    
-    qInfo().noquote() << QString("ChordScaleTable: Initialized with %1 entries in %2ms")
-                             .arg(s_table.size())
-                             .arg(timer.elapsed());
+
+        qInfo().noquote() << QString("ChordScaleTable: Initialized with %1 entries in %2ms")
+                                 .arg(entryCount)
+                                 .arg(timer.elapsed());
+        return table;
+    });
+}
+
+void ChordScaleTable::writeBundle(virtuoso::util::BundleWriter& w) {
+    // Field order of the bundle's chord-scale section; bump RegistryBundle::kFormatVersion
+    // when changing it.
+    const Table* t = s_table.load(std::memory_order_acquire);
+    static const Table empty;
+    if (!t) t = &empty;
+    w.beginSection(virtuoso::util::BundleSection::ChordScaleTable);
+    w.io(t->chordKeys);
+    w.list(t->entries, [](virtuoso::util::BundleWriter& a, const ChordScaleEntry& e) {
+        a.io(e.scaleKey);
+        a.io(e.scaleName);
+        a.io(e.function);
+        a.io(e.roman);
+    });
+}
+
+bool ChordScaleTable::initializeFromBundle(const virtuoso::util::RegistryBundle& bundle) {
+    return initializeOnce([&bundle]() -> std::unique_ptr<Table> {
+        QElapsedTimer timer;
+        timer.start();
+
+        virtuoso::util::BundleReader r = bundle.section(virtuoso::util::BundleSection::ChordScaleTable);
+        QVector<QString> chordKeys;
+        QVector<ChordScaleEntry> entries;
+        r.io(chordKeys);
+        r.list(entries, [](virtuoso::util::BundleReader& a, ChordScaleEntry& e) {
+            a.io(e.scaleKey);
+            a.io(e.scaleName);
+            a.io(e.function);
+            a.io(e.roman);
+        });
+        if (!r.ok() || !r.atEnd() || chordKeys.isEmpty() || entries.size() != chordKeys.size() * kSlotsPerChord) {
+            return nullptr;
+        }
+        for (qsizetype i = 1; i < chordKeys.size(); ++i) {
+            if (!(chordKeys[i - 1] < chordKeys[i])) return nullptr;
+        }
+
+        auto table = std::make_unique<Table>();
+        table->chordKeys = std::move(chordKeys);
+        table->entries = std::move(entries);
+        table->entryCount = int(std::count_if(table->entries.cbegin(), table->entries.cend(),
+                                              [](const ChordScaleEntry& e) { return !e.scaleKey.isEmpty(); }));
+
+        qInfo().noquote() << QString("ChordScaleTable: Loaded %1 precompiled entries in %2ms")
+                                 .arg(table->entryCount)
+                                 .arg(timer.elapsed());
+        return table;
+    });
 }
 
 bool ChordScaleTable::isInitialized() {
-    return s_initialized;
+    return s_table.load(std::memory_order_acquire) != nullptr;
 }
 
 const ChordScaleEntry* ChordScaleTable::lookup(
-    const QString& chordDefKey,
+    int chordId,
     int intervalFromKey,
     virtuoso::theory::KeyMode keyMode) {
     
-    if (!s_initialized) return nullptr;
+    const Table* t = s_table.load(std::memory_order_acquire);
+    if (!t) return nullptr;
     
-    const QString key = makeKey(chordDefKey, intervalFromKey, keyMode);
-    auto it = s_table.find(key);
-    if (it != s_table.end()) {
-        ++s_hits;
-        return &it.value();
+    StatsSlot& stats = threadStats();
+    if (chordId >= 0 && chordId < t->chordKeys.size()) {
+        const ChordScaleEntry& e = t->entries[slot(chordId, intervalFromKey, keyMode)];
+        if (!e.scaleKey.isEmpty()) {
+            stats.hits.fetch_add(1, std::memory_order_relaxed);
+            return &e;
+        }
     }
-    ++s_misses;
+    stats.misses.fetch_add(1, std::memory_order_relaxed);
     return nullptr;
 }
 
+const ChordScaleEntry* ChordScaleTable::lookup(
+    QStringView chordDefKey,
+    int intervalFromKey,
+    virtuoso::theory::KeyMode keyMode) {
+    
+    const Table* t = s_table.load(std::memory_order_acquire);
+    if (!t) return nullptr;
+    return lookup(t->chordIdOf(chordDefKey), intervalFromKey, keyMode);
+}
+
 const ChordScaleEntry* ChordScaleTable::lookup(
     const virtuoso::ontology::ChordDef& chordDef,
     int chordRootPc,
@@ -175,12 +313,44 @@ const ChordScaleEntry* ChordScaleTable::lookup(
     int interval = (chordRootPc - keyTonicPc) % 12;
     if (interval < 0) interval += 12;
     
-    return lookup(chordDef.key, interval, keyMode);
+    const Table* t = s_table.load(std::memory_order_acquire);
+    if (!t) return nullptr;
+    // Trust the id only if it names the same chord here (same ontology tables).
+    const bool idMatches = chordDef.id >= 0 && chordDef.id < t->chordKeys.size() &&
+                           t->chordKeys[chordDef.id] == chordDef.key;
+    return lookup(idMatches ? chordDef.id : t->chordIdOf(chordDef.key), interval, keyMode);
+}
+
+int ChordScaleTable::entryCount() {
+    const Table* t = s_table.load(std::memory_order_acquire);
+    return t ? t->entryCount : 0;
+}
+
+int ChordScaleTable::hitCount() {
+    StatsRegistry& r = statsRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    int n = r.retiredHits;
+    for (const StatsSlot* s : r.live) n += s->hits.load(std::memory_order_relaxed);
+    return n;
 }
 
-int ChordScaleTable::entryCount() { return s_table.size(); }
-int ChordScaleTable::hitCount() { return s_hits; }
-int ChordScaleTable::missCount() { return s_misses; }
-void ChordScaleTable::resetStats() { s_hits = 0; s_misses = 0; }
+int ChordScaleTable::missCount() {
+    StatsRegistry& r = statsRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    int n = r.retiredMisses;
+    for (const StatsSlot* s : r.live) n += s->misses.load(std::memory_order_relaxed);
+    return n;
+}
+
+void ChordScaleTable::resetStats() {
+    StatsRegistry& r = statsRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.retiredHits = 0;
+    r.retiredMisses = 0;
+    for (StatsSlot* s : r.live) {
+        s->hits.store(0, std::memory_order_relaxed);
+        s->misses.store(0, std::memory_order_relaxed);
+    }
+}
 
 } // namespace playback
@@ -1,11 +1,19 @@
 #pragma once
 
 #include <QString>
-#include <QHash>
+#include <QStringView>
+#include <QVector>
+
+#include <atomic>
 
 #include "virtuoso/ontology/OntologyRegistry.h"
 #include "virtuoso/theory/FunctionalHarmony.h"
 
+namespace virtuoso::util {
+class BundleWriter;
+class RegistryBundle;
+} // namespace virtuoso::util
+
 namespace playback {
 
 /**
@@ -36,21 +44,40 @@ struct ChordScaleEntry {
 
 class ChordScaleTable {
 public:
-    // Build the table from ontology (call once at startup)
+    // Build the table from ontology (call once at startup). Thread-safe and idempotent: the
+    // first initializer builds and publishes the table, later calls (from any thread) return
+    // once it is published.
     static void initialize(const virtuoso::ontology::OntologyRegistry& ontology);
+
+    // Precompiled table (virtuoso/util/RegistryBundle.h), built from the same ontology the
+    // bundle carries. initializeFromBundle() returns false, leaving the table uninitialized,
+    // when the bundle has no usable chord-scale section; callers then initialize().
+    static void writeBundle(virtuoso::util::BundleWriter& w);
+    static bool initializeFromBundle(const virtuoso::util::RegistryBundle& bundle);
     
     // Check if initialized
     static bool isInitialized();
     
     // O(1) lookup: given chord type, interval from key, and key mode
     // Returns nullptr if not found (fallback to runtime computation)
+    //
+    // Lookups may run on any number of threads at once (PrePlaybackBuilder's context pass maps
+    // over the whole thread pool): the published table is immutable and read without locks,
+    // and each thread counts hits/misses in its own slot. Entries stay valid for the process.
     static const ChordScaleEntry* lookup(
-        const QString& chordDefKey,     // e.g., "min7", "dom7"
+        int chordId,                    // OntologyRegistry::chordId() of the initializing ontology
         int intervalFromKey,            // 0-11, chord root relative to key tonic
         virtuoso::theory::KeyMode keyMode
     );
+
+    // By chord key (UI, tools): resolves the key to its id first.
+    static const ChordScaleEntry* lookup(
+        QStringView chordDefKey,        // e.g., "min7", "dom7"
+        int intervalFromKey,
+        virtuoso::theory::KeyMode keyMode
+    );
     
-    // Convenience: lookup by chord symbol and key context
+    // Convenience: lookup by chord symbol and key context (uses chordDef.id)
     static const ChordScaleEntry* lookup(
         const virtuoso::ontology::ChordDef& chordDef,
         int chordRootPc,
@@ -58,21 +85,35 @@ public:
         virtuoso::theory::KeyMode keyMode
     );
     
-    // Statistics for debugging
+    // Statistics for debugging. Counts are merged from every thread's slot when read.
     static int entryCount();
     static int hitCount();
     static int missCount();
     static void resetStats();
 
 private:
-    // Key format: "chordDefKey:interval:mode"
-    static QString makeKey(const QString& chordDefKey, int interval, virtuoso::theory::KeyMode mode);
+    friend struct ChordScaleTableTestAccess;
+    friend struct ChordScaleTableBenchAccess;
+
+    // Flat [chordId][interval 0-11][mode] layout; an entry with an empty scaleKey is a miss.
+    // Chord ids are the initializing ontology's (key order), kept with their keys so a
+    // ChordDef from another registry instance is checked before its id is trusted.
+    struct Table {
+        QVector<QString> chordKeys;
+        QVector<ChordScaleEntry> entries;
+        int entryCount = 0;
+
+        int chordIdOf(QStringView chordDefKey) const;
+    };
+
+    static constexpr int kSlotsPerChord = 12 * 2;
+    static int slot(int chordId, int interval, virtuoso::theory::KeyMode mode);
+    // Builds or loads under the init lock, then publishes; false leaves the table unpublished.
+    template <typename Build>
+    static bool initializeOnce(const Build& build);
     
-    // The actual table
-    static QHash<QString, ChordScaleEntry> s_table;
-    static bool s_initialized;
-    static int s_hits;
-    static int s_misses;
+    // The actual table: published once (release) and only read after that (acquire).
+    static std::atomic<const Table*> s_table;
 };
 
 } // namespace playback
@@ -73,12 +73,12 @@ bool HarmonyContext::sameChordKey(const music::ChordSymbol& a, const music::Chor
     return aa == bb;
 }
 
-QString HarmonyContext::ontologyChordKeyFor(const music::ChordSymbol& c) {
+QStringView HarmonyContext::ontologyChordKeyFor(const music::ChordSymbol& c) {
     using music::ChordQuality;
     using music::SeventhQuality;
     if (c.noChord || c.placeholder) return {};
     if (c.quality == ChordQuality::Dominant) {
-        if (c.alt) return "7alt";
+        if (c.alt) return u"7alt";
 
         // Collect all alterations
         bool hasB5 = false, hasSharp5 = false;
@@ -95,82 +95,83 @@ QString HarmonyContext::ontologyChordKeyFor(const music::ChordSymbol& c) {
         }
 
         // Priority: 5th alterations first (they change the fundamental chord quality)
-        if (hasSharp5) return "7#5";  // aug7 equivalent
-        if (hasB5) return "7b5";
+        if (hasSharp5) return u"7#5";  // aug7 equivalent
+        if (hasB5) return u"7b5";
 
         // Combined alterations (check most specific first)
-        if (hasB9 && hasSharp9) return "7b9#9";
-        if (hasB9 && hasB13) return "7b9b13";
-        if (hasSharp9 && hasB13) return "7#9b13";
-        if (c.extension >= 13 && hasB9 && hasSharp11) return "13b9#11";
-        if (c.extension >= 13 && hasSharp9 && hasSharp11) return "13#9#11";
-        if (c.extension >= 13 && hasB9) return "13b9";
-        if (c.extension >= 13 && hasSharp9) return "13#9";
+        if (hasB9 && hasSharp9) return u"7b9#9";
+        if (hasB9 && hasB13) return u"7b9b13";
+        if (hasSharp9 && hasB13) return u"7#9b13";
+        if (c.extension >= 13 && hasB9 && hasSharp11) return u"13b9#11";
+        if (c.extension >= 13 && hasSharp9 && hasSharp11) return u"13#9#11";
+        if (c.extension >= 13 && hasB9) return u"13b9";
+        if (c.extension >= 13 && hasSharp9) return u"13#9";
 
         // Single alterations
-        if (hasB9) return "7b9";
-        if (hasSharp9) return "7#9";
-        if (hasB13) return "7b13";
-        if (hasSharp11) return "7#11";
+        if (hasB9) return u"7b9";
+        if (hasSharp9) return u"7#9";
+        if (hasB13) return u"7b13";
+        if (hasSharp11) return u"7#11";
 
         // Extensions without alterations
-        if (c.extension >= 13 && hasSharp11) return "13#11";
-        if (c.extension >= 13) return "13";
-        if (c.extension >= 11) return "11";
-        if (c.extension >= 9) return "9";
-        if (c.seventh != SeventhQuality::None || c.extension >= 7) return "7";
-        return "7";
+        if (c.extension >= 13 && hasSharp11) return u"13#11";
+        if (c.extension >= 13) return u"13";
+        if (c.extension >= 11) return u"11";
+        if (c.extension >= 9) return u"9";
+        if (c.seventh != SeventhQuality::None || c.extension >= 7) return u"7";
+        return u"7";
     }
-    if (c.quality == ChordQuality::HalfDiminished) return "m7b5";
+    if (c.quality == ChordQuality::HalfDiminished) return u"m7b5";
     if (c.quality == ChordQuality::Diminished) {
-        if (c.seventh == SeventhQuality::Dim7) return "dim7";
-        return (c.extension >= 7) ? "dim7" : "dim";
+        if (c.seventh == SeventhQuality::Dim7) return u"dim7";
+        return (c.extension >= 7) ? QStringView(u"dim7") : QStringView(u"dim");
     }
     if (c.quality == ChordQuality::Minor) {
         if (c.seventh == SeventhQuality::Major7) {
-            if (c.extension >= 13) return "minmaj13";
-            if (c.extension >= 11) return "minmaj11";
-            if (c.extension >= 9) return "minmaj9";
-            return "min_maj7";
+            if (c.extension >= 13) return u"minmaj13";
+            if (c.extension >= 11) return u"minmaj11";
+            if (c.extension >= 9) return u"minmaj9";
+            return u"min_maj7";
         }
-        if (c.extension >= 13) return "min13";
-        if (c.extension >= 11) return "min11";
-        if (c.extension >= 9) return "min9";
-        if (c.seventh != SeventhQuality::None || c.extension >= 7) return "min7";
-        return "min";
+        if (c.extension >= 13) return u"min13";
+        if (c.extension >= 11) return u"min11";
+        if (c.extension >= 9) return u"min9";
+        if (c.seventh != SeventhQuality::None || c.extension >= 7) return u"min7";
+        return u"min";
     }
     if (c.quality == ChordQuality::Major) {
         bool hasSharp11 = false;
         for (const auto& a : c.alterations) {
             if (a.degree == 11 && a.delta > 0) hasSharp11 = true;
         }
-        if (c.extension >= 13 && hasSharp11) return "maj13#11";
-        if (c.extension >= 13) return "maj13";
-        if (c.extension >= 11) return "maj11";
-        if (c.extension >= 9 && hasSharp11) return "maj9#11";
-        if (c.extension >= 9) return "maj9";
-        if (c.seventh == SeventhQuality::Major7 || c.extension >= 7) return "maj7";
-        if (c.extension >= 6) return "6";
-        return "maj";
+        if (c.extension >= 13 && hasSharp11) return u"maj13#11";
+        if (c.extension >= 13) return u"maj13";
+        if (c.extension >= 11) return u"maj11";
+        if (c.extension >= 9 && hasSharp11) return u"maj9#11";
+        if (c.extension >= 9) return u"maj9";
+        if (c.seventh == SeventhQuality::Major7 || c.extension >= 7) return u"maj7";
+        if (c.extension >= 6) return u"6";
+        return u"maj";
     }
-    if (c.quality == ChordQuality::Sus2) return "sus2";
+    if (c.quality == ChordQuality::Sus2) return u"sus2";
     if (c.quality == ChordQuality::Sus4) {
-        if (c.extension >= 13) return "13sus4";
-        if (c.extension >= 9) return "9sus4";
-        if (c.seventh == SeventhQuality::Minor7 || c.extension >= 7) return "7sus4";
-        return "sus4";
+        if (c.extension >= 13) return u"13sus4";
+        if (c.extension >= 9) return u"9sus4";
+        if (c.seventh == SeventhQuality::Minor7 || c.extension >= 7) return u"7sus4";
+        return u"sus4";
     }
     if (c.quality == ChordQuality::Augmented) {
-        if (c.seventh == SeventhQuality::Minor7 || c.extension >= 7) return "aug7";
-        return "aug";
+        if (c.seventh == SeventhQuality::Minor7 || c.extension >= 7) return u"aug7";
+        return u"aug";
     }
-    if (c.quality == ChordQuality::Power5) return "5";
+    if (c.quality == ChordQuality::Power5) return u"5";
     return {};
 }
 
 const virtuoso::ontology::ChordDef* HarmonyContext::chordDefForSymbol(const music::ChordSymbol& c) const {
     if (!m_ont) return nullptr;
-    const QString key = ontologyChordKeyFor(c);
+    // A literal key: resolved by binary search over the interned chord table, no allocation.
+    const QStringView key = ontologyChordKeyFor(c);
     if (key.isEmpty()) return nullptr;
     return m_ont->chord(key);
 }
@@ -345,7 +346,7 @@ HarmonyContext::ScaleChoice HarmonyContext::chooseScaleForChord(int keyPc,
     struct Sc { virtuoso::theory::ScaleSuggestion s; double score = 0.0; };
     QVector<Sc> ranked;
     ranked.reserve(sugg.size());
-    const QString chordKey = ontologyChordKeyFor(chordSym);
+    const QString chordKey = ontologyChordKeyFor(chordSym).toString();
     const QVector<QString> hints = virtuoso::theory::explicitHintScalesForContext(QString(), chordKey);
     for (const auto& s : sugg) {
         double bonus = 0.0;
@@ -378,9 +379,11 @@ HarmonyContext::ScaleChoice HarmonyContext::chooseScaleForChord(int keyPc,
 music::ChordSymbol HarmonyContext::parseCellChordNoState(const chart::ChartModel& model,
                                                         int cellIndex,
                                                         const music::ChordSymbol& fallback,
-                                                        bool* outIsExplicit) const {
+                                                        bool* outIsExplicit,
+                                                        bool* outCellExists) const {
     if (outIsExplicit) *outIsExplicit = false;
     const chart::Cell* c = cellForFlattenedIndexLocal(model, cellIndex);
+    if (outCellExists) *outCellExists = (c != nullptr);
     if (!c) return fallback;
     const QString t = c->chord.trimmed();
     if (t.isEmpty()) return fallback;
@@ -391,9 +394,18 @@ music::ChordSymbol HarmonyContext::parseCellChordNoState(const chart::ChartModel
     return parsed;
 }
 
+HarmonyContext::ChordCarry HarmonyContext::chordCarry(bool cellExists, bool cellIsExplicit, bool hasLastChord) {
+    if (!cellExists) return ChordCarry::NoChord;
+    if (cellIsExplicit) return ChordCarry::CellChord;
+    return hasLastChord ? ChordCarry::LastChord : ChordCarry::NoChord;
+}
+
+bool HarmonyContext::isNewChord(const music::ChordSymbol& cellChord, const music::ChordSymbol* lastChord) {
+    return !lastChord || !sameChordKey(cellChord, *lastChord);
+}
+
 bool HarmonyContext::chordForCellIndex(const chart::ChartModel& model, int cellIndex, music::ChordSymbol& outChord, bool& isNewChord) {
     isNewChord = false;
-    const chart::Cell* c = cellForFlattenedIndexLocal(model, cellIndex);
     
     // HARMONY_TRACE: Debug logging (use DirectConnection for synchronous/ordered output)
     auto emitTrace = [this](const QString& msg) {
@@ -407,54 +419,41 @@ bool HarmonyContext::chordForCellIndex(const chart::ChartModel& model, int cellI
     const int barIdx = cellIndex / 4;
     const int cellInBar = cellIndex % 4;
     
-    if (!c) {
+    bool cellExists = false;
+    bool cellIsExplicit = false;
+    const music::ChordSymbol parsed =
+        parseCellChordNoState(model, cellIndex, music::ChordSymbol{}, &cellIsExplicit, &cellExists);
+    if (!cellExists) {
         emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) -> NO CELL FOUND")
             .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar));
         return false;
     }
 
-    const QString t = c->chord.trimmed();
+    const QString t = cellForFlattenedIndexLocal(model, cellIndex)->chord.trimmed();
     const QString prevChordText = m_hasLastChord ? m_lastChord.originalText : "(none)";
-    
-    if (t.isEmpty()) {
-        if (m_hasLastChord) {
-            outChord = m_lastChord;
-            emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='' (empty) -> CONTINUE prev='%5'")
-                .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(m_lastChord.originalText));
-            return true;
-        }
-        emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='' (empty), no prev -> FALSE")
-            .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar));
-        return false;
-    }
+    // Why a non-explicit cell does not name a chord (trace only).
+    auto why = [&t]() -> QString {
+        if (t.isEmpty()) return "(empty)";
+        music::ChordSymbol tmp;
+        return music::parseChordSymbol(t, tmp) ? "PLACEHOLDER" : "PARSE_FAIL";
+    };
 
-    music::ChordSymbol parsed;
-    if (!music::parseChordSymbol(t, parsed)) {
-        if (m_hasLastChord) {
-            outChord = m_lastChord;
-            emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' PARSE_FAIL -> CONTINUE prev='%6'")
-                .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(t).arg(m_lastChord.originalText));
-            return true;
-        }
-        emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' PARSE_FAIL, no prev -> FALSE")
-            .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(t));
-        return false;
-    }
-    if (parsed.placeholder) {
-        if (m_hasLastChord) {
-            outChord = m_lastChord;
-            emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' PLACEHOLDER -> CONTINUE prev='%6'")
-                .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(t).arg(m_lastChord.originalText));
-            return true;
-        }
-        emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' PLACEHOLDER, no prev -> FALSE")
-            .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(t));
+    switch (chordCarry(cellExists, cellIsExplicit, m_hasLastChord)) {
+    case ChordCarry::NoChord:
+        emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' %6, no prev -> FALSE")
+            .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(t).arg(why()));
         return false;
+    case ChordCarry::LastChord:
+        outChord = m_lastChord;
+        emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' %6 -> CONTINUE prev='%7'")
+            .arg(cellIndex).arg(cellIndex).arg(barIdx).arg(cellInBar).arg(t).arg(why()).arg(m_lastChord.originalText));
+        return true;
+    case ChordCarry::CellChord:
+        break;
     }
 
     outChord = parsed;
-    if (!m_hasLastChord) isNewChord = true;
-    else isNewChord = !sameChordKey(outChord, m_lastChord);
+    isNewChord = HarmonyContext::isNewChord(outChord, m_hasLastChord ? &m_lastChord : nullptr);
     
     // THIS IS WHERE m_lastChord CHANGES - critical to trace!
     emitTrace(QString("HARMONY[%1]: cell=%2 (bar%3.%4) RAW='%5' -> PARSED='%6' %7 (prev='%8')")
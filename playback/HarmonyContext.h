@@ -4,6 +4,7 @@
 #include <QPointer>
 #include <QSet>
 #include <QString>
+#include <QStringView>
 #include <QVector>
 
 #include "chart/ChartModel.h"
@@ -25,14 +26,25 @@ public:
 
     void rebuildFromModel(const chart::ChartModel& model);
 
+    // chordForCellIndex()'s carry-over rule, also replayed by PrePlaybackBuilder over its cell
+    // tables: an explicit chord replaces the last chord, an empty/unparseable/placeholder cell
+    // continues it (if there is one), a missing cell has no chord.
+    enum class ChordCarry { NoChord, LastChord, CellChord };
+    static ChordCarry chordCarry(bool cellExists, bool cellIsExplicit, bool hasLastChord);
+    // isNewChord of a CellChord step (lastChord: nullptr when there is none).
+    static bool isNewChord(const music::ChordSymbol& cellChord, const music::ChordSymbol* lastChord);
+
     // Runtime chord tracking (mutates internal last-chord state).
     bool chordForCellIndex(const chart::ChartModel& model, int cellIndex, music::ChordSymbol& outChord, bool& isNewChord);
 
     // Stateless parse: never mutates last-chord state.
+    // outCellExists (optional) is false when the chart has no cell at cellIndex; chordForCellIndex()
+    // reports "no chord" for such cells regardless of the last chord.
     music::ChordSymbol parseCellChordNoState(const chart::ChartModel& model,
                                              int cellIndex,
                                              const music::ChordSymbol& fallback,
-                                             bool* outIsExplicit = nullptr) const;
+                                             bool* outIsExplicit = nullptr,
+                                             bool* outCellExists = nullptr) const;
 
     // Key context accessors
     bool hasKeyPcGuess() const { return m_hasKeyPcGuess; }
@@ -91,7 +103,7 @@ public:
 
 private:
     static QVector<const chart::Bar*> flattenBarsFrom(const chart::ChartModel& model);
-    static QString ontologyChordKeyFor(const music::ChordSymbol& c);
+    static QStringView ontologyChordKeyFor(const music::ChordSymbol& c);
     static QSet<int> pitchClassesForChordDef(int rootPc, const virtuoso::ontology::ChordDef& chord);
     static virtuoso::theory::KeyMode keyModeForScaleKey(const QString& k);
 
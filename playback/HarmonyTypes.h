@@ -1,8 +1,11 @@
 #pragma once
 
 #include <QString>
+#include <QtGlobal>
 #include <set>
 #include <array>
+#include <cstddef>
+#include <iterator>
 
 #include "virtuoso/theory/FunctionalHarmony.h"
 
@@ -21,6 +24,70 @@ struct LocalKeyEstimate {
     double coverage = 0.0;
 };
 
+// ============================================================================
+// Pitch-class set (12-bit mask)
+// ============================================================================
+
+// Set of pitch classes 0-11 stored as a bit mask (bit pc set = pc present).
+// Same contains/insert/unite/isEmpty/size/range-for surface as the QSet<int>
+// it replaces in the harmony code, but copying and testing are plain integer
+// ops and never allocate. Iterates in ascending pitch-class order.
+class PitchClassSet {
+public:
+    constexpr PitchClassSet() = default;
+    static constexpr PitchClassSet fromMask(quint16 mask) { return PitchClassSet(quint16(mask & 0x0FFFu)); }
+
+    constexpr quint16 mask() const { return m_mask; }
+    constexpr bool contains(int pc) const { return pc >= 0 && pc < 12 && ((m_mask >> pc) & 1u); }
+    constexpr bool isEmpty() const { return m_mask == 0; }
+    int size() const {
+        int n = 0;
+        for (quint16 m = m_mask; m; m = quint16(m & (m - 1))) ++n;
+        return n;
+    }
+
+    void insert(int pc) { if (pc >= 0 && pc < 12) m_mask = quint16(m_mask | (1u << pc)); }
+    void remove(int pc) { if (pc >= 0 && pc < 12) m_mask = quint16(m_mask & ~(1u << pc)); }
+    PitchClassSet& unite(const PitchClassSet& other) { m_mask = quint16(m_mask | other.m_mask); return *this; }
+    PitchClassSet& subtract(const PitchClassSet& other) { m_mask = quint16(m_mask & ~other.m_mask); return *this; }
+
+    // std::set<int> spellings, so code written against the old set-based
+    // ActiveChord tiers keeps compiling unchanged.
+    int count(int pc) const { return contains(pc) ? 1 : 0; }
+    bool empty() const { return isEmpty(); }
+
+    constexpr bool operator==(const PitchClassSet& o) const { return m_mask == o.m_mask; }
+    constexpr bool operator!=(const PitchClassSet& o) const { return m_mask != o.m_mask; }
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        explicit const_iterator(quint16 rest) : m_rest(rest) {}
+        int operator*() const {
+            int pc = 0;
+            while (!((m_rest >> pc) & 1u)) ++pc;
+            return pc;
+        }
+        const_iterator& operator++() { m_rest = quint16(m_rest & (m_rest - 1)); return *this; }
+        const_iterator operator++(int) { const_iterator prev = *this; ++*this; return prev; }
+        bool operator==(const const_iterator& o) const { return m_rest == o.m_rest; }
+        bool operator!=(const const_iterator& o) const { return m_rest != o.m_rest; }
+    private:
+        quint16 m_rest;
+    };
+    const_iterator begin() const { return const_iterator(m_mask); }
+    const_iterator end() const { return const_iterator(0); }
+
+private:
+    constexpr explicit PitchClassSet(quint16 mask) : m_mask(mask) {}
+    quint16 m_mask = 0;
+};
+
 // ============================================================================
 // Phase 1: Chord Ontology Types
 // ============================================================================
@@ -291,11 +291,11 @@ QVector<virtuoso::engine::AgentIntentNote> JazzBalladBassPlanner::planBeat(const
         auto chooseApproachTo = [&](int targetMidi) -> int {
             // Prefer half-step approaches; at cadence/dominant allow occasional whole-step.
             const bool spicy = (c.chordFunction == "Dominant") || (c.cadence01 >= 0.55);
-            const quint32 h = virtuoso::util::StableHash::fnv1a32(QString("bwalk_app|%1|%2|%3")
-                                                                      .arg(c.chordText)
-                                                                      .arg(c.playbackBarIndex)
-                                                                      .arg(c.determinismSeed)
-                                                                      .toUtf8());
+            const quint32 h = virtuoso::util::StableHash::ArgFormat("bwalk_app|%1|%2|%3")
+                                  .arg(c.chordText)
+                                  .arg(c.playbackBarIndex)
+                                  .arg(c.determinismSeed)
+                                  .value();
             const int step = (spicy && energy >= 0.50 && int(h % 100u) < 35) ? 2 : 1;
             const int below = targetMidi - step;
             const int above = targetMidi + step;
@@ -384,11 +384,11 @@ QVector<virtuoso::engine::AgentIntentNote> JazzBalladBassPlanner::planBeat(const
                 const bool wantEnclosure = !userBusy && c.allowApproachFromAbove &&
                                            (c.chordFunction == "Dominant" || c.cadence01 >= 0.75) &&
                                            (energy >= 0.60);
-                const quint32 he = virtuoso::util::StableHash::fnv1a32(QString("bwalk_enc|%1|%2|%3")
-                                                                           .arg(c.chordText)
-                                                                           .arg(c.playbackBarIndex)
-                                                                           .arg(c.determinismSeed)
-                                                                           .toUtf8());
+                const quint32 he = virtuoso::util::StableHash::ArgFormat("bwalk_enc|%1|%2|%3")
+                                       .arg(c.chordText)
+                                       .arg(c.playbackBarIndex)
+                                       .arg(c.determinismSeed)
+                                       .value();
                 if (wantEnclosure && int(he % 100u) < int(llround(25.0 + 55.0 * qBound(0.0, c.cadence01, 1.0)))) {
                     int a = nextRootMidi + 1;
                     int b = nextRootMidi - 1;
@@ -557,11 +557,11 @@ QVector<virtuoso::engine::AgentIntentNote> JazzBalladBassPlanner::planBeat(const
             // Keep the old "Chet space" behavior but modulate by Virtuosity weights.
             const bool stableHarmony = !nextChanges && !c.chordIsNew;
             if (stableHarmony) {
-                const quint32 hStable = virtuoso::util::StableHash::fnv1a32(QString("%1|%2|%3|b3")
-                                                                                .arg(c.chordText)
-                                                                                .arg(c.playbackBarIndex)
-                                                                                .arg(c.determinismSeed)
-                                                                                .toUtf8());
+                const quint32 hStable = virtuoso::util::StableHash::ArgFormat("%1|%2|%3|b3")
+                                            .arg(c.chordText)
+                                            .arg(c.playbackBarIndex)
+                                            .arg(c.determinismSeed)
+                                            .value();
                 // Higher energy = fewer omissions (more activity)
                 const double omit = qBound(0.0,
                                            c.skipBeat3ProbStable
@@ -722,11 +722,11 @@ QVector<virtuoso::engine::AgentIntentNote> JazzBalladBassPlanner::planBeat(const
 
         // Deterministic probability, slightly higher at phrase ends (adaptive 4–8 bar phrasing).
         const bool phraseEnd = c.phraseEndBar;
-        const quint32 hApp = virtuoso::util::StableHash::fnv1a32(QString("%1|%2|%3|app4")
-                                                                     .arg(c.chordText)
-                                                                     .arg(c.playbackBarIndex)
-                                                                     .arg(c.determinismSeed)
-                                                                     .toUtf8());
+        const quint32 hApp = virtuoso::util::StableHash::ArgFormat("%1|%2|%3|app4")
+                                 .arg(c.chordText)
+                                 .arg(c.playbackBarIndex)
+                                 .arg(c.determinismSeed)
+                                 .value();
         // Energy-driven pickup frequency (simplified from legacy weights).
         const double baseP = qBound(0.0,
                                     (c.approachProbBeat3 * 0.45)
@@ -784,11 +784,11 @@ QVector<virtuoso::engine::AgentIntentNote> JazzBalladBassPlanner::planBeat(const
         } else {
             // On stable harmony, occasionally hold the root for the whole bar (Chet ballad vibe).
             const bool stable = (!c.hasNextChord) || ((c.nextChord.rootPc == c.chord.rootPc) && !c.chordIsNew);
-            const quint32 hLen = virtuoso::util::StableHash::fnv1a32(QString("%1|%2|%3|len")
-                                                                         .arg(c.chordText)
-                                                                         .arg(c.playbackBarIndex)
-                                                                         .arg(c.determinismSeed)
-                                                                         .toUtf8());
+            const quint32 hLen = virtuoso::util::StableHash::ArgFormat("%1|%2|%3|len")
+                                     .arg(c.chordText)
+                                     .arg(c.playbackBarIndex)
+                                     .arg(c.determinismSeed)
+                                     .value();
             const bool longHold = stable && ((hLen % 4u) == 0u);
             // Walk articulation: slightly legato when stepwise, otherwise normal quarter.
             if (doWalk) {
@@ -982,11 +982,11 @@ JazzBalladBassPlanner::BeatPlan JazzBalladBassPlanner::planBeatWithActions(const
         const bool meaningful = (n0.structural || c.phraseEndBar || c.cadence01 >= 0.80);
         const bool highEnough = (n0.note >= 60); // harmonics read best higher
         if (meaningful && highEnough && c.energy >= 0.40) {
-            const quint32 hNh = virtuoso::util::StableHash::fnv1a32(QString("ab_upr_nh|%1|%2|%3")
-                                                                        .arg(c.chordText)
-                                                                        .arg(c.playbackBarIndex)
-                                                                        .arg(c.determinismSeed)
-                                                                        .toUtf8());
+            const quint32 hNh = virtuoso::util::StableHash::ArgFormat("ab_upr_nh|%1|%2|%3")
+                                    .arg(c.chordText)
+                                    .arg(c.playbackBarIndex)
+                                    .arg(c.determinismSeed)
+                                    .value();
             const int p = qBound(0, int(llround(8.0 + 22.0 * qBound(0.0, c.cadence01, 1.0))), 35);
             if (int(hNh % 100u) < p) {
                 KeySwitchIntent ks;
@@ -1007,11 +1007,11 @@ JazzBalladBassPlanner::BeatPlan JazzBalladBassPlanner::planBeatWithActions(const
         const bool cadence = (c.phraseEndBar || c.cadence01 >= 0.70);
         const bool sustained = (n0.durationWhole.num * 1.0 / n0.durationWhole.den) >= (1.0 / double(qMax(1, ts.den))); // at least ~1 beat
         if (cadence && sustained && c.energy >= 0.30) {
-            const quint32 hSio = virtuoso::util::StableHash::fnv1a32(QString("ab_upr_sio_out|%1|%2|%3")
-                                                                         .arg(c.chordText)
-                                                                         .arg(c.playbackBarIndex)
-                                                                         .arg(c.determinismSeed)
-                                                                         .toUtf8());
+            const quint32 hSio = virtuoso::util::StableHash::ArgFormat("ab_upr_sio_out|%1|%2|%3")
+                                     .arg(c.chordText)
+                                     .arg(c.playbackBarIndex)
+                                     .arg(c.determinismSeed)
+                                     .value();
             const int p = qBound(0, int(llround(10.0 + 28.0 * qBound(0.0, c.cadence01, 1.0))), 55);
             if (int(hSio % 100u) < p) {
                 KeySwitchIntent ks;
@@ -1034,11 +1034,11 @@ JazzBalladBassPlanner::BeatPlan JazzBalladBassPlanner::planBeatWithActions(const
     // FX notes: performance noises + intentional percussive taps.
     // These are NOT bass-range notes, so we keep them out of the BassDriver constraint path.
     if ((c.phraseEndBar || c.cadence01 >= 0.70) && !userBusy && c.energy <= 0.85) {
-        const quint32 hf = virtuoso::util::StableHash::fnv1a32(QString("ab_upr_fx|%1|%2|%3")
-                                                                   .arg(c.chordText)
-                                                                   .arg(c.playbackBarIndex)
-                                                                   .arg(c.determinismSeed)
-                                                                   .toUtf8());
+        const quint32 hf = virtuoso::util::StableHash::ArgFormat("ab_upr_fx|%1|%2|%3")
+                               .arg(c.chordText)
+                               .arg(c.playbackBarIndex)
+                               .arg(c.determinismSeed)
+                               .value();
         const int roll = int(hf % 100u);
         const bool bassPlaysThisBeat = (c.beatInBar == 0 || c.beatInBar == 2 || c.beatInBar == 3);
 
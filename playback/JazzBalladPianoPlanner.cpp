@@ -462,7 +462,8 @@ void JazzBalladPianoPlanner::setOntology(const virtuoso::ontology::OntologyRegis
 
 void JazzBalladPianoPlanner::reset() {
     QMutexLocker locker(m_stateMutex.get());
-    m_state = PlannerState{};
+    m_state = WorkingState{};
+    m_sharedCache.reset();
     m_state.perf.heldNotes.clear();
     m_state.perf.ints.insert("cc64", 0);
     m_state.lastVoicingMidi.clear();
@@ -518,15 +519,74 @@ void JazzBalladPianoPlanner::updateStateFromGenerators() {
     m_state.lastChordForRh = rhState.lastChordForRh;
 }
 
+const JazzBalladPianoPlanner::StateShared& JazzBalladPianoPlanner::PlannerState::defaultShared() {
+    static const StateShared kDefault;
+    return kDefault;
+}
+
+namespace {
+bool sameShared(const JazzBalladPianoPlanner::StateShared& a, const JazzBalladPianoPlanner::StateShared& b) {
+    return a.lastVoicingMidi == b.lastVoicingMidi && a.lastVoicingKey == b.lastVoicingKey &&
+           a.currentPhraseId == b.currentPhraseId && a.perf.heldNotes == b.perf.heldNotes &&
+           a.perf.ints == b.perf.ints && a.lastLhMidi == b.lastLhMidi && a.lastRhMidi == b.lastRhMidi &&
+           music::sameChordSymbol(a.lastChordForRh, b.lastChordForRh) && a.phraseMotifPcs == b.phraseMotifPcs &&
+           a.questionContour == b.questionContour && a.lastMelodicPattern == b.lastMelodicPattern;
+}
+} // namespace
+
+// Must cover every StateCore field: a missed field can end an incremental replan early.
+bool JazzBalladPianoPlanner::sameState(const PlannerState& x, const PlannerState& y) {
+    const StateCore& a = x.core;
+    const StateCore& b = y.core;
+    const bool coreSame =
+           a.lastTopMidi == b.lastTopMidi && a.phraseStartBar == b.phraseStartBar &&
+           a.lastRhTopMidi == b.lastRhTopMidi && a.lastRhSecondMidi == b.lastRhSecondMidi &&
+           a.lastLhWasTypeA == b.lastLhWasTypeA && a.rhMelodicDirection == b.rhMelodicDirection &&
+           a.rhMotionsThisChord == b.rhMotionsThisChord &&
+           a.lastPhraseStartBar == b.lastPhraseStartBar && a.phraseArcPhase == b.phraseArcPhase &&
+           a.phraseTargetMidi == b.phraseTargetMidi && a.phraseResolveMidi == b.phraseResolveMidi &&
+           a.phraseMotifStartDegree == b.phraseMotifStartDegree &&
+           a.phraseMotifAscending == b.phraseMotifAscending && a.phraseMotifVariation == b.phraseMotifVariation &&
+           a.recentRegisterSum == b.recentRegisterSum && a.recentRegisterCount == b.recentRegisterCount &&
+           a.preferredRegisterOffset == b.preferredRegisterOffset &&
+           a.barsInCurrentRegister == b.barsInCurrentRegister && a.lastPhraseWasHigh == b.lastPhraseWasHigh &&
+           a.userWasBusy == b.userWasBusy && a.responseWindowBeats == b.responseWindowBeats &&
+           a.inResponseMode == b.inResponseMode && a.userLastRegisterHigh == b.userLastRegisterHigh &&
+           a.userLastRegisterLow == b.userLastRegisterLow && a.lastPhraseWasQuestion == b.lastPhraseWasQuestion &&
+           a.questionPeakMidi == b.questionPeakMidi && a.questionEndMidi == b.questionEndMidi &&
+           a.barsInCurrentQA == b.barsInCurrentQA &&
+           a.sequenceTransposition == b.sequenceTransposition &&
+           a.sequenceRepetitions == b.sequenceRepetitions && a.lastInnerVoiceIndex == b.lastInnerVoiceIndex &&
+           a.innerVoiceDirection == b.innerVoiceDirection && a.innerVoiceTarget == b.innerVoiceTarget &&
+           a.innerVoiceTension == b.innerVoiceTension && a.beatsOnCurrentTarget == b.beatsOnCurrentTarget &&
+           a.currentPhrasePeakMidi == b.currentPhrasePeakMidi && a.currentPhraseLastMidi == b.currentPhraseLastMidi &&
+           a.phrasePatternIndex == b.phrasePatternIndex && a.lastPhrasePatternIndex == b.lastPhrasePatternIndex &&
+           a.phrasePatternBar == b.phrasePatternBar && a.phrasePatternBeat == b.phrasePatternBeat &&
+           a.phrasePatternHitIndex == b.phrasePatternHitIndex &&
+           a.phraseMelodicTargetMidi == b.phraseMelodicTargetMidi && a.phraseVoicingType == b.phraseVoicingType;
+    return coreSame && (x.shared == y.shared || sameShared(x.sub(), y.sub()));
+}
+
 JazzBalladPianoPlanner::PlannerState JazzBalladPianoPlanner::snapshotState() const {
     QMutexLocker locker(m_stateMutex.get());
     syncGeneratorState();  // Ensure generators are in sync before snapshot
-    return m_state;
+    PlannerState s;
+    s.core = m_state;
+    // Planning a beat usually rewrites the containers, but repeated snapshots (and restore+snapshot
+    // without planning) hand out the same immutable block instead of allocating another one.
+    const StateShared& cur = m_state;
+    if (!m_sharedCache || !sameShared(*m_sharedCache, cur)) {
+        m_sharedCache = std::make_shared<const StateShared>(cur);
+    }
+    s.shared = m_sharedCache;
+    return s;
 }
 
 void JazzBalladPianoPlanner::restoreState(const PlannerState& s) {
     QMutexLocker locker(m_stateMutex.get());
-    m_state = s;
+    static_cast<StateCore&>(m_state) = s.core;
+    static_cast<StateShared&>(m_state) = s.sub();
+    m_sharedCache = s.shared;
     syncGeneratorState();  // Sync generators with restored state
 }
 
@@ -5,6 +5,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <memory>
+#include <type_traits>
 
 #include "music/ChordSymbol.h"
 #include "virtuoso/constraints/PianoDriver.h"
@@ -47,28 +48,24 @@ namespace playback {
  */
 class JazzBalladPianoPlanner {
 public:
-    // State for snapshot/restore (used by phrase planner and lookahead)
-    struct PlannerState {
-        QVector<int> lastVoicingMidi;    // last realized MIDI notes (combined)
+    // Planner continuity state, split for cheap forking (beam search, lookahead, pre-cache):
+    //  - StateCore:   every scalar field; trivially copyable, lives inline.
+    //  - StateShared: containers, strings, chord and constraint state; immutable once snapshotted
+    //                 and shared between every PlannerState forked from the same snapshot.
+    // The planner itself works on a flat WorkingState (StateCore + StateShared, mutable).
+
+    struct StateCore {
         int lastTopMidi = -1;            // for RH continuity
-        QString lastVoicingKey;          // ontology key of last voicing used
 
         // Phrase-level state for vocabulary coherence
-        QString currentPhraseId;         // current phrase pattern ID
         int phraseStartBar = -1;         // bar where phrase pattern started
-
-        // Constraints state (needed by JointCandidateModel for feasibility evaluation)
-        virtuoso::constraints::PerformanceState perf;
         
         // ========== NEW: Separate LH/RH state for Bill Evans style ==========
-        QVector<int> lastLhMidi;         // LH rootless voicing (3-4 notes)
-        QVector<int> lastRhMidi;         // RH melodic dyad/triad (2-3 notes)
         int lastRhTopMidi = 74;          // RH melodic line top note tracking
         int lastRhSecondMidi = 69;       // RH second voice for melodic dyads
         bool lastLhWasTypeA = true;      // Alternate Type A/B for voice-leading
         int rhMelodicDirection = 0;      // -1 descending, 0 neutral, +1 ascending
         int rhMotionsThisChord = 0;      // Count of RH melodic movements on current chord
-        music::ChordSymbol lastChordForRh; // Track when chord changes for RH reset
         
         // ========== PHRASE-LEVEL PLANNING ==========
         // Tracks melodic arcs, motifs, and phrase-level intent across multiple bars
@@ -76,7 +73,6 @@ public:
         int phraseArcPhase = 0;          // 0=building, 1=peak, 2=resolving
         int phraseTargetMidi = 76;       // The note we're building toward (phrase peak)
         int phraseResolveMidi = 72;      // The note we resolve to at phrase end
-        QVector<int> phraseMotifPcs;     // 2-3 pitch classes of our motif (relative to chord)
         int phraseMotifStartDegree = 5;  // Starting degree of motif (3, 5, 7, 9, etc.)
         bool phraseMotifAscending = true;// Direction of original motif
         int phraseMotifVariation = 0;    // 0=original, 1=transposed, 2=inverted, 3=rhythmic
@@ -102,12 +98,10 @@ public:
         bool lastPhraseWasQuestion = true;  // Alternate question/answer
         int questionPeakMidi = 76;          // Highest note of question phrase
         int questionEndMidi = 72;           // Final note of question phrase
-        QVector<int> questionContour;       // Pitch contour of question (for answer to relate)
         int barsInCurrentQA = 0;            // Bars into current Q or A
         
         // ========== MELODIC SEQUENCE ==========
         // Tracks patterns for sequence development
-        QVector<int> lastMelodicPattern;    // Recent interval pattern
         int sequenceTransposition = 0;      // Current transposition level
         int sequenceRepetitions = 0;        // How many times pattern repeated
         
@@ -134,6 +128,33 @@ public:
         int phraseMelodicTargetMidi = 74;   // The melodic goal for this phrase
         int phraseVoicingType = 0;          // 0=Drop2, 1=Triad, 2=Dyad (consistent for phrase)
     };
+    static_assert(std::is_trivially_copyable<StateCore>::value, "StateCore must stay POD (copied on every beam fork)");
+
+    struct StateShared {
+        QVector<int> lastVoicingMidi;    // last realized MIDI notes (combined)
+        QString lastVoicingKey;          // ontology key of last voicing used
+        QString currentPhraseId;         // current phrase pattern ID
+
+        // Constraints state (needed by JointCandidateModel for feasibility evaluation)
+        virtuoso::constraints::PerformanceState perf;
+
+        QVector<int> lastLhMidi;         // LH rootless voicing (3-4 notes)
+        QVector<int> lastRhMidi;         // RH melodic dyad/triad (2-3 notes)
+        music::ChordSymbol lastChordForRh; // Track when chord changes for RH reset
+        QVector<int> phraseMotifPcs;     // 2-3 pitch classes of our motif (relative to chord)
+        QVector<int> questionContour;    // Pitch contour of question (for answer to relate)
+        QVector<int> lastMelodicPattern; // Recent interval pattern
+    };
+
+    // Snapshot handle (used by phrase planner, lookahead and pre-cache).
+    // Copying it is a POD copy plus one refcount bump; nothing is deep-copied.
+    struct PlannerState {
+        StateCore core;
+        std::shared_ptr<const StateShared> shared; // null = default-constructed sub-state
+
+        const StateShared& sub() const { return shared ? *shared : defaultShared(); }
+        static const StateShared& defaultShared();
+    };
 
     struct CcIntent {
         int cc = 64;
@@ -223,6 +244,8 @@ public:
     void reset();
     PlannerState snapshotState() const;
     void restoreState(const PlannerState& s);
+    // Field-wise equality (shared blocks compare by pointer first).
+    static bool sameState(const PlannerState& a, const PlannerState& b);
 
     void setVocabulary(const virtuoso::vocab::VocabularyRegistry* vocab) { m_vocab = vocab; }
     void setOntology(const virtuoso::ontology::OntologyRegistry* ont);
@@ -740,7 +763,13 @@ private:
     // ============= State =============
 
     virtuoso::constraints::PianoDriver m_driver;
-    PlannerState m_state;
+
+    // Flat mutable state the planning code reads/writes; converted to/from PlannerState at
+    // snapshotState()/restoreState().
+    struct WorkingState : StateCore, StateShared {};
+    WorkingState m_state;
+    // Last StateShared handed out by snapshotState() or taken by restoreState(); reused while unchanged.
+    mutable std::shared_ptr<const StateShared> m_sharedCache;
     
     // Thread safety: mutex protects all mutable state
     // Using shared_ptr because QMutex is not copyable and planners may be copied/moved
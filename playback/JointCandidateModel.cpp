@@ -1,7 +1,12 @@
 #include "playback/JointCandidateModel.h"
 
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QtGlobal>
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 #include "virtuoso/constraints/PianoDriver.h"
 
@@ -39,7 +44,7 @@ static PianoExtraCosts pianoExtraCosts(const JazzBalladPianoPlanner::PlannerStat
                                        const virtuoso::groove::TimeSignature& ts) {
     PianoExtraCosts out;
     virtuoso::constraints::PianoDriver driver;
-    virtuoso::constraints::PerformanceState st = startState.perf;
+    virtuoso::constraints::PerformanceState st = startState.sub().perf;
 
     // Collect CC64 events (sorted by time).
     struct CcEv { virtuoso::groove::GridPos pos; int value = 0; };
@@ -240,6 +245,54 @@ double JointCandidateModel::spacingPenalty(const QVector<virtuoso::engine::Agent
     return penalty;
 }
 
+namespace {
+
+// Combo cost terms that depend on a single agent's candidate (computed once per call, not per combo).
+struct AgentTerms {
+    double harmonic = 0.0;   // harmonicOutsidePenalty01
+    double voiceLeading = 0.0;
+    double rhythm = 0.0;
+    int noteCount = 0;
+    double bound = 0.0;      // this agent's exact share of every combo's separable cost
+};
+
+// Ranked combo result. Order is (cost, enumeration index) so evaluation order never changes the
+// winner: on equal cost the combo the original bi/pi/di loop reached first wins, as before.
+struct Scored {
+    double cost = std::numeric_limits<double>::infinity();
+    int index = std::numeric_limits<int>::max(); // (bi * P + pi) * D + di
+    double pianoExtra = 0.0;
+    virtuoso::solver::CostBreakdown bd{};
+};
+static bool scoredLess(const Scored& a, const Scored& b) {
+    if (a.cost != b.cost) return a.cost < b.cost;
+    return a.index < b.index;
+}
+
+// Separable bounds are summed in a different order than the real cost: allow for rounding.
+static double boundSlack(double cost) { return 1e-9 * (1.0 + qAbs(cost)); }
+
+// Keeps the K best Scored (K >= 1); threshold() is the cost a combo must beat to matter.
+class TopK {
+public:
+    explicit TopK(int k) : m_k(qMax(1, k)) { m_items.reserve(m_k + 1); }
+    bool full() const { return m_items.size() >= m_k; }
+    double threshold() const { return full() ? m_items.last().cost : std::numeric_limits<double>::infinity(); }
+    void offer(const Scored& s) {
+        if (full() && !scoredLess(s, m_items.last())) return;
+        auto it = std::upper_bound(m_items.begin(), m_items.end(), s, scoredLess);
+        m_items.insert(it, s);
+        if (m_items.size() > m_k) m_items.removeLast();
+    }
+    const QVector<Scored>& items() const { return m_items; }
+
+private:
+    int m_k;
+    QVector<Scored> m_items;
+};
+
+} // namespace
+
 JointCandidateModel::BestChoice JointCandidateModel::chooseBestCombo(const ScoringInputs& in,
                                                                      const QVector<BassCand>& bass,
                                                                      const QVector<PianoCand>& piano,
@@ -251,27 +304,39 @@ JointCandidateModel::BestChoice JointCandidateModel::chooseBestCombo(const Scori
     out.bestCost = std::numeric_limits<double>::infinity();
     if (bass.isEmpty() || piano.isEmpty() || drums.isEmpty()) return out;
 
-    auto comboCost = [&](const QVector<virtuoso::engine::AgentIntentNote>& bassNotes,
-                         const QVector<virtuoso::engine::AgentIntentNote>& pianoNotes,
-                         const QVector<virtuoso::engine::AgentIntentNote>& drumNotes,
-                         const QString& drumId,
-                         virtuoso::solver::CostBreakdown* outBd) -> double {
+    // Per-agent terms: harmonic/voice-leading/rhythm penalties only depend on one agent's notes.
+    auto termsFor = [&](const QVector<virtuoso::engine::AgentIntentNote>& notes, int prevCenter, bool harmonic) {
+        AgentTerms t;
+        t.noteCount = notes.size();
+        if (harmonic) t.harmonic = virtuoso::solver::harmonicOutsidePenalty01(notes, in.chord);
+        if (prevCenter >= 0) t.voiceLeading = virtuoso::solver::voiceLeadingPenalty(notes, prevCenter);
+        t.rhythm = virtuoso::solver::rhythmicInterestPenalty01(notes, in.ts);
+        return t;
+    };
+    // std::vector: read concurrently by the parallel search below (no implicit-sharing detach checks).
+    std::vector<AgentTerms> bassTerms;
+    std::vector<AgentTerms> pianoTerms;
+    std::vector<AgentTerms> drumTerms;
+    bassTerms.reserve(size_t(bass.size()));
+    pianoTerms.reserve(size_t(piano.size()));
+    drumTerms.reserve(size_t(drums.size()));
+    for (const auto& c : bass) bassTerms.push_back(termsFor(c.plan.notes, in.prevBassCenterMidi, true));
+    for (const auto& c : piano) pianoTerms.push_back(termsFor(c.plan.notes, in.prevPianoCenterMidi, true));
+    for (const auto& c : drums) drumTerms.push_back(termsFor(c.plan, -1, false));
+
+    // Same arithmetic, in the same order, as the original per-combo evaluation (bit-identical costs).
+    auto comboBreakdown = [&](int bi, int pi, int di) -> virtuoso::solver::CostBreakdown {
+        const AgentTerms& b = bassTerms[size_t(bi)];
+        const AgentTerms& p = pianoTerms[size_t(pi)];
+        const AgentTerms& d = drumTerms[size_t(di)];
+        const QString& drumId = drums[di].id;
         virtuoso::solver::CostBreakdown bd;
 
-        bd.harmonicStability =
-            0.65 * virtuoso::solver::harmonicOutsidePenalty01(bassNotes, in.chord) +
-            0.95 * virtuoso::solver::harmonicOutsidePenalty01(pianoNotes, in.chord);
-
-        bd.voiceLeadingDistance =
-            0.55 * virtuoso::solver::voiceLeadingPenalty(bassNotes, in.prevBassCenterMidi) +
-            0.55 * virtuoso::solver::voiceLeadingPenalty(pianoNotes, in.prevPianoCenterMidi);
+        bd.harmonicStability = 0.65 * b.harmonic + 0.95 * p.harmonic;
+        bd.voiceLeadingDistance = 0.55 * b.voiceLeading + 0.55 * p.voiceLeading;
+        bd.rhythmicInterest = 0.55 * b.rhythm + 0.65 * p.rhythm + 0.20 * d.rhythm;
 
-        bd.rhythmicInterest =
-            0.55 * virtuoso::solver::rhythmicInterestPenalty01(bassNotes, in.ts) +
-            0.65 * virtuoso::solver::rhythmicInterestPenalty01(pianoNotes, in.ts) +
-            0.20 * virtuoso::solver::rhythmicInterestPenalty01(drumNotes, in.ts);
-
-        const double totalNotes = double(bassNotes.size() + pianoNotes.size()) + 0.35 * double(drumNotes.size());
+        const double totalNotes = double(b.noteCount + p.noteCount) + 0.35 * double(d.noteCount);
         const double rc = qBound(0.0, in.weightsAvg.rhythm, 1.0);
         double target = 2.0 + 4.5 * rc;
         if (in.userSilence) target += qBound(0.0, in.weightsAvg.interactivity, 1.0) * 2.0;
@@ -293,9 +358,7 @@ JointCandidateModel::BestChoice JointCandidateModel::chooseBestCombo(const Scori
             }
             if (in.userBusy && drumId == "wet") bd.interactionFactor += 1.25;
         }
-
-        if (outBd) *outBd = bd;
-        return bd.total(in.weights);
+        return bd;
     };
 
     const bool havePlanned = (!plannedBassId.isEmpty() || !plannedPianoId.isEmpty() || !plannedDrumsId.isEmpty());
@@ -303,71 +366,200 @@ JointCandidateModel::BestChoice JointCandidateModel::chooseBestCombo(const Scori
         for (int bi = 0; bi < bass.size(); ++bi) if (bass[bi].id == plannedBassId) out.bestBi = bi;
         for (int pi = 0; pi < piano.size(); ++pi) if (piano[pi].id == plannedPianoId) out.bestPi = pi;
         for (int di = 0; di < drums.size(); ++di) if (drums[di].id == plannedDrumsId) out.bestDi = di;
-        (void)comboCost(bass[out.bestBi].plan.notes, piano[out.bestPi].plan.notes, drums[out.bestDi].plan, drums[out.bestDi].id, &out.bestBd);
+        out.bestBd = comboBreakdown(out.bestBi, out.bestPi, out.bestDi);
         out.bestCost = out.bestBd.total(in.weights) + spacingPenalty(bass[out.bestBi].plan.notes, piano[out.bestPi].plan.notes);
+        out.evaluatedCombos = 1;
         return out;
     }
 
-    out.combos.reserve(bass.size() * piano.size() * drums.size());
     // Variability (v2): higher variability => lower continuity penalties (more switching),
     // lower variability => stronger continuity (more "stay on a concept").
     const double var = qBound(0.0, in.weightsAvg.variability, 1.0);
     const double switchMul = qBound(0.20, 1.15 - 0.90 * var, 1.15);
-    for (int bi = 0; bi < bass.size(); ++bi) {
-        for (int pi = 0; pi < piano.size(); ++pi) {
-            for (int di = 0; di < drums.size(); ++di) {
-                virtuoso::solver::CostBreakdown bd;
-                double c = comboCost(bass[bi].plan.notes, piano[pi].plan.notes, drums[di].plan, drums[di].id, &bd);
-                c += spacingPenalty(bass[bi].plan.notes, piano[pi].plan.notes);
-
-                const double pianoExtra = piano[pi].pianistFeasibilityCost + piano[pi].pedalClarityCost + piano[pi].topLineContinuityCost;
-                c += pianoExtra;
-
-                if (!in.lastBassId.isEmpty() && in.lastBassId != bass[bi].id) c += in.bassSwitchPenalty * switchMul;
-                if (!in.lastPianoId.isEmpty() && in.lastPianoId != piano[pi].id) c += in.pianoSwitchPenalty * switchMul;
-                if (!in.lastDrumsId.isEmpty() && in.lastDrumsId != drums[di].id) c += in.drumsSwitchPenalty * switchMul;
-
-                // Piano library continuity (prefer staying within a phrase/story choice).
-                {
-                    const auto& perf = piano[pi].plan.performance;
-                    if (!in.lastPianoCompPhraseId.trimmed().isEmpty()
-                        && !perf.compPhraseId.trimmed().isEmpty()
-                        && perf.compPhraseId.trimmed() != in.lastPianoCompPhraseId.trimmed()) {
-                        c += in.pianoCompPhraseSwitchPenalty * switchMul;
-                    }
-                    if (!in.lastPianoTopLinePhraseId.trimmed().isEmpty()
-                        && !perf.toplinePhraseId.trimmed().isEmpty()
-                        && perf.toplinePhraseId.trimmed() != in.lastPianoTopLinePhraseId.trimmed()) {
-                        c += in.pianoTopLinePhraseSwitchPenalty * switchMul;
-                    }
-                    if (!in.lastPianoPedalId.trimmed().isEmpty()
-                        && !perf.pedalId.trimmed().isEmpty()
-                        && perf.pedalId.trimmed() != in.lastPianoPedalId.trimmed()) {
-                        c += in.pianoPedalSwitchPenalty * switchMul;
-                    }
-                    if (!in.lastPianoGestureId.trimmed().isEmpty()
-                        && !perf.gestureId.trimmed().isEmpty()
-                        && perf.gestureId.trimmed() != in.lastPianoGestureId.trimmed()) {
-                        c += in.pianoGestureSwitchPenalty * switchMul;
-                    }
-                }
 
-                if (in.inResponse) {
-                    if (drums[di].id == "wet") c -= in.responseWetBonus;
-                    if (piano[pi].id == "rich") c -= in.responsePianoRichBonus;
-                    if (bass[bi].id == "rich") c -= in.responseBassRichBonus;
-                }
+    // Piano library continuity (prefer staying within a phrase/story choice): which penalties apply.
+    struct PianoContinuity { bool comp = false, topline = false, pedal = false, gesture = false; };
+    auto switched = [](const QString& last, const QString& now) {
+        const QString l = last.trimmed();
+        const QString n = now.trimmed();
+        return !l.isEmpty() && !n.isEmpty() && n != l;
+    };
+    std::vector<PianoContinuity> pianoCont;
+    pianoCont.reserve(size_t(piano.size()));
+    for (const auto& c : piano) {
+        const auto& perf = c.plan.performance;
+        PianoContinuity pc;
+        pc.comp = switched(in.lastPianoCompPhraseId, perf.compPhraseId);
+        pc.topline = switched(in.lastPianoTopLinePhraseId, perf.toplinePhraseId);
+        pc.pedal = switched(in.lastPianoPedalId, perf.pedalId);
+        pc.gesture = switched(in.lastPianoGestureId, perf.gestureId);
+        pianoCont.push_back(pc);
+    }
 
-                out.combos.push_back({bi, pi, di, bass[bi].id, piano[pi].id, drums[di].id, c, pianoExtra, bd});
-                if (c < out.bestCost) {
-                    out.bestCost = c;
-                    out.bestBd = bd;
-                    out.bestBi = bi;
-                    out.bestPi = pi;
-                    out.bestDi = di;
+    const int P = piano.size();
+    const int D = drums.size();
+    auto evalCombo = [&](int bi, int pi, int di, double spacing) -> Scored {
+        Scored r;
+        r.index = (bi * P + pi) * D + di;
+        r.bd = comboBreakdown(bi, pi, di);
+        double c = r.bd.total(in.weights);
+        c += spacing;
+
+        r.pianoExtra = piano[pi].pianistFeasibilityCost + piano[pi].pedalClarityCost + piano[pi].topLineContinuityCost;
+        c += r.pianoExtra;
+
+        if (!in.lastBassId.isEmpty() && in.lastBassId != bass[bi].id) c += in.bassSwitchPenalty * switchMul;
+        if (!in.lastPianoId.isEmpty() && in.lastPianoId != piano[pi].id) c += in.pianoSwitchPenalty * switchMul;
+        if (!in.lastDrumsId.isEmpty() && in.lastDrumsId != drums[di].id) c += in.drumsSwitchPenalty * switchMul;
+
+        const PianoContinuity& pc = pianoCont[size_t(pi)];
+        if (pc.comp) c += in.pianoCompPhraseSwitchPenalty * switchMul;
+        if (pc.topline) c += in.pianoTopLinePhraseSwitchPenalty * switchMul;
+        if (pc.pedal) c += in.pianoPedalSwitchPenalty * switchMul;
+        if (pc.gesture) c += in.pianoGestureSwitchPenalty * switchMul;
+
+        if (in.inResponse) {
+            if (drums[di].id == "wet") c -= in.responseWetBonus;
+            if (piano[pi].id == "rich") c -= in.responsePianoRichBonus;
+            if (bass[bi].id == "rich") c -= in.responseBassRichBonus;
+        }
+        r.cost = c;
+        return r;
+    };
+    auto toComboEval = [&](const Scored& r) {
+        const int bi = r.index / (P * D);
+        const int pi = (r.index / D) % P;
+        const int di = r.index % D;
+        return ComboEval{bi, pi, di, bass[bi].id, piano[pi].id, drums[di].id, r.cost, r.pianoExtra, r.bd};
+    };
+    auto setBest = [&](const Scored& r) {
+        out.bestCost = r.cost;
+        out.bestBd = r.bd;
+        out.bestBi = r.index / (P * D);
+        out.bestPi = (r.index / D) % P;
+        out.bestDi = r.index % D;
+    };
+
+    // Explainability: score and return the full cartesian product, in enumeration order.
+    if (in.explainAllCombos) {
+        out.combos.reserve(bass.size() * P * D);
+        Scored best;
+        for (int bi = 0; bi < bass.size(); ++bi) {
+            for (int pi = 0; pi < P; ++pi) {
+                const double spacing = spacingPenalty(bass[bi].plan.notes, piano[pi].plan.notes);
+                for (int di = 0; di < D; ++di) {
+                    const Scored r = evalCombo(bi, pi, di, spacing);
+                    out.combos.push_back(toComboEval(r));
+                    if (scoredLess(r, best)) best = r;
                 }
             }
         }
+        setBest(best);
+        out.evaluatedCombos = out.combos.size();
+        return out;
+    }
+
+    // Branch and bound. Every cost term except interactionFactor (>= 0, weighted by w.interaction)
+    // and spacingPenalty (>= 0) is a sum of per-agent parts, so
+    //   cost(b,p,d) >= bound(b) + bound(p) + bound(d) [+ spacing(b,p)]
+    // and any combo whose bound already exceeds the K-th best cost found so far cannot be returned.
+    const bool interactionNonNegative = (in.weights.interaction >= 0.0);
+    for (int bi = 0; bi < bass.size(); ++bi) {
+        AgentTerms& t = bassTerms[size_t(bi)];
+        t.bound = in.weights.harmony * 0.65 * t.harmonic + in.weights.voiceLeading * 0.55 * t.voiceLeading +
+                  in.weights.rhythm * 0.55 * t.rhythm;
+        if (!in.lastBassId.isEmpty() && in.lastBassId != bass[bi].id) t.bound += in.bassSwitchPenalty * switchMul;
+        if (in.inResponse && bass[bi].id == "rich") t.bound -= in.responseBassRichBonus;
+    }
+    for (int pi = 0; pi < P; ++pi) {
+        AgentTerms& t = pianoTerms[size_t(pi)];
+        const PianoContinuity& pc = pianoCont[size_t(pi)];
+        t.bound = in.weights.harmony * 0.95 * t.harmonic + in.weights.voiceLeading * 0.55 * t.voiceLeading +
+                  in.weights.rhythm * 0.65 * t.rhythm;
+        t.bound += piano[pi].pianistFeasibilityCost + piano[pi].pedalClarityCost + piano[pi].topLineContinuityCost;
+        if (!in.lastPianoId.isEmpty() && in.lastPianoId != piano[pi].id) t.bound += in.pianoSwitchPenalty * switchMul;
+        if (pc.comp) t.bound += in.pianoCompPhraseSwitchPenalty * switchMul;
+        if (pc.topline) t.bound += in.pianoTopLinePhraseSwitchPenalty * switchMul;
+        if (pc.pedal) t.bound += in.pianoPedalSwitchPenalty * switchMul;
+        if (pc.gesture) t.bound += in.pianoGestureSwitchPenalty * switchMul;
+        if (in.inResponse && piano[pi].id == "rich") t.bound -= in.responsePianoRichBonus;
+    }
+    double minDrumBound = std::numeric_limits<double>::infinity();
+    for (int di = 0; di < D; ++di) {
+        AgentTerms& t = drumTerms[size_t(di)];
+        t.bound = in.weights.rhythm * 0.20 * t.rhythm;
+        if (!in.lastDrumsId.isEmpty() && in.lastDrumsId != drums[di].id) t.bound += in.drumsSwitchPenalty * switchMul;
+        if (in.inResponse && drums[di].id == "wet") t.bound -= in.responseWetBonus;
+        minDrumBound = qMin(minDrumBound, t.bound);
+    }
+    if (!interactionNonNegative) {
+        // Negative interaction weight: the separable bound is not a lower bound; score everything.
+        for (auto& t : bassTerms) t.bound = -std::numeric_limits<double>::infinity();
+    }
+
+    // Bass/piano pairs, cheapest bound first so good incumbents are found early.
+    struct Pair { int bi = 0; int pi = 0; double spacing = 0.0; double bound = 0.0; };
+    std::vector<Pair> pairs;
+    pairs.reserve(size_t(bass.size() * P));
+    for (int bi = 0; bi < bass.size(); ++bi) {
+        for (int pi = 0; pi < P; ++pi) {
+            Pair pr;
+            pr.bi = bi;
+            pr.pi = pi;
+            pr.spacing = spacingPenalty(bass[bi].plan.notes, piano[pi].plan.notes);
+            pr.bound = bassTerms[size_t(bi)].bound + pianoTerms[size_t(pi)].bound + pr.spacing;
+            pairs.push_back(pr);
+        }
+    }
+    std::stable_sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.bound < b.bound; });
+
+    const int keep = qMax(1, in.keepTopK);
+    auto searchSlice = [&](int first, int stride, int* evaluated) {
+        TopK top(keep);
+        for (size_t i = size_t(first); i < pairs.size(); i += size_t(stride)) {
+            const Pair& pr = pairs[i];
+            const double threshold = top.threshold();
+            if (pr.bound + minDrumBound > threshold + boundSlack(threshold)) break; // sorted: the rest is worse
+            for (int di = 0; di < D; ++di) {
+                const double t = top.threshold();
+                if (pr.bound + drumTerms[size_t(di)].bound > t + boundSlack(t)) continue;
+                top.offer(evalCombo(pr.bi, pr.pi, di, pr.spacing));
+                ++*evaluated;
+            }
+        }
+        return top.items();
+    };
+
+    // Large products (many candidates per agent): independent slices on the thread pool, merged in
+    // (cost, index) order, so the result does not depend on scheduling.
+    const int pairCount = int(pairs.size());
+    const int slices = (pairCount * D >= kParallelMinCombos)
+        ? qBound(1, QThreadPool::globalInstance()->maxThreadCount(), pairCount)
+        : 1;
+    QVector<Scored> merged;
+    if (slices > 1) {
+        std::vector<int> evaluated(size_t(slices), 0);
+        QVector<QFuture<QVector<Scored>>> futures;
+        futures.reserve(slices);
+        for (int s = 0; s < slices; ++s) {
+            futures.push_back(QtConcurrent::run([&searchSlice, &evaluated, s, slices]() {
+                return searchSlice(s, slices, &evaluated[size_t(s)]);
+            }));
+        }
+        TopK top(keep);
+        for (int s = 0; s < slices; ++s) {
+            for (const Scored& r : futures[s].result()) top.offer(r);
+            out.evaluatedCombos += evaluated[size_t(s)];
+        }
+        merged = top.items();
+    } else {
+        merged = searchSlice(0, 1, &out.evaluatedCombos);
+    }
+
+    if (!merged.isEmpty()) setBest(merged.first());
+    if (in.keepTopK > 0) {
+        out.combos.reserve(merged.size());
+        for (const Scored& r : merged) out.combos.push_back(toComboEval(r));
     }
     return out;
 }
@@ -114,6 +114,13 @@ public:
         double pianoTopLinePhraseSwitchPenalty = 0.08;
         double pianoPedalSwitchPenalty = 0.05;
         double pianoGestureSwitchPenalty = 0.03;
+
+        // What chooseBestCombo() returns in BestChoice::combos (the winner is the same either way):
+        //  - explainAllCombos: every combo, in bi/pi/di enumeration order (candidate_pool explainability);
+        //  - keepTopK > 0: the K cheapest combos, by (cost, enumeration order) (phrase beam expansion);
+        //  - neither: nothing, and dominated combos are never scored.
+        bool explainAllCombos = false;
+        int keepTopK = 0;
     };
 
     struct ComboEval {
@@ -134,10 +141,16 @@ public:
         int bestDi = 0;
         double bestCost = 0.0;
         virtuoso::solver::CostBreakdown bestBd{};
-        QVector<ComboEval> combos; // full cartesian product evaluation
+        QVector<ComboEval> combos; // see ScoringInputs::explainAllCombos / keepTopK
+        int evaluatedCombos = 0;   // combos actually scored (the rest were pruned by bound)
     };
 
-    // Evaluate all combinations and pick best (or follow a planned id triple).
+    // Products at least this large are searched on the global thread pool.
+    static constexpr int kParallelMinCombos = 512;
+
+    // Pick the cheapest bass x piano x drums combination (or follow a planned id triple).
+    // Branch and bound over separable per-agent lower bounds: returns exactly what scoring the full
+    // cartesian product would (same costs, ties go to the first combo in bi/pi/di order).
     static BestChoice chooseBestCombo(const ScoringInputs& in,
                                       const QVector<BassCand>& bass,
                                       const QVector<PianoCand>& piano,
@@ -10,6 +10,7 @@
 #include <QElapsedTimer>
 #include <QtGlobal>
 #include <algorithm>
+#include <memory>
 
 namespace playback {
 namespace {
@@ -21,13 +22,37 @@ static virtuoso::groove::TimeSignature timeSigFromModel(const chart::ChartModel&
     return ts;
 }
 
+// Choices form a persistent (immutable, tail-shared) list: every node forked from the same parent
+// shares the parent's history, so extending a beam entry never copies earlier steps.
+struct ChoiceLink {
+    StoryState::JointStepChoice choice;
+    std::shared_ptr<const ChoiceLink> prev;
+};
+
+// Forking a node is a POD copy plus refcount bumps: planner states share their sub-state blocks
+// (JazzBalladPianoPlanner::PlannerState) and choices share their history.
 struct BeamNode {
     double cost = 0.0;
     JazzBalladBassPlanner::PlannerState bassState;
     JazzBalladPianoPlanner::PlannerState pianoState;
     int lastBassCenter = 45;
     int lastPianoCenter = 72;
-    QVector<StoryState::JointStepChoice> choices;
+    std::shared_ptr<const ChoiceLink> choices;
+    int choiceCount = 0;
+
+    void pushChoice(StoryState::JointStepChoice c) {
+        auto link = std::make_shared<ChoiceLink>();
+        link->choice = std::move(c);
+        link->prev = std::move(choices);
+        choices = std::move(link);
+        ++choiceCount;
+    }
+    QVector<StoryState::JointStepChoice> materializeChoices() const {
+        QVector<StoryState::JointStepChoice> out(choiceCount);
+        int i = choiceCount;
+        for (const ChoiceLink* l = choices.get(); l && i > 0; l = l->prev.get()) out[--i] = l->choice;
+        return out;
+    }
 
     QString lastBassId;
     QString lastPianoId;
@@ -69,7 +94,7 @@ QVector<StoryState::JointStepChoice> JointPhrasePlanner::plan(const Inputs& p) {
     const int beamWidth = qBound(2, p.beamWidth, 12);
 
     // Determinism seed.
-    const quint32 detSeed = virtuoso::util::StableHash::fnv1a32((QString("ballad|") + in.stylePresetKey).toUtf8());
+    const quint32 detSeed = virtuoso::util::StableHash::Builder().ascii("ballad|").utf8(in.stylePresetKey).value();
 
     // Starting planner states (live continuity).
     const auto bassStart = in.bassPlanner->snapshotState();
@@ -92,17 +117,15 @@ QVector<StoryState::JointStepChoice> JointPhrasePlanner::plan(const Inputs& p) {
                                          /*keyWindowBars=*/8, *in.harmony);
         if (!look.haveCurrentChord || look.currentChord.noChord) {
             // If harmony is missing, keep previous choices and skip.
-            QVector<BeamNode> nextBeam = beam;
-            for (auto& n : nextBeam) {
+            for (auto& n : beam) {
                 StoryState::JointStepChoice c;
                 c.stepIndex = stepIndex;
                 c.bassId = n.lastBassId;
                 c.pianoId = n.lastPianoId;
                 c.drumsId = n.lastDrumsId;
                 c.costTag = "no_chord";
-                n.choices.push_back(c);
+                n.pushChoice(std::move(c));
             }
-            beam = nextBeam;
             continue;
         }
 
@@ -402,6 +425,8 @@ QVector<StoryState::JointStepChoice> JointPhrasePlanner::plan(const Inputs& p) {
             si.lastPianoId = node.lastPianoId;
             si.lastDrumsId = node.lastDrumsId;
             si.inResponse = inResponse;
+            // At most beamWidth children of one node can survive the cut below.
+            si.keepTopK = beamWidth;
 
             const auto scored = JointCandidateModel::chooseBestCombo(si, bassCands, pianoCands, drumCands);
 
@@ -434,15 +459,15 @@ QVector<StoryState::JointStepChoice> JointPhrasePlanner::plan(const Inputs& p) {
                 choice.pianoPlan = pianoCands[pi].plan;
                 choice.bassStateAfter = bassCands[bi].nextState;
                 choice.pianoStateAfter = pianoCands[pi].nextState;
-                nn.choices.push_back(choice);
+                nn.pushChoice(std::move(choice));
                 nextBeam.push_back(std::move(nn));
             }
         }
 
-        // Keep top beamWidth nodes.
-        std::sort(nextBeam.begin(), nextBeam.end(), [](const BeamNode& a, const BeamNode& b) { return a.cost < b.cost; });
+        // Keep top beamWidth nodes. Stable: equal-cost nodes keep parent/combo order, so the cut is deterministic.
+        std::stable_sort(nextBeam.begin(), nextBeam.end(), [](const BeamNode& a, const BeamNode& b) { return a.cost < b.cost; });
         if (nextBeam.size() > beamWidth) nextBeam.resize(beamWidth);
-        beam = nextBeam;
+        beam = std::move(nextBeam);
     }
 
     if (beam.isEmpty()) {
@@ -451,8 +476,8 @@ QVector<StoryState::JointStepChoice> JointPhrasePlanner::plan(const Inputs& p) {
         return {};
     }
     // Best node is beam[0] after sort above at last iteration.
-    std::sort(beam.begin(), beam.end(), [](const BeamNode& a, const BeamNode& b) { return a.cost < b.cost; });
-    const auto out = beam.front().choices;
+    std::stable_sort(beam.begin(), beam.end(), [](const BeamNode& a, const BeamNode& b) { return a.cost < b.cost; });
+    const auto out = beam.front().materializeChoices();
     // IMPORTANT: planning must not mutate live planner state.
     in.bassPlanner->restoreState(bassStart);
     in.pianoPlanner->restoreState(pianoStart);
@@ -291,7 +291,7 @@ QString LookaheadPlanner::buildLookaheadPlanJson(const Inputs& in, int stepNow,
             dc.playbackBarIndex = playbackBarIndex;
             dc.beatInBar = beatInBar;
             dc.structural = structural;
-            const quint32 detSeed = virtuoso::util::StableHash::fnv1a32((QString("ballad|") + in.stylePresetKey).toUtf8());
+            const quint32 detSeed = virtuoso::util::StableHash::Builder().ascii("ballad|").utf8(in.stylePresetKey).value();
             dc.determinismSeed = detSeed ^ 0xD00D'BEEFu;
             dc.phraseBars = phraseBars;
             dc.barInPhrase = barInPhrase;
@@ -307,7 +307,7 @@ QString LookaheadPlanner::buildLookaheadPlanJson(const Inputs& in, int stepNow,
 
         // Bass + piano
         if (!chord.noChord) {
-            const quint32 detSeed = virtuoso::util::StableHash::fnv1a32((QString("ballad|") + in.stylePresetKey).toUtf8());
+            const quint32 detSeed = virtuoso::util::StableHash::Builder().ascii("ballad|").utf8(in.stylePresetKey).value();
 
             JazzBalladBassPlanner::Context bc;
             bc.bpm = in.bpm;
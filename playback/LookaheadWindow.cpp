@@ -17,6 +17,44 @@ static int normalizePcLocal(int pc) {
 
 } // namespace
 
+bool lookaheadChordChanges(const music::ChordSymbol& next, const music::ChordSymbol& current) {
+    return !HarmonyContext::sameChordKey(next, current);
+}
+
+LookaheadPhrase lookaheadPhrase(int phraseBars, int playbackBarIndex) {
+    LookaheadPhrase p;
+    p.phraseBars = qBound(4, phraseBars, 8);
+    p.barInPhrase = qMax(0, playbackBarIndex) % p.phraseBars;
+    p.phraseEndBar = (p.barInPhrase == (p.phraseBars - 1));
+    p.phraseSetupBar = (p.phraseBars > 1) ? (p.barInPhrase == (p.phraseBars - 2)) : false;
+    return p;
+}
+
+double lookaheadCadence01(const LookaheadPhrase& phrase,
+                          bool chordIsNew,
+                          const LookaheadNextChord& next,
+                          const QString& chordFunction,
+                          int keyPc,
+                          virtuoso::theory::KeyMode keyMode,
+                          const HarmonyContext& harmony) {
+    double cadence01 = 0.0;
+    if (phrase.phraseEndBar) cadence01 = (next.nextChanges || chordIsNew) ? 1.0 : 0.65;
+    else if (phrase.phraseSetupBar) cadence01 = (next.nextChanges ? 0.60 : 0.35);
+
+    // If we can see a Dominant->Tonic move soon, strengthen cadence.
+    if (next.haveNextChord && next.beatsUntilChange > 0 && next.beatsUntilChange <= 2) {
+        const music::ChordSymbol& n = *next.nextChord;
+        const auto* defN = harmony.chordDefForSymbol(n);
+        if (defN && n.rootPc >= 0) {
+            const auto hn = virtuoso::theory::analyzeChordInKey(keyPc, keyMode, n.rootPc, *defN);
+            if (chordFunction == "Dominant" && hn.function == "Tonic") {
+                cadence01 = qMax(cadence01, 1.0);
+            }
+        }
+    }
+    return cadence01;
+}
+
 // NOTE: This is implemented as a free function in this TU to keep call-sites simple.
 // It computes a *single* lookahead snapshot (used by runtime scheduling).
 LookaheadWindow buildLookaheadWindow(const chart::ChartModel& model,
@@ -45,11 +83,10 @@ LookaheadWindow buildLookaheadWindow(const chart::ChartModel& model,
     const int endStep = qMin(total, w.startStep + w.horizonBars * beatsPerBar);
 
     // Phrase model: adaptive 4–8 bars (provided by caller).
-    w.phraseBars = qBound(4, phraseBars, 8);
-    const int playbackBarIndex = w.startStep / beatsPerBar;
-    w.barInPhrase = (w.phraseBars > 0) ? (qMax(0, playbackBarIndex) % w.phraseBars) : 0;
-    w.phraseEndBar = (w.phraseBars > 0) ? (w.barInPhrase == (w.phraseBars - 1)) : false;
-    const bool phraseSetupBar = (w.phraseBars > 1) ? (w.barInPhrase == (w.phraseBars - 2)) : false;
+    const LookaheadPhrase phrase = lookaheadPhrase(phraseBars, w.startStep / beatsPerBar);
+    w.phraseBars = phrase.phraseBars;
+    w.barInPhrase = phrase.barInPhrase;
+    w.phraseEndBar = phrase.phraseEndBar;
 
     // Current chord (mutating harmony state is OK for runtime; this is the single source of chord truth).
     {
@@ -58,40 +95,17 @@ LookaheadWindow buildLookaheadWindow(const chart::ChartModel& model,
     }
 
     // Next chord boundary: scan for explicit changes within the current bar, fallback to next barline.
-    w.haveNextChord = false;
-    w.beatsUntilChange = 0;
-    if (w.haveCurrentChord) {
-        const int beatInBar = w.startStep % beatsPerBar;
-        const int maxLook = qMax(1, beatsPerBar - beatInBar);
-        for (int k = 1; k <= maxLook; ++k) {
-            const int stepFwd = w.startStep + k;
-            if (stepFwd >= total) break;
-            const int cellNext = sequence[stepFwd % seqLen];
+    music::ChordSymbol parsedNext;
+    const LookaheadNextChord next = findLookaheadNextChord(
+        w.currentChord, w.haveCurrentChord, w.startStep, beatsPerBar, total, [&](int step) -> const music::ChordSymbol* {
             bool explicitNext = false;
-            const music::ChordSymbol cand = harmony.parseCellChordNoState(model, cellNext, w.currentChord, &explicitNext);
-            if (!explicitNext || cand.noChord) continue;
-            if (!HarmonyContext::sameChordKey(cand, w.currentChord)) {
-                w.nextChord = cand;
-                w.haveNextChord = true;
-                w.beatsUntilChange = k;
-                break;
-            }
-        }
-        if (!w.haveNextChord) {
-            const int stepNextBar = w.startStep + (beatsPerBar - beatInBar);
-            if (stepNextBar < total) {
-                const int cellNext = sequence[stepNextBar % seqLen];
-                bool explicitNext = false;
-                w.nextChord = harmony.parseCellChordNoState(model, cellNext, w.currentChord, &explicitNext);
-                w.haveNextChord = explicitNext || (w.nextChord.rootPc >= 0);
-                if (w.nextChord.noChord) w.haveNextChord = false;
-                w.beatsUntilChange = beatsPerBar - beatInBar;
-            }
-        }
-    }
-
-    w.nextChanges = w.haveNextChord && !w.nextChord.noChord && (w.nextChord.rootPc >= 0) &&
-                    ((w.nextChord.rootPc != w.currentChord.rootPc) || (w.nextChord.bassPc != w.currentChord.bassPc));
+            parsedNext = harmony.parseCellChordNoState(model, sequence[step % seqLen], w.currentChord, &explicitNext);
+            return explicitNext ? &parsedNext : nullptr;
+        });
+    w.haveNextChord = next.haveNextChord;
+    if (next.nextChord) w.nextChord = *next.nextChord;
+    w.beatsUntilChange = next.beatsUntilChange;
+    w.nextChanges = next.nextChanges;
 
     // Sliding-window key estimate for this bar.
     const int barIdx = (sequence[w.startStep % seqLen]) / 4;
@@ -111,21 +125,7 @@ LookaheadWindow buildLookaheadWindow(const chart::ChartModel& model,
         }
     }
 
-    // Cadence heuristic: phrase end/setup with "nextChanges" boost + functional cadence boost.
-    w.cadence01 = 0.0;
-    if (w.phraseEndBar) w.cadence01 = (w.nextChanges || w.chordIsNew) ? 1.0 : 0.65;
-    else if (phraseSetupBar) w.cadence01 = (w.nextChanges ? 0.60 : 0.35);
-
-    // If we can see a Dominant->Tonic move soon, strengthen cadence.
-    if (w.haveNextChord && w.beatsUntilChange > 0 && w.beatsUntilChange <= 2) {
-        const auto* defN = harmony.chordDefForSymbol(w.nextChord);
-        if (defN && w.nextChord.rootPc >= 0) {
-            const auto hn = virtuoso::theory::analyzeChordInKey(keyPc, w.key.mode, w.nextChord.rootPc, *defN);
-            if (w.chordFunction == "Dominant" && hn.function == "Tonic") {
-                w.cadence01 = qMax(w.cadence01, 1.0);
-            }
-        }
-    }
+    w.cadence01 = lookaheadCadence01(phrase, w.chordIsNew, next, w.chordFunction, keyPc, w.key.mode, harmony);
 
     // Modulation detection (lightweight): compare current tonic to a mid-horizon tonic estimate.
     {
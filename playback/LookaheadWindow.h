@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <QVector>
+#include <QtGlobal>
 
 #include "music/ChordSymbol.h"
 #include "playback/HarmonyTypes.h"
@@ -43,6 +44,84 @@ struct LookaheadWindow {
     double cadence01 = 0.0;
 };
 
+// --- Window rules shared with PrePlaybackBuilder::buildContexts ---
+// buildLookaheadWindow() reads chart cells through a live HarmonyContext; the pre-playback cache
+// computes every step's window from per-cell tables. Both go through these rules, so the cache
+// cannot drift from what the live planner sees.
+
+// Next-chord boundary after the current step.
+struct LookaheadNextChord {
+    bool haveNextChord = false;
+    const music::ChordSymbol* nextChord = nullptr; // the current chord or an explicitChordAt() result
+    int beatsUntilChange = 0;
+    bool nextChanges = false;
+};
+
+// True when `next` differs from `current` as a chord (HarmonyContext::sameChordKey).
+bool lookaheadChordChanges(const music::ChordSymbol& next, const music::ChordSymbol& current);
+
+// First explicit chord change within the current bar, else whatever the next barline holds
+// (the current chord carries on when that cell is not explicit). explicitChordAt(step) returns the
+// explicit chord at that sequence step, or nullptr (empty, unparseable, placeholder, no cell); its
+// result only needs to stay valid until the next call.
+template <typename ExplicitChordAt>
+LookaheadNextChord findLookaheadNextChord(const music::ChordSymbol& current,
+                                          bool haveCurrentChord,
+                                          int step,
+                                          int beatsPerBar,
+                                          int totalSteps,
+                                          const ExplicitChordAt& explicitChordAt) {
+    LookaheadNextChord n;
+    if (!haveCurrentChord) return n;
+    const int beatInBar = step % beatsPerBar;
+    const int maxLook = qMax(1, beatsPerBar - beatInBar);
+    for (int k = 1; k <= maxLook; ++k) {
+        const int stepFwd = step + k;
+        if (stepFwd >= totalSteps) break;
+        const music::ChordSymbol* cand = explicitChordAt(stepFwd);
+        if (!cand || cand->noChord) continue;
+        if (lookaheadChordChanges(*cand, current)) {
+            n.nextChord = cand;
+            n.haveNextChord = true;
+            n.beatsUntilChange = k;
+            break;
+        }
+    }
+    if (!n.haveNextChord) {
+        const int stepNextBar = step + (beatsPerBar - beatInBar);
+        if (stepNextBar < totalSteps) {
+            const music::ChordSymbol* cand = explicitChordAt(stepNextBar);
+            n.nextChord = cand ? cand : &current;
+            n.haveNextChord = (cand != nullptr) || (n.nextChord->rootPc >= 0);
+            if (n.nextChord->noChord) n.haveNextChord = false;
+            n.beatsUntilChange = beatsPerBar - beatInBar;
+        }
+    }
+    const music::ChordSymbol* next = n.nextChord;
+    n.nextChanges = n.haveNextChord && !next->noChord && (next->rootPc >= 0) &&
+                    ((next->rootPc != current.rootPc) || (next->bassPc != current.bassPc));
+    return n;
+}
+
+// Phrase model: adaptive 4-8 bars (provided by caller).
+struct LookaheadPhrase {
+    int phraseBars = 4;
+    int barInPhrase = 0;
+    bool phraseEndBar = false;
+    bool phraseSetupBar = false;
+};
+LookaheadPhrase lookaheadPhrase(int phraseBars, int playbackBarIndex);
+
+// Cadence heuristic: phrase end/setup with "nextChanges" boost, raised to 1 when a
+// Dominant -> Tonic move is at most two beats away.
+double lookaheadCadence01(const LookaheadPhrase& phrase,
+                          bool chordIsNew,
+                          const LookaheadNextChord& next,
+                          const QString& chordFunction,
+                          int keyPc,
+                          virtuoso::theory::KeyMode keyMode,
+                          const HarmonyContext& harmony);
+
 // Computes a canonical sliding-window lookahead snapshot for runtime scheduling.
 LookaheadWindow buildLookaheadWindow(const chart::ChartModel& model,
                                      const QVector<int>& sequence,
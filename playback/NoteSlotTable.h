@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+#include <array>
+
+namespace playback {
+
+// Per-note state keyed by MIDI note number (0-127): 128 preallocated slots
+// plus a 128-bit occupancy bitmap. Same isEmpty/size/contains/find/insert/
+// erase/remove/clear/key()-value() iteration surface as the QHash<int, T> it
+// replaces in ScaleSnapProcessor, but a lookup is an array index, nothing
+// allocates, and iteration visits only occupied slots, in ascending note
+// order. Erasing the entry an iterator points at does not invalidate it.
+// Not synchronized: the table belongs to one thread.
+template <typename T>
+class NoteSlotTable {
+    template <typename Table, typename Value>
+    class Iter {
+    public:
+        Iter(Table* table, quint64 lo, quint64 hi) : m_table(table), m_rest{lo, hi} { seek(); }
+        int key() const { return m_key; }
+        Value& value() const { return m_table->m_slots[size_t(m_key)]; }
+        Value& operator*() const { return value(); }
+        Value* operator->() const { return &value(); }
+        Iter& operator++() {
+            quint64& word = m_rest[m_key >> 6];
+            word &= word - 1;
+            seek();
+            return *this;
+        }
+        bool operator==(const Iter& o) const { return m_key == o.m_key; }
+        bool operator!=(const Iter& o) const { return m_key != o.m_key; }
+
+    private:
+        void seek() {
+            if (m_rest[0]) m_key = int(qCountTrailingZeroBits(m_rest[0]));
+            else if (m_rest[1]) m_key = 64 + int(qCountTrailingZeroBits(m_rest[1]));
+            else m_key = -1;
+        }
+        Table* m_table;
+        quint64 m_rest[2];
+        int m_key = -1;
+    };
+
+public:
+    static constexpr int kSlots = 128;
+    using iterator = Iter<NoteSlotTable, T>;
+    using const_iterator = Iter<const NoteSlotTable, const T>;
+
+    bool isEmpty() const { return (m_bits[0] | m_bits[1]) == 0; }
+    int size() const { return m_size; }
+    bool contains(int note) const { return inRange(note) && ((m_bits[note >> 6] >> (note & 63)) & 1u); }
+
+    iterator begin() { return iterator(this, m_bits[0], m_bits[1]); }
+    iterator end() { return iterator(this, 0, 0); }
+    const_iterator begin() const { return const_iterator(this, m_bits[0], m_bits[1]); }
+    const_iterator end() const { return const_iterator(this, 0, 0); }
+    const_iterator constBegin() const { return begin(); }
+    const_iterator constEnd() const { return end(); }
+
+    iterator find(int note) {
+        if (!contains(note)) return end();
+        // Iterator positioned on `note`: drop the lower occupied slots.
+        const quint64 lowMask = ~quint64(0) << (note & 63);
+        return (note < 64) ? iterator(this, m_bits[0] & lowMask, m_bits[1])
+                           : iterator(this, 0, m_bits[1] & lowMask);
+    }
+
+    // Overwrites an existing entry. Out-of-range notes are ignored.
+    void insert(int note, const T& value) {
+        if (!inRange(note)) return;
+        m_slots[size_t(note)] = value;
+        quint64& word = m_bits[note >> 6];
+        const quint64 bit = quint64(1) << (note & 63);
+        if (!(word & bit)) {
+            word |= bit;
+            ++m_size;
+        }
+    }
+
+    bool remove(int note) {
+        if (!contains(note)) return false;
+        m_bits[note >> 6] &= ~(quint64(1) << (note & 63));
+        --m_size;
+        return true;
+    }
+    void erase(const iterator& it) { remove(it.key()); }
+
+    void clear() {
+        m_bits[0] = m_bits[1] = 0;
+        m_size = 0;
+    }
+
+private:
+    static bool inRange(int note) { return note >= 0 && note < kSlots; }
+
+    std::array<T, kSlots> m_slots{};
+    quint64 m_bits[2] = {0, 0};
+    int m_size = 0;
+};
+
+} // namespace playback
@@ -2,6 +2,10 @@
 #include <algorithm>
 #include <cmath>
 #include <QDebug>
+#include <QLoggingCategory>
+
+// Per-note tracing; enable with QT_LOGGING_RULES="playback.conformance.debug=true".
+Q_LOGGING_CATEGORY(lcConformance, "playback.conformance", QtInfoMsg)
 
 namespace playback {
 
@@ -19,10 +23,13 @@ GravityResult PitchConformanceEngine::calculateGravity(int pitchClass, const Act
     GravityResult result;
     pitchClass = ChordOntology::normalizePc(pitchClass);
 
-    result.tier = ChordOntology::instance().getTier(pitchClass, chord);
-    result.isAvoidNote = chord.isAvoidNote(pitchClass);
+    const quint16 bit = quint16(1u << pitchClass);
+    result.tier = (chord.tier1Absolute.mask() & bit) ? 1
+                : (chord.tier2Absolute.mask() & bit) ? 2
+                : (chord.tier3Absolute.mask() & bit) ? 3 : 4;
+    result.isAvoidNote = (chord.avoidAbsolute.mask() & bit) != 0;
 
-    qDebug() << "PitchConformance: calculateGravity pc=" << pitchClass
+    qCDebug(lcConformance) << "PitchConformance: calculateGravity pc=" << pitchClass
              << "tier=" << result.tier << "isAvoid=" << result.isAvoidNote
              << "chord.tier1 size=" << chord.tier1Absolute.size();
 
@@ -35,22 +42,11 @@ GravityResult PitchConformanceEngine::calculateGravity(int pitchClass, const Act
     }
 
     // Find nearest T1 pitch (chord tone) - STRICT: only snap to chord tones
-    int bestTarget = -1;
-    int bestDistance = 7;  // Max is 6 semitones
-
-    // Search T1 only (chord tones are the only valid snap targets)
-    for (int target : chord.tier1Absolute) {
-        int dist = ChordOntology::minDistance(pitchClass, target);
-        if (dist < bestDistance) {
-            bestDistance = dist;
-            bestTarget = target;
-        }
-    }
+    int bestTarget = ChordOntology::nearestPc(pitchClass, chord.tier1Absolute);
 
     // Fallback if no target found (shouldn't happen with valid chord)
     if (bestTarget < 0) {
         bestTarget = chord.rootPc;
-        bestDistance = ChordOntology::minDistance(pitchClass, bestTarget);
     }
 
     result.nearestTarget = bestTarget;
@@ -116,21 +112,21 @@ ConformanceResult PitchConformanceEngine::selectBehavior(
     // T1 (chord tones): Always allowed - these are home
     if (gravity.tier == 1) {
         result.behavior = ConformanceBehavior::ALLOW;
-        qDebug() << "ALLOW T1 (chord tone): note" << inputPitch << "pc" << (inputPitch % 12);
+        qCDebug(lcConformance) << "ALLOW T1 (chord tone): note" << inputPitch << "pc" << (inputPitch % 12);
         return result;
     }
 
     // T2 (tensions): Allowed - 9th, 11th, 13th are color tones
     if (gravity.tier == 2) {
         result.behavior = ConformanceBehavior::ALLOW;
-        qDebug() << "ALLOW T2 (tension): note" << inputPitch << "pc" << (inputPitch % 12);
+        qCDebug(lcConformance) << "ALLOW T2 (tension): note" << inputPitch << "pc" << (inputPitch % 12);
         return result;
     }
 
     // T3 (scale tones): Allowed - these are passing tones
     if (gravity.tier == 3) {
         result.behavior = ConformanceBehavior::ALLOW;
-        qDebug() << "ALLOW T3 (scale tone): note" << inputPitch << "pc" << (inputPitch % 12);
+        qCDebug(lcConformance) << "ALLOW T3 (scale tone): note" << inputPitch << "pc" << (inputPitch % 12);
         return result;
     }
 
@@ -142,7 +138,7 @@ ConformanceResult PitchConformanceEngine::selectBehavior(
         result.outputPitch = inputPitch;
         result.snapTargetPitch = targetPitch;
         result.snapDelayMs = 30.0f;  // Quick grace note
-        qDebug() << "TIMED_SNAP T4 (up): note" << inputPitch << "->" << targetPitch
+        qCDebug(lcConformance) << "TIMED_SNAP T4 (up): note" << inputPitch << "->" << targetPitch
                  << "after 30ms";
         return result;
     }
@@ -151,7 +147,7 @@ ConformanceResult PitchConformanceEngine::selectBehavior(
     result.behavior = ConformanceBehavior::SNAP;
     result.outputPitch = targetPitch;
     result.snapTargetPitch = targetPitch;
-    qDebug() << "SNAP T4 (down): note" << inputPitch << "->" << targetPitch;
+    qCDebug(lcConformance) << "SNAP T4 (down): note" << inputPitch << "->" << targetPitch;
     return result;
 }
 
@@ -173,16 +169,17 @@ ConformanceResult PitchConformanceEngine::conformPitch(
 // ============================================================================
 
 int PitchConformanceEngine::conformHarmonyPitch(int rawPitch, const ActiveChord& chord) const {
-    int pc = ChordOntology::normalizePc(rawPitch);
-    GravityResult gravity = calculateGravity(pc, chord);
+    const int pc = ChordOntology::normalizePc(rawPitch);
 
     // Harmony always snaps to valid pitches (no bend option)
-    if (gravity.tier <= 2) {
+    if ((chord.tier1Absolute.mask() | chord.tier2Absolute.mask()) & (1u << pc)) {
         return rawPitch;  // Already valid (T1 or T2)
     }
 
-    // Snap to nearest chord tone or tension
-    return ChordOntology::findNearestInOctave(rawPitch, gravity.nearestTarget);
+    // Snap to nearest chord tone (same target calculateGravity picks)
+    int target = ChordOntology::nearestPc(pc, chord.tier1Absolute);
+    if (target < 0) target = chord.rootPc;
+    return ChordOntology::findNearestInOctave(rawPitch, target);
 }
 
 // ============================================================================
@@ -13,6 +13,7 @@
 #include <QtConcurrent>
 #include <QFuture>
 #include <QMutex>
+#include <QThreadPool>
 
 namespace playback {
 namespace {
@@ -31,9 +32,93 @@ static int adaptivePhraseBars(int bpm) {
 static int clampBassCenterMidi(int v) { return qBound(28, v, 67); }
 static int clampPianoCenterMidi(int v) { return qBound(48, v, 96); }
 
+// --- Phase 1 lookup tables (read-only once built; shared by the parallel step loop) ---
+
+// One entry per chart cell referenced by the sequence.
+struct ContextCellChord {
+    bool resolved = false;
+    bool exists = false;     // chart has a cell at this flattened index
+    bool isExplicit = false; // non-empty, parseable, not a placeholder
+    music::ChordSymbol chord;
+    const virtuoso::ontology::ChordDef* def = nullptr;
+};
+
+// Where a step's current chord comes from (HarmonyContext last-chord carry-over, replayed).
+static constexpr int kNoChordCell = -2;
+static constexpr int kSavedChordCell = -1; // HarmonyContext's last chord before the build
+struct ContextStepChord {
+    int chordCell = kNoChordCell; // >= 0: cell index into the ContextCellChord table
+    bool isNew = false;
+};
+
+struct ContextBarKey {
+    int bar = 0;
+    LocalKeyEstimate key;
+};
+
+static const music::ChordSymbol* chordForCell(int chordCell,
+                                              const QVector<ContextCellChord>& cells,
+                                              const music::ChordSymbol& savedChord) {
+    if (chordCell == kSavedChordCell) return &savedChord;
+    if (chordCell >= 0) return &cells[chordCell].chord;
+    return nullptr;
+}
+
+// --- Incremental rebuild (PrePlaybackBuilder::rebuild) ---
+
+static bool sameContext(const PreComputedContext& a, const PreComputedContext& b) {
+    return a.stepIndex == b.stepIndex && a.barIndex == b.barIndex && a.beatInBar == b.beatInBar &&
+           a.haveChord == b.haveChord && music::sameChordSymbol(a.chord, b.chord) && a.chordText == b.chordText &&
+           a.chordIsNew == b.chordIsNew && a.haveNextChord == b.haveNextChord &&
+           music::sameChordSymbol(a.nextChord, b.nextChord) && a.nextChanges == b.nextChanges &&
+           a.beatsUntilChange == b.beatsUntilChange && a.keyTonicPc == b.keyTonicPc && a.keyMode == b.keyMode &&
+           a.scaleKey == b.scaleKey && a.scaleName == b.scaleName && a.roman == b.roman &&
+           a.chordFunction == b.chordFunction && a.phraseBars == b.phraseBars && a.barInPhrase == b.barInPhrase &&
+           a.phraseEndBar == b.phraseEndBar && a.cadence01 == b.cadence01 && a.chordDef == b.chordDef;
+}
+
+static bool samePerf(const virtuoso::constraints::PerformanceState& a, const virtuoso::constraints::PerformanceState& b) {
+    return a.heldNotes == b.heldNotes && a.ints == b.ints;
+}
+
+static bool sameBassState(const JazzBalladBassPlanner::PlannerState& a, const JazzBalladBassPlanner::PlannerState& b) {
+    return samePerf(a.perf, b.perf) && a.lastMidi == b.lastMidi && a.walkPosBlockStartBar == b.walkPosBlockStartBar &&
+           a.walkPosMidi == b.walkPosMidi && a.artInit == b.artInit && a.art == b.art &&
+           a.lastArtBar == b.lastArtBar && a.haveSentArt == b.haveSentArt && a.sentArt == b.sentArt &&
+           a.prevMidiBeforeLast == b.prevMidiBeforeLast;
+}
+
+static bool samePianoState(const JazzBalladPianoPlanner::PlannerState& a, const JazzBalladPianoPlanner::PlannerState& b) {
+    return JazzBalladPianoPlanner::sameState(a, b);
+}
+
+// Step-independent inputs of each agent lane. If a lane's hash differs from the previous cache's,
+// none of that lane's old plans can be reused.
+static quint32 laneSettingsHash(const PrePlaybackBuilder::Inputs& in, const QString& agent, int channel, const QString& extra) {
+    const auto ts = timeSigFromModel(*in.model);
+    return virtuoso::util::StableHash::fnv1a32(QString("lane|%1|%2|%3/%4|%5|%6|%7|%8")
+                                                   .arg(agent)
+                                                   .arg(in.bpm)
+                                                   .arg(ts.num)
+                                                   .arg(ts.den)
+                                                   .arg(in.stylePresetKey)
+                                                   .arg(channel)
+                                                   .arg(QString::number(in.agentEnergyMult.value(agent, 1.0), 'g', 17))
+                                                   .arg(extra)
+                                                   .toUtf8());
+}
+
 } // namespace
 
 PrePlaybackCache PrePlaybackBuilder::build(const Inputs& in, ProgressCallback progress) {
+    return buildImpl(in, nullptr, progress);
+}
+
+PrePlaybackCache PrePlaybackBuilder::rebuild(const Inputs& in, const PrePlaybackCache& previous, ProgressCallback progress) {
+    return buildImpl(in, previous.canRebuildFrom() ? &previous : nullptr, progress);
+}
+
+PrePlaybackCache PrePlaybackBuilder::buildImpl(const Inputs& in, const PrePlaybackCache* previous, ProgressCallback progress) {
     QElapsedTimer buildTimer;
     buildTimer.start();
     
@@ -72,6 +157,30 @@ PrePlaybackCache PrePlaybackBuilder::build(const Inputs& in, ProgressCallback pr
     cache.contextBuildMs = static_cast<int>(contextTimer.elapsed());
     qInfo().noquote() << QString("    Context built in %1ms (%2 steps)")
         .arg(cache.contextBuildMs).arg(contexts.size());
+
+    cache.bassSettingsHash = laneSettingsHash(in, "Bass", in.chBass, QString());
+    cache.pianoSettingsHash = laneSettingsHash(in, "Piano", in.chPiano,
+        (in.pianoPlanner && in.pianoPlanner->useOrchestratorEnabled()) ? "orch" : "legacy");
+    cache.drumsSettingsHash = laneSettingsHash(in, "Drums", in.chDrums, QString());
+
+    // Incremental rebuild: which bars' contexts changed, and which lanes kept their settings.
+    // The legacy (non-orchestrator) piano path keeps process-wide voicing memory, so its output is not a
+    // function of PlannerState and cannot be resumed mid-song: that lane is always replanned in full.
+    QVector<bool> barChanged;
+    BranchReuse reuse;
+    if (previous) {
+        barChanged.fill(false, (contexts.size() + cache.beatsPerBar - 1) / cache.beatsPerBar);
+        for (int i = 0; i < contexts.size(); ++i) {
+            if (i >= previous->contexts.size() || !sameContext(contexts[i], previous->contexts[i])) {
+                barChanged[i / cache.beatsPerBar] = true;
+            }
+        }
+        reuse.barChanged = &barChanged;
+        reuse.bass = (cache.bassSettingsHash == previous->bassSettingsHash);
+        reuse.piano = (cache.pianoSettingsHash == previous->pianoSettingsHash) &&
+                      in.pianoPlanner && in.pianoPlanner->useOrchestratorEnabled();
+        reuse.drums = (cache.drumsSettingsHash == previous->drumsSettingsHash);
+    }
     
     // Build 4 energy branches: Simmer (0.15), Build (0.40), Climax (0.70), CoolDown (0.92)
     const QVector<double> energyLevels = {0.15, 0.40, 0.70, 0.92};
@@ -91,14 +200,21 @@ PrePlaybackCache PrePlaybackBuilder::build(const Inputs& in, ProgressCallback pr
     QMutex progressMutex;
     
     // Use QtConcurrent to build all branches in parallel
+    QThreadPool* workers = in.pool ? in.pool : QThreadPool::globalInstance();
     QVector<QFuture<QVector<PreComputedBeat>>> futures;
     futures.reserve(totalBranches);
+    QVector<int> reusedPerBranch(totalBranches, 0);
     
     for (int bi = 0; bi < totalBranches; ++bi) {
         const double energy = energyLevels[bi];
         
         // Launch async branch build
-        futures.append(QtConcurrent::run([&in, &contexts, energy, bi, totalBranches, progress, &progressMutex]() {
+        // Previous cache's branches line up with energyLevels (same builder, same order).
+        BranchReuse branchReuse = reuse;
+        if (previous && bi < previous->energyBranches.size()) branchReuse.previous = &previous->energyBranches[bi];
+        
+        futures.append(QtConcurrent::run(workers, [&in, &contexts, energy, bi, totalBranches, progress, &progressMutex,
+                                                   branchReuse, &reusedPerBranch]() {
             QElapsedTimer branchTimer;
             branchTimer.start();
             
@@ -109,7 +225,8 @@ PrePlaybackCache PrePlaybackBuilder::build(const Inputs& in, ProgressCallback pr
                 progress(step, total, branch, branches);
             };
             
-            auto branch = buildBranchFromContexts(in, contexts, energy, bi, totalBranches, threadSafeProgress);
+            auto branch = buildBranchFromContexts(in, contexts, energy, bi, totalBranches, threadSafeProgress,
+                                                  branchReuse.previous ? &branchReuse : nullptr, &reusedPerBranch[bi]);
             
             qInfo().noquote() << QString("    Branch %1 (energy=%.2f) completed in %2ms")
                 .arg(bi + 1).arg(energy).arg(branchTimer.elapsed());
@@ -122,13 +239,17 @@ PrePlaybackCache PrePlaybackBuilder::build(const Inputs& in, ProgressCallback pr
     cache.energyBranches.reserve(totalBranches);
     for (int bi = 0; bi < totalBranches; ++bi) {
         cache.energyBranches.append(futures[bi].result());
+        cache.reusedSteps += reusedPerBranch[bi];
+        cache.recomputedSteps += cache.energyBranches.last().size() - reusedPerBranch[bi];
     }
+    cache.contexts = std::move(contexts);
     
     cache.branchBuildMs = static_cast<int>(branchPhaseTimer.elapsed());
     cache.buildTimeMs = static_cast<int>(buildTimer.elapsed());
     
-    qInfo().noquote() << QString("PrePlaybackBuilder: Complete! Context=%1ms, Branches=%2ms, Total=%3ms")
-        .arg(cache.contextBuildMs).arg(cache.branchBuildMs).arg(cache.buildTimeMs);
+    qInfo().noquote() << QString("PrePlaybackBuilder: Complete! Context=%1ms, Branches=%2ms, Total=%3ms (recomputed %4 / reused %5 steps)")
+        .arg(cache.contextBuildMs).arg(cache.branchBuildMs).arg(cache.buildTimeMs)
+        .arg(cache.recomputedSteps).arg(cache.reusedSteps);
     
     return cache;
 }
@@ -136,18 +257,23 @@ PrePlaybackCache PrePlaybackBuilder::build(const Inputs& in, ProgressCallback pr
 // =========================================================================
 // Phase 1: Build energy-independent harmonic context for all steps
 // This includes: chord parsing, key estimation, scale selection, functional analysis
+//
+// Output is identical to running buildLookaheadWindow(horizonBars=8) per step, but:
+//  (a) each referenced chart cell is parsed/resolved ONCE and each bar's key window is
+//      estimated ONCE (in parallel), instead of per step and per lookahead probe;
+//  (b) the step loop is data-parallel over those read-only tables.
+// The only serial dependency (HarmonyContext's "last chord" carry-over) is replayed as a cheap
+// index scan; in.harmony's runtime state is never touched.
 // =========================================================================
 QVector<PreComputedContext> PrePlaybackBuilder::buildContexts(const Inputs& in, ProgressCallback progress) {
-    QVector<PreComputedContext> contexts;
-    
     const QVector<int>& seq = *in.sequence;
     const auto ts = timeSigFromModel(*in.model);
     const int beatsPerBar = qMax(1, ts.num);
-    const int totalSteps = seq.size() * qMax(1, in.repeats);
+    const int seqLen = seq.size();
+    const int totalSteps = seqLen * qMax(1, in.repeats);
     const int phraseBars = adaptivePhraseBars(in.bpm);
-    
-    contexts.reserve(totalSteps);
-    
+    const HarmonyContext& harmony = *in.harmony;
+
     // ===========================================================================
     // KEY DETECTION: Use pattern-based analysis (ii-V-I detection) instead of
     // the 8-bar averaging approach. This gives PRECISE key boundaries.
@@ -155,61 +281,144 @@ QVector<PreComputedContext> PrePlaybackBuilder::buildContexts(const Inputs& in,
     KeyAnalyzer keyAnalyzer(*in.ontology);
     const QVector<KeyRegion> keyRegions = keyAnalyzer.analyze(*in.model);
     qInfo() << "KeyAnalyzer: Detected" << keyRegions.size() << "key region(s)";
-    
-    // Progress: context building is "branch 0" in progress reporting
+
+    // Progress: context building is "branch 0" in progress reporting.
+    // The callback touches UI, so it is only ever invoked from this (calling) thread.
     const int progressInterval = qMax(1, beatsPerBar * 4);
-    
-    // Save harmony state to restore after context building
-    const auto savedHarmony = in.harmony->saveRuntimeState();
-    
-    for (int stepIndex = 0; stepIndex < totalSteps; ++stepIndex) {
-        // Report progress (phase 0 = context building)
-        if (progress && (stepIndex % progressInterval == 0)) {
-            progress(stepIndex, totalSteps, -1, 4);  // -1 indicates context phase
+    if (progress) progress(0, totalSteps, -1, 4);  // -1 indicates context phase
+
+    // --- (a) Per-cell chord table: parse + ChordDef once per referenced cell ---
+    int maxCell = -1;
+    for (int cell : seq) maxCell = qMax(maxCell, cell);
+    QVector<ContextCellChord> cells(maxCell + 1);
+    for (int cell : seq) {
+        if (cell < 0) continue;
+        ContextCellChord& cc = cells[cell];
+        if (cc.resolved) continue;
+        cc.resolved = true;
+        cc.chord = harmony.parseCellChordNoState(*in.model, cell, music::ChordSymbol{}, &cc.isExplicit, &cc.exists);
+        if (cc.isExplicit) cc.def = harmony.chordDefForSymbol(cc.chord);
+    }
+
+    // Carry-over chord that HarmonyContext held before the build (chordForCellIndex starts from it).
+    const auto savedHarmony = harmony.saveRuntimeState();
+    const auto* savedChordDef = savedHarmony.hasLastChord ? harmony.chordDefForSymbol(savedHarmony.lastChord) : nullptr;
+
+    // Replay chordForCellIndex's last-chord carry-over (HarmonyContext::chordCarry) over the step order.
+    QVector<ContextStepChord> stepChords(totalSteps);
+    {
+        int lastCell = savedHarmony.hasLastChord ? kSavedChordCell : kNoChordCell;
+        for (int stepIndex = 0; stepIndex < totalSteps; ++stepIndex) {
+            const int cell = seq[stepIndex % seqLen];
+            ContextStepChord& sc = stepChords[stepIndex];
+            const ContextCellChord* cc = (cell >= 0) ? &cells[cell] : nullptr;
+            switch (HarmonyContext::chordCarry(cc && cc->exists, cc && cc->isExplicit, lastCell != kNoChordCell)) {
+            case HarmonyContext::ChordCarry::NoChord:
+                break; // state unchanged
+            case HarmonyContext::ChordCarry::LastChord:
+                sc.chordCell = lastCell;
+                break;
+            case HarmonyContext::ChordCarry::CellChord:
+                sc.chordCell = cell;
+                sc.isNew = HarmonyContext::isNewChord(cc->chord, chordForCell(lastCell, cells, savedHarmony.lastChord));
+                lastCell = cell;
+                break;
+            }
         }
-        
-        PreComputedContext ctx;
-        ctx.stepIndex = stepIndex;
+    }
+
+    // --- Per-bar key windows (estimateLocalKeyWindow), once per referenced chart bar, in parallel ---
+    QVector<ContextBarKey> barKeys;
+    QVector<int> barKeyIndex(qMax(0, maxCell / 4) + 1, -1);
+    for (int cell : seq) {
+        const int bar = qMax(0, cell / 4); // estimateLocalKeyWindow clamps the bar itself
+        if (barKeyIndex[bar] >= 0) continue;
+        barKeyIndex[bar] = barKeys.size();
+        ContextBarKey bk;
+        bk.bar = bar;
+        barKeys.push_back(bk);
+    }
+    QThreadPool* workers = in.pool ? in.pool : QThreadPool::globalInstance();
+    QtConcurrent::blockingMap(workers, barKeys, [&](ContextBarKey& bk) {
+        bk.key = harmony.estimateLocalKeyWindow(*in.model, bk.bar, /*keyWindowBars=*/8);
+    });
+
+    // --- (b) Data-parallel step loop over the read-only tables ---
+    QVector<PreComputedContext> contexts(totalSteps);
+    for (int stepIndex = 0; stepIndex < totalSteps; ++stepIndex) contexts[stepIndex].stepIndex = stepIndex;
+
+    // Workers only read these (const views: no implicit-sharing detach checks across threads).
+    const QVector<ContextCellChord>& cellTable = cells;
+    const QVector<ContextStepChord>& stepChordTable = stepChords;
+    const QVector<ContextBarKey>& barKeyTable = barKeys;
+    const QVector<int>& barKeyLookup = barKeyIndex;
+    const music::ChordSymbol noChord;
+    auto fillContext = [&](PreComputedContext& ctx) {
+        const int stepIndex = ctx.stepIndex;
         ctx.barIndex = stepIndex / beatsPerBar;
         ctx.beatInBar = stepIndex % beatsPerBar;
-        
-        // Build lookahead window (still used for chord parsing, phrase structure, etc.)
-        auto look = buildLookaheadWindow(*in.model, seq, in.repeats, stepIndex,
-                                         /*horizonBars=*/8, phraseBars, /*keyWindowBars=*/8,
-                                         *in.harmony);
-        
-        ctx.haveChord = look.haveCurrentChord && !look.currentChord.noChord;
-        ctx.chord = look.currentChord;
-        ctx.chordText = look.currentChord.originalText.trimmed();
-        ctx.chordIsNew = look.chordIsNew;
-        ctx.haveNextChord = look.haveNextChord;
-        ctx.nextChord = look.nextChord;
-        ctx.nextChanges = look.nextChanges;
-        ctx.beatsUntilChange = look.beatsUntilChange;
-        ctx.phraseBars = look.phraseBars;
-        ctx.barInPhrase = look.barInPhrase;
-        ctx.phraseEndBar = look.phraseEndBar;
-        ctx.cadence01 = look.cadence01;
-        
+
+        // --- Lookahead-window facts (buildLookaheadWindow's rules, LookaheadWindow.h) ---
+        const ContextStepChord& sc = stepChordTable[stepIndex];
+        const bool haveCurrentChord = (sc.chordCell != kNoChordCell);
+        const music::ChordSymbol* curPtr = chordForCell(sc.chordCell, cellTable, savedHarmony.lastChord);
+        const music::ChordSymbol& cur = curPtr ? *curPtr : noChord;
+        // (No chord: rootPc is -1, so the def is never consulted.)
+        const auto* curDef = (sc.chordCell == kSavedChordCell) ? savedChordDef
+                             : (sc.chordCell >= 0)             ? cellTable[sc.chordCell].def
+                                                               : nullptr;
+
+        // Next chord boundary (same rule as buildLookaheadWindow, over the cell table).
+        const LookaheadNextChord next = findLookaheadNextChord(
+            cur, haveCurrentChord, stepIndex, beatsPerBar, totalSteps, [&](int step) -> const music::ChordSymbol* {
+                const int cellNext = seq[step % seqLen];
+                const ContextCellChord* cn = (cellNext >= 0) ? &cellTable[cellNext] : nullptr;
+                return (cn && cn->isExplicit) ? &cn->chord : nullptr;
+            });
+
+        // Phrase model + sliding-window key for this bar.
+        const LookaheadPhrase phrase = lookaheadPhrase(phraseBars, ctx.barIndex);
+        const int cellNow = seq[stepIndex % seqLen];
+        const LocalKeyEstimate& localKey = barKeyTable[barKeyLookup[qMax(0, cellNow / 4)]].key;
+        const int keyPc = harmony.hasKeyPcGuess() ? localKey.tonicPc : HarmonyContext::normalizePc(cur.rootPc);
+
+        QString lookChordFunction;
+        if (curDef && cur.rootPc >= 0) {
+            lookChordFunction = virtuoso::theory::analyzeChordInKey(keyPc, localKey.mode, cur.rootPc, *curDef).function;
+        }
+
+        ctx.haveChord = haveCurrentChord && !cur.noChord;
+        ctx.chord = cur;
+        ctx.chordText = cur.originalText.trimmed();
+        ctx.chordIsNew = sc.isNew;
+        ctx.haveNextChord = next.haveNextChord;
+        ctx.nextChord = next.nextChord ? *next.nextChord : noChord;
+        ctx.nextChanges = next.nextChanges;
+        ctx.beatsUntilChange = next.beatsUntilChange;
+        ctx.phraseBars = phrase.phraseBars;
+        ctx.barInPhrase = phrase.barInPhrase;
+        ctx.phraseEndBar = phrase.phraseEndBar;
+        ctx.cadence01 = lookaheadCadence01(phrase, sc.isNew, next, lookChordFunction, keyPc, localKey.mode, harmony);
+
         // ===========================================================================
         // OVERRIDE KEY: Use KeyAnalyzer result instead of 8-bar averaging!
         // This provides PRECISE key boundaries based on cadence pattern detection.
         // ===========================================================================
-        const int chartBarIndex = ctx.barIndex % (seq.size() / beatsPerBar);  // Handle repeats
+        const int chartBarIndex = ctx.barIndex % qMax(1, seqLen / beatsPerBar);  // Handle repeats
         const KeyRegion keyRegion = KeyAnalyzer::keyAtBar(keyRegions, chartBarIndex);
         ctx.keyTonicPc = keyRegion.tonicPc;
         ctx.keyMode = keyRegion.mode;
-        
+
         // Cache chord definition (pointer is valid for song duration)
         if (ctx.haveChord) {
-            ctx.chordDef = in.harmony->chordDefForSymbol(ctx.chord);
-            
+            ctx.chordDef = curDef;
+
             // Get CHORD-SPECIFIC scale and functional analysis
             // PERF: Use pre-computed ChordScaleTable for O(1) lookup
             if (ctx.chordDef && ctx.chord.rootPc >= 0) {
                 const auto* cached = ChordScaleTable::lookup(
                     *ctx.chordDef, ctx.chord.rootPc, ctx.keyTonicPc, ctx.keyMode);
-                
+
                 if (cached) {
                     // O(1) lookup hit!
                     ctx.scaleKey = cached->scaleKey;
@@ -220,7 +429,7 @@ QVector<PreComputedContext> PrePlaybackBuilder::buildContexts(const Inputs& in,
                     // Fallback to runtime computation (should rarely happen)
                     QString roman;
                     QString func;
-                    const auto scaleChoice = in.harmony->chooseScaleForChord(
+                    const auto scaleChoice = harmony.chooseScaleForChord(
                         ctx.keyTonicPc, ctx.keyMode, ctx.chord, *ctx.chordDef, &roman, &func);
                     ctx.scaleKey = scaleChoice.key;
                     ctx.scaleName = scaleChoice.name;
@@ -229,21 +438,24 @@ QVector<PreComputedContext> PrePlaybackBuilder::buildContexts(const Inputs& in,
                 }
             } else {
                 // Fallback to key's scale if no chord-specific choice available
-                ctx.scaleKey = look.key.scaleKey;
-                ctx.scaleName = look.key.scaleName;
+                ctx.scaleKey = localKey.scaleKey;
+                ctx.scaleName = localKey.scaleName;
             }
         } else {
             // No chord - use key's default scale
-            ctx.scaleKey = look.key.scaleKey;
-            ctx.scaleName = look.key.scaleName;
+            ctx.scaleKey = localKey.scaleKey;
+            ctx.scaleName = localKey.scaleName;
         }
-        
-        contexts.append(ctx);
+    };
+
+    // Map in bar-aligned chunks so progress can still be reported from this thread.
+    const int chunk = qMax(progressInterval, ((totalSteps / 8) / progressInterval + 1) * progressInterval);
+    for (int begin = 0; begin < totalSteps; begin += chunk) {
+        const int end = qMin(totalSteps, begin + chunk);
+        QtConcurrent::blockingMap(workers, contexts.begin() + begin, contexts.begin() + end, fillContext);
+        if (progress) progress(end, totalSteps, -1, 4);
     }
-    
-    // Restore harmony state
-    in.harmony->restoreRuntimeState(savedHarmony);
-    
+
     return contexts;
 }
 
@@ -260,7 +472,9 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
     double baseEnergy,
     int branchIndex, 
     int totalBranches,
-    ProgressCallback progress) {
+    ProgressCallback progress,
+    const BranchReuse* reuse,
+    int* outReusedSteps) {
     
     QVector<PreComputedBeat> branch;
     
@@ -293,8 +507,7 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
     }
     
     // Determinism seed
-    const quint32 detSeed = virtuoso::util::StableHash::fnv1a32(
-        (QString("ballad|") + in.stylePresetKey).toUtf8());
+    const quint32 detSeed = virtuoso::util::StableHash::Builder().ascii("ballad|").utf8(in.stylePresetKey).value();
     
     // Track register centers
     int lastBassCenterMidi = 45;
@@ -302,6 +515,26 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
     
     // Get reference tuning
     const BalladRefTuning tune = tuningForReferenceTrack(in.stylePresetKey);
+
+    // =========================================================================
+    // INCREMENTAL REBUILD: per agent lane, either REPLAY the previous branch (copy plans verbatim) or
+    // PLAN. Bass/piano carry planner state beat to beat; drums are stateless. Lanes only switch at bar
+    // starts, where the piano planner regenerates its rhythmic phrase anyway:
+    //  - replay -> plan: this bar has a changed context; restore the planner from the previous
+    //    branch's state at the end of the prior bar (identical so far, by induction);
+    //  - plan -> replay: this bar is unchanged and planner state + register center equal the previous
+    //    branch's at this boundary, so replanning would reproduce the old plans from here on.
+    // =========================================================================
+    const QVector<PreComputedBeat>* prev = reuse ? reuse->previous : nullptr;
+    bool replayBass = prev && reuse->bass;
+    bool replayPiano = prev && reuse->piano;
+    bool replayDrums = false;
+    // Previous branch's running lane state: after its last planned beat so far (initially a fresh planner).
+    JazzBalladBassPlanner::PlannerState prevBassState = localBassPlanner.snapshotState();
+    JazzBalladPianoPlanner::PlannerState prevPianoState = localPianoPlanner.snapshotState();
+    int prevBassCenterMidi = lastBassCenterMidi;
+    int prevPianoCenterMidi = lastPianoCenterMidi;
+    int reusedSteps = 0;
     
     // Compute each beat using PRE-COMPUTED context (no harmony re-analysis!)
     for (int stepIndex = 0; stepIndex < totalSteps; ++stepIndex) {
@@ -312,6 +545,42 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
         
         // Get pre-computed context (replaces expensive buildLookaheadWindow call!)
         const PreComputedContext& ctx = contexts[stepIndex];
+
+        if (prev) {
+            if (stepIndex > 0 && stepIndex - 1 < prev->size()) {
+                const PreComputedBeat& ob = (*prev)[stepIndex - 1];
+                if (!ob.bassId.isEmpty()) {
+                    prevBassState = ob.bassStateAfter;
+                    prevBassCenterMidi = ob.bassCenterMidi;
+                }
+                if (!ob.pianoId.isEmpty()) {
+                    prevPianoState = ob.pianoStateAfter;
+                    prevPianoCenterMidi = ob.pianoCenterMidi;
+                }
+            }
+            if (stepIndex % beatsPerBar == 0) {
+                const bool changed = (*reuse->barChanged)[stepIndex / beatsPerBar] || stepIndex >= prev->size();
+                if (replayBass && changed) {
+                    replayBass = false;
+                    localBassPlanner.restoreState(prevBassState);
+                    lastBassCenterMidi = prevBassCenterMidi;
+                } else if (!replayBass && reuse->bass && !changed && lastBassCenterMidi == prevBassCenterMidi &&
+                           sameBassState(localBassPlanner.snapshotState(), prevBassState)) {
+                    replayBass = true;
+                }
+                if (replayPiano && changed) {
+                    replayPiano = false;
+                    localPianoPlanner.restoreState(prevPianoState);
+                    lastPianoCenterMidi = prevPianoCenterMidi;
+                } else if (!replayPiano && reuse->piano && !changed && lastPianoCenterMidi == prevPianoCenterMidi &&
+                           samePianoState(localPianoPlanner.snapshotState(), prevPianoState)) {
+                    replayPiano = true;
+                }
+                replayDrums = reuse->drums && !changed;
+            }
+        }
+        const PreComputedBeat* oldBeat = (replayBass || replayPiano || replayDrums) ? &(*prev)[stepIndex] : nullptr;
+        if (replayBass && replayPiano && replayDrums) ++reusedSteps;
         
         PreComputedBeat beat;
         beat.stepIndex = stepIndex;
@@ -432,24 +701,38 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
         
         // --- Generate Plans (using LOCAL thread-safe planners) ---
         // Bass plan
-        beat.bassPlan = localBassPlanner.planBeatWithActions(bc, in.chBass, ts);
-        beat.bassStateAfter = localBassPlanner.snapshotState();
-        if (!beat.bassPlan.notes.isEmpty()) {
-            // Update register center based on what was played
-            int sum = 0;
-            for (const auto& n : beat.bassPlan.notes) sum += n.note;
-            lastBassCenterMidi = clampBassCenterMidi(sum / beat.bassPlan.notes.size());
+        if (replayBass) {
+            beat.bassPlan = oldBeat->bassPlan;
+            beat.bassStateAfter = oldBeat->bassStateAfter;
+            lastBassCenterMidi = oldBeat->bassCenterMidi;
+        } else {
+            beat.bassPlan = localBassPlanner.planBeatWithActions(bc, in.chBass, ts);
+            beat.bassStateAfter = localBassPlanner.snapshotState();
+            if (!beat.bassPlan.notes.isEmpty()) {
+                // Update register center based on what was played
+                int sum = 0;
+                for (const auto& n : beat.bassPlan.notes) sum += n.note;
+                lastBassCenterMidi = clampBassCenterMidi(sum / beat.bassPlan.notes.size());
+            }
         }
         beat.bassCenterMidi = lastBassCenterMidi;
         beat.bassId = beat.bassPlan.notes.isEmpty() ? "rest" : "base";
         
         // Piano plan
-        beat.pianoPlan = localPianoPlanner.planBeatWithActions(pc, in.chPiano, ts);
-        beat.pianoStateAfter = localPianoPlanner.snapshotState();
+        if (replayPiano) {
+            beat.pianoPlan = oldBeat->pianoPlan;
+            beat.pianoStateAfter = oldBeat->pianoStateAfter;
+            lastPianoCenterMidi = oldBeat->pianoCenterMidi;
+        } else {
+            beat.pianoPlan = localPianoPlanner.planBeatWithActions(pc, in.chPiano, ts);
+            beat.pianoStateAfter = localPianoPlanner.snapshotState();
+            if (!beat.pianoPlan.notes.isEmpty()) {
+                int sum = 0;
+                for (const auto& n : beat.pianoPlan.notes) sum += n.note;
+                lastPianoCenterMidi = clampPianoCenterMidi(sum / beat.pianoPlan.notes.size());
+            }
+        }
         if (!beat.pianoPlan.notes.isEmpty()) {
-            int sum = 0;
-            for (const auto& n : beat.pianoPlan.notes) sum += n.note;
-            lastPianoCenterMidi = clampPianoCenterMidi(sum / beat.pianoPlan.notes.size());
             // Extract voicing key from the piano plan
             beat.voicingKey = beat.pianoPlan.chosenVoicingKey;
         }
@@ -457,7 +740,7 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
         beat.pianoId = beat.pianoPlan.notes.isEmpty() ? "rest" : "base";
         
         // Drums plan
-        beat.drumsNotes = localDrummer.planBeat(dc);
+        beat.drumsNotes = replayDrums ? oldBeat->drumsNotes : localDrummer.planBeat(dc);
         beat.drumsId = beat.drumsNotes.isEmpty() ? "rest" : "base";
         
         beat.costTag = QString("pre|e%1").arg(baseEnergy, 0, 'f', 2);
@@ -465,6 +748,7 @@ QVector<PreComputedBeat> PrePlaybackBuilder::buildBranchFromContexts(
         branch.append(beat);
     }
     
+    if (outReusedSteps) *outReusedSteps = reusedSteps;
     return branch;
 }
 
@@ -4,6 +4,7 @@
 #include <QString>
 #include <QHash>
 #include <QElapsedTimer>
+#include <QThreadPool>
 #include <functional>
 
 #include "chart/ChartModel.h"
@@ -83,6 +84,45 @@ struct PreComputedBeat {
     QString grooveTemplateKey; // Groove template used
 };
 
+/**
+ * Pre-computed harmonic context for a single step.
+ * This is ENERGY-INDEPENDENT and computed only once, then shared across all branches.
+ */
+struct PreComputedContext {
+    int stepIndex = -1;
+    int barIndex = 0;
+    int beatInBar = 0;
+    
+    // Lookahead window (expensive to compute, identical across energy levels)
+    bool haveChord = false;
+    music::ChordSymbol chord;
+    QString chordText;
+    bool chordIsNew = false;
+    
+    // Next chord lookahead
+    bool haveNextChord = false;
+    music::ChordSymbol nextChord;
+    bool nextChanges = false;
+    int beatsUntilChange = 0;
+    
+    // Key/scale analysis (very expensive - involves ontology queries)
+    int keyTonicPc = 0;
+    virtuoso::theory::KeyMode keyMode = virtuoso::theory::KeyMode::Major;
+    QString scaleKey;
+    QString scaleName;
+    QString roman;
+    QString chordFunction;
+    
+    // Phrase context
+    int phraseBars = 4;
+    int barInPhrase = 0;
+    bool phraseEndBar = false;
+    double cadence01 = 0.0;
+    
+    // Chord definition (cached pointer - valid for song duration)
+    const virtuoso::ontology::ChordDef* chordDef = nullptr;
+};
+
 // A complete song cache with multiple energy branches
 struct PrePlaybackCache {
     // Song metadata
@@ -133,51 +173,26 @@ struct PrePlaybackCache {
     void clear() { 
         totalSteps = 0; 
         energyBranches.clear(); 
+        contexts.clear();
     }
     
     // Build statistics
     int buildTimeMs = 0;
     int contextBuildMs = 0;  // Time spent on energy-independent context
     int branchBuildMs = 0;   // Time spent on energy-dependent planning
-};
+    // Summed over energy branches. A step is "reused" when its bass, piano and drum plans were all
+    // copied from the previous cache by PrePlaybackBuilder::rebuild(); a full build recomputes every step.
+    int recomputedSteps = 0;
+    int reusedSteps = 0;
 
-/**
- * Pre-computed harmonic context for a single step.
- * This is ENERGY-INDEPENDENT and computed only once, then shared across all branches.
- */
-struct PreComputedContext {
-    int stepIndex = -1;
-    int barIndex = 0;
-    int beatInBar = 0;
-    
-    // Lookahead window (expensive to compute, identical across energy levels)
-    bool haveChord = false;
-    music::ChordSymbol chord;
-    QString chordText;
-    bool chordIsNew = false;
-    
-    // Next chord lookahead
-    bool haveNextChord = false;
-    music::ChordSymbol nextChord;
-    bool nextChanges = false;
-    int beatsUntilChange = 0;
-    
-    // Key/scale analysis (very expensive - involves ontology queries)
-    int keyTonicPc = 0;
-    virtuoso::theory::KeyMode keyMode = virtuoso::theory::KeyMode::Major;
-    QString scaleKey;
-    QString scaleName;
-    QString roman;
-    QString chordFunction;
-    
-    // Phrase context
-    int phraseBars = 4;
-    int barInPhrase = 0;
-    bool phraseEndBar = false;
-    double cadence01 = 0.0;
-    
-    // Chord definition (cached pointer - valid for song duration)
-    const virtuoso::ontology::ChordDef* chordDef = nullptr;
+    // Incremental-rebuild state (in memory only; PrePlaybackCacheStore does not persist it).
+    // contexts: the Phase 1 output this cache was planned from.
+    // *SettingsHash: step-independent inputs of each agent lane (tempo, style, channel, energy mult, ...).
+    QVector<PreComputedContext> contexts;
+    quint32 bassSettingsHash = 0;
+    quint32 pianoSettingsHash = 0;
+    quint32 drumsSettingsHash = 0;
+    bool canRebuildFrom() const { return isValid() && contexts.size() == totalSteps; }
 };
 
 /**
@@ -207,7 +222,7 @@ public:
         // Context
         HarmonyContext* harmony = nullptr;
         virtuoso::engine::VirtuosoEngine* engine = nullptr;
-        virtuoso::ontology::OntologyRegistry* ontology = nullptr;
+        const virtuoso::ontology::OntologyRegistry* ontology = nullptr;
         InteractionContext* interaction = nullptr;
         StoryState* story = nullptr;
         
@@ -218,7 +233,16 @@ public:
         
         // Energy multipliers per agent
         QHash<QString, double> agentEnergyMult;
-        
+
+        // VocabularyRegistry::contentHash() of the loaded vocabulary (0 = none).
+        // Only feeds the PrePlaybackCacheStore key; the builder itself does not read it.
+        quint32 vocabularyHash = 0;
+
+        // Workers for both phases (context map and energy branches); QThreadPool::globalInstance()
+        // when null. Everything the workers share (ontology, ChordScaleTable, contexts) is read-only,
+        // so a dedicated pool of any size gives the same cache.
+        QThreadPool* pool = nullptr;
+
         // Note: Negotiated weights are not used in pre-cache since we don't have 
         // real-time interaction context. Energy levels are pre-computed per branch instead.
     };
@@ -226,8 +250,30 @@ public:
     // Build the complete cache for all energy levels
     // Optional progress callback receives (currentStep, totalSteps, currentBranch, totalBranches)
     static PrePlaybackCache build(const Inputs& in, ProgressCallback progress = nullptr);
+
+    // Incremental build after an edit (chart region, tempo, style, orchestrator toggle, ...).
+    // Produces the same cache as build(in), but copies plans from `previous` wherever they are
+    // provably unchanged: per agent lane, steps are replanned from the bar containing the first
+    // changed context (or from the start if that lane's settings changed) until the planner state
+    // reconverges with `previous` at a bar boundary; everything else is reused verbatim.
+    // Falls back to build() if !previous.canRebuildFrom() (e.g. a cache loaded from disk).
+    static PrePlaybackCache rebuild(const Inputs& in, const PrePlaybackCache& previous, ProgressCallback progress = nullptr);
     
 private:
+    // Incremental-rebuild inputs for one energy branch (see rebuild()).
+    struct BranchReuse {
+        const QVector<PreComputedBeat>* previous = nullptr; // same branch of the previous cache
+        const QVector<bool>* barChanged = nullptr;          // per playback bar: any step context differs
+        bool bass = false;   // lane settings unchanged: old plans may be copied
+        bool piano = false;
+        bool drums = false;
+    };
+
+    static PrePlaybackCache buildImpl(const Inputs& in, const PrePlaybackCache* previous, ProgressCallback progress);
+
+    // Test-only access to the phase entry points (playback/tests).
+    friend struct PrePlaybackBuilderTestAccess;
+
     // Phase 1: Build energy-independent harmonic context for all steps (ONCE)
     static QVector<PreComputedContext> buildContexts(const Inputs& in, ProgressCallback progress);
     
@@ -238,7 +284,9 @@ private:
         double baseEnergy, 
         int branchIndex, 
         int totalBranches,
-        ProgressCallback progress);
+        ProgressCallback progress,
+        const BranchReuse* reuse = nullptr,
+        int* outReusedSteps = nullptr);
 };
 
 } // namespace playback
@@ -0,0 +1,622 @@
+#include "playback/PrePlaybackCacheStore.h"
+
+#include "virtuoso/util/StableHash.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+namespace playback {
+
+namespace {
+
+using virtuoso::engine::AgentIntentNote;
+using virtuoso::groove::GridPos;
+using virtuoso::groove::Rational;
+
+// ---------------------------------------------------------------------------
+// Little-endian byte writer/reader. Every record is padded to 4 bytes so the
+// UTF-16 string data read back out of the mapping is always QChar-aligned.
+// ---------------------------------------------------------------------------
+
+class ByteWriter {
+public:
+    explicit ByteWriter(QByteArray* out) : m_out(out) {}
+
+    void u32(quint32 v) { put(qToLittleEndian(v)); }
+    void i32(qint32 v) { put(qToLittleEndian(v)); }
+    void i64(qint64 v) { put(qToLittleEndian(v)); }
+    void f64(double v) {
+        quint64 bits = 0;
+        std::memcpy(&bits, &v, sizeof bits);
+        put(qToLittleEndian(bits));
+    }
+    void flag(bool v) { u32(v ? 1u : 0u); }
+
+    void bytes(const QByteArray& b) {
+        u32(quint32(b.size()));
+        m_out->append(b);
+        pad();
+    }
+    void str(const QString& s) {
+        u32(quint32(s.size()));
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        m_out->append(reinterpret_cast<const char*>(s.utf16()), int(s.size() * 2));
+#else
+        for (QChar c : s) put(qToLittleEndian(c.unicode()));
+#endif
+        pad();
+    }
+
+private:
+    template <typename T>
+    void put(T v) { m_out->append(reinterpret_cast<const char*>(&v), int(sizeof v)); }
+    void pad() {
+        while (m_out->size() % 4) m_out->append('\0');
+    }
+
+    QByteArray* m_out;
+};
+
+class ByteReader {
+public:
+    ByteReader(const uchar* data, qint64 size) : m_p(data), m_end(data + size) {}
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_p == m_end; }
+
+    quint32 u32() { return qFromLittleEndian(get<quint32>()); }
+    qint32 i32() { return qFromLittleEndian(get<qint32>()); }
+    qint64 i64() { return qFromLittleEndian(get<qint64>()); }
+    double f64() {
+        const quint64 bits = qFromLittleEndian(get<quint64>());
+        double v = 0.0;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+    bool flag() { return u32() != 0u; }
+
+    // Element count for a following array; rejects counts the remaining bytes cannot hold.
+    int count(int minBytesPerItem) {
+        const quint32 n = u32();
+        if (!m_ok || quint64(n) * quint64(qMax(1, minBytesPerItem)) > quint64(m_end - m_p)) {
+            m_ok = false;
+            return 0;
+        }
+        return int(n);
+    }
+
+    QByteArray bytes() {
+        const int n = count(1);
+        const uchar* p = take(padded(n));
+        return p ? QByteArray(reinterpret_cast<const char*>(p), n) : QByteArray();
+    }
+    QString str() {
+        const int n = count(2);
+        const uchar* p = take(padded(n * 2));
+        if (!p) return {};
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        return QString(reinterpret_cast<const QChar*>(p), n);
+#else
+        QString s(n, Qt::Uninitialized);
+        for (int i = 0; i < n; ++i) s[i] = QChar(qFromLittleEndian<quint16>(p + 2 * i));
+        return s;
+#endif
+    }
+
+private:
+    static qint64 padded(qint64 n) { return (n + 3) & ~qint64(3); }
+
+    const uchar* take(qint64 n) {
+        if (!m_ok || n < 0 || n > m_end - m_p) {
+            m_ok = false;
+            return nullptr;
+        }
+        const uchar* p = m_p;
+        m_p += n;
+        return p;
+    }
+    template <typename T>
+    T get() {
+        T v{};
+        if (const uchar* p = take(qint64(sizeof v))) std::memcpy(&v, p, sizeof v);
+        return v;
+    }
+
+    const uchar* m_p;
+    const uchar* m_end;
+    bool m_ok = true;
+};
+
+// Distinct strings are written once; beats store indices. Most fields repeat heavily
+// (agent names, logic tags, scale/voicing keys), so this keeps files small and lets the
+// loaded cache share one QString per distinct value.
+class StringTableWriter {
+public:
+    quint32 intern(const QString& s) {
+        auto it = m_index.constFind(s);
+        if (it != m_index.constEnd()) return it.value();
+        const quint32 id = quint32(m_strings.size());
+        m_index.insert(s, id);
+        m_strings.push_back(s);
+        return id;
+    }
+    const QVector<QString>& strings() const { return m_strings; }
+
+private:
+    QHash<QString, quint32> m_index;
+    QVector<QString> m_strings;
+};
+
+// ---------------------------------------------------------------------------
+// Beat codec
+// ---------------------------------------------------------------------------
+
+struct BeatWriter {
+    ByteWriter& w;
+    StringTableWriter& strings;
+
+    void str(const QString& s) { w.u32(strings.intern(s)); }
+    void rational(const Rational& r) {
+        w.i64(r.num);
+        w.i64(r.den);
+    }
+    void gridPos(const GridPos& p) {
+        w.i32(p.barIndex);
+        rational(p.withinBarWhole);
+    }
+    void note(const AgentIntentNote& n) {
+        str(n.agent);
+        w.i32(n.channel);
+        w.i32(n.note);
+        w.i32(n.baseVelocity);
+        gridPos(n.startPos);
+        rational(n.durationWhole);
+        w.flag(n.structural);
+        str(n.chord_context);
+        str(n.scale_used);
+        str(n.key_center);
+        str(n.roman);
+        str(n.chord_function);
+        str(n.voicing_type);
+        str(n.logic_tag);
+        str(n.target_note);
+        str(n.vibe_state);
+        str(n.user_intents);
+        w.f64(n.user_outside_ratio);
+        w.f64(n.emotion01);
+    }
+    void notes(const QVector<AgentIntentNote>& ns) {
+        w.u32(quint32(ns.size()));
+        for (const auto& n : ns) note(n);
+    }
+    void beat(const PreComputedBeat& b) {
+        w.i32(b.stepIndex);
+        str(b.bassId);
+        str(b.pianoId);
+        str(b.drumsId);
+        str(b.costTag);
+
+        notes(b.bassPlan.notes);
+        w.u32(quint32(b.bassPlan.keyswitches.size()));
+        for (const auto& ks : b.bassPlan.keyswitches) {
+            w.i32(ks.midi);
+            gridPos(ks.startPos);
+            str(ks.logic_tag);
+            w.i32(ks.leadMs);
+            w.i32(ks.holdMs);
+        }
+        notes(b.bassPlan.fxNotes);
+        w.i32(b.bassPlan.desiredArtKeyswitchMidi);
+        str(b.bassPlan.chosenScaleKey);
+
+        notes(b.pianoPlan.notes);
+        w.u32(quint32(b.pianoPlan.ccs.size()));
+        for (const auto& cc : b.pianoPlan.ccs) {
+            w.i32(cc.cc);
+            w.i32(cc.value);
+            gridPos(cc.startPos);
+            w.flag(cc.structural);
+            str(cc.logic_tag);
+        }
+        str(b.pianoPlan.chosenVoicingKey);
+        str(b.pianoPlan.chosenScaleKey);
+        str(b.pianoPlan.chosenScaleName);
+        str(b.pianoPlan.motifSourceAgent);
+        str(b.pianoPlan.motifTransform);
+
+        notes(b.drumsNotes);
+
+        w.i32(b.bassCenterMidi);
+        w.i32(b.pianoCenterMidi);
+        str(b.chordText);
+        w.i32(b.barIndex);
+        w.i32(b.beatInBar);
+        w.flag(b.phraseEndBar);
+        str(b.chordDefKey);
+        w.i32(b.chordRootPc);
+        w.i32(b.keyTonicPc);
+        w.i32(int(b.keyMode));
+        w.flag(b.chordIsNew);
+        str(b.scaleKey);
+        str(b.voicingKey);
+        str(b.grooveTemplateKey);
+    }
+};
+
+// Encoded sizes (beat: with all arrays empty), used to bound array counts against the remaining bytes.
+constexpr int kMinNoteBytes = 112;
+constexpr int kMinKeySwitchBytes = 36;
+constexpr int kMinCcBytes = 36;
+constexpr int kMinBeatBytes = 128;
+
+struct BeatReader {
+    ByteReader& r;
+    const QVector<QString>& strings;
+
+    QString str() {
+        const quint32 id = r.u32();
+        if (id >= quint32(strings.size())) {
+            if (r.ok()) failed = true;
+            return {};
+        }
+        return strings[int(id)];
+    }
+    Rational rational() {
+        // Written already normalized: assign fields directly instead of re-running gcd.
+        Rational q;
+        q.num = r.i64();
+        q.den = r.i64();
+        if (q.den <= 0) failed = true;
+        return q;
+    }
+    GridPos gridPos() {
+        GridPos p;
+        p.barIndex = r.i32();
+        p.withinBarWhole = rational();
+        return p;
+    }
+    void note(AgentIntentNote& n) {
+        n.agent = str();
+        n.channel = r.i32();
+        n.note = r.i32();
+        n.baseVelocity = r.i32();
+        n.startPos = gridPos();
+        n.durationWhole = rational();
+        n.structural = r.flag();
+        n.chord_context = str();
+        n.scale_used = str();
+        n.key_center = str();
+        n.roman = str();
+        n.chord_function = str();
+        n.voicing_type = str();
+        n.logic_tag = str();
+        n.target_note = str();
+        n.vibe_state = str();
+        n.user_intents = str();
+        n.user_outside_ratio = r.f64();
+        n.emotion01 = r.f64();
+    }
+    void notes(QVector<AgentIntentNote>& ns) {
+        ns.resize(r.count(kMinNoteBytes));
+        for (auto& n : ns) note(n);
+    }
+    void beat(PreComputedBeat& b) {
+        b.stepIndex = r.i32();
+        b.bassId = str();
+        b.pianoId = str();
+        b.drumsId = str();
+        b.costTag = str();
+
+        notes(b.bassPlan.notes);
+        b.bassPlan.keyswitches.resize(r.count(kMinKeySwitchBytes));
+        for (auto& ks : b.bassPlan.keyswitches) {
+            ks.midi = r.i32();
+            ks.startPos = gridPos();
+            ks.logic_tag = str();
+            ks.leadMs = r.i32();
+            ks.holdMs = r.i32();
+        }
+        notes(b.bassPlan.fxNotes);
+        b.bassPlan.desiredArtKeyswitchMidi = r.i32();
+        b.bassPlan.chosenScaleKey = str();
+
+        notes(b.pianoPlan.notes);
+        b.pianoPlan.ccs.resize(r.count(kMinCcBytes));
+        for (auto& cc : b.pianoPlan.ccs) {
+            cc.cc = r.i32();
+            cc.value = r.i32();
+            cc.startPos = gridPos();
+            cc.structural = r.flag();
+            cc.logic_tag = str();
+        }
+        b.pianoPlan.chosenVoicingKey = str();
+        b.pianoPlan.chosenScaleKey = str();
+        b.pianoPlan.chosenScaleName = str();
+        b.pianoPlan.motifSourceAgent = str();
+        b.pianoPlan.motifTransform = str();
+
+        notes(b.drumsNotes);
+
+        b.bassCenterMidi = r.i32();
+        b.pianoCenterMidi = r.i32();
+        b.chordText = str();
+        b.barIndex = r.i32();
+        b.beatInBar = r.i32();
+        b.phraseEndBar = r.flag();
+        b.chordDefKey = str();
+        b.chordRootPc = r.i32();
+        b.keyTonicPc = r.i32();
+        b.keyMode = (r.i32() == int(virtuoso::theory::KeyMode::Minor)) ? virtuoso::theory::KeyMode::Minor
+                                                                         : virtuoso::theory::KeyMode::Major;
+        b.chordIsNew = r.flag();
+        b.scaleKey = str();
+        b.voicingKey = str();
+        b.grooveTemplateKey = str();
+    }
+
+    bool failed = false;
+};
+
+// ---------------------------------------------------------------------------
+// Key helpers
+// ---------------------------------------------------------------------------
+
+static void writeChart(ByteWriter& w, const chart::ChartModel& model) {
+    w.i32(model.timeSigNum);
+    w.i32(model.timeSigDen);
+    w.str(model.footerText);
+    w.u32(quint32(model.lines.size()));
+    for (const auto& line : model.lines) {
+        w.str(line.sectionLabel);
+        w.u32(quint32(line.bars.size()));
+        for (const auto& bar : line.bars) {
+            w.str(bar.barlineLeft);
+            w.str(bar.barlineRight);
+            w.i32(bar.endingStart);
+            w.i32(bar.endingEnd);
+            w.str(bar.annotation);
+            w.u32(quint32(bar.cells.size()));
+            for (const auto& cell : bar.cells) {
+                w.str(cell.chord);
+                w.flag(cell.isPlaceholder);
+            }
+        }
+    }
+}
+
+static void writeInts(ByteWriter& w, const QVector<int>& v) {
+    w.u32(quint32(v.size()));
+    for (int x : v) w.i32(x);
+}
+
+// Same fields music::sameChordSymbol compares.
+static void writeChordSymbol(ByteWriter& w, const music::ChordSymbol& c) {
+    w.str(c.originalText);
+    w.flag(c.placeholder);
+    w.flag(c.noChord);
+    w.i32(c.rootPc);
+    w.i32(c.bassPc);
+    w.i32(int(c.quality));
+    w.i32(int(c.seventh));
+    w.i32(c.extension);
+    w.flag(c.alt);
+    w.u32(quint32(c.alterations.size()));
+    for (const auto& a : c.alterations) {
+        w.i32(a.degree);
+        w.i32(a.delta);
+        w.flag(a.add);
+    }
+}
+
+// Content fingerprint of the ontology (registry iteration order is not stable, so sort by key).
+static quint32 ontologyFingerprint(const virtuoso::ontology::OntologyRegistry* ont) {
+    if (!ont) return 0u;
+    QByteArray bytes;
+    ByteWriter w(&bytes);
+    auto byKey = [](const auto* a, const auto* b) { return a->key < b->key; };
+
+    auto chords = ont->allChords();
+    std::sort(chords.begin(), chords.end(), byKey);
+    w.u32(quint32(chords.size()));
+    for (const auto* c : chords) {
+        w.str(c->key);
+        writeInts(w, c->intervals);
+        w.i32(c->bassInterval);
+        w.str(c->tags.join(','));
+    }
+    auto scales = ont->allScales();
+    std::sort(scales.begin(), scales.end(), byKey);
+    w.u32(quint32(scales.size()));
+    for (const auto* s : scales) {
+        w.str(s->key);
+        w.str(s->name);
+        writeInts(w, s->intervals);
+        w.str(s->tags.join(','));
+    }
+    auto voicings = ont->allVoicings();
+    std::sort(voicings.begin(), voicings.end(), byKey);
+    w.u32(quint32(voicings.size()));
+    for (const auto* v : voicings) {
+        w.str(v->key);
+        w.i32(int(v->instrument));
+        writeInts(w, v->chordDegrees);
+        writeInts(w, v->intervals);
+        w.str(v->tags.join(','));
+    }
+    return virtuoso::util::StableHash::fnv1a32(bytes);
+}
+
+} // namespace
+
+PrePlaybackCacheStore::Key PrePlaybackCacheStore::keyFor(const PrePlaybackBuilder::Inputs& in) {
+    Key key;
+    if (!in.model || !in.sequence) return key;
+
+    QByteArray& id = key.identity;
+    ByteWriter w(&id);
+    w.u32(kFormatVersion);
+    w.u32(virtuoso::util::StableHash::kHashVersion);
+    writeChart(w, *in.model);
+    writeInts(w, *in.sequence);
+    w.i32(in.repeats);
+    w.i32(in.bpm);
+    w.str(in.stylePresetKey);
+    w.i32(in.chBass);
+    w.i32(in.chPiano);
+    w.i32(in.chDrums);
+
+    QStringList agents = in.agentEnergyMult.keys();
+    agents.sort();
+    w.u32(quint32(agents.size()));
+    for (const QString& a : agents) {
+        w.str(a);
+        w.f64(in.agentEnergyMult.value(a));
+    }
+
+    w.flag(in.pianoPlanner && in.pianoPlanner->useOrchestratorEnabled());
+    w.u32(in.vocabularyHash);
+    w.u32(ontologyFingerprint(in.ontology));
+
+    // The build starts from HarmonyContext's last chord, so a cache built mid-playback
+    // (or after realtime fallback) is only reusable from the same carried-over chord.
+    const HarmonyContext::RuntimeState prior =
+        in.harmony ? in.harmony->saveRuntimeState() : HarmonyContext::RuntimeState{};
+    w.flag(prior.hasLastChord);
+    if (prior.hasLastChord) writeChordSymbol(w, prior.lastChord);
+
+    key.hash = virtuoso::util::StableHash::fnv1a32(id);
+    return key;
+}
+
+QString PrePlaybackCacheStore::defaultDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/preplayback";
+}
+
+QString PrePlaybackCacheStore::pathFor(const QString& dir, const Key& key) {
+    return QString("%1/%2.ppc").arg(dir).arg(key.hash, 8, 16, QChar('0'));
+}
+
+QByteArray PrePlaybackCacheStore::serialize(const Key& key, const PrePlaybackCache& cache) {
+    // Body first (interning strings as we go), then header + string table in front of it.
+    QByteArray body;
+    StringTableWriter strings;
+    {
+        ByteWriter w(&body);
+        w.i32(cache.totalSteps);
+        w.i32(cache.beatsPerBar);
+        w.i32(cache.totalBars);
+        w.i32(cache.phraseBars);
+        w.i32(cache.buildTimeMs);
+        w.i32(cache.contextBuildMs);
+        w.i32(cache.branchBuildMs);
+        w.u32(quint32(cache.energyBranches.size()));
+        BeatWriter bw{w, strings};
+        for (const auto& branch : cache.energyBranches) {
+            w.u32(quint32(branch.size()));
+            for (const auto& beat : branch) bw.beat(beat);
+        }
+    }
+
+    QByteArray out;
+    ByteWriter w(&out);
+    w.u32(kMagic);
+    w.u32(kFormatVersion);
+    w.u32(virtuoso::util::StableHash::kHashVersion);
+    w.u32(key.hash);
+    w.bytes(key.identity);
+    w.u32(quint32(strings.strings().size()));
+    for (const QString& s : strings.strings()) w.str(s);
+    out.append(body);
+    return out;
+}
+
+bool PrePlaybackCacheStore::deserialize(const uchar* data, qint64 size, const Key& key, PrePlaybackCache* out, QString* outError) {
+    auto fail = [&](const QString& why) {
+        if (outError) *outError = why;
+        return false;
+    };
+    if (!out || !data) return fail("no data");
+
+    ByteReader r(data, size);
+    if (r.u32() != kMagic) return fail("bad magic");
+    if (r.u32() != kFormatVersion) return fail("format version mismatch");
+    if (r.u32() != virtuoso::util::StableHash::kHashVersion) return fail("hash version mismatch");
+    if (r.u32() != key.hash) return fail("key hash mismatch");
+    if (r.bytes() != key.identity || !r.ok()) return fail("key identity mismatch");
+
+    QVector<QString> strings(r.count(4));
+    for (auto& s : strings) s = r.str();
+    if (!r.ok()) return fail("truncated string table");
+
+    PrePlaybackCache cache;
+    cache.totalSteps = r.i32();
+    cache.beatsPerBar = r.i32();
+    cache.totalBars = r.i32();
+    cache.phraseBars = r.i32();
+    cache.buildTimeMs = r.i32();
+    cache.contextBuildMs = r.i32();
+    cache.branchBuildMs = r.i32();
+
+    BeatReader br{r, strings};
+    cache.energyBranches.resize(r.count(4));
+    for (auto& branch : cache.energyBranches) {
+        branch.resize(r.count(kMinBeatBytes));
+        for (auto& beat : branch) {
+            br.beat(beat);
+            if (!r.ok() || br.failed) return fail("corrupt beat data");
+        }
+    }
+    if (!r.ok() || br.failed) return fail("truncated cache data");
+    if (!r.atEnd()) return fail("trailing bytes");
+
+    *out = std::move(cache);
+    return true;
+}
+
+bool PrePlaybackCacheStore::save(const QString& path, const Key& key, const PrePlaybackCache& cache, QString* outError) {
+    if (!key.isValid() || !cache.isValid()) {
+        if (outError) *outError = "nothing to save";
+        return false;
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        if (outError) *outError = f.errorString();
+        return false;
+    }
+    const QByteArray bytes = serialize(key, cache);
+    if (f.write(bytes) != bytes.size() || !f.commit()) {
+        if (outError) *outError = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool PrePlaybackCacheStore::load(const QString& path, const Key& key, PrePlaybackCache* out, QString* outError) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (outError) *outError = f.errorString();
+        return false;
+    }
+    const qint64 size = f.size();
+    uchar* data = f.map(0, size);
+    if (!data) {
+        if (outError) *outError = f.errorString();
+        return false;
+    }
+    // Strings are copied out, so the mapping can go away as soon as decoding is done.
+    const bool ok = deserialize(data, size, key, out, outError);
+    f.unmap(data);
+    return ok;
+}
+
+} // namespace playback
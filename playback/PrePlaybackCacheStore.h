@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+#include "playback/PrePlaybackCache.h"
+
+namespace playback {
+
+/**
+ * PrePlaybackCacheStore: persistent on-disk copy of a PrePlaybackCache.
+ *
+ * Rehearsing the same song with unchanged chart/tempo/style should not pay the full
+ * multi-second pre-plan again. The builder output is written once to a versioned
+ * binary file; the next play() memory-maps it and restores the cache in a few ms.
+ *
+ * Identity (Key):
+ *   - a canonical byte string of everything the builder output depends on (chart model,
+ *     sequence, repeats, bpm, style preset, channels, agent energy multipliers, piano
+ *     orchestrator toggle, vocabulary content hash, ontology fingerprint, format version);
+ *   - its StableHash names the file, and the full identity is stored in the header and
+ *     compared on load, so a 32-bit hash collision can never return the wrong song.
+ *
+ * Format (little-endian):
+ *   header   magic, formatVersion, StableHash::kHashVersion, identity bytes
+ *   strings  table of every distinct QString (UTF-16); beats refer to strings by index,
+ *            so the loaded cache shares one QString per distinct value
+ *   cache    metadata + energy branches of PreComputedBeat
+ *
+ * Persisted per beat: everything playback reads (intent notes, keyswitches, CCs, theory
+ * fields for live-follow, ids/cost tag/register centers for debugging).
+ * NOT persisted: bassStateAfter/pianoStateAfter and pianoPlan.performance, which only
+ * matter while the builder is running. They come back default-constructed.
+ *
+ * Any mismatch (magic, version, identity, truncation) makes load() fail and the caller
+ * rebuilds. Bump kFormatVersion whenever the layout OR planner output changes.
+ */
+class PrePlaybackCacheStore {
+public:
+    static constexpr quint32 kMagic = 0x43505050u; // "PPPC"
+    static constexpr quint32 kFormatVersion = 3u;
+
+    struct Key {
+        quint32 hash = 0;
+        QByteArray identity;
+
+        bool isValid() const { return !identity.isEmpty(); }
+    };
+
+    // Key for the cache PrePlaybackBuilder::build(in) would produce, including the
+    // chord in.harmony carries into the build.
+    static Key keyFor(const PrePlaybackBuilder::Inputs& in);
+
+    // Per-user cache directory (QStandardPaths::CacheLocation + "/preplayback").
+    static QString defaultDirectory();
+    static QString pathFor(const QString& dir, const Key& key);
+
+    // Writes atomically (QSaveFile); creates `path`'s directory if needed.
+    static bool save(const QString& path, const Key& key, const PrePlaybackCache& cache, QString* outError = nullptr);
+
+    // Memory-maps `path` and restores the cache if the file matches `key` exactly.
+    // On failure `out` is left untouched.
+    static bool load(const QString& path, const Key& key, PrePlaybackCache* out, QString* outError = nullptr);
+
+    // In-memory codec (used by save/load; exposed for tests).
+    static QByteArray serialize(const Key& key, const PrePlaybackCache& cache);
+    static bool deserialize(const uchar* data, qint64 size, const Key& key, PrePlaybackCache* out, QString* outError = nullptr);
+};
+
+} // namespace playback
@@ -1,20 +1,61 @@
+// Compile-time log level (midi/TraceLog.h): below Debug, the qCDebug
+// diagnostics here are compiled out rather than just filtered at runtime.
+#if defined(MIDI_TRACE_MAX_LEVEL) && MIDI_TRACE_MAX_LEVEL < 3 && !defined(QT_NO_DEBUG_OUTPUT)
+#define QT_NO_DEBUG_OUTPUT
+#endif
+
 #include "ScaleSnapProcessor.h"
 
 #include <QDebug>
 #include <QDateTime>
-#include <QTimer>
+#include <QLoggingCategory>
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 
 #include "midiprocessor.h"
+#include "midi/TraceLog.h"
 #include "playback/HarmonyContext.h"
 #include "chart/ChartModel.h"
 #include "virtuoso/ontology/OntologyRegistry.h"
 #include "virtuoso/theory/ScaleSuggester.h"
 #include "music/Pitch.h"
 
+// Per-note diagnostics. Off by default (they used to stream on every guitar
+// attack); enable with QT_LOGGING_RULES="playback.scalesnap.debug=true".
+// The per-attack summaries go through the binary midi::trace() instead and
+// show up in the log with verbose on.
+Q_LOGGING_CATEGORY(lcScaleSnap, "playback.scalesnap", QtInfoMsg)
+
 namespace playback {
 
+static QDebug operator<<(QDebug dbg, const PitchClassSet& pcs)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "PitchClassSet(";
+    bool first = true;
+    for (int pc : pcs) {
+        if (!first) dbg << ", ";
+        dbg << pc;
+        first = false;
+    }
+    dbg << ')';
+    return dbg;
+}
+
+// Runs f on the thread that owns the note table (the MIDI worker; the caller
+// when there is no MidiProcessor or its worker isn't running) and waits.
+template <typename F>
+static void runOnOwner(MidiProcessor* midi, F&& f)
+{
+    if (!midi) {
+        f();
+        return;
+    }
+    using Fn = std::remove_reference_t<F>;
+    midi->runOnWorker([](void* ctx) { (*static_cast<Fn*>(ctx))(); }, &f);
+}
+
 ScaleSnapProcessor::ScaleSnapProcessor(QObject* parent)
     : QObject(parent)
 {
@@ -22,6 +63,7 @@ ScaleSnapProcessor::ScaleSnapProcessor(QObject* parent)
 
 ScaleSnapProcessor::~ScaleSnapProcessor()
 {
+    if (m_midi) m_midi->releaseGuitarStage(this);
     reset();
 }
 
@@ -29,8 +71,10 @@ void ScaleSnapProcessor::setMidiProcessor(MidiProcessor* midi)
 {
     if (m_midi) {
         disconnect(m_midi, nullptr, this, nullptr);
+        m_midi->releaseGuitarStage(this);
     }
     m_midi = midi;
+    if (m_midi) m_midi->setGuitarStage(this);
 
     // Apply the current lead mode's side effects now that we have a MidiProcessor.
     // The header default (Original) sets m_leadMode but never calls setLeadMode(),
@@ -45,26 +89,35 @@ void ScaleSnapProcessor::setMidiProcessor(MidiProcessor* midi)
 
 void ScaleSnapProcessor::setHarmonyContext(HarmonyContext* harmony)
 {
-    m_harmony = harmony;
+    runOnOwner(m_midi, [&] {
+        m_harmony = harmony;
+        rebuildHarmonicSnapshot();
+    });
 }
 
 void ScaleSnapProcessor::setOntology(const virtuoso::ontology::OntologyRegistry* ontology)
 {
-    m_ontology = ontology;
+    runOnOwner(m_midi, [&] {
+        m_ontology = ontology;
+        rebuildHarmonicSnapshot();
+    });
 }
 
 void ScaleSnapProcessor::setChartModel(const chart::ChartModel* model)
 {
-    m_model = model;
-    // Reset chord tracking when chart changes — UNLESS the user has set
-    // an explicit default chord via the footswitch / editor. Otherwise
-    // iReal Pro auto-loading at startup silently wipes the user's choice
-    // (because setChartModel runs after applyHarmonyChordToEngine in the
-    // ctor) and the engine ends up with no chord at all.
-    if (!m_useDefaultHarmonyChord) {
-        m_lastKnownChord = music::ChordSymbol{};
-        m_hasLastKnownChord = false;
-    }
+    runOnOwner(m_midi, [&] {
+        m_model = model;
+        // Reset chord tracking when chart changes — UNLESS the user has set
+        // an explicit default chord via the footswitch / editor. Otherwise
+        // iReal Pro auto-loading at startup silently wipes the user's choice
+        // (because setChartModel runs after applyHarmonyChordToEngine in the
+        // ctor) and the engine ends up with no chord at all.
+        if (!m_useDefaultHarmonyChord) {
+            m_lastKnownChord = music::ChordSymbol{};
+            m_hasLastKnownChord = false;
+        }
+        rebuildHarmonicSnapshot();
+    });
 }
 
 void ScaleSnapProcessor::setLeadMode(LeadMode mode)
@@ -260,7 +313,7 @@ void ScaleSnapProcessor::setVoiceSustainEnabled(bool enabled)
         m_voiceSustainEnabled = enabled;
         // Release any currently voice-sustained notes when disabling
         if (!enabled) {
-            releaseVoiceSustainedNotes();
+            runOnOwner(m_midi, [this] { releaseVoiceSustainedNotes(); });
         }
         emit voiceSustainEnabledChanged(enabled);
     }
@@ -271,9 +324,12 @@ void ScaleSnapProcessor::setSustainSmoothingEnabled(bool enabled)
     if (m_sustainSmoothingEnabled != enabled) {
         m_sustainSmoothingEnabled = enabled;
         // If disabling while timer is pending, release immediately
-        if (!enabled && m_sustainReleaseTimerActive) {
-            m_sustainReleaseTimerActive = false;
-            releaseVoiceSustainedNotes();
+        if (!enabled) {
+            runOnOwner(m_midi, [this] {
+                if (!m_sustainReleaseTimerActive) return;
+                m_sustainReleaseTimerActive = false;
+                releaseVoiceSustainedNotes();
+            });
         }
         emit sustainSmoothingEnabledChanged(enabled);
     }
@@ -319,7 +375,7 @@ void ScaleSnapProcessor::setHarmonyRange(int minNote, int maxNote)
     m_harmonyRangeMin = minNote;
     m_harmonyRangeMax = maxNote;
 
-    qDebug() << "ScaleSnap: Harmony range set to" << minNote << "-" << maxNote;
+    qCDebug(lcScaleSnap) << "ScaleSnap: Harmony range set to" << minNote << "-" << maxNote;
 }
 
 const HarmonyVoiceConfig& ScaleSnapProcessor::voiceConfig(int voiceIndex) const
@@ -338,8 +394,11 @@ void ScaleSnapProcessor::setVoiceConfig(int voiceIndex, const HarmonyVoiceConfig
         qWarning() << "ScaleSnap: Invalid voice index" << voiceIndex;
         return;
     }
-    m_voiceConfigs[voiceIndex] = config;
-    qDebug() << "ScaleSnap: Voice" << voiceIndex << "config set - motion:"
+    runOnOwner(m_midi, [&] {
+        m_voiceConfigs[voiceIndex] = config;
+        rebuildHarmonicSnapshot();  // voice tables
+    });
+    qCDebug(lcScaleSnap) << "ScaleSnap: Voice" << voiceIndex << "config set - motion:"
              << static_cast<int>(config.motionType) << "range:" << config.rangeMin << "-" << config.rangeMax;
 }
 
@@ -349,8 +408,11 @@ void ScaleSnapProcessor::setVoiceMotionType(int voiceIndex, VoiceMotionType type
         qWarning() << "ScaleSnap: Invalid voice index" << voiceIndex;
         return;
     }
-    m_voiceConfigs[voiceIndex].motionType = type;
-    qDebug() << "ScaleSnap: Voice" << voiceIndex << "motion type set to" << static_cast<int>(type);
+    runOnOwner(m_midi, [&] {
+        m_voiceConfigs[voiceIndex].motionType = type;
+        rebuildHarmonicSnapshot();  // voice tables
+    });
+    qCDebug(lcScaleSnap) << "ScaleSnap: Voice" << voiceIndex << "motion type set to" << static_cast<int>(type);
 }
 
 void ScaleSnapProcessor::setVoiceRange(int voiceIndex, int minNote, int maxNote)
@@ -367,7 +429,7 @@ void ScaleSnapProcessor::setVoiceRange(int voiceIndex, int minNote, int maxNote)
     }
     m_voiceConfigs[voiceIndex].rangeMin = minNote;
     m_voiceConfigs[voiceIndex].rangeMax = maxNote;
-    qDebug() << "ScaleSnap: Voice" << voiceIndex << "range set to" << minNote << "-" << maxNote;
+    qCDebug(lcScaleSnap) << "ScaleSnap: Voice" << voiceIndex << "range set to" << minNote << "-" << maxNote;
 }
 
 bool ScaleSnapProcessor::isMultiVoiceModeActive() const
@@ -395,6 +457,7 @@ void ScaleSnapProcessor::setHarmonyEnabled(bool enabled)
     if (!enabled && m_midi) {
         // kHarmonyChannels[] uses 1-based MIDI channel numbers in this file.
         for (int ch = 12; ch <= 15; ++ch) {
+            m_midi->cancelScheduledVirtualNotes(ch); // humanized attacks still pending
             m_midi->sendVirtualAllNotesOff(ch);
         }
     }
@@ -402,16 +465,18 @@ void ScaleSnapProcessor::setHarmonyEnabled(bool enabled)
 
 void ScaleSnapProcessor::setDefaultHarmonyChord(const music::ChordSymbol& chord)
 {
-    m_lastKnownChord = chord;
-    m_hasLastKnownChord = (chord.rootPc >= 0);
-    // Mark the chord as user-driven so the chart-driven path in
-    // computeValidPitchClasses doesn't silently overwrite it on the next
-    // guitar note. iReal Pro auto-loads at startup, which sets a chart
-    // model and was previously stealing the footswitch chord.
-    m_useDefaultHarmonyChord = m_hasLastKnownChord;
-    // Republish the voice-snap mask so ch-10 voice mirroring follows the
-    // new chord/scale immediately, not on the next guitar note.
-    publishVoiceScaleMask();
+    runOnOwner(m_midi, [&] {
+        m_lastKnownChord = chord;
+        m_hasLastKnownChord = (chord.rootPc >= 0);
+        // Mark the chord as user-driven so the chart-driven path in
+        // resolveHarmonyChord doesn't silently overwrite it on the next
+        // guitar note. iReal Pro auto-loads at startup, which sets a chart
+        // model and was previously stealing the footswitch chord.
+        m_useDefaultHarmonyChord = m_hasLastKnownChord;
+        // Rebuild the harmonic snapshot (and with it the ch-10 voice-snap mask)
+        // so the next guitar note and voice mirroring both see the new chord.
+        rebuildHarmonicSnapshot();
+    });
 }
 
 void ScaleSnapProcessor::setVoiceCh10SnapEnabled(bool enabled)
@@ -426,22 +491,57 @@ bool ScaleSnapProcessor::voiceCh10SnapEnabled() const
 
 void ScaleSnapProcessor::publishVoiceScaleMask()
 {
-    if (!m_midi) return;
-    // Build the 12-bit pitch-class bitmap from the current valid PCs.
+    runOnOwner(m_midi, [this] { rebuildHarmonicSnapshot(); });
+}
+
+std::shared_ptr<const ScaleSnapProcessor::HarmonicSnapshot> ScaleSnapProcessor::harmonicSnapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void ScaleSnapProcessor::rebuildHarmonicSnapshot()
+{
+    auto snap = std::make_shared<HarmonicSnapshot>();
+
+    // Resolution only reads; the chord it lands on is recorded here, the one
+    // place the chart-driven tracking advances, and everything below is
+    // derived from the snapshot's copy.
+    music::ChordSymbol resolved;
+    if (resolveHarmonyChord(resolved)) {
+        m_lastKnownChord = resolved;
+        m_hasLastKnownChord = true;
+    }
+    snap->hasChord = m_hasLastKnownChord && m_lastKnownChord.rootPc >= 0;
+    if (snap->hasChord) snap->chord = m_lastKnownChord;
+    snap->validPcs = computeValidPitchClasses(*snap);
+    snap->chordTones = computeChordTones(snap->chord);
+    snap->activeChord = buildActiveChord(*snap);
+    for (int pc = 0; pc < 12; ++pc) {
+        snap->nearestValidPc[pc] = static_cast<qint8>(snapToNearestValidPc(pc, snap->validPcs));
+    }
+
+    // Stateless voices depend only on (lead note, config, chord/scale): table them.
+    for (int v = 0; v < 4; ++v) {
+        const VoiceMotionType type = m_voiceConfigs[v].motionType;
+        const bool stateless = (type == VoiceMotionType::PARALLEL_FIXED) ||
+                               (type == VoiceMotionType::DRONE) ||
+                               (type == VoiceMotionType::SCALE_PARALLEL);
+        snap->voiceTabled[v] = stateless;
+        if (!stateless) continue;
+        for (int note = 0; note < 128; ++note) {
+            snap->voiceNotes[v][note] = static_cast<qint16>(generateHarmonyForVoice(v, note, *snap));
+        }
+    }
+
     // 0 means "no constraint" (passthrough on the worker side); we emit 0
     // only when no chord/scale is known so unsnapping happens by default
     // pre-chord.
-    const QSet<int> validPcs = computeValidPitchClasses();
-    uint16_t mask = 0;
-    for (int pc : validPcs) {
-        if (pc >= 0 && pc < 12) {
-            mask |= (uint16_t)(1u << pc);
-        }
-    }
-    m_midi->setVoiceCh10ScaleMask(mask);
+    const quint16 mask = snap->validPcs.mask();
+    std::atomic_store(&m_snapshot, std::shared_ptr<const HarmonicSnapshot>(std::move(snap)));
+    if (m_midi) m_midi->setVoiceCh10ScaleMask(mask);
 }
 
-QString ScaleSnapProcessor::scaleKeyForChord(const music::ChordSymbol& c) const
+QStringView ScaleSnapProcessor::scaleKeyForChord(const music::ChordSymbol& c) const
 {
     // The user's chord stepper produces these chord qualities. We pick a
     // single best-fit scale per quality, prioritizing what a guitar player
@@ -452,40 +552,41 @@ QString ScaleSnapProcessor::scaleKeyForChord(const music::ChordSymbol& c) const
     switch (c.quality) {
         case ChordQuality::Major:
             // maj / maj7 / maj9 / 6 / etc. — ionian.
-            return "ionian";
+            return u"ionian";
         case ChordQuality::Minor:
             // m7+ leans dorian (jazz idiom), plain "m" is natural minor.
             if (c.seventh == SeventhQuality::Minor7 || c.extension >= 7)
-                return "dorian";
-            return "aeolian";
+                return u"dorian";
+            return u"aeolian";
         case ChordQuality::Dominant:
-            return "mixolydian";
+            return u"mixolydian";
         case ChordQuality::Diminished:
-            return "locrian";
+            return u"locrian";
         case ChordQuality::HalfDiminished:
-            return "locrian";
+            return u"locrian";
         case ChordQuality::Augmented:
-            return "lydian_augmented";
+            return u"lydian_augmented";
         case ChordQuality::Sus2:
         case ChordQuality::Sus4:
-            return "mixolydian";
+            return u"mixolydian";
         case ChordQuality::Power5:
         case ChordQuality::Unknown:
         default:
-            return "ionian";
+            return u"ionian";
     }
 }
 
 QString ScaleSnapProcessor::currentScaleSummary(bool preferFlats) const
 {
-    if (!m_hasLastKnownChord || m_lastKnownChord.rootPc < 0 || !m_ontology) {
+    const std::shared_ptr<const HarmonicSnapshot> snap = harmonicSnapshot();
+    if (!snap || !snap->hasChord || !m_ontology) {
         return QString();
     }
-    const QString scaleKey = scaleKeyForChord(m_lastKnownChord);
+    const QStringView scaleKey = scaleKeyForChord(snap->chord);
     const auto* sd = m_ontology->scale(scaleKey);
     if (!sd) return QString();
 
-    const int rootPc = normalizePc(m_lastKnownChord.rootPc);
+    const int rootPc = normalizePc(snap->chord.rootPc);
     const QString rootName = music::spellPitchClass(rootPc, preferFlats);
 
     QStringList notes;
@@ -516,7 +617,6 @@ void ScaleSnapProcessor::setCurrentCellIndex(int cellIndex)
     }
 
     const int previousCellIndex = m_currentCellIndex;
-    m_currentCellIndex = cellIndex;
 
     // Check if chord changed and re-conform any active notes
     // This applies to BOTH lead conformance AND harmony - harmony notes need
@@ -524,27 +624,77 @@ void ScaleSnapProcessor::setCurrentCellIndex(int cellIndex)
     // Also applies to multi-voice mode where each voice needs re-conformance.
     const bool multiVoiceActive = isMultiVoiceModeActive();
     const bool legacyHarmonyActive = !multiVoiceActive && (legacyHarmonyOn());
-    bool needsReconform = false;
-    {
-        QReadLocker lock(&m_activeNotesLock);
-        needsReconform = !m_activeNotes.isEmpty() &&
-                              (m_leadMode == LeadMode::Conformed || multiVoiceActive || legacyHarmonyActive);
+    runOnOwner(m_midi, [&] {
+        m_currentCellIndex = cellIndex;
+        const bool needsReconform = !m_activeNotes.isEmpty() &&
+                                    (m_leadMode == LeadMode::Conformed || multiVoiceActive || legacyHarmonyActive);
+        // The chart chord and local key are resolved per cell: refresh the
+        // snapshot here, off the note-on path (a re-conform already did).
+        if (!needsReconform || !checkAndReconformOnChordChange(previousCellIndex)) {
+            rebuildHarmonicSnapshot();
+        }
+    });
+}
+
+void ScaleSnapProcessor::setBeatPosition(float beatPosition)
+{
+    m_beatPosition = beatPosition;
+}
+
+void ScaleSnapProcessor::tick(std::int64_t nowNs)
+{
+    if (m_sustainReleaseTimerActive && nowNs >= m_sustainReleaseDueNs) {
+        m_sustainReleaseTimerActive = false;
+        qCDebug(lcScaleSnap) << "ScaleSnap: Sustain hold timer expired, releasing voice-sustained notes";
+        releaseVoiceSustainedNotes();
+    }
+    // Real elapsed time; capped so a stalled worker doesn't jump a bend or delay to its end.
+    // The first tick after an idle stretch only starts the clock.
+    const float deltaMs = (m_lastTickNs > 0) ? qBound(0.0f, float(nowNs - m_lastTickNs) / 1e6f, 50.0f) : 0.0f;
+    m_lastTickNs = nowNs;
+    updateConformance(deltaMs);
+    if (!conformanceTickPending()) {
+        m_lastTickNs = 0;
     }
+}
 
-    if (needsReconform) {
-        checkAndReconformOnChordChange(previousCellIndex);
+std::int64_t ScaleSnapProcessor::nextTickDeadlineNs() const
+{
+    std::int64_t due = kNoTickDeadline;
+    if (conformanceTickPending()) {
+        // Work that just started ticks at once; running work keeps the cadence.
+        due = (m_lastTickNs > 0) ? m_lastTickNs + kTickPeriodNs : 0;
     }
+    if (m_sustainReleaseTimerActive && (due == kNoTickDeadline || m_sustainReleaseDueNs < due)) {
+        due = m_sustainReleaseDueNs;
+    }
+    return due;
 }
 
-void ScaleSnapProcessor::setBeatPosition(float beatPosition)
+bool ScaleSnapProcessor::conformanceTickPending() const
 {
-    m_beatPosition = beatPosition;
+    if (m_leadMode == LeadMode::VocalSync) {
+        // The shift follows the voice every tick while both pitches are live (see emitVocalSyncShift()).
+        return m_glissando.isGliding() || (m_midi && m_vocalSyncVoiceHz >= 50.0 && m_vocalSyncGuitarHz >= 20.0);
+    }
+    if (m_leadMode != LeadMode::Conformed) {
+        return false;
+    }
+    for (auto it = m_activeNotes.constBegin(); it != m_activeNotes.constEnd(); ++it) {
+        const ActiveNote& note = it.value();
+        if (note.isDelayed || note.isTimedSnap || note.isTimedBend) {
+            return true;
+        }
+        if (note.behavior == ConformanceBehavior::BEND &&
+            std::abs(note.conformanceBendTarget - note.conformanceBendCurrent) > 0.5f) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ScaleSnapProcessor::updateConformance(float deltaMs)
 {
-    QWriteLocker lock(&m_activeNotesLock);
-
     // VocalSync: advance glissando and send shift
     if (m_leadMode == LeadMode::VocalSync) {
         if (m_glissando.isGliding()) {
@@ -570,7 +720,7 @@ void ScaleSnapProcessor::updateConformance(float deltaMs)
                 // Delay complete - emit the note now
                 note.isDelayed = false;
                 emitNoteOn(kChannelLead, note.snappedNote, note.delayedVelocity);
-                qDebug() << "ScaleSnap: Delayed note" << note.snappedNote << "now playing after delay";
+                qCDebug(lcScaleSnap) << "ScaleSnap: Delayed note" << note.snappedNote << "now playing after delay";
             }
         }
 
@@ -589,7 +739,7 @@ void ScaleSnapProcessor::updateConformance(float deltaMs)
                     emitNoteOn(kChannelLead, newNote, note.velocity);
                     note.snappedNote = newNote;
                     note.referenceHz = midiNoteToHz(newNote);
-                    qDebug() << "ScaleSnap: TIMED_SNAP triggered - snapped" << oldNote << "->" << newNote;
+                    qCDebug(lcScaleSnap) << "ScaleSnap: TIMED_SNAP triggered - snapped" << oldNote << "->" << newNote;
                 }
             }
         }
@@ -637,7 +787,7 @@ void ScaleSnapProcessor::updateConformance(float deltaMs)
         bendValue = qBound(0, bendValue, 16383);
         emitPitchBend(kChannelLead, bendValue);
 
-        qDebug() << "ScaleSnap: Applying bend" << note.conformanceBendCurrent
+        qCDebug(lcScaleSnap) << "ScaleSnap: Applying bend" << note.conformanceBendCurrent
                  << "cents, MIDI value:" << bendValue;
     } else if (needsBendUpdate && m_activeNotes.size() > 1) {
         // Multiple notes active - reset pitch bend to center
@@ -647,86 +797,98 @@ void ScaleSnapProcessor::updateConformance(float deltaMs)
 
 void ScaleSnapProcessor::reset()
 {
-    emitAllNotesOff();
-    {
-        QWriteLocker lock(&m_activeNotesLock);
+    runOnOwner(m_midi, [this] {
+        emitAllNotesOff();
         m_activeNotes.clear();
-    }
-    m_lastGuitarHz = 0.0;
-    m_lastGuitarCents = 0.0;
-    m_lastVoiceCents = 0.0;
-    m_voiceCentsAverage = 0.0;
-    m_voiceCentsAverageInitialized = false;
-    m_settlingCounter = 0;
-    m_vibratoFadeInSamples = 0;
-    m_oscillationDetected = false;
-    m_lastOscillation = 0.0;
-    m_lastCc2Value = 0;
-    // Reset fast playing and machine-gun prevention tracking
-    m_lastNoteOnTimestamp = 0;
-    m_currentlyPlayingNote = -1;
-    m_currentNoteWasSnapped = false;
-    // Reset chromatic sweep detection
-    m_recentIntervals.fill(0);
-    m_recentIntervalsIndex = 0;
-    m_lastInputNote = -1;
-    // Reset lead melody direction tracking
-    m_lastHarmonyLeadNote = -1;
-    m_leadMelodyDirection = 0;
-    m_lastHarmonyOutputNote = -1;
-    m_lastGuitarNoteOffTimestamp = 0;  // Reset phrase tracking
-    m_guitarNotesHeld = 0;
-    // Reset glissando and VocalSync state
-    m_glissando.clear();
-    m_vocalSyncGuitarHz = 0.0;
-    m_vocalSyncVoiceHz = 0.0;
-    m_vocalSyncLastShiftSent = 999;
-    // Reset octave guard
-    m_octaveGuardAcceptedHz = 0.0;
-    m_octaveGuardCandidateHz = 0.0;
-    m_octaveGuardConfirmCount = 0;
-    // Reset pitch bend to center on all channels
-    emitPitchBend(kChannelVocalSync, 8192);
-    emitPitchBend(kChannelLead, 8192);
-    emitPitchBend(kChannelHarmony1, 8192);
-    emitPitchBend(kChannelHarmony2, 8192);
-    emitPitchBend(kChannelHarmony3, 8192);
-    emitPitchBend(kChannelHarmony4, 8192);
+        m_lastGuitarHz = 0.0;
+        m_lastGuitarCents = 0.0;
+        m_lastVoiceCents = 0.0;
+        m_voiceCentsAverage = 0.0;
+        m_voiceCentsAverageInitialized = false;
+        m_settlingCounter = 0;
+        m_vibratoFadeInSamples = 0;
+        m_oscillationDetected = false;
+        m_lastOscillation = 0.0;
+        m_lastCc2Value = 0;
+        // Reset fast playing and machine-gun prevention tracking
+        m_lastNoteOnTimestamp = 0;
+        m_currentlyPlayingNote = -1;
+        m_currentNoteWasSnapped = false;
+        // Reset chromatic sweep detection
+        m_recentIntervals.fill(0);
+        m_recentIntervalsIndex = 0;
+        m_lastInputNote = -1;
+        // Reset lead melody direction tracking
+        m_lastHarmonyLeadNote = -1;
+        m_leadMelodyDirection = 0;
+        m_lastHarmonyOutputNote = -1;
+        m_lastGuitarNoteOffTimestamp = 0;  // Reset phrase tracking
+        m_guitarNotesHeld = 0;
+        // Reset glissando and VocalSync state
+        m_glissando.clear();
+        m_vocalSyncGuitarHz = 0.0;
+        m_vocalSyncVoiceHz = 0.0;
+        m_vocalSyncLastShiftSent = 999;
+        // Reset octave guard
+        m_octaveGuardAcceptedHz = 0.0;
+        m_octaveGuardCandidateHz = 0.0;
+        m_octaveGuardConfirmCount = 0;
+        // Reset pitch bend to center on all channels
+        emitPitchBend(kChannelVocalSync, 8192);
+        emitPitchBend(kChannelLead, 8192);
+        emitPitchBend(kChannelHarmony1, 8192);
+        emitPitchBend(kChannelHarmony2, 8192);
+        emitPitchBend(kChannelHarmony3, 8192);
+        emitPitchBend(kChannelHarmony4, 8192);
+    });
 }
 
 void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
 {
-    qDebug() << "ScaleSnap::onGuitarNoteOn - leadMode:" << static_cast<int>(m_leadMode)
+    qCDebug(lcScaleSnap) << "ScaleSnap::onGuitarNoteOn - leadMode:" << static_cast<int>(m_leadMode)
              << "harmonyMode:" << static_cast<int>(m_harmonyMode)
              << "midi:" << (m_midi != nullptr) << "note:" << midiNote << "vel:" << velocity;
 
     // Both modes off means nothing to do
     if (m_leadMode == LeadMode::Off && m_harmonyMode == HarmonyMode::OFF) {
-        qDebug() << "ScaleSnap: Exiting early - both modes are Off";
+        qCDebug(lcScaleSnap) << "ScaleSnap: Exiting early - both modes are Off";
         return;
     }
 
     if (!m_midi) {
-        qDebug() << "ScaleSnap: Exiting early - no midi processor";
+        qCDebug(lcScaleSnap) << "ScaleSnap: Exiting early - no midi processor";
         return;
     }
 
-    // Thread safety: Lock for the duration of this function since we access m_activeNotes
-    QWriteLocker lock(&m_activeNotesLock);
-
     // NOTE: We do NOT call releaseVoiceSustainedNotes() here anymore.
     // It will be called later, only if we're actually going to play a new note.
     // This allows repeated wrong notes and fast-playing skips to keep notes sustained.
 
-    qDebug() << "ScaleSnap: cellIndex=" << m_currentCellIndex
-             << "hasChord=" << m_hasLastKnownChord
+    // Current chord/scale context, derived at chord-change time (see rebuildHarmonicSnapshot).
+    // Only the snapshot is read here: the chord-tracking members belong to whoever rebuilds it.
+    std::shared_ptr<const HarmonicSnapshot> snap = harmonicSnapshot();
+    if (!snap) {
+        rebuildHarmonicSnapshot();
+        snap = harmonicSnapshot();
+    }
+
+    qCDebug(lcScaleSnap) << "ScaleSnap: cellIndex=" << m_currentCellIndex
+             << "hasChord=" << snap->hasChord
              << "harmony=" << (m_harmony != nullptr)
              << "ontology=" << (m_ontology != nullptr)
              << "model=" << (m_model != nullptr);
-
-    // Compute valid pitch classes from current chord/scale
-    const QSet<int> validPcs = computeValidPitchClasses();
-    qDebug() << "ScaleSnap: validPcs size=" << validPcs.size() << "pcs=" << validPcs;
+    const PitchClassSet validPcs = snap->validPcs;
+    const PitchClassSet chordTones = snap->chordTones;
+    const ActiveChord& activeChord = snap->activeChord;
+    qCDebug(lcScaleSnap) << "ScaleSnap: validPcs size=" << validPcs.size() << "pcs=" << validPcs;
+
+    // Stateless voices come straight from the snapshot's per-voice tables.
+    auto harmonyForVoice = [&](int v, const VoiceNoteList& others) {
+        if (snap->voiceTabled[v] && midiNote >= 0 && midiNote < 128) {
+            return int(snap->voiceNotes[v][midiNote]);
+        }
+        return generateHarmonyForVoice(v, midiNote, *snap, others);
+    };
 
     // Pre-compute the harmony pitch we WILL emit on each voice for this
     // new lead. This must happen BEFORE the lead-conformance path calls
@@ -738,12 +900,11 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
         m_skipUpcomingOn.fill(false);
         m_upcomingHarmony.fill(-1);
         if (isMultiVoiceModeActive()) {
-            const QSet<int> chordTones = computeChordTones(m_lastKnownChord);
-            QVector<int> generated;
+            VoiceNoteList generated;
             generated.append(midiNote); // include lead so clash logic accounts for it
             for (int v = 0; v < 4; ++v) {
                 if (!m_voiceConfigs[v].isEnabled()) continue;
-                const int h = generateHarmonyForVoice(v, midiNote, chordTones, validPcs, generated);
+                const int h = harmonyForVoice(v, generated);
                 m_upcomingHarmony[v] = h;
                 if (h >= 0) generated.append(h);
             }
@@ -783,35 +944,34 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
             releaseVoiceSustainedNotes();
             active.snappedNote = midiNote;
             active.referenceHz = midiNoteToHz(midiNote);
-            qDebug() << "ScaleSnap ORIGINAL: Emitting note" << midiNote << "on channel" << kChannelLead;
+            qCDebug(lcScaleSnap) << "ScaleSnap ORIGINAL: Emitting note" << midiNote << "on channel" << kChannelLead;
             emitNoteOn(kChannelLead, midiNote, velocity);
         } else if (m_leadMode == LeadMode::Conformed) {
             // Conformed mode: use PitchConformanceEngine for gravity-based correction
-            qDebug() << "ScaleSnap CONFORMED: validPcs.isEmpty()=" << validPcs.isEmpty()
-                     << "m_hasLastKnownChord=" << m_hasLastKnownChord;
+            qCDebug(lcScaleSnap) << "ScaleSnap CONFORMED: validPcs.isEmpty()=" << validPcs.isEmpty()
+                     << "hasChord=" << snap->hasChord;
 
-            if (validPcs.isEmpty() || !m_hasLastKnownChord) {
+            if (validPcs.isEmpty() || !snap->hasChord) {
                 // No chord/scale info - pass through unchanged
-                qDebug() << "ScaleSnap CONFORMED: No chord/scale info - passing through unchanged";
+                qCDebug(lcScaleSnap) << "ScaleSnap CONFORMED: No chord/scale info - passing through unchanged";
                 releaseVoiceSustainedNotes();
                 active.snappedNote = midiNote;
                 active.referenceHz = midiNoteToHz(midiNote);
                 active.behavior = ConformanceBehavior::ALLOW;
                 emitNoteOn(kChannelLead, midiNote, velocity);
             } else {
-                // Build ActiveChord for conformance
-                ActiveChord activeChord = buildActiveChord();
-
                 // Debug: show actual pitch classes in tier1
-                QString tier1Pcs;
-                for (int pc : activeChord.tier1Absolute) {
-                    static const char* noteNames[] = {"C","C#","D","D#","E","F","F#","G","G#","A","A#","B"};
-                    tier1Pcs += QString("%1(%2) ").arg(noteNames[pc]).arg(pc);
+                if (lcScaleSnap().isDebugEnabled()) {
+                    QString tier1Pcs;
+                    for (int pc : activeChord.tier1Absolute) {
+                        static const char* noteNames[] = {"C","C#","D","D#","E","F","F#","G","G#","A","A#","B"};
+                        tier1Pcs += QString("%1(%2) ").arg(noteNames[pc]).arg(pc);
+                    }
+                    qCDebug(lcScaleSnap) << "ScaleSnap CONFORMED: rootPc=" << activeChord.rootPc
+                             << "chordKey=" << activeChord.ontologyChordKey
+                             << "T1 notes:" << tier1Pcs
+                             << "T1 size=" << activeChord.tier1Absolute.size();
                 }
-                qDebug() << "ScaleSnap CONFORMED: rootPc=" << activeChord.rootPc
-                         << "chordKey=" << activeChord.ontologyChordKey
-                         << "T1 notes:" << tier1Pcs
-                         << "T1 size=" << activeChord.tier1Absolute.size();
 
                 // ================================================================
                 // INTERVAL TRACKING FOR CHROMATIC SWEEP DETECTION
@@ -842,7 +1002,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                 const bool isScaleTone = activeChord.isValidScaleTone(inputPc);  // T1, T2, or T3
                 const bool isChromaticSweep = isLikelyChromaticSweep();
 
-                qDebug() << "ScaleSnap: timeSinceLastNote=" << timeSinceLastNote
+                qCDebug(lcScaleSnap) << "ScaleSnap: timeSinceLastNote=" << timeSinceLastNote
                          << "isFastPlaying=" << isFastPlaying
                          << "isChordTone=" << isChordTone
                          << "isScaleTone=" << isScaleTone
@@ -862,7 +1022,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                 if (isFastPlaying && !isChordTone) {
                     if (isChromaticSweep) {
                         // Chromatic sweep: skip non-chord tones
-                        qDebug() << "ScaleSnap: SKIPPING non-chord tone during chromatic sweep";
+                        qCDebug(lcScaleSnap) << "ScaleSnap: SKIPPING non-chord tone during chromatic sweep";
                         if (sustainActive) {
                             for (auto it = m_activeNotes.begin(); it != m_activeNotes.end(); ++it) {
                                 it.value().voiceSustained = true;
@@ -871,11 +1031,11 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                         return;  // Exit early - don't process this note
                     } else if (isScaleTone) {
                         // Melodic pattern with scale tone: allow it through
-                        qDebug() << "ScaleSnap: ALLOWING scale tone during fast melodic pattern";
+                        qCDebug(lcScaleSnap) << "ScaleSnap: ALLOWING scale tone during fast melodic pattern";
                         // Fall through to normal processing
                     } else {
                         // Fast playing + chromatic (T4) note = skip
-                        qDebug() << "ScaleSnap: SKIPPING chromatic note during fast playing";
+                        qCDebug(lcScaleSnap) << "ScaleSnap: SKIPPING chromatic note during fast playing";
                         if (sustainActive) {
                             for (auto it = m_activeNotes.begin(); it != m_activeNotes.end(); ++it) {
                                 it.value().voiceSustained = true;
@@ -919,7 +1079,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                         // → sustain, don't retrigger.  Only mark voice-sustained
                         // when sustain is actually engaged (otherwise the flag
                         // would block the previous note's release later).
-                        qDebug() << "ScaleSnap: Wrong fret" << midiNote << "would snap to already-playing"
+                        qCDebug(lcScaleSnap) << "ScaleSnap: Wrong fret" << midiNote << "would snap to already-playing"
                                  << m_currentlyPlayingNote << "- sustaining instead";
                         if (sustainActive) {
                             for (auto it = m_activeNotes.begin(); it != m_activeNotes.end(); ++it) {
@@ -930,15 +1090,15 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                     }
                     // else: Player is playing the correct fret for this note
                     // Allow retrigger (fall through to normal processing)
-                    qDebug() << "ScaleSnap: Correct fret" << midiNote << "for note"
+                    qCDebug(lcScaleSnap) << "ScaleSnap: Correct fret" << midiNote << "for note"
                              << outputNote << "- allowing retrigger";
                 }
 
                 // (conformance result already computed above for machine-gun check)
 
-                qDebug() << "ScaleSnap: LEAD INPUT" << midiNote << "-> OUTPUT" << outputNote
-                         << "behavior:" << static_cast<int>(result.behavior)
-                         << "snapTarget:" << result.snapTargetPitch;
+                midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::ScaleSnap, midi::TraceEvent::ScaleSnapLead,
+                                                     midiNote, outputNote, static_cast<int>(result.behavior),
+                                                     result.snapTargetPitch);
 
                 active.snappedNote = outputNote;
                 active.referenceHz = midiNoteToHz(outputNote);
@@ -965,7 +1125,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                         // Track: this note was snapped (wrong fret)
                         m_currentlyPlayingNote = outputNote;
                         m_currentNoteWasSnapped = true;
-                        qDebug() << "ScaleSnap: SNAP (down) - note" << midiNote
+                        qCDebug(lcScaleSnap) << "ScaleSnap: SNAP (down) - note" << midiNote
                                  << "snapped to" << outputNote;
                         break;
 
@@ -982,7 +1142,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                         m_currentlyPlayingNote = result.snapTargetPitch;
                         m_currentNoteWasSnapped = true;
 
-                        qDebug() << "ScaleSnap: TIMED_SNAP (up) - note" << midiNote
+                        qCDebug(lcScaleSnap) << "ScaleSnap: TIMED_SNAP (up) - note" << midiNote
                                  << "will snap to" << result.snapTargetPitch
                                  << "after" << result.snapDelayMs << "ms if held";
                         break;
@@ -991,7 +1151,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                     case ConformanceBehavior::TIMED_BEND:
                     case ConformanceBehavior::BEND:
                         // Bends disabled - just emit the note unchanged
-                        qDebug() << "ScaleSnap: BEND behavior disabled, emitting note unchanged";
+                        qCDebug(lcScaleSnap) << "ScaleSnap: BEND behavior disabled, emitting note unchanged";
                         emitNoteOn(kChannelLead, midiNote, velocity);
                         break;
 
@@ -1000,7 +1160,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                         active.isDelayed = true;
                         active.delayRemainingMs = result.delayMs;
                         active.delayedVelocity = velocity;
-                        qDebug() << "ScaleSnap: DELAY behavior - note" << outputNote
+                        qCDebug(lcScaleSnap) << "ScaleSnap: DELAY behavior - note" << outputNote
                                  << "delayed by" << result.delayMs << "ms";
                         break;
                 }
@@ -1043,17 +1203,16 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                             .arg(m_harmonyEnabled.load() ? "Y" : "N")
                             .arg(multiVoiceActive ? "Y" : "N")
                             .arg(legacyHarmonyActive ? "Y" : "N")
-                            .arg(m_hasLastKnownChord ? "Y" : "N")
-                            .arg(m_lastKnownChord.rootPc)
+                            .arg(snap->hasChord ? "Y" : "N")
+                            .arg(snap->chord.rootPc)
                             .arg(int(validPcs.size()))
                             .arg(perVoice));
     }
 
     if (multiVoiceActive || legacyHarmonyActive) {
-        qDebug() << "ScaleSnap: HARMONY MODE IS ACTIVE - multiVoice:" << multiVoiceActive
+        qCDebug(lcScaleSnap) << "ScaleSnap: HARMONY MODE IS ACTIVE - multiVoice:" << multiVoiceActive
                  << "legacy:" << legacyHarmonyActive << "lead note:" << midiNote;
-        const QSet<int> chordTones = computeChordTones(m_lastKnownChord);
-        qDebug() << "ScaleSnap Harmony: chordTones=" << chordTones << "validPcs=" << validPcs;
+        qCDebug(lcScaleSnap) << "ScaleSnap Harmony: chordTones=" << chordTones << "validPcs=" << validPcs;
 
         // Check for phrase timeout (new phrase = reset contrary motion)
         // The phrase resets when you STOPPED PLAYING GUITAR for > threshold
@@ -1064,10 +1223,10 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
             // We were silent (no guitar notes held), check how long
             qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
             qint64 silenceDuration = currentTime - m_lastGuitarNoteOffTimestamp;
-            qDebug() << "ScaleSnap CONTRARY: was silent for" << silenceDuration << "ms (threshold=" << kPhraseTimeoutMs << ")";
+            qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: was silent for" << silenceDuration << "ms (threshold=" << kPhraseTimeoutMs << ")";
             if (silenceDuration > kPhraseTimeoutMs) {
                 // New phrase! Reset contrary motion tracking for legacy mode
-                qDebug() << "ScaleSnap CONTRARY: NEW PHRASE detected after" << silenceDuration << "ms silence";
+                qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: NEW PHRASE detected after" << silenceDuration << "ms silence";
                 m_lastHarmonyLeadNote = -1;
                 m_lastHarmonyOutputNote = -1;
                 m_leadMelodyDirection = 0;
@@ -1082,9 +1241,6 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
         m_guitarNotesHeld++;
         m_lastGuitarNoteOffTimestamp = 0;  // Clear since we're playing
 
-        // Build active chord for validation
-        ActiveChord activeChord = buildActiveChord();
-
         // Apply harmony velocity scaling
         int harmonyVelocity = static_cast<int>(velocity * m_harmonyConfig.velocityRatio);
         harmonyVelocity = qBound(1, harmonyVelocity, 127);
@@ -1095,7 +1251,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
             static const int kHarmonyChannels[4] = {kChannelHarmony1, kChannelHarmony2, kChannelHarmony3, kChannelHarmony4};
 
             // Collect already-generated harmony notes to pass to subsequent voices
-            QVector<int> generatedHarmonyNotes;
+            VoiceNoteList generatedHarmonyNotes;
             generatedHarmonyNotes.append(midiNote);  // Include lead note to avoid clashes with it too
 
             for (int voiceIdx = 0; voiceIdx < 4; ++voiceIdx) {
@@ -1105,7 +1261,7 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                 }
 
                 // Generate harmony for this voice, passing already-generated notes for clash avoidance
-                int harmonyNote = generateHarmonyForVoice(voiceIdx, midiNote, chordTones, validPcs, generatedHarmonyNotes);
+                int harmonyNote = harmonyForVoice(voiceIdx, generatedHarmonyNotes);
 
                 // Validate (ensure not chromatic T4) — but ONLY for the
                 // legacy motion modes. The new PARALLEL_FIXED and DRONE modes
@@ -1133,8 +1289,9 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
                 m_voiceConfigs[voiceIdx].lastLeadNote = midiNote;
                 m_voiceConfigs[voiceIdx].lastOutputNote = harmonyNote;
 
-                qDebug() << "ScaleSnap Multi-Voice" << voiceIdx << ":" << midiNote << "->" << harmonyNote
-                         << "ch" << kHarmonyChannels[voiceIdx];
+                midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::ScaleSnap,
+                                                     midi::TraceEvent::ScaleSnapHarmonyVoice,
+                                                     voiceIdx, midiNote, harmonyNote, kHarmonyChannels[voiceIdx]);
 
                 // Emit the harmony note (with humanization delay if enabled).
                 // Voice-sustained tie: skip the on if releaseNote already
@@ -1195,7 +1352,8 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
             // Track the harmony output for next iteration (used by CONTRARY mode)
             m_lastHarmonyOutputNote = active.harmonyNote;
 
-            qDebug() << "ScaleSnap Harmony (legacy): INPUT" << midiNote << "-> HARMONY" << active.harmonyNote;
+            midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::ScaleSnap, midi::TraceEvent::ScaleSnapHarmonyLegacy,
+                                                 midiNote, active.harmonyNote);
 
             if (active.harmonyNote >= 0 && active.harmonyNote <= 127) {
                 emitHarmonyNoteOn(kChannelHarmony1, active.harmonyNote, harmonyVelocity, 0);
@@ -1212,23 +1370,12 @@ void ScaleSnapProcessor::onGuitarNoteOn(int midiNote, int velocity)
     // bug.
     m_upcomingHarmony.fill(-1);
     m_skipUpcomingOn.fill(false);
-
-    // The chart-driven path inside computeValidPitchClasses may have updated
-    // m_lastKnownChord (via const_cast) when the cell index advanced. Push
-    // the resulting scale mask out to MidiProcessor so ch-10 voice mirroring
-    // tracks chord changes between guitar notes too, not just on
-    // setDefaultHarmonyChord.
-    publishVoiceScaleMask();
 }
 
 void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
 {
-    // Thread safety: Lock for the duration of this function since we access m_activeNotes
-    QWriteLocker lock(&m_activeNotesLock);
-
-    qDebug() << "ScaleSnap::onGuitarNoteOff - note:" << midiNote
-             << "activeNotes count:" << m_activeNotes.size()
-             << "guitarNotesHeld:" << m_guitarNotesHeld;
+    midi::trace<midi::TraceLevel::Debug>(midi::TraceCategory::ScaleSnap, midi::TraceEvent::ScaleSnapNoteOff,
+                                         midiNote, m_activeNotes.size(), m_guitarNotesHeld);
 
     // Track guitar note release for phrase detection (BEFORE checking modes or voice sustain)
     // This tracks when you physically release the guitar string, regardless of voice sustain
@@ -1237,7 +1384,7 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
         if (m_guitarNotesHeld == 0) {
             // All guitar notes released - start silence timer
             m_lastGuitarNoteOffTimestamp = QDateTime::currentMSecsSinceEpoch();
-            qDebug() << "ScaleSnap: All guitar notes released - silence timer started";
+            qCDebug(lcScaleSnap) << "ScaleSnap: All guitar notes released - silence timer started";
         }
     }
 
@@ -1252,11 +1399,11 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
 
     auto it = m_activeNotes.find(midiNote);
     if (it == m_activeNotes.end()) {
-        qDebug() << "ScaleSnap: Note" << midiNote << "not found in activeNotes, ignoring noteOff";
+        qCDebug(lcScaleSnap) << "ScaleSnap: Note" << midiNote << "not found in activeNotes, ignoring noteOff";
         return;
     }
 
-    qDebug() << "ScaleSnap: Found note" << midiNote << "in activeNotes, voiceSustained="
+    qCDebug(lcScaleSnap) << "ScaleSnap: Found note" << midiNote << "in activeNotes, voiceSustained="
              << it.value().voiceSustained << "snappedNote=" << it.value().snappedNote;
 
     // If note is already marked as voice-sustained (e.g., from repeated wrong note
@@ -1272,7 +1419,7 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
         const bool sustainActive = m_voiceSustainEnabled &&
                                    (m_lastCc2Value > m_voiceSustainThreshold);
         if (!sustainActive) {
-            qDebug() << "ScaleSnap: Note" << midiNote
+            qCDebug(lcScaleSnap) << "ScaleSnap: Note" << midiNote
                      << "was flagged voiceSustained but sustain is inactive"
                      << "(enabled=" << m_voiceSustainEnabled
                      << "cc2=" << m_lastCc2Value
@@ -1281,7 +1428,7 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
             it.value().voiceSustained = false;
             // fall through to normal release path below
         } else {
-            qDebug() << "ScaleSnap: Note" << midiNote << "is voice-sustained, not releasing";
+            qCDebug(lcScaleSnap) << "ScaleSnap: Note" << midiNote << "is voice-sustained, not releasing";
             return;
         }
     }
@@ -1290,7 +1437,7 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
     if (m_voiceSustainEnabled && m_lastCc2Value > m_voiceSustainThreshold) {
         // Mark note as voice-sustained instead of releasing
         it.value().voiceSustained = true;
-        qDebug() << "ScaleSnap: Voice sustaining note" << midiNote << "CC2=" << m_lastCc2Value;
+        qCDebug(lcScaleSnap) << "ScaleSnap: Voice sustaining note" << midiNote << "CC2=" << m_lastCc2Value;
 
         // Release bend prevention: reset guitar bend to center so the string release
         // pitch droop from MG3 doesn't make the sustained note go sour
@@ -1328,7 +1475,7 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
         // Clear machine-gun prevention state when all notes released
         m_currentlyPlayingNote = -1;
         m_currentNoteWasSnapped = false;
-        qDebug() << "ScaleSnap: All notes released";
+        qCDebug(lcScaleSnap) << "ScaleSnap: All notes released";
         if (m_leadMode == LeadMode::VocalSync) {
             // All guitar notes released — reset to passthrough
             m_vocalSyncGuitarHz = 0.0;
@@ -1344,9 +1491,6 @@ void ScaleSnapProcessor::onGuitarNoteOff(int midiNote)
 
 void ScaleSnapProcessor::onGuitarHzUpdated(double hz)
 {
-    // Thread safety: Lock for reading m_activeNotes
-    QReadLocker lock(&m_activeNotesLock);
-
     // VocalSync mode: update glissando target with guitar pitch bend
     if (m_leadMode == LeadMode::VocalSync && m_midi && !m_activeNotes.isEmpty() && hz > 0.0) {
         // Release bend prevention: freeze during voice sustain
@@ -1462,31 +1606,24 @@ void ScaleSnapProcessor::onVoiceCc2Updated(int value)
     }
 
     // Voice sustain: release sustained notes when CC2 drops below threshold
-    // Note: releaseVoiceSustainedNotes() acquires its own lock
     if (m_voiceSustainEnabled && previousCc2 > m_voiceSustainThreshold && value <= m_voiceSustainThreshold) {
         if (m_sustainSmoothingEnabled && m_sustainSmoothingMs > 0) {
-            // Delayed release: start timer so brief silences don't kill sustain
+            // Delayed release: arm the hold deadline (fired by tick()) so brief silences don't kill sustain
             if (!m_sustainReleaseTimerActive) {
                 m_sustainReleaseTimerActive = true;
-                qDebug() << "ScaleSnap: CC2 dropped below threshold, starting sustain hold timer (" << m_sustainSmoothingMs << "ms)";
-                QTimer::singleShot(m_sustainSmoothingMs, this, [this]() {
-                    if (m_sustainReleaseTimerActive) {
-                        m_sustainReleaseTimerActive = false;
-                        qDebug() << "ScaleSnap: Sustain hold timer expired, releasing voice-sustained notes";
-                        releaseVoiceSustainedNotes();
-                    }
-                });
+                m_sustainReleaseDueNs = midi::monotonicNowNs() + std::int64_t(m_sustainSmoothingMs) * 1000000;
+                qCDebug(lcScaleSnap) << "ScaleSnap: CC2 dropped below threshold, starting sustain hold timer (" << m_sustainSmoothingMs << "ms)";
             }
         } else {
             // Immediate release (smoothing disabled)
-            qDebug() << "ScaleSnap: CC2 dropped below threshold, releasing voice-sustained notes";
+            qCDebug(lcScaleSnap) << "ScaleSnap: CC2 dropped below threshold, releasing voice-sustained notes";
             releaseVoiceSustainedNotes();
         }
     }
 
     // Cancel pending release if CC2 came back above threshold
     if (m_sustainReleaseTimerActive && value > m_voiceSustainThreshold) {
-        qDebug() << "ScaleSnap: CC2 recovered above threshold, cancelling sustain release timer";
+        qCDebug(lcScaleSnap) << "ScaleSnap: CC2 recovered above threshold, cancelling sustain release timer";
         m_sustainReleaseTimerActive = false;
     }
 
@@ -1561,9 +1698,6 @@ void ScaleSnapProcessor::onVoiceHzUpdated(double hz)
         return;
     }
 
-    // Thread safety: Lock for reading m_activeNotes
-    QReadLocker lock(&m_activeNotesLock);
-
     // Only active when vocal bend is enabled, at least one mode is on, and there are active notes
     const bool multiVoiceActive = isMultiVoiceModeActive();
     const bool legacyHarmonyActive = !multiVoiceActive && (legacyHarmonyOn());
@@ -1684,7 +1818,7 @@ void ScaleSnapProcessor::onVoiceHzUpdated(double hz)
     int bendValue = 8192 + static_cast<int>((totalCents / 200.0) * 8192.0);
     bendValue = qBound(0, bendValue, 16383);
 
-    qDebug() << "ScaleSnap VoiceHz: voiceHz=" << hz << "refHz=" << note.referenceHz
+    qCDebug(lcScaleSnap) << "ScaleSnap VoiceHz: voiceHz=" << hz << "refHz=" << note.referenceHz
              << "rawCents=" << rawVoiceCents << "oscillation=" << (rawVoiceCents - m_voiceCentsAverage)
              << "settling=" << m_settlingCounter << "/" << kSettlingDuration
              << "oscDetected=" << m_oscillationDetected
@@ -1714,42 +1848,99 @@ void ScaleSnapProcessor::onVoiceHzUpdated(double hz)
     }
 }
 
-QSet<int> ScaleSnapProcessor::computeValidPitchClasses() const
+bool ScaleSnapProcessor::resolveHarmonyChord(music::ChordSymbol& out) const
 {
-    QSet<int> validPcs;
-
-    qDebug() << "ScaleSnap::computeValidPitchClasses - harmony=" << (m_harmony != nullptr)
-             << "ontology=" << (m_ontology != nullptr)
-             << "model=" << (m_model != nullptr)
-             << "cellIndex=" << m_currentCellIndex
-             << "hasLastKnownChord=" << m_hasLastKnownChord;
+    auto usable = [](const music::ChordSymbol& c) { return c.rootPc >= 0 && !c.noChord && !c.placeholder; };
+    const bool haveLast = m_hasLastKnownChord && m_lastKnownChord.rootPc >= 0;
 
     if (!m_harmony || !m_ontology) {
-        qDebug() << "ScaleSnap::computeValidPitchClasses - missing harmony/ontology, returning empty";
-        return validPcs;
+        return false;
     }
 
-    // Derive valid pitches from the user-set default chord whenever:
+    // The user-set default chord wins whenever:
     //   (a) we have no chart model (pure performance mode), OR
     //   (b) the user has explicitly set a default via setDefaultHarmonyChord
     //       (footswitch-driven chord stepping). In case (b) we must override
     //       the chart-driven path below — otherwise iReal-Pro auto-load will
     //       silently substitute the chart's first chord for the user's choice.
-    // Same chord-type → scale machinery as buildActiveChord(), so for B♭ maj
-    // you get the full B♭ ionian (B♭ C D E♭ F G A), not just chord tones.
     if (!m_model || m_useDefaultHarmonyChord) {
-        if (m_hasLastKnownChord && m_lastKnownChord.rootPc >= 0) {
-            validPcs.unite(computeChordTones(m_lastKnownChord));
+        if (!haveLast) return false;
+        out = m_lastKnownChord;
+        return true;
+    }
+
+    bool isExplicit = false;
+    if (m_currentCellIndex >= 0) {
+        // Playback is active: the current cell's chord, else the last one we
+        // tracked, else the most recent chord before this cell.
+        music::ChordSymbol chord = m_harmony->parseCellChordNoState(
+            *m_model, m_currentCellIndex, music::ChordSymbol{}, &isExplicit);
+        if (isExplicit && usable(chord)) {
+            out = chord;
+            return true;
+        }
+        if (haveLast) {
+            out = m_lastKnownChord;
+            return true;
+        }
+        for (int i = m_currentCellIndex - 1; i >= 0; --i) {
+            chord = m_harmony->parseCellChordNoState(*m_model, i, music::ChordSymbol{}, &isExplicit);
+            if (isExplicit && usable(chord)) {
+                out = chord;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Playback not active: last known chord, else the first chord in the
+    // chart (limit to first 32 cells).
+    if (haveLast) {
+        out = m_lastKnownChord;
+        return true;
+    }
+    for (int i = 0; i < 32; ++i) {
+        const music::ChordSymbol chord = m_harmony->parseCellChordNoState(*m_model, i, music::ChordSymbol{}, &isExplicit);
+        if (isExplicit && usable(chord)) {
+            qCDebug(lcScaleSnap) << "ScaleSnap: Found first chord at cell" << i << "root=" << chord.rootPc;
+            out = chord;
+            return true;
+        }
+    }
+    return false;
+}
+
+PitchClassSet ScaleSnapProcessor::computeValidPitchClasses(const HarmonicSnapshot& ctx) const
+{
+    PitchClassSet validPcs;
+
+    qCDebug(lcScaleSnap) << "ScaleSnap::computeValidPitchClasses - harmony=" << (m_harmony != nullptr)
+             << "ontology=" << (m_ontology != nullptr)
+             << "model=" << (m_model != nullptr)
+             << "cellIndex=" << m_currentCellIndex
+             << "hasChord=" << ctx.hasChord;
+
+    if (!m_harmony || !m_ontology) {
+        qCDebug(lcScaleSnap) << "ScaleSnap::computeValidPitchClasses - missing harmony/ontology, returning empty";
+        return validPcs;
+    }
+
+    // Default-chord path (see resolveHarmonyChord): same chord-type → scale
+    // machinery as buildActiveChord(), so for B♭ maj you get the full B♭
+    // ionian (B♭ C D E♭ F G A), not just chord tones.
+    if (!m_model || m_useDefaultHarmonyChord) {
+        if (ctx.hasChord) {
+            validPcs.unite(computeChordTones(ctx.chord));
 
             // Pick a single scale that matches the user's chord choice
             // (ionian for maj, aeolian for plain minor, locrian for dim,
             // lydian-augmented for aug, etc.). One scale, no unions —
             // unioning multiple scales blurs the harmonic identity (e.g.
             // ionian ∪ lydian for B♭ maj would add E natural).
-            const QString scaleKey = scaleKeyForChord(m_lastKnownChord);
+            const QStringView scaleKey = scaleKeyForChord(ctx.chord);
             if (const auto* sd = m_ontology->scale(scaleKey)) {
                 for (int iv : sd->intervals) {
-                    validPcs.insert(normalizePc(m_lastKnownChord.rootPc + iv));
+                    validPcs.insert(normalizePc(ctx.chord.rootPc + iv));
                 }
             } else {
                 // Scale lookup failed — fall back to chord-tone-only.
@@ -1759,81 +1950,26 @@ QSet<int> ScaleSnapProcessor::computeValidPitchClasses() const
         return validPcs;
     }
 
-    music::ChordSymbol chord;
-    bool isExplicit = false;
-
-    // If we have a valid cell index (playback is active), use it
-    if (m_currentCellIndex >= 0) {
-        // Try to get chord for current cell
-        chord = m_harmony->parseCellChordNoState(
-            *m_model,
-            m_currentCellIndex,
-            music::ChordSymbol{},
-            &isExplicit
-        );
-
-        // If current cell has explicit chord, update our tracking
-        if (isExplicit && chord.rootPc >= 0 && !chord.noChord && !chord.placeholder) {
-            // Use this chord
-            const_cast<ScaleSnapProcessor*>(this)->m_lastKnownChord = chord;
-            const_cast<ScaleSnapProcessor*>(this)->m_hasLastKnownChord = true;
-        } else if (m_hasLastKnownChord && m_lastKnownChord.rootPc >= 0) {
-            // Use last known chord
-            chord = m_lastKnownChord;
-        } else {
-            // Scan backward to find most recent chord
-            for (int i = m_currentCellIndex - 1; i >= 0; --i) {
-                music::ChordSymbol prevChord = m_harmony->parseCellChordNoState(
-                    *m_model, i, music::ChordSymbol{}, &isExplicit
-                );
-                if (isExplicit && prevChord.rootPc >= 0 && !prevChord.noChord && !prevChord.placeholder) {
-                    chord = prevChord;
-                    const_cast<ScaleSnapProcessor*>(this)->m_lastKnownChord = chord;
-                    const_cast<ScaleSnapProcessor*>(this)->m_hasLastKnownChord = true;
-                    break;
-                }
-            }
-        }
-    } else {
-        // Playback not active - try to use the first chord in the chart as fallback
-        // or use last known chord if we have one
-        if (m_hasLastKnownChord && m_lastKnownChord.rootPc >= 0) {
-            chord = m_lastKnownChord;
-        } else {
-            // Scan from the beginning to find the first chord (limit to first 32 cells)
-            for (int i = 0; i < 32; ++i) {
-                music::ChordSymbol firstChord = m_harmony->parseCellChordNoState(
-                    *m_model, i, music::ChordSymbol{}, &isExplicit
-                );
-                if (isExplicit && firstChord.rootPc >= 0 && !firstChord.noChord && !firstChord.placeholder) {
-                    chord = firstChord;
-                    const_cast<ScaleSnapProcessor*>(this)->m_lastKnownChord = chord;
-                    const_cast<ScaleSnapProcessor*>(this)->m_hasLastKnownChord = true;
-                    qDebug() << "ScaleSnap: Found first chord at cell" << i << "root=" << chord.rootPc;
-                    break;
-                }
-            }
-        }
-    }
+    const music::ChordSymbol& chord = ctx.chord;
 
     // If still no chord, return empty (will pass through)
-    if (chord.rootPc < 0 || chord.noChord || chord.placeholder) {
+    if (!ctx.hasChord || chord.rootPc < 0 || chord.noChord || chord.placeholder) {
         return validPcs;
     }
 
     // Get chord tones (always valid)
-    const QSet<int> chordTones = computeChordTones(chord);
+    const PitchClassSet chordTones = computeChordTones(chord);
     validPcs.unite(chordTones);
 
     // Get key scale tones from dynamic key detection
-    const QSet<int> keyTones = computeKeyScaleTones();
+    const PitchClassSet keyTones = computeKeyScaleTones();
     validPcs.unite(keyTones);
 
     // Smart avoid notes filter: only remove the most problematic clashes
     // The main rule: the natural 4th is an avoid note on chords with a major 3rd
     // (it creates a minor 2nd above the 3rd, which sounds harsh)
 
-    QSet<int> avoidPcs;
+    PitchClassSet avoidPcs;
 
     // Find the 3rd of the chord (if present)
     const int root = chord.rootPc;
@@ -1854,22 +1990,22 @@ QSet<int> ScaleSnapProcessor::computeValidPitchClasses() const
     }
 
     // Filter out avoid notes
-    QSet<int> safePcs;
+    PitchClassSet safePcs;
     for (int pc : validPcs) {
         if (!avoidPcs.contains(pc)) {
             safePcs.insert(pc);
         }
     }
 
-    qDebug() << "ScaleSnap: chordTones=" << chordTones << "keyTones=" << keyTones
+    qCDebug(lcScaleSnap) << "ScaleSnap: chordTones=" << chordTones << "keyTones=" << keyTones
              << "avoidPcs=" << avoidPcs << "safePcs=" << safePcs;
 
     return safePcs;
 }
 
-QSet<int> ScaleSnapProcessor::computeChordTones(const music::ChordSymbol& chord) const
+PitchClassSet ScaleSnapProcessor::computeChordTones(const music::ChordSymbol& chord) const
 {
-    QSet<int> chordTones;
+    PitchClassSet chordTones;
 
     if (!m_harmony || chord.rootPc < 0) {
         return chordTones;
@@ -1894,9 +2030,9 @@ QSet<int> ScaleSnapProcessor::computeChordTones(const music::ChordSymbol& chord)
     return chordTones;
 }
 
-QSet<int> ScaleSnapProcessor::computeKeyScaleTones() const
+PitchClassSet ScaleSnapProcessor::computeKeyScaleTones() const
 {
-    QSet<int> keyTones;
+    PitchClassSet keyTones;
 
     if (!m_harmony || !m_ontology || !m_model || m_currentCellIndex < 0) {
         return keyTones;
@@ -1941,18 +2077,18 @@ QSet<int> ScaleSnapProcessor::computeKeyScaleTones() const
     return keyTones;
 }
 
-ActiveChord ScaleSnapProcessor::buildActiveChord() const
+ActiveChord ScaleSnapProcessor::buildActiveChord(const HarmonicSnapshot& ctx) const
 {
     ActiveChord chord;
 
-    if (!m_hasLastKnownChord || !m_harmony || !m_ontology) {
+    if (!ctx.hasChord || !m_harmony || !m_ontology) {
         return chord;  // Return empty chord
     }
 
-    chord.rootPc = m_lastKnownChord.rootPc;
+    chord.rootPc = ctx.chord.rootPc;
 
     // Get chord definition
-    const auto* chordDef = m_harmony->chordDefForSymbol(m_lastKnownChord);
+    const auto* chordDef = m_harmony->chordDefForSymbol(ctx.chord);
     if (chordDef) {
         chord.ontologyChordKey = chordDef->key;
     }
@@ -2010,7 +2146,7 @@ ActiveChord ScaleSnapProcessor::buildActiveChord() const
             }
         }
 
-        qDebug() << "ScaleSnap buildActiveChord: chordRoot=" << chord.rootPc
+        qCDebug(lcScaleSnap) << "ScaleSnap buildActiveChord: chordRoot=" << chord.rootPc
                  << "chordKey=" << chordDef->key
                  << "numScales=" << scaleDefs.size()
                  << "scales:" << scaleNames;
@@ -2027,21 +2163,18 @@ ActiveChord ScaleSnapProcessor::buildActiveChord() const
         for (int pc : chord.tier2Absolute) t2Str += QString("%1 ").arg(noteNames[pc]);
         for (int pc : chord.tier3Absolute) t3Str += QString("%1 ").arg(noteNames[pc]);
 
-        qDebug() << "ScaleSnap buildActiveChord: T1=" << t1Str
+        qCDebug(lcScaleSnap) << "ScaleSnap buildActiveChord: T1=" << t1Str
                  << "T2=" << t2Str << "T3=" << t3Str;
     }
 
     return chord;
 }
 
-void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
+bool ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
 {
-    // Thread safety: Lock for modifying m_activeNotes
-    QWriteLocker lock(&m_activeNotesLock);
-
     // Get the new chord for the current cell
     if (!m_harmony || !m_ontology || !m_model) {
-        return;
+        return false;
     }
 
     // First, force refresh of chord by checking current cell
@@ -2063,7 +2196,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
             if (m_hasLastKnownChord &&
                 m_lastKnownChord.rootPc == newChord.rootPc &&
                 m_lastKnownChord.quality == newChord.quality) {
-                return;  // Same chord, no re-conformance needed
+                return false;  // Same chord, no re-conformance needed
             }
 
             // Chord changed - update tracking
@@ -2071,24 +2204,26 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
             m_hasLastKnownChord = true;
         } else {
             // No explicit chord in this cell - keep using last known chord
-            return;
+            return false;
         }
     } else {
-        return;  // No valid cell index
+        return false;  // No valid cell index
     }
 
-    // Build the new ActiveChord
-    ActiveChord activeChord = buildActiveChord();
+    // Re-derive the harmonic context for the new chord; the notes below are
+    // re-conformed against the same snapshot the next note-on will read.
+    rebuildHarmonicSnapshot();
+    const std::shared_ptr<const HarmonicSnapshot> snap = harmonicSnapshot();
+    const ActiveChord& activeChord = snap->activeChord;
     if (activeChord.tier1Absolute.empty()) {
-        return;  // No valid chord data
+        return true;  // No valid chord data
     }
 
-    qDebug() << "ScaleSnap: Chord changed at cell" << m_currentCellIndex
+    qCDebug(lcScaleSnap) << "ScaleSnap: Chord changed at cell" << m_currentCellIndex
              << "- checking" << m_activeNotes.size() << "active notes for re-conformance";
 
-    // Precompute chord tones and valid pitch classes for harmony re-conformance
-    const QSet<int> chordTones = computeChordTones(m_lastKnownChord);
-    const QSet<int> validPcs = computeValidPitchClasses();
+    const PitchClassSet& chordTones = snap->chordTones;
+    const PitchClassSet& validPcs = snap->validPcs;
 
     // Check each active note and re-conform if needed
     for (auto it = m_activeNotes.begin(); it != m_activeNotes.end(); ++it) {
@@ -2098,7 +2233,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
         // Check if the current output note is still valid (T1 chord tone)
         const int leadTier = ChordOntology::instance().getTier(currentOutputPc, activeChord);
 
-        qDebug() << "ScaleSnap: Lead note" << note.snappedNote << "(pc" << currentOutputPc << ") tier=" << leadTier;
+        qCDebug(lcScaleSnap) << "ScaleSnap: Lead note" << note.snappedNote << "(pc" << currentOutputPc << ") tier=" << leadTier;
 
         bool leadChanged = false;
         int currentLeadNote = note.snappedNote;
@@ -2110,23 +2245,14 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
         // Only T1 stays, snap T2/T3/T4 (tensions disabled)
         if (m_leadMode == LeadMode::Conformed && leadTier > 1) {
             // Find nearest chord tone
-            int nearestTarget = -1;
-            int minDistance = 7;
-
-            for (int target : activeChord.tier1Absolute) {
-                int dist = ChordOntology::minDistance(currentOutputPc, target);
-                if (dist < minDistance) {
-                    minDistance = dist;
-                    nearestTarget = target;
-                }
-            }
+            const int nearestTarget = ChordOntology::nearestPc(currentOutputPc, activeChord.tier1Absolute);
 
             if (nearestTarget >= 0) {
                 // Compute the new note in the same octave
                 int newNote = ChordOntology::findNearestInOctave(note.snappedNote, nearestTarget);
 
                 if (newNote != note.snappedNote) {
-                    qDebug() << "ScaleSnap: Re-conforming lead" << note.snappedNote
+                    qCDebug(lcScaleSnap) << "ScaleSnap: Re-conforming lead" << note.snappedNote
                              << "->" << newNote << "due to chord change";
 
                     // Emit note change (note-off old, note-on new)
@@ -2161,7 +2287,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
             // Collect already-generated harmony notes to pass to subsequent voices for clash avoidance
             static const int kHarmonyChannels[4] = {kChannelHarmony1, kChannelHarmony2, kChannelHarmony3, kChannelHarmony4};
 
-            QVector<int> generatedHarmonyNotes;
+            VoiceNoteList generatedHarmonyNotes;
             generatedHarmonyNotes.append(currentLeadNote);  // Include lead note
 
             for (int voiceIdx = 0; voiceIdx < 4; ++voiceIdx) {
@@ -2172,7 +2298,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
                 const int harmonyPc = normalizePc(note.harmonyNotes[voiceIdx]);
                 const int harmonyTier = ChordOntology::instance().getTier(harmonyPc, activeChord);
 
-                qDebug() << "ScaleSnap Multi-Voice" << voiceIdx << ": harmony note" << note.harmonyNotes[voiceIdx]
+                qCDebug(lcScaleSnap) << "ScaleSnap Multi-Voice" << voiceIdx << ": harmony note" << note.harmonyNotes[voiceIdx]
                          << "(pc" << harmonyPc << ") tier=" << harmonyTier;
 
                 // Harmony should stay on T1 (chord tones) or T2 (tensions)
@@ -2184,7 +2310,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
                 if (!harmonyNeedsReconform) {
                     int intervalWithLead = getIntervalClass(currentLeadNote, note.harmonyNotes[voiceIdx]);
                     if (!isConsonant(intervalWithLead)) {
-                        qDebug() << "ScaleSnap Multi-Voice" << voiceIdx << ": harmony" << note.harmonyNotes[voiceIdx]
+                        qCDebug(lcScaleSnap) << "ScaleSnap Multi-Voice" << voiceIdx << ": harmony" << note.harmonyNotes[voiceIdx]
                                  << "forms dissonant interval" << intervalWithLead << "with lead - forcing re-conform";
                         harmonyNeedsReconform = true;
                     }
@@ -2192,22 +2318,22 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
 
                 // CRITICAL: Also check if harmony clashes with already-generated voices
                 if (!harmonyNeedsReconform && wouldClashWithOtherVoices(note.harmonyNotes[voiceIdx], generatedHarmonyNotes)) {
-                    qDebug() << "ScaleSnap Multi-Voice" << voiceIdx << ": harmony" << note.harmonyNotes[voiceIdx]
+                    qCDebug(lcScaleSnap) << "ScaleSnap Multi-Voice" << voiceIdx << ": harmony" << note.harmonyNotes[voiceIdx]
                              << "clashes with other voices - forcing re-conform";
                     harmonyNeedsReconform = true;
                 }
 
                 // Also re-conform harmony if lead changed (to maintain proper voice leading)
                 if (leadChanged || harmonyNeedsReconform) {
-                    qDebug() << "ScaleSnap Multi-Voice" << voiceIdx << ": Re-conforming (leadChanged=" << leadChanged
+                    qCDebug(lcScaleSnap) << "ScaleSnap Multi-Voice" << voiceIdx << ": Re-conforming (leadChanged=" << leadChanged
                              << ", harmonyTier=" << harmonyTier << ")";
 
-                    // Turn off old harmony note IMMEDIATELY (no humanization delay for chord-change reconform)
-                    // Using direct emitNoteOff to ensure instant chord conformance
-                    emitNoteOff(kHarmonyChannels[voiceIdx], note.harmonyNotes[voiceIdx]);
+                    // Turn off old harmony note IMMEDIATELY (no humanization delay for chord-change reconform).
+                    // voiceIndex -1 = zero delay, but still behind its own attack if that is still pending.
+                    emitHarmonyNoteOff(kHarmonyChannels[voiceIdx], note.harmonyNotes[voiceIdx], -1);
 
                     // Generate new harmony using the voice's motion type, with inter-voice clash avoidance
-                    int newHarmony = generateHarmonyForVoice(voiceIdx, currentLeadNote, chordTones, validPcs, generatedHarmonyNotes);
+                    int newHarmony = generateHarmonyForVoice(voiceIdx, currentLeadNote, *snap, generatedHarmonyNotes);
 
                     // FINAL VALIDATION: Ensure re-conformed harmony is T1/T2/T3 (not chromatic T4)
                     newHarmony = validateHarmonyNote(newHarmony, currentLeadNote, activeChord);
@@ -2216,7 +2342,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
                     // Chord changes require instant conformance - humanization only applies to new note attacks
                     int harmonyVelocity = static_cast<int>(note.velocity * m_harmonyConfig.velocityRatio);
                     harmonyVelocity = qBound(1, harmonyVelocity, 127);
-                    emitNoteOn(kHarmonyChannels[voiceIdx], newHarmony, harmonyVelocity);
+                    emitHarmonyNoteOn(kHarmonyChannels[voiceIdx], newHarmony, harmonyVelocity, -1);
 
                     // Update tracking
                     note.harmonyNotes[voiceIdx] = newHarmony;
@@ -2228,7 +2354,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
                         generatedHarmonyNotes.append(newHarmony);
                     }
 
-                    qDebug() << "ScaleSnap Multi-Voice" << voiceIdx << ": Harmony re-conformed to" << newHarmony;
+                    qCDebug(lcScaleSnap) << "ScaleSnap Multi-Voice" << voiceIdx << ": Harmony re-conformed to" << newHarmony;
                 } else {
                     // Voice not re-conformed but still add to list for subsequent voice clash detection
                     generatedHarmonyNotes.append(note.harmonyNotes[voiceIdx]);
@@ -2243,7 +2369,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
             const int harmonyPc = normalizePc(note.harmonyNote);
             const int harmonyTier = ChordOntology::instance().getTier(harmonyPc, activeChord);
 
-            qDebug() << "ScaleSnap: Harmony note" << note.harmonyNote << "(pc" << harmonyPc << ") tier=" << harmonyTier;
+            qCDebug(lcScaleSnap) << "ScaleSnap: Harmony note" << note.harmonyNote << "(pc" << harmonyPc << ") tier=" << harmonyTier;
 
             // Harmony should stay on T1 (chord tones) or T2 (tensions like 9th, 11th, 13th)
             // Re-conform if harmony is T3 (scale tone) or T4 (chromatic)
@@ -2253,7 +2379,7 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
             if (!harmonyNeedsReconform) {
                 int intervalWithLead = getIntervalClass(currentLeadNote, note.harmonyNote);
                 if (!isConsonant(intervalWithLead)) {
-                    qDebug() << "ScaleSnap: harmony" << note.harmonyNote << "forms dissonant interval"
+                    qCDebug(lcScaleSnap) << "ScaleSnap: harmony" << note.harmonyNote << "forms dissonant interval"
                              << intervalWithLead << "with lead - forcing re-conform";
                     harmonyNeedsReconform = true;
                 }
@@ -2261,11 +2387,11 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
 
             // Also re-conform harmony if lead changed (to maintain proper voice leading)
             if (leadChanged || harmonyNeedsReconform) {
-                qDebug() << "ScaleSnap: Re-conforming harmony (leadChanged=" << leadChanged
+                qCDebug(lcScaleSnap) << "ScaleSnap: Re-conforming harmony (leadChanged=" << leadChanged
                          << ", harmonyTier=" << harmonyTier << ")";
 
                 // Turn off old harmony note IMMEDIATELY (no humanization delay for chord-change reconform)
-                emitNoteOff(kChannelHarmony1, note.harmonyNote);
+                emitHarmonyNoteOff(kChannelHarmony1, note.harmonyNote, -1);
 
                 // Generate new harmony using the CORRECT motion-type generator
                 // This preserves voice leading context (parallel/contrary/similar motion)
@@ -2330,13 +2456,13 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
                 // Chord changes require instant conformance - humanization only applies to new note attacks
                 int harmonyVelocity = static_cast<int>(note.velocity * m_harmonyConfig.velocityRatio);
                 harmonyVelocity = qBound(1, harmonyVelocity, 127);
-                emitNoteOn(kChannelHarmony1, newHarmony, harmonyVelocity);
+                emitHarmonyNoteOn(kChannelHarmony1, newHarmony, harmonyVelocity, -1);
 
                 // Update tracking
                 note.harmonyNote = newHarmony;
                 m_lastHarmonyOutputNote = newHarmony;
 
-                qDebug() << "ScaleSnap: Harmony re-conformed to" << newHarmony;
+                qCDebug(lcScaleSnap) << "ScaleSnap: Harmony re-conformed to" << newHarmony;
             }
         }
 
@@ -2345,9 +2471,11 @@ void ScaleSnapProcessor::checkAndReconformOnChordChange(int previousCellIndex)
             m_lastHarmonyLeadNote = currentLeadNote;
         }
     }
+
+    return true;
 }
 
-int ScaleSnapProcessor::snapToNearestValidPc(int inputPc, const QSet<int>& validPcs) const
+int ScaleSnapProcessor::snapToNearestValidPc(int inputPc, const PitchClassSet& validPcs) const
 {
     if (validPcs.contains(inputPc)) {
         return inputPc;
@@ -2379,7 +2507,7 @@ int ScaleSnapProcessor::snapToNearestValidPc(int inputPc, const QSet<int>& valid
     return bestPc;
 }
 
-int ScaleSnapProcessor::generateHarmonyNote(int inputNote, const QSet<int>& chordTones, const QSet<int>& scaleTones) const
+int ScaleSnapProcessor::generateHarmonyNote(int inputNote, const PitchClassSet& chordTones, const PitchClassSet& scaleTones) const
 {
     // Strategy: Find a chord tone close to the input note (within 3rd-5th range)
     // Keep harmony tight - prefer minor/major 3rds, avoid large jumps
@@ -2396,7 +2524,7 @@ int ScaleSnapProcessor::generateHarmonyNote(int inputNote, const QSet<int>& chor
         int harmonyPc = normalizePc(inputPc + interval);
         if (chordTones.contains(harmonyPc)) {
             int harmonyNote = inputNote + interval;
-            qDebug() << "ScaleSnap Harmony: found chord tone at interval" << interval
+            qCDebug(lcScaleSnap) << "ScaleSnap Harmony: found chord tone at interval" << interval
                      << "harmonyNote=" << harmonyNote;
             return qBound(0, harmonyNote, 127);
         }
@@ -2407,7 +2535,7 @@ int ScaleSnapProcessor::generateHarmonyNote(int inputNote, const QSet<int>& chor
         int harmonyPc = normalizePc(inputPc + interval);
         if (scaleTones.contains(harmonyPc)) {
             int harmonyNote = inputNote + interval;
-            qDebug() << "ScaleSnap Harmony: found scale tone at interval" << interval
+            qCDebug(lcScaleSnap) << "ScaleSnap Harmony: found scale tone at interval" << interval
                      << "harmonyNote=" << harmonyNote;
             return qBound(0, harmonyNote, 127);
         }
@@ -2436,17 +2564,17 @@ int ScaleSnapProcessor::generateHarmonyNote(int inputNote, const QSet<int>& chor
         }
 
         int harmonyNote = inputNote + bestInterval;
-        qDebug() << "ScaleSnap Harmony: fallback nearest chord tone, interval=" << bestInterval
+        qCDebug(lcScaleSnap) << "ScaleSnap Harmony: fallback nearest chord tone, interval=" << bestInterval
                  << "harmonyNote=" << harmonyNote;
         return qBound(0, harmonyNote, 127);
     }
 
     // Last resort: major 3rd above
-    qDebug() << "ScaleSnap Harmony: last resort major 3rd above";
+    qCDebug(lcScaleSnap) << "ScaleSnap Harmony: last resort major 3rd above";
     return qBound(0, inputNote + 4, 127);
 }
 
-int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove) const
+int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove) const
 {
     // =========================================================================
     // TRUE PARALLEL MOTION (Species Counterpoint Rules)
@@ -2462,7 +2590,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
     //   Lead:    C  D  E  F  G
     //   Harmony: A  B  C  D  E  (each a 3rd below)
 
-    qDebug() << "ScaleSnap PARALLEL: inputNote=" << inputNote
+    qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: inputNote=" << inputNote
              << "prevLead=" << previousLeadNote
              << "prevHarmony=" << previousHarmonyNote
              << "harmonyAbove=" << harmonyAbove;
@@ -2470,7 +2598,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
     // === PHRASE START: Pick initial interval ===
     if (previousLeadNote < 0 || previousHarmonyNote < 0) {
         // First note of phrase - start at a diatonic 3rd
-        qDebug() << "ScaleSnap PARALLEL: NEW PHRASE - starting at 3rd";
+        qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: NEW PHRASE - starting at 3rd";
 
         // Try to find a 3rd (minor or major) that's in the valid pitch classes
         int targetInterval = harmonyAbove ? 3 : -3;  // 3rd above or below
@@ -2488,14 +2616,14 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
 
             int candidatePc = normalizePc(candidate);
             if (chordTones.contains(candidatePc) || validPcs.contains(candidatePc)) {
-                qDebug() << "ScaleSnap PARALLEL: starting interval=" << interval << "harmonyNote=" << candidate;
+                qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: starting interval=" << interval << "harmonyNote=" << candidate;
                 return qBound(m_harmonyRangeMin, candidate, m_harmonyRangeMax);
             }
         }
 
         // Fallback: just use a minor 3rd
         int fallback = inputNote + (harmonyAbove ? 3 : -3);
-        qDebug() << "ScaleSnap PARALLEL: fallback starting interval, harmonyNote=" << fallback;
+        qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: fallback starting interval, harmonyNote=" << fallback;
         return qBound(m_harmonyRangeMin, fallback, m_harmonyRangeMax);
     }
 
@@ -2503,7 +2631,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
     int leadMovement = inputNote - previousLeadNote;
     int rawHarmonyNote = previousHarmonyNote + leadMovement;
 
-    qDebug() << "ScaleSnap PARALLEL: leadMovement=" << leadMovement
+    qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: leadMovement=" << leadMovement
              << "rawHarmonyNote=" << rawHarmonyNote;
 
     // Check the resulting interval
@@ -2517,7 +2645,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
         int rawPc = normalizePc(rawHarmonyNote);
         if (chordTones.contains(rawPc) || validPcs.contains(rawPc)) {
             // Already valid
-            qDebug() << "ScaleSnap PARALLEL: valid imperfect consonance, harmonyNote=" << rawHarmonyNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: valid imperfect consonance, harmonyNote=" << rawHarmonyNote;
             return qBound(m_harmonyRangeMin, rawHarmonyNote, m_harmonyRangeMax);
         }
 
@@ -2543,7 +2671,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
             }
         }
 
-        qDebug() << "ScaleSnap PARALLEL: snapped to valid pc, harmonyNote=" << bestCandidate;
+        qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: snapped to valid pc, harmonyNote=" << bestCandidate;
         return qBound(m_harmonyRangeMin, bestCandidate, m_harmonyRangeMax);
     }
 
@@ -2551,7 +2679,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
     // This can happen when the lead moves chromatically or by unusual intervals
     // Find the nearest imperfect consonance (3rd or 6th) from the lead note
 
-    qDebug() << "ScaleSnap PARALLEL: interval=" << intervalWithLead
+    qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: interval=" << intervalWithLead
              << "is NOT imperfect consonance, correcting...";
 
     // Target intervals: 3rds and 6ths (semitones: 3, 4, 8, 9)
@@ -2607,7 +2735,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
                   [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
 
         int bestNote = candidates.first().note;
-        qDebug() << "ScaleSnap PARALLEL: corrected to imperfect consonance, harmonyNote=" << bestNote
+        qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: corrected to imperfect consonance, harmonyNote=" << bestNote
                  << "score=" << candidates.first().score;
         return qBound(m_harmonyRangeMin, bestNote, m_harmonyRangeMax);
     }
@@ -2615,7 +2743,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
     // =========================================================================
     // SMART FALLBACK: Find best consonant chord tone maintaining melodic continuity
     // =========================================================================
-    qDebug() << "ScaleSnap PARALLEL: correction search failed, using smart fallback";
+    qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: correction search failed, using smart fallback";
 
     // Determine the direction harmony should be moving (parallel to lead)
     int harmonyDirection = leadMovement > 0 ? 1 : (leadMovement < 0 ? -1 : 0);
@@ -2684,7 +2812,7 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
                   [](const FallbackCandidate& a, const FallbackCandidate& b) { return a.score > b.score; });
 
         int bestFallback = fallbackCandidates.first().note;
-        qDebug() << "ScaleSnap PARALLEL: Smart fallback selected" << bestFallback
+        qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: Smart fallback selected" << bestFallback
                  << "with score" << fallbackCandidates.first().score;
         return bestFallback;
     }
@@ -2695,23 +2823,23 @@ int ScaleSnapProcessor::generateParallelHarmonyNote(int inputNote, int previousL
 
     // If the raw result is dissonant, try shifting by minor 2nd to find consonance
     if (!isConsonant(fallbackInterval)) {
-        qDebug() << "ScaleSnap PARALLEL: Raw result" << fallbackNote << "is dissonant, adjusting";
+        qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: Raw result" << fallbackNote << "is dissonant, adjusting";
         // Try shifting up or down by 1-2 semitones to find consonance
         for (int offset : {1, -1, 2, -2}) {
             int adjusted = fallbackNote + offset;
             if (adjusted < m_harmonyRangeMin || adjusted > m_harmonyRangeMax) continue;
             if (isConsonant(getIntervalClass(inputNote, adjusted))) {
-                qDebug() << "ScaleSnap PARALLEL: Adjusted to consonant" << adjusted;
+                qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: Adjusted to consonant" << adjusted;
                 return adjusted;
             }
         }
     }
 
-    qDebug() << "ScaleSnap PARALLEL: Last resort fallback" << fallbackNote;
+    qCDebug(lcScaleSnap) << "ScaleSnap PARALLEL: Last resort fallback" << fallbackNote;
     return fallbackNote;
 }
 
-int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove) const
+int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove) const
 {
     // =========================================================================
     // CONSONANCE-AWARE CONTRARY MOTION (Species Counterpoint Rules)
@@ -2741,7 +2869,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
         // Also try octave transpositions to find one within range
         static const int preferredIntervals[] = {3, 4, 8, 9, 7, 12};  // m3, M3, m6, M6, P5, P8
 
-        const QSet<int>& validTones = validPcs.isEmpty() ? chordTones : validPcs;
+        const PitchClassSet& validTones = validPcs.isEmpty() ? chordTones : validPcs;
 
         for (int interval : preferredIntervals) {
             // Try the interval in the preferred direction
@@ -2759,7 +2887,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
 
                     int candidatePc = normalizePc(c);
                     if (validTones.isEmpty() || validTones.contains(candidatePc)) {
-                        qDebug() << "ScaleSnap CONTRARY: PHRASE START - harmony at interval"
+                        qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: PHRASE START - harmony at interval"
                                  << interval << "=" << c << (harmonyAbove ? "(above)" : "(below)")
                                  << "(range:" << m_harmonyRangeMin << "-" << m_harmonyRangeMax << ")";
                         return c;
@@ -2775,7 +2903,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
         while (fallback > m_harmonyRangeMax && fallback - 12 >= 0) fallback -= 12;
         fallback = qBound(m_harmonyRangeMin, fallback, m_harmonyRangeMax);
 
-        qDebug() << "ScaleSnap CONTRARY: PHRASE START fallback - harmony at" << fallback;
+        qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: PHRASE START fallback - harmony at" << fallback;
         return fallback;
     }
 
@@ -2785,7 +2913,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
     // No lead movement = use oblique motion (harmony stays, if in range)
     if (leadMovement == 0) {
         if (isInRange(previousHarmonyNote)) {
-            qDebug() << "ScaleSnap CONTRARY: no lead movement, keeping harmony at" << previousHarmonyNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: no lead movement, keeping harmony at" << previousHarmonyNote;
             return previousHarmonyNote;
         }
         // Previous note is now out of range, need to find new one
@@ -2794,7 +2922,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
     // Determine harmony direction (OPPOSITE to lead)
     int harmonyDir = (leadMovement > 0) ? -1 : 1;
 
-    qDebug() << "ScaleSnap CONTRARY: lead moved" << leadMovement
+    qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: lead moved" << leadMovement
              << ", harmony should move" << (harmonyDir > 0 ? "UP" : "DOWN")
              << "(range:" << m_harmonyRangeMin << "-" << m_harmonyRangeMax << ")";
 
@@ -2802,7 +2930,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
     // CANDIDATE SEARCH: Find harmony notes that satisfy counterpoint rules
     // =========================================================================
 
-    const QSet<int>& validTones = validPcs.isEmpty() ? chordTones : validPcs;
+    const PitchClassSet& validTones = validPcs.isEmpty() ? chordTones : validPcs;
 
     struct Candidate {
         int note;
@@ -2838,7 +2966,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
         // CRITICAL: Check for parallel 5ths and octaves (FORBIDDEN)
         // =====================================================================
         if (wouldCreateParallelPerfect(previousLeadNote, previousHarmonyNote, inputNote, candidateNote)) {
-            qDebug() << "ScaleSnap CONTRARY: REJECTING candidate" << candidateNote
+            qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: REJECTING candidate" << candidateNote
                      << "- would create parallel 5ths/octaves";
             continue;  // Skip this candidate entirely
         }
@@ -2945,7 +3073,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
         int bestNote = candidates.first().note;
         int bestScore = candidates.first().score;
 
-        qDebug() << "ScaleSnap CONTRARY: Selected harmony" << bestNote
+        qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: Selected harmony" << bestNote
                  << "with score" << bestScore
                  << "(interval with lead:" << getIntervalClass(inputNote, bestNote) << ")";
 
@@ -2960,7 +3088,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
     // 2. Melodic continuity - prefer continuing in the direction harmony was moving
     // 3. Avoid random jumping back and forth
 
-    qDebug() << "ScaleSnap CONTRARY: Primary searches failed, using smart fallback";
+    qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: Primary searches failed, using smart fallback";
 
     // Determine the direction harmony was moving (for melodic continuity)
     int harmonyDirection = 0;
@@ -3043,7 +3171,7 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
                   [](const FallbackCandidate& a, const FallbackCandidate& b) { return a.score > b.score; });
 
         int bestFallback = fallbackCandidates.first().note;
-        qDebug() << "ScaleSnap CONTRARY: Smart fallback selected" << bestFallback
+        qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: Smart fallback selected" << bestFallback
                  << "with score" << fallbackCandidates.first().score
                  << "(harmonyDirection was" << harmonyDirection << ")";
         return bestFallback;
@@ -3055,22 +3183,22 @@ int ScaleSnapProcessor::generateContraryHarmonyNote(int inputNote, int previousL
 
     // If the fallback is dissonant, try shifting to find consonance
     if (!isConsonant(intervalWithLead)) {
-        qDebug() << "ScaleSnap CONTRARY: Fallback" << fallback << "is dissonant, adjusting";
+        qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: Fallback" << fallback << "is dissonant, adjusting";
         for (int offset : {1, -1, 2, -2}) {
             int adjusted = fallback + offset;
             if (adjusted < m_harmonyRangeMin || adjusted > m_harmonyRangeMax) continue;
             if (isConsonant(getIntervalClass(inputNote, adjusted))) {
-                qDebug() << "ScaleSnap CONTRARY: Adjusted to consonant" << adjusted;
+                qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: Adjusted to consonant" << adjusted;
                 return adjusted;
             }
         }
     }
 
-    qDebug() << "ScaleSnap CONTRARY: No chord tones in range, using fallback" << fallback;
+    qCDebug(lcScaleSnap) << "ScaleSnap CONTRARY: No chord tones in range, using fallback" << fallback;
     return fallback;
 }
 
-int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove) const
+int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove) const
 {
     // =========================================================================
     // SIMILAR MOTION (Species Counterpoint Rules)
@@ -3097,7 +3225,7 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
         int direction = harmonyAbove ? 1 : -1;
         static const int preferredIntervals[] = {3, 4, 8, 9};  // m3, M3, m6, M6 (imperfect only for similar)
 
-        const QSet<int>& validTones = validPcs.isEmpty() ? chordTones : validPcs;
+        const PitchClassSet& validTones = validPcs.isEmpty() ? chordTones : validPcs;
 
         for (int interval : preferredIntervals) {
             int candidate = inputNote + (direction * interval);
@@ -3112,7 +3240,7 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
 
                     int candidatePc = normalizePc(c);
                     if (validTones.isEmpty() || validTones.contains(candidatePc)) {
-                        qDebug() << "ScaleSnap SIMILAR: PHRASE START - harmony at interval"
+                        qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: PHRASE START - harmony at interval"
                                  << interval << "=" << c << (harmonyAbove ? "(above)" : "(below)");
                         return c;
                     }
@@ -3134,7 +3262,7 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
     // No lead movement = use oblique motion (harmony stays)
     if (leadMovement == 0) {
         if (isInRange(previousHarmonyNote)) {
-            qDebug() << "ScaleSnap SIMILAR: no lead movement, keeping harmony at" << previousHarmonyNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: no lead movement, keeping harmony at" << previousHarmonyNote;
             return previousHarmonyNote;
         }
     }
@@ -3142,7 +3270,7 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
     // SIMILAR motion: harmony moves in the SAME direction as lead
     int harmonyDir = (leadMovement > 0) ? 1 : -1;
 
-    qDebug() << "ScaleSnap SIMILAR: lead moved" << leadMovement
+    qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: lead moved" << leadMovement
              << ", harmony should also move" << (harmonyDir > 0 ? "UP" : "DOWN")
              << "(range:" << m_harmonyRangeMin << "-" << m_harmonyRangeMax << ")";
 
@@ -3150,7 +3278,7 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
     // CANDIDATE SEARCH
     // =========================================================================
 
-    const QSet<int>& validTones = validPcs.isEmpty() ? chordTones : validPcs;
+    const PitchClassSet& validTones = validPcs.isEmpty() ? chordTones : validPcs;
 
     struct Candidate {
         int note;
@@ -3178,14 +3306,14 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
         // CRITICAL: Similar motion to PERFECT consonances is FORBIDDEN
         // =====================================================================
         if (isPerfectConsonance(intervalWithLead)) {
-            qDebug() << "ScaleSnap SIMILAR: REJECTING candidate" << candidateNote
+            qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: REJECTING candidate" << candidateNote
                      << "- similar motion to perfect consonance (direct 5th/octave)";
             continue;
         }
 
         // Check for parallel 5ths/octaves (still forbidden)
         if (wouldCreateParallelPerfect(previousLeadNote, previousHarmonyNote, inputNote, candidateNote)) {
-            qDebug() << "ScaleSnap SIMILAR: REJECTING candidate" << candidateNote
+            qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: REJECTING candidate" << candidateNote
                      << "- would create parallel 5ths/octaves";
             continue;
         }
@@ -3234,7 +3362,7 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
         int bestNote = candidates.first().note;
         int bestScore = candidates.first().score;
 
-        qDebug() << "ScaleSnap SIMILAR: Selected harmony" << bestNote
+        qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: Selected harmony" << bestNote
                  << "with score" << bestScore
                  << "(interval with lead:" << getIntervalClass(inputNote, bestNote) << ")";
 
@@ -3247,11 +3375,11 @@ int ScaleSnapProcessor::generateSimilarHarmonyNote(int inputNote, int previousLe
     // Similar motion is more restricted (can't approach perfect consonances),
     // so fall back to contrary motion which has more options.
 
-    qDebug() << "ScaleSnap SIMILAR: No valid similar motion candidates, falling back to contrary";
+    qCDebug(lcScaleSnap) << "ScaleSnap SIMILAR: No valid similar motion candidates, falling back to contrary";
     return generateContraryHarmonyNote(inputNote, previousLeadNote, previousHarmonyNote, chordTones, validPcs, harmonyAbove);
 }
 
-int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove) const
+int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove) const
 {
     // =========================================================================
     // OBLIQUE MOTION (Species Counterpoint / Pedal Point)
@@ -3327,13 +3455,13 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
         int pedalNote = -1;
         if (rootNote >= 0) {
             pedalNote = rootNote;
-            qDebug() << "ScaleSnap OBLIQUE: PHRASE START - pedal on ROOT" << pedalNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: PHRASE START - pedal on ROOT" << pedalNote;
         } else if (fifthNote >= 0) {
             pedalNote = fifthNote;
-            qDebug() << "ScaleSnap OBLIQUE: PHRASE START - pedal on 5TH" << pedalNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: PHRASE START - pedal on 5TH" << pedalNote;
         } else if (thirdNote >= 0) {
             pedalNote = thirdNote;
-            qDebug() << "ScaleSnap OBLIQUE: PHRASE START - pedal on 3RD" << pedalNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: PHRASE START - pedal on 3RD" << pedalNote;
         } else {
             // Fallback: use any interval that works
             int baseInterval = harmonyAbove ? 4 : -3;  // M3 above or m3 below
@@ -3341,7 +3469,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
             while (pedalNote < m_harmonyRangeMin && pedalNote + 12 <= 127) pedalNote += 12;
             while (pedalNote > m_harmonyRangeMax && pedalNote - 12 >= 0) pedalNote -= 12;
             pedalNote = qBound(m_harmonyRangeMin, pedalNote, m_harmonyRangeMax);
-            qDebug() << "ScaleSnap OBLIQUE: PHRASE START - fallback pedal" << pedalNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: PHRASE START - fallback pedal" << pedalNote;
         }
 
         return pedalNote;
@@ -3363,7 +3491,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
     int leadMovement = std::abs(inputNote - previousLeadNote);
     bool isPhraseBreak = (leadMovement > 7);  // More than a 5th suggests phrase break
 
-    qDebug() << "ScaleSnap OBLIQUE: pedal=" << previousHarmonyNote << "(pc" << pedalPc << ")"
+    qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: pedal=" << previousHarmonyNote << "(pc" << pedalPc << ")"
              << "isChordTone=" << isChordTone << "isScaleTone=" << isScaleTone
              << "intervalWithLead=" << intervalWithLead << "isHarsh=" << isHarshInterval
              << "leadMovement=" << leadMovement << "isPhraseBreak=" << isPhraseBreak;
@@ -3376,7 +3504,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
         shouldHold = !isHarshInterval && !isPhraseBreak;
 
         if (shouldHold) {
-            qDebug() << "ScaleSnap OBLIQUE: HOLDING chord tone pedal" << previousHarmonyNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: HOLDING chord tone pedal" << previousHarmonyNote;
         }
     } else if (isScaleTone) {
         // Scale tones can hold if consonant with lead
@@ -3384,7 +3512,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
         shouldHold = isConsonant(intervalWithLead) && !isPhraseBreak;
 
         if (shouldHold) {
-            qDebug() << "ScaleSnap OBLIQUE: HOLDING scale tone pedal" << previousHarmonyNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: HOLDING scale tone pedal" << previousHarmonyNote;
         }
     }
     // Chromatic (T4) notes should always move - they become "wrong notes"
@@ -3392,7 +3520,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
     // Check range - can't hold if pedal is now out of range
     if (!isInRange(previousHarmonyNote)) {
         shouldHold = false;
-        qDebug() << "ScaleSnap OBLIQUE: pedal out of range, must move";
+        qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: pedal out of range, must move";
     }
 
     // =========================================================================
@@ -3410,7 +3538,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
     // 2. 5th of current chord (dominant pedal)
     // 3. Smooth voice leading from previous pedal (stepwise if possible)
 
-    qDebug() << "ScaleSnap OBLIQUE: selecting new pedal note";
+    qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: selecting new pedal note";
 
     struct PedalCandidate {
         int note;
@@ -3474,7 +3602,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
                   [](const PedalCandidate& a, const PedalCandidate& b) { return a.score > b.score; });
 
         int bestPedal = candidates.first().note;
-        qDebug() << "ScaleSnap OBLIQUE: new pedal" << bestPedal
+        qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: new pedal" << bestPedal
                  << "with score" << candidates.first().score;
         return bestPedal;
     }
@@ -3482,7 +3610,7 @@ int ScaleSnapProcessor::generateObliqueHarmonyNote(int inputNote, int previousLe
     // =========================================================================
     // FALLBACK: Use parallel motion if no good pedal found
     // =========================================================================
-    qDebug() << "ScaleSnap OBLIQUE: no valid pedal found, falling back to parallel";
+    qCDebug(lcScaleSnap) << "ScaleSnap OBLIQUE: no valid pedal found, falling back to parallel";
     return generateParallelHarmonyNote(inputNote, previousLeadNote, previousHarmonyNote, chordTones, validPcs, harmonyAbove);
 }
 
@@ -3501,14 +3629,14 @@ int ScaleSnapProcessor::validateHarmonyNote(int harmonyNote, int leadNote, const
     // - T4 (chromatic): INVALID - outside scale, sounds wrong
 
     if (harmonyNote < 0 || harmonyNote > 127) {
-        qDebug() << "ScaleSnap VALIDATE: harmony note" << harmonyNote << "out of MIDI range";
+        qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: harmony note" << harmonyNote << "out of MIDI range";
         return qBound(0, harmonyNote, 127);
     }
 
     // Check if chord data is available
     if (chord.tier1Absolute.empty()) {
         // No chord data - can't validate, return as-is
-        qDebug() << "ScaleSnap VALIDATE: no chord data, passing through harmony" << harmonyNote;
+        qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: no chord data, passing through harmony" << harmonyNote;
         return harmonyNote;
     }
 
@@ -3522,19 +3650,19 @@ int ScaleSnapProcessor::validateHarmonyNote(int harmonyNote, int leadNote, const
 
     // T1, T2, T3 are acceptable IF they form consonant intervals with lead
     if (tier <= 3 && isConsonantWithLead) {
-        qDebug() << "ScaleSnap VALIDATE: harmony" << harmonyNote << "(pc" << harmonyPc << ") tier=" << tier
+        qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: harmony" << harmonyNote << "(pc" << harmonyPc << ") tier=" << tier
                  << "interval=" << intervalWithLead << "- OK";
         return harmonyNote;
     }
 
     // Need to find a better note - either T4 (wrong pitch class) or dissonant interval
     if (!isConsonantWithLead) {
-        qDebug() << "ScaleSnap VALIDATE: harmony" << harmonyNote << "forms dissonant interval" << intervalWithLead
+        qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: harmony" << harmonyNote << "forms dissonant interval" << intervalWithLead
                  << "with lead" << leadNote << "- correcting";
     }
 
     // Find a CONSONANT chord tone (T1) to replace the problematic harmony
-    qDebug() << "ScaleSnap VALIDATE: Finding consonant chord tone replacement";
+    qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: Finding consonant chord tone replacement";
 
     // Score candidates by: consonance with lead, distance from original, and tier
     struct Candidate {
@@ -3548,14 +3676,7 @@ int ScaleSnapProcessor::validateHarmonyNote(int harmonyNote, int leadNote, const
         int candidatePc = normalizePc(candidate);
 
         // Must be a chord tone (T1)
-        bool isT1 = false;
-        for (int t1Pc : chord.tier1Absolute) {
-            if (candidatePc == t1Pc) {
-                isT1 = true;
-                break;
-            }
-        }
-        if (!isT1) continue;
+        if (!chord.tier1Absolute.contains(candidatePc)) continue;
 
         // Must form consonant interval with lead
         int intervalWithLead = getIntervalClass(leadNote, candidate);
@@ -3583,7 +3704,7 @@ int ScaleSnapProcessor::validateHarmonyNote(int harmonyNote, int leadNote, const
                   [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
 
         int correctedNote = candidates.first().note;
-        qDebug() << "ScaleSnap VALIDATE: corrected harmony" << harmonyNote << "->" << correctedNote
+        qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: corrected harmony" << harmonyNote << "->" << correctedNote
                  << "(score=" << candidates.first().score << ")";
         return correctedNote;
     }
@@ -3601,22 +3722,23 @@ int ScaleSnapProcessor::validateHarmonyNote(int harmonyNote, int leadNote, const
     }
 
     if (bestTarget < 0) {
-        qDebug() << "ScaleSnap VALIDATE: no T1 found, using chord root" << chord.rootPc;
+        qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: no T1 found, using chord root" << chord.rootPc;
         bestTarget = chord.rootPc;
     }
 
     int correctedNote = ChordOntology::findNearestInOctave(harmonyNote, bestTarget);
     correctedNote = qBound(m_harmonyRangeMin, correctedNote, m_harmonyRangeMax);
 
-    qDebug() << "ScaleSnap VALIDATE: fallback corrected harmony" << harmonyNote << "->" << correctedNote;
+    qCDebug(lcScaleSnap) << "ScaleSnap VALIDATE: fallback corrected harmony" << harmonyNote << "->" << correctedNote;
     return correctedNote;
 }
 
 int ScaleSnapProcessor::generateHarmonyForVoice(int voiceIndex, int inputNote,
-                                                  const QSet<int>& chordTones,
-                                                  const QSet<int>& validPcs,
-                                                  const QVector<int>& otherVoiceNotes) const
+                                                  const HarmonicSnapshot& ctx,
+                                                  const VoiceNoteList& otherVoiceNotes) const
 {
+    const PitchClassSet& chordTones = ctx.chordTones;
+    const PitchClassSet& validPcs = ctx.validPcs;
     if (voiceIndex < 0 || voiceIndex >= 4) {
         return -1;
     }
@@ -3654,7 +3776,7 @@ int ScaleSnapProcessor::generateHarmonyForVoice(int voiceIndex, int inputNote,
             harmonyNote = generateParallelFixedHarmonyNote(inputNote, config.parallelInterval, validPcs);
             break;
         case VoiceMotionType::DRONE:
-            harmonyNote = generateDroneHarmonyNote(config.droneOctave);
+            harmonyNote = generateDroneHarmonyNote(config.droneOctave, ctx);
             break;
         case VoiceMotionType::SCALE_PARALLEL:
             harmonyNote = generateScaleParallelHarmonyNote(inputNote, config.scaleStepOffset, validPcs);
@@ -3685,7 +3807,7 @@ int ScaleSnapProcessor::generateHarmonyForVoice(int voiceIndex, int inputNote,
 
     // Check for clashes with other voices and adjust if needed
     if (harmonyNote >= 0 && !otherVoiceNotes.isEmpty() && wouldClashWithOtherVoices(harmonyNote, otherVoiceNotes)) {
-        qDebug() << "ScaleSnap Voice" << voiceIndex << ": harmony" << harmonyNote
+        qCDebug(lcScaleSnap) << "ScaleSnap Voice" << voiceIndex << ": harmony" << harmonyNote
                  << "clashes with other voices, attempting adjustment";
 
         // Try shifting by octave first (preserves pitch class)
@@ -3693,10 +3815,10 @@ int ScaleSnapProcessor::generateHarmonyForVoice(int voiceIndex, int inputNote,
         int octaveDown = harmonyNote - 12;
 
         if (octaveUp <= config.rangeMax && !wouldClashWithOtherVoices(octaveUp, otherVoiceNotes)) {
-            qDebug() << "ScaleSnap Voice" << voiceIndex << ": adjusted up octave to" << octaveUp;
+            qCDebug(lcScaleSnap) << "ScaleSnap Voice" << voiceIndex << ": adjusted up octave to" << octaveUp;
             harmonyNote = octaveUp;
         } else if (octaveDown >= config.rangeMin && !wouldClashWithOtherVoices(octaveDown, otherVoiceNotes)) {
-            qDebug() << "ScaleSnap Voice" << voiceIndex << ": adjusted down octave to" << octaveDown;
+            qCDebug(lcScaleSnap) << "ScaleSnap Voice" << voiceIndex << ": adjusted down octave to" << octaveDown;
             harmonyNote = octaveDown;
         } else {
             // Try finding a nearby chord tone that doesn't clash
@@ -3709,7 +3831,7 @@ int ScaleSnapProcessor::generateHarmonyForVoice(int voiceIndex, int inputNote,
                     if (!chordTones.contains(candidatePc) && !validPcs.contains(candidatePc)) continue;
 
                     if (!wouldClashWithOtherVoices(candidate, otherVoiceNotes)) {
-                        qDebug() << "ScaleSnap Voice" << voiceIndex << ": found non-clashing alternative" << candidate;
+                        qCDebug(lcScaleSnap) << "ScaleSnap Voice" << voiceIndex << ": found non-clashing alternative" << candidate;
                         harmonyNote = candidate;
                         goto adjusted;
                     }
@@ -3723,7 +3845,7 @@ int ScaleSnapProcessor::generateHarmonyForVoice(int voiceIndex, int inputNote,
     return harmonyNote;
 }
 
-bool ScaleSnapProcessor::wouldClashWithOtherVoices(int candidateNote, const QVector<int>& otherVoiceNotes) const
+bool ScaleSnapProcessor::wouldClashWithOtherVoices(int candidateNote, const VoiceNoteList& otherVoiceNotes) const
 {
     if (candidateNote < 0 || otherVoiceNotes.isEmpty()) {
         return false;
@@ -3736,14 +3858,14 @@ bool ScaleSnapProcessor::wouldClashWithOtherVoices(int candidateNote, const QVec
 
         // Unison (same note) - definitely a clash
         if (interval == 0) {
-            qDebug() << "ScaleSnap: Clash detected - unison with" << otherNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap: Clash detected - unison with" << otherNote;
             return true;
         }
 
         // Minor 2nd (1 semitone) or Major 7th (11 semitones) - harsh dissonance
         int intervalClass = interval % 12;
         if (intervalClass == 1 || intervalClass == 11) {
-            qDebug() << "ScaleSnap: Clash detected - m2/M7 between" << candidateNote << "and" << otherNote;
+            qCDebug(lcScaleSnap) << "ScaleSnap: Clash detected - m2/M7 between" << candidateNote << "and" << otherNote;
             return true;
         }
 
@@ -3755,7 +3877,7 @@ bool ScaleSnapProcessor::wouldClashWithOtherVoices(int candidateNote, const QVec
 }
 
 int ScaleSnapProcessor::generateParallelFixedHarmonyNote(int inputNote, int intervalSemitones,
-                                                          const QSet<int>& validPcs) const
+                                                          const PitchClassSet& validPcs) const
 {
     // Apply interval, then conform the result to the nearest valid pitch
     // class. We pick the nearest scale member by minimum |delta semitones|,
@@ -3796,20 +3918,20 @@ int ScaleSnapProcessor::generateParallelFixedHarmonyNote(int inputNote, int inte
     return (bestNote >= 0) ? bestNote : target;
 }
 
-int ScaleSnapProcessor::generateDroneHarmonyNote(int octave) const
+int ScaleSnapProcessor::generateDroneHarmonyNote(int octave, const HarmonicSnapshot& ctx) const
 {
-    if (!m_hasLastKnownChord || m_lastKnownChord.rootPc < 0) return -1;
+    if (!ctx.hasChord || ctx.chord.rootPc < 0) return -1;
     if (octave < 0) octave = 0;
     if (octave > 9) octave = 9;
     // C-1 = 0, C0 = 12, C3 = 48 (typical "octave 3" convention).
-    int note = (octave + 1) * 12 + normalizePc(m_lastKnownChord.rootPc);
+    int note = (octave + 1) * 12 + normalizePc(ctx.chord.rootPc);
     if (note < 0)   note = 0;
     if (note > 127) note = 127;
     return note;
 }
 
 int ScaleSnapProcessor::generateScaleParallelHarmonyNote(int inputNote, int scaleStepOffset,
-                                                          const QSet<int>& validPcs) const
+                                                          const PitchClassSet& validPcs) const
 {
     if (validPcs.isEmpty()) return inputNote;
     if (scaleStepOffset < -14) scaleStepOffset = -14;
@@ -3938,18 +4060,9 @@ void ScaleSnapProcessor::emitHarmonyNoteOn(int channel, int note, int velocity,
         m_humanizationDelayMs[voiceIndex] = delayMs;
     }
 
-    if (delayMs <= 0) {
-        // No delay - emit immediately
-        m_midi->sendVirtualNoteOn(channel, note, velocity);
-    } else {
-        // Delay the note-on using QTimer::singleShot
-        // Capture by value to ensure data survives the lambda
-        QTimer::singleShot(delayMs, this, [this, channel, note, velocity]() {
-            if (m_midi) {
-                m_midi->sendVirtualNoteOn(channel, note, velocity);
-            }
-        });
-    }
+    // MidiProcessor's worker sends it at now + delay. Undelayed notes take
+    // the same path so they stay ordered behind still-pending delayed ones.
+    m_midi->scheduleVirtualNoteOn(channel, note, velocity, qint64(delayMs) * 1000000);
 }
 
 void ScaleSnapProcessor::emitHarmonyNoteOff(int channel, int note, int voiceIndex)
@@ -3964,17 +4077,9 @@ void ScaleSnapProcessor::emitHarmonyNoteOff(int channel, int note, int voiceInde
         delayMs = m_humanizationDelayMs[voiceIndex];
     }
 
-    if (delayMs <= 0) {
-        // No delay - emit immediately
-        m_midi->sendVirtualNoteOff(channel, note);
-    } else {
-        // Delay the note-off to match note-on delay
-        QTimer::singleShot(delayMs, this, [this, channel, note]() {
-            if (m_midi) {
-                m_midi->sendVirtualNoteOff(channel, note);
-            }
-        });
-    }
+    // The worker never sends this before the matching scheduled note-on,
+    // even if the voice's delay has changed since.
+    m_midi->scheduleVirtualNoteOff(channel, note, qint64(delayMs) * 1000000);
 }
 
 void ScaleSnapProcessor::onVoiceNoteOn(int midiNote)
@@ -4010,9 +4115,6 @@ void ScaleSnapProcessor::emitVocalSyncShift()
 
 void ScaleSnapProcessor::emitAllNotesOff()
 {
-    // Thread safety: Lock for reading m_activeNotes (recursive lock allows nested calls)
-    QReadLocker lock(&m_activeNotesLock);
-
     for (auto it = m_activeNotes.begin(); it != m_activeNotes.end(); ++it) {
         releaseNote(it.value());
     }
@@ -4056,20 +4158,14 @@ void ScaleSnapProcessor::releaseNote(const ActiveNote& note)
 
 void ScaleSnapProcessor::releaseVoiceSustainedNotes()
 {
-    // Thread safety: Lock for modifying m_activeNotes (recursive lock allows nested calls)
-    QWriteLocker lock(&m_activeNotesLock);
-
     // Release all notes that are being held by voice sustain
-    QList<int> toRemove;
+    // (erasing the current entry keeps the iterator valid)
     for (auto it = m_activeNotes.begin(); it != m_activeNotes.end(); ++it) {
         if (it.value().voiceSustained) {
             releaseNote(it.value());
-            toRemove.append(it.key());
+            m_activeNotes.erase(it);
         }
     }
-    for (int key : toRemove) {
-        m_activeNotes.remove(key);
-    }
 
     // Reset state when no notes are active
     if (m_activeNotes.isEmpty()) {
@@ -4082,7 +4178,7 @@ void ScaleSnapProcessor::releaseVoiceSustainedNotes()
         m_vibratoFadeInSamples = 0;
         m_oscillationDetected = false;
         m_lastOscillation = 0.0;
-        qDebug() << "ScaleSnap: Voice sustain notes released";
+        qCDebug(lcScaleSnap) << "ScaleSnap: Voice sustain notes released";
         if (m_leadMode == LeadMode::VocalSync) {
             // Don't reset here — this runs inside onGuitarNoteOn during legato,
             // which would cause a brief passthrough blip. Reset only in onGuitarNoteOff.
@@ -4241,7 +4337,7 @@ bool ScaleSnapProcessor::wouldCreateParallelPerfect(int prevLead, int prevHarmon
                             (leadMovement < 0 && harmonyMovement < 0);
 
         if (sameDirection && leadMovement != 0 && harmonyMovement != 0) {
-            qDebug() << "ScaleSnap COUNTERPOINT: FORBIDDEN parallel"
+            qCDebug(lcScaleSnap) << "ScaleSnap COUNTERPOINT: FORBIDDEN parallel"
                      << (prevInterval == 7 ? "5ths" : "octaves") << "detected!";
             return true;
         }
@@ -4293,7 +4389,7 @@ bool ScaleSnapProcessor::isLikelyChromaticSweep() const
     const bool mostlyChromatic = (chromaticCount >= 3);
     const bool consistentDirection = (sameDirection >= 3);
 
-    qDebug() << "ChromaticSweep check: chromaticCount=" << chromaticCount
+    qCDebug(lcScaleSnap) << "ChromaticSweep check: chromaticCount=" << chromaticCount
              << "sameDirection=" << sameDirection
              << "result=" << (mostlyChromatic && consistentDirection);
 
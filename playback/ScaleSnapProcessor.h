@@ -1,18 +1,20 @@
 #pragma once
 
 #include <QObject>
-#include <QSet>
-#include <QHash>
+#include <QStringView>
+#include <QVarLengthArray>
 #include <QVector>
-#include <QReadWriteLock>
 #include <array>
 #include <atomic>
+#include <memory>
 
 #include "music/ChordSymbol.h"
 #include "playback/HarmonyTypes.h"
 #include "playback/ChordOntology.h"
 #include "playback/PitchConformanceEngine.h"
 #include "playback/GlissandoProcessor.h"
+#include "playback/NoteSlotTable.h"
+#include "midi/IGuitarStage.h"
 
 class MidiProcessor;
 
@@ -45,7 +47,7 @@ class HarmonyContext;
  *
  * Conformance behaviors: ALLOW, SNAP, BEND, ANTICIPATE, DELAY
  */
-class ScaleSnapProcessor : public QObject {
+class ScaleSnapProcessor : public QObject, public midi::IGuitarStage {
     Q_OBJECT
 
 public:
@@ -76,6 +78,16 @@ public:
     explicit ScaleSnapProcessor(QObject* parent = nullptr);
     ~ScaleSnapProcessor() override;
 
+    // midi::IGuitarStage: setMidiProcessor() registers this processor as the
+    // MidiProcessor's inline guitar stage, so these run on the MIDI worker.
+    void guitarNoteOn(int midiNote, int velocity) override { onGuitarNoteOn(midiNote, velocity); }
+    void guitarNoteOff(int midiNote) override { onGuitarNoteOff(midiNote); }
+    // Conformance tick (bend/delay/timed behaviors) and the sustain-smoothing deadline.
+    // Ticks every kTickPeriodNs only while a glide, bend, VocalSync shift or timed note
+    // is in flight; otherwise the deadline is the pending sustain release, if any.
+    void tick(std::int64_t nowNs) override;
+    std::int64_t nextTickDeadlineNs() const override;
+
     // Dependencies (must be set before use)
     void setMidiProcessor(MidiProcessor* midi);
     void setHarmonyContext(HarmonyContext* harmony);
@@ -203,13 +215,41 @@ public:
     // Audio Track Switch editor for visual debugging.
     QString currentScaleSummary(bool preferFlats = true) const;
 
+    // --- Harmonic snapshot ---
+    // Everything the note-on path needs to know about the current chord/scale,
+    // derived once when the harmonic context changes (chart cell, default chord,
+    // chart/ontology/harmony context, voice config) instead of on every guitar
+    // attack. Published by atomically swapping an immutable shared_ptr, so a
+    // reader always sees one consistent snapshot.
+    struct HarmonicSnapshot {
+        bool hasChord = false;
+        music::ChordSymbol chord;          // resolveHarmonyChord() at build time; the note-on path reads only this
+
+        PitchClassSet validPcs;            // computeValidPitchClasses(*this)
+        PitchClassSet chordTones;          // computeChordTones(chord)
+
+        // snapToNearestValidPc(pc, validPcs) for every pc (identity if validPcs is empty).
+        std::array<qint8, 12> nearestValidPc{};
+
+        // buildActiveChord(*this): tier masks for PitchConformanceEngine / validateHarmonyNote.
+        ActiveChord activeChord;
+
+        // Per-voice harmony note for every lead note, for the stateless motion
+        // types (PARALLEL_FIXED, DRONE, SCALE_PARALLEL): generateHarmonyForVoice()
+        // result, -1 = no note. Voices with stateful motion are not tabled.
+        std::array<bool, 4> voiceTabled{};
+        std::array<std::array<qint16, 128>, 4> voiceNotes{};
+    };
+    std::shared_ptr<const HarmonicSnapshot> harmonicSnapshot() const;
+
     // --- Voice Channel-10 scale snap relay ---
     // The actual snapping happens on MidiProcessor's worker thread (lock-free
     // via an atomic 12-bit pitch-class mask). These methods are convenience
     // relays so the SnappingWindow can drive the feature without holding a
     // direct MidiProcessor pointer. publishVoiceScaleMask() recomputes the
     // current valid-PC mask from the active chord/scale and pushes it to
-    // MidiProcessor; call it whenever the chord changes.
+    // MidiProcessor; call it whenever the chord changes. It rebuilds and
+    // republishes the harmonic snapshot as well.
     void setVoiceCh10SnapEnabled(bool enabled);
     bool voiceCh10SnapEnabled() const;
     void publishVoiceScaleMask();
@@ -225,6 +265,7 @@ public:
     // Periodic update for time-based conformance (call from audio/timer callback)
     // deltaMs: milliseconds since last update
     void updateConformance(float deltaMs);
+    bool conformanceTickPending() const; // updateConformance() has timed work to advance
 
 signals:
     void leadModeChanged(LeadMode newMode);
@@ -242,7 +283,7 @@ signals:
     void voiceSustainThresholdChanged(int threshold);
 
 public slots:
-    // Guitar input handlers (connected to MidiProcessor signals)
+    // Guitar input handlers (note on/off arrive via the inline guitar stage)
     void onGuitarNoteOn(int midiNote, int velocity);
     void onGuitarNoteOff(int midiNote);
     void onGuitarHzUpdated(double hz);
@@ -261,6 +302,9 @@ public slots:
     void reset();
 
 private:
+    // Test-only access to the snapshot builders (playback/tests).
+    friend struct ScaleSnapProcessorTestAccess;
+
     // Active note tracking (for note-off routing and pitch bend)
     // Defined here so it can be used by helper method declarations below
     struct ActiveNote {
@@ -293,27 +337,27 @@ private:
     };
 
     // Core snapping logic
-    int snapToNearestValidPc(int inputPc, const QSet<int>& validPcs) const;
-    int generateHarmonyNote(int inputNote, const QSet<int>& chordTones, const QSet<int>& scaleTones) const;
-    int generateParallelHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove = false) const;
-    int generateContraryHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove = false) const;
-    int generateSimilarHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove = false) const;
-    int generateObliqueHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const QSet<int>& chordTones, const QSet<int>& validPcs, bool harmonyAbove = false) const;
+    int snapToNearestValidPc(int inputPc, const PitchClassSet& validPcs) const;
+    int generateHarmonyNote(int inputNote, const PitchClassSet& chordTones, const PitchClassSet& scaleTones) const;
+    int generateParallelHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove = false) const;
+    int generateContraryHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove = false) const;
+    int generateSimilarHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove = false) const;
+    int generateObliqueHarmonyNote(int inputNote, int previousLeadNote, int previousHarmonyNote, const PitchClassSet& chordTones, const PitchClassSet& validPcs, bool harmonyAbove = false) const;
 
     // PARALLEL_FIXED: lead + interval (semitones), then snap result to the
     //   nearest pitch class in validPcs (chord+scale tones derived from the
     //   current default chord). Returns a MIDI note ready to be range-applied.
     int generateParallelFixedHarmonyNote(int inputNote, int intervalSemitones,
-                                         const QSet<int>& validPcs) const;
+                                         const PitchClassSet& validPcs) const;
     // DRONE: emit the chord root in the configured base octave.
     //   Returns rootPc + (octave * 12), clamped to MIDI range, or -1 if no
     //   chord is set yet.
-    int generateDroneHarmonyNote(int octave) const;
+    int generateDroneHarmonyNote(int octave, const HarmonicSnapshot& ctx) const;
     // SCALE_PARALLEL: find the lead's position in the current scale (or the
     //   nearest scale tone if it's chromatic), then offset by N scale steps.
     //   Always lands on a scale tone; consecutive leads never collide.
     int generateScaleParallelHarmonyNote(int inputNote, int scaleStepOffset,
-                                         const QSet<int>& validPcs) const;
+                                         const PitchClassSet& validPcs) const;
 
     // Final validation: ensures harmony note is T1, T2, or T3 (not chromatic T4)
     // If T4, snaps to nearest T1 (chord tone). Returns validated MIDI note.
@@ -321,18 +365,31 @@ private:
 
     // Multi-voice harmony generation
     // otherVoiceNotes: harmony notes already generated by other voices (for inter-voice consonance)
-    int generateHarmonyForVoice(int voiceIndex, int inputNote, const QSet<int>& chordTones,
-                                 const QSet<int>& validPcs, const QVector<int>& otherVoiceNotes = {}) const;
+    using VoiceNoteList = QVarLengthArray<int, 5>;  // lead + 4 voices, no heap allocation
+    // ctx supplies the chord, chord tones and valid pitch classes (a snapshot, or one being built).
+    int generateHarmonyForVoice(int voiceIndex, int inputNote, const HarmonicSnapshot& ctx,
+                                const VoiceNoteList& otherVoiceNotes = {}) const;
     int applyVoiceRange(int note, int minNote, int maxNote) const;  // Octave-shift to fit range
-    bool wouldClashWithOtherVoices(int candidateNote, const QVector<int>& otherVoiceNotes) const;  // Check inter-voice dissonance
-
-    QSet<int> computeValidPitchClasses() const;
-    QSet<int> computeChordTones(const music::ChordSymbol& chord) const;
-    QSet<int> computeKeyScaleTones() const;  // Uses dynamic key detection
-    ActiveChord buildActiveChord() const;    // Build ActiveChord from current context
-
-    // Chord change handling
-    void checkAndReconformOnChordChange(int previousCellIndex);  // Re-conform notes when chord changes
+    bool wouldClashWithOtherVoices(int candidateNote, const VoiceNoteList& otherVoiceNotes) const;  // Check inter-voice dissonance
+
+    // Chord the current context resolves to (default chord, or chart cell with
+    // last-known / backward-scan fallbacks). Reads only; false = no chord.
+    bool resolveHarmonyChord(music::ChordSymbol& out) const;
+    // Derived from ctx.hasChord / ctx.chord plus the key context.
+    PitchClassSet computeValidPitchClasses(const HarmonicSnapshot& ctx) const;
+    PitchClassSet computeChordTones(const music::ChordSymbol& chord) const;
+    PitchClassSet computeKeyScaleTones() const;  // Uses dynamic key detection
+    ActiveChord buildActiveChord(const HarmonicSnapshot& ctx) const;
+
+    // Resolves the chord (recording it as the last known chord), rebuilds the
+    // harmonic snapshot, publishes it and pushes its valid-PC mask to
+    // MidiProcessor (voice ch-10 snap). Runs on the note-table owner only;
+    // setters reach it through runOnOwner.
+    void rebuildHarmonicSnapshot();
+
+    // Chord change handling: re-conform notes when the chord changes. True when
+    // it rebuilt the snapshot for the new chord.
+    bool checkAndReconformOnChordChange(int previousCellIndex);
 
     // MIDI output helpers
     void emitNoteOn(int channel, int note, int velocity);
@@ -345,6 +402,7 @@ private:
 
     // Humanization helpers
     int calculateHumanizationDelayMs(int voiceIndex) const;  // BPM-constrained delay for a voice
+    // Scheduled on MidiProcessor's worker; voiceIndex -1 = no humanization delay.
     void emitHarmonyNoteOn(int channel, int note, int velocity, int voiceIndex);  // Delayed if humanization enabled
     void emitHarmonyNoteOff(int channel, int note, int voiceIndex);  // Matches delay from note-on
 
@@ -385,7 +443,7 @@ private:
     // major / minor / dominant cleanly; this covers dim / aug / sus
     // / m7b5 etc. with the right diatonic completion (e.g. natural
     // minor for "Bm", locrian for "Bdim", etc.).
-    QString scaleKeyForChord(const music::ChordSymbol& c) const;
+    QStringView scaleKeyForChord(const music::ChordSymbol& c) const;
 
     // State
     LeadMode m_leadMode = LeadMode::Original;
@@ -412,6 +470,9 @@ private:
     bool m_sustainSmoothingEnabled = true;    // Enabled by default - delay release on brief silences
     int m_sustainSmoothingMs = 500;           // Default 500ms hold time after CC2 drops
     bool m_sustainReleaseTimerActive = false; // True when waiting to release after CC2 dropped
+    std::int64_t m_sustainReleaseDueNs = 0;    // monotonicNowNs() deadline for that release (checked in tick())
+    std::int64_t m_lastTickNs = 0;             // 0 while idle: the next tick starts a fresh clock
+    static constexpr std::int64_t kTickPeriodNs = 10000000; // 10 ms conformance/glide cadence
     bool m_releaseBendPreventionEnabled = true; // Enabled by default - freeze pitch bend on voice-sustained notes
     int m_voiceSustainThreshold = 5;           // CC2 threshold for sustain (1-10, lower = more sensitive)
     int m_harmonyRangeMin = 0;                // Min MIDI note for harmony (default: no limit)
@@ -453,7 +514,8 @@ private:
     // Returns true if recent playing pattern looks like a chromatic sweep
     bool isLikelyChromaticSweep() const;
 
-    // Track last known chord (to persist across empty cells)
+    // Track last known chord (to persist across empty cells). Written only on
+    // the note-table owner (MIDI worker), alongside the snapshot.
     music::ChordSymbol m_lastKnownChord;
     bool m_hasLastKnownChord = false;
     // True when the chord was set explicitly via setDefaultHarmonyChord
@@ -482,8 +544,12 @@ private:
     std::array<int, 4>  m_upcomingHarmony  = {-1, -1, -1, -1};
     std::array<bool, 4> m_skipUpcomingOn   = {false, false, false, false};
 
-    QHash<int, ActiveNote> m_activeNotes;  // key = original input note
-    mutable QReadWriteLock m_activeNotesLock{QReadWriteLock::Recursive};  // Thread safety for m_activeNotes (recursive to allow nested locking)
+    // Current harmonic snapshot; always accessed with std::atomic_load/atomic_store.
+    std::shared_ptr<const HarmonicSnapshot> m_snapshot;
+
+    // key = original input note. Owned by the MIDI worker (guitar stage, voice slots, tick());
+    // UI-thread entry points that touch it go through MidiProcessor::runOnWorker(), so no lock.
+    NoteSlotTable<ActiveNote> m_activeNotes;
 
     // VocalSync: continuous Hz tracking for shift calculation
     double m_vocalSyncGuitarHz = 0.0;              // Current guitar Hz (note + pitch bend)
@@ -9,6 +9,8 @@
 #include "playback/AutoWeightController.h"
 #include "playback/WeightNegotiator.h"
 #include "playback/ChordScaleTable.h"
+#include "playback/PrePlaybackCacheStore.h"
+#include "virtuoso/util/RegistryBundle.h"
 
 #include <QHash>
 #include <QDateTime>
@@ -153,6 +155,18 @@ void VirtuosoBalladMvpPlaybackEngine::onVoiceCc2Stream(int cc2) {
     m_interaction.ingestCc2(cc2, QDateTime::currentMSecsSinceEpoch());
 }
 
+void VirtuosoBalladMvpPlaybackEngine::pollContinuousState() {
+    if (!m_midi) return;
+    const quint64 version = m_midi->continuousVersion();
+    if (version == m_lastContinuousVersion) return;
+    m_lastContinuousVersion = version;
+    const midi::ContinuousState s = m_midi->continuousState();
+    if (s.voiceCc2Samples != m_lastCc2Samples) {
+        m_lastCc2Samples = s.voiceCc2Samples;
+        onVoiceCc2Stream(s.voiceCc2);
+    }
+}
+
 void VirtuosoBalladMvpPlaybackEngine::onVoiceNoteOn(int note, int vel) {
     m_interaction.ingestVoiceNoteOn(note, vel, QDateTime::currentMSecsSinceEpoch());
 }
@@ -162,22 +176,26 @@ void VirtuosoBalladMvpPlaybackEngine::onVoiceNoteOff(int note) {
 }
 
 VirtuosoBalladMvpPlaybackEngine::VirtuosoBalladMvpPlaybackEngine(QObject* parent)
-    : QObject(parent)
-    , m_registry(virtuoso::groove::GrooveRegistry::builtins()) {
+    : QObject(parent) {
     m_tickTimer.setInterval(10);
     m_tickTimer.setTimerType(Qt::PreciseTimer);
     connect(&m_tickTimer, &QTimer::timeout, this, &VirtuosoBalladMvpPlaybackEngine::onTick);
+    m_continuousPollTimer.setInterval(10);
+    connect(&m_continuousPollTimer, &QTimer::timeout, this, &VirtuosoBalladMvpPlaybackEngine::pollContinuousState);
 
     connect(&m_engine, &virtuoso::engine::VirtuosoEngine::theoryEventJson,
             this, &VirtuosoBalladMvpPlaybackEngine::theoryEventJson);
     connect(&m_engine, &virtuoso::engine::VirtuosoEngine::plannedTheoryEventJson,
             this, &VirtuosoBalladMvpPlaybackEngine::plannedTheoryEventJson);
 
-    // Load data-driven vocabulary (rhythmic/phrase patterns) from resources.
+    // Precompiled registries (ontology, groove, vocabulary, chord→scale table) when the build
+    // embedded them; each falls back to its code/JSON path on its own.
+    const virtuoso::util::RegistryBundle* bundle = virtuoso::util::RegistryBundle::embedded();
+
+    // Data-driven vocabulary (rhythmic/phrase patterns), shared by every engine in the process.
     {
-        QString err;
-        m_vocabLoaded = m_vocab.loadFromResourcePath(":/virtuoso/vocab/cool_jazz_vocabulary.json", &err);
-        m_vocabError = err;
+        m_vocabLoaded = m_vocab.isLoaded();
+        m_vocabError = m_vocab.lastError();
         // Bass planner consumes VocabularyRegistry directly.
         m_bassPlanner.setVocabulary(m_vocabLoaded ? &m_vocab : nullptr);
         // Piano planner consumes VocabularyRegistry for comping rhythm grammar.
@@ -198,7 +216,7 @@ VirtuosoBalladMvpPlaybackEngine::VirtuosoBalladMvpPlaybackEngine(QObject* parent
 
     // Initialize global chord→scale lookup table (once at startup)
     // This provides O(1) scale selection during pre-planning.
-    ChordScaleTable::initialize(m_ontology);
+    if (!bundle || !ChordScaleTable::initializeFromBundle(*bundle)) ChordScaleTable::initialize(m_ontology);
 }
 
 void VirtuosoBalladMvpPlaybackEngine::emitLookaheadPlanOnce() {
@@ -264,8 +282,15 @@ void VirtuosoBalladMvpPlaybackEngine::emitLookaheadPlanOnce() {
     if (!json.trimmed().isEmpty()) emit lookaheadPlanJson(json);
 }
 
+void VirtuosoBalladMvpPlaybackEngine::setRealtimeDispatch(bool on) {
+    if (on == m_realtimeDispatch) return; // re-arming would restart the dispatch thread
+    m_realtimeDispatch = on;
+    m_engine.setRealtimeOutput((m_realtimeDispatch && m_midi) ? m_midi->virtualBandSink() : nullptr);
+}
+
 void VirtuosoBalladMvpPlaybackEngine::setMidiProcessor(MidiProcessor* midi) {
     m_midi = midi;
+    m_engine.setRealtimeOutput((m_realtimeDispatch && m_midi) ? m_midi->virtualBandSink() : nullptr);
     if (!m_midi) return;
 
     connect(&m_engine, &virtuoso::engine::VirtuosoEngine::noteOn,
@@ -285,9 +310,9 @@ void VirtuosoBalladMvpPlaybackEngine::setMidiProcessor(MidiProcessor* midi) {
     connect(m_midi, &MidiProcessor::guitarNoteOff,
             this, &VirtuosoBalladMvpPlaybackEngine::onGuitarNoteOff,
             static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
-    connect(m_midi, &MidiProcessor::voiceCc2Stream,
-            this, &VirtuosoBalladMvpPlaybackEngine::onVoiceCc2Stream,
-            static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
+    // Breath (CC2) for interaction/vibe detection: polled at 100 Hz from the
+    // processor's latest-value block rather than one queued event per sample.
+    m_continuousPollTimer.start();
 
     // Vocal melody tracking (NOT used for density): allows later call/response.
     connect(m_midi, &MidiProcessor::voiceNoteOn,
@@ -297,30 +322,25 @@ void VirtuosoBalladMvpPlaybackEngine::setMidiProcessor(MidiProcessor* midi) {
             this, &VirtuosoBalladMvpPlaybackEngine::onVoiceNoteOff,
             static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
 
-    // ScaleSnapProcessor: connect guitar signals for scale-aware pitch correction.
-    // IMPORTANT: Use DirectConnection for note on/off to ensure notes are added to m_activeNotes
-    // immediately, before any queued voiceHzUpdated events are processed. This prevents a race
-    // condition where voiceHzUpdated would find m_activeNotes empty and bail out.
+    // ScaleSnapProcessor: setMidiProcessor() installs it as the MidiProcessor's inline guitar
+    // stage, so guitar note on/off run synchronously on the MIDI worker (no signal dispatch) and
+    // its lead/harmony output is sent on the same worker pass. Notes are in m_activeNotes before
+    // any queued voiceHzUpdated event can look for them.
     m_scaleSnap.setMidiProcessor(m_midi);
-    connect(m_midi, &MidiProcessor::guitarNoteOn,
-            &m_scaleSnap, &ScaleSnapProcessor::onGuitarNoteOn,
-            static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
-    connect(m_midi, &MidiProcessor::guitarNoteOff,
-            &m_scaleSnap, &ScaleSnapProcessor::onGuitarNoteOff,
-            static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
     connect(m_midi, &MidiProcessor::guitarHzUpdated,
             &m_scaleSnap, &ScaleSnapProcessor::onGuitarHzUpdated,
             static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
 
     // Forward CC2 (breath) from voice to ScaleSnapProcessor for expression on snapped channels.
+    // DirectConnection: ScaleSnap's note table belongs to the MIDI worker, which emits these.
     connect(m_midi, &MidiProcessor::voiceCc2Updated,
             &m_scaleSnap, &ScaleSnapProcessor::onVoiceCc2Updated,
-            static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
+            static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
 
     // Forward voice Hz (for AsPlayedPlusBend mode - measures delta from snapped note for vibrato)
     connect(m_midi, &MidiProcessor::voiceHzUpdated,
             &m_scaleSnap, &ScaleSnapProcessor::onVoiceHzUpdated,
-            static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection));
+            static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
 
     // Forward voice MIDI notes (for VocalSync mode - stable integer note tracking)
     connect(m_midi, &MidiProcessor::voiceNoteOn,
@@ -591,10 +611,6 @@ void VirtuosoBalladMvpPlaybackEngine::onTick() {
         m_scaleSnap.setBeatPosition(static_cast<float>(beatFraction));
     }
 
-    // Update ScaleSnapProcessor conformance (for BEND and DELAY behaviors)
-    // The tick timer runs every 10ms
-    m_scaleSnap.updateConformance(10.0f);
-
     // Update playhead highlight once per beat-step.
     if (stepNow != m_lastPlayheadStep) {
         m_lastPlayheadStep = stepNow;
@@ -888,27 +904,11 @@ void VirtuosoBalladMvpPlaybackEngine::buildPrePlaybackCache() {
     QElapsedTimer timer;
     timer.start();
     
-    // Clear any existing cache
+    // Keep the previous cache: after an edit (chart region, tempo, style, orchestrator toggle) the
+    // builder reuses every plan that is provably unchanged instead of replanning the whole song.
+    PrePlaybackCache previous = std::move(m_preCache);
     m_preCache.clear();
     
-    // Create and show the progress dialog
-    if (!m_prePlanningDialog) {
-        // Find parent widget for dialog (walk up to find a QWidget)
-        QWidget* parentWidget = nullptr;
-        QObject* p = parent();
-        while (p) {
-            if (auto* w = qobject_cast<QWidget*>(p)) {
-                parentWidget = w;
-                break;
-            }
-            p = p->parent();
-        }
-        m_prePlanningDialog = new PrePlanningDialog(parentWidget);
-    }
-    
-    // Start the dialog with a generic title
-    m_prePlanningDialog->start("Preparing Performance");
-    
     // Build input structure for the cache builder
     PrePlaybackBuilder::Inputs in;
     in.model = &m_model;
@@ -928,6 +928,42 @@ void VirtuosoBalladMvpPlaybackEngine::buildPrePlaybackCache() {
     in.chPiano = m_chPiano;
     in.chDrums = m_chDrums;
     in.agentEnergyMult = m_agentEnergyMult;
+    in.vocabularyHash = m_vocabLoaded ? m_vocab.contentHash() : 0u;
+
+    // Warm start: an identical chart/tempo/style was pre-planned before (this or an earlier session).
+    PrePlaybackCacheStore::Key storeKey;
+    QString storePath;
+    if (m_persistPreCache) {
+        storeKey = PrePlaybackCacheStore::keyFor(in);
+        storePath = PrePlaybackCacheStore::pathFor(PrePlaybackCacheStore::defaultDirectory(), storeKey);
+        QString err;
+        if (PrePlaybackCacheStore::load(storePath, storeKey, &m_preCache, &err)) {
+            emit prePlanningProgress(2, 1.0, "Ready!");
+            m_bassPlanner.reset();
+            m_pianoPlanner.reset();
+            m_harmony.resetRuntimeState();
+            qInfo().noquote() << QString("buildPrePlaybackCache: Loaded %1 in %2ms").arg(storePath).arg(timer.elapsed());
+            return;
+        }
+    }
+    
+    // Create and show the progress dialog
+    if (!m_prePlanningDialog) {
+        // Find parent widget for dialog (walk up to find a QWidget)
+        QWidget* parentWidget = nullptr;
+        QObject* p = parent();
+        while (p) {
+            if (auto* w = qobject_cast<QWidget*>(p)) {
+                parentWidget = w;
+                break;
+            }
+            p = p->parent();
+        }
+        m_prePlanningDialog = new PrePlanningDialog(parentWidget);
+    }
+    
+    // Start the dialog with a generic title
+    m_prePlanningDialog->start("Preparing Performance");
     
     // Track maximum progress seen from parallel branches (thread-safe via atomic)
     std::atomic<int> maxBranchProgressPct{0};
@@ -979,8 +1015,15 @@ void VirtuosoBalladMvpPlaybackEngine::buildPrePlaybackCache() {
         }
     };
     
-    // Build the cache (optimized: ~400-800ms for a full song)
-    m_preCache = PrePlaybackBuilder::build(in, progressCallback);
+    // Build the cache (optimized: ~400-800ms for a full song; incremental edits are much cheaper)
+    m_preCache = PrePlaybackBuilder::rebuild(in, previous, progressCallback);
+    previous.clear();
+    if (m_persistPreCache && m_preCache.isValid()) {
+        QString err;
+        if (!PrePlaybackCacheStore::save(storePath, storeKey, m_preCache, &err)) {
+            qWarning().noquote() << QString("buildPrePlaybackCache: could not persist cache to %1: %2").arg(storePath, err);
+        }
+    }
     
     // Process any pending queued UI updates from worker threads
     QCoreApplication::processEvents();
@@ -40,6 +40,14 @@ public:
     explicit VirtuosoBalladMvpPlaybackEngine(QObject* parent = nullptr);
 
     void setMidiProcessor(MidiProcessor* midi);
+    // Dispatch band MIDI from a dedicated realtime thread straight into MidiProcessor's virtual-band ring
+    // (bypasses the GUI event loop). Off here (QTimer + queued signals); MainWindow turns it on from the
+    // "Realtime Band Dispatch" setting, which defaults to on.
+    void setRealtimeDispatch(bool on);
+    bool realtimeDispatch() const { return m_realtimeDispatch; }
+    // Reuse pre-planned caches across plays/sessions (PrePlaybackCacheStore). Default on.
+    void setPersistentPreCache(bool on) { m_persistPreCache = on; }
+    bool persistentPreCache() const { return m_persistPreCache; }
     void setTempoBpm(int bpm);
     void setRepeats(int repeats);
     void setChartModel(const chart::ChartModel& model);
@@ -132,6 +140,7 @@ private slots:
     void onGuitarNoteOn(int note, int vel);
     void onGuitarNoteOff(int note);
     void onVoiceCc2Stream(int cc2);
+    void pollContinuousState(); // feeds onVoiceCc2Stream from the latest-value block
     void onVoiceNoteOn(int note, int vel);
     void onVoiceNoteOff(int note);
 
@@ -182,14 +191,20 @@ private:
     int m_lastLookaheadBuildMs = -1;
 
     QTimer m_tickTimer;
+    // Polls MidiProcessor::continuousState() (voice breath) at 100 Hz.
+    QTimer m_continuousPollTimer;
+    quint64 m_lastContinuousVersion = 0;
+    quint32 m_lastCc2Samples = 0;
 
     // New engine (internal clock domain)
     virtuoso::engine::VirtuosoEngine m_engine;
-    virtuoso::groove::GrooveRegistry m_registry;
-    virtuoso::ontology::OntologyRegistry m_ontology = virtuoso::ontology::OntologyRegistry::builtins();
+    // Process-wide immutable registries (precompiled bundle, else builtins/JSON).
+    const virtuoso::groove::GrooveRegistry& m_registry = virtuoso::groove::GrooveRegistry::shared();
+    const virtuoso::ontology::OntologyRegistry& m_ontology = virtuoso::ontology::OntologyRegistry::shared();
     QString m_stylePresetKey = "jazz_brushes_ballad_60_evans";
 
     MidiProcessor* m_midi = nullptr; // not owned
+    bool m_realtimeDispatch = false;
 
     HarmonyContext m_harmony;
     ScaleSnapProcessor m_scaleSnap;
@@ -202,7 +217,7 @@ private:
     BrushesBalladDrummer m_drummer;
 
     // Data-driven rhythmic vocabulary (optional, but enabled by default for ballad MVP).
-    virtuoso::vocab::VocabularyRegistry m_vocab;
+    const virtuoso::vocab::VocabularyRegistry& m_vocab = virtuoso::vocab::VocabularyRegistry::shared();
     bool m_vocabLoaded = false;
     QString m_vocabError;
 
@@ -218,6 +233,7 @@ private:
     // Pre-computed playback cache (built before playback starts)
     PrePlaybackCache m_preCache;
     bool m_usePreCache = true;  // When true, use pre-computed cache instead of real-time planning
+    bool m_persistPreCache = true;  // When true, load/save m_preCache via PrePlaybackCacheStore
     PrePlanningDialog* m_prePlanningDialog = nullptr;  // Popup shown during pre-planning
     EnergyBand m_currentEnergyBand = EnergyBand::Simmer;  // Track current band for hysteresis
 
@@ -0,0 +1,231 @@
+#include "playback/ScaleSnapProcessor.h"
+#include "playback/HarmonyContext.h"
+#include "chart/ChartModel.h"
+#include "music/ChordSymbol.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QString>
+#include <QtGlobal>
+
+#include <cstdlib>
+#include <set>
+
+namespace playback {
+// Friend of ScaleSnapProcessor: the per-note primitives the note-on path called
+// on every attack before the harmonic snapshot.
+struct ScaleSnapProcessorTestAccess {
+    using Snapshot = ScaleSnapProcessor::HarmonicSnapshot;
+    static PitchClassSet keyTones(const ScaleSnapProcessor& p) { return p.computeKeyScaleTones(); }
+    static QStringView scaleKeyForChord(const ScaleSnapProcessor& p, const music::ChordSymbol& c) {
+        return p.scaleKeyForChord(c);
+    }
+    static int harmonyForVoice(const ScaleSnapProcessor& p, int voice, int note, const Snapshot& ctx) {
+        return p.generateHarmonyForVoice(voice, note, ctx);
+    }
+};
+} // namespace playback
+
+namespace {
+
+using playback::PitchClassSet;
+using playback::ScaleSnapProcessor;
+using playback::ScaleSnapProcessorTestAccess;
+using playback::VoiceMotionType;
+
+static int g_failures = 0;
+
+static void expect(bool cond, const QString& msg) {
+    if (!cond) {
+        ++g_failures;
+        qWarning().noquote() << "FAIL:" << msg;
+    }
+}
+
+static std::set<int> toSet(const PitchClassSet& s) { return std::set<int>(s.begin(), s.end()); }
+
+static PitchClassSet fromSet(const std::set<int>& s) {
+    PitchClassSet out;
+    for (int pc : s) out.insert(pc);
+    return out;
+}
+
+static int pcOf(int v) { return ((v % 12) + 12) % 12; }
+
+// Chord tones as computeChordTones() derived them, straight from the ontology.
+static std::set<int> chordTonesFor(const playback::HarmonyContext& harmony, const music::ChordSymbol& chord) {
+    std::set<int> out;
+    if (chord.rootPc < 0) return out;
+    out.insert(pcOf(chord.rootPc));
+    if (const auto* def = harmony.chordDefForSymbol(chord)) {
+        for (int iv : def->intervals) out.insert(pcOf(chord.rootPc + iv));
+    }
+    return out;
+}
+
+// The former per-attack computeValidPitchClasses(), on std::set.
+static std::set<int> referenceValidPcs(const ScaleSnapProcessor& snap, const playback::HarmonyContext& harmony,
+                                       const virtuoso::ontology::OntologyRegistry& ont,
+                                       const music::ChordSymbol& chord, bool defaultChordPath) {
+    std::set<int> valid = chordTonesFor(harmony, chord);
+    if (defaultChordPath) {
+        if (const auto* sd = ont.scale(ScaleSnapProcessorTestAccess::scaleKeyForChord(snap, chord))) {
+            for (int iv : sd->intervals) valid.insert(pcOf(chord.rootPc + iv));
+        }
+        return valid;
+    }
+    const std::set<int> tones = valid;
+    for (int pc : ScaleSnapProcessorTestAccess::keyTones(snap)) valid.insert(pc);
+    const int root = chord.rootPc;
+    if (tones.count(pcOf(root + 4)) && !tones.count(pcOf(root + 3)) && !tones.count(pcOf(root + 5))) {
+        valid.erase(pcOf(root + 5)); // natural 4th over a major 3rd
+    }
+    return valid;
+}
+
+// The former per-attack snapToNearestValidPc(), on std::set.
+static int referenceNearestPc(int pc, const std::set<int>& valid) {
+    if (valid.empty() || valid.count(pc)) return pc;
+    int best = pc;
+    int bestDist = 12;
+    for (int v : valid) {
+        int d = std::abs(v - pc);
+        if (d > 6) d = 12 - d;
+        if (d < bestDist || (d == bestDist && v < best)) {
+            bestDist = d;
+            best = v;
+        }
+    }
+    return best;
+}
+
+static void configureVoices(ScaleSnapProcessor& snap) {
+    const VoiceMotionType types[4] = {VoiceMotionType::PARALLEL_FIXED, VoiceMotionType::DRONE,
+                                      VoiceMotionType::SCALE_PARALLEL, VoiceMotionType::PARALLEL};
+    for (int v = 0; v < 4; ++v) {
+        playback::HarmonyVoiceConfig c;
+        c.motionType = types[v];
+        c.rangeMin = 40;
+        c.rangeMax = 88;
+        c.parallelInterval = 4;
+        c.droneOctave = 2;
+        c.scaleStepOffset = -2;
+        snap.setVoiceConfig(v, c);
+    }
+}
+
+// Compares the published snapshot with the per-note computation for `chord`.
+static void checkSnapshot(const ScaleSnapProcessor& snap, const playback::HarmonyContext& harmony,
+                          const virtuoso::ontology::OntologyRegistry& ont, const music::ChordSymbol& chord,
+                          bool defaultChordPath, const QString& label) {
+    const auto s = snap.harmonicSnapshot();
+    expect(s != nullptr, label + ": snapshot published");
+    if (!s) return;
+    expect(s->hasChord && s->chord.rootPc == chord.rootPc && s->chord.quality == chord.quality &&
+               s->chord.seventh == chord.seventh,
+           label + ": snapshot carries the resolved chord");
+
+    const std::set<int> valid = referenceValidPcs(snap, harmony, ont, chord, defaultChordPath);
+    expect(toSet(s->validPcs) == valid, label + ": validPcs match the per-note computation");
+    expect(toSet(s->chordTones) == chordTonesFor(harmony, chord), label + ": chord tones match");
+
+    int nearestMismatches = 0;
+    for (int pc = 0; pc < 12; ++pc) {
+        if (s->nearestValidPc[pc] != referenceNearestPc(pc, valid)) ++nearestMismatches;
+    }
+    expect(nearestMismatches == 0, label + QString(": nearest-valid-pc table (%1 differ)").arg(nearestMismatches));
+
+    // Per-attack inputs, derived from the chord alone (not from the snapshot).
+    ScaleSnapProcessorTestAccess::Snapshot perNote;
+    perNote.hasChord = true;
+    perNote.chord = chord;
+    perNote.chordTones = fromSet(chordTonesFor(harmony, chord));
+    perNote.validPcs = fromSet(valid);
+    int slotMismatches = 0;
+    for (int v = 0; v < 4; ++v) {
+        const bool stateless = v < 3;
+        expect(s->voiceTabled[v] == stateless, label + QString(": voice %1 tabled iff stateless").arg(v));
+        if (!s->voiceTabled[v]) continue;
+        for (int note = 0; note < 128; ++note) {
+            if (s->voiceNotes[v][note] != ScaleSnapProcessorTestAccess::harmonyForVoice(snap, v, note, perNote)) {
+                ++slotMismatches;
+            }
+        }
+    }
+    expect(slotMismatches == 0, label + QString(": per-voice slot tables (%1 differ)").arg(slotMismatches));
+}
+
+static void testDefaultChordSnapshotMatchesPerNote() {
+    const auto ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+    ScaleSnapProcessor snap;
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    configureVoices(snap);
+
+    for (const char* text : {"Bbmaj7", "Dm7", "Dm", "G7", "F#m7b5", "Bdim7", "Caug", "Esus4", "A7b9", "C6"}) {
+        music::ChordSymbol chord;
+        music::parseChordSymbol(text, chord);
+        snap.setDefaultHarmonyChord(chord);
+        checkSnapshot(snap, harmony, ont, chord, true, QString("default %1").arg(text));
+    }
+
+    snap.setDefaultHarmonyChord(music::ChordSymbol{});
+    const auto none = snap.harmonicSnapshot();
+    expect(none && !none->hasChord && none->validPcs.isEmpty(), "default: cleared chord publishes an empty snapshot");
+}
+
+static void testChartSnapshotFollowsCells() {
+    const auto ont = virtuoso::ontology::OntologyRegistry::builtins();
+    playback::HarmonyContext harmony;
+    harmony.setOntology(&ont);
+
+    chart::ChartModel model;
+    chart::Line line;
+    for (const char* first : {"Cmaj7", "A7", "Dm7", "G7"}) {
+        chart::Bar bar;
+        bar.cells.resize(4);
+        bar.cells[0].chord = first;
+        line.bars.push_back(bar);
+    }
+    model.lines.push_back(line);
+    model.timeSigNum = 4;
+    model.timeSigDen = 4;
+    harmony.rebuildFromModel(model);
+
+    ScaleSnapProcessor snap;
+    snap.setHarmonyContext(&harmony);
+    snap.setOntology(&ont);
+    snap.setChartModel(&model);
+    configureVoices(snap);
+
+    // Not playing: the first chord of the chart.
+    music::ChordSymbol expected;
+    music::parseChordSymbol("Cmaj7", expected);
+    checkSnapshot(snap, harmony, ont, expected, false, "chart idle");
+
+    // Each cell resolves to its own chord, or carries the last one over empty cells.
+    const char* byCell[16] = {"Cmaj7", "Cmaj7", "Cmaj7", "Cmaj7", "A7", "A7", "A7", "A7",
+                              "Dm7", "Dm7", "Dm7", "Dm7", "G7", "G7", "G7", "G7"};
+    for (int cell = 0; cell < 16; ++cell) {
+        snap.setCurrentCellIndex(cell);
+        music::parseChordSymbol(byCell[cell], expected);
+        checkSnapshot(snap, harmony, ont, expected, false, QString("chart cell %1").arg(cell));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    testDefaultChordSnapshotMatchesPerNote();
+    testChartSnapshotFollowsCells();
+    if (g_failures > 0) {
+        qWarning() << "ScaleSnapProcessorTests failures:" << g_failures;
+        return 1;
+    }
+    qInfo() << "ScaleSnapProcessorTests OK";
+    return 0;
+}
@@ -11,19 +11,42 @@
 #include "playback/AutoWeightController.h"
 #include "playback/WeightNegotiator.h"
 #include "playback/StoryState.h"
+#include "playback/PrePlaybackCache.h"
+#include "playback/LookaheadWindow.h"
+#include "playback/KeyAnalyzer.h"
+#include "playback/ChordScaleTable.h"
+#include "playback/PrePlaybackCacheStore.h"
+#include "playback/JointCandidateModel.h"
+#include "playback/ChordOntology.h"
+#include "playback/PitchConformanceEngine.h"
+#include "playback/NoteSlotTable.h"
 
 #include "music/ChordSymbol.h"
 #include "virtuoso/ontology/OntologyRegistry.h"
 #include "virtuoso/memory/MotifTransform.h"
 #include "virtuoso/engine/VirtuosoEngine.h"
+#include "virtuoso/groove/GrooveRegistry.h"
+#include "virtuoso/util/RegistryBundle.h"
+#include "virtuoso/util/StableHash.h"
+#include "virtuoso/vocab/VocabularyRegistry.h"
 
 #include <QCoreApplication>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QElapsedTimer>
 #include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
 #include <QtGlobal>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <set>
+#include <thread>
+#include <type_traits>
+
 namespace {
 
 static int g_failures = 0;
@@ -617,6 +640,1301 @@ static void testVocabularyModularMatching() {
     expect(hits.size() == 0, "Modular matching: bar 0 beat 0 has no hits");
 }
 
+// Friend of VocabularyRegistry: exposes the loaded pattern lists so the test can run the
+// former linear-scan selection against the indexed one.
+namespace virtuoso::vocab {
+struct VocabularyRegistryTestAccess {
+    static const auto& piano(const VocabularyRegistry& v) { return v.m_piano; }
+    static const auto& bass(const VocabularyRegistry& v) { return v.m_bass; }
+    static const auto& drums(const VocabularyRegistry& v) { return v.m_drums; }
+    static const auto& pianoPhrases(const VocabularyRegistry& v) { return v.m_pianoPhrases; }
+    static const auto& pianoTopLines(const VocabularyRegistry& v) { return v.m_pianoTopLines; }
+    static const auto& pianoPedals(const VocabularyRegistry& v) { return v.m_pianoPedals; }
+    static const auto& bassPhrases(const VocabularyRegistry& v) { return v.m_bassPhrases; }
+    static const auto& drumsPhrases(const VocabularyRegistry& v) { return v.m_drumsPhrases; }
+};
+} // namespace virtuoso::vocab
+
+namespace {
+
+// Former VocabularyRegistry::chooseWeighted over already-filtered candidates.
+template <typename TPattern>
+static QString linearWeightedPickId(const QVector<const TPattern*>& cands, quint32 pickHash) {
+    if (cands.isEmpty()) return {};
+    double sum = 0.0;
+    for (const auto* p : cands) sum += (p->weight > 0.0 ? p->weight : 0.0);
+    if (sum <= 0.0) return {};
+    const double u = double((pickHash >> 8) & 0x00FF'FFFFu) / double(0x0100'0000u);
+    const double r = u * sum;
+    double acc = 0.0;
+    for (const auto* p : cands) {
+        acc += (p->weight > 0.0 ? p->weight : 0.0);
+        if (r <= acc) return p->id;
+    }
+    return cands.last()->id;
+}
+
+static bool linearEnergyMatches(double e, double minE, double maxE) {
+    if (minE > maxE) std::swap(minE, maxE);
+    return e >= minE && e <= maxE;
+}
+
+static bool linearFunctionMatches(const QVector<QString>& allowed, const QString& func) {
+    if (allowed.isEmpty()) return true;
+    const QString f = func.trimmed();
+    if (f.isEmpty()) return true;
+    for (const auto& a : allowed) {
+        if (a.trimmed().compare(f, Qt::CaseInsensitive) == 0) return true;
+    }
+    return false;
+}
+
+static quint32 linearHash(const QString& s) { return virtuoso::util::StableHash::fnv1a32(s.toUtf8()); }
+
+// Runs a grid of queries through every indexed choose*() and the former linear scans.
+static void checkVocabularyIndexAgainstLinearScan(const virtuoso::vocab::VocabularyRegistry& vocab, const QString& label) {
+    using namespace virtuoso::vocab;
+    using TA = VocabularyRegistryTestAccess;
+
+    QVector<double> energies = {-0.5, 0.0, 0.1, 0.15, 0.2, 0.25, 0.2999, 0.3, 0.3001, 0.45, 0.5, 0.55, 0.7, 0.85, 0.9, 1.0, 1.5};
+    auto addEndpoints = [&](const auto& patterns) {
+        for (const auto& p : patterns) energies << p.minEnergy << p.maxEnergy;
+    };
+    addEndpoints(TA::piano(vocab));
+    addEndpoints(TA::bass(vocab));
+    addEndpoints(TA::pianoPhrases(vocab));
+    const QStringList functions = {"", "Dominant", " dominant ", "TONIC", "Subdominant", "Weird"};
+    const QStringList chords = {"Cmaj7", "F#m7b5"};
+
+    int cases = 0;
+    int mismatches = 0;
+    auto check = [&](const QString& got, const QString& want, const QString& what) {
+        ++cases;
+        if (got != want && mismatches++ < 5) {
+            qWarning().noquote() << QString("%1: %2 index '%3' vs linear '%4'").arg(label, what, got, want);
+        }
+    };
+
+    for (const double energy : energies) {
+        const double e = qBound(0.0, energy, 1.0);
+        for (int bar = 0; bar < 9; bar += 4) {
+            for (const QString& chord : chords) {
+                for (int flags = 0; flags < 8; ++flags) {
+                    const bool a = flags & 1;
+                    const bool b = flags & 2;
+                    const bool c = flags & 4;
+                    for (int beat = -1; beat < 6; ++beat) {
+                        const int cb = qMax(0, beat);
+                        for (const QString& fn : functions) {
+                            VocabularyRegistry::PianoBeatQuery q;
+                            q.playbackBarIndex = bar;
+                            q.beatInBar = beat;
+                            q.chordText = chord;
+                            q.chordFunction = fn;
+                            q.chordIsNew = a;
+                            q.userSilence = b;
+                            q.energy = energy;
+                            q.determinismSeed = c ? 7u : 1u;
+                            QVector<const std::decay_t<decltype(TA::piano(vocab).first())>*> cands;
+                            for (const auto& p : TA::piano(vocab)) {
+                                if (!p.beats.contains(cb) || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                                if ((p.chordIsNewOnly && !a) || (p.stableOnly && a) || (!p.allowWhenUserSilence && b)) continue;
+                                if (!linearFunctionMatches(p.chordFunctions, fn)) continue;
+                                cands.push_back(&p);
+                            }
+                            const quint32 h = linearHash(QString("%1|piano|%2|%3|%4|%5|%6")
+                                                             .arg(chord).arg(bar).arg(cb).arg(int(a)).arg(fn).arg(q.determinismSeed));
+                            check(vocab.choosePianoBeat(q).id, linearWeightedPickId(cands, h), "piano beat");
+                        }
+
+                        VocabularyRegistry::BassBeatQuery bq;
+                        bq.playbackBarIndex = bar;
+                        bq.beatInBar = beat;
+                        bq.chordText = chord;
+                        bq.chordIsNew = a;
+                        bq.hasNextChord = b;
+                        bq.nextChanges = b || c;
+                        bq.userDenseOrPeak = c;
+                        bq.energy = energy;
+                        QVector<const std::decay_t<decltype(TA::bass(vocab).first())>*> bassCands;
+                        for (const auto& p : TA::bass(vocab)) {
+                            if (!p.beats.contains(cb) || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                            if ((p.chordIsNewOnly && !a) || (p.stableOnly && a)) continue;
+                            if (p.nextChangesOnly && !(bq.hasNextChord && bq.nextChanges)) continue;
+                            if (p.forbidWhenUserDenseOrPeak && c) continue;
+                            bassCands.push_back(&p);
+                        }
+                        const quint32 bh = linearHash(QString("%1|bass|%2|%3|%4|%5|%6|%7")
+                                                          .arg(chord).arg(bar).arg(cb).arg(int(a))
+                                                          .arg(int(bq.hasNextChord)).arg(int(bq.nextChanges)).arg(1u));
+                        check(vocab.chooseBassBeat(bq).id, linearWeightedPickId(bassCands, bh), "bass beat");
+
+                        VocabularyRegistry::DrumsBeatQuery dq;
+                        dq.playbackBarIndex = bar;
+                        dq.beatInBar = beat;
+                        dq.intensityPeak = a;
+                        dq.energy = energy;
+                        dq.determinismSeed = b ? 3u : 1u;
+                        QVector<const std::decay_t<decltype(TA::drums(vocab).first())>*> drumCands;
+                        for (const auto& p : TA::drums(vocab)) {
+                            if (!p.beats.contains(cb) || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                            if (p.intensityPeakOnly && !a) continue;
+                            drumCands.push_back(&p);
+                        }
+                        const quint32 dh = linearHash(QString("drums|%1|%2|%3|%4").arg(bar).arg(cb).arg(int(a)).arg(dq.determinismSeed));
+                        check(vocab.chooseDrumsBeat(dq).id, linearWeightedPickId(drumCands, dh), "drums beat");
+                    }
+
+                    // 20 is past the indexed phrase lengths (scan fallback).
+                    for (const int phraseBars : {0, 1, 2, 3, 4, 6, 8, 12, 16, 20}) {
+                        const int pb = qMax(1, phraseBars);
+                        for (const QString& fn : functions) {
+                            VocabularyRegistry::PianoPhraseQuery q;
+                            q.playbackBarIndex = bar;
+                            q.chordText = chord;
+                            q.chordFunction = fn;
+                            q.chordIsNew = a;
+                            q.userSilence = b;
+                            q.energy = energy;
+                            q.determinismSeed = c ? 7u : 1u;
+                            q.phraseBars = phraseBars;
+                            QVector<const std::decay_t<decltype(TA::pianoPhrases(vocab).first())>*> cands;
+                            for (const auto& p : TA::pianoPhrases(vocab)) {
+                                if (pb % qMax(1, p.phraseBars) != 0 || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                                if (!p.allowWhenUserSilence && b) continue;
+                                if (!linearFunctionMatches(p.chordFunctions, fn)) continue;
+                                cands.push_back(&p);
+                            }
+                            const int sub = cands.isEmpty() ? pb : qMax(1, cands.first()->phraseBars);
+                            const quint32 h = linearHash(QString("%1|piano_phrase|%2|%3|%4|%5")
+                                                             .arg(chord).arg(bar / sub).arg(int(a)).arg(fn).arg(q.determinismSeed));
+                            check(vocab.choosePianoPhrase(q).id, linearWeightedPickId(cands, h), "piano phrase");
+
+                            VocabularyRegistry::PianoTopLineQuery tq;
+                            tq.playbackBarIndex = bar;
+                            tq.chordText = chord;
+                            tq.chordFunction = fn;
+                            tq.chordIsNew = a;
+                            tq.userSilence = b;
+                            tq.energy = energy;
+                            tq.phraseBars = phraseBars;
+                            QVector<const std::decay_t<decltype(TA::pianoTopLines(vocab).first())>*> topCands;
+                            for (const auto& p : TA::pianoTopLines(vocab)) {
+                                if (p.phraseBars != pb || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                                if (!p.allowWhenUserSilence && b) continue;
+                                if (!linearFunctionMatches(p.chordFunctions, fn)) continue;
+                                topCands.push_back(&p);
+                            }
+                            const quint32 th = linearHash(QString("%1|piano_topline|%2|%3|%4|%5|%6")
+                                                              .arg(chord).arg(bar / pb).arg(int(a)).arg(fn)
+                                                              .arg(int(llround(tq.rhythmicComplexity * 100.0))).arg(1u));
+                            check(vocab.choosePianoTopLine(tq).id, linearWeightedPickId(topCands, th), "piano top line");
+                        }
+
+                        VocabularyRegistry::BassPhraseQuery bq;
+                        bq.playbackBarIndex = bar;
+                        bq.chordText = chord;
+                        bq.chordIsNew = a;
+                        bq.nextChanges = b;
+                        bq.userDenseOrPeak = c;
+                        bq.energy = energy;
+                        bq.phraseBars = phraseBars;
+                        QVector<const std::decay_t<decltype(TA::bassPhrases(vocab).first())>*> bassCands;
+                        for (const auto& p : TA::bassPhrases(vocab)) {
+                            if (pb % qMax(1, p.phraseBars) != 0 || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                            if (p.forbidWhenUserDenseOrPeak && c) continue;
+                            bassCands.push_back(&p);
+                        }
+                        const int bassSub = bassCands.isEmpty() ? pb : qMax(1, bassCands.first()->phraseBars);
+                        const quint32 bh = linearHash(QString("%1|bass_phrase|%2|%3|%4|%5")
+                                                          .arg(chord).arg(bar / bassSub).arg(int(a)).arg(int(b)).arg(1u));
+                        check(vocab.chooseBassPhrase(bq).id, linearWeightedPickId(bassCands, bh), "bass phrase");
+
+                        VocabularyRegistry::DrumsPhraseQuery dq;
+                        dq.playbackBarIndex = bar;
+                        dq.intensityPeak = a;
+                        dq.energy = energy;
+                        dq.phraseBars = phraseBars;
+                        QVector<const std::decay_t<decltype(TA::drumsPhrases(vocab).first())>*> drumCands;
+                        for (const auto& p : TA::drumsPhrases(vocab)) {
+                            if (pb % qMax(1, p.phraseBars) != 0 || !linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                            if (p.intensityPeakOnly && !a) continue;
+                            drumCands.push_back(&p);
+                        }
+                        const int drumSub = drumCands.isEmpty() ? pb : qMax(1, drumCands.first()->phraseBars);
+                        const quint32 dh = linearHash(QString("drums_phrase|%1|%2|%3").arg(bar / drumSub).arg(int(a)).arg(1u));
+                        check(vocab.chooseDrumsPhrase(dq).id, linearWeightedPickId(drumCands, dh), "drums phrase");
+                    }
+
+                    VocabularyRegistry::PianoPedalQuery pq;
+                    pq.playbackBarIndex = bar;
+                    pq.chordText = chord;
+                    pq.chordIsNew = a;
+                    pq.nextChanges = b;
+                    pq.userSilence = c;
+                    pq.beatsUntilChordChange = bar % 3;
+                    pq.energy = energy;
+                    QVector<const std::decay_t<decltype(TA::pianoPedals(vocab).first())>*> pedalCands;
+                    for (const auto& p : TA::pianoPedals(vocab)) {
+                        if (!linearEnergyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                        if (!p.allowWhenUserSilence && c) continue;
+                        pedalCands.push_back(&p);
+                    }
+                    const quint32 ph = linearHash(QString("%1|piano_pedal|%2|%3|%4|%5|%6")
+                                                      .arg(chord).arg(bar).arg(int(a)).arg(int(b)).arg(bar % 3).arg(1u));
+                    check(vocab.choosePianoPedal(pq).id, linearWeightedPickId(pedalCands, ph), "piano pedal");
+                }
+            }
+        }
+    }
+    expect(cases > 0, label + ": queried");
+    expect(mismatches == 0, QString("%1: indexed choices match the linear scan (%2 of %3 differ)")
+                                .arg(label).arg(mismatches).arg(cases));
+}
+
+} // namespace
+
+static void testVocabularyIndexMatchesLinearScan() {
+    using namespace virtuoso::vocab;
+
+    // Edge cases the index has to reproduce: reversed and shared energy endpoints, zero
+    // weights, function names differing in case, beats past 3, odd phrase lengths, patterns
+    // only some queries can reach.
+    const QByteArray js = QByteArray(R"JSON({
+        "piano": [
+            { "id": "P_ALL", "beats": [0,1,2,3], "weight": 1.0, "hits": [ { "sub": 0 } ] },
+            { "id": "P_NEW", "beats": [0,2], "minEnergy": 0.3, "maxEnergy": 0.3, "chordIsNewOnly": true, "weight": 2.5, "hits": [ { "sub": 1 } ] },
+            { "id": "P_STABLE_DOM", "beats": [1,3,5], "minEnergy": 0.85, "maxEnergy": 0.15, "stableOnly": true, "functions": ["Dominant"], "hits": [ { "sub": 2 } ] },
+            { "id": "P_ZERO", "beats": [1], "weight": 0.0, "hits": [ { "sub": 0 } ] },
+            { "id": "P_TONIC_LOUD", "beats": [0,1], "minEnergy": 0.5, "allowWhenUserSilence": false, "functions": ["tonic", "DOMINANT"], "weight": 0.5, "hits": [ { "sub": 0 } ] }
+        ],
+        "bass": [
+            { "id": "B_ROOT", "beats": [0,2], "action": "root" },
+            { "id": "B_APPROACH", "beats": [3], "action": "approach_to_next", "nextChangesOnly": true, "weight": 3 },
+            { "id": "B_FIFTH", "beats": [1,2,3], "action": "fifth", "minEnergy": 0.25, "maxEnergy": 0.7, "forbidWhenUserDenseOrPeak": true },
+            { "id": "B_NEW", "beats": [0], "action": "third", "chordIsNewOnly": true, "weight": 0.2 }
+        ],
+        "drums": [
+            { "id": "D_RIDE", "beats": [0,1,2,3], "hits": [ { "articulation": "ride_hit" } ] },
+            { "id": "D_PEAK", "beats": [1,3], "intensityPeakOnly": true, "minEnergy": 0.45, "weight": 4, "hits": [ { "articulation": "ride_bell" } ] }
+        ],
+        "piano_phrases": [
+            { "id": "PP_2", "phraseBars": 2, "maxEnergy": 0.55, "hits": [ { "bar": 0, "beat": 0 } ] },
+            { "id": "PP_4", "phraseBars": 4, "functions": ["Dominant"], "weight": 2, "hits": [ { "bar": 1, "beat": 2 } ] },
+            { "id": "PP_3", "phraseBars": 3, "minEnergy": 0.2, "allowWhenUserSilence": false, "hits": [ { "bar": 2, "beat": 1 } ] },
+            { "id": "PP_8", "phraseBars": 8, "minEnergy": 0.5, "hits": [ { "bar": 7, "beat": 3 } ] }
+        ],
+        "piano_topline": [
+            { "id": "T_4", "phraseBars": 4, "functions": ["Tonic"], "hits": [ { "bar": 0, "beat": 0 } ] },
+            { "id": "T_4B", "phraseBars": 4, "minEnergy": 0.3, "weight": 3, "hits": [ { "bar": 1, "beat": 0 } ] },
+            { "id": "T_20", "phraseBars": 20, "hits": [ { "bar": 0, "beat": 0 } ] }
+        ],
+        "piano_pedals": [
+            { "id": "PED_HALF", "defaultState": "half" },
+            { "id": "PED_DOWN", "defaultState": "down", "maxEnergy": 0.4, "allowWhenUserSilence": false, "weight": 2 }
+        ],
+        "bass_phrases": [
+            { "id": "BP_4", "phraseBars": 4, "hits": [ { "bar": 0, "beat": 0, "action": "root" } ] },
+            { "id": "BP_2", "phraseBars": 2, "forbidWhenUserDenseOrPeak": true, "minEnergy": 0.35, "hits": [ { "bar": 0, "beat": 0, "action": "fifth" } ] }
+        ],
+        "drums_phrases": [
+            { "id": "DP_4", "phraseBars": 4, "hits": [ { "bar": 0, "beat": 0 } ] },
+            { "id": "DP_5", "phraseBars": 5, "intensityPeakOnly": true, "hits": [ { "bar": 0, "beat": 0 } ] }
+        ]
+    })JSON");
+    VocabularyRegistry vocab;
+    QString err;
+    const bool ok = vocab.loadFromJsonBytes(js, &err);
+    expect(ok, "Vocab index: load synthetic vocab JSON");
+    if (ok) checkVocabularyIndexAgainstLinearScan(vocab, "Vocab index (synthetic)");
+
+    QFile f("../virtuoso/vocab/cool_jazz_vocabulary.json");
+    if (!f.open(QIODevice::ReadOnly)) return; // not an error if running in a different directory
+    VocabularyRegistry real;
+    expect(real.loadFromJsonBytes(f.readAll(), &err), "Vocab index: real vocab parses");
+    if (real.isLoaded()) checkVocabularyIndexAgainstLinearScan(real, "Vocab index (real)");
+}
+
+// Friend of PrePlaybackBuilder: exposes Phase 1 (context building) directly.
+namespace playback {
+struct PrePlaybackBuilderTestAccess {
+    static QVector<PreComputedContext> buildContexts(const PrePlaybackBuilder::Inputs& in) {
+        return PrePlaybackBuilder::buildContexts(in, nullptr);
+    }
+};
+} // namespace playback
+
+namespace {
+
+// The pre-parallel Phase 1: one buildLookaheadWindow() per step on a mutable HarmonyContext.
+static QVector<playback::PreComputedContext> referenceContexts(const chart::ChartModel& model,
+                                                               const QVector<int>& seq,
+                                                               int repeats,
+                                                               int phraseBars,
+                                                               const virtuoso::ontology::OntologyRegistry& ont,
+                                                               playback::HarmonyContext& harmony) {
+    using namespace playback;
+    QVector<PreComputedContext> out;
+    const int beatsPerBar = qMax(1, model.timeSigNum);
+    const int totalSteps = seq.size() * qMax(1, repeats);
+    const QVector<KeyRegion> keyRegions = KeyAnalyzer(ont).analyze(model);
+    for (int stepIndex = 0; stepIndex < totalSteps; ++stepIndex) {
+        PreComputedContext ctx;
+        ctx.stepIndex = stepIndex;
+        ctx.barIndex = stepIndex / beatsPerBar;
+        ctx.beatInBar = stepIndex % beatsPerBar;
+        const auto look = buildLookaheadWindow(model, seq, repeats, stepIndex, 8, phraseBars, 8, harmony);
+        ctx.haveChord = look.haveCurrentChord && !look.currentChord.noChord;
+        ctx.chord = look.currentChord;
+        ctx.chordText = look.currentChord.originalText.trimmed();
+        ctx.chordIsNew = look.chordIsNew;
+        ctx.haveNextChord = look.haveNextChord;
+        ctx.nextChord = look.nextChord;
+        ctx.nextChanges = look.nextChanges;
+        ctx.beatsUntilChange = look.beatsUntilChange;
+        ctx.phraseBars = look.phraseBars;
+        ctx.barInPhrase = look.barInPhrase;
+        ctx.phraseEndBar = look.phraseEndBar;
+        ctx.cadence01 = look.cadence01;
+        const KeyRegion keyRegion = KeyAnalyzer::keyAtBar(keyRegions, ctx.barIndex % (seq.size() / beatsPerBar));
+        ctx.keyTonicPc = keyRegion.tonicPc;
+        ctx.keyMode = keyRegion.mode;
+        ctx.scaleKey = look.key.scaleKey;
+        ctx.scaleName = look.key.scaleName;
+        if (ctx.haveChord) {
+            ctx.chordDef = harmony.chordDefForSymbol(ctx.chord);
+            if (ctx.chordDef && ctx.chord.rootPc >= 0) {
+                const auto* cached = ChordScaleTable::lookup(*ctx.chordDef, ctx.chord.rootPc, ctx.keyTonicPc, ctx.keyMode);
+                if (cached) {
+                    ctx.scaleKey = cached->scaleKey;
+                    ctx.scaleName = cached->scaleName;
+                    ctx.roman = cached->roman;
+                    ctx.chordFunction = cached->function;
+                } else {
+                    QString roman;
+                    QString func;
+                    const auto sc = harmony.chooseScaleForChord(ctx.keyTonicPc, ctx.keyMode, ctx.chord, *ctx.chordDef, &roman, &func);
+                    ctx.scaleKey = sc.key;
+                    ctx.scaleName = sc.name;
+                    ctx.roman = roman;
+                    ctx.chordFunction = func;
+                }
+            }
+        }
+        out.push_back(ctx);
+    }
+    return out;
+}
+
+} // namespace
+
+static void testPrePlaybackContextsMatchSerialLookahead() {
+    using namespace playback;
+
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    ChordScaleTable::initialize(ont);
+
+    // Changes mid-bar, held (empty) cells, a placeholder, an unparseable cell and N.C.
+    chart::ChartModel model;
+    model.timeSigNum = 4;
+    model.timeSigDen = 4;
+    const QStringList cellsText = {"Dm7", "", "", "G7",    "Cmaj7", "", "x", "",
+                                   "Em7b5", "", "A7b9", "", "N.C.", "", "??", "",
+                                   "Fmaj7", "", "Bb7", "", "Ebmaj7", "", "Ab7", "",
+                                   "Dm7", "", "G7alt", "", "Cmaj7", "", "", ""};
+    chart::Line line;
+    for (int b = 0; b < cellsText.size() / 4; ++b) {
+        chart::Bar bar;
+        bar.cells.resize(4);
+        for (int c = 0; c < 4; ++c) bar.cells[c].chord = cellsText[b * 4 + c];
+        line.bars.push_back(bar);
+    }
+    model.lines.push_back(line);
+
+    // Starts on a held cell so the pre-build carry-over chord matters.
+    QVector<int> sequence;
+    for (int i = 1; i < cellsText.size(); ++i) sequence << i;
+    sequence << 0;
+
+    const int repeats = 2;
+    const int bpm = 60; // 8-bar phrases
+    for (bool primeLastChord : {false, true}) {
+        HarmonyContext harmony;
+        harmony.setOntology(&ont);
+        harmony.rebuildFromModel(model);
+        HarmonyContext refHarmony = harmony;
+        if (primeLastChord) {
+            music::ChordSymbol tmp;
+            bool isNew = false;
+            harmony.chordForCellIndex(model, 4, tmp, isNew);
+            refHarmony.chordForCellIndex(model, 4, tmp, isNew);
+        }
+        const auto before = harmony.saveRuntimeState();
+
+        PrePlaybackBuilder::Inputs in;
+        in.model = &model;
+        in.sequence = &sequence;
+        in.repeats = repeats;
+        in.bpm = bpm;
+        in.harmony = &harmony;
+        in.ontology = const_cast<virtuoso::ontology::OntologyRegistry*>(&ont);
+        const auto got = PrePlaybackBuilderTestAccess::buildContexts(in);
+        const auto want = referenceContexts(model, sequence, repeats, /*phraseBars=*/8, ont, refHarmony);
+
+        const QString tag = primeLastChord ? "PrePlayback contexts (primed)" : "PrePlayback contexts";
+        expect(got.size() == want.size(), tag + ": step count");
+        int mismatches = 0;
+        for (int i = 0; i < qMin(got.size(), want.size()); ++i) {
+            const auto& a = got[i];
+            const auto& b = want[i];
+            const bool same = a.stepIndex == b.stepIndex && a.barIndex == b.barIndex && a.beatInBar == b.beatInBar &&
+                              a.haveChord == b.haveChord && music::sameChordSymbol(a.chord, b.chord) &&
+                              a.chordText == b.chordText && a.chordIsNew == b.chordIsNew &&
+                              a.haveNextChord == b.haveNextChord && music::sameChordSymbol(a.nextChord, b.nextChord) &&
+                              a.nextChanges == b.nextChanges && a.beatsUntilChange == b.beatsUntilChange &&
+                              a.keyTonicPc == b.keyTonicPc && a.keyMode == b.keyMode && a.scaleKey == b.scaleKey &&
+                              a.scaleName == b.scaleName && a.roman == b.roman && a.chordFunction == b.chordFunction &&
+                              a.phraseBars == b.phraseBars && a.barInPhrase == b.barInPhrase &&
+                              a.phraseEndBar == b.phraseEndBar && a.cadence01 == b.cadence01 && a.chordDef == b.chordDef;
+            if (!same && mismatches++ < 3) expect(false, tag + QString(": step %1 differs from serial lookahead").arg(i));
+        }
+        expect(mismatches == 0, tag + QString(": %1 mismatching steps").arg(mismatches));
+
+        const auto after = harmony.saveRuntimeState();
+        expect(after.hasLastChord == before.hasLastChord && music::sameChordSymbol(after.lastChord, before.lastChord),
+               tag + ": HarmonyContext runtime state untouched");
+    }
+}
+
+static void testPrePlaybackCacheStoreRoundTrip() {
+    using namespace playback;
+
+    chart::ChartModel model;
+    chart::Line line;
+    chart::Bar bar;
+    bar.cells.resize(4);
+    bar.cells[0].chord = "Dm7";
+    bar.cells[2].chord = "G7";
+    line.bars.push_back(bar);
+    model.lines.push_back(line);
+    const QVector<int> sequence = {0, 1, 2, 3};
+
+    PrePlaybackBuilder::Inputs in;
+    in.model = &model;
+    in.sequence = &sequence;
+    in.bpm = 60;
+    in.stylePresetKey = "jazz_brushes_ballad_60_evans";
+    in.agentEnergyMult.insert("Piano", 0.8);
+    const auto key = PrePlaybackCacheStore::keyFor(in);
+
+    PrePlaybackCache cache;
+    cache.totalSteps = 4;
+    cache.totalBars = 1;
+    cache.buildTimeMs = 1234;
+    for (int e = 0; e < 2; ++e) {
+        QVector<PreComputedBeat> branch;
+        for (int step = 0; step < 4; ++step) {
+            PreComputedBeat b;
+            b.stepIndex = step;
+            b.beatInBar = step;
+            b.chordText = step < 2 ? "Dm7" : "G7";
+            b.chordDefKey = step < 2 ? "min7" : "dom7";
+            b.keyMode = virtuoso::theory::KeyMode::Minor;
+            b.chordIsNew = (step % 2) == 0;
+            virtuoso::engine::AgentIntentNote n;
+            n.agent = "Piano";
+            n.channel = 4;
+            n.note = 60 + step + e;
+            n.startPos.barIndex = 0;
+            n.startPos.withinBarWhole = virtuoso::groove::Rational(step, 4);
+            n.durationWhole = virtuoso::groove::Rational(3, 8);
+            n.logic_tag = QString::fromUtf8("RH:color \u00f8");
+            n.emotion01 = 0.25 * step;
+            b.pianoPlan.notes.push_back(n);
+            JazzBalladPianoPlanner::CcIntent cc;
+            cc.value = 127;
+            cc.structural = true;
+            b.pianoPlan.ccs.push_back(cc);
+            JazzBalladBassPlanner::KeySwitchIntent ks;
+            ks.midi = 24;
+            ks.logic_tag = "art";
+            b.bassPlan.keyswitches.push_back(ks);
+            if (e == 1) b.drumsNotes.push_back(n);
+            branch.push_back(b);
+        }
+        cache.energyBranches.push_back(branch);
+    }
+
+    const QByteArray bytes = PrePlaybackCacheStore::serialize(key, cache);
+    const auto* data = reinterpret_cast<const uchar*>(bytes.constData());
+    PrePlaybackCache got;
+    QString err;
+    expect(PrePlaybackCacheStore::deserialize(data, bytes.size(), key, &got, &err), "PrePlaybackCacheStore: round trip (" + err + ")");
+    expect(got.totalSteps == 4 && got.buildTimeMs == 1234 && got.energyBranches.size() == 2, "PrePlaybackCacheStore: metadata");
+    bool same = got.energyBranches.size() == cache.energyBranches.size();
+    for (int e = 0; same && e < cache.energyBranches.size(); ++e) {
+        same = got.energyBranches[e].size() == cache.energyBranches[e].size();
+        for (int i = 0; same && i < cache.energyBranches[e].size(); ++i) {
+            const auto& a = got.energyBranches[e][i];
+            const auto& b = cache.energyBranches[e][i];
+            same = a.stepIndex == b.stepIndex && a.chordText == b.chordText && a.chordDefKey == b.chordDefKey &&
+                   a.keyMode == b.keyMode && a.chordIsNew == b.chordIsNew && a.drumsNotes.size() == b.drumsNotes.size() &&
+                   a.pianoPlan.notes.size() == 1 && a.pianoPlan.ccs.size() == 1 && a.bassPlan.keyswitches.size() == 1;
+            if (!same) break;
+            const auto& na = a.pianoPlan.notes[0];
+            const auto& nb = b.pianoPlan.notes[0];
+            same = na.agent == nb.agent && na.note == nb.note && na.logic_tag == nb.logic_tag &&
+                   na.startPos.withinBarWhole.num == nb.startPos.withinBarWhole.num &&
+                   na.startPos.withinBarWhole.den == nb.startPos.withinBarWhole.den &&
+                   na.durationWhole.num == 3 && na.durationWhole.den == 8 && na.emotion01 == nb.emotion01 &&
+                   a.pianoPlan.ccs[0].value == 127 && a.pianoPlan.ccs[0].structural &&
+                   a.bassPlan.keyswitches[0].midi == 24 && a.bassPlan.keyswitches[0].logic_tag == "art";
+        }
+    }
+    expect(same, "PrePlaybackCacheStore: beats survive round trip");
+
+    // Any change to the inputs is a different key; a stale file must not load.
+    PrePlaybackBuilder::Inputs in2 = in;
+    in2.bpm = 61;
+    const auto key2 = PrePlaybackCacheStore::keyFor(in2);
+    expect(key2.identity != key.identity, "PrePlaybackCacheStore: bpm changes key");
+
+    // So does the chord HarmonyContext carries into the build.
+    HarmonyContext harmony;
+    PrePlaybackBuilder::Inputs in3 = in;
+    in3.harmony = &harmony;
+    expect(PrePlaybackCacheStore::keyFor(in3).identity == key.identity, "PrePlaybackCacheStore: reset harmony keeps key");
+    HarmonyContext::RuntimeState carried;
+    expect(music::parseChordSymbol("G7", carried.lastChord), "PrePlaybackCacheStore: parse carried chord");
+    carried.hasLastChord = true;
+    harmony.restoreRuntimeState(carried);
+    const auto key3 = PrePlaybackCacheStore::keyFor(in3);
+    expect(key3.identity != key.identity, "PrePlaybackCacheStore: prior chord changes key");
+    expect(music::parseChordSymbol("G7b9", carried.lastChord), "PrePlaybackCacheStore: parse altered chord");
+    harmony.restoreRuntimeState(carried);
+    expect(PrePlaybackCacheStore::keyFor(in3).identity != key3.identity, "PrePlaybackCacheStore: prior alteration changes key");
+    PrePlaybackCache untouched;
+    expect(!PrePlaybackCacheStore::deserialize(data, bytes.size(), key2, &untouched), "PrePlaybackCacheStore: key mismatch rejected");
+    expect(!untouched.isValid(), "PrePlaybackCacheStore: output untouched on mismatch");
+    expect(!PrePlaybackCacheStore::deserialize(data, bytes.size() - 8, key, &untouched), "PrePlaybackCacheStore: truncation rejected");
+
+    QTemporaryDir dir;
+    const QString path = PrePlaybackCacheStore::pathFor(dir.path(), key);
+    expect(PrePlaybackCacheStore::save(path, key, cache), "PrePlaybackCacheStore: save");
+    PrePlaybackCache loaded;
+    expect(PrePlaybackCacheStore::load(path, key, &loaded) && loaded.energyBranches.size() == 2,
+           "PrePlaybackCacheStore: load from disk");
+    expect(!PrePlaybackCacheStore::load(path, key2, &loaded), "PrePlaybackCacheStore: load with other key fails");
+}
+
+// Friend of ChordScaleTable: lets the bundle round trip reload the process-wide table.
+namespace playback {
+struct ChordScaleTableTestAccess {
+    static QVector<QString> chordKeys() {
+        const auto* t = ChordScaleTable::s_table.load();
+        return t ? t->chordKeys : QVector<QString>();
+    }
+    static QVector<ChordScaleEntry> entries() {
+        const auto* t = ChordScaleTable::s_table.load();
+        return t ? t->entries : QVector<ChordScaleEntry>();
+    }
+    // Only while no other thread is looking up.
+    static void reset() { delete ChordScaleTable::s_table.exchange(nullptr); }
+};
+} // namespace playback
+
+static void testRegistryBundleRoundTrip() {
+    using namespace playback;
+    using virtuoso::groove::GrooveRegistry;
+    using virtuoso::ontology::OntologyRegistry;
+    using virtuoso::util::BundleWriter;
+    using virtuoso::util::RegistryBundle;
+    using virtuoso::vocab::VocabularyRegistry;
+
+    const OntologyRegistry ont = OntologyRegistry::builtins();
+    const GrooveRegistry groove = GrooveRegistry::builtins();
+    VocabularyRegistry vocab;
+    QString err;
+    QFile f("../virtuoso/vocab/cool_jazz_vocabulary.json");
+    if (f.open(QIODevice::ReadOnly)) { // not an error if running in a different directory
+        expect(vocab.loadFromJsonBytes(f.readAll(), &err), "RegistryBundle: real vocab parses");
+    }
+    ChordScaleTable::initialize(ont);
+    const QVector<QString> computedKeys = ChordScaleTableTestAccess::chordKeys();
+    const QVector<ChordScaleEntry> computed = ChordScaleTableTestAccess::entries();
+
+    const auto compile = [](const OntologyRegistry& o, const GrooveRegistry& g, const VocabularyRegistry& v) {
+        BundleWriter w;
+        o.writeBundle(w);
+        g.writeBundle(w);
+        if (v.isLoaded()) v.writeBundle(w);
+        ChordScaleTable::writeBundle(w);
+        return w.finish();
+    };
+    const QByteArray bytes = compile(ont, groove, vocab);
+    const auto bundle = RegistryBundle::fromBytes(bytes, &err);
+    expect(bundle != nullptr, "RegistryBundle: opens (" + err + ")");
+    if (!bundle) return;
+
+    OntologyRegistry ont2;
+    GrooveRegistry groove2;
+    VocabularyRegistry vocab2;
+    expect(OntologyRegistry::fromBundle(*bundle, ont2), "RegistryBundle: ontology loads");
+    expect(GrooveRegistry::fromBundle(*bundle, groove2), "RegistryBundle: groove loads");
+    expect(ont2.allChords().size() == ont.allChords().size() && ont2.allVoicings().size() == ont.allVoicings().size(),
+           "RegistryBundle: ontology table sizes");
+    const auto* maj7 = ont2.chord("maj7");
+    expect(maj7 && maj7->intervals == QVector<int>({0, 4, 7, 11}) && maj7->order == ont.chord("maj7")->order,
+           "RegistryBundle: chord fields survive");
+    expect(maj7 && maj7->id == ont.chordId(u"maj7") && ont2.scaleId(u"dorian") == ont.scaleId(u"dorian"),
+           "RegistryBundle: dense ids survive");
+    QStringList presetsBefore;
+    QStringList presetsAfter;
+    for (const auto* p : groove.allStylePresets()) presetsBefore.push_back(p->key);
+    for (const auto* p : groove2.allStylePresets()) presetsAfter.push_back(p->key);
+    expect(presetsAfter == presetsBefore, "RegistryBundle: style preset order survives");
+    if (vocab.isLoaded()) {
+        expect(vocab2.loadFromBundle(*bundle, &err), "RegistryBundle: vocabulary loads (" + err + ")");
+        expect(vocab2.contentHash() == vocab.contentHash(), "RegistryBundle: vocabulary content hash survives");
+        if (vocab2.isLoaded()) checkVocabularyIndexAgainstLinearScan(vocab2, "Vocab index (bundle)");
+        bool same = true;
+        for (int beat = 0; beat < 4 && same; ++beat) {
+            for (int e = 0; e <= 10 && same; ++e) {
+                VocabularyRegistry::PianoBeatQuery q;
+                q.beatInBar = beat;
+                q.chordText = "G7";
+                q.chordFunction = "Dominant";
+                q.chordIsNew = beat == 0;
+                q.energy = 0.1 * e;
+                q.determinismSeed = quint32(17 + beat * 11 + e);
+                same = vocab2.choosePianoBeat(q).id == vocab.choosePianoBeat(q).id;
+            }
+        }
+        expect(same, "RegistryBundle: vocabulary choices match the JSON-loaded registry");
+    }
+
+    // The chord-scale table reloads without ranking scales and answers the same.
+    ChordScaleTableTestAccess::reset();
+    expect(ChordScaleTable::initializeFromBundle(*bundle), "RegistryBundle: chord-scale table loads");
+    const QVector<ChordScaleEntry> loaded = ChordScaleTableTestAccess::entries();
+    bool sameTable = ChordScaleTableTestAccess::chordKeys() == computedKeys && loaded.size() == computed.size();
+    for (int i = 0; sameTable && i < computed.size(); ++i) {
+        sameTable = loaded[i].scaleKey == computed[i].scaleKey && loaded[i].scaleName == computed[i].scaleName &&
+                    loaded[i].function == computed[i].function && loaded[i].roman == computed[i].roman;
+    }
+    expect(sameTable, "RegistryBundle: chord-scale entries survive");
+
+    // What was loaded encodes back to the same bytes (every field, string ids included).
+    expect(compile(ont2, groove2, vocab2) == bytes, "RegistryBundle: reloaded registries re-encode identically");
+
+    // Stale or damaged bundles are rejected, so callers fall back to builtins()/JSON.
+    QByteArray otherVersion = bytes;
+    otherVersion[4] = char(otherVersion[4] + 1);
+    expect(!RegistryBundle::fromBytes(otherVersion), "RegistryBundle: other format version rejected");
+    QByteArray flipped = bytes;
+    flipped[flipped.size() - 3] = char(flipped[flipped.size() - 3] ^ 0x5a);
+    expect(!RegistryBundle::fromBytes(flipped), "RegistryBundle: checksum mismatch rejected");
+    expect(!RegistryBundle::fromBytes(bytes.left(bytes.size() - 8)), "RegistryBundle: truncation rejected");
+
+    BundleWriter ontologyOnly;
+    ont.writeBundle(ontologyOnly);
+    const auto partial = RegistryBundle::fromBytes(ontologyOnly.finish());
+    VocabularyRegistry none;
+    GrooveRegistry grooveUntouched = groove;
+    expect(partial && !none.loadFromBundle(*partial) && !none.isLoaded(), "RegistryBundle: missing vocabulary section fails");
+    expect(partial && !GrooveRegistry::fromBundle(*partial, grooveUntouched) &&
+               grooveUntouched.allStylePresets().size() == groove.allStylePresets().size(),
+           "RegistryBundle: missing groove section leaves output untouched");
+
+    // No bundle is embedded in the test binary: precompiled() is builtins().
+    expect(RegistryBundle::embedded() == nullptr, "RegistryBundle: nothing embedded in tests");
+    expect(OntologyRegistry::precompiled().allChords().size() == ont.allChords().size(), "RegistryBundle: precompiled() falls back");
+}
+
+static void testRegistryDenseIdsAndSharedInstances() {
+    using namespace playback;
+    using virtuoso::groove::GrooveRegistry;
+    using virtuoso::ontology::OntologyRegistry;
+
+    const OntologyRegistry ont = OntologyRegistry::builtins();
+
+    // Ids are dense, in key order, and agree with every lookup path.
+    bool idsOk = ont.chordCount() > 0 && ont.scaleCount() > 0 && ont.voicingCount() > 0;
+    for (int id = 0; idsOk && id < ont.chordCount(); ++id) {
+        const auto* c = ont.chordById(id);
+        idsOk = c && c->id == id && ont.chordId(c->key) == id && ont.chord(c->key) == c &&
+                (id == 0 || ont.chordById(id - 1)->key < c->key);
+    }
+    for (int id = 0; idsOk && id < ont.scaleCount(); ++id) {
+        idsOk = ont.scaleById(id)->id == id && ont.scaleId(ont.scaleById(id)->key) == id;
+    }
+    for (int id = 0; idsOk && id < ont.voicingCount(); ++id) {
+        idsOk = ont.voicingById(id)->id == id && ont.voicingId(ont.voicingById(id)->key) == id;
+    }
+    expect(idsOk, "OntologyRegistry: dense ids round-trip through keys");
+    expect(ont.chord(u"maj7") == ont.chord(QString("maj7")) && ont.chord(u"maj7") != nullptr,
+           "OntologyRegistry: literal and QString keys resolve alike");
+    expect(ont.chordId(u"no_such_chord") < 0 && !ont.chordById(-1) && !ont.chordById(ont.chordCount()),
+           "OntologyRegistry: unknown keys and ids are absent");
+    expect(OntologyRegistry::builtins().chordId(u"7alt") == ont.chordId(u"7alt"),
+           "OntologyRegistry: ids are the same for every build of the same tables");
+
+    const GrooveRegistry groove = GrooveRegistry::builtins();
+    bool grooveOk = !groove.allGrooveTemplates().isEmpty();
+    for (const auto* t : groove.allGrooveTemplates()) {
+        grooveOk = grooveOk && t && groove.grooveTemplateById(t->id) == t && groove.grooveTemplateId(t->key) == t->id;
+    }
+    for (const auto* p : groove.allStylePresets()) {
+        grooveOk = grooveOk && (p->grooveTemplateKey.isEmpty() || groove.grooveTemplateId(p->grooveTemplateKey) >= 0);
+    }
+    expect(grooveOk, "GrooveRegistry: template ids agree with keys and presets resolve");
+
+    // One instance per process, with the same tables as a fresh build.
+    expect(&OntologyRegistry::shared() == &OntologyRegistry::shared() &&
+               OntologyRegistry::shared().chordCount() == ont.chordCount(),
+           "OntologyRegistry: shared() is one instance");
+    expect(&GrooveRegistry::shared() == &GrooveRegistry::shared() &&
+               GrooveRegistry::shared().grooveTemplateCount() == groove.grooveTemplateCount(),
+           "GrooveRegistry: shared() is one instance");
+    expect(&virtuoso::vocab::VocabularyRegistry::shared() == &virtuoso::vocab::VocabularyRegistry::shared(),
+           "VocabularyRegistry: shared() is one instance");
+
+    // The chord-scale table indexes by chord id; key lookups and foreign ChordDefs agree.
+    ChordScaleTable::initialize(ont);
+    bool tableOk = true;
+    int hits = 0;
+    for (int id = 0; tableOk && id < ont.chordCount(); ++id) {
+        const auto* c = ont.chordById(id);
+        virtuoso::ontology::ChordDef foreign = *c;
+        foreign.id = -1;
+        for (int interval = 0; interval < 12; ++interval) {
+            for (const auto mode : {virtuoso::theory::KeyMode::Major, virtuoso::theory::KeyMode::Minor}) {
+                const auto* byId = ChordScaleTable::lookup(id, interval, mode);
+                tableOk = tableOk && byId == ChordScaleTable::lookup(QStringView(c->key), interval, mode) &&
+                          byId == ChordScaleTable::lookup(*c, interval + 5, 5, mode) &&
+                          byId == ChordScaleTable::lookup(foreign, interval, 0, mode);
+                if (byId) ++hits;
+            }
+        }
+    }
+    expect(tableOk, "ChordScaleTable: id, key and ChordDef lookups agree");
+    expect(hits == ChordScaleTable::entryCount(), "ChordScaleTable: every entry reachable by id");
+    expect(!ChordScaleTable::lookup(-1, 0, virtuoso::theory::KeyMode::Major) &&
+               !ChordScaleTable::lookup(ont.chordCount() + 3, 0, virtuoso::theory::KeyMode::Major),
+           "ChordScaleTable: out-of-range ids miss");
+}
+
+// Also meant to run clean under ThreadSanitizer (-DVIRTUOSO_TSAN=ON): more threads than the
+// four energy branches race to initialize the table and then look up every slot.
+static void testChordScaleTableConcurrentLookups() {
+    using namespace playback;
+    using virtuoso::theory::KeyMode;
+
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    ChordScaleTable::initialize(ont);
+    QVector<QString> want; // scale key per (chord id, interval, mode); empty = miss
+    for (int id = 0; id < ont.chordCount(); ++id) {
+        for (int interval = 0; interval < 12; ++interval) {
+            for (const auto mode : {KeyMode::Major, KeyMode::Minor}) {
+                const auto* e = ChordScaleTable::lookup(id, interval, mode);
+                want.push_back(e ? e->scaleKey : QString());
+            }
+        }
+    }
+    const int entryCount = ChordScaleTable::entryCount();
+    ChordScaleTableTestAccess::reset();
+    const QVector<QString>& wantTable = want; // const: no detach checks from the workers
+
+    constexpr int kThreads = 16;
+    constexpr int kRounds = 4;
+    std::atomic<bool> go{false};
+    std::atomic<bool> done{false};
+    std::atomic<bool> countsReadable{true};
+    std::vector<int> mismatches(kThreads, 0);
+    std::vector<const ChordScaleEntry*> firstEntry(kThreads, nullptr);
+    std::vector<std::thread> threads;
+    threads.reserve(kThreads + 1);
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            ChordScaleTable::initialize(ont);
+            int bad = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                int i = 0;
+                for (int id = 0; id < ont.chordCount(); ++id) {
+                    const auto* c = ont.chordById(id);
+                    for (int interval = 0; interval < 12; ++interval) {
+                        for (const auto mode : {KeyMode::Major, KeyMode::Minor}) {
+                            // Alternate the id and ChordDef paths; both resolve to the same slot.
+                            const auto* e = (round % 2) ? ChordScaleTable::lookup(*c, interval + 7, 7, mode)
+                                                        : ChordScaleTable::lookup(id, interval, mode);
+                            const QString& w = wantTable[i++];
+                            if (e ? e->scaleKey != w : !w.isEmpty()) ++bad;
+                        }
+                    }
+                }
+            }
+            mismatches[t] = bad;
+            firstEntry[t] = ChordScaleTable::lookup(0, 0, KeyMode::Major);
+        });
+    }
+    // Statistics are read while the lookups run.
+    threads.emplace_back([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            if (ChordScaleTable::hitCount() < 0 || ChordScaleTable::missCount() < 0) countsReadable = false;
+            std::this_thread::yield();
+        }
+    });
+    go.store(true, std::memory_order_release);
+    for (int t = 0; t < kThreads; ++t) threads[t].join();
+    done.store(true, std::memory_order_release);
+    threads.back().join();
+
+    int bad = 0;
+    for (int n : mismatches) bad += n;
+    expect(countsReadable, "ChordScaleTable (threads): counts readable during lookups");
+    expect(bad == 0, QString("ChordScaleTable (threads): %1 lookups differ from the serial table").arg(bad));
+    expect(ChordScaleTable::entryCount() == entryCount, "ChordScaleTable (threads): one table built");
+    expect(std::all_of(firstEntry.cbegin(), firstEntry.cend(),
+                       [&](const ChordScaleEntry* e) { return e == firstEntry.front(); }),
+           "ChordScaleTable (threads): every thread reads the same published table");
+    // Exited threads' counts survive in the merged totals (+1: the firstEntry lookup).
+    const int perThread = kRounds * ont.chordCount() * 24 + 1;
+    expect(ChordScaleTable::hitCount() + ChordScaleTable::missCount() == kThreads * perThread,
+           QString("ChordScaleTable (threads): %1 hits + %2 misses, expected %3 lookups")
+               .arg(ChordScaleTable::hitCount())
+               .arg(ChordScaleTable::missCount())
+               .arg(kThreads * perThread));
+    expect(ChordScaleTable::hitCount() >= kThreads * kRounds * entryCount,
+           "ChordScaleTable (threads): every entry hit on every round");
+    ChordScaleTable::resetStats();
+    expect(ChordScaleTable::hitCount() == 0 && ChordScaleTable::missCount() == 0,
+           "ChordScaleTable (threads): resetStats clears every slot");
+
+    // The context pass gives the same contexts on a one-thread pool and a wide one.
+    chart::ChartModel model;
+    chart::Line line;
+    const QStringList cellsText = {"Dm7", "", "G7", "", "Cmaj7", "", "A7b9", "", "Em7b5", "", "A7", "",
+                                   "Dm7", "G7", "Cmaj7", "", "Fmaj7", "", "Bb7", "", "Ebmaj7", "", "Ab7", ""};
+    for (int b = 0; b < cellsText.size() / 4; ++b) {
+        chart::Bar bar;
+        bar.cells.resize(4);
+        for (int c = 0; c < 4; ++c) bar.cells[c].chord = cellsText[b * 4 + c];
+        line.bars.push_back(bar);
+    }
+    model.lines.push_back(line);
+    QVector<int> sequence;
+    for (int i = 0; i < cellsText.size(); ++i) sequence << i;
+    auto contextsOn = [&](int threadCount) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(threadCount);
+        HarmonyContext harmony;
+        harmony.setOntology(&ont);
+        harmony.rebuildFromModel(model);
+        PrePlaybackBuilder::Inputs in;
+        in.model = &model;
+        in.sequence = &sequence;
+        in.repeats = 4;
+        in.harmony = &harmony;
+        in.ontology = &ont;
+        in.pool = &pool;
+        return PrePlaybackBuilderTestAccess::buildContexts(in);
+    };
+    const auto serial = contextsOn(1);
+    const auto wide = contextsOn(12);
+    bool same = serial.size() == wide.size() && !serial.isEmpty();
+    for (int i = 0; same && i < serial.size(); ++i) {
+        same = serial[i].scaleKey == wide[i].scaleKey && serial[i].roman == wide[i].roman &&
+               serial[i].keyTonicPc == wide[i].keyTonicPc && serial[i].keyMode == wide[i].keyMode &&
+               serial[i].chordText == wide[i].chordText && serial[i].chordDef == wide[i].chordDef;
+    }
+    expect(same, "PrePlaybackBuilder: 12-thread pool builds the same contexts as one thread");
+}
+
+static void testPrePlaybackIncrementalRebuildMatchesFullBuild() {
+    using namespace playback;
+
+    const virtuoso::ontology::OntologyRegistry ont = virtuoso::ontology::OntologyRegistry::builtins();
+    ChordScaleTable::initialize(ont);
+
+    const QStringList cellsText = {"Cmaj7", "", "Am7", "", "Dm7", "", "G7", "",
+                                   "Em7", "", "A7", "", "Dm7", "", "G7", "",
+                                   "Cmaj7", "", "C7", "", "Fmaj7", "", "Bb7", "",
+                                   "Em7", "", "A7", "", "Dm7", "G7", "Cmaj7", "",
+                                   "Cmaj7", "", "Am7", "", "Dm7", "", "G7", "",
+                                   "Em7", "", "A7", "", "Dm7", "", "G7", "",
+                                   "Cmaj7", "", "C7", "", "Fmaj7", "", "Bb7", "",
+                                   "Em7", "", "A7", "", "Dm7", "G7", "Cmaj7", ""};
+    auto makeModel = [&](const QStringList& cells) {
+        chart::ChartModel model;
+        chart::Line line;
+        for (int b = 0; b < cells.size() / 4; ++b) {
+            chart::Bar bar;
+            bar.cells.resize(4);
+            for (int c = 0; c < 4; ++c) bar.cells[c].chord = cells[b * 4 + c];
+            line.bars.push_back(bar);
+        }
+        model.lines.push_back(line);
+        return model;
+    };
+    QVector<int> sequence;
+    for (int i = 0; i < cellsText.size(); ++i) sequence << i;
+
+    JazzBalladBassPlanner bass;
+    JazzBalladPianoPlanner piano;
+    BrushesBalladDrummer drums;
+    auto build = [&](const chart::ChartModel& model, int bpm, const PrePlaybackCache* previous) {
+        HarmonyContext harmony;
+        harmony.setOntology(&ont);
+        harmony.rebuildFromModel(model);
+        PrePlaybackBuilder::Inputs in;
+        in.model = &model;
+        in.sequence = &sequence;
+        in.bpm = bpm;
+        in.stylePresetKey = "jazz_brushes_ballad_60_evans";
+        in.bassPlanner = &bass;
+        in.pianoPlanner = &piano;
+        in.drummer = &drums;
+        in.harmony = &harmony;
+        in.ontology = const_cast<virtuoso::ontology::OntologyRegistry*>(&ont);
+        return previous ? PrePlaybackBuilder::rebuild(in, *previous) : PrePlaybackBuilder::build(in);
+    };
+    auto sameNotes = [](const QVector<virtuoso::engine::AgentIntentNote>& a,
+                        const QVector<virtuoso::engine::AgentIntentNote>& b) {
+        if (a.size() != b.size()) return false;
+        for (int i = 0; i < a.size(); ++i) {
+            if (a[i].note != b[i].note || a[i].baseVelocity != b[i].baseVelocity || a[i].channel != b[i].channel ||
+                a[i].startPos.barIndex != b[i].startPos.barIndex ||
+                a[i].startPos.withinBarWhole.num != b[i].startPos.withinBarWhole.num ||
+                a[i].startPos.withinBarWhole.den != b[i].startPos.withinBarWhole.den ||
+                a[i].durationWhole.num != b[i].durationWhole.num || a[i].durationWhole.den != b[i].durationWhole.den ||
+                a[i].logic_tag != b[i].logic_tag) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto mismatchingSteps = [&](const PrePlaybackCache& a, const PrePlaybackCache& b) {
+        if (a.energyBranches.size() != b.energyBranches.size()) return -1;
+        int bad = 0;
+        for (int e = 0; e < a.energyBranches.size(); ++e) {
+            if (a.energyBranches[e].size() != b.energyBranches[e].size()) return -1;
+            for (int i = 0; i < a.energyBranches[e].size(); ++i) {
+                const auto& x = a.energyBranches[e][i];
+                const auto& y = b.energyBranches[e][i];
+                const bool same = x.bassId == y.bassId && x.pianoId == y.pianoId && x.drumsId == y.drumsId &&
+                                  x.voicingKey == y.voicingKey && x.chordText == y.chordText &&
+                                  x.bassCenterMidi == y.bassCenterMidi && x.pianoCenterMidi == y.pianoCenterMidi &&
+                                  sameNotes(x.bassPlan.notes, y.bassPlan.notes) &&
+                                  sameNotes(x.pianoPlan.notes, y.pianoPlan.notes) &&
+                                  sameNotes(x.drumsNotes, y.drumsNotes) &&
+                                  x.bassPlan.keyswitches.size() == y.bassPlan.keyswitches.size() &&
+                                  x.pianoPlan.ccs.size() == y.pianoPlan.ccs.size();
+                if (!same) ++bad;
+            }
+        }
+        return bad;
+    };
+
+    const chart::ChartModel original = makeModel(cellsText);
+    const PrePlaybackCache a = build(original, 60, nullptr);
+    expect(a.isValid() && a.canRebuildFrom(), "Incremental rebuild: initial build keeps contexts");
+    expect(a.reusedSteps == 0 && a.recomputedSteps == a.totalSteps * a.energyBranches.size(),
+           "Incremental rebuild: full build recomputes every step");
+
+    // Edit one bar near the end: everything before it is reused, the result matches a fresh build.
+    QStringList edited = cellsText;
+    edited[13 * 4] = "Ebm7";
+    edited[13 * 4 + 2] = "Ab7";
+    const chart::ChartModel editedModel = makeModel(edited);
+    const PrePlaybackCache fresh = build(editedModel, 60, nullptr);
+    const PrePlaybackCache inc = build(editedModel, 60, &a);
+    expect(mismatchingSteps(inc, fresh) == 0,
+           QString("Incremental rebuild: chart edit matches full build (%1 steps differ)").arg(mismatchingSteps(inc, fresh)));
+    expect(inc.reusedSteps > 0, "Incremental rebuild: chart edit reuses unchanged bars");
+    expect(inc.reusedSteps + inc.recomputedSteps == inc.totalSteps * inc.energyBranches.size(),
+           "Incremental rebuild: reused + recomputed covers every step");
+
+    // Tempo changes every lane's settings: nothing may be reused, output still matches a fresh build.
+    const PrePlaybackCache freshTempo = build(editedModel, 72, nullptr);
+    const PrePlaybackCache incTempo = build(editedModel, 72, &inc);
+    expect(mismatchingSteps(incTempo, freshTempo) == 0, "Incremental rebuild: tempo change matches full build");
+    expect(incTempo.reusedSteps == 0, "Incremental rebuild: tempo change reuses nothing");
+
+    // A cache without contexts (e.g. loaded from disk) falls back to a full build.
+    PrePlaybackCache noContexts = a;
+    noContexts.contexts.clear();
+    const PrePlaybackCache fallback = build(editedModel, 60, &noContexts);
+    expect(fallback.reusedSteps == 0 && mismatchingSteps(fallback, fresh) == 0,
+           "Incremental rebuild: falls back to full build without contexts");
+}
+
+static void testChooseBestComboMatchesExhaustive() {
+    using namespace playback;
+
+    quint32 x = 12345u;
+    auto rnd = [&](int n) {
+        x = x * 1664525u + 1013904223u;
+        return int((x >> 8) % quint32(qMax(1, n)));
+    };
+    auto notes = [&](int lo, int hi, int maxCount) {
+        QVector<virtuoso::engine::AgentIntentNote> out;
+        const int count = rnd(maxCount + 1);
+        for (int i = 0; i < count; ++i) {
+            virtuoso::engine::AgentIntentNote n;
+            n.note = lo + rnd(hi - lo + 1);
+            n.startPos.barIndex = 0;
+            n.startPos.withinBarWhole = virtuoso::groove::Rational(rnd(8), 8);
+            out.push_back(n);
+        }
+        return out;
+    };
+    const QStringList ids = {"sparse", "base", "rich"};
+
+    // Realistic pools (2-3 per agent), pools with duplicated candidates (exact cost ties), and a
+    // large pool that takes the thread-pool path.
+    struct Shape { int b, p, d; bool dup; };
+    const QVector<Shape> shapes = {{2, 2, 2, false}, {3, 3, 2, false}, {3, 3, 1, true}, {12, 10, 6, true}};
+    int mismatches = 0;
+    for (int trial = 0; trial < 40; ++trial) {
+        const Shape sh = shapes[trial % shapes.size()];
+        QVector<JointCandidateModel::BassCand> bass;
+        QVector<JointCandidateModel::PianoCand> piano;
+        QVector<JointCandidateModel::DrumCand> drums;
+        for (int i = 0; i < sh.b; ++i) {
+            JointCandidateModel::BassCand c;
+            c.id = ids[i % ids.size()];
+            c.plan.notes = (sh.dup && i > 0 && rnd(2)) ? bass.last().plan.notes : notes(28, 55, 3);
+            bass.push_back(c);
+        }
+        for (int i = 0; i < sh.p; ++i) {
+            JointCandidateModel::PianoCand c;
+            c.id = ids[i % ids.size()];
+            c.plan.notes = (sh.dup && i > 0 && rnd(2)) ? piano.last().plan.notes : notes(50, 84, 5);
+            c.pianistFeasibilityCost = 0.1 * rnd(4);
+            c.plan.performance.compPhraseId = rnd(2) ? "comp_a" : "comp_b";
+            piano.push_back(c);
+        }
+        for (int i = 0; i < sh.d; ++i) {
+            JointCandidateModel::DrumCand c;
+            c.id = (i % 3 == 0) ? "dry" : (i % 3 == 1) ? "wet" : "none";
+            c.plan = notes(36, 51, 4);
+            drums.push_back(c);
+        }
+
+        JointCandidateModel::ScoringInputs si;
+        music::parseChordSymbol(trial % 2 ? "G7" : "Cmaj7", si.chord);
+        si.beatInBar = trial % 4;
+        si.cadence01 = 0.25 * (trial % 5);
+        si.phraseEndBar = (trial % 3) == 0;
+        si.userBusy = (trial % 7) == 0;
+        si.userSilence = !si.userBusy;
+        si.inResponse = (trial % 5) == 1;
+        si.lastBassId = "base";
+        si.lastPianoId = (trial % 2) ? "rich" : QString();
+        si.lastDrumsId = "dry";
+        si.lastPianoCompPhraseId = "comp_a";
+        si.weightsAvg.rhythm = 0.1 * (trial % 10);
+        si.weightsAvg.variability = 0.05 * (trial % 20);
+        si.weights = virtuoso::solver::weightsFromWeightsV2(si.weightsAvg);
+
+        JointCandidateModel::ScoringInputs full = si;
+        full.explainAllCombos = true;
+        const auto all = JointCandidateModel::chooseBestCombo(full, bass, piano, drums);
+        const auto pruned = JointCandidateModel::chooseBestCombo(si, bass, piano, drums);
+        if (all.combos.size() != sh.b * sh.p * sh.d) ++mismatches;
+        if (pruned.bestBi != all.bestBi || pruned.bestPi != all.bestPi || pruned.bestDi != all.bestDi ||
+            pruned.bestCost != all.bestCost || !pruned.combos.isEmpty()) {
+            ++mismatches;
+        }
+
+        // Top-K = first K of the exhaustive list ordered by (cost, enumeration order).
+        QVector<JointCandidateModel::ComboEval> want = all.combos;
+        std::stable_sort(want.begin(), want.end(), [](const auto& a, const auto& b) { return a.cost < b.cost; });
+        JointCandidateModel::ScoringInputs topSi = si;
+        topSi.keepTopK = 5;
+        const auto top = JointCandidateModel::chooseBestCombo(topSi, bass, piano, drums);
+        const int k = qMin(5, want.size());
+        if (top.combos.size() != k) {
+            ++mismatches;
+            continue;
+        }
+        for (int i = 0; i < k; ++i) {
+            if (top.combos[i].bi != want[i].bi || top.combos[i].pi != want[i].pi || top.combos[i].di != want[i].di ||
+                top.combos[i].cost != want[i].cost) {
+                ++mismatches;
+                break;
+            }
+        }
+    }
+    expect(mismatches == 0, QString("chooseBestCombo: pruned search matches exhaustive (%1 mismatches)").arg(mismatches));
+}
+
+// Pre-bitmask ChordOntology::createActiveChord: tiers rebuilt as std::set straight from the
+// ontology intervals, so the reference does not depend on the masks under test.
+struct SetTiers {
+    std::set<int> t1, t2, t3, avoid;
+};
+
+static SetTiers setTiersFromOntology(int chordRootPc, int keyRootPc,
+                                     const virtuoso::ontology::ChordDef* cd,
+                                     const virtuoso::ontology::ScaleDef* sd) {
+    auto pcOf = [](int v) { return ((v % 12) + 12) % 12; };
+    const int root = pcOf(chordRootPc);
+    SetTiers r;
+    if (cd) {
+        for (int interval : cd->intervals) r.t1.insert(pcOf(root + interval));
+    } else {
+        r.t1.insert(root);
+    }
+    std::set<int> scaleTones;
+    if (sd) {
+        for (int interval : sd->intervals) scaleTones.insert(pcOf(keyRootPc + interval));
+    }
+    // Tensions: 9, 11, 13 then b9, #9, #11, b13 when in the scale and not chord tones.
+    for (int interval : {2, 5, 9, 1, 3, 6, 8}) {
+        const int pc = pcOf(root + interval);
+        if (scaleTones.count(pc) && !r.t1.count(pc)) r.t2.insert(pc);
+    }
+    for (int pc : scaleTones) {
+        if (!r.t1.count(pc) && !r.t2.count(pc)) r.t3.insert(pc);
+    }
+    const int major3rd = pcOf(root + 4);
+    const int minor3rd = pcOf(root + 3);
+    const int natural4th = pcOf(root + 5);
+    const int second = pcOf(root + 2);
+    if (r.t1.count(major3rd) && !r.t1.count(minor3rd) && scaleTones.count(natural4th) && !r.t1.count(natural4th)) {
+        r.avoid.insert(natural4th);
+    }
+    if (r.t1.count(natural4th) && scaleTones.count(major3rd)) r.avoid.insert(major3rd);
+    if (r.t1.count(second) && !r.t1.count(major3rd) && !r.t1.count(natural4th) && scaleTones.count(major3rd)) {
+        r.avoid.insert(major3rd);
+    }
+    return r;
+}
+
+static void testPitchConformanceMasksMatchSetScan() {
+    using namespace playback;
+    const auto ont = virtuoso::ontology::OntologyRegistry::builtins();
+    const auto chords = ont.allChords();
+    const auto scales = ont.allScales();
+    const ChordOntology& co = ChordOntology::instance();
+    PitchConformanceEngine engine;
+
+    auto toSet = [](const PitchClassSet& s) { return std::set<int>(s.begin(), s.end()); };
+    int cases = 0;
+    int mismatches = 0;
+    int tierMismatches = 0;
+    for (int root = 0; root < 12; ++root) {
+        for (const auto* cd : chords) {
+            for (const auto* sd : scales) {
+                // Key root differs from the chord root on odd roots so scale tones are not
+                // always chord-relative.
+                const int keyRoot = (root % 2) ? (root + 5) % 12 : root;
+                const ActiveChord chord = co.createActiveChord(root, keyRoot, cd, sd);
+                const SetTiers ref = setTiersFromOntology(root, keyRoot, cd, sd);
+                if (toSet(chord.tier1Absolute) != ref.t1 || toSet(chord.tier2Absolute) != ref.t2 ||
+                    toSet(chord.tier3Absolute) != ref.t3 || toSet(chord.avoidAbsolute) != ref.avoid) {
+                    if (tierMismatches++ < 5) {
+                        qWarning().noquote() << QString("tier mask mismatch: root=%1 key=%2 chord=%3 scale=%4")
+                                                    .arg(root).arg(keyRoot).arg(cd->key, sd->key);
+                    }
+                }
+                const std::set<int>& t1 = ref.t1;
+                const std::set<int>& t2 = ref.t2;
+                const std::set<int>& t3 = ref.t3;
+                const std::set<int>& avoid = ref.avoid;
+                for (int pitch = 0; pitch < 128; ++pitch) {
+                    ++cases;
+                    // Former std::set implementation of calculateGravity / conformHarmonyPitch.
+                    const int pc = pitch % 12;
+                    const int tier = t1.count(pc) ? 1 : t2.count(pc) ? 2 : t3.count(pc) ? 3 : 4;
+                    int target = pc;
+                    if (tier != 1) {
+                        int bestDistance = 7;
+                        target = -1;
+                        for (int t : t1) {
+                            const int d = ChordOntology::minDistance(pc, t);
+                            if (d < bestDistance) {
+                                bestDistance = d;
+                                target = t;
+                            }
+                        }
+                        if (target < 0) target = chord.rootPc;
+                    }
+                    const int harmony = (tier <= 2) ? pitch : ChordOntology::findNearestInOctave(pitch, target);
+
+                    const GravityResult g = engine.calculateGravity(pc, chord);
+                    if (g.tier != tier || co.getTier(pc, chord) != tier || g.isAvoidNote != (avoid.count(pc) > 0) ||
+                        g.nearestTarget != target || g.distance != (tier == 1 ? 0 : ChordOntology::signedDistance(pc, target)) ||
+                        engine.conformHarmonyPitch(pitch, chord) != harmony) {
+                        if (mismatches++ < 5) {
+                            qWarning().noquote() << QString("conformance mismatch: root=%1 chord=%2 scale=%3 pitch=%4")
+                                                        .arg(root).arg(cd->key, sd->key).arg(pitch);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    expect(cases > 0, "PitchConformance: ontology has chords and scales");
+    expect(tierMismatches == 0, QString("PitchConformance: tier masks match set construction (%1 differ)")
+                                    .arg(tierMismatches));
+    expect(mismatches == 0, QString("PitchConformance: mask/table path matches set scan (%1 of %2 differ)")
+                                .arg(mismatches).arg(cases));
+}
+
+static void testNoteSlotTableMatchesMap() {
+    // Random insert/remove/erase-while-iterating against std::map, the ordered
+    // reference (QHash iteration order was unspecified anyway).
+    playback::NoteSlotTable<int> table;
+    std::map<int, int> ref;
+    quint32 x = 777u;
+    auto next = [&x](int n) {
+        x = x * 1664525u + 1013904223u;
+        return int((x >> 8) % quint32(n));
+    };
+    int mismatches = 0;
+    for (int step = 0; step < 20000; ++step) {
+        const int note = next(130) - 1; // includes the out-of-range -1 and 128
+        switch (next(4)) {
+        case 0:
+        case 1:
+            table.insert(note, step);
+            if (note >= 0 && note < 128) ref[note] = step;
+            break;
+        case 2:
+            if (table.remove(note) != (ref.erase(note) > 0)) ++mismatches;
+            break;
+        default:
+            // Erase every entry with an odd value while iterating.
+            for (auto it = table.begin(); it != table.end(); ++it) {
+                if (it.value() % 2) table.erase(it);
+            }
+            for (auto it = ref.begin(); it != ref.end();) it = (it->second % 2) ? ref.erase(it) : std::next(it);
+            break;
+        }
+        if (table.size() != int(ref.size()) || table.isEmpty() != ref.empty()) ++mismatches;
+        auto r = ref.begin();
+        for (auto it = table.constBegin(); it != table.constEnd(); ++it, ++r) {
+            if (r == ref.end() || it.key() != r->first || it.value() != r->second) {
+                ++mismatches;
+                break;
+            }
+        }
+        if (r != ref.end()) ++mismatches;
+        auto found = table.find(note);
+        const bool inRef = ref.count(note) > 0;
+        if ((found != table.end()) != inRef || table.contains(note) != inRef ||
+            (inRef && (found.key() != note || found.value() != ref[note]))) {
+            ++mismatches;
+        }
+    }
+    table.clear();
+    expect(table.isEmpty() && table.begin() == table.end(), "NoteSlotTable: clear empties the table");
+    expect(mismatches == 0, QString("NoteSlotTable: matches std::map (%1 mismatching steps)").arg(mismatches));
+}
+
 int main(int argc, char** argv) {
     QCoreApplication app(argc, argv);
     testLookaheadPlannerJsonDeterminism();
@@ -628,6 +1946,16 @@ int main(int argc, char** argv) {
     testCandidatePoolIncludesWeightsV2();
     testRealVocabularyParsing();
     testVocabularyModularMatching();
+    testVocabularyIndexMatchesLinearScan();
+    testPrePlaybackContextsMatchSerialLookahead();
+    testPrePlaybackCacheStoreRoundTrip();
+    testRegistryBundleRoundTrip();
+    testRegistryDenseIdsAndSharedInstances();
+    testChordScaleTableConcurrentLookups();
+    testPrePlaybackIncrementalRebuildMatchesFullBuild();
+    testChooseBestComboMatchesExhaustive();
+    testPitchConformanceMasksMatchSetScan();
+    testNoteSlotTableMatchesMap();
     if (g_failures > 0) {
         qWarning() << "VirtuosoPlaybackTests failures:" << g_failures;
         return 1;
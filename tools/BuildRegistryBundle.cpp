@@ -0,0 +1,72 @@
+// Compiles the code-defined ontology and groove registries, the vocabulary JSON and the
+// chord→scale table derived from the ontology into the precompiled registry bundle the app
+// embeds (virtuoso/util/RegistryBundle.h). The build runs it; by hand:
+//   ./BuildRegistryBundle virtuoso/vocab/cool_jazz_vocabulary.json registries.vrb
+
+#include "playback/ChordScaleTable.h"
+#include "virtuoso/groove/GrooveRegistry.h"
+#include "virtuoso/ontology/OntologyRegistry.h"
+#include "virtuoso/util/RegistryBundle.h"
+#include "virtuoso/vocab/VocabularyRegistry.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() != 3) {
+        qWarning().noquote() << "usage: BuildRegistryBundle vocabulary.json out.vrb";
+        return 2;
+    }
+    const QString vocabPath = args[1];
+    const QString out = args[2];
+
+    const auto ontology = virtuoso::ontology::OntologyRegistry::builtins();
+    const auto groove = virtuoso::groove::GrooveRegistry::builtins();
+    virtuoso::vocab::VocabularyRegistry vocab;
+    QString error;
+    if (!vocab.loadFromResourcePath(vocabPath, &error)) {
+        qWarning().noquote() << error;
+        return 1;
+    }
+    playback::ChordScaleTable::initialize(ontology);
+    if (!playback::ChordScaleTable::isInitialized()) {
+        qWarning().noquote() << "ChordScaleTable did not initialize";
+        return 1;
+    }
+
+    virtuoso::util::BundleWriter w;
+    ontology.writeBundle(w);
+    groove.writeBundle(w);
+    vocab.writeBundle(w);
+    playback::ChordScaleTable::writeBundle(w);
+    const QByteArray bytes = w.finish();
+
+    // Check what a loader will see before replacing the previous bundle.
+    const auto bundle = virtuoso::util::RegistryBundle::fromBytes(bytes, &error);
+    virtuoso::ontology::OntologyRegistry ontologyBack;
+    virtuoso::groove::GrooveRegistry grooveBack;
+    virtuoso::vocab::VocabularyRegistry vocabBack;
+    if (!bundle || !virtuoso::ontology::OntologyRegistry::fromBundle(*bundle, ontologyBack) ||
+        !virtuoso::groove::GrooveRegistry::fromBundle(*bundle, grooveBack) ||
+        !vocabBack.loadFromBundle(*bundle, &error)) {
+        qWarning().noquote() << "bundle does not read back:" << error;
+        return 1;
+    }
+
+    QFile f(out);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(bytes) != bytes.size()) {
+        qWarning().noquote() << "cannot write" << out;
+        return 1;
+    }
+    qInfo().noquote() << QString("wrote %1: %2 bytes, %3 strings, format %4")
+                             .arg(out)
+                             .arg(bytes.size())
+                             .arg(bundle->stringCount())
+                             .arg(virtuoso::util::RegistryBundle::kFormatVersion);
+    return 0;
+}
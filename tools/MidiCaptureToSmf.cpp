@@ -0,0 +1,74 @@
+// Converts a MIDI capture recorded by MidiProcessor (Settings → Record MIDI Capture, a
+// binary .mcap) or written by hand in the text form into a Standard MIDI File with one
+// track per port, and prints what it holds.
+//   ./MidiCaptureToSmf capture.mcap [out.mid] [--text out.txt]
+// out.mid defaults to the capture path with a .mid suffix; --text also writes the text form
+// (which MidiReplayBenchmarks replays as well).
+
+#include "midi/MidiCapture.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <array>
+#include <cstdint>
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    QString in;
+    QString out;
+    QString text;
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--text" && i + 1 < args.size()) text = args[++i];
+        else if (in.isEmpty()) in = args[i];
+        else out = args[i];
+    }
+    if (in.isEmpty()) {
+        qWarning().noquote() << "usage: MidiCaptureToSmf capture.mcap [out.mid] [--text out.txt]";
+        return 2;
+    }
+    if (out.isEmpty()) {
+        const QFileInfo fi(in);
+        out = fi.path() + "/" + fi.completeBaseName() + ".mid";
+    }
+
+    midi::MidiCapture capture;
+    QString error;
+    std::uint64_t dropped = 0;
+    if (!midi::loadCapture(in, capture, &error, &dropped)) {
+        qWarning().noquote() << error;
+        return 1;
+    }
+
+    std::array<int, std::size_t(midi::CapturePort::Count)> perPort{};
+    for (const midi::CaptureEvent& ev : capture) ++perPort[std::size_t(ev.port)];
+    qInfo().noquote() << QString("%1: %2 events over %3 s, %4 dropped while recording")
+                             .arg(in)
+                             .arg(capture.size())
+                             .arg(capture.empty() ? 0.0 : double(capture.back().tNs) / 1e9, 0, 'f', 3)
+                             .arg(dropped);
+    for (int p = 0; p < int(midi::CapturePort::Count); ++p) {
+        if (perPort[std::size_t(p)] == 0) continue;
+        qInfo().noquote() << QString("  %1 %2").arg(midi::capturePortName(midi::CapturePort(p)), -13)
+                                                .arg(perPort[std::size_t(p)]);
+    }
+
+    if (!midi::saveSmf(out, capture, &error)) {
+        qWarning().noquote() << error;
+        return 1;
+    }
+    qInfo().noquote() << "wrote" << out;
+    if (!text.isEmpty()) {
+        if (!midi::saveTextCapture(text, capture)) {
+            qWarning().noquote() << "cannot write" << text;
+            return 1;
+        }
+        qInfo().noquote() << "wrote" << text;
+    }
+    return 0;
+}
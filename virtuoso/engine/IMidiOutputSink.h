@@ -0,0 +1,19 @@
+#pragma once
+
+namespace virtuoso::engine {
+
+// Direct MIDI output target for the realtime dispatch thread.
+// Implementations must be thread-safe and non-blocking: they are called from
+// a high-priority thread at the event's due time (e.g. MidiProcessor's
+// lock-free virtual-band ring).
+class IMidiOutputSink {
+public:
+    virtual ~IMidiOutputSink() = default;
+
+    virtual void sendNoteOn(int channel, int note, int velocity) = 0; // channel 1..16
+    virtual void sendNoteOff(int channel, int note) = 0;
+    virtual void sendAllNotesOff(int channel) = 0;
+    virtual void sendCC(int channel, int cc, int value) = 0;
+};
+
+} // namespace virtuoso::engine
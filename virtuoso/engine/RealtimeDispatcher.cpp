@@ -0,0 +1,219 @@
+#include "virtuoso/engine/RealtimeDispatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#include <pthread/qos.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace virtuoso::engine {
+
+namespace {
+static bool heapLess(const RealtimeDispatcher::Event& a, const RealtimeDispatcher::Event& b) {
+    return a.dueNs > b.dueNs; // reversed for min-heap behavior
+}
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+} // namespace
+
+RealtimeDispatcher::RealtimeDispatcher(const VirtuosoClock* clock, IMidiOutputSink* sink)
+    : m_clock(clock), m_sink(sink) {
+    m_heap.reserve(1024);
+    m_due.reserve(1024);
+    m_thread = std::thread(&RealtimeDispatcher::run, this);
+}
+
+RealtimeDispatcher::~RealtimeDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void RealtimeDispatcher::schedule(const Event& ev) {
+    bool wakeThread = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_heap.push_back(ev);
+        std::push_heap(m_heap.begin(), m_heap.end(), heapLess);
+        // Only an earlier deadline changes what the thread is sleeping for.
+        wakeThread = (m_heap.front().dueNs == ev.dueNs);
+    }
+    if (wakeThread) m_cv.notify_one();
+}
+
+void RealtimeDispatcher::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_heap.clear();
+}
+
+bool RealtimeDispatcher::isEmpty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_heap.empty();
+}
+
+RealtimeDispatcher::Stats RealtimeDispatcher::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void RealtimeDispatcher::panicSilence() {
+    std::lock_guard<std::recursive_mutex> sendLock(m_sendMutex);
+    m_due.clear(); // collected by a send in progress on this thread: drop the rest
+    std::array<std::array<bool, 128>, 16> sounding;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_heap.clear();
+        sounding = m_active;
+        for (auto& row : m_active) row.fill(false);
+        for (auto& row : m_activeId) row.fill(0u);
+    }
+    if (!m_sink) return;
+    for (int ch = 1; ch <= 16; ++ch) {
+        bool any = false;
+        for (int n = 0; n < 128; ++n) {
+            if (!sounding[ch - 1][n]) continue;
+            any = true;
+            m_sink->sendNoteOff(ch, n);
+        }
+        if (any) m_sink->sendAllNotesOff(ch);
+    }
+}
+
+void RealtimeDispatcher::collectDue() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const qint64 dispatchNow = m_clock->elapsedNs();
+    while (!m_heap.empty() && m_heap.front().dueNs <= dispatchNow) {
+        const Event ev = m_heap.front();
+        std::pop_heap(m_heap.begin(), m_heap.end(), heapLess);
+        m_heap.pop_back();
+        if (applyLocked(ev)) m_due.push_back(ev);
+        ++m_stats.dispatched;
+        m_stats.maxLateNs = std::max(m_stats.maxLateNs, dispatchNow - ev.dueNs);
+    }
+}
+
+bool RealtimeDispatcher::applyLocked(const Event& ev) {
+    const int ch = int(ev.channel);
+    const int note = int(ev.note);
+    const bool noteInRange = ch >= 1 && ch <= 16 && note >= 0 && note <= 127;
+    switch (ev.op) {
+    case Op::NoteOn:
+        if (noteInRange) {
+            m_active[ch - 1][note] = true;
+            m_activeId[ch - 1][note] = ev.noteId;
+        }
+        return true;
+    case Op::NoteOff:
+        // Only release the currently-active instance of this pitch; a stale
+        // NOTE_OFF must not choke a retriggered note.
+        if (noteInRange && m_active[ch - 1][note] && m_activeId[ch - 1][note] == ev.noteId) {
+            m_active[ch - 1][note] = false;
+            m_activeId[ch - 1][note] = 0u;
+            return true;
+        }
+        return false;
+    case Op::AllNotesOff:
+        if (ch >= 1 && ch <= 16) {
+            m_active[ch - 1].fill(false);
+            m_activeId[ch - 1].fill(0u);
+        }
+        return true;
+    case Op::CC:
+        return true;
+    }
+    return false;
+}
+
+void RealtimeDispatcher::send(const Event& ev) {
+    if (!m_sink) return;
+    const int ch = int(ev.channel);
+    switch (ev.op) {
+    case Op::NoteOn: {
+        const double s = std::max(0.0, m_velocityScale.load(std::memory_order_relaxed));
+        const int v = std::max(1, std::min(127, int(std::llround(double(ev.velocity) * s))));
+        m_sink->sendNoteOn(ch, int(ev.note), v);
+        break;
+    }
+    case Op::NoteOff: m_sink->sendNoteOff(ch, int(ev.note)); break;
+    case Op::AllNotesOff: m_sink->sendAllNotesOff(ch); break;
+    case Op::CC: m_sink->sendCC(ch, int(ev.cc), int(ev.ccValue)); break;
+    }
+}
+
+void RealtimeDispatcher::raiseCurrentThreadPriority() {
+    // Best effort: failure (e.g. no CAP_SYS_NICE on Linux) leaves the thread
+    // at normal priority, which is still independent of the GUI loop.
+#if defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+#elif defined(__linux__)
+    sched_param sp{};
+    sp.sched_priority = std::max(1, sched_get_priority_max(SCHED_FIFO) / 2);
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+#endif
+}
+
+void RealtimeDispatcher::run() {
+    raiseCurrentThreadPriority();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (m_heap.empty() || !m_clock || !m_clock->isRunning()) {
+            // Nothing due (or transport stopped): sleep until schedule()/stop.
+            m_cv.wait_for(lock, std::chrono::milliseconds(50));
+            continue;
+        }
+
+        const qint64 due = m_heap.front().dueNs;
+        const qint64 now = m_clock->elapsedNs();
+        if (due - now > kSpinWindowNs) {
+            // Coarse sleep; re-evaluate on wake since an earlier event may have arrived.
+            m_cv.wait_for(lock, std::chrono::nanoseconds(due - now - kSpinWindowNs));
+            continue;
+        }
+        if (due > now) {
+            // Fine wait: spin without holding the lock so schedule() never blocks on us.
+            lock.unlock();
+            while (m_clock->isRunning() && m_clock->elapsedNs() < due) cpuRelax();
+            lock.lock();
+            continue;
+        }
+
+        // Due: collect under the lock, call the sink after releasing it, so a
+        // sink that schedules, clears or panics from inside a send cannot
+        // deadlock. m_sendMutex keeps a concurrent panicSilence() from
+        // landing between a collected NOTE_ON and its send.
+        lock.unlock();
+        {
+            std::lock_guard<std::recursive_mutex> sendLock(m_sendMutex);
+            collectDue();
+            // By index, on a copy: a re-entrant panicSilence() clears m_due mid-loop.
+            for (std::size_t i = 0; i < m_due.size(); ++i) {
+                const Event ev = m_due[i];
+                send(ev);
+            }
+            m_due.clear();
+        }
+        lock.lock();
+    }
+}
+
+} // namespace virtuoso::engine
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "virtuoso/engine/IMidiOutputSink.h"
+#include "virtuoso/engine/VirtuosoClock.h"
+
+namespace virtuoso::engine {
+
+// Optional VirtuosoScheduler backend: a dedicated high-priority thread that
+// owns the MIDI event heap and writes straight into an IMidiOutputSink.
+//
+// The thread sleeps until ~kSpinWindowNs before the next deadline, then
+// spin-waits on the monotonic clock, so dispatch accuracy no longer depends
+// on the GUI event loop (repaints, layout, JSON handling).
+// NOTE_ON/NOTE_OFF pairing by noteId matches VirtuosoScheduler exactly.
+class RealtimeDispatcher {
+public:
+    enum class Op : quint8 { NoteOn, NoteOff, AllNotesOff, CC };
+
+    struct Event {
+        qint64 dueNs = 0; // absolute, in clock elapsed ns
+        Op op = Op::NoteOn;
+        quint8 channel = 1; // 1..16
+        quint8 note = 0;
+        quint8 velocity = 0;
+        quint8 cc = 0;
+        quint8 ccValue = 0;
+        quint32 noteId = 0;
+    };
+
+    struct Stats {
+        quint64 dispatched = 0;
+        qint64 maxLateNs = 0; // worst observed (actual - due)
+    };
+
+    // Spin-wait window before each deadline.
+    static constexpr qint64 kSpinWindowNs = 200000;
+
+    RealtimeDispatcher(const VirtuosoClock* clock, IMidiOutputSink* sink);
+    ~RealtimeDispatcher();
+    RealtimeDispatcher(const RealtimeDispatcher&) = delete;
+    RealtimeDispatcher& operator=(const RealtimeDispatcher&) = delete;
+
+    void schedule(const Event& ev);
+    void clear();
+    bool isEmpty() const;
+
+    // Emits NOTE_OFF for every active note and AllNotesOff for channels that
+    // had any, then clears the queue (same contract as VirtuosoScheduler).
+    void panicSilence();
+
+    void setVelocityScale(double s) { m_velocityScale.store(s, std::memory_order_relaxed); }
+    Stats stats() const;
+
+private:
+    void run();
+    // Pops every due event under m_mutex, applies its note bookkeeping and
+    // queues the ones to send in m_due. Caller holds m_sendMutex.
+    void collectDue();
+    bool applyLocked(const Event& ev); // false: nothing to send (stale NOTE_OFF)
+    void send(const Event& ev);        // calls the sink; no lock of ours held
+    static void raiseCurrentThreadPriority();
+
+    const VirtuosoClock* m_clock = nullptr; // not owned
+    IMidiOutputSink* m_sink = nullptr;      // not owned
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<Event> m_heap; // min-heap by dueNs (guarded by m_mutex)
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    // Serializes sink calls between the dispatch thread and panicSilence().
+    // Recursive so a sink may call panicSilence() from inside a send.
+    std::recursive_mutex m_sendMutex;
+    std::vector<Event> m_due; // collected, not yet sent (guarded by m_sendMutex)
+
+    std::atomic<double> m_velocityScale{1.0};
+
+    // Guarded by m_mutex. [channel-1][note]
+    std::array<std::array<bool, 128>, 16> m_active{};
+    std::array<std::array<quint32, 128>, 16> m_activeId{};
+    Stats m_stats;
+};
+
+} // namespace virtuoso::engine
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace virtuoso::engine {
+
+// Hierarchical timing wheel keyed on 1 ms buckets (replaces a binary heap for the scheduler).
+//
+//  - L0: 1024 x 1 ms slots covering the cursor's current 1024 ms page.
+//  - L1:   64 x 1024 ms slots covering the rest of the current 65536 ms super-page.
+//  - Overflow: min-heap for anything further out (pulled in at super-page boundaries).
+//
+// Push and per-ms pop are O(1); occupancy bitmaps let advance() skip idle time without walking every ms.
+// Events with equal dueMs come out in push order (the heap gave no such guarantee).
+// Events that are already late are delivered at the next advance().
+//
+// T must be cheap to copy and expose `qint64 dueMs`.
+template <typename T>
+class TimingWheel {
+public:
+    static constexpr int kL0Bits = 10;
+    static constexpr int kL1Bits = 6;
+    static constexpr qint64 kL0Slots = qint64(1) << kL0Bits;
+    static constexpr qint64 kL1Slots = qint64(1) << kL1Bits;
+    static constexpr qint64 kL0Mask = kL0Slots - 1;
+    static constexpr qint64 kL1Mask = kL1Slots - 1;
+    static constexpr int kPageBits = kL0Bits;            // one L0 rotation
+    static constexpr int kSuperBits = kL0Bits + kL1Bits; // one L1 rotation
+
+    explicit TimingWheel(qint64 startMs = 0) { reset(startMs); }
+
+    void reset(qint64 startMs = 0) {
+        for (auto& b : m_l0) b.clear();
+        for (auto& b : m_l1) b.clear();
+        m_l0Bits.fill(0);
+        m_l1Bits = 0;
+        m_overflow.clear();
+        m_size = 0;
+        m_seq = 0;
+        m_cursor = startMs;
+    }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    void push(const T& ev) {
+        ++m_size;
+        place(ev);
+    }
+
+    // Earliest ms at which advance() will deliver something; -1 if empty.
+    qint64 nextDueMs() const {
+        if (m_size == 0) return -1;
+        const qint64 l0 = nextOccupiedL0(m_cursor);
+        if (l0 >= 0) return l0;
+        if (m_l1Bits != 0) {
+            const int slot = lowestBit(m_l1Bits);
+            qint64 best = m_l1[size_t(slot)].front().dueMs;
+            for (const T& ev : m_l1[size_t(slot)]) best = std::min(best, ev.dueMs);
+            return std::max(best, m_cursor);
+        }
+        return m_overflow.front().ev.dueMs;
+    }
+
+    // Deliver every event with dueMs <= nowMs to fn(const T&), in due order.
+    // fn may push() (including events that are already due; they are delivered in this call).
+    template <typename Fn>
+    void advance(qint64 nowMs, Fn&& fn) {
+        if (nowMs < m_cursor) return;
+        for (;;) {
+            drainSlot(fn);
+            if (m_cursor == nowMs) return;
+            const qint64 next = nextOccupiedL0(m_cursor + 1);
+            if (next >= 0 && next <= nowMs) {
+                m_cursor = next;
+                continue;
+            }
+            if (nowMs <= (m_cursor | kL0Mask)) {
+                m_cursor = nowMs;
+                return;
+            }
+            enterNextPage(nowMs);
+        }
+    }
+
+private:
+    struct OverflowEntry {
+        T ev;
+        quint64 seq; // push order, keeps equal-dueMs events FIFO
+    };
+    static bool overflowLess(const OverflowEntry& a, const OverflowEntry& b) {
+        if (a.ev.dueMs != b.ev.dueMs) return a.ev.dueMs > b.ev.dueMs; // reversed for min-heap behavior
+        return a.seq > b.seq;
+    }
+
+    static int lowestBit(quint64 w) { return __builtin_ctzll(w); }
+
+    void place(const T& ev) {
+        const qint64 t = std::max(ev.dueMs, m_cursor);
+        if ((t >> kPageBits) == (m_cursor >> kPageBits)) {
+            const size_t slot = size_t(t & kL0Mask);
+            m_l0[slot].push_back(ev);
+            m_l0Bits[slot >> 6] |= (quint64(1) << (slot & 63));
+        } else if ((t >> kSuperBits) == (m_cursor >> kSuperBits)) {
+            const size_t slot = size_t((t >> kPageBits) & kL1Mask);
+            m_l1[slot].push_back(ev);
+            m_l1Bits |= (quint64(1) << slot);
+        } else {
+            m_overflow.push_back({ev, m_seq++});
+            std::push_heap(m_overflow.begin(), m_overflow.end(), overflowLess);
+        }
+    }
+
+    template <typename Fn>
+    void drainSlot(Fn& fn) {
+        const size_t slot = size_t(m_cursor & kL0Mask);
+        auto& bucket = m_l0[slot];
+        while (!bucket.empty()) {
+            // Swap out first: fn may push into this same slot while we iterate.
+            m_scratch.clear();
+            m_scratch.swap(bucket);
+            m_l0Bits[slot >> 6] &= ~(quint64(1) << (slot & 63));
+            m_size -= m_scratch.size();
+            for (const T& ev : m_scratch) fn(ev);
+        }
+    }
+
+    // First occupied L0 ms in [fromMs, end of cursor page]; -1 if none.
+    qint64 nextOccupiedL0(qint64 fromMs) const {
+        if ((fromMs >> kPageBits) != (m_cursor >> kPageBits)) return -1;
+        const qint64 pageBase = fromMs & ~kL0Mask;
+        size_t idx = size_t(fromMs & kL0Mask);
+        size_t word = idx >> 6;
+        quint64 bits = m_l0Bits[word] & (~quint64(0) << (idx & 63));
+        for (;;) {
+            if (bits) return pageBase + qint64(word * 64 + size_t(lowestBit(bits)));
+            if (++word >= m_l0Bits.size()) return -1;
+            bits = m_l0Bits[word];
+        }
+    }
+
+    // Called when the current page is exhausted and nowMs lies beyond it.
+    void enterNextPage(qint64 nowMs) {
+        const qint64 nextPage = ((m_cursor >> kPageBits) + 1) << kPageBits;
+        if (m_l1Bits != 0) {
+            m_cursor = nextPage;
+            cascade();
+            return;
+        }
+        // Nothing left in this super-page: jump straight to the overflow head's super-page (or to now).
+        if (m_overflow.empty()) {
+            m_cursor = nowMs;
+            return;
+        }
+        const qint64 superStart = (m_overflow.front().ev.dueMs >> kSuperBits) << kSuperBits;
+        if (superStart > nowMs) {
+            m_cursor = nowMs;
+            return;
+        }
+        m_cursor = superStart;
+        cascade();
+    }
+
+    // m_cursor just moved onto a page boundary: refill L0 (and L1 at super-page boundaries).
+    void cascade() {
+        if ((m_cursor & ((qint64(1) << kSuperBits) - 1)) == 0) {
+            const qint64 super = m_cursor >> kSuperBits;
+            while (!m_overflow.empty() && (m_overflow.front().ev.dueMs >> kSuperBits) <= super) {
+                const T ev = m_overflow.front().ev;
+                std::pop_heap(m_overflow.begin(), m_overflow.end(), overflowLess);
+                m_overflow.pop_back();
+                place(ev);
+            }
+        }
+        const size_t slot = size_t((m_cursor >> kPageBits) & kL1Mask);
+        if (m_l1Bits & (quint64(1) << slot)) {
+            m_l1Bits &= ~(quint64(1) << slot);
+            m_scratch.clear();
+            m_scratch.swap(m_l1[slot]);
+            for (const T& ev : m_scratch) place(ev);
+        }
+    }
+
+    std::array<std::vector<T>, size_t(kL0Slots)> m_l0;
+    std::array<std::vector<T>, size_t(kL1Slots)> m_l1;
+    std::array<quint64, size_t(kL0Slots / 64)> m_l0Bits{};
+    quint64 m_l1Bits = 0;
+    std::vector<OverflowEntry> m_overflow; // min-heap by (dueMs, seq)
+    std::vector<T> m_scratch;
+    size_t m_size = 0;
+    quint64 m_seq = 0;
+    qint64 m_cursor = 0; // every ms before this has been delivered
+};
+
+} // namespace virtuoso::engine
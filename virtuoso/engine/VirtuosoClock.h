@@ -1,21 +1,42 @@
 #pragma once
 
-#include <QElapsedTimer>
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
 
 namespace virtuoso::engine {
 
-// Internal clock authority for Virtuoso (Stage 1: QElapsedTimer, sample-agnostic).
+// Internal clock authority for Virtuoso (monotonic, ns-resolution, sample-agnostic).
+// Reads are lock-free and safe from any thread, so the realtime dispatch
+// thread and the GUI thread share one time base.
 class VirtuosoClock {
 public:
-    void start() { m_timer.restart(); m_running = true; }
-    void stop() { m_running = false; }
-    bool isRunning() const { return m_running; }
-    qint64 elapsedMs() const { return m_running ? m_timer.elapsed() : 0; }
+    static qint64 monotonicNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void start() {
+        m_originNs.store(monotonicNowNs(), std::memory_order_relaxed);
+        m_running.store(true, std::memory_order_release);
+    }
+    void stop() { m_running.store(false, std::memory_order_release); }
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    qint64 elapsedNs() const {
+        return isRunning() ? monotonicNowNs() - m_originNs.load(std::memory_order_relaxed) : 0;
+    }
+    qint64 elapsedMs() const { return elapsedNs() / 1000000; }
+
+    // Absolute monotonic time of an engine-clock ms position (for sleeping until it).
+    qint64 monotonicNsAtMs(qint64 ms) const {
+        return m_originNs.load(std::memory_order_relaxed) + ms * 1000000;
+    }
 
 private:
-    bool m_running = false;
-    QElapsedTimer m_timer;
+    std::atomic<bool> m_running{false};
+    std::atomic<qint64> m_originNs{0};
 };
 
 } // namespace virtuoso::engine
-
@@ -57,6 +57,10 @@ public:
 
     void setInstrumentGrooveProfile(const QString& agent, const groove::InstrumentGrooveProfile& p);
     void setRealtimeVelocityScale(double s);
+    // Route MIDI output through a dedicated realtime dispatch thread into `sink` (not owned) instead of the
+    // noteOn/noteOff/allNotesOff/cc signals. nullptr restores signal dispatch. See VirtuosoScheduler::setRealtimeSink.
+    void setRealtimeOutput(IMidiOutputSink* sink) { m_sched.setRealtimeSink(sink); }
+    bool isRealtimeOutput() const { return m_sched.isRealtime(); }
     void sendCcNow(int channel, int cc, int value);
 
     // PERF: Enable/disable JSON emission. When false, toJsonString() is skipped entirely.
@@ -1,14 +1,31 @@
 #include "virtuoso/engine/VirtuosoScheduler.h"
 
+#include "virtuoso/engine/RealtimeDispatcher.h"
+
 #include <algorithm>
+#include <cmath>
 
 namespace virtuoso::engine {
 
 namespace {
-static bool heapLess(const VirtuosoScheduler::ScheduledEvent& a,
-                     const VirtuosoScheduler::ScheduledEvent& b) {
-    return a.dueMs > b.dueMs; // reversed for min-heap behavior
+
+bool inMidiRange(int v) { return v >= 0 && v <= 127; }
+
+// True when the fields ev.kind sends fit their MIDI ranges, so both dispatch
+// paths can store them as bytes. Out-of-range events are dropped rather than
+// clamped onto a different note, velocity or controller.
+bool hasValidMidiFields(const VirtuosoScheduler::ScheduledEvent& ev) {
+    using Kind = VirtuosoScheduler::Kind;
+    if (ev.kind == Kind::TheoryEventJson) return true;
+    if (ev.channel < 1 || ev.channel > 16) return false;
+    switch (ev.kind) {
+    case Kind::NoteOn:
+    case Kind::NoteOff: return inMidiRange(ev.note) && inMidiRange(ev.velocity);
+    case Kind::CC: return inMidiRange(ev.cc) && inMidiRange(ev.ccValue);
+    default: return true;
+    }
 }
+
 } // namespace
 
 VirtuosoScheduler::VirtuosoScheduler(VirtuosoClock* clock, QObject* parent)
@@ -21,14 +38,37 @@ VirtuosoScheduler::VirtuosoScheduler(VirtuosoClock* clock, QObject* parent)
     for (auto& row : m_activeId) row.fill(0u);
 }
 
+VirtuosoScheduler::~VirtuosoScheduler() = default;
+
+bool VirtuosoScheduler::isEmpty() const {
+    return m_wheel.empty() && (!m_rt || m_rt->isEmpty());
+}
+
+void VirtuosoScheduler::setRealtimeSink(IMidiOutputSink* sink) {
+    if (m_rt) m_rt->panicSilence();
+    m_rt.reset();
+    if (!sink) return;
+    m_rt = std::make_unique<RealtimeDispatcher>(m_clock, sink);
+    m_rt->setVelocityScale(m_velocityScale);
+}
+
+void VirtuosoScheduler::setRealtimeVelocityScale(double s) {
+    m_velocityScale = s;
+    if (m_rt) m_rt->setVelocityScale(s);
+}
+
 void VirtuosoScheduler::clear() {
-    m_heap.clear();
+    m_wheel.reset(0);
+    m_payloads.clear();
+    m_freePayloads.clear();
     m_dispatchTimer.stop();
+    if (m_rt) m_rt->clear();
 }
 
 void VirtuosoScheduler::panicSilence() {
     // Stop any pending dispatches first.
     m_dispatchTimer.stop();
+    if (m_rt) m_rt->panicSilence();
 
     // Emit explicit NOTE_OFF for any active notes (critical for looped articulations in samplers).
     for (int ch = 1; ch <= 16; ++ch) {
@@ -46,81 +86,123 @@ void VirtuosoScheduler::panicSilence() {
         }
     }
 
-    m_heap.clear();
+    m_wheel.reset(0);
+    m_payloads.clear();
+    m_freePayloads.clear();
 }
 
-void VirtuosoScheduler::schedule(const ScheduledEvent& ev) {
-    const bool wasEmpty = m_heap.isEmpty();
-    m_heap.push_back(ev);
-    std::push_heap(m_heap.begin(), m_heap.end(), heapLess);
+quint32 VirtuosoScheduler::storePayload(const QString& json) {
+    if (json.isEmpty()) return 0u;
+    if (!m_freePayloads.isEmpty()) {
+        const quint32 h = m_freePayloads.takeLast();
+        m_payloads[int(h - 1)] = json;
+        return h;
+    }
+    m_payloads.push_back(json);
+    return quint32(m_payloads.size());
+}
 
-    if (!m_clock || !m_clock->isRunning()) return;
+QString VirtuosoScheduler::takePayload(quint32 handle) {
+    if (handle == 0u || int(handle) > m_payloads.size()) return QString();
+    QString out;
+    out.swap(m_payloads[int(handle - 1)]);
+    m_freePayloads.push_back(handle);
+    return out;
+}
 
-    const qint64 now = m_clock->elapsedMs();
-    if (wasEmpty || ev.dueMs <= m_heap.front().dueMs) {
-        const int delay = int(std::max<qint64>(0, m_heap.front().dueMs - now));
-        if (!m_dispatchTimer.isActive() || delay < m_dispatchTimer.remainingTime()) {
-            m_dispatchTimer.start(delay);
+void VirtuosoScheduler::armTimer(qint64 nowMs) {
+    const qint64 nextDue = m_wheel.nextDueMs();
+    if (nextDue < 0) return;
+    const int delay = int(std::max<qint64>(0, nextDue - nowMs));
+    if (!m_dispatchTimer.isActive() || delay < m_dispatchTimer.remainingTime()) {
+        m_dispatchTimer.start(delay);
+    }
+}
+
+void VirtuosoScheduler::schedule(const ScheduledEvent& ev) {
+    if (!hasValidMidiFields(ev)) return;
+    if (m_rt && ev.kind != Kind::TheoryEventJson) {
+        RealtimeDispatcher::Event rt;
+        rt.dueNs = ev.dueMs * 1000000;
+        switch (ev.kind) {
+        case Kind::NoteOn: rt.op = RealtimeDispatcher::Op::NoteOn; break;
+        case Kind::NoteOff: rt.op = RealtimeDispatcher::Op::NoteOff; break;
+        case Kind::AllNotesOff: rt.op = RealtimeDispatcher::Op::AllNotesOff; break;
+        default: rt.op = RealtimeDispatcher::Op::CC; break;
         }
+        rt.channel = quint8(ev.channel);
+        rt.note = quint8(ev.note);
+        rt.velocity = quint8(ev.velocity);
+        rt.cc = quint8(ev.cc);
+        rt.ccValue = quint8(ev.ccValue);
+        rt.noteId = ev.noteId;
+        m_rt->schedule(rt);
+        return;
     }
+
+    WheelEvent w;
+    w.dueMs = ev.dueMs;
+    w.kind = ev.kind;
+    w.channel = quint8(ev.channel);
+    w.note = quint8(ev.note);
+    w.velocity = quint8(ev.velocity);
+    w.noteId = ev.noteId;
+    w.cc = quint8(ev.cc);
+    w.ccValue = quint8(ev.ccValue);
+    if (ev.kind == Kind::TheoryEventJson) w.payload = storePayload(ev.theoryJson);
+    m_wheel.push(w);
+
+    if (!m_clock || !m_clock->isRunning()) return;
+    armTimer(m_clock->elapsedMs());
 }
 
 void VirtuosoScheduler::onDispatch() {
     if (!m_clock || !m_clock->isRunning()) return;
     const qint64 now = m_clock->elapsedMs();
+    m_wheel.advance(now, [this](const WheelEvent& ev) { dispatch(ev); });
+    armTimer(now);
+}
 
-    while (!m_heap.isEmpty()) {
-        const ScheduledEvent& top = m_heap.front();
-        if (top.dueMs > now) break;
-
-        ScheduledEvent ev = top;
-        std::pop_heap(m_heap.begin(), m_heap.end(), heapLess);
-        m_heap.pop_back();
-
-        switch (ev.kind) {
-        case Kind::NoteOn:
-            if (ev.channel >= 1 && ev.channel <= 16 && ev.note >= 0 && ev.note <= 127) {
-                m_active[ev.channel - 1][ev.note] = true;
-                m_activeId[ev.channel - 1][ev.note] = ev.noteId;
-            }
-            {
-                const double s = std::max(0.0, m_velocityScale);
-                const int v = std::max(1, std::min(127, int(std::llround(double(ev.velocity) * s))));
-                emit noteOn(ev.channel, ev.note, v);
-            }
-            break;
-        case Kind::NoteOff:
-            if (ev.channel >= 1 && ev.channel <= 16 && ev.note >= 0 && ev.note <= 127) {
-                // Only emit NOTE_OFF if it matches the currently-active note instance.
-                // This prevents stale NOTE_OFF from choking a retriggered note of the same pitch.
-                if (m_active[ev.channel - 1][ev.note] && m_activeId[ev.channel - 1][ev.note] == ev.noteId) {
-                    m_active[ev.channel - 1][ev.note] = false;
-                    m_activeId[ev.channel - 1][ev.note] = 0u;
-                    emit noteOff(ev.channel, ev.note);
-                }
-                break;
-            }
-            break;
-        case Kind::AllNotesOff:
-            if (ev.channel >= 1 && ev.channel <= 16) {
-                m_active[ev.channel - 1].fill(false);
-                m_activeId[ev.channel - 1].fill(0u);
+void VirtuosoScheduler::dispatch(const WheelEvent& wev) {
+    const int channel = int(wev.channel);
+    const int note = int(wev.note);
+    switch (wev.kind) {
+    case Kind::NoteOn:
+        if (channel >= 1 && channel <= 16 && note >= 0 && note <= 127) {
+            m_active[channel - 1][note] = true;
+            m_activeId[channel - 1][note] = wev.noteId;
+        }
+        {
+            const double s = std::max(0.0, m_velocityScale);
+            const int v = std::max(1, std::min(127, int(std::llround(double(wev.velocity) * s))));
+            emit noteOn(channel, note, v);
+        }
+        break;
+    case Kind::NoteOff:
+        if (channel >= 1 && channel <= 16 && note >= 0 && note <= 127) {
+            // Only emit NOTE_OFF if it matches the currently-active note instance.
+            // This prevents stale NOTE_OFF from choking a retriggered note of the same pitch.
+            if (m_active[channel - 1][note] && m_activeId[channel - 1][note] == wev.noteId) {
+                m_active[channel - 1][note] = false;
+                m_activeId[channel - 1][note] = 0u;
+                emit noteOff(channel, note);
             }
-            emit allNotesOff(ev.channel);
-            break;
-        case Kind::CC: emit cc(ev.channel, ev.cc, ev.ccValue); break;
-        case Kind::TheoryEventJson:
-            if (!ev.theoryJson.isEmpty()) emit theoryEventJson(ev.theoryJson);
-            break;
         }
+        break;
+    case Kind::AllNotesOff:
+        if (channel >= 1 && channel <= 16) {
+            m_active[channel - 1].fill(false);
+            m_activeId[channel - 1].fill(0u);
+        }
+        emit allNotesOff(channel);
+        break;
+    case Kind::CC: emit cc(channel, int(wev.cc), int(wev.ccValue)); break;
+    case Kind::TheoryEventJson: {
+        const QString json = takePayload(wev.payload);
+        if (!json.isEmpty()) emit theoryEventJson(json);
+        break;
     }
-
-    if (!m_heap.isEmpty()) {
-        const qint64 nextDue = m_heap.front().dueMs;
-        const int delay = int(std::max<qint64>(0, nextDue - now));
-        m_dispatchTimer.start(delay);
     }
 }
 
 } // namespace virtuoso::engine
-
@@ -4,17 +4,22 @@
 #include <QTimer>
 #include <QVector>
 #include <array>
+#include <memory>
 
+#include "virtuoso/engine/TimingWheel.h"
 #include "virtuoso/engine/VirtuosoClock.h"
 
 namespace virtuoso::engine {
 
-// Minimal real-time scheduler (single-shot wakeup + min-heap).
+class IMidiOutputSink;
+class RealtimeDispatcher;
+
+// Minimal real-time scheduler (single-shot wakeup + timing wheel).
 // This is infrastructure only: no legacy musician logic.
 class VirtuosoScheduler : public QObject {
     Q_OBJECT
 public:
-    enum class Kind {
+    enum class Kind : quint8 {
         NoteOn,
         NoteOff,
         AllNotesOff,
@@ -41,15 +46,22 @@ public:
     };
 
     explicit VirtuosoScheduler(VirtuosoClock* clock, QObject* parent = nullptr);
+    ~VirtuosoScheduler() override;
 
     void clear();
-    bool isEmpty() const { return m_heap.isEmpty(); }
+    bool isEmpty() const;
+
+    // Realtime mode: when a sink is set, MIDI events (NoteOn/Off, AllNotesOff, CC) are dispatched by a
+    // dedicated high-priority thread straight into the sink instead of via QTimer + signals.
+    // TheoryEventJson stays on the GUI thread. nullptr returns to QTimer mode. Sink is not owned.
+    void setRealtimeSink(IMidiOutputSink* sink);
+    bool isRealtime() const { return m_rt != nullptr; }
 
     void schedule(const ScheduledEvent& ev);
 
     // Real-time output scaling (applied at dispatch time so already-queued events respond immediately).
     // 1.0 = unchanged. Values are clamped to a reasonable range internally by callers.
-    void setRealtimeVelocityScale(double s) { m_velocityScale = s; }
+    void setRealtimeVelocityScale(double s);
 
     // Hard stop: immediately emits NoteOff for any notes that are currently on (tracked internally),
     // then emits AllNotesOff per channel as a safety net, and clears the queue.
@@ -67,8 +79,28 @@ private slots:
     void onDispatch();
 
 private:
+    // Compact POD form of ScheduledEvent held in the wheel; the JSON payload lives in m_payloads.
+    struct WheelEvent {
+        qint64 dueMs = 0;
+        quint32 noteId = 0;
+        quint32 payload = 0; // 1-based index into m_payloads (0 = none)
+        Kind kind = Kind::NoteOn;
+        quint8 channel = 1;
+        quint8 note = 0;
+        quint8 velocity = 0;
+        quint8 cc = 0;
+        quint8 ccValue = 0;
+    };
+
+    void dispatch(const WheelEvent& ev);
+    quint32 storePayload(const QString& json);
+    QString takePayload(quint32 handle);
+    void armTimer(qint64 nowMs);
+
     VirtuosoClock* m_clock = nullptr; // not owned
-    QVector<ScheduledEvent> m_heap;   // min-heap by dueMs
+    TimingWheel<WheelEvent> m_wheel;
+    QVector<QString> m_payloads;    // side table for TheoryEventJson
+    QVector<quint32> m_freePayloads; // recycled m_payloads handles
     QTimer m_dispatchTimer;
 
     double m_velocityScale = 1.0;
@@ -77,6 +109,8 @@ private:
     // [channel-1][note] => on/off
     std::array<std::array<bool, 128>, 16> m_active{};
     std::array<std::array<quint32, 128>, 16> m_activeId{};
+
+    std::unique_ptr<RealtimeDispatcher> m_rt;
 };
 
 } // namespace virtuoso::engine
@@ -1,9 +1,86 @@
 #include "virtuoso/groove/GrooveRegistry.h"
 
+#include "virtuoso/util/RegistryBundle.h"
+
 namespace virtuoso::groove {
+namespace {
+
+// Field order of the bundle's groove section, shared by the writer and the reader.
+// Bump RegistryBundle::kFormatVersion when changing it.
+template <typename A, typename D>
+void feelFields(A& a, D& t) {
+    a.io(t.key);
+    a.io(t.name);
+    a.io(t.kind);
+    a.io(t.amount);
+    a.io(t.pocketMs);
+}
+
+template <typename A, typename D>
+void templateFields(A& a, D& t) {
+    a.io(t.key);
+    a.io(t.name);
+    a.io(t.category);
+    a.io(t.gridKind);
+    a.io(t.amount);
+    a.list(t.offsetMap, [](auto& a2, auto& o) {
+        a2.io(o.withinBeat.num);
+        a2.io(o.withinBeat.den);
+        a2.io(o.unit);
+        a2.io(o.value);
+    });
+}
+
+template <typename A, typename D>
+void profileFields(A& a, D& p) {
+    a.io(p.instrument);
+    a.io(p.pushMs);
+    a.io(p.laidBackMs);
+    a.io(p.microJitterMs);
+    a.io(p.attackVarianceMs);
+    a.io(p.driftMaxMs);
+    a.io(p.driftRate);
+    a.io(p.velocityJitter);
+    a.io(p.accentDownbeat);
+    a.io(p.accentBackbeat);
+    a.io(p.humanizeSeed);
+    a.io(p.clampMsStructural);
+    a.io(p.clampMsLoose);
+    a.io(p.phraseBars);
+    a.io(p.phraseTimingMaxMs);
+    a.io(p.phraseVelocityMax);
+}
+
+template <typename A, typename D>
+void presetFields(A& a, D& p) {
+    a.io(p.key);
+    a.io(p.name);
+    a.io(p.grooveTemplateKey);
+    a.io(p.templateAmount);
+    a.map(p.instrumentProfiles, [](auto& a2, auto& prof) { profileFields(a2, prof); });
+    a.map(p.articulationNotes, [](auto& a2, auto& note) { a2.io(note); });
+    a.io(p.defaultBpm);
+    a.io(p.defaultTimeSig.num);
+    a.io(p.defaultTimeSig.den);
+    auto& w = p.weightsV2Defaults;
+    a.io(w.density);
+    a.io(w.rhythm);
+    a.io(w.emotion);
+    a.io(w.intensity);
+    a.io(w.dynamism);
+    a.io(w.creativity);
+    a.io(w.tension);
+    a.io(w.interactivity);
+    a.io(w.variability);
+    a.io(w.warmth);
+}
+
+} // namespace
 
 GrooveRegistry GrooveRegistry::builtins() {
     GrooveRegistry r;
+    QHash<QString, GrooveTemplate> templates;
+    QVector<QString> templateOrder;
 
     auto addFeel = [&](const FeelTemplate& t, int order) {
         r.m_feels.insert(t.key, t);
@@ -12,9 +89,9 @@ GrooveRegistry GrooveRegistry::builtins() {
     };
 
     auto addTemplate = [&](const GrooveTemplate& t, int order) {
-        r.m_templates.insert(t.key, t);
-        if (r.m_templateOrder.size() <= order) r.m_templateOrder.resize(order + 1);
-        r.m_templateOrder[order] = t.key;
+        templates.insert(t.key, t);
+        if (templateOrder.size() <= order) templateOrder.resize(order + 1);
+        templateOrder[order] = t.key;
     };
 
     auto addPreset = [&](const StylePreset& p, int order) {
@@ -854,12 +931,12 @@ GrooveRegistry GrooveRegistry::builtins() {
     }
     r.m_feelOrder = compact;
 
-    QVector<QString> compactT;
-    compactT.reserve(r.m_templateOrder.size());
-    for (const auto& k : r.m_templateOrder) {
-        if (!k.trimmed().isEmpty() && r.m_templates.contains(k)) compactT.push_back(k);
+    r.m_templates = util::InternedTable<GrooveTemplate>::fromHash(std::move(templates));
+    r.m_templateOrder.reserve(templateOrder.size());
+    for (const auto& k : templateOrder) {
+        const int id = k.trimmed().isEmpty() ? -1 : r.m_templates.idOf(k);
+        if (id >= 0) r.m_templateOrder.push_back(id);
     }
-    r.m_templateOrder = compactT;
 
     QVector<QString> compactP;
     compactP.reserve(r.m_presetOrder.size());
@@ -871,6 +948,45 @@ GrooveRegistry GrooveRegistry::builtins() {
     return r;
 }
 
+void GrooveRegistry::writeBundle(util::BundleWriter& w) const {
+    w.beginSection(util::BundleSection::Groove);
+    w.map(m_feels, [](auto& a, const FeelTemplate& t) { feelFields(a, t); });
+    w.io(m_feelOrder);
+    w.list(m_templates.items(), [](auto& a, const GrooveTemplate& t) { templateFields(a, t); });
+    w.io(m_templateOrder);
+    w.map(m_presets, [](auto& a, const StylePreset& p) { presetFields(a, p); });
+    w.io(m_presetOrder);
+}
+
+bool GrooveRegistry::fromBundle(const util::RegistryBundle& bundle, GrooveRegistry& out) {
+    util::BundleReader r = bundle.section(util::BundleSection::Groove);
+    GrooveRegistry reg;
+    r.map(reg.m_feels, [](auto& a, FeelTemplate& t) { feelFields(a, t); });
+    r.io(reg.m_feelOrder);
+    QVector<GrooveTemplate> templates;
+    r.list(templates, [](auto& a, GrooveTemplate& t) { templateFields(a, t); });
+    r.io(reg.m_templateOrder);
+    r.map(reg.m_presets, [](auto& a, StylePreset& p) { presetFields(a, p); });
+    r.io(reg.m_presetOrder);
+    if (!r.ok() || !r.atEnd() || !reg.m_templates.assign(std::move(templates))) return false;
+    for (int id : reg.m_templateOrder) {
+        if (!reg.m_templates.byId(id)) return false;
+    }
+    out = std::move(reg);
+    return true;
+}
+
+GrooveRegistry GrooveRegistry::precompiled() {
+    GrooveRegistry r;
+    if (const auto* bundle = util::RegistryBundle::embedded(); bundle && fromBundle(*bundle, r)) return r;
+    return builtins();
+}
+
+const GrooveRegistry& GrooveRegistry::shared() {
+    static const GrooveRegistry registry = precompiled();
+    return registry;
+}
+
 const FeelTemplate* GrooveRegistry::feel(const QString& key) const {
     auto it = m_feels.find(key);
     if (it == m_feels.end()) return nullptr;
@@ -887,19 +1003,10 @@ QVector<const FeelTemplate*> GrooveRegistry::allFeels() const {
     return out;
 }
 
-const GrooveTemplate* GrooveRegistry::grooveTemplate(const QString& key) const {
-    auto it = m_templates.find(key);
-    if (it == m_templates.end()) return nullptr;
-    return &it.value();
-}
-
 QVector<const GrooveTemplate*> GrooveRegistry::allGrooveTemplates() const {
     QVector<const GrooveTemplate*> out;
     out.reserve(m_templateOrder.size());
-    for (const QString& k : m_templateOrder) {
-        auto it = m_templates.find(k);
-        if (it != m_templates.end()) out.push_back(&it.value());
-    }
+    for (int id : m_templateOrder) out.push_back(m_templates.byId(id));
     return out;
 }
 
@@ -8,6 +8,12 @@
 #include "virtuoso/groove/GrooveTemplate.h"
 #include "virtuoso/groove/TimingHumanizer.h"
 #include "virtuoso/control/PerformanceWeightsV2.h"
+#include "virtuoso/util/InternedTable.h"
+
+namespace virtuoso::util {
+class BundleWriter;
+class RegistryBundle;
+} // namespace virtuoso::util
 
 namespace virtuoso::groove {
 
@@ -26,12 +32,25 @@ class GrooveRegistry {
 public:
     static GrooveRegistry builtins();
 
+    // Precompiled tables (virtuoso/util/RegistryBundle.h).
+    void writeBundle(util::BundleWriter& w) const;
+    // False, leaving out untouched, when the bundle has no usable groove section.
+    static bool fromBundle(const util::RegistryBundle& bundle, GrooveRegistry& out);
+    // The embedded bundle's tables when the app has one, builtins() otherwise.
+    static GrooveRegistry precompiled();
+    // One immutable precompiled() registry per process, built on first use (thread-safe).
+    static const GrooveRegistry& shared();
+
     const FeelTemplate* feel(const QString& key) const;
     QVector<const FeelTemplate*> allFeels() const; // stable ordering
 
     // New: GrooveTemplates (richer feel vocabulary)
-    const GrooveTemplate* grooveTemplate(const QString& key) const;
+    const GrooveTemplate* grooveTemplate(const QString& key) const { return m_templates.find(key); }
     QVector<const GrooveTemplate*> allGrooveTemplates() const; // stable ordering
+    // Dense ids (0..count-1, in key order; -1 when absent), resolved once per style preset.
+    int grooveTemplateId(QStringView key) const { return m_templates.idOf(key); }
+    const GrooveTemplate* grooveTemplateById(int id) const { return m_templates.byId(id); }
+    int grooveTemplateCount() const { return m_templates.size(); }
 
     // Jazz-only initial style preset vocabulary (expands over time).
     struct StylePreset {
@@ -57,8 +76,8 @@ private:
     QHash<QString, FeelTemplate> m_feels;
     QVector<QString> m_feelOrder;
 
-    QHash<QString, GrooveTemplate> m_templates;
-    QVector<QString> m_templateOrder;
+    util::InternedTable<GrooveTemplate> m_templates;
+    QVector<int> m_templateOrder; // ids, UI order
 
     QHash<QString, StylePreset> m_presets;
     QVector<QString> m_presetOrder;
@@ -48,6 +48,8 @@ struct GrooveTemplate {
 
     QVector<OffsetPoint> offsetMap;
 
+    int id = -1; // dense id in the owning registry (GrooveRegistry::grooveTemplateById)
+
     // Compute template-only offset in ms for the given grid position.
     // This does NOT include per-instrument push/jitter/drift.
     int offsetMsFor(const GridPos& pos, const TimeSignature& ts, int bpm) const;
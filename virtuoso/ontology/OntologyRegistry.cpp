@@ -1,12 +1,60 @@
 #include "virtuoso/ontology/OntologyRegistry.h"
 
+#include "virtuoso/util/RegistryBundle.h"
+
 namespace virtuoso::ontology {
 namespace {
-// (intentionally empty) helper namespace reserved for future ontology utilities
+
+// Field order of the bundle's ontology section, shared by the writer and the reader.
+// Bump RegistryBundle::kFormatVersion when changing it.
+template <typename A, typename D>
+void chordFields(A& a, D& d) {
+    a.io(d.key);
+    a.io(d.name);
+    a.io(d.intervals);
+    a.io(d.tags);
+    a.io(d.order);
+    a.io(d.bassInterval);
+}
+
+template <typename A, typename D>
+void scaleFields(A& a, D& d) {
+    a.io(d.key);
+    a.io(d.name);
+    a.io(d.intervals);
+    a.io(d.tags);
+    a.io(d.order);
+}
+
+template <typename A, typename D>
+void voicingFields(A& a, D& d) {
+    a.io(d.key);
+    a.io(d.instrument);
+    a.io(d.name);
+    a.io(d.category);
+    a.io(d.formula);
+    a.io(d.chordDegrees);
+    a.io(d.intervals);
+    a.io(d.tags);
+    a.io(d.order);
+}
+
+template <typename A, typename D>
+void polychordFields(A& a, D& d) {
+    a.io(d.key);
+    a.io(d.name);
+    a.io(d.formula);
+    a.io(d.tags);
+    a.io(d.order);
+}
+
 } // namespace
 
 OntologyRegistry OntologyRegistry::builtins() {
     OntologyRegistry r;
+    QHash<Key, ChordDef> chords;
+    QHash<Key, ScaleDef> scales;
+    QHash<Key, VoicingDef> voicings;
 
     // --- Chord primitives (subset, extensible) ---
     auto addChord = [&](QString key, QString name, QVector<int> iv, QStringList tags, int order, int bassInterval = -1) {
@@ -17,7 +65,7 @@ OntologyRegistry OntologyRegistry::builtins() {
         d.tags = std::move(tags);
         d.order = order;
         d.bassInterval = bassInterval;
-        r.m_chords.insert(d.key, d);
+        chords.insert(d.key, d);
     };
 
     // Chord ordering requested: Maj, Maj7, 7, Sus2, Sus4, Min, Min7, m7b5, dim7, aug, 5
@@ -133,7 +181,7 @@ OntologyRegistry OntologyRegistry::builtins() {
         s.intervals = std::move(iv);
         s.tags = std::move(tags);
         s.order = order;
-        r.m_scales.insert(s.key, s);
+        scales.insert(s.key, s);
     };
 
     // Diatonic modes (requested order)
@@ -243,7 +291,7 @@ OntologyRegistry OntologyRegistry::builtins() {
         v.intervals = std::move(intervals);
         v.tags = std::move(tags);
         v.order = order;
-        r.m_voicings.insert(v.key, v);
+        voicings.insert(v.key, v);
     };
 
     addVoicing2("piano_shell_1_7", InstrumentKind::Piano, "Shell (1-7)", "Shell", "1-7", {1, 7}, {}, {"piano","shell"}, 0);
@@ -335,31 +383,55 @@ OntologyRegistry OntologyRegistry::builtins() {
     addPoly("triad_over_bass", "Triad over Bass (D/C)", "UpperTriad / Bass", {"polychord","slash"}, 0);
     addPoly("triad_over_chord", "Triad over Chord (D over Cmaj7#11)", "UpperTriad over LowerChord", {"polychord","stack"}, 1);
 
+    r.m_chords = util::InternedTable<ChordDef>::fromHash(std::move(chords));
+    r.m_scales = util::InternedTable<ScaleDef>::fromHash(std::move(scales));
+    r.m_voicings = util::InternedTable<VoicingDef>::fromHash(std::move(voicings));
     return r;
 }
 
-const ChordDef* OntologyRegistry::chord(const Key& key) const {
-    auto it = m_chords.find(key);
-    if (it == m_chords.end()) return nullptr;
-    return &it.value();
+void OntologyRegistry::writeBundle(util::BundleWriter& w) const {
+    w.beginSection(util::BundleSection::Ontology);
+    // In id (key) order; ids are not stored, the reader renumbers.
+    w.list(m_chords.items(), [](auto& a, const ChordDef& d) { chordFields(a, d); });
+    w.list(m_scales.items(), [](auto& a, const ScaleDef& d) { scaleFields(a, d); });
+    w.list(m_voicings.items(), [](auto& a, const VoicingDef& d) { voicingFields(a, d); });
+    w.map(m_polychords, [](auto& a, const PolychordTemplate& d) { polychordFields(a, d); });
 }
 
-const ScaleDef* OntologyRegistry::scale(const Key& key) const {
-    auto it = m_scales.find(key);
-    if (it == m_scales.end()) return nullptr;
-    return &it.value();
+bool OntologyRegistry::fromBundle(const util::RegistryBundle& bundle, OntologyRegistry& out) {
+    util::BundleReader r = bundle.section(util::BundleSection::Ontology);
+    OntologyRegistry reg;
+    QVector<ChordDef> chords;
+    QVector<ScaleDef> scales;
+    QVector<VoicingDef> voicings;
+    r.list(chords, [](auto& a, ChordDef& d) { chordFields(a, d); });
+    r.list(scales, [](auto& a, ScaleDef& d) { scaleFields(a, d); });
+    r.list(voicings, [](auto& a, VoicingDef& d) { voicingFields(a, d); });
+    r.map(reg.m_polychords, [](auto& a, PolychordTemplate& d) { polychordFields(a, d); });
+    if (!r.ok() || !r.atEnd()) return false;
+    if (!reg.m_chords.assign(std::move(chords)) || !reg.m_scales.assign(std::move(scales)) ||
+        !reg.m_voicings.assign(std::move(voicings))) {
+        return false;
+    }
+    out = std::move(reg);
+    return true;
 }
 
-const VoicingDef* OntologyRegistry::voicing(const Key& key) const {
-    auto it = m_voicings.find(key);
-    if (it == m_voicings.end()) return nullptr;
-    return &it.value();
+OntologyRegistry OntologyRegistry::precompiled() {
+    OntologyRegistry r;
+    if (const auto* bundle = util::RegistryBundle::embedded(); bundle && fromBundle(*bundle, r)) return r;
+    return builtins();
+}
+
+const OntologyRegistry& OntologyRegistry::shared() {
+    static const OntologyRegistry registry = precompiled();
+    return registry;
 }
 
 QVector<const ChordDef*> OntologyRegistry::chordsWithTag(const QString& tag) const {
     QVector<const ChordDef*> out;
     out.reserve(m_chords.size());
-    for (const ChordDef& v : m_chords) {
+    for (const ChordDef& v : m_chords.items()) {
         if (v.tags.contains(tag)) out.push_back(&v);
     }
     return out;
@@ -368,7 +440,7 @@ QVector<const ChordDef*> OntologyRegistry::chordsWithTag(const QString& tag) con
 QVector<const ScaleDef*> OntologyRegistry::scalesWithTag(const QString& tag) const {
     QVector<const ScaleDef*> out;
     out.reserve(m_scales.size());
-    for (const ScaleDef& v : m_scales) {
+    for (const ScaleDef& v : m_scales.items()) {
         if (v.tags.contains(tag)) out.push_back(&v);
     }
     return out;
@@ -377,7 +449,7 @@ QVector<const ScaleDef*> OntologyRegistry::scalesWithTag(const QString& tag) con
 QVector<const VoicingDef*> OntologyRegistry::voicingsFor(InstrumentKind instrument) const {
     QVector<const VoicingDef*> out;
     out.reserve(m_voicings.size());
-    for (const VoicingDef& v : m_voicings) {
+    for (const VoicingDef& v : m_voicings.items()) {
         if (v.instrument == instrument) out.push_back(&v);
     }
     return out;
@@ -386,21 +458,21 @@ QVector<const VoicingDef*> OntologyRegistry::voicingsFor(InstrumentKind instrume
 QVector<const ChordDef*> OntologyRegistry::allChords() const {
     QVector<const ChordDef*> out;
     out.reserve(m_chords.size());
-    for (const ChordDef& v : m_chords) out.push_back(&v);
+    for (const ChordDef& v : m_chords.items()) out.push_back(&v);
     return out;
 }
 
 QVector<const ScaleDef*> OntologyRegistry::allScales() const {
     QVector<const ScaleDef*> out;
     out.reserve(m_scales.size());
-    for (const ScaleDef& v : m_scales) out.push_back(&v);
+    for (const ScaleDef& v : m_scales.items()) out.push_back(&v);
     return out;
 }
 
 QVector<const VoicingDef*> OntologyRegistry::allVoicings() const {
     QVector<const VoicingDef*> out;
     out.reserve(m_voicings.size());
-    for (const VoicingDef& v : m_voicings) out.push_back(&v);
+    for (const VoicingDef& v : m_voicings.items()) out.push_back(&v);
     return out;
 }
 
@@ -2,9 +2,17 @@
 
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 #include <QVector>
 #include <QHash>
 
+#include "virtuoso/util/InternedTable.h"
+
+namespace virtuoso::util {
+class BundleWriter;
+class RegistryBundle;
+} // namespace virtuoso::util
+
 namespace virtuoso::ontology {
 
 enum class InstrumentKind {
@@ -25,6 +33,7 @@ struct ChordDef {
     QStringList tags;           // e.g. "triad", "seventh", "shell"
     int order = 1000;           // stable UI ordering
     int bassInterval = -1;      // optional slash-bass/inversion bass note (semitones from root)
+    int id = -1;                // dense id in the owning registry (OntologyRegistry::chordById)
 };
 
 struct ScaleDef {
@@ -33,6 +42,7 @@ struct ScaleDef {
     QVector<int> intervals; // semitone offsets from tonic
     QStringList tags;       // e.g. "diatonic", "symmetric"
     int order = 1000;       // stable UI ordering
+    int id = -1;            // dense id in the owning registry (OntologyRegistry::scaleById)
 };
 
 struct VoicingDef {
@@ -45,6 +55,7 @@ struct VoicingDef {
     QVector<int> intervals;    // optional alternative: absolute semitone offsets from root (0..)
     QStringList tags;       // e.g. "piano", "rootless"
     int order = 1000;       // stable UI ordering
+    int id = -1;            // dense id in the owning registry (OntologyRegistry::voicingById)
 };
 
 struct PolychordTemplate {
@@ -61,9 +72,34 @@ class OntologyRegistry {
 public:
     static OntologyRegistry builtins();
 
-    const ChordDef* chord(const Key& key) const;
-    const ScaleDef* scale(const Key& key) const;
-    const VoicingDef* voicing(const Key& key) const;
+    // Precompiled tables (virtuoso/util/RegistryBundle.h).
+    void writeBundle(util::BundleWriter& w) const;
+    // False, leaving out untouched, when the bundle has no usable ontology section.
+    static bool fromBundle(const util::RegistryBundle& bundle, OntologyRegistry& out);
+    // The embedded bundle's tables when the app has one, builtins() otherwise.
+    static OntologyRegistry precompiled();
+    // One immutable precompiled() registry per process, built on first use (thread-safe).
+    // The engine and the windows share it instead of each holding a copy.
+    static const OntologyRegistry& shared();
+
+    const ChordDef* chord(const Key& key) const { return chord(QStringView(key)); }
+    const ScaleDef* scale(const Key& key) const { return scale(QStringView(key)); }
+    const VoicingDef* voicing(const Key& key) const { return voicing(QStringView(key)); }
+    const ChordDef* chord(QStringView key) const { return m_chords.find(key); }
+    const ScaleDef* scale(QStringView key) const { return m_scales.find(key); }
+    const VoicingDef* voicing(QStringView key) const { return m_voicings.find(key); }
+
+    // Dense ids (0..count-1, in key order; -1 when absent). Resolve keys at the chart/UI
+    // boundary and index by id on hot paths.
+    int chordId(QStringView key) const { return m_chords.idOf(key); }
+    int scaleId(QStringView key) const { return m_scales.idOf(key); }
+    int voicingId(QStringView key) const { return m_voicings.idOf(key); }
+    const ChordDef* chordById(int id) const { return m_chords.byId(id); }
+    const ScaleDef* scaleById(int id) const { return m_scales.byId(id); }
+    const VoicingDef* voicingById(int id) const { return m_voicings.byId(id); }
+    int chordCount() const { return m_chords.size(); }
+    int scaleCount() const { return m_scales.size(); }
+    int voicingCount() const { return m_voicings.size(); }
 
     QVector<const ChordDef*> chordsWithTag(const QString& tag) const;
     QVector<const ScaleDef*> scalesWithTag(const QString& tag) const;
@@ -77,9 +113,9 @@ public:
     const PolychordTemplate* polychordTemplate(const Key& key) const;
 
 private:
-    QHash<Key, ChordDef> m_chords;
-    QHash<Key, ScaleDef> m_scales;
-    QHash<Key, VoicingDef> m_voicings;
+    util::InternedTable<ChordDef> m_chords;
+    util::InternedTable<ScaleDef> m_scales;
+    util::InternedTable<VoicingDef> m_voicings;
     QHash<Key, PolychordTemplate> m_polychords;
 };
 
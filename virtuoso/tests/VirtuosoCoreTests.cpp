@@ -12,12 +12,22 @@
 #include "virtuoso/groove/TimingHumanizer.h"
 #include "virtuoso/drums/FluffyAudioJazzDrumsBrushesMapping.h"
 #include "virtuoso/bass/AmpleBassUprightMapping.h"
+#include "virtuoso/engine/TimingWheel.h"
+#include "virtuoso/engine/RealtimeDispatcher.h"
+#include "virtuoso/util/StableHash.h"
 
 #include <QCoreApplication>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QStringList>
 #include <QtGlobal>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 using virtuoso::ontology::OntologyRegistry;
 using virtuoso::ontology::InstrumentKind;
 
@@ -423,6 +433,143 @@ static void testFunctionalHarmony() {
     }
 }
 
+static void testTimingWheelOrdering() {
+    struct Ev {
+        qint64 dueMs;
+        int seq;
+    };
+    virtuoso::engine::TimingWheel<Ev> wheel;
+    std::vector<Ev> expected;
+
+    // Deterministic spread across L0 (<1s), L1 (<65s) and the overflow heap (>65s),
+    // with deliberate dueMs collisions to check FIFO order within a millisecond.
+    quint32 x = 12345u;
+    for (int i = 0; i < 5000; ++i) {
+        x = x * 1664525u + 1013904223u;
+        const qint64 range = (i % 3 == 0) ? 900 : (i % 3 == 1) ? 60000 : 400000;
+        const Ev ev{qint64(x % quint32(range)) / 7 * 7, i};
+        wheel.push(ev);
+        expected.push_back(ev);
+    }
+    std::stable_sort(expected.begin(), expected.end(), [](const Ev& a, const Ev& b) { return a.dueMs < b.dueMs; });
+    expectEq(int(wheel.nextDueMs()), int(expected.front().dueMs), "TimingWheel nextDueMs is the earliest event");
+
+    std::vector<Ev> got;
+    for (qint64 now = 0; now <= 400000; now += 13) {
+        wheel.advance(now, [&](const Ev& ev) {
+            expect(ev.dueMs <= now, "TimingWheel never delivers early");
+            got.push_back(ev);
+        });
+    }
+    expectEq(int(got.size()), int(expected.size()), "TimingWheel delivers every event");
+    bool sameOrder = got.size() == expected.size();
+    for (size_t i = 0; sameOrder && i < got.size(); ++i) sameOrder = got[i].seq == expected[i].seq;
+    expect(sameOrder, "TimingWheel delivery matches stable (dueMs, push order)");
+    expect(wheel.empty() && wheel.nextDueMs() < 0, "TimingWheel empty after drain");
+
+    // Late events are delivered on the next advance.
+    wheel.push({100, -1});
+    int late = 0;
+    wheel.advance(400000, [&](const Ev&) { ++late; });
+    expectEq(late, 1, "TimingWheel delivers late events immediately");
+}
+
+static void testRealtimeDispatcherReentrantSink() {
+    using virtuoso::engine::RealtimeDispatcher;
+
+    // A sink that schedules the release of each note it plays, from inside the send.
+    struct ReleasingSink : virtuoso::engine::IMidiOutputSink {
+        RealtimeDispatcher* dispatcher = nullptr;
+        const virtuoso::engine::VirtuosoClock* clock = nullptr;
+        std::atomic<int> ons{0};
+        std::atomic<int> offs{0};
+        void sendNoteOn(int channel, int note, int) override {
+            ++ons;
+            RealtimeDispatcher::Event off;
+            off.dueNs = clock->elapsedNs();
+            off.op = RealtimeDispatcher::Op::NoteOff;
+            off.channel = quint8(channel);
+            off.note = quint8(note);
+            off.noteId = 7;
+            dispatcher->schedule(off);
+            (void)dispatcher->isEmpty();
+        }
+        void sendNoteOff(int, int) override { ++offs; }
+        void sendAllNotesOff(int) override {}
+        void sendCC(int, int, int) override {}
+    };
+
+    virtuoso::engine::VirtuosoClock clock;
+    clock.start();
+    ReleasingSink sink;
+    RealtimeDispatcher dispatcher(&clock, &sink);
+    sink.dispatcher = &dispatcher;
+    sink.clock = &clock;
+
+    RealtimeDispatcher::Event on;
+    on.dueNs = clock.elapsedNs() + 1000000;
+    on.op = RealtimeDispatcher::Op::NoteOn;
+    on.channel = 3;
+    on.note = 60;
+    on.velocity = 90;
+    on.noteId = 7;
+    dispatcher.schedule(on);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (sink.offs.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    expectEq(sink.ons.load(), 1, "RealtimeDispatcher sends the note-on");
+    expectEq(sink.offs.load(), 1, "RealtimeDispatcher: a sink may schedule from inside a send");
+    expect(dispatcher.isEmpty(), "RealtimeDispatcher drains the re-entrant release");
+}
+
+static void testStableHashBuilderMatchesArgFormatting() {
+    using virtuoso::util::StableHash;
+    static_assert(StableHash::Builder().ascii("foobar").value() == 0xbf9cf968u, "FNV-1a 32 test vector");
+    static_assert(StableHash::Builder().decimal(-42).value() == StableHash::Builder().ascii("-42").value(),
+                  "decimal() is constexpr");
+    expect(StableHash::Builder().word(StableHash::kHashVersion).word(0x12345678u).word(42u).value() ==
+               StableHash::mix(0x12345678u, 42u),
+           "StableHash::Builder: word() matches mix()");
+
+    auto formatted = [](const QString& s) { return StableHash::fnv1a32(s.toUtf8()); };
+    int mismatches = 0;
+    auto check = [&](quint32 got, quint32 want, const QString& what) {
+        if (got != want && mismatches++ < 5) qWarning().noquote() << "StableHash::ArgFormat mismatch:" << what;
+    };
+
+    // Non-ASCII, a surrogate pair, a lone surrogate, and '%' sequences a later arg() substitutes.
+    const QStringList texts = {"", "Cmaj7", "F#m7b5", QString::fromUtf8("B\xE2\x99\xAD" "maj7"),
+                               QString::fromUtf8("\xC3\xA9t\xC3\xA9"), QString::fromUtf8("\xF0\x9F\x8E\xB5"),
+                               QString(QChar(0xDC00)) + "x", "%2", "100%", "%1%3"};
+    const QList<qlonglong> numbers = {0, 7, -1, 2147483647LL, -2147483647LL - 1, 4294967295LL};
+    for (const QString& t : texts) {
+        for (const qlonglong n : numbers) {
+            const int i = int(n);
+            const quint32 u = quint32(n);
+            check(StableHash::ArgFormat("%1|piano|%2|%3|%4|%5|%6").arg(t).arg(i).arg(3).arg(int(n < 0)).arg(t).arg(u).value(),
+                  formatted(QString("%1|piano|%2|%3|%4|%5|%6").arg(t).arg(i).arg(3).arg(int(n < 0)).arg(t).arg(u)),
+                  "vocab format " + t);
+            check(StableHash::ArgFormat("drums_phrase|%1|%2|%3").arg(n).arg(qulonglong(u)).arg(t).value(),
+                  formatted(QString("drums_phrase|%1|%2|%3").arg(n).arg(qulonglong(u)).arg(t)),
+                  "64-bit arguments " + t);
+            // Formats the streaming path hands to QString::arg().
+            check(StableHash::ArgFormat("%2|%1").arg(t).arg(i).value(), formatted(QString("%2|%1").arg(t).arg(i)),
+                  "out-of-order placeholders " + t);
+            check(StableHash::ArgFormat("%1|%1|%2").arg(i).arg(t).value(), formatted(QString("%1|%1|%2").arg(i).arg(t)),
+                  "repeated placeholder " + t);
+            check(StableHash::ArgFormat("50%|%1").arg(t).value(), formatted(QString("50%|%1").arg(t)),
+                  "literal percent " + t);
+            // Fewer arguments than placeholders: the rest stays literal.
+            check(StableHash::ArgFormat("%1|%2|%3").arg(t).value(), formatted(QString("%1|%2|%3").arg(t)),
+                  "unfilled placeholders " + t);
+        }
+        check(StableHash::Builder().ascii("ballad|").utf8(t).value(), formatted(QString("ballad|") + t), "utf8() " + t);
+    }
+    expectEq(mismatches, 0, "StableHash::ArgFormat hashes the bytes QString::arg() formats");
+}
+
 int main(int argc, char** argv) {
     QCoreApplication app(argc, argv);
 
@@ -441,6 +588,9 @@ int main(int argc, char** argv) {
     testNegativeHarmony();
     testScaleSuggester();
     testFunctionalHarmony();
+    testTimingWheelOrdering();
+    testRealtimeDispatcherReentrantSink();
+    testStableHashBuilderMatchesArgFormatting();
 
     if (g_failures == 0) {
         qInfo("VirtuosoCoreTests: PASS");
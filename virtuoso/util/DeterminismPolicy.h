@@ -10,6 +10,8 @@
 // 2) Do not use Qt RNGs (QRandomGenerator) in decision-making or timing humanization.
 // 3) Derive all seeds via StableHash::fnv1a32() from a namespaced string:
 //    seed = fnv1a32("domain|agent|preset|bar|beat|...".toUtf8()).
+//    In planning loops, hash the same bytes without formatting them:
+//    seed = StableHash::ArgFormat("domain|%1|%2").arg(agent).arg(bar).value().
 // 4) Planning code must not call wall-clock APIs directly. If it needs \"now\",
 //    accept it as an input (e.g., LookaheadPlanner::Inputs.nowMs).
 //
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+#include <algorithm>
+
+namespace virtuoso::util {
+
+// Immutable keyed table with dense integer ids, for the registries' definition tables.
+// Values are stored sorted by key and a value's id is its index (also written to T::id), so
+// the same definitions get the same ids whether built in code or loaded from a bundle.
+// Resolve a key once where strings come in (chart parse, UI, load) and index by id after
+// that. Key lookups are a binary search over QStringView: a literal such as u"maj7" resolves
+// without building a QString.
+//
+// T needs a QString `key` and an int `id`.
+template <typename T>
+class InternedTable {
+public:
+    InternedTable() = default;
+
+    static InternedTable fromHash(QHash<QString, T> byKey) {
+        QList<QString> keys = byKey.keys();
+        std::sort(keys.begin(), keys.end());
+        InternedTable t;
+        t.m_items.reserve(keys.size());
+        for (const QString& k : keys) t.m_items.push_back(std::move(byKey[k]));
+        t.numberItems();
+        return t;
+    }
+
+    // False, leaving the table untouched, unless keys are strictly increasing (as items()
+    // hands them out).
+    bool assign(QVector<T> sorted) {
+        for (qsizetype i = 1; i < sorted.size(); ++i) {
+            if (!(sorted[i - 1].key < sorted[i].key)) return false;
+        }
+        m_items = std::move(sorted);
+        numberItems();
+        return true;
+    }
+
+    int size() const { return int(m_items.size()); }
+    bool isEmpty() const { return m_items.isEmpty(); }
+    const QVector<T>& items() const { return m_items; }
+
+    // -1 when absent.
+    int idOf(QStringView key) const {
+        const auto it = std::lower_bound(m_items.cbegin(), m_items.cend(), key, [](const T& v, QStringView k) {
+            return QStringView(v.key).compare(k) < 0;
+        });
+        if (it == m_items.cend() || QStringView(it->key).compare(key) != 0) return -1;
+        return int(it - m_items.cbegin());
+    }
+    const T* byId(int id) const { return (id >= 0 && id < m_items.size()) ? &m_items[id] : nullptr; }
+    const T* find(QStringView key) const { return byId(idOf(key)); }
+
+private:
+    void numberItems() {
+        for (qsizetype i = 0; i < m_items.size(); ++i) m_items[i].id = int(i);
+    }
+
+    QVector<T> m_items;
+};
+
+} // namespace virtuoso::util
@@ -0,0 +1,207 @@
+#include "virtuoso/util/RegistryBundle.h"
+
+#include "virtuoso/util/StableHash.h"
+
+#include <QDebug>
+
+namespace virtuoso::util {
+namespace {
+
+constexpr char kMagic[4] = {'V', 'R', 'B', 'D'};
+constexpr quint32 kHeaderBytes = 24;
+constexpr quint32 kSectionEntryBytes = 12;
+
+static void appendU32(QByteArray& out, quint32 v) {
+    const quint32 le = qToLittleEndian(v);
+    out.append(reinterpret_cast<const char*>(&le), 4);
+}
+
+static quint32 readU32(const char* p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+static bool fail(QString* outError, const QString& msg) {
+    if (outError) *outError = msg;
+    return false;
+}
+
+} // namespace
+
+void BundleWriter::beginSection(BundleSection id) {
+    if (!m_sections.isEmpty()) m_sections.last().bytes = quint32(m_payload.size()) - m_sections.last().begin;
+    Section s;
+    s.id = quint32(id);
+    s.begin = quint32(m_payload.size());
+    m_sections.push_back(s);
+}
+
+quint32 BundleWriter::intern(const QString& s) {
+    auto it = m_stringIds.constFind(s);
+    if (it != m_stringIds.constEnd()) return it.value();
+    const quint32 id = quint32(m_strings.size());
+    m_stringIds.insert(s, id);
+    m_strings.push_back(s);
+    return id;
+}
+
+QByteArray BundleWriter::finish() const {
+    QVector<Section> sections = m_sections;
+    if (!sections.isEmpty()) sections.last().bytes = quint32(m_payload.size()) - sections.last().begin;
+
+    QByteArray strings;
+    quint32 units = 0;
+    for (const QString& s : m_strings) {
+        appendU32(strings, units);
+        units += quint32(s.size());
+    }
+    appendU32(strings, units);
+    for (const QString& s : m_strings) {
+        for (const QChar c : s) {
+            const quint16 le = qToLittleEndian(c.unicode());
+            strings.append(reinterpret_cast<const char*>(&le), 2);
+        }
+    }
+    // Keep payloads 4-byte aligned relative to the file start.
+    while (strings.size() % 4) strings.append('\0');
+
+    const quint32 payloadBase = kHeaderBytes + kSectionEntryBytes * quint32(sections.size()) + quint32(strings.size());
+    QByteArray body;
+    body.reserve(qsizetype(payloadBase - kHeaderBytes) + m_payload.size());
+    for (const Section& s : sections) {
+        appendU32(body, s.id);
+        appendU32(body, payloadBase + s.begin);
+        appendU32(body, s.bytes);
+    }
+    body.append(strings);
+    body.append(m_payload);
+
+    QByteArray out;
+    out.reserve(qsizetype(kHeaderBytes) + body.size());
+    out.append(kMagic, 4);
+    appendU32(out, RegistryBundle::kFormatVersion);
+    appendU32(out, kHeaderBytes + quint32(body.size()));
+    appendU32(out, StableHash::Builder().bytes(body.constData(), body.size()).value());
+    appendU32(out, quint32(m_strings.size()));
+    appendU32(out, quint32(sections.size()));
+    out.append(body);
+    return out;
+}
+
+void BundleReader::io(QString& s) {
+    const quint32 id = take<quint32>();
+    if (!m_ok || !m_strings || id >= quint32(m_strings->size())) {
+        m_ok = false;
+        s.clear();
+        return;
+    }
+    s = m_strings->at(qsizetype(id));
+}
+
+std::unique_ptr<RegistryBundle> RegistryBundle::open(const QString& path, QString* outError) {
+    std::unique_ptr<RegistryBundle> b(new RegistryBundle);
+    b->m_file.setFileName(path);
+    if (!b->m_file.open(QIODevice::ReadOnly)) {
+        if (outError) *outError = QString("Failed to open registry bundle '%1'").arg(path);
+        return nullptr;
+    }
+    const qint64 size = b->m_file.size();
+    if (size < qint64(kHeaderBytes) || size > qint64(0x7fffffff)) {
+        if (outError) *outError = QString("Registry bundle '%1' has an invalid size").arg(path);
+        return nullptr;
+    }
+    const char* data = reinterpret_cast<const char*>(b->m_file.map(0, size));
+    // Payload fields are read unaligned, but the UTF-16 text is copied as QChars: keep the
+    // base 4-byte aligned, as file mappings are and embedded resources may not be.
+    if (!data || (quintptr(data) % 4) != 0) {
+        if (data) b->m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+        b->m_file.seek(0);
+        b->m_bytes = b->m_file.readAll();
+        b->m_file.close();
+        data = b->m_bytes.constData();
+    }
+    if (!b->attach(data, quint32(size), outError)) return nullptr;
+    return b;
+}
+
+std::unique_ptr<RegistryBundle> RegistryBundle::fromBytes(const QByteArray& bytes, QString* outError) {
+    std::unique_ptr<RegistryBundle> b(new RegistryBundle);
+    b->m_bytes = bytes;
+    if (!b->attach(b->m_bytes.constData(), quint32(b->m_bytes.size()), outError)) return nullptr;
+    return b;
+}
+
+const RegistryBundle* RegistryBundle::embedded() {
+    static const std::unique_ptr<RegistryBundle> bundle = [] {
+        if (!QFile::exists(QString::fromLatin1(kResourcePath))) return std::unique_ptr<RegistryBundle>();
+        QString err;
+        auto b = open(QString::fromLatin1(kResourcePath), &err);
+        if (!b) qWarning().noquote() << "RegistryBundle:" << err << "- using builtins";
+        return b;
+    }();
+    return bundle.get();
+}
+
+bool RegistryBundle::attach(const char* data, quint32 size, QString* outError) {
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return fail(outError, "Registry bundles are little-endian only");
+#else
+    if (!data || size < kHeaderBytes || std::memcmp(data, kMagic, 4) != 0) {
+        return fail(outError, "Not a registry bundle");
+    }
+    const quint32 version = readU32(data + 4);
+    if (version != kFormatVersion) {
+        return fail(outError, QString("Registry bundle format %1, expected %2").arg(version).arg(kFormatVersion));
+    }
+    if (readU32(data + 8) != size) return fail(outError, "Registry bundle is truncated");
+    if (StableHash::Builder().bytes(data + kHeaderBytes, qsizetype(size - kHeaderBytes)).value() != readU32(data + 12)) {
+        return fail(outError, "Registry bundle checksum mismatch");
+    }
+    const quint32 stringCount = readU32(data + 16);
+    const quint32 sectionCount = readU32(data + 20);
+
+    const quint64 stringsAt = quint64(kHeaderBytes) + quint64(kSectionEntryBytes) * sectionCount;
+    const quint64 textAt = stringsAt + 4ull * (quint64(stringCount) + 1);
+    if (textAt > size) return fail(outError, "Registry bundle string table is out of range");
+    const quint64 textUnits = readU32(data + stringsAt + 4ull * stringCount);
+    if (textAt + 2 * textUnits > size) return fail(outError, "Registry bundle string table is out of range");
+
+    m_sections.clear();
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        const char* e = data + kHeaderBytes + kSectionEntryBytes * i;
+        Section s;
+        s.offset = readU32(e + 4);
+        s.bytes = readU32(e + 8);
+        if (quint64(s.offset) + s.bytes > size) return fail(outError, "Registry bundle section is out of range");
+        m_sections.insert(readU32(e), s);
+    }
+
+    const QChar* text = reinterpret_cast<const QChar*>(data + textAt);
+    m_strings.clear();
+    m_strings.reserve(qsizetype(stringCount));
+    for (quint32 i = 0; i < stringCount; ++i) {
+        const quint32 begin = readU32(data + stringsAt + 4ull * i);
+        const quint32 end = readU32(data + stringsAt + 4ull * (i + 1));
+        if (begin > end || end > textUnits) return fail(outError, "Registry bundle string table is damaged");
+        m_strings.push_back(QString(text + begin, qsizetype(end - begin)));
+    }
+
+    m_data = data;
+    m_size = size;
+    return true;
+#endif
+}
+
+bool RegistryBundle::hasSection(BundleSection id) const {
+    return m_sections.contains(quint32(id));
+}
+
+BundleReader RegistryBundle::section(BundleSection id) const {
+    auto it = m_sections.constFind(quint32(id));
+    if (it == m_sections.constEnd()) return BundleReader();
+    const char* begin = m_data + it.value().offset;
+    return BundleReader(begin, begin + it.value().bytes, &m_strings);
+}
+
+} // namespace virtuoso::util
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace virtuoso::util {
+
+// Precompiled registry bundle: the code-defined ontology and groove tables, the parsed
+// vocabulary and the playback chord→scale table in one versioned binary file, so startup
+// copies fields instead of building tables in code, parsing JSON or ranking scales.
+//
+// Layout (little-endian, offsets from the start of the file):
+//   header    "VRBD", u32 formatVersion, u32 totalBytes, u32 checksum (FNV-1a of all bytes
+//             after the header), u32 stringCount, u32 sectionCount
+//   sections  sectionCount x {u32 id, u32 offset, u32 bytes}
+//   strings   (stringCount + 1) x u32 start (UTF-16 units), then the UTF-16 text
+//   payloads  fixed-width fields, in the order each registry's writeBundle() puts them
+//
+// Every string (keys, names, tags, pattern ids, notes) is interned: payloads hold its id and
+// each distinct string is materialized once when the bundle is opened, so loaded tables share
+// it. Loading is field copies out of the mapping; nothing is tokenized or decoded.
+//
+// tools/BuildRegistryBundle writes the file at build time and the app embeds it uncompressed
+// (kResourcePath), so QFile::map hands out the resource bytes in place. A missing bundle,
+// another format version, a bad checksum or a payload that runs short make the loaders return
+// false; callers then take the builtins()/JSON path.
+enum class BundleSection : quint32 {
+    Ontology = 1,
+    Groove = 2,
+    Vocabulary = 3,
+    ChordScaleTable = 4,
+};
+
+class BundleWriter {
+public:
+    // Subsequent fields go to this section (each section at most once).
+    void beginSection(BundleSection id);
+
+    void io(bool v) { put<quint8>(v ? 1u : 0u); }
+    void io(int v) { put<qint32>(qint32(v)); }
+    void io(quint32 v) { put<quint32>(v); }
+    void io(qint64 v) { put<qint64>(v); }
+    void io(double v) {
+        quint64 bits = 0;
+        std::memcpy(&bits, &v, sizeof bits);
+        put<quint64>(bits);
+    }
+    void io(const QString& s) { put<quint32>(intern(s)); }
+    void io(const QVector<QString>& v) { list(v, [](BundleWriter& w, const QString& s) { w.io(s); }); }
+    void io(const QVector<int>& v) { list(v, [](BundleWriter& w, int x) { w.io(x); }); }
+    template <typename E, typename = std::enable_if_t<std::is_enum_v<E>>>
+    void io(E v) { put<qint32>(qint32(v)); }
+
+    template <typename T, typename Fn>
+    void list(const QVector<T>& items, const Fn& fn) {
+        io(quint32(items.size()));
+        for (const T& item : items) fn(*this, item);
+    }
+    // Keys in sorted order, so equal tables give equal bytes.
+    template <typename T, typename Fn>
+    void map(const QHash<QString, T>& items, const Fn& fn) {
+        QList<QString> keys = items.keys();
+        std::sort(keys.begin(), keys.end());
+        io(quint32(keys.size()));
+        for (const QString& k : keys) {
+            io(k);
+            fn(*this, *items.constFind(k));
+        }
+    }
+
+    QByteArray finish() const;
+
+private:
+    template <typename T>
+    void put(T v) {
+        const T le = qToLittleEndian(v);
+        m_payload.append(reinterpret_cast<const char*>(&le), qsizetype(sizeof le));
+    }
+    quint32 intern(const QString& s);
+
+    struct Section {
+        quint32 id = 0;
+        quint32 begin = 0; // into m_payload
+        quint32 bytes = 0;
+    };
+    QByteArray m_payload;
+    QVector<Section> m_sections;
+    QHash<QString, quint32> m_stringIds;
+    QVector<QString> m_strings;
+};
+
+// Cursor over one section. Mirrors BundleWriter field for field; reading past the end or an
+// out-of-range string id clears ok() and yields defaults from then on.
+class BundleReader {
+public:
+    BundleReader() = default;
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_cur == m_end; }
+
+    void io(bool& v) { v = take<quint8>() != 0; }
+    void io(int& v) { v = int(take<qint32>()); }
+    void io(quint32& v) { v = take<quint32>(); }
+    void io(qint64& v) { v = take<qint64>(); }
+    void io(double& v) {
+        const quint64 bits = take<quint64>();
+        std::memcpy(&v, &bits, sizeof v);
+    }
+    void io(QString& s);
+    void io(QVector<QString>& v) { list(v, [](BundleReader& r, QString& s) { r.io(s); }); }
+    void io(QVector<int>& v) { list(v, [](BundleReader& r, int& x) { r.io(x); }); }
+    template <typename E, typename = std::enable_if_t<std::is_enum_v<E>>>
+    void io(E& v) { v = E(take<qint32>()); }
+
+    template <typename T, typename Fn>
+    void list(QVector<T>& items, const Fn& fn) {
+        const quint32 n = take<quint32>();
+        items.clear();
+        // Every element takes at least a byte: a larger count is a damaged payload.
+        if (!m_ok || n > quint32(m_end - m_cur)) {
+            m_ok = false;
+            return;
+        }
+        items.resize(qsizetype(n));
+        for (T& item : items) fn(*this, item);
+    }
+    template <typename T, typename Fn>
+    void map(QHash<QString, T>& items, const Fn& fn) {
+        const quint32 n = take<quint32>();
+        items.clear();
+        if (!m_ok || n > quint32(m_end - m_cur)) {
+            m_ok = false;
+            return;
+        }
+        items.reserve(qsizetype(n));
+        for (quint32 i = 0; i < n && m_ok; ++i) {
+            QString k;
+            io(k);
+            T v{};
+            fn(*this, v);
+            items.insert(k, v);
+        }
+    }
+
+private:
+    friend class RegistryBundle;
+    BundleReader(const char* begin, const char* end, const QVector<QString>* strings)
+        : m_cur(begin), m_end(end), m_strings(strings), m_ok(begin != nullptr) {}
+
+    template <typename T>
+    T take() {
+        if (!m_ok || m_end - m_cur < qsizetype(sizeof(T))) {
+            m_ok = false;
+            return T{};
+        }
+        const T v = qFromLittleEndian<T>(m_cur);
+        m_cur += sizeof(T);
+        return v;
+    }
+
+    const char* m_cur = nullptr;
+    const char* m_end = nullptr;
+    const QVector<QString>* m_strings = nullptr;
+    bool m_ok = false;
+};
+
+class RegistryBundle {
+public:
+    // Bump when any writeBundle() changes what it writes; older files are then rejected.
+    static constexpr quint32 kFormatVersion = 2;
+    static constexpr const char* kResourcePath = ":/virtuoso/bundle/registries.vrb";
+
+    // Maps the file or resource at path (reads it when it cannot be mapped) and validates it.
+    static std::unique_ptr<RegistryBundle> open(const QString& path, QString* outError = nullptr);
+    // Same checks over bytes already in memory (tests, benchmarks).
+    static std::unique_ptr<RegistryBundle> fromBytes(const QByteArray& bytes, QString* outError = nullptr);
+
+    // The bundle embedded in the app, opened once per process; nullptr when there is none.
+    static const RegistryBundle* embedded();
+
+    RegistryBundle(const RegistryBundle&) = delete;
+    RegistryBundle& operator=(const RegistryBundle&) = delete;
+
+    bool hasSection(BundleSection id) const;
+    // A reader that is not ok() when the section is absent.
+    BundleReader section(BundleSection id) const;
+
+    quint32 byteSize() const { return m_size; }
+    int stringCount() const { return m_strings.size(); }
+
+private:
+    RegistryBundle() = default;
+    bool attach(const char* data, quint32 size, QString* outError);
+
+    QFile m_file;      // owns the mapping
+    QByteArray m_bytes; // when not mapped
+    const char* m_data = nullptr;
+    quint32 m_size = 0;
+    QVector<QString> m_strings;
+    struct Section {
+        quint32 offset = 0;
+        quint32 bytes = 0;
+    };
+    QHash<quint32, Section> m_sections;
+};
+
+} // namespace virtuoso::util
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <QByteArray>
+#include <QString>
+#include <QStringView>
 #include <QtGlobal>
 
+#include <type_traits>
+
 namespace virtuoso::util {
 
 // Canonical deterministic hash for the Virtuoso framework.
@@ -42,7 +46,177 @@ struct StableHash final {
         add(b);
         return h;
     }
+
+    // Incremental FNV-1a 32-bit: value() equals fnv1a32() over the concatenation of everything
+    // absorbed, without building it. Integers and enums go in as the decimal text QString::arg()
+    // prints (decimal) or as little-endian words (word, as mix() does); strings as UTF-8.
+    class Builder {
+    public:
+        constexpr Builder& byte(quint8 c) {
+            m_h ^= quint32(c);
+            m_h *= 16777619u;
+            return *this;
+        }
+
+        constexpr Builder& bytes(const char* data, qsizetype n) {
+            for (qsizetype i = 0; i < n; ++i) byte(quint8(data[i]));
+            return *this;
+        }
+
+        // NUL-terminated ASCII (its UTF-8 bytes are the same).
+        constexpr Builder& ascii(const char* s) {
+            while (*s) byte(quint8(*s++));
+            return *this;
+        }
+
+        template <typename T>
+        constexpr Builder& word(T v) {
+            static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "word() takes integers and enums");
+            using Raw = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::enable_if<true, T>>::type;
+            using U = std::make_unsigned_t<Raw>;
+            const U u = U(v);
+            for (int i = 0; i < int(sizeof(U)); ++i) byte(quint8((u >> (i * 8)) & 0xFFu));
+            return *this;
+        }
+
+        template <typename T>
+        constexpr Builder& decimal(T v) {
+            static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>, "decimal() takes integers");
+            using U = std::make_unsigned_t<T>;
+            U u = U(v);
+            if constexpr (std::is_signed_v<T>) {
+                if (v < 0) {
+                    byte('-');
+                    u = U(0) - u;
+                }
+            }
+            char digits[24] = {};
+            int n = 0;
+            do {
+                digits[n++] = char('0' + int(u % 10u));
+                u = U(u / 10u);
+            } while (u != 0);
+            while (n > 0) byte(quint8(digits[--n]));
+            return *this;
+        }
+
+        // The bytes QString::toUtf8() produces for s.
+        Builder& utf8(QStringView s) {
+            const char16_t* p = s.utf16();
+            const qsizetype n = s.size();
+            // Lone surrogates: leave their replacement bytes to Qt's encoder.
+            for (qsizetype i = 0; i < n; ++i) {
+                if (p[i] < 0xD800 || p[i] > 0xDFFF) continue;
+                if (p[i] <= 0xDBFF && i + 1 < n && p[i + 1] >= 0xDC00 && p[i + 1] <= 0xDFFF) {
+                    ++i;
+                    continue;
+                }
+                const QByteArray encoded = s.toUtf8();
+                return bytes(encoded.constData(), encoded.size());
+            }
+            for (qsizetype i = 0; i < n; ++i) {
+                const quint32 u = p[i];
+                if (u < 0x80) {
+                    byte(quint8(u));
+                } else if (u < 0x800) {
+                    byte(quint8(0xC0 | (u >> 6)));
+                    byte(quint8(0x80 | (u & 0x3F)));
+                } else if (u >= 0xD800 && u <= 0xDBFF) {
+                    const quint32 cp = 0x10000 + ((u - 0xD800) << 10) + (quint32(p[++i]) - 0xDC00);
+                    byte(quint8(0xF0 | (cp >> 18)));
+                    byte(quint8(0x80 | ((cp >> 12) & 0x3F)));
+                    byte(quint8(0x80 | ((cp >> 6) & 0x3F)));
+                    byte(quint8(0x80 | (cp & 0x3F)));
+                } else {
+                    byte(quint8(0xE0 | (u >> 12)));
+                    byte(quint8(0x80 | ((u >> 6) & 0x3F)));
+                    byte(quint8(0x80 | (u & 0x3F)));
+                }
+            }
+            return *this;
+        }
+
+        constexpr quint32 value() const { return m_h; }
+
+    private:
+        quint32 m_h = 2166136261u;
+    };
+
+    // Seeds that were historically fnv1a32(QString(format).arg(a).arg(b)....toUtf8()): hashes
+    // exactly those bytes without building the string, e.g.
+    //   StableHash::ArgFormat("%1|piano|%2").arg(chordText).arg(bar).value()
+    // format is an ASCII literal (it is read in place). When its placeholders are not %1..%n,
+    // in order and each once, or a string argument contains '%' that a later arg() could
+    // substitute, the rest goes through QString::arg() itself, so the bytes always match.
+    class ArgFormat {
+    public:
+        explicit ArgFormat(const char* format) : m_rest(format) {
+            int expected = 1;
+            for (const char* c = format; *c; ++c) {
+                if (*c != '%') continue;
+                const bool ok = expected <= 9 && c[1] == char('0' + expected) && !(c[2] >= '0' && c[2] <= '9');
+                if (!ok) {
+                    fallBack(QString::fromLatin1(format));
+                    return;
+                }
+                ++expected;
+                ++c;
+            }
+        }
+
+        ArgFormat& arg(QStringView s) {
+            if (m_fallback) {
+                m_formatted = m_formatted.arg(s);
+                return *this;
+            }
+            if (!toNextPlaceholder()) return *this; // QString::arg() ignores surplus arguments
+            if (s.contains(QChar('%'))) {
+                fallBack(s.toString() + QString::fromLatin1(m_rest));
+                return *this;
+            }
+            m_hash.utf8(s);
+            return *this;
+        }
+
+        template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+        ArgFormat& arg(T v) {
+            static_assert(!std::is_same_v<T, bool>, "cast bools to int, as arg() call sites do");
+            if (m_fallback) {
+                if constexpr (std::is_signed_v<T>) m_formatted = m_formatted.arg(qlonglong(v));
+                else m_formatted = m_formatted.arg(qulonglong(v));
+                return *this;
+            }
+            if (toNextPlaceholder()) m_hash.decimal(v);
+            return *this;
+        }
+
+        quint32 value() const {
+            Builder h = m_hash;
+            if (m_fallback) return h.utf8(m_formatted).value();
+            return h.ascii(m_rest).value(); // unfilled placeholders stay literal, as in arg()
+        }
+
+    private:
+        // Absorbs the literal text before the next placeholder and skips the placeholder.
+        bool toNextPlaceholder() {
+            const char* c = m_rest;
+            while (*c && *c != '%') ++c;
+            if (!*c) return false;
+            m_hash.bytes(m_rest, c - m_rest);
+            m_rest = c + 2;
+            return true;
+        }
+
+        void fallBack(const QString& remaining) {
+            m_fallback = true;
+            m_formatted = remaining;
+        }
+
+        Builder m_hash;
+        const char* m_rest;
+        bool m_fallback = false;
+        QString m_formatted; // the unhashed tail, once QString::arg() has taken over
+    };
 };
 
 } // namespace virtuoso::util
-
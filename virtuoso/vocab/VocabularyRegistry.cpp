@@ -1,5 +1,6 @@
 #include "virtuoso/vocab/VocabularyRegistry.h"
 
+#include "virtuoso/util/RegistryBundle.h"
 #include "virtuoso/util/StableHash.h"
 
 #include <QFile>
@@ -82,6 +83,178 @@ static bool functionMatches(const QVector<QString>& allowed, const QString& func
     return false;
 }
 
+// Field order of the bundle's vocabulary section, shared by the writer and the reader.
+// Bump RegistryBundle::kFormatVersion when changing it.
+template <typename A, typename H>
+void pianoHitFields(A& a, H& h) {
+    a.io(h.sub);
+    a.io(h.count);
+    a.io(h.dur_num);
+    a.io(h.dur_den);
+    a.io(h.vel_delta);
+    a.io(h.density);
+}
+
+template <typename A, typename H>
+void drumHitFields(A& a, H& h) {
+    a.io(h.articulation);
+    a.io(h.sub);
+    a.io(h.count);
+    a.io(h.dur_num);
+    a.io(h.dur_den);
+    a.io(h.vel_delta);
+}
+
+template <typename A, typename P>
+void energyWeightFields(A& a, P& p) {
+    a.io(p.minEnergy);
+    a.io(p.maxEnergy);
+    a.io(p.weight);
+}
+
+template <typename A, typename P>
+void pianoBeatFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.beats);
+    energyWeightFields(a, p);
+    a.io(p.chordIsNewOnly);
+    a.io(p.stableOnly);
+    a.io(p.allowWhenUserSilence);
+    a.io(p.chordFunctions);
+    a.list(p.hits, [](auto& a2, auto& h) { pianoHitFields(a2, h); });
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void bassBeatFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.beats);
+    energyWeightFields(a, p);
+    a.io(p.chordIsNewOnly);
+    a.io(p.stableOnly);
+    a.io(p.nextChangesOnly);
+    a.io(p.forbidWhenUserDenseOrPeak);
+    a.io(p.action);
+    a.io(p.sub);
+    a.io(p.count);
+    a.io(p.dur_num);
+    a.io(p.dur_den);
+    a.io(p.vel_delta);
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void drumsBeatFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.beats);
+    energyWeightFields(a, p);
+    a.io(p.intensityPeakOnly);
+    a.list(p.hits, [](auto& a2, auto& h) { drumHitFields(a2, h); });
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void pianoPhraseFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.phraseBars);
+    energyWeightFields(a, p);
+    a.io(p.allowWhenUserSilence);
+    a.io(p.chordFunctions);
+    a.list(p.hits, [](auto& a2, auto& h) {
+        a2.io(h.barOffset);
+        a2.io(h.beatInBar);
+        pianoHitFields(a2, h.hit);
+    });
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void pianoTopLineFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.phraseBars);
+    energyWeightFields(a, p);
+    a.io(p.allowWhenUserSilence);
+    a.io(p.chordFunctions);
+    a.list(p.hits, [](auto& a2, auto& h) {
+        a2.io(h.barOffset);
+        a2.io(h.beatInBar);
+        a2.io(h.sub);
+        a2.io(h.count);
+        a2.io(h.dur_num);
+        a2.io(h.dur_den);
+        a2.io(h.vel_delta);
+        a2.io(h.degree);
+        a2.io(h.neighborDir);
+        a2.io(h.resolve);
+        a2.io(h.tag);
+    });
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void pianoGestureFields(A& a, P& p) {
+    a.io(p.id);
+    energyWeightFields(a, p);
+    a.io(p.cadenceOnly);
+    a.io(p.chordIsNewOnly);
+    a.io(p.allowWhenUserSilence);
+    a.io(p.minNoteCount);
+    a.io(p.maxNoteCount);
+    a.io(p.maxBpm);
+    a.io(p.kind);
+    a.io(p.style);
+    a.io(p.spreadMs);
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void pianoPedalFields(A& a, P& p) {
+    a.io(p.id);
+    energyWeightFields(a, p);
+    a.io(p.allowWhenUserSilence);
+    a.io(p.defaultState);
+    a.io(p.repedalOnNewChord);
+    a.io(p.repedalProbPct);
+    a.io(p.clearBeforeChange);
+    a.io(p.clearSub);
+    a.io(p.clearCount);
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void bassPhraseFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.phraseBars);
+    energyWeightFields(a, p);
+    a.io(p.forbidWhenUserDenseOrPeak);
+    a.list(p.hits, [](auto& a2, auto& h) {
+        a2.io(h.barOffset);
+        a2.io(h.beatInBar);
+        a2.io(h.action);
+        a2.io(h.sub);
+        a2.io(h.count);
+        a2.io(h.dur_num);
+        a2.io(h.dur_den);
+        a2.io(h.vel_delta);
+        a2.io(h.notes);
+    });
+    a.io(p.notes);
+}
+
+template <typename A, typename P>
+void drumsPhraseFields(A& a, P& p) {
+    a.io(p.id);
+    a.io(p.phraseBars);
+    energyWeightFields(a, p);
+    a.io(p.intensityPeakOnly);
+    a.list(p.hits, [](auto& a2, auto& h) {
+        a2.io(h.barOffset);
+        a2.io(h.beatInBar);
+        drumHitFields(a2, h.hit);
+    });
+    a.io(p.notes);
+}
+
 } // namespace
 
 quint32 VocabularyRegistry::fnv1a32(const QByteArray& bytes) {
@@ -98,29 +271,220 @@ int VocabularyRegistry::clampBeat(int beatInBar) {
     return (beatInBar < 0) ? 0 : beatInBar;
 }
 
-template <typename TPattern, typename TChoice, typename TMakeChoiceFn>
-TChoice VocabularyRegistry::chooseWeighted(const QVector<TPattern>& patterns,
-                                          quint32 pickHash,
-                                          const TMakeChoiceFn& makeChoice) {
-    TChoice out{};
-    if (patterns.isEmpty()) return out;
+int VocabularyRegistry::functionId(const QString& chordFunction) const {
+    const QStringView f = QStringView(chordFunction).trimmed();
+    if (f.isEmpty()) return 0;
+    for (int i = 0; i < m_functionNames.size(); ++i) {
+        if (QStringView(m_functionNames[i]).compare(f, Qt::CaseInsensitive) == 0) return i + 1;
+    }
+    return m_functionNames.size() + 1;
+}
+
+bool VocabularyRegistry::functionIdMatches(const QVector<QString>& allowed, int id) const {
+    if (id <= 0 || allowed.isEmpty()) return true;
+    if (id > m_functionNames.size()) return false;
+    return functionMatches(allowed, m_functionNames[id - 1]);
+}
+
+int VocabularyRegistry::CandidateIndex::energyBand(double e) const {
+    const auto it = std::lower_bound(energyBounds.cbegin(), energyBounds.cend(), e);
+    const int i = int(it - energyBounds.cbegin());
+    return (it != energyBounds.cend() && *it == e) ? 2 * i + 1 : 2 * i;
+}
+
+int VocabularyRegistry::CandidateIndex::bucketOf(std::initializer_list<int> key, double energy) const {
+    if (bucketBegin.isEmpty() || int(key.size()) != extents.size()) return -1;
+    int bucket = 0;
+    int d = 0;
+    for (const int k : key) {
+        if (k < 0 || k >= extents[d]) return -1;
+        bucket = bucket * extents[d++] + k;
+    }
+    return bucket * (2 * energyBounds.size() + 1) + energyBand(energy);
+}
+
+VocabularyRegistry::CandidateSpan VocabularyRegistry::CandidateIndex::candidates(int bucket) const {
+    CandidateSpan out;
+    if (bucket < 0 || bucket + 1 >= bucketBegin.size()) return out;
+    const int begin = bucketBegin[bucket];
+    out.patterns = patterns.constData() + begin;
+    out.cumWeights = cumWeights.constData() + begin;
+    out.count = bucketBegin[bucket + 1] - begin;
+    return out;
+}
+
+template <typename TPattern, typename TMatchFn>
+void VocabularyRegistry::buildIndex(CandidateIndex& index,
+                                    const QVector<TPattern>& patterns,
+                                    const QVector<int>& extents,
+                                    const TMatchFn& matches) {
+    index = CandidateIndex();
+    index.extents = extents;
+    for (const auto& p : patterns) {
+        index.energyBounds.push_back(qMin(p.minEnergy, p.maxEnergy));
+        index.energyBounds.push_back(qMax(p.minEnergy, p.maxEnergy));
+    }
+    std::sort(index.energyBounds.begin(), index.energyBounds.end());
+    index.energyBounds.erase(std::unique(index.energyBounds.begin(), index.energyBounds.end()), index.energyBounds.end());
+
+    // One energy per band: the bound itself, or a value inside the gap. A gap with no double
+    // strictly inside it is never looked up, so its representative doesn't matter.
+    const QVector<double>& bounds = index.energyBounds;
+    const int n = bounds.size();
+    QVector<double> bandEnergy;
+    bandEnergy.reserve(2 * n + 1);
+    for (int band = 0; band < 2 * n + 1; ++band) {
+        const int i = band / 2;
+        if (band % 2) {
+            bandEnergy.push_back(bounds[i]);
+        } else if (n == 0) {
+            bandEnergy.push_back(0.0);
+        } else {
+            const double lo = (i == 0) ? bounds[0] - 1.0 : bounds[i - 1];
+            const double hi = (i == n) ? bounds[n - 1] + 1.0 : bounds[i];
+            bandEnergy.push_back(lo + (hi - lo) * 0.5);
+        }
+    }
+
+    int keyCount = 1;
+    for (const int extent : extents) keyCount *= extent;
+    QVector<int> key(extents.size());
+    index.bucketBegin.reserve(keyCount * bandEnergy.size() + 1);
+    for (int k = 0; k < keyCount; ++k) {
+        for (int d = extents.size() - 1, rest = k; d >= 0; --d) {
+            key[d] = rest % extents[d];
+            rest /= extents[d];
+        }
+        for (const double e : bandEnergy) {
+            index.bucketBegin.push_back(index.patterns.size());
+            // Load order and the same running sum the linear scan accumulated: picks stay
+            // bit-identical.
+            double acc = 0.0;
+            for (int i = 0; i < patterns.size(); ++i) {
+                const TPattern& p = patterns[i];
+                if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
+                if (!matches(p, key.constData())) continue;
+                acc += (p.weight > 0.0 ? p.weight : 0.0);
+                index.patterns.push_back(i);
+                index.cumWeights.push_back(acc);
+            }
+        }
+    }
+    index.bucketBegin.push_back(index.patterns.size());
+}
+
+template <typename TPattern, typename TAcceptFn>
+VocabularyRegistry::CandidateSpan VocabularyRegistry::scanCandidates(const QVector<TPattern>& patterns,
+                                                                     double energy,
+                                                                     const TAcceptFn& accept,
+                                                                     ScanPatterns& outPatterns,
+                                                                     ScanWeights& outWeights) {
+    outPatterns.clear();
+    outWeights.clear();
+    double acc = 0.0;
+    for (int i = 0; i < patterns.size(); ++i) {
+        const TPattern& p = patterns[i];
+        if (!energyMatches(energy, p.minEnergy, p.maxEnergy)) continue;
+        if (!accept(p)) continue;
+        acc += (p.weight > 0.0 ? p.weight : 0.0);
+        outPatterns.push_back(i);
+        outWeights.push_back(acc);
+    }
+    CandidateSpan out;
+    out.patterns = outPatterns.constData();
+    out.cumWeights = outWeights.constData();
+    out.count = int(outPatterns.size());
+    return out;
+}
+
+template <typename TPattern>
+const TPattern* VocabularyRegistry::pickWeighted(const QVector<TPattern>& patterns,
+                                                 const CandidateSpan& cands,
+                                                 quint32 pickHash) {
+    if (cands.count <= 0) return nullptr;
     // Weighted pick by mapping hash into [0, sumWeights).
-    double sum = 0.0;
-    for (const auto& p : patterns) sum += (p.weight > 0.0 ? p.weight : 0.0);
-    if (sum <= 0.0) return out;
+    const double sum = cands.cumWeights[cands.count - 1];
+    if (sum <= 0.0) return nullptr;
 
     // Deterministic unit in [0,1)
     const double u = double((pickHash >> 8) & 0x00FF'FFFFu) / double(0x0100'0000u);
     const double r = u * sum;
 
-    double acc = 0.0;
-    for (const auto& p : patterns) {
-        const double w = (p.weight > 0.0 ? p.weight : 0.0);
-        acc += w;
-        if (r <= acc) return makeChoice(p);
-    }
-    // Fallback to last.
-    return makeChoice(patterns.last());
+    // First candidate whose running sum reaches r; fallback to last.
+    const double* end = cands.cumWeights + cands.count;
+    const double* hit = std::lower_bound(cands.cumWeights, end, r);
+    const int i = (hit == end) ? cands.count - 1 : int(hit - cands.cumWeights);
+    return &patterns[cands.patterns[i]];
+}
+
+void VocabularyRegistry::buildIndexes() {
+    m_functionNames.clear();
+    auto addFunctions = [this](const QVector<QString>& names) {
+        for (const QString& name : names) {
+            if (functionId(name) > m_functionNames.size()) m_functionNames.push_back(name);
+        }
+    };
+    for (const auto& p : m_piano) addFunctions(p.chordFunctions);
+    for (const auto& p : m_pianoPhrases) addFunctions(p.chordFunctions);
+    for (const auto& p : m_pianoTopLines) addFunctions(p.chordFunctions);
+    const int functions = m_functionNames.size() + 2;
+
+    auto beatExtent = [](const auto& patterns) {
+        int extent = 0;
+        for (const auto& p : patterns) {
+            for (const int b : p.beats) extent = qMax(extent, b + 1);
+        }
+        return extent;
+    };
+
+    buildIndex(m_pianoIndex, m_piano, {beatExtent(m_piano), 2, 2, functions},
+               [this](const PianoBeatPattern& p, const int* key) {
+                   if (!p.beats.contains(key[0])) return false;
+                   if (p.chordIsNewOnly && !key[1]) return false;
+                   if (p.stableOnly && key[1]) return false;
+                   if (!p.allowWhenUserSilence && key[2]) return false;
+                   return functionIdMatches(p.chordFunctions, key[3]);
+               });
+    buildIndex(m_bassIndex, m_bass, {beatExtent(m_bass), 2, 2, 2}, [](const BassBeatPattern& p, const int* key) {
+        if (!p.beats.contains(key[0])) return false;
+        if (p.chordIsNewOnly && !key[1]) return false;
+        if (p.stableOnly && key[1]) return false;
+        if (p.nextChangesOnly && !key[2]) return false;
+        if (p.forbidWhenUserDenseOrPeak && key[3]) return false;
+        return true;
+    });
+    buildIndex(m_drumsIndex, m_drums, {beatExtent(m_drums), 2}, [](const DrumsBeatPattern& p, const int* key) {
+        if (!p.beats.contains(key[0])) return false;
+        if (p.intensityPeakOnly && !key[1]) return false;
+        return true;
+    });
+
+    // Phrase keys start with phraseBars - 1 for queries up to kIndexedPhraseBars.
+    buildIndex(m_pianoPhraseIndex, m_pianoPhrases, {kIndexedPhraseBars, 2, functions},
+               [this](const PianoPhrasePattern& p, const int* key) {
+                   if ((key[0] + 1) % qMax(1, p.phraseBars) != 0) return false;
+                   if (!p.allowWhenUserSilence && key[1]) return false;
+                   return functionIdMatches(p.chordFunctions, key[2]);
+               });
+    buildIndex(m_pianoTopLineIndex, m_pianoTopLines, {kIndexedPhraseBars, 2, functions},
+               [this](const PianoTopLinePattern& p, const int* key) {
+                   if (p.phraseBars != key[0] + 1) return false;
+                   if (!p.allowWhenUserSilence && key[1]) return false;
+                   return functionIdMatches(p.chordFunctions, key[2]);
+               });
+    buildIndex(m_pianoPedalIndex, m_pianoPedals, {2}, [](const PianoPedalPattern& p, const int* key) {
+        return p.allowWhenUserSilence || !key[0];
+    });
+    buildIndex(m_bassPhraseIndex, m_bassPhrases, {kIndexedPhraseBars, 2}, [](const BassPhrasePattern& p, const int* key) {
+        if ((key[0] + 1) % qMax(1, p.phraseBars) != 0) return false;
+        if (p.forbidWhenUserDenseOrPeak && key[1]) return false;
+        return true;
+    });
+    buildIndex(m_drumsPhraseIndex, m_drumsPhrases, {kIndexedPhraseBars, 2}, [](const DrumsPhrasePattern& p, const int* key) {
+        if ((key[0] + 1) % qMax(1, p.phraseBars) != 0) return false;
+        if (p.intensityPeakOnly && !key[1]) return false;
+        return true;
+    });
 }
 
 bool VocabularyRegistry::loadFromResourcePath(const QString& resourcePath, QString* outError) {
@@ -134,9 +498,59 @@ bool VocabularyRegistry::loadFromResourcePath(const QString& resourcePath, QStri
     return loadFromJsonBytes(f.readAll(), outError);
 }
 
+void VocabularyRegistry::writeBundle(util::BundleWriter& w) const {
+    w.beginSection(util::BundleSection::Vocabulary);
+    w.io(m_contentHash);
+    w.list(m_piano, [](auto& a, const auto& p) { pianoBeatFields(a, p); });
+    w.list(m_bass, [](auto& a, const auto& p) { bassBeatFields(a, p); });
+    w.list(m_drums, [](auto& a, const auto& p) { drumsBeatFields(a, p); });
+    w.list(m_pianoPhrases, [](auto& a, const auto& p) { pianoPhraseFields(a, p); });
+    w.list(m_pianoTopLines, [](auto& a, const auto& p) { pianoTopLineFields(a, p); });
+    w.list(m_pianoGestures, [](auto& a, const auto& p) { pianoGestureFields(a, p); });
+    w.list(m_pianoPedals, [](auto& a, const auto& p) { pianoPedalFields(a, p); });
+    w.list(m_bassPhrases, [](auto& a, const auto& p) { bassPhraseFields(a, p); });
+    w.list(m_drumsPhrases, [](auto& a, const auto& p) { drumsPhraseFields(a, p); });
+}
+
+bool VocabularyRegistry::loadFromBundle(const util::RegistryBundle& bundle, QString* outError) {
+    util::BundleReader r = bundle.section(util::BundleSection::Vocabulary);
+    VocabularyRegistry v;
+    r.io(v.m_contentHash);
+    r.list(v.m_piano, [](auto& a, auto& p) { pianoBeatFields(a, p); });
+    r.list(v.m_bass, [](auto& a, auto& p) { bassBeatFields(a, p); });
+    r.list(v.m_drums, [](auto& a, auto& p) { drumsBeatFields(a, p); });
+    r.list(v.m_pianoPhrases, [](auto& a, auto& p) { pianoPhraseFields(a, p); });
+    r.list(v.m_pianoTopLines, [](auto& a, auto& p) { pianoTopLineFields(a, p); });
+    r.list(v.m_pianoGestures, [](auto& a, auto& p) { pianoGestureFields(a, p); });
+    r.list(v.m_pianoPedals, [](auto& a, auto& p) { pianoPedalFields(a, p); });
+    r.list(v.m_bassPhrases, [](auto& a, auto& p) { bassPhraseFields(a, p); });
+    r.list(v.m_drumsPhrases, [](auto& a, auto& p) { drumsPhraseFields(a, p); });
+    if (!r.ok() || !r.atEnd() || v.m_contentHash == 0) {
+        *this = VocabularyRegistry();
+        m_lastError = "Registry bundle has no usable vocabulary section";
+        if (outError) *outError = m_lastError;
+        return false;
+    }
+    v.buildIndexes();
+    v.m_loaded = true;
+    *this = std::move(v);
+    return true;
+}
+
+const VocabularyRegistry& VocabularyRegistry::shared() {
+    static const VocabularyRegistry registry = [] {
+        VocabularyRegistry v;
+        const auto* bundle = util::RegistryBundle::embedded();
+        if (!bundle || !v.loadFromBundle(*bundle)) v.loadFromResourcePath(QString::fromLatin1(kResourcePath));
+        return v;
+    }();
+    return registry;
+}
+
 bool VocabularyRegistry::loadFromJsonBytes(const QByteArray& json, QString* outError) {
     m_lastError.clear();
     m_loaded = false;
+    m_contentHash = 0;
     m_piano.clear();
     m_bass.clear();
     m_drums.clear();
@@ -146,6 +560,15 @@ bool VocabularyRegistry::loadFromJsonBytes(const QByteArray& json, QString* outE
     m_pianoPedals.clear();
     m_bassPhrases.clear();
     m_drumsPhrases.clear();
+    m_functionNames.clear();
+    m_pianoIndex = CandidateIndex();
+    m_bassIndex = CandidateIndex();
+    m_drumsIndex = CandidateIndex();
+    m_pianoPhraseIndex = CandidateIndex();
+    m_pianoTopLineIndex = CandidateIndex();
+    m_pianoPedalIndex = CandidateIndex();
+    m_bassPhraseIndex = CandidateIndex();
+    m_drumsPhraseIndex = CandidateIndex();
 
     QJsonParseError pe;
     const auto doc = QJsonDocument::fromJson(json, &pe);
@@ -524,347 +947,364 @@ bool VocabularyRegistry::loadFromJsonBytes(const QByteArray& json, QString* outE
         return false;
     }
 
+    buildIndexes();
     m_loaded = true;
+    m_contentHash = fnv1a32(json);
     return true;
 }
 
-VocabularyRegistry::PianoBeatChoice VocabularyRegistry::choosePianoBeat(const PianoBeatQuery& q) const {
-    PianoBeatChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::PianoBeatPattern* VocabularyRegistry::pickPianoBeat(const PianoBeatQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const int beat = clampBeat(q.beatInBar);
     const double e = qBound(0.0, q.energy, 1.0);
 
-    QVector<PianoBeatPattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_piano) {
-        if (!p.beats.contains(beat)) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (p.chordIsNewOnly && !q.chordIsNew) continue;
-        if (p.stableOnly && q.chordIsNew) continue;
-        if (!p.allowWhenUserSilence && q.userSilence) continue;
-        if (!functionMatches(p.chordFunctions, q.chordFunction)) continue;
-        cands.push_back(p);
-    }
-    const quint32 h = fnv1a32(QString("%1|piano|%2|%3|%4|%5|%6")
-                                  .arg(q.chordText)
-                                  .arg(q.playbackBarIndex)
-                                  .arg(beat)
-                                  .arg(int(q.chordIsNew))
-                                  .arg(q.chordFunction)
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<PianoBeatPattern, PianoBeatChoice>(cands, h, [](const PianoBeatPattern& p) {
-        PianoBeatChoice c;
-        c.id = p.id;
-        c.hits = p.hits;
-        c.notes = p.notes;
-        return c;
-    });
+    const CandidateSpan cands = m_pianoIndex.candidates(
+        m_pianoIndex.bucketOf({beat, int(q.chordIsNew), int(q.userSilence), functionId(q.chordFunction)}, e));
+    if (cands.count == 0) return nullptr;
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|piano|%2|%3|%4|%5|%6")
+                          .arg(q.chordText)
+                          .arg(q.playbackBarIndex)
+                          .arg(beat)
+                          .arg(int(q.chordIsNew))
+                          .arg(q.chordFunction)
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_piano, cands, h);
 }
 
-VocabularyRegistry::BassBeatChoice VocabularyRegistry::chooseBassBeat(const BassBeatQuery& q) const {
-    BassBeatChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::BassBeatPattern* VocabularyRegistry::pickBassBeat(const BassBeatQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const int beat = clampBeat(q.beatInBar);
     const double e = qBound(0.0, q.energy, 1.0);
 
-    QVector<BassBeatPattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_bass) {
-        if (!p.beats.contains(beat)) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (p.chordIsNewOnly && !q.chordIsNew) continue;
-        if (p.stableOnly && q.chordIsNew) continue;
-        if (p.nextChangesOnly && !(q.hasNextChord && q.nextChanges)) continue;
-        if (p.forbidWhenUserDenseOrPeak && q.userDenseOrPeak) continue;
-        cands.push_back(p);
-    }
-
-    const quint32 h = fnv1a32(QString("%1|bass|%2|%3|%4|%5|%6|%7")
-                                  .arg(q.chordText)
-                                  .arg(q.playbackBarIndex)
-                                  .arg(beat)
-                                  .arg(int(q.chordIsNew))
-                                  .arg(int(q.hasNextChord))
-                                  .arg(int(q.nextChanges))
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<BassBeatPattern, BassBeatChoice>(cands, h, [](const BassBeatPattern& p) {
-        BassBeatChoice c;
-        c.id = p.id;
-        c.action = p.action;
-        c.sub = p.sub;
-        c.count = p.count;
-        c.dur_num = p.dur_num;
-        c.dur_den = p.dur_den;
-        c.vel_delta = p.vel_delta;
-        c.notes = p.notes;
-        return c;
-    });
+    const CandidateSpan cands = m_bassIndex.candidates(m_bassIndex.bucketOf(
+        {beat, int(q.chordIsNew), int(q.hasNextChord && q.nextChanges), int(q.userDenseOrPeak)}, e));
+    if (cands.count == 0) return nullptr;
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|bass|%2|%3|%4|%5|%6|%7")
+                          .arg(q.chordText)
+                          .arg(q.playbackBarIndex)
+                          .arg(beat)
+                          .arg(int(q.chordIsNew))
+                          .arg(int(q.hasNextChord))
+                          .arg(int(q.nextChanges))
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_bass, cands, h);
 }
 
-VocabularyRegistry::DrumsBeatChoice VocabularyRegistry::chooseDrumsBeat(const DrumsBeatQuery& q) const {
-    DrumsBeatChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::DrumsBeatPattern* VocabularyRegistry::pickDrumsBeat(const DrumsBeatQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const int beat = clampBeat(q.beatInBar);
     const double e = qBound(0.0, q.energy, 1.0);
 
-    QVector<DrumsBeatPattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_drums) {
-        if (!p.beats.contains(beat)) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (p.intensityPeakOnly && !q.intensityPeak) continue;
-        cands.push_back(p);
-    }
-
-    const quint32 h = fnv1a32(QString("drums|%1|%2|%3|%4")
-                                  .arg(q.playbackBarIndex)
-                                  .arg(beat)
-                                  .arg(int(q.intensityPeak))
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<DrumsBeatPattern, DrumsBeatChoice>(cands, h, [](const DrumsBeatPattern& p) {
-        DrumsBeatChoice c;
-        c.id = p.id;
-        c.hits = p.hits;
-        c.notes = p.notes;
-        return c;
-    });
+    const CandidateSpan cands = m_drumsIndex.candidates(m_drumsIndex.bucketOf({beat, int(q.intensityPeak)}, e));
+    if (cands.count == 0) return nullptr;
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("drums|%1|%2|%3|%4")
+                          .arg(q.playbackBarIndex)
+                          .arg(beat)
+                          .arg(int(q.intensityPeak))
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_drums, cands, h);
 }
 
-VocabularyRegistry::PianoPhraseChoice VocabularyRegistry::choosePianoPhrase(const PianoPhraseQuery& q) const {
-    PianoPhraseChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::PianoPhrasePattern* VocabularyRegistry::pickPianoPhrase(const PianoPhraseQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const double e = qBound(0.0, q.energy, 1.0);
     const int pb = qMax(1, q.phraseBars);
 
-    QVector<PianoPhrasePattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_pianoPhrases) {
-        // Allow modular matching: pattern's phraseBars should evenly divide query's phraseBars.
-        // E.g., 4-bar patterns work within 4-bar or 8-bar phrases.
-        const int patternBars = qMax(1, p.phraseBars);
-        if (pb % patternBars != 0) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (!p.allowWhenUserSilence && q.userSilence) continue;
-        if (!functionMatches(p.chordFunctions, q.chordFunction)) continue;
-        cands.push_back(p);
-    }
+    // Allow modular matching: pattern's phraseBars should evenly divide query's phraseBars.
+    // E.g., 4-bar patterns work within 4-bar or 8-bar phrases.
+    ScanPatterns scanned;
+    ScanWeights scannedWeights;
+    const CandidateSpan cands =
+        (pb <= kIndexedPhraseBars)
+            ? m_pianoPhraseIndex.candidates(
+                  m_pianoPhraseIndex.bucketOf({pb - 1, int(q.userSilence), functionId(q.chordFunction)}, e))
+            : scanCandidates(m_pianoPhrases, e,
+                             [&](const PianoPhrasePattern& p) {
+                                 return pb % qMax(1, p.phraseBars) == 0 && (p.allowWhenUserSilence || !q.userSilence) &&
+                                        functionMatches(p.chordFunctions, q.chordFunction);
+                             },
+                             scanned, scannedWeights);
+    if (cands.count == 0) return nullptr;
 
     // For modular matching, use the sub-phrase index based on playback bar.
     // This ensures deterministic selection even when 4-bar patterns are used in 8-bar phrases.
-    const int subPhraseLen = cands.isEmpty() ? pb : qMax(1, cands.first().phraseBars);
+    const int subPhraseLen = qMax(1, m_pianoPhrases[cands.patterns[0]].phraseBars);
     const int phraseIndex = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex / subPhraseLen) : 0;
-    const quint32 h = fnv1a32(QString("%1|piano_phrase|%2|%3|%4|%5")
-                                  .arg(q.chordText)
-                                  .arg(phraseIndex)
-                                  .arg(int(q.chordIsNew))
-                                  .arg(q.chordFunction)
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<PianoPhrasePattern, PianoPhraseChoice>(cands, h, [](const PianoPhrasePattern& p) {
-        PianoPhraseChoice c;
-        c.id = p.id;
-        c.phraseBars = p.phraseBars;
-        c.hits = p.hits;
-        c.notes = p.notes;
-        return c;
-    });
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|piano_phrase|%2|%3|%4|%5")
+                          .arg(q.chordText)
+                          .arg(phraseIndex)
+                          .arg(int(q.chordIsNew))
+                          .arg(q.chordFunction)
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_pianoPhrases, cands, h);
 }
 
-VocabularyRegistry::BassPhraseChoice VocabularyRegistry::chooseBassPhrase(const BassPhraseQuery& q) const {
-    BassPhraseChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::BassPhrasePattern* VocabularyRegistry::pickBassPhrase(const BassPhraseQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const double e = qBound(0.0, q.energy, 1.0);
     const int pb = qMax(1, q.phraseBars);
 
-    QVector<BassPhrasePattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_bassPhrases) {
-        // Allow modular matching: pattern's phraseBars should evenly divide query's phraseBars.
-        const int patternBars = qMax(1, p.phraseBars);
-        if (pb % patternBars != 0) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (p.forbidWhenUserDenseOrPeak && q.userDenseOrPeak) continue;
-        cands.push_back(p);
-    }
-    const int subPhraseLen = cands.isEmpty() ? pb : qMax(1, cands.first().phraseBars);
+    // Allow modular matching: pattern's phraseBars should evenly divide query's phraseBars.
+    ScanPatterns scanned;
+    ScanWeights scannedWeights;
+    const CandidateSpan cands =
+        (pb <= kIndexedPhraseBars)
+            ? m_bassPhraseIndex.candidates(m_bassPhraseIndex.bucketOf({pb - 1, int(q.userDenseOrPeak)}, e))
+            : scanCandidates(m_bassPhrases, e,
+                             [&](const BassPhrasePattern& p) {
+                                 return pb % qMax(1, p.phraseBars) == 0 &&
+                                        !(p.forbidWhenUserDenseOrPeak && q.userDenseOrPeak);
+                             },
+                             scanned, scannedWeights);
+    if (cands.count == 0) return nullptr;
+
+    const int subPhraseLen = qMax(1, m_bassPhrases[cands.patterns[0]].phraseBars);
     const int phraseIndex = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex / subPhraseLen) : 0;
-    const quint32 h = fnv1a32(QString("%1|bass_phrase|%2|%3|%4|%5")
-                                  .arg(q.chordText)
-                                  .arg(phraseIndex)
-                                  .arg(int(q.chordIsNew))
-                                  .arg(int(q.nextChanges))
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<BassPhrasePattern, BassPhraseChoice>(cands, h, [](const BassPhrasePattern& p) {
-        BassPhraseChoice c;
-        c.id = p.id;
-        c.phraseBars = p.phraseBars;
-        c.hits = p.hits;
-        c.notes = p.notes;
-        return c;
-    });
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|bass_phrase|%2|%3|%4|%5")
+                          .arg(q.chordText)
+                          .arg(phraseIndex)
+                          .arg(int(q.chordIsNew))
+                          .arg(int(q.nextChanges))
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_bassPhrases, cands, h);
 }
 
-VocabularyRegistry::DrumsPhraseChoice VocabularyRegistry::chooseDrumsPhrase(const DrumsPhraseQuery& q) const {
-    DrumsPhraseChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::DrumsPhrasePattern* VocabularyRegistry::pickDrumsPhrase(const DrumsPhraseQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const double e = qBound(0.0, q.energy, 1.0);
     const int pb = qMax(1, q.phraseBars);
 
-    QVector<DrumsPhrasePattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_drumsPhrases) {
-        // Allow modular matching: pattern's phraseBars should evenly divide query's phraseBars.
-        const int patternBars = qMax(1, p.phraseBars);
-        if (pb % patternBars != 0) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (p.intensityPeakOnly && !q.intensityPeak) continue;
-        cands.push_back(p);
-    }
-    const int subPhraseLen = cands.isEmpty() ? pb : qMax(1, cands.first().phraseBars);
+    // Allow modular matching: pattern's phraseBars should evenly divide query's phraseBars.
+    ScanPatterns scanned;
+    ScanWeights scannedWeights;
+    const CandidateSpan cands =
+        (pb <= kIndexedPhraseBars)
+            ? m_drumsPhraseIndex.candidates(m_drumsPhraseIndex.bucketOf({pb - 1, int(q.intensityPeak)}, e))
+            : scanCandidates(m_drumsPhrases, e,
+                             [&](const DrumsPhrasePattern& p) {
+                                 return pb % qMax(1, p.phraseBars) == 0 && !(p.intensityPeakOnly && !q.intensityPeak);
+                             },
+                             scanned, scannedWeights);
+    if (cands.count == 0) return nullptr;
+
+    const int subPhraseLen = qMax(1, m_drumsPhrases[cands.patterns[0]].phraseBars);
     const int phraseIndex = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex / subPhraseLen) : 0;
-    const quint32 h = fnv1a32(QString("drums_phrase|%1|%2|%3")
-                                  .arg(phraseIndex)
-                                  .arg(int(q.intensityPeak))
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<DrumsPhrasePattern, DrumsPhraseChoice>(cands, h, [](const DrumsPhrasePattern& p) {
-        DrumsPhraseChoice c;
-        c.id = p.id;
-        c.phraseBars = p.phraseBars;
-        c.hits = p.hits;
-        c.notes = p.notes;
-        return c;
-    });
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("drums_phrase|%1|%2|%3")
+                          .arg(phraseIndex)
+                          .arg(int(q.intensityPeak))
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_drumsPhrases, cands, h);
 }
 
-VocabularyRegistry::PianoTopLineChoice VocabularyRegistry::choosePianoTopLine(const PianoTopLineQuery& q) const {
-    PianoTopLineChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::PianoTopLinePattern* VocabularyRegistry::pickPianoTopLine(const PianoTopLineQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const double e = qBound(0.0, q.energy, 1.0);
     const int pb = qMax(1, q.phraseBars);
 
-    QVector<PianoTopLinePattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_pianoTopLines) {
-        if (p.phraseBars != pb) continue;
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (!p.allowWhenUserSilence && q.userSilence) continue;
-        if (!functionMatches(p.chordFunctions, q.chordFunction)) continue;
-        cands.push_back(p);
-    }
+    ScanPatterns scanned;
+    ScanWeights scannedWeights;
+    const CandidateSpan cands =
+        (pb <= kIndexedPhraseBars)
+            ? m_pianoTopLineIndex.candidates(
+                  m_pianoTopLineIndex.bucketOf({pb - 1, int(q.userSilence), functionId(q.chordFunction)}, e))
+            : scanCandidates(m_pianoTopLines, e,
+                             [&](const PianoTopLinePattern& p) {
+                                 return p.phraseBars == pb && (p.allowWhenUserSilence || !q.userSilence) &&
+                                        functionMatches(p.chordFunctions, q.chordFunction);
+                             },
+                             scanned, scannedWeights);
+    if (cands.count == 0) return nullptr;
+
     const int phraseIndex = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex / pb) : 0;
-    const quint32 h = fnv1a32(QString("%1|piano_topline|%2|%3|%4|%5|%6")
-                                  .arg(q.chordText)
-                                  .arg(phraseIndex)
-                                  .arg(int(q.chordIsNew))
-                                  .arg(q.chordFunction)
-                                  .arg(int(llround(q.rhythmicComplexity * 100.0)))
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<PianoTopLinePattern, PianoTopLineChoice>(cands, h, [](const PianoTopLinePattern& p) {
-        PianoTopLineChoice c;
-        c.id = p.id;
-        c.phraseBars = p.phraseBars;
-        c.hits = p.hits;
-        c.notes = p.notes;
-        return c;
-    });
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|piano_topline|%2|%3|%4|%5|%6")
+                          .arg(q.chordText)
+                          .arg(phraseIndex)
+                          .arg(int(q.chordIsNew))
+                          .arg(q.chordFunction)
+                          .arg(int(llround(q.rhythmicComplexity * 100.0)))
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_pianoTopLines, cands, h);
 }
 
-VocabularyRegistry::PianoGestureChoice VocabularyRegistry::choosePianoGesture(const PianoGestureQuery& q) const {
-    PianoGestureChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::PianoGesturePattern* VocabularyRegistry::pickPianoGesture(const PianoGestureQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const double e = qBound(0.0, q.energy, 1.0);
 
-    QVector<PianoGesturePattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_pianoGestures) {
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (p.cadenceOnly && !q.cadence) continue;
-        if (p.chordIsNewOnly && !q.chordIsNew) continue;
-        if (!p.allowWhenUserSilence && q.userSilence) continue;
-        if (q.noteCount < p.minNoteCount || q.noteCount > p.maxNoteCount) continue;
-        if (q.bpm > p.maxBpm) continue;
-        cands.push_back(p);
-    }
-    const quint32 h = fnv1a32(QString("%1|piano_gesture|%2|%3|%4|%5|%6|%7")
-                                  .arg(q.chordText)
-                                  .arg(q.playbackBarIndex)
-                                  .arg(q.beatInBar)
-                                  .arg(int(q.cadence))
-                                  .arg(q.noteCount)
-                                  .arg(int(llround(q.energy * 100.0)))
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<PianoGesturePattern, PianoGestureChoice>(cands, h, [](const PianoGesturePattern& p) {
-        PianoGestureChoice c;
-        c.id = p.id;
-        c.kind = p.kind;
-        c.style = p.style;
-        c.spreadMs = p.spreadMs;
-        c.notes = p.notes;
-        return c;
-    });
+    // Note count and tempo are open-ended ranges, so gestures (a handful) are scanned.
+    ScanPatterns scanned;
+    ScanWeights scannedWeights;
+    const CandidateSpan cands = scanCandidates(m_pianoGestures, e,
+                                               [&](const PianoGesturePattern& p) {
+                                                   if (p.cadenceOnly && !q.cadence) return false;
+                                                   if (p.chordIsNewOnly && !q.chordIsNew) return false;
+                                                   if (!p.allowWhenUserSilence && q.userSilence) return false;
+                                                   if (q.noteCount < p.minNoteCount || q.noteCount > p.maxNoteCount) return false;
+                                                   return q.bpm <= p.maxBpm;
+                                               },
+                                               scanned, scannedWeights);
+    if (cands.count == 0) return nullptr;
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|piano_gesture|%2|%3|%4|%5|%6|%7")
+                          .arg(q.chordText)
+                          .arg(q.playbackBarIndex)
+                          .arg(q.beatInBar)
+                          .arg(int(q.cadence))
+                          .arg(q.noteCount)
+                          .arg(int(llround(q.energy * 100.0)))
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_pianoGestures, cands, h);
 }
 
-VocabularyRegistry::PianoPedalChoice VocabularyRegistry::choosePianoPedal(const PianoPedalQuery& q) const {
-    PianoPedalChoice out;
-    if (!m_loaded) return out;
-    if (!(q.ts.num == 4 && q.ts.den == 4)) return out;
+const VocabularyRegistry::PianoPedalPattern* VocabularyRegistry::pickPianoPedal(const PianoPedalQuery& q) const {
+    if (!m_loaded) return nullptr;
+    if (!(q.ts.num == 4 && q.ts.den == 4)) return nullptr;
     const double e = qBound(0.0, q.energy, 1.0);
 
-    QVector<PianoPedalPattern> cands;
-    cands.reserve(16);
-    for (const auto& p : m_pianoPedals) {
-        if (!energyMatches(e, p.minEnergy, p.maxEnergy)) continue;
-        if (!p.allowWhenUserSilence && q.userSilence) continue;
-        cands.push_back(p);
-    }
-    const quint32 h = fnv1a32(QString("%1|piano_pedal|%2|%3|%4|%5|%6")
-                                  .arg(q.chordText)
-                                  .arg(q.playbackBarIndex)
-                                  .arg(int(q.chordIsNew))
-                                  .arg(int(q.nextChanges))
-                                  .arg(q.beatsUntilChordChange)
-                                  .arg(q.determinismSeed)
-                                  .toUtf8());
-    return chooseWeighted<PianoPedalPattern, PianoPedalChoice>(cands, h, [](const PianoPedalPattern& p) {
-        PianoPedalChoice c;
-        c.id = p.id;
-        c.defaultState = p.defaultState;
-        c.repedalOnNewChord = p.repedalOnNewChord;
-        c.repedalProbPct = p.repedalProbPct;
-        c.clearBeforeChange = p.clearBeforeChange;
-        c.clearSub = p.clearSub;
-        c.clearCount = p.clearCount;
-        c.notes = p.notes;
-        return c;
-    });
+    const CandidateSpan cands = m_pianoPedalIndex.candidates(m_pianoPedalIndex.bucketOf({int(q.userSilence)}, e));
+    if (cands.count == 0) return nullptr;
+    const quint32 h = virtuoso::util::StableHash::ArgFormat("%1|piano_pedal|%2|%3|%4|%5|%6")
+                          .arg(q.chordText)
+                          .arg(q.playbackBarIndex)
+                          .arg(int(q.chordIsNew))
+                          .arg(int(q.nextChanges))
+                          .arg(q.beatsUntilChordChange)
+                          .arg(q.determinismSeed)
+                          .value();
+    return pickWeighted(m_pianoPedals, cands, h);
+}
+
+VocabularyRegistry::PianoBeatChoice VocabularyRegistry::choosePianoBeat(const PianoBeatQuery& q) const {
+    PianoBeatChoice c;
+    const PianoBeatPattern* p = pickPianoBeat(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.hits = p->hits;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::BassBeatChoice VocabularyRegistry::chooseBassBeat(const BassBeatQuery& q) const {
+    BassBeatChoice c;
+    const BassBeatPattern* p = pickBassBeat(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.action = p->action;
+    c.sub = p->sub;
+    c.count = p->count;
+    c.dur_num = p->dur_num;
+    c.dur_den = p->dur_den;
+    c.vel_delta = p->vel_delta;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::DrumsBeatChoice VocabularyRegistry::chooseDrumsBeat(const DrumsBeatQuery& q) const {
+    DrumsBeatChoice c;
+    const DrumsBeatPattern* p = pickDrumsBeat(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.hits = p->hits;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::PianoPhraseChoice VocabularyRegistry::choosePianoPhrase(const PianoPhraseQuery& q) const {
+    PianoPhraseChoice c;
+    const PianoPhrasePattern* p = pickPianoPhrase(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.phraseBars = p->phraseBars;
+    c.hits = p->hits;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::BassPhraseChoice VocabularyRegistry::chooseBassPhrase(const BassPhraseQuery& q) const {
+    BassPhraseChoice c;
+    const BassPhrasePattern* p = pickBassPhrase(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.phraseBars = p->phraseBars;
+    c.hits = p->hits;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::DrumsPhraseChoice VocabularyRegistry::chooseDrumsPhrase(const DrumsPhraseQuery& q) const {
+    DrumsPhraseChoice c;
+    const DrumsPhrasePattern* p = pickDrumsPhrase(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.phraseBars = p->phraseBars;
+    c.hits = p->hits;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::PianoTopLineChoice VocabularyRegistry::choosePianoTopLine(const PianoTopLineQuery& q) const {
+    PianoTopLineChoice c;
+    const PianoTopLinePattern* p = pickPianoTopLine(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.phraseBars = p->phraseBars;
+    c.hits = p->hits;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::PianoGestureChoice VocabularyRegistry::choosePianoGesture(const PianoGestureQuery& q) const {
+    PianoGestureChoice c;
+    const PianoGesturePattern* p = pickPianoGesture(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.kind = p->kind;
+    c.style = p->style;
+    c.spreadMs = p->spreadMs;
+    c.notes = p->notes;
+    return c;
+}
+
+VocabularyRegistry::PianoPedalChoice VocabularyRegistry::choosePianoPedal(const PianoPedalQuery& q) const {
+    PianoPedalChoice c;
+    const PianoPedalPattern* p = pickPianoPedal(q);
+    if (!p) return c;
+    c.id = p->id;
+    c.defaultState = p->defaultState;
+    c.repedalOnNewChord = p->repedalOnNewChord;
+    c.repedalProbPct = p->repedalProbPct;
+    c.clearBeforeChange = p->clearBeforeChange;
+    c.clearSub = p->clearSub;
+    c.clearCount = p->clearCount;
+    c.notes = p->notes;
+    return c;
 }
 
 QVector<VocabularyRegistry::PianoHit> VocabularyRegistry::pianoPhraseHitsForBeat(const PianoPhraseQuery& q,
                                                                                  QString* outPhraseId,
                                                                                  QString* outPhraseNotes) const {
     QVector<PianoHit> out;
-    const auto ch = choosePianoPhrase(q);
-    if (outPhraseId) *outPhraseId = ch.id;
-    if (outPhraseNotes) *outPhraseNotes = ch.notes;
-    if (ch.id.isEmpty()) return out;
-    const int pb = qMax(1, ch.phraseBars);
+    const PianoPhrasePattern* p = pickPianoPhrase(q);
+    if (outPhraseId) *outPhraseId = p ? p->id : QString();
+    if (outPhraseNotes) *outPhraseNotes = p ? p->notes : QString();
+    if (!p) return out;
+    const int pb = qMax(1, p->phraseBars);
     const int barInPhrase = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex % pb) : 0;
-    for (const auto& h : ch.hits) {
+    for (const auto& h : p->hits) {
         if (h.barOffset == barInPhrase && h.beatInBar == q.beatInBar) out.push_back(h.hit);
     }
 
@@ -875,13 +1315,13 @@ QVector<VocabularyRegistry::BassPhraseHit> VocabularyRegistry::bassPhraseHitsFor
                                                                                      QString* outPhraseId,
                                                                                      QString* outPhraseNotes) const {
     QVector<BassPhraseHit> out;
-    const auto ch = chooseBassPhrase(q);
-    if (outPhraseId) *outPhraseId = ch.id;
-    if (outPhraseNotes) *outPhraseNotes = ch.notes;
-    if (ch.id.isEmpty()) return out;
-    const int pb = qMax(1, ch.phraseBars);
+    const BassPhrasePattern* p = pickBassPhrase(q);
+    if (outPhraseId) *outPhraseId = p ? p->id : QString();
+    if (outPhraseNotes) *outPhraseNotes = p ? p->notes : QString();
+    if (!p) return out;
+    const int pb = qMax(1, p->phraseBars);
     const int barInPhrase = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex % pb) : 0;
-    for (const auto& h : ch.hits) {
+    for (const auto& h : p->hits) {
         if (h.barOffset == barInPhrase && h.beatInBar == q.beatInBar) out.push_back(h);
     }
     return out;
@@ -891,13 +1331,13 @@ QVector<VocabularyRegistry::DrumHit> VocabularyRegistry::drumsPhraseHitsForBeat(
                                                                                 QString* outPhraseId,
                                                                                 QString* outPhraseNotes) const {
     QVector<DrumHit> out;
-    const auto ch = chooseDrumsPhrase(q);
-    if (outPhraseId) *outPhraseId = ch.id;
-    if (outPhraseNotes) *outPhraseNotes = ch.notes;
-    if (ch.id.isEmpty()) return out;
-    const int pb = qMax(1, ch.phraseBars);
+    const DrumsPhrasePattern* p = pickDrumsPhrase(q);
+    if (outPhraseId) *outPhraseId = p ? p->id : QString();
+    if (outPhraseNotes) *outPhraseNotes = p ? p->notes : QString();
+    if (!p) return out;
+    const int pb = qMax(1, p->phraseBars);
     const int barInPhrase = (q.playbackBarIndex >= 0) ? (q.playbackBarIndex % pb) : 0;
-    for (const auto& h : ch.hits) {
+    for (const auto& h : p->hits) {
         if (h.barOffset == barInPhrase && h.beatInBar == q.beatInBar) out.push_back(h.hit);
     }
     return out;
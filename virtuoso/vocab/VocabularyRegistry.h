@@ -1,16 +1,25 @@
 #pragma once
 
 #include <QString>
+#include <QVarLengthArray>
 #include <QVector>
 
+#include <initializer_list>
+
 #include "virtuoso/groove/GrooveGrid.h"
 
+namespace virtuoso::util {
+class BundleWriter;
+class RegistryBundle;
+} // namespace virtuoso::util
+
 namespace virtuoso::vocab {
 
 // A small, data-driven "phrase/pattern vocabulary" layer.
 // MVP scope:
 // - Beat-scoped patterns (per beat-in-bar) for 4/4, tuned for cool jazz ballad language.
 // - Deterministic selection: no RNG state; selection is derived from a stable hash of the query.
+// - Candidate lookup is indexed at load time (see CandidateIndex); queries do no per-pattern scan.
 class VocabularyRegistry {
 public:
     struct PianoHit {
@@ -376,8 +385,21 @@ public:
     bool loadFromJsonBytes(const QByteArray& json, QString* outError = nullptr);
     bool loadFromResourcePath(const QString& resourcePath, QString* outError = nullptr);
 
+    // Precompiled patterns (virtuoso/util/RegistryBundle.h): the loaded tables and contentHash()
+    // of the JSON they came from; indexes are rebuilt on load.
+    void writeBundle(util::BundleWriter& w) const;
+    bool loadFromBundle(const util::RegistryBundle& bundle, QString* outError = nullptr);
+
+    // The vocabulary the app ships as a resource.
+    static constexpr const char* kResourcePath = ":/virtuoso/vocab/cool_jazz_vocabulary.json";
+    // One immutable registry per process, loaded on first use (thread-safe) from the embedded
+    // bundle, else from kResourcePath. Check isLoaded()/lastError() on the result.
+    static const VocabularyRegistry& shared();
+
     bool isLoaded() const { return m_loaded; }
     QString lastError() const { return m_lastError; }
+    // Stable hash of the loaded JSON bytes (0 when not loaded). Identifies vocabulary content for caches.
+    quint32 contentHash() const { return m_contentHash; }
 
     PianoBeatChoice choosePianoBeat(const PianoBeatQuery& q) const;
     BassBeatChoice chooseBassBeat(const BassBeatQuery& q) const;
@@ -406,6 +428,8 @@ public:
     QVector<DrumsPhraseChoice> drumsPhrasePatterns() const;
 
 private:
+    friend struct VocabularyRegistryTestAccess;
+
     struct PianoBeatPattern {
         QString id;
         QVector<int> beats; // allowed beatInBar values
@@ -528,17 +552,75 @@ private:
         QString notes;
     };
 
+    // Candidate pattern indices (into one pattern list, in load order) with running sums of
+    // their weights; points into a CandidateIndex or a scan buffer.
+    struct CandidateSpan {
+        const int* patterns = nullptr;
+        const double* cumWeights = nullptr;
+        int count = 0;
+    };
+
+    // Load-time candidate index for one pattern list. Which patterns pass a query's filters
+    // depends only on a few discrete keys (beat or phrase length, flags, chord function id)
+    // and on the energy band: energy is cut at every distinct min/max endpoint, so each bound
+    // and each open gap between bounds is its own band. Every key combination gets a bucket
+    // built with the same filters the former linear scan applied.
+    struct CandidateIndex {
+        QVector<double> energyBounds; // sorted, distinct
+        QVector<int> extents;         // per key dimension; energy band is the innermost
+        QVector<int> bucketBegin;     // offsets into patterns/cumWeights, plus the end
+        QVector<int> patterns;
+        QVector<double> cumWeights;
+
+        int energyBand(double e) const;
+        // -1 when a key component is out of range (no pattern can match it).
+        int bucketOf(std::initializer_list<int> key, double energy) const;
+        CandidateSpan candidates(int bucket) const;
+    };
+
+    using ScanPatterns = QVarLengthArray<int, 32>;
+    using ScanWeights = QVarLengthArray<double, 32>;
+
+    // Phrase lengths up to this are indexed; longer queries fall back to a scan.
+    static constexpr int kIndexedPhraseBars = 16;
+
     static quint32 fnv1a32(const QByteArray& bytes);
     static bool energyMatches(double e, double minE, double maxE);
     static int clampBeat(int beatInBar);
 
-    template <typename TPattern, typename TChoice, typename TMakeChoiceFn>
-    static TChoice chooseWeighted(const QVector<TPattern>& patterns,
-                                  quint32 pickHash,
-                                  const TMakeChoiceFn& makeChoice);
+    // 0 = no function given (matches everything), 1..n = a function named by some pattern,
+    // n + 1 = any other function (matches only unrestricted patterns).
+    int functionId(const QString& chordFunction) const;
+    bool functionIdMatches(const QVector<QString>& allowed, int functionId) const;
+    void buildIndexes();
+
+    template <typename TPattern, typename TMatchFn>
+    static void buildIndex(CandidateIndex& index,
+                           const QVector<TPattern>& patterns,
+                           const QVector<int>& extents,
+                           const TMatchFn& matches);
+    template <typename TPattern, typename TAcceptFn>
+    static CandidateSpan scanCandidates(const QVector<TPattern>& patterns,
+                                        double energy,
+                                        const TAcceptFn& accept,
+                                        ScanPatterns& outPatterns,
+                                        ScanWeights& outWeights);
+    template <typename TPattern>
+    static const TPattern* pickWeighted(const QVector<TPattern>& patterns, const CandidateSpan& cands, quint32 pickHash);
+
+    const PianoBeatPattern* pickPianoBeat(const PianoBeatQuery& q) const;
+    const BassBeatPattern* pickBassBeat(const BassBeatQuery& q) const;
+    const DrumsBeatPattern* pickDrumsBeat(const DrumsBeatQuery& q) const;
+    const PianoPhrasePattern* pickPianoPhrase(const PianoPhraseQuery& q) const;
+    const PianoTopLinePattern* pickPianoTopLine(const PianoTopLineQuery& q) const;
+    const PianoGesturePattern* pickPianoGesture(const PianoGestureQuery& q) const;
+    const PianoPedalPattern* pickPianoPedal(const PianoPedalQuery& q) const;
+    const BassPhrasePattern* pickBassPhrase(const BassPhraseQuery& q) const;
+    const DrumsPhrasePattern* pickDrumsPhrase(const DrumsPhraseQuery& q) const;
 
     bool m_loaded = false;
     QString m_lastError;
+    quint32 m_contentHash = 0;
 
     QVector<PianoBeatPattern> m_piano;
     QVector<BassBeatPattern> m_bass;
@@ -550,6 +632,16 @@ private:
     QVector<PianoPedalPattern> m_pianoPedals;
     QVector<BassPhrasePattern> m_bassPhrases;
     QVector<DrumsPhrasePattern> m_drumsPhrases;
+
+    QVector<QString> m_functionNames; // distinct names from "functions" lists, case-insensitive
+    CandidateIndex m_pianoIndex;        // beat, chordIsNew, userSilence, function
+    CandidateIndex m_bassIndex;         // beat, chordIsNew, next chord changes, userDenseOrPeak
+    CandidateIndex m_drumsIndex;        // beat, intensityPeak
+    CandidateIndex m_pianoPhraseIndex;  // phraseBars - 1, userSilence, function
+    CandidateIndex m_pianoTopLineIndex; // phraseBars - 1, userSilence, function
+    CandidateIndex m_pianoPedalIndex;   // userSilence
+    CandidateIndex m_bassPhraseIndex;   // phraseBars - 1, userDenseOrPeak
+    CandidateIndex m_drumsPhraseIndex;  // phraseBars - 1, intensityPeak
 };
 
 } // namespace virtuoso::vocab